@@ -0,0 +1,222 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The RtcpPacketView class references one RTCP packet inside a received compound
+ * packet. It does not own or copy any data: the buffer the view was created from must
+ * outlive the view.
+ */
+class RtcpPacketView
+{
+public:
+  RtcpPacketView()
+    :m_pData(nullptr),
+    m_uiSize(0)
+  {
+  }
+
+  RtcpPacketView(const uint8_t* pData, uint32_t uiSize)
+    :m_pData(pData),
+    m_uiSize(uiSize)
+  {
+  }
+
+  uint8_t getVersion() const { return m_pData[0] >> 6; }
+  bool getPadding() const { return (m_pData[0] & 0x20) != 0; }
+  /// report count, sub-type or feedback message type depending on the packet type
+  uint8_t getTypeSpecific() const { return m_pData[0] & 0x1F; }
+  uint8_t getPacketType() const { return m_pData[1]; }
+  /// length in words excluding the common header
+  uint16_t getLength() const { return rfc3550::RtpHeaderCodec::readUint16(m_pData + 2); }
+  /// pointer to the common header
+  const uint8_t* getData() const { return m_pData; }
+  /// size in bytes including the common header and padding
+  uint32_t getSize() const { return m_uiSize; }
+  /// pointer to the data following the common header
+  const uint8_t* getBody() const { return m_pData + 4; }
+  uint32_t getBodySize() const { return m_uiSize - 4; }
+  /// returns the 32 bit word at uiOffset bytes from the start of the packet
+  uint32_t readUint32(uint32_t uiOffset) const { return rfc3550::RtpHeaderCodec::readUint32(m_pData + uiOffset); }
+
+private:
+  const uint8_t* m_pData;
+  uint32_t m_uiSize;
+};
+
+/**
+ * @brief The RtcpReportBlockView class references a report block of an SR or RR
+ */
+class RtcpReportBlockView
+{
+public:
+  explicit RtcpReportBlockView(const uint8_t* pData)
+    :m_pData(pData)
+  {
+  }
+
+  uint32_t getReporteeSSRC() const { return rfc3550::RtpHeaderCodec::readUint32(m_pData); }
+  uint8_t getFractionLost() const { return m_pData[4]; }
+  /// the 24 bit field is sign-extended
+  int32_t getCumulativeNumberOfPacketsLost() const
+  {
+    int32_t iLost = (m_pData[5] << 16) | (m_pData[6] << 8) | m_pData[7];
+    return (iLost & 0x800000) ? iLost - 0x1000000 : iLost;
+  }
+  uint32_t getExtendedHighestSNReceived() const { return rfc3550::RtpHeaderCodec::readUint32(m_pData + 8); }
+  uint32_t getInterarrivalJitter() const { return rfc3550::RtpHeaderCodec::readUint32(m_pData + 12); }
+  uint32_t getLastSr() const { return rfc3550::RtpHeaderCodec::readUint32(m_pData + 16); }
+  uint32_t getDelaySinceLastSr() const { return rfc3550::RtpHeaderCodec::readUint32(m_pData + 20); }
+
+private:
+  const uint8_t* m_pData;
+};
+
+/**
+ * @brief The RtcpSrView class provides typed access to an SR that has been validated by RtcpCompoundView
+ */
+class RtcpSrView
+{
+public:
+  explicit RtcpSrView(const RtcpPacketView& packet)
+    :m_packet(packet)
+  {
+  }
+
+  uint32_t getSSRC() const { return m_packet.readUint32(4); }
+  uint32_t getNtpTimestampMsw() const { return m_packet.readUint32(8); }
+  uint32_t getNtpTimestampLsw() const { return m_packet.readUint32(12); }
+  uint32_t getRtpTimestamp() const { return m_packet.readUint32(16); }
+  uint32_t getSendersPacketCount() const { return m_packet.readUint32(20); }
+  uint32_t getSendersOctetCount() const { return m_packet.readUint32(24); }
+  uint32_t getReportCount() const { return m_packet.getTypeSpecific(); }
+  RtcpReportBlockView getReportBlock(uint32_t uiIndex) const { return RtcpReportBlockView(m_packet.getData() + 28 + 24 * uiIndex); }
+
+private:
+  RtcpPacketView m_packet;
+};
+
+/**
+ * @brief The RtcpRrView class provides typed access to an RR that has been validated by RtcpCompoundView
+ */
+class RtcpRrView
+{
+public:
+  explicit RtcpRrView(const RtcpPacketView& packet)
+    :m_packet(packet)
+  {
+  }
+
+  uint32_t getReporterSSRC() const { return m_packet.readUint32(4); }
+  uint32_t getReportCount() const { return m_packet.getTypeSpecific(); }
+  RtcpReportBlockView getReportBlock(uint32_t uiIndex) const { return RtcpReportBlockView(m_packet.getData() + 8 + 24 * uiIndex); }
+
+private:
+  RtcpPacketView m_packet;
+};
+
+/**
+ * @brief The RtcpByeView class provides typed access to a BYE that has been validated by RtcpCompoundView
+ */
+class RtcpByeView
+{
+public:
+  explicit RtcpByeView(const RtcpPacketView& packet)
+    :m_packet(packet)
+  {
+  }
+
+  uint32_t getSourceCount() const { return m_packet.getTypeSpecific(); }
+  uint32_t getSSRC(uint32_t uiIndex) const { return m_packet.readUint32(4 + 4 * uiIndex); }
+
+private:
+  RtcpPacketView m_packet;
+};
+
+/**
+ * @brief The RtcpFbView class provides typed access to an RFC 4585 transport layer or
+ * payload specific feedback message that has been validated by RtcpCompoundView.
+ *
+ * The NACK and ACK decoders append to a caller-owned vector so that the storage can be
+ * reused between packets. They decode the same FCI layout as RtcpGenericNack and
+ * RtcpGenericAck.
+ */
+class RtcpFbView
+{
+public:
+  explicit RtcpFbView(const RtcpPacketView& packet)
+    :m_packet(packet)
+  {
+  }
+
+  uint8_t getFormat() const { return m_packet.getTypeSpecific(); }
+  uint32_t getSize() const { return m_packet.getSize(); }
+  uint32_t getSenderSSRC() const { return m_packet.readUint32(4); }
+  uint32_t getSourceSSRC() const { return m_packet.readUint32(8); }
+  /// feedback control information
+  const uint8_t* getFci() const { return m_packet.getData() + 12; }
+  uint32_t getFciSize() const { return m_packet.getSize() - 12; }
+  /**
+   * @brief appends the sequence numbers of a generic NACK to vSNs
+   */
+  void readNacks(std::vector<uint16_t>& vSNs) const;
+  /**
+   * @brief appends the sequence numbers of a generic ACK to vSNs
+   */
+  void readAcks(std::vector<uint16_t>& vSNs) const;
+
+private:
+  RtcpPacketView m_packet;
+};
+
+/**
+ * @brief The RtcpCompoundView class indexes the packets of a compound RTCP packet in place.
+ *
+ * parse() walks the common headers once, checks the version and that every length fits
+ * into the datagram, and stores a view per packet. The views of the first INLINE_PACKETS
+ * packets are stored in a fixed size array: larger compound packets spill into a vector
+ * that is reused between parses. Padding is only accepted on the last packet as required
+ * by RFC 3550. The remaining RFC 3550 / RFC 5506 validation rules are applied by the
+ * configured RtcpValidator on the parsed packets.
+ */
+class RtcpCompoundView
+{
+public:
+  /// number of packets that can be indexed without allocating
+  static const uint32_t INLINE_PACKETS = 32;
+
+  RtcpCompoundView();
+  /**
+   * @brief parse indexes the compound packet in pData. Parsing stops at the first
+   * malformed packet: the valid packets before it remain accessible.
+   * @return true if pData contains a well-formed compound packet
+   */
+  bool parse(const uint8_t* pData, uint32_t uiSize);
+
+  uint32_t size() const { return m_uiCount; }
+  bool empty() const { return m_uiCount == 0; }
+  const RtcpPacketView& operator[](uint32_t uiIndex) const
+  {
+    return uiIndex < INLINE_PACKETS ? m_packets[uiIndex] : m_vOverflow[uiIndex - INLINE_PACKETS];
+  }
+  /// byte offset of the packet at uiIndex from the start of the compound packet
+  uint32_t getOffset(uint32_t uiIndex) const { return static_cast<uint32_t>((*this)[uiIndex].getData() - m_pData); }
+  /**
+   * @brief find returns the index of the first packet of type uiPacketType at or after
+   * uiStart or size() if there is no such packet
+   */
+  uint32_t find(uint8_t uiPacketType, uint32_t uiStart = 0) const;
+
+private:
+  const uint8_t* m_pData;
+  RtcpPacketView m_packets[INLINE_PACKETS];
+  // packets after the first INLINE_PACKETS
+  std::vector<RtcpPacketView> m_vOverflow;
+  uint32_t m_uiCount;
+};
+
+} // rtp_plus_plus
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <cpputil/Buffer.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The RtcpCompoundWriter class builds a compound RTCP packet directly into a
+ * pooled buffer.
+ *
+ * Each write method appends one packet and returns false without modifying the buffer
+ * if there is not enough space left. Report blocks are appended to the SR or RR that
+ * was written last and update its report count and length. The generic NACK and ACK
+ * FCIs are encoded in the same layout as RtcpGenericNack and RtcpGenericAck so that
+ * the registered parsers can read them.
+ *
+ * This is an alternative to building a CompoundRtcpPacket and serialising it with
+ * RtpPacketiser::packetise for senders of frequent feedback.
+ */
+class RtcpCompoundWriter
+{
+public:
+  /**
+   * @brief Constructor
+   * @param uiCapacity The maximum size of the compound packet
+   */
+  explicit RtcpCompoundWriter(uint32_t uiCapacity = 1500);
+  /**
+   * @brief reset discards the written packets. The buffer returned by getBuffer must
+   * not be in use anymore.
+   */
+  void reset();
+
+  bool writeSr(uint32_t uiSSRC, uint32_t uiNtpTimestampMsw, uint32_t uiNtpTimestampLsw,
+               uint32_t uiRtpTimestamp, uint32_t uiSendersPacketCount, uint32_t uiSendersOctetCount);
+  bool writeRr(uint32_t uiReporterSSRC);
+  bool addReportBlock(uint32_t uiReporteeSSRC, uint8_t uiFractionLost, int32_t iCumulativeNumberOfPacketsLost,
+                      uint32_t uiExtendedHighestSNReceived, uint32_t uiInterarrivalJitter,
+                      uint32_t uiLastSr, uint32_t uiDelaySinceLastSr);
+  bool writeSdesCname(uint32_t uiSSRC, const std::string& sCname);
+  bool writeBye(uint32_t uiSSRC);
+  /**
+   * @brief writes a feedback message with the FCI in pFci
+   * @param uiFciSize Must be a multiple of 4
+   */
+  bool writeFb(uint8_t uiPacketType, uint8_t uiFormat, uint32_t uiSenderSSRC, uint32_t uiSourceSSRC,
+               const uint8_t* pFci, uint32_t uiFciSize);
+  bool writeGenericNack(uint32_t uiSenderSSRC, uint32_t uiSourceSSRC, const std::vector<uint16_t>& vSNs);
+  /**
+   * @brief writes a generic ACK
+   * @param vSNs Should be in ascending order (sequence numbers may wrap around): any order is
+   * encoded correctly but consecutive sequence numbers share an entry
+   */
+  bool writeGenericAck(uint32_t uiSenderSSRC, uint32_t uiSourceSSRC, const std::vector<uint16_t>& vSNs);
+
+  uint32_t getSize() const { return m_uiOffset; }
+  uint32_t getPacketCount() const { return m_uiPacketCount; }
+  /**
+   * @brief getBuffer returns the compound packet. The returned buffer shares the storage of the writer.
+   */
+  Buffer getBuffer() const;
+
+private:
+  uint8_t* beginPacket(uint8_t uiTypeSpecific, uint8_t uiPacketType, uint32_t uiSize);
+  void setLength(uint32_t uiOffset, uint32_t uiSize);
+  uint32_t getRemaining() const { return m_buffer.getSize() - m_uiOffset; }
+
+  Buffer m_buffer;
+  uint32_t m_uiOffset;
+  uint32_t m_uiPacketCount;
+  // offset of the last SR or RR or UINT32_MAX
+  uint32_t m_uiReportOffset;
+};
+
+} // rtp_plus_plus
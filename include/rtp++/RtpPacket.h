@@ -1,11 +1,15 @@
 #pragma once
+#include <cassert>
+#include <cstring>
 #include <list>
 #include <utility>
+#include <vector>
 #include <cpputil/Buffer.h>
 #include <boost/date_time/posix_time/ptime.hpp>
 #include <boost/optional.hpp>
 #include <rtp++/mprtp/MpRtpHeader.h>
 #include <rtp++/rfc3550/RtpHeader.h>
+#include <rtp++/util/Clock.h>
 
 /// typedef for extended sequence number and payload pair
 typedef std::pair<uint32_t, Buffer> PacketData_t;
@@ -16,19 +20,48 @@ namespace rtp_plus_plus
 
 /**
  * @brief The RtpPacket class
+ *
+ * The packet does not own any heap memory besides the reference counted payload and raw
+ * data buffers unless it has more than RtpHeader::INLINE_CSRC_COUNT CSRCs, an RFC 5285
+ * header extension or payload segments. Copies are therefore cheap, and packets are moved
+ * where they are handed on, e.g. from the payload packetisers to the session.
+ *
+ * Outgoing packets may describe their payload for gathering instead of storing it in one
+ * buffer: a payload header of up to MAX_PAYLOAD_HEADER_SIZE bytes that is stored inline,
+ * the payload buffer, and optional segments each consisting of a few inline prefix bytes
+ * and a buffer. This allows payload formats such as RFC 6184 to reference the media sample
+ * for FU and STAP payloads. The parts are only joined when the packet is written.
  */
 class RtpPacket
 {
 public:
+  static const uint32_t MAX_PAYLOAD_HEADER_SIZE = 8;
+
+  /**
+   * @brief The PayloadSegment struct is a part of a gathered payload that follows the
+   * payload buffer on the wire, e.g. the NAL unit size and NAL unit of an RFC 6184 STAP-A
+   */
+  struct PayloadSegment
+  {
+    static const uint32_t MAX_PREFIX_SIZE = 6;
+
+    uint8_t Prefix[MAX_PREFIX_SIZE];
+    uint8_t PrefixSize;
+    Buffer Data;
+  };
+
   /**
    * @brief Constructor
    */
   RtpPacket()
-    :m_uiRtpArrivalTimestamp(0),
+    :m_uiExtendedSequenceNumber(0),
+      m_uiRtpArrivalTimestamp(0),
+      m_iId(-1),
+      m_iArrivalTimeNs(0),
+      m_iSendTimeNs(0),
       m_tNtpArrival(0),
-      m_uiExtendedSequenceNumber(0),
       m_dOwdSeconds(-1.0),
-      m_iId(-1)
+      m_uiPayloadHeaderSize(0)
   {
 
   }
@@ -37,13 +70,102 @@ public:
    */
   RtpPacket(const rfc3550::RtpHeader& rtpHeader)
     :m_header(rtpHeader),
+      m_uiExtendedSequenceNumber(0),
       m_uiRtpArrivalTimestamp(0),
+      m_iId(-1),
+      m_iArrivalTimeNs(0),
+      m_iSendTimeNs(0),
       m_tNtpArrival(0),
-      m_uiExtendedSequenceNumber(0),
       m_dOwdSeconds(-1.0),
-      m_iId(-1)
+      m_uiPayloadHeaderSize(0)
   {
 
+  }
+  /**
+   * @brief Copy constructor: the payload buffers are shared with other
+   */
+  RtpPacket(const RtpPacket& other)
+    :m_header(other.m_header),
+      m_rtpPayload(other.m_rtpPayload),
+      m_uiExtendedSequenceNumber(other.m_uiExtendedSequenceNumber),
+      m_uiRtpArrivalTimestamp(other.m_uiRtpArrivalTimestamp),
+      m_iId(other.m_iId),
+      m_iArrivalTimeNs(other.m_iArrivalTimeNs),
+      m_iSendTimeNs(other.m_iSendTimeNs),
+      m_tNtpArrival(other.m_tNtpArrival),
+      m_dOwdSeconds(other.m_dOwdSeconds),
+      m_rawRtpPacketData(other.m_rawRtpPacketData),
+      m_source(other.m_source),
+      m_pMpRtpSubflow(other.m_pMpRtpSubflow),
+      m_uiPayloadHeaderSize(other.m_uiPayloadHeaderSize),
+      m_vPayloadSegments(other.m_vPayloadSegments)
+  {
+    memcpy(m_aPayloadHeader, other.m_aPayloadHeader, m_uiPayloadHeaderSize);
+  }
+  /**
+   * @brief Move constructor: takes over the header, payload buffers and segments of other
+   */
+  RtpPacket(RtpPacket&& other)
+    :m_header(std::move(other.m_header)),
+      m_rtpPayload(std::move(other.m_rtpPayload)),
+      m_uiExtendedSequenceNumber(other.m_uiExtendedSequenceNumber),
+      m_uiRtpArrivalTimestamp(other.m_uiRtpArrivalTimestamp),
+      m_iId(other.m_iId),
+      m_iArrivalTimeNs(other.m_iArrivalTimeNs),
+      m_iSendTimeNs(other.m_iSendTimeNs),
+      m_tNtpArrival(other.m_tNtpArrival),
+      m_dOwdSeconds(other.m_dOwdSeconds),
+      m_rawRtpPacketData(std::move(other.m_rawRtpPacketData)),
+      m_source(other.m_source),
+      m_pMpRtpSubflow(other.m_pMpRtpSubflow),
+      m_uiPayloadHeaderSize(other.m_uiPayloadHeaderSize),
+      m_vPayloadSegments(std::move(other.m_vPayloadSegments))
+  {
+    memcpy(m_aPayloadHeader, other.m_aPayloadHeader, m_uiPayloadHeaderSize);
+  }
+  RtpPacket& operator=(const RtpPacket& other)
+  {
+    if (this != &other)
+    {
+      m_header = other.m_header;
+      m_rtpPayload = other.m_rtpPayload;
+      m_uiExtendedSequenceNumber = other.m_uiExtendedSequenceNumber;
+      m_uiRtpArrivalTimestamp = other.m_uiRtpArrivalTimestamp;
+      m_iId = other.m_iId;
+      m_iArrivalTimeNs = other.m_iArrivalTimeNs;
+      m_iSendTimeNs = other.m_iSendTimeNs;
+      m_tNtpArrival = other.m_tNtpArrival;
+      m_dOwdSeconds = other.m_dOwdSeconds;
+      m_rawRtpPacketData = other.m_rawRtpPacketData;
+      m_source = other.m_source;
+      m_pMpRtpSubflow = other.m_pMpRtpSubflow;
+      m_uiPayloadHeaderSize = other.m_uiPayloadHeaderSize;
+      m_vPayloadSegments = other.m_vPayloadSegments;
+      memcpy(m_aPayloadHeader, other.m_aPayloadHeader, m_uiPayloadHeaderSize);
+    }
+    return *this;
+  }
+  RtpPacket& operator=(RtpPacket&& other)
+  {
+    if (this != &other)
+    {
+      m_header = std::move(other.m_header);
+      m_rtpPayload = std::move(other.m_rtpPayload);
+      m_uiExtendedSequenceNumber = other.m_uiExtendedSequenceNumber;
+      m_uiRtpArrivalTimestamp = other.m_uiRtpArrivalTimestamp;
+      m_iId = other.m_iId;
+      m_iArrivalTimeNs = other.m_iArrivalTimeNs;
+      m_iSendTimeNs = other.m_iSendTimeNs;
+      m_tNtpArrival = other.m_tNtpArrival;
+      m_dOwdSeconds = other.m_dOwdSeconds;
+      m_rawRtpPacketData = std::move(other.m_rawRtpPacketData);
+      m_source = other.m_source;
+      m_pMpRtpSubflow = other.m_pMpRtpSubflow;
+      m_uiPayloadHeaderSize = other.m_uiPayloadHeaderSize;
+      m_vPayloadSegments = std::move(other.m_vPayloadSegments);
+      memcpy(m_aPayloadHeader, other.m_aPayloadHeader, m_uiPayloadHeaderSize);
+    }
+    return *this;
   }
   /**
    * @brief Convenience accessor for RTP timestamp
@@ -114,20 +236,96 @@ public:
    */
   void setRtpHeader(const rfc3550::RtpHeader& rHeader) { m_header = rHeader; }
   /**
-   * @brief getPayload
+   * @brief getPayload For received packets the payload is a slice of the
+   * datagram buffer, i.e. it shares the storage of the network packet
    * @return
    */
-  const Buffer getPayload() const { return m_rtpPayload; }
+  const Buffer& getPayload() const { return m_rtpPayload; }
   /**
-   * @brief setPayload
+   * @brief setPayload replaces the payload including a payload header and
+   * segments set for gathering
    * @param payload
    */
-  void setPayload(Buffer payload){ m_rtpPayload = payload; }
+  void setPayload(Buffer payload)
+  {
+    m_rtpPayload = std::move(payload);
+    m_uiPayloadHeaderSize = 0;
+    m_vPayloadSegments.clear();
+  }
   /**
    * @brief getPayloadSize
-   * @return
+   * @return the size of the payload on the wire including a payload header
+   * and segments set for gathering
    */
-  uint32_t getPayloadSize() const { return m_rtpPayload.getSize(); }
+  uint32_t getPayloadSize() const
+  {
+    uint32_t uiSize = m_uiPayloadHeaderSize + m_rtpPayload.getSize();
+    for (const PayloadSegment& segment : m_vPayloadSegments)
+    {
+      uiSize += segment.PrefixSize + segment.Data.getSize();
+    }
+    return uiSize;
+  }
+  /**
+   * @brief setPayloadHeader sets the bytes that precede the payload buffer on the wire
+   */
+  void setPayloadHeader(const uint8_t* pHeader, uint32_t uiSize)
+  {
+    assert(uiSize <= MAX_PAYLOAD_HEADER_SIZE);
+    memcpy(m_aPayloadHeader, pHeader, uiSize);
+    m_uiPayloadHeaderSize = static_cast<uint8_t>(uiSize);
+  }
+  const uint8_t* getPayloadHeader() const { return m_aPayloadHeader; }
+  uint32_t getPayloadHeaderSize() const { return m_uiPayloadHeaderSize; }
+  /**
+   * @brief addPayloadSegment appends uiPrefixSize bytes followed by data to the payload
+   */
+  void addPayloadSegment(const uint8_t* pPrefix, uint32_t uiPrefixSize, Buffer data)
+  {
+    assert(uiPrefixSize <= PayloadSegment::MAX_PREFIX_SIZE);
+    m_vPayloadSegments.push_back(PayloadSegment());
+    PayloadSegment& segment = m_vPayloadSegments.back();
+    memcpy(segment.Prefix, pPrefix, uiPrefixSize);
+    segment.PrefixSize = static_cast<uint8_t>(uiPrefixSize);
+    segment.Data = std::move(data);
+  }
+  const std::vector<PayloadSegment>& getPayloadSegments() const { return m_vPayloadSegments; }
+  /**
+   * @brief isPayloadGathered returns true if the payload consists of more than the payload buffer
+   */
+  bool isPayloadGathered() const { return m_uiPayloadHeaderSize > 0 || !m_vPayloadSegments.empty(); }
+  /**
+   * @brief writePayload joins the payload header, payload and segments at pDest which
+   * must have space for getPayloadSize() bytes
+   * @return the number of bytes written
+   */
+  uint32_t writePayload(uint8_t* pDest) const
+  {
+    uint32_t uiOffset = m_uiPayloadHeaderSize;
+    memcpy(pDest, m_aPayloadHeader, m_uiPayloadHeaderSize);
+    memcpy(pDest + uiOffset, m_rtpPayload.data(), m_rtpPayload.getSize());
+    uiOffset += m_rtpPayload.getSize();
+    for (const PayloadSegment& segment : m_vPayloadSegments)
+    {
+      memcpy(pDest + uiOffset, segment.Prefix, segment.PrefixSize);
+      uiOffset += segment.PrefixSize;
+      memcpy(pDest + uiOffset, segment.Data.data(), segment.Data.getSize());
+      uiOffset += segment.Data.getSize();
+    }
+    return uiOffset;
+  }
+  /**
+   * @brief getContiguousPayload returns the payload in one buffer. Gathered payloads
+   * are copied into a new buffer.
+   */
+  Buffer getContiguousPayload() const
+  {
+    if (!isPayloadGathered()) return m_rtpPayload;
+    const uint32_t uiSize = getPayloadSize();
+    Buffer payload(new uint8_t[uiSize], uiSize);
+    writePayload(&payload[0]);
+    return payload;
+  }
   /**
    * @brief getRawRtpPacketData Getter for raw packet data
    * @return
@@ -137,35 +335,53 @@ public:
    * @brief setRawRtpPacketData Setter for raw packet data
    * @param rtpData
    */
-  void setRawRtpPacketData(Buffer rtpData){ m_rawRtpPacketData = rtpData; }
+  void setRawRtpPacketData(Buffer rtpData){ m_rawRtpPacketData = std::move(rtpData); }
   /**
    * @brief getSize Getter for size including header and payload
    * @return
    */
   uint32_t getSize() const
   {
-    return m_header.getSize() + m_rtpPayload.getSize();
+    return m_header.getSize() + getPayloadSize();
   }
   /**
    * @brief getArrivalTime Getter for arrival time
    * @return
    */
-  boost::posix_time::ptime getArrivalTime() const { return m_tArrival; }
+  boost::posix_time::ptime getArrivalTime() const { return Clock::toPosixTime(m_iArrivalTimeNs); }
   /**
    * @brief setArrivalTime Setter for packet arrival time
    * @param tArrival
    */
-  void setArrivalTime(const boost::posix_time::ptime& tArrival) { m_tArrival = tArrival; }
+  void setArrivalTime(const boost::posix_time::ptime& tArrival) { m_iArrivalTimeNs = Clock::fromPosixTime(tArrival); }
+  /**
+   * @brief getArrivalTimeNs Getter for arrival time in nanoseconds since the unix epoch
+   * @return 0 if the arrival time has not been set
+   */
+  int64_t getArrivalTimeNs() const { return m_iArrivalTimeNs; }
+  /**
+   * @brief setArrivalTimeNs Setter for arrival time in nanoseconds since the unix epoch
+   * @param iArrivalTimeNs
+   */
+  void setArrivalTimeNs(int64_t iArrivalTimeNs) { m_iArrivalTimeNs = iArrivalTimeNs; }
   /**
    * @brief getSendTime
    * @return
    */
-  boost::posix_time::ptime getSendTime() const { return m_tSent; }
+  boost::posix_time::ptime getSendTime() const { return Clock::toPosixTime(m_iSendTimeNs); }
   /**
    * @brief setArrivalTime
    * @param tSent
    */
-  void setSendTime(const boost::posix_time::ptime& tSent) { m_tSent = tSent; }
+  void setSendTime(const boost::posix_time::ptime& tSent) { m_iSendTimeNs = Clock::fromPosixTime(tSent); }
+  /**
+   * @brief getSendTimeNs Getter for send time in nanoseconds since the unix epoch
+   */
+  int64_t getSendTimeNs() const { return m_iSendTimeNs; }
+  /**
+   * @brief setSendTimeNs Setter for send time in nanoseconds since the unix epoch
+   */
+  void setSendTimeNs(int64_t iSendTimeNs) { m_iSendTimeNs = iSendTimeNs; }
   /**
    * @brief getNtpArrivalTime Getter for arrival time as NTP timestamp
    * @return
@@ -231,30 +447,36 @@ public:
   }
 
 private:
+  // members are ordered so that the fields used per packet share the first cache lines
   /// RTP header
   rfc3550::RtpHeader m_header;
   /// payload
   Buffer m_rtpPayload;
-  /// arrival time ptime
-  boost::posix_time::ptime m_tArrival;
-  /// send time ptime
-  boost::posix_time::ptime m_tSent;
+  /// extended RTP SN
+  uint32_t m_uiExtendedSequenceNumber;
   /// arrival time RTP
   uint32_t m_uiRtpArrivalTimestamp;
+  /// Id: to be used for miscellaneous reasons
+  int32_t m_iId;
+  /// arrival time in ns since the unix epoch
+  int64_t m_iArrivalTimeNs;
+  /// send time in ns since the unix epoch
+  int64_t m_iSendTimeNs;
   /// arrival time NTP
   uint64_t m_tNtpArrival;
-  /// extended RTP SN
-  uint32_t m_uiExtendedSequenceNumber;
   /// OWD
   double m_dOwdSeconds;
   /// optional buffer to store the raw RTP data
   Buffer m_rawRtpPacketData;
-  /// Id: to be used for miscellaneous reasons
-  int32_t m_iId;
   /// optional source endpoint
   EndPoint m_source;
   /// MPRTP
   boost::optional<mprtp::MpRtpSubflowRtpHeader> m_pMpRtpSubflow;
+  /// payload header for gathering
+  uint8_t m_aPayloadHeader[MAX_PAYLOAD_HEADER_SIZE];
+  uint8_t m_uiPayloadHeaderSize;
+  /// payload segments for gathering
+  std::vector<PayloadSegment> m_vPayloadSegments;
 };
 
 } // rtp_plus_plus
@@ -2,8 +2,10 @@
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include <boost/function.hpp>
 #include <boost/optional.hpp>
 #include <cpputil/Buffer.h>
+#include <rtp++/RtcpCompoundView.h>
 #include <rtp++/RtcpPacketBase.h>
 #include <rtp++/RtcpParserInterface.h>
 #include <rtp++/RtpPacket.h>
@@ -17,6 +19,12 @@ class IBitStream;
 namespace rtp_plus_plus
 {
 
+/**
+ * @brief Handler for generic NACKs and ACKs that are read in place when depacketising RTCP.
+ * The view is only valid for the duration of the call.
+ */
+typedef boost::function<void (const RtcpFbView&)> RtcpFbViewHandler_t;
+
 /**
  * @brief The RtpPacketiser class
  * Implementation of RFC3550 RTP/RTCP packetisation
@@ -103,6 +111,21 @@ public:
    * @return
    */
   static Buffer packetise(CompoundRtcpPacket rtcpPackets, uint32_t uiPreferredBufferSize);
+  /**
+   * @brief Packetises a compound RTCP packet followed by feedback messages that have
+   * already been written with RtcpCompoundWriter
+   * @param rtcpPackets A compound RTCP packet. This may be empty for reduced size RTCP.
+   * @param feedback The packets written by RtcpCompoundWriter
+   */
+  static Buffer packetise(CompoundRtcpPacket rtcpPackets, const Buffer& feedback);
+  /**
+   * @brief packetise
+   * @param rtcpPackets
+   * @param feedback
+   * @param uiPreferredBufferSize
+   * @return
+   */
+  static Buffer packetise(CompoundRtcpPacket rtcpPackets, const Buffer& feedback, uint32_t uiPreferredBufferSize);
   /**
    * @fn  boost::optional<RtpPacket> RtpPacketiser::depacketise(Buffer buffer);
    *
@@ -145,6 +168,21 @@ public:
    * @return A compound RTCP packet containing all successfully parsed and validated RTCP packets.
    */
   CompoundRtcpPacket depacketiseRtcp(NetworkPacket networkPacket);
+  /**
+   * @brief Depacketises a compound RTCP packet and passes generic NACKs and ACKs to onFb
+   * instead of creating RtcpPacketBase objects for them.
+   *
+   * The compound packet is validated with RtcpValidator::validateCompoundRtcpView before
+   * onFb is called. The NACKs and ACKs are only passed on if a registered parser supports
+   * generic feedback.
+   *
+   * @param networkPacket Packet received from the network.
+   * @param onFb The handler for generic NACKs and ACKs
+   *
+   * @return A compound RTCP packet containing the remaining parsed RTCP packets. This is empty
+   * if the compound packet was invalid or if it only contained packets passed to onFb.
+   */
+  CompoundRtcpPacket depacketiseRtcp(NetworkPacket networkPacket, const RtcpFbViewHandler_t& onFb);
   /**
    * @fn  CompoundRtcpPacket RtpPacketiser::parseRtcpPacket(IBitStream& ib);
    *
@@ -155,10 +193,25 @@ public:
    * @return The parsed RTCP packet is returned on success, otherwise a null pointer is returned
    */
   RtcpPacketBase::ptr parseRtcpPacket(IBitStream& ib);
+  /**
+   * @brief Creates the RtcpPacketBase object for a packet of a compound packet that has been
+   * indexed with RtcpCompoundView using the registered RTCP parsers.
+   *
+   * This allows callers to inspect the views first and to only create objects where required.
+   *
+   * @param buffer The buffer that compoundView was parsed from
+   * @param compoundView The indexed compound packet
+   * @param uiIndex The index of the packet in compoundView
+   *
+   * @return The parsed RTCP packet on success, otherwise a null pointer.
+   */
+  RtcpPacketBase::ptr createRtcpPacket(const Buffer& buffer, const RtcpCompoundView& compoundView, uint32_t uiIndex);
 
 private:
 
   void registerDefaultRtcpParser();
+  /// writes rtpPacket into buffer which must be rtpPacket.getSize() bytes long
+  static void writeRtpPacket(const RtpPacket& rtpPacket, Buffer& buffer);
 
   /// iterates over registered RTCP parser and returns vector containing indices of capable parsers
   /// returns empty vector if no such parser is registered
@@ -167,7 +220,9 @@ private:
   // convenience methods that set the arrival time
   boost::optional<RtpPacket> doDepacketise(Buffer buffer);
   // unknown RTCP reports are ignored
-  CompoundRtcpPacket doDepacketiseRtcp(Buffer buffer);
+  CompoundRtcpPacket doDepacketiseRtcp(Buffer buffer, const RtcpFbViewHandler_t& onFb = RtcpFbViewHandler_t());
+  /// returns true if the packet is a generic NACK or ACK that a registered parser supports
+  bool isGenericFeedback(const RtcpPacketView& packet) const;
 
 private:
   std::vector<std::unique_ptr<RtcpParserInterface> > m_vRtcpParsers;
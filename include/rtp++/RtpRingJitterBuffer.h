@@ -0,0 +1,168 @@
+#pragma once
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <boost/circular_buffer.hpp>
+#include <boost/thread/mutex.hpp>
+#include <rtp++/IRtpJitterBuffer.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The RtpRingJitterBuffer class stores received RTP packets in a power-of-two ring
+ * that is indexed by extended sequence number. Frame boundaries (RTP timestamps) are tracked
+ * separately, and an RtpPacketGroup is only built once a frame is played out.
+ *
+ * Insertion, duplicate detection and late detection only touch the slot of the packet
+ * and its neighbours. Playout semantics are the same as those of RtpJitterBufferV2.
+ * This class is designed for a single RTP session.
+ */
+class RtpRingJitterBuffer : public IRtpJitterBuffer
+{
+public:
+  typedef std::unique_ptr<RtpRingJitterBuffer> ptr;
+
+  /// default number of slots in the ring: must be a power of two
+  static const uint32_t DEFAULT_CAPACITY = 2048;
+
+  static ptr create(uint32_t uiPlayoutBufferLatency = IRtpJitterBuffer::MAX_LATENCY_MS,
+                    uint32_t uiCapacity = DEFAULT_CAPACITY);
+  /**
+   * @brief Constructor
+   * @param uiCapacity The number of slots in the ring. This is rounded up to the next
+   * power of two and bounds the number of packets that can be buffered.
+   */
+  RtpRingJitterBuffer(uint32_t uiPlayoutBufferLatency = IRtpJitterBuffer::MAX_LATENCY_MS,
+                      uint32_t uiCapacity = DEFAULT_CAPACITY);
+  ~RtpRingJitterBuffer();
+
+  uint32_t getCapacity() const { return static_cast<uint32_t>(m_vSlots.size()); }
+
+  virtual const RtpPacketGroup getNextPlayoutBufferNode();
+
+protected:
+  virtual boost::posix_time::ptime calculatePlayoutTime(const RtpPacket& packet,
+                                                        const boost::posix_time::ptime& tPresentation,
+                                                        bool bRtcpSynchronised);
+
+  virtual bool doAddRtpPacket(const RtpPacket& packet,
+                              const boost::posix_time::ptime& tPresentation,
+                              bool bRtcpSynchronised,
+                              const boost::posix_time::ptime& tPlayout,
+                              uint32_t& uiLateMs, bool &bDuplicate);
+
+private:
+  enum SlotState
+  {
+    SLOT_EMPTY,
+    SLOT_BUFFERED,
+    SLOT_PLAYED
+  };
+
+  /**
+   * @brief A slot of the ring. Played slots keep the SN and RTP TS until they are
+   * overwritten so that late packets can still be identified as duplicates. The
+   * packet itself is released on playout.
+   */
+  struct Slot
+  {
+    Slot()
+      :ExtendedSN(0),
+      RtpTs(0),
+      State(SLOT_EMPTY)
+    {
+    }
+    uint32_t ExtendedSN;
+    uint32_t RtpTs;
+    SlotState State;
+    RtpPacket Packet;
+  };
+
+  /**
+   * @brief A frame consists of all packets with the same RTP timestamp
+   */
+  struct Frame
+  {
+    Frame(uint32_t uiExtendedSN, const boost::posix_time::ptime& tPresentation,
+          bool bRtcpSynchronised, const boost::posix_time::ptime& tPlayout)
+      :Presentation(tPresentation),
+      RtcpSynchronised(bRtcpSynchronised),
+      Playout(tPlayout),
+      FirstSN(uiExtendedSN),
+      LastSN(uiExtendedSN)
+    {
+    }
+    boost::posix_time::ptime Presentation;
+    bool RtcpSynchronised;
+    boost::posix_time::ptime Playout;
+    // lowest and highest extended SN received for the frame
+    uint32_t FirstSN;
+    uint32_t LastSN;
+  };
+
+  Slot& getSlot(uint32_t uiExtendedSN) { return m_vSlots[uiExtendedSN & m_uiMask]; }
+  /**
+   * @brief returns true if the slot can store the packet with uiExtendedSN
+   * without overwriting a buffered packet.
+   */
+  bool isSlotAvailable(const Slot& slot, uint32_t uiExtendedSN) const
+  {
+    return slot.State != SLOT_BUFFERED || slot.ExtendedSN == uiExtendedSN;
+  }
+  /**
+   * @brief checks the neighbouring slots and then the recent history for an
+   * already played frame with the RTP timestamp of the packet.
+   */
+  bool hasBeenPlayedOut(const RtpPacket& packet);
+  /**
+   * @brief inserts the RTP timestamp into the playout order according to presentation time.
+   */
+  void insertAccordingToPts(uint32_t uiRtpTs, const boost::posix_time::ptime& tPresentation);
+
+  // lock for multi-threaded access
+  mutable boost::mutex m_listLock;
+
+  // the ring: the size is a power of two
+  std::vector<Slot> m_vSlots;
+  uint32_t m_uiMask;
+  // frames that have not been played out yet, keyed by RTP TS
+  std::unordered_map<uint32_t, Frame> m_mFrames;
+  // RTP timestamps of the buffered frames ordered by presentation time
+  std::deque<uint32_t> m_qPlayoutOrder;
+
+  // arrival time of first packet
+  boost::posix_time::ptime m_tFirstPacket;
+  // presentation time of first packet
+  boost::posix_time::ptime m_tFirstPts;
+  // presentation time of first RTCP synced packet
+  boost::posix_time::ptime m_tFirstSyncedPts;
+  // first RTP TS
+  uint32_t m_uiFirstRtpTs;
+  // RTP TS offset between first RTP packet, and first RTCP synced RTP packet
+  uint32_t m_uiRtpDiffMs;
+
+  // For stats
+  // 1st SN
+  uint32_t m_uiFirstSN;
+  // Last SN
+  uint32_t m_uiLastSN;
+  uint32_t m_uiTotalPackets;
+  // discard characteristics
+  uint32_t m_uiTotalLatePackets;
+  // duplicates
+  uint32_t m_uiTotalDuplicates;
+  // packets that were discarded because the ring was full
+  uint32_t m_uiTotalOverflows;
+
+  /// Flag for RTCP sync
+  bool m_bRtcpSync;
+
+  /**
+   * @brief m_recentHistory: RTP timestamps of recently played frames.
+   * This is only consulted if the neighbouring slots do not identify a late packet.
+   */
+  boost::circular_buffer<uint32_t> m_recentHistory;
+};
+
+} // rtp_plus_plus
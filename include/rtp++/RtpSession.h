@@ -45,7 +45,7 @@ public:
   typedef boost::function<void (const RtpPacket&, const EndPoint& ep,
                                 bool bSSRCValidated, bool bRtcpSynchronised,
                                 const boost::posix_time::ptime&)> IncomingRtpCb_t;
-  typedef boost::function<void (const RtpPacket&, rfc5285::HeaderExtensionElement&)> ExtensionHeaderCb_t;
+  typedef boost::function<void (const RtpPacket&, const rfc5285::HeaderExtensionElementView&)> ExtensionHeaderCb_t;
   /**
    * @brief create
    * @param rIoService
@@ -198,6 +198,11 @@ public:
    * @brief Setter for callback for incoming RTCP packets. The calling class must configure these callbacks
    */
   void setIncomingRtcpHandler(CompoundRtcpCb_t incomingRtcp) { m_incomingRtcp = incomingRtcp; }
+  /**
+   * @brief Setter for callback for incoming generic NACKs and ACKs. If this is set before the network
+   * interfaces are initialised, they are read in place and not passed to the incoming RTCP handler.
+   */
+  void setIncomingFbHandler(RtcpFbCb_t incomingFb) { m_incomingFb = incomingFb; }
   /**
    * @brief Setter for callback before outgoing RTP packets. The calling class must configure these callbacks
    */
@@ -214,7 +219,7 @@ public:
    * @brief setFeedbackCallback Setter for feedback callback
    * @param onFeedback
    */
-  void setFeedbackCallback(rfc4585::FeedbackCallback_t onFeedback) { m_onFeedback = onFeedback; }
+  void setFeedbackCallback(rfc4585::FeedbackWriterCallback_t onFeedback) { m_onFeedback = onFeedback; }
   /**
    * @brief setMpFeedbackCallback Setter for multipath feedback callback
    * @param onMpFeedback
@@ -388,6 +393,12 @@ protected:
    * @param ep
    */
   void onIncomingRtcp( const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep );
+  /**
+   * @brief onIncomingFb
+   * @param fb
+   * @param ep
+   */
+  void onIncomingFb( const RtcpFbView& fb, const EndPoint& ep );
   /**
    * @brief onOutgoingRtcp
    * @param compoundRtcp
@@ -406,13 +417,13 @@ private:
    * @param rtpPacket
    * @param extensionHeader
    */
-  void handleRapidSyncRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader);
+  void handleRapidSyncRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader);
   /**
    * @brief handleRtcpRtpExtensionHeader
    * @param rtpPacket
    * @param extensionHeader
    */
-  void handleRtcpRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader);
+  void handleRtcpRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader);
   /**
    * @brief generateMpRtpExtensionHeader generates an MPRTP header extension
    * @param uiSubflowId Subflow Id of the header to be generated
@@ -440,7 +451,7 @@ private:
    * @param rtpPacket
    * @param extensionHeader
    */
-  void handleMpRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader);
+  void handleMpRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader);
   /**
    * This method is periodically called when RTCP reports are generated
    * @param uiSN the sequence number of the RTP packet assumed to be lost that was a false positive
@@ -453,11 +464,19 @@ private:
    * @param rtcpEp
    */
   void onRtcpReportGeneration( const CompoundRtcpPacket& rtcp, uint32_t uiInterfaceIndex, const EndPoint& rtcpEp );
+  /**
+   * @brief onRtcpReportGeneration is called for RTCP reports that are followed by feedback
+   * written with RtcpCompoundWriter
+   * @param rtcp
+   * @param feedback
+   */
+  void onRtcpReportGeneration( const CompoundRtcpPacket& rtcp, const Buffer& feedback );
   /**
    * @brief onGenerateFeedback
    * @param feedback
+   * @param writer
    */
-  void onGenerateFeedback(CompoundRtcpPacket& feedback);
+  void onGenerateFeedback(CompoundRtcpPacket& feedback, RtcpCompoundWriter& writer);
   /**
    * @brief onGenerateFeedbackMpRtp
    * @param uiFlowId
@@ -532,6 +551,8 @@ protected:
   SessionState m_state;
   // RTP dynamic state
   RtpSessionState m_rtpSessionState;
+  // converts arrival times to RTP timestamps
+  RtpTimestampConverter m_arrivalTimestampConverter;
 
   /// flag that gets cleared when packets arrive from an unknown source
   /// and is set on validation
@@ -562,10 +583,11 @@ protected:
 
   IncomingRtpCb_t m_incomingRtp;
   CompoundRtcpCb_t m_incomingRtcp;
+  RtcpFbCb_t m_incomingFb;
   RtpCb_t m_beforeOutgoingRtp;
   RtpCb_t m_afterOutgoingRtp;
   CompoundRtcpCb_t m_outgoingRtcp;
-  rfc4585::FeedbackCallback_t m_onFeedback;
+  rfc4585::FeedbackWriterCallback_t m_onFeedback;
   mprtp::MpFeedbackCallback_t m_onMpFeedback;
 
   // Callback for member updates
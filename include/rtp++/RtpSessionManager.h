@@ -7,6 +7,7 @@
 #include <rtp++/RtpSession.h>
 #include <rtp++/rfc3611/RtcpXr.h>
 #include <rtp++/rfc4585/RtcpFb.h>
+#include <rtp++/util/TimerService.h>
 
 namespace rtp_plus_plus
 {
@@ -107,6 +108,10 @@ private:
   void handleOutgoingRtp(const RtpPacket& rtpPacket, const EndPoint& ep);
 
   void handleIncomingRtcp(const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep);
+  /**
+   * @brief handles generic NACKs and ACKs that are read in place without creating RtcpFb objects
+   */
+  void handleIncomingFb(const RtcpFbView& fb, const EndPoint& ep);
 
   void handleOutgoingRtcp(const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep);
 
@@ -123,7 +128,7 @@ private:
   virtual void doHandleXr(const rfc3611::RtcpXr& xr, const EndPoint& ep);
   virtual void doHandleFb(const rfc4585::RtcpFb& fb, const EndPoint& ep);
 
-  virtual void onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp);
+  virtual void onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp, RtcpCompoundWriter& writer);
   virtual void onMpFeedbackGeneration(uint16_t uiFlowId, CompoundRtcpPacket& compoundRtcp);
 
   void onPacketAssumedLost(uint16_t uiSN);
@@ -132,10 +137,8 @@ private:
    * @brief This method is called when the sample exits the jitter buffer. These deadlines
    * are based on a relative offset to the time that the first RTP packet was received.
    * @param ec the boost asio timer error code
-   * @param pTimer a pointer to the timer used for this timeout
    */
-  void onScheduledSampleTimeout(const boost::system::error_code& ec,
-                                boost::asio::deadline_timer* pTimer);
+  void onScheduledSampleTimeout(const boost::system::error_code& ec);
   /**
    * @brief prepareSampleForOutput should be called by subclasses once a media sample
    * or access unit is ready for output
@@ -164,10 +167,10 @@ protected:
   std::unique_ptr<TransmissionManager> m_pTxManager;
   /// FB management: TODO: rename to loss manager and abstract feedback out into feedback interface
   std::unique_ptr<IFeedbackManager> m_pFeedbackManager;
-  /// Lock for timer map
-  mutable boost::mutex m_timerLock;
-  /// Timers for scheduled media sample delivery to application layer
-  std::unordered_map<boost::asio::deadline_timer*, boost::asio::deadline_timer*> m_mPlayoutTimers;
+  /// Shared timer service for scheduled media sample delivery to application layer
+  TimerService& m_rTimerService;
+  /// Timer group of the scheduled media sample deliveries
+  uint32_t m_uiPlayoutTimerGroup;
   /// Lock for media sample queue
   mutable boost::mutex m_outgoingSampleLock;
   /// Outgoing media sample queue
@@ -207,6 +210,9 @@ protected:
   // Map to store RTX times
   std::unordered_map<uint16_t, boost::posix_time::ptime> m_mRtxDurationMap;
   std::unordered_map<uint32_t, boost::posix_time::ptime> m_mFlowSpecificRtxDurationMap;
+  // sequence numbers of received and generated generic NACKs and ACKs: reused to avoid allocations
+  std::vector<uint16_t> m_vIncomingFbSNs;
+  std::vector<uint16_t> m_vOutgoingFbSNs;
 };
 
 } // rtp_plus_plus
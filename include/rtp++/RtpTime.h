@@ -80,6 +80,13 @@ static void convertToNtpTimestamp(boost::posix_time::ptime t1, uint32_t& uiNtpMs
 
 static boost::posix_time::ptime convertNtpTimestampToPosixTime(uint64_t uiNtp);
 static boost::posix_time::ptime convertNtpTimestampToPosixTime(uint32_t uiNtpMsw, uint32_t uiNtpLsw);
+/**
+ * @brief convertUnixTimeToNtpTimestamp converts a time since the unix epoch e.g. a kernel timestamp
+ * @param uiSeconds Seconds since 1970
+ * @param uiNanoseconds Nanoseconds part
+ * @return 64-bit NTP timestamp
+ */
+static uint64_t convertUnixTimeToNtpTimestamp(uint64_t uiSeconds, uint32_t uiNanoseconds);
 static void getNTPTimeStamp(uint64_t& uiNtpTime);
 static void getNTPTimeStamp(uint32_t& uiNtpMsw, uint32_t& uiNtpLsw);
 
@@ -106,6 +113,48 @@ static boost::posix_time::ptime getPresentationTime(uint32_t uiRtpSyncRef, const
  * @return True if the difference between two presentation times is less than 12 microseconds, false otherwise
  */
 static bool presentationTimeMatch(const boost::posix_time::ptime& t1, const boost::posix_time::ptime& t2);
+/**
+ * @brief convertUnixNsToNtpTimestamp converts nanoseconds since the unix epoch (see Clock) to a 64-bit NTP timestamp
+ */
+static uint64_t convertUnixNsToNtpTimestamp(int64_t iUnixNs);
+/**
+ * @brief convertNtpTimestampToUnixNs converts a 64-bit NTP timestamp to nanoseconds since the unix epoch
+ */
+static int64_t convertNtpTimestampToUnixNs(uint64_t uiNtp);
+};
+
+/**
+ * @brief The RtpTimestampConverter class converts between nanoseconds and RTP timestamps
+ * of one clock rate with integer arithmetic.
+ *
+ * Conversions to RTP timestamps do not need floating point or a division by the
+ * clock rate, which makes them cheap enough for per packet arrival timestamps.
+ */
+class RtpTimestampConverter
+{
+public:
+  explicit RtpTimestampConverter(uint32_t uiTimestampFrequency = 90000);
+
+  uint32_t getTimestampFrequency() const { return m_uiTimestampFrequency; }
+  /**
+   * @brief toRtpTimestamp converts a time in nanoseconds to an RTP timestamp with uiTimestampBase as offset
+   */
+  uint32_t toRtpTimestamp(int64_t iTimeNs, uint32_t uiTimestampBase) const;
+  /**
+   * @brief toNs converts a signed difference of RTP timestamps to nanoseconds
+   */
+  int64_t toNs(int32_t iRtpTimestampDiff) const;
+  /**
+   * @brief getPresentationTime returns the presentation time of uiRtpTs in nanoseconds
+   * given a reference RTP timestamp and its presentation time
+   */
+  int64_t getPresentationTime(uint32_t uiRtpSyncRef, int64_t iSyncRefNs, uint32_t uiRtpTs) const
+  {
+    return iSyncRefNs + toNs(static_cast<int32_t>(uiRtpTs - uiRtpSyncRef));
+  }
+
+private:
+  uint32_t m_uiTimestampFrequency;
 };
 
 } // rtp_plus_plus
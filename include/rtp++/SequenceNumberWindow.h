@@ -0,0 +1,275 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The SequenceNumberWindow class is a fixed-size sliding bitmap keyed by extended
+ * RTP sequence number.
+ *
+ * One bit is kept for each of the last WINDOW_SIZE sequence numbers up to and including
+ * the highest one seen. Marking a sequence number beyond the highest slides the window
+ * forward and forgets the sequence numbers that drop out of it, so memory use is fixed
+ * regardless of the session length. Range queries are answered a word at a time using
+ * count trailing zeros and population count.
+ *
+ * The meaning of a mark is up to the caller: the LossEstimator marks received packets and
+ * scans for gaps while the rfc4585::FeedbackManager marks packets assumed lost.
+ */
+class SequenceNumberWindow
+{
+public:
+  /// number of sequence numbers covered by the window: must be a multiple of 64
+  static const uint32_t WINDOW_SIZE = 4096;
+
+  SequenceNumberWindow()
+  {
+    reset();
+  }
+  /**
+   * @brief reset clears all marks and the window position
+   */
+  void reset()
+  {
+    memset(m_aWords, 0, sizeof(m_aWords));
+    m_bEmpty = true;
+    m_uiHighest = 0;
+    m_uiCount = 0;
+  }
+  /**
+   * @brief isEmpty returns true if nothing has been marked since the last reset
+   */
+  bool isEmpty() const { return m_bEmpty; }
+  /**
+   * @brief getHighest returns the highest sequence number marked since the last reset
+   */
+  uint32_t getHighest() const { return m_uiHighest; }
+  /**
+   * @brief getLowest returns the lowest sequence number still covered by the window
+   */
+  uint32_t getLowest() const
+  {
+    return m_uiHighest >= WINDOW_SIZE - 1 ? m_uiHighest - (WINDOW_SIZE - 1) : 0;
+  }
+  /**
+   * @brief getCount returns the number of marked sequence numbers in the window
+   */
+  uint32_t getCount() const { return m_uiCount; }
+  /**
+   * @brief contains returns true if uiSN is covered by the window
+   */
+  bool contains(uint32_t uiSN) const
+  {
+    return !m_bEmpty && uiSN <= m_uiHighest && uiSN >= getLowest();
+  }
+  /**
+   * @brief extend maps a 16-bit sequence number to the extended sequence number closest
+   * to the highest one in the window
+   */
+  uint32_t extend(uint16_t uiSN) const
+  {
+    int16_t iDelta = static_cast<int16_t>(uiSN - static_cast<uint16_t>(m_uiHighest));
+    return m_uiHighest + iDelta;
+  }
+  /**
+   * @brief mark marks uiSN. Sequence numbers that have already dropped out of the window
+   * are ignored.
+   * @return true if uiSN was not marked before
+   */
+  bool mark(uint32_t uiSN)
+  {
+    if (m_bEmpty)
+    {
+      m_bEmpty = false;
+      m_uiHighest = uiSN;
+    }
+    else if (uiSN > m_uiHighest)
+    {
+      advance(uiSN);
+    }
+    else if (uiSN < getLowest())
+    {
+      return false;
+    }
+    uint64_t& uiWord = word(uiSN);
+    const uint64_t uiBit = bit(uiSN);
+    if (uiWord & uiBit) return false;
+    uiWord |= uiBit;
+    ++m_uiCount;
+    return true;
+  }
+  /**
+   * @brief unmark clears the mark of uiSN
+   * @return true if uiSN was marked
+   */
+  bool unmark(uint32_t uiSN)
+  {
+    if (!contains(uiSN)) return false;
+    uint64_t& uiWord = word(uiSN);
+    const uint64_t uiBit = bit(uiSN);
+    if (!(uiWord & uiBit)) return false;
+    uiWord &= ~uiBit;
+    --m_uiCount;
+    return true;
+  }
+  /**
+   * @brief isMarked returns true if uiSN is in the window and marked
+   */
+  bool isMarked(uint32_t uiSN) const
+  {
+    return contains(uiSN) && (m_aWords[index(uiSN)] & bit(uiSN)) != 0;
+  }
+  /**
+   * @brief countMarked counts the marked sequence numbers in [uiFrom, uiTo)
+   */
+  uint32_t countMarked(uint32_t uiFrom, uint32_t uiTo) const
+  {
+    uint32_t uiCount = 0;
+    scan(uiFrom, uiTo, false, [&uiCount](uint32_t, uint64_t uiBits)
+    {
+      uiCount += popcount(uiBits);
+    });
+    return uiCount;
+  }
+  /**
+   * @brief countUnmarked counts the sequence numbers in [uiFrom, uiTo) that are in the
+   * window and not marked
+   */
+  uint32_t countUnmarked(uint32_t uiFrom, uint32_t uiTo) const
+  {
+    uint32_t uiCount = 0;
+    scan(uiFrom, uiTo, true, [&uiCount](uint32_t, uint64_t uiBits)
+    {
+      uiCount += popcount(uiBits);
+    });
+    return uiCount;
+  }
+  /**
+   * @brief forEachMarked calls f(uiSN) in ascending order for each marked sequence
+   * number in [uiFrom, uiTo)
+   */
+  template <typename F>
+  void forEachMarked(uint32_t uiFrom, uint32_t uiTo, F f) const
+  {
+    scan(uiFrom, uiTo, false, [&f](uint32_t uiBase, uint64_t uiBits)
+    {
+      for (; uiBits; uiBits &= uiBits - 1)
+        f(uiBase + ctz(uiBits));
+    });
+  }
+  /**
+   * @brief forEachUnmarked calls f(uiSN) in ascending order for each sequence number in
+   * [uiFrom, uiTo) that is in the window and not marked
+   */
+  template <typename F>
+  void forEachUnmarked(uint32_t uiFrom, uint32_t uiTo, F f) const
+  {
+    scan(uiFrom, uiTo, true, [&f](uint32_t uiBase, uint64_t uiBits)
+    {
+      for (; uiBits; uiBits &= uiBits - 1)
+        f(uiBase + ctz(uiBits));
+    });
+  }
+  /**
+   * @brief unmarkAll clears all marks while keeping the window position
+   */
+  void unmarkAll()
+  {
+    memset(m_aWords, 0, sizeof(m_aWords));
+    m_uiCount = 0;
+  }
+
+private:
+  static const uint32_t WORD_COUNT = WINDOW_SIZE / 64;
+
+  static uint32_t index(uint32_t uiSN) { return (uiSN >> 6) & (WORD_COUNT - 1); }
+  static uint64_t bit(uint32_t uiSN) { return 1ULL << (uiSN & 63); }
+  uint64_t& word(uint32_t uiSN) { return m_aWords[index(uiSN)]; }
+
+  static uint32_t ctz(uint64_t uiBits)
+  {
+#ifdef _MSC_VER
+    unsigned long uiIndex;
+    _BitScanForward64(&uiIndex, uiBits);
+    return uiIndex;
+#else
+    return __builtin_ctzll(uiBits);
+#endif
+  }
+
+  static uint32_t popcount(uint64_t uiBits)
+  {
+#ifdef _MSC_VER
+    return static_cast<uint32_t>(__popcnt64(uiBits));
+#else
+    return __builtin_popcountll(uiBits);
+#endif
+  }
+  /**
+   * @brief scan calls f(uiBase, uiBits) for each word overlapping [uiFrom, uiTo) clipped
+   * to the window, where bit i of uiBits stands for uiBase + i. If bInvert is set the
+   * unmarked bits are passed instead of the marked ones.
+   */
+  template <typename F>
+  void scan(uint32_t uiFrom, uint32_t uiTo, bool bInvert, F f) const
+  {
+    if (m_bEmpty) return;
+    const uint32_t uiLowest = getLowest();
+    if (uiFrom < uiLowest) uiFrom = uiLowest;
+    if (uiTo > m_uiHighest + 1) uiTo = m_uiHighest + 1;
+
+    while (uiFrom < uiTo)
+    {
+      const uint32_t uiOffset = uiFrom & 63;
+      const uint32_t uiRemaining = uiTo - uiFrom;
+      const uint32_t uiBitCount = uiRemaining < 64 - uiOffset ? uiRemaining : 64 - uiOffset;
+      const uint64_t uiMask = (uiBitCount == 64 ? ~0ULL : ((1ULL << uiBitCount) - 1)) << uiOffset;
+      uint64_t uiBits = m_aWords[index(uiFrom)];
+      if (bInvert) uiBits = ~uiBits;
+      uiBits &= uiMask;
+      if (uiBits) f(uiFrom - uiOffset, uiBits);
+      uiFrom += uiBitCount;
+    }
+  }
+  /**
+   * @brief advance slides the window so that uiSN becomes the highest sequence number,
+   * clearing the bits of the sequence numbers that drop out
+   */
+  void advance(uint32_t uiSN)
+  {
+    if (uiSN - m_uiHighest >= WINDOW_SIZE)
+    {
+      unmarkAll();
+    }
+    else
+    {
+      // the slots of (highest, uiSN] were last used by sequence numbers WINDOW_SIZE earlier
+      uint32_t uiFrom = m_uiHighest + 1;
+      const uint32_t uiTo = uiSN + 1;
+      while (uiFrom < uiTo)
+      {
+        const uint32_t uiOffset = uiFrom & 63;
+        const uint32_t uiRemaining = uiTo - uiFrom;
+        const uint32_t uiBitCount = uiRemaining < 64 - uiOffset ? uiRemaining : 64 - uiOffset;
+        const uint64_t uiMask = (uiBitCount == 64 ? ~0ULL : ((1ULL << uiBitCount) - 1)) << uiOffset;
+        uint64_t& uiWord = word(uiFrom);
+        m_uiCount -= popcount(uiWord & uiMask);
+        uiWord &= ~uiMask;
+        uiFrom += uiBitCount;
+      }
+    }
+    m_uiHighest = uiSN;
+  }
+
+  uint64_t m_aWords[WORD_COUNT];
+  bool m_bEmpty;
+  uint32_t m_uiHighest;
+  uint32_t m_uiCount;
+};
+
+} // rtp_plus_plus
@@ -1,6 +1,6 @@
 #pragma once
 #include <unordered_map>
-#include <boost/asio/deadline_timer.hpp>
+#include <vector>
 #ifdef _WIN32
 #pragma warning(push)     // disable for this header only
 #pragma warning(disable:4503) 
@@ -39,11 +39,15 @@ typedef boost::function<void (const PathInfo&)> PathInfoCb_t;
 /**
  * @brief The TransmissionManager class stores meta information about
  * sent packets as well as the packets themselves for retransmission purposes.
+ * Sent packets are stored in a fixed size ring indexed by sequence number.
  * To prevent the memory used from growing indefinitely we use the following
  * memory management stragies:
- * - CIRCULAR_MODE: we use a fixed size queue to store the last x sent packets.
+ * - CIRCULAR_MODE: only the last x sent packets are kept.
  * - NACK_TIMED_MODE: each sent packet is stored for the retransmission time.
- * - ACK_MODE: packets that have been acked are removed from the retransmission buffer immediately.
+ * - ACK_MODE: packets are kept until they are overwritten in the ring.
+ * Additional limits on the age and the total size of the stored packets can be set with
+ * setHistoryLimits. Packets are expired lazily when the next packet is stored, and
+ * expired packets are not returned by lookups.
  */
 class TransmissionManager
 {
@@ -53,6 +57,10 @@ public:
     RtpPacketInfo();
     RtpPacketInfo(const RtpPacket& rtpPacket);
     ~RtpPacketInfo();
+    /**
+     * @brief assign reuses the info for a newly stored packet
+     */
+    void assign(const RtpPacket& rtpPacket, const boost::posix_time::ptime& tNow);
 
     RtpPacket originalRtpPacket;
     uint32_t rtpPacketSize;
@@ -72,6 +80,22 @@ public:
    * @param uiRecvBufferSize Size of circular buffer to store recently received packets. For now 64 packets should be enough for acking.
    */
   explicit TransmissionManager(RtpSessionState& rtpSessionState, boost::asio::io_service& ioService, TxBufferManagementMode eMode, uint32_t uiRtxTimeMs, uint32_t uiRecvBufferSize = 64);
+  /// number of packets in the retransmission ring: must be a power of two
+  static const uint32_t DEFAULT_HISTORY_SIZE = 1024;
+  /// number of packets kept in CIRCULAR_MODE
+  static const uint32_t CIRCULAR_HISTORY_SIZE = 30;
+  /**
+   * @brief setHistoryLimits limits the retransmission history in addition to the mode
+   * @param uiMaxAgeMs Packets older than this are expired. 0 = unlimited. In NACK_TIMED_MODE
+   * this defaults to the retransmission time.
+   * @param uiMaxBytes The oldest packets are expired while the stored packets exceed this size.
+   * 0 = unlimited.
+   */
+  void setHistoryLimits(uint32_t uiMaxAgeMs, uint32_t uiMaxBytes);
+  /**
+   * @brief getHistorySize returns the number of packets in the retransmission history
+   */
+  uint32_t getHistorySize() const;
   /**
    * @brief lookupRtpPacketInfo returns the info to the RtpPacket info if it exists.
    * @param uiSN
@@ -177,12 +201,43 @@ public:
   uint32_t getLastReceivedExtendedSN() const { return m_uiLastReceivedExtendedSN; }
 
 private:
-  void onRemoveRtpPacketTimeout(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, uint16_t uiSN);
   RtpPacket generateRtxPacketSsrcMultiplexing(const RtpPacket& rtpPacket);
   RtpPacket generateRtxPacketSsrcMultiplexing(const RtpPacket& rtpPacket, uint16_t uiFlowId, uint16_t uiFSSN);
   RtpPacket generateRtxPacket(const RtpPacket& rtpPacket);
   void insertPacketIntoTxBuffer(const RtpPacket& rtpPacket);
   void removePacketFromTxBuffer(uint16_t uiSN);
+  /**
+   * @brief expires the oldest packets while they exceed the history limits
+   */
+  void expirePacketsFromTxBuffer(const boost::posix_time::ptime& tNow);
+  /**
+   * @brief advances m_uiOldestSN to the oldest stored packet. There must be at least one stored packet.
+   */
+  void skipToOldestStoredPacket();
+  /**
+   * @brief returns the info of the stored packet or null if uiSN is not stored or has expired
+   */
+  RtpPacketInfo* findPacketInTxBuffer(uint16_t uiSN);
+
+  /**
+   * @brief A slot of the retransmission ring
+   */
+  struct TxSlot
+  {
+    TxSlot()
+      :bStored(false)
+    {
+    }
+    bool bStored;
+    RtpPacketInfo info;
+  };
+
+  TxSlot& getTxSlot(uint16_t uiSN) { return m_vTxHistory[uiSN & m_uiTxMask]; }
+  bool isStored(uint16_t uiSN)
+  {
+    const TxSlot& slot = getTxSlot(uiSN);
+    return slot.bStored && slot.info.originalRtpPacket.getSequenceNumber() == uiSN;
+  }
 
 private:
 
@@ -190,18 +245,24 @@ private:
   TxBufferManagementMode m_eMode;
   /// RTP session state
   RtpSessionState& m_rtpSessionState;
-  /// asio service
-  boost::asio::io_service& m_rIoService;
   /// RTX time in milliseconds
   uint32_t m_uiRtxTimeMs;
   /// Lock for RTX data structures
   mutable boost::mutex m_rtxLock;
   /// RTX
 
-  /// outgoing stats
-  std::unordered_map<uint16_t, RtpPacketInfo> m_mTxMap;
-  /// Timers for RTX
-  std::unordered_map<boost::asio::deadline_timer*, boost::asio::deadline_timer*> m_mRtxTimers;
+  /// outgoing stats: ring indexed by SN & m_uiTxMask
+  std::vector<TxSlot> m_vTxHistory;
+  uint16_t m_uiTxMask;
+  /// SN of the oldest stored packet
+  uint16_t m_uiOldestSN;
+  /// number and total size of stored packets
+  uint32_t m_uiStoredPackets;
+  uint32_t m_uiStoredBytes;
+  /// history limits
+  uint32_t m_uiMaxPackets;
+  uint32_t m_uiMaxAgeMs;
+  uint32_t m_uiMaxBytes;
   /// for MPRTP RTX
   bool m_bIsMpRtpSession;
   /// map SN to FLowID + FSSN
@@ -217,7 +278,6 @@ private:
   std::unordered_map<uint32_t, RtpPacketInfo> m_mIncoming;
   boost::posix_time::ptime m_tFirstPacketReceived;
   uint32_t m_uiLastReceivedExtendedSN;
-  std::deque<uint16_t> m_qCircularBuffer;
 
   PathInfoCb_t m_onPathInfo;
   AckCb_t m_onNack;
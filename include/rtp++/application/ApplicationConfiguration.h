@@ -233,6 +233,8 @@ public:
         RtcpRtpHeaderExt(false),
         RtcpRs(false),
         RtxTime(0),
+        RtxHistoryBytes(0),
+        MaxReportedSenders(0),
         RapidSyncMode(0),
         ExtractNtp(0),
         DisableRtcp(false),
@@ -245,6 +247,8 @@ public:
         RtpSn(0),
         RtpTs(0),
         DisableStap(false),
+        ZeroCopyPacketisation(false),
+        DeliverIncompleteNalUnits(false),
         SummariseStats(false)
     {
 
@@ -266,6 +270,10 @@ public:
     bool RtcpRs;
     /// rtx-time
     uint32_t RtxTime;
+    /// size limit of the retransmission history
+    uint32_t RtxHistoryBytes;
+    /// senders reported on per RTCP interval
+    uint32_t MaxReportedSenders;
     uint32_t RapidSyncMode;
     bool ExtractNtp;
     bool DisableRtcp;
@@ -279,6 +287,8 @@ public:
     // TODO: this should be a vector for multiple media lines?
     uint32_t RtpSsrc;
     bool DisableStap;
+    bool ZeroCopyPacketisation;
+    bool DeliverIncompleteNalUnits;
     bool SummariseStats;
   };
   RtpRtcpParameters RtpRtcp;
@@ -286,6 +296,16 @@ public:
   // Network parameters
   struct NetworkParameters
   {
+    NetworkParameters()
+      :RecvBatch(0),
+      SendBatch(0),
+      UdpGso(false),
+      KernelTimestamps(false),
+      ReusePort(false)
+    {
+
+    }
+
     /// transport
     std::string Protocol;
     // preferred RTP starting port
@@ -301,6 +321,18 @@ public:
     std::string FQDN;
     // hack to set local domain name
     std::string Domain;
+    // max number of datagrams read per UDP receive
+    uint32_t RecvBatch;
+    // max number of datagrams written per UDP send
+    uint32_t SendBatch;
+    // use UDP segmentation offload for batched sends
+    bool UdpGso;
+    // I/O backend for UDP RTP/RTCP: asio or io_uring
+    std::string IoBackend;
+    // take arrival times from kernel receive timestamps
+    bool KernelTimestamps;
+    // bind multiplexed RTP/RTCP sockets with SO_REUSEPORT
+    bool ReusePort;
   };
   NetworkParameters Network;
 
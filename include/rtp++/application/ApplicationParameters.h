@@ -77,6 +77,10 @@ public:
   static const std::string channel_config;
   static const std::string t_rr_interval;
   static const std::string disable_stap;
+  /// Reference media sample data from RTP packets instead of copying it during packetisation
+  static const std::string zero_copy_packetisation;
+  /// Deliver fragmented H.264 NAL units with missing fragments instead of discarding them
+  static const std::string deliver_incomplete_nal_units;
   static const std::string rapid_sync_mode;
   static const std::string scheduler;
   static const std::string scheduler_param;
@@ -128,6 +132,18 @@ public:
   static const std::string domain;
   /// Public IP used in offer/answer through NAT
   static const std::string public_ip;
+  /// Max number of datagrams read per UDP receive (recvmmsg): 0 = disabled
+  static const std::string recv_batch;
+  /// Max number of RTP datagrams written per UDP send (sendmmsg): 0 = disabled
+  static const std::string send_batch;
+  /// Use UDP segmentation offload (UDP_SEGMENT) for batched sends
+  static const std::string udp_gso;
+  /// I/O backend of non-multiplexed UDP RTP/RTCP: asio or io_uring
+  static const std::string io_backend;
+  /// Take packet arrival times from kernel receive timestamps (SO_TIMESTAMPNS)
+  static const std::string kernel_timestamps;
+  /// Bind single path multiplexed UDP RTP/RTCP sockets with SO_REUSEPORT so that several sessions can share a port
+  static const std::string reuse_port;
   /// SIP user
   static const std::string sip_user;
   /// SIP FQDN
@@ -169,6 +185,9 @@ public:
   static const std::string rtcp_xr;
   static const std::string rtcp_rs;
   static const std::string rtx_time;
+  static const std::string rtx_history_bytes;
+  /// Maximum number of senders reported on per RTCP interval (0 = all)
+  static const std::string max_reported_senders;
 
   // RTC server options
   static const std::string no_audio;
@@ -29,7 +29,7 @@ public:
    * @param headerExtension
    * @return
    */
-  static CompoundRtcpPacket parse(const rfc5285::HeaderExtensionElement& headerExtension, RtpPacketiser& rtpPacketiser);
+  static CompoundRtcpPacket parse(const rfc5285::HeaderExtensionElementView& headerExtension, RtpPacketiser& rtpPacketiser);
 
 };
 
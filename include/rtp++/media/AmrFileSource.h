@@ -1,41 +1,86 @@
 #pragma once
+#include <istream>
 #include <string>
-#include <media/MediaStreamParser.h>
+#include <vector>
+#include <rtp++/media/MediaSample.h>
+#include <rtp++/media/MediaSource.h>
+#include <rtp++/util/MappedFile.h>
 
 namespace rtp_plus_plus
 {
 namespace media
 {
 
-class AmrFileSource : public MediaStreamParser
+/**
+ * @brief The AmrFileSource class retrieves AMR or AMR-WB speech frames from a file in the
+ * single channel storage format of RFC 4867 section 5. Each media sample consists of the
+ * frame header followed by the speech data as expected by the rfc4867::Rfc4867Packetiser.
+ * The file is memory mapped and the frames reference the mapping.
+ */
+class AmrFileSource : public MediaSource
 {
-  AmrFileSource(const std::string& sFile)
-    :m_sFileName(sFile)
-  {
-    // read AMR header
-    const char amrHeader[] = { 0x23, 0x21, 0x41, 0x4D, 0x52, 0x0A };
-
-  }
-
-  virtual std::vector<MediaSample> flush()
-  {
-
-  }
-
-  virtual boost::optional<MediaSample> extract(const uint8_t* pBuffer, uint32_t uiBufferSize,
-                                               int32_t& sampleSize, bool bMoreDataWaiting)
-  {
-  }
-
-  virtual std::vector<MediaSample> extractAll(const uint8_t* pBuffer, uint32_t uiBufferSize,
-                                              double dCurrentAccessUnitPts)
-  {
-
-  }
+public:
+  /**
+   * @brief AmrFileSource
+   * @param sFilename The name of the AMR or AMR-WB file
+   * @param bLoopSource Configures the source to loop on end of stream
+   * @param uiLoopCount Configures the number of times the source is looped
+   * IFF bLoopSource is true. A value of 0 means that the source will loop
+   * indefinitely
+   */
+  AmrFileSource(const std::string& sFilename, bool bLoopSource, uint32_t uiLoopCount);
+  /**
+   * @brief AmrFileSource The stream is read into memory since it can't be mapped.
+   * @param in1 A reference to the istream that has opened the AMR file
+   * @param bLoopSource Configures the source to loop on end of stream
+   * @param uiLoopCount Configures the number of times the source is looped
+   * IFF bLoopSource is true. A value of 0 means that the source will loop
+   * indefinitely
+   */
+  AmrFileSource(std::istream& in1, bool bLoopSource, uint32_t uiLoopCount);
+  /**
+   * @brief isWideband returns true if the file contains AMR-WB frames
+   */
+  bool isWideband() const { return m_bWideband; }
+  /**
+   * @brief isGood returns false if the end of the file has been reached and the source is
+   * not looped or if the file could not be parsed
+   */
+  bool isGood() const;
+  /**
+   * @brief Overridden from MediaSource. Returns the next speech frame.
+   */
+  boost::optional<MediaSample> getNextMediaSample();
+  /**
+   * @brief Overridden from MediaSource. Returns the next speech frame.
+   */
+  std::vector<MediaSample> getNextAccessUnit();
 
 private:
-  std::string m_sFileName;
+  /**
+   * @brief parseFile checks the file header and stores the offset of each frame
+   */
+  void parseFile();
+
+  // file contents
+  MappedFile::ptr m_pFile;
+  // AMR-WB
+  bool m_bWideband;
 
+  // state of source
+  bool m_bEos;
+  // if source should loop
+  bool m_bLoopSource;
+  // total number of loops if m_bLoopSource
+  uint32_t m_uiLoopCount;
+  // Current loop
+  uint32_t m_uiCurrentLoop;
+  // Current (next) frame
+  uint32_t m_uiCurrentFrame;
+  // offset of each frame header in the file
+  std::vector<uint64_t> m_vFrameOffsets;
+  // size of each frame including the frame header
+  std::vector<uint32_t> m_vFrameSizes;
 };
 
 } // media
@@ -59,6 +59,7 @@ private:
   std::unique_ptr<MediaStreamParser> m_pMediaStreamParser;
   Buffer m_buffer;          /// buffer for reads
   uint32_t m_uiReadSize;    /// Read data
+  uint32_t m_uiReadPos;     /// start of data that has not been parsed yet
   uint32_t m_uiCurrentPos;  /// pointer for new reads
   bool m_bNeedMoreData;     /// flag if we need to read more data
   bool m_bEof;              /// eof flag
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <deque>
+#include <vector>
 #include <boost/make_shared.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/shared_ptr.hpp>
@@ -95,6 +96,19 @@ public:
   boost::posix_time::ptime getPresentationTime() const { return m_tPresentation; }
   void setPresentationTime(const boost::posix_time::ptime& tPresentation) { m_tPresentation = tPresentation; }
 
+  /**
+   * @brief isComplete returns false if parts of the data were lost in transmission
+   * e.g. fragments of a fragmented NAL unit.
+   */
+  bool isComplete() const { return m_vMissingDataOffsets.empty(); }
+  /**
+   * @brief getMissingDataOffsets returns the byte offsets into the data at which
+   * data is missing in ascending order. An offset equal to the payload size means
+   * that the end of the sample is missing.
+   */
+  const std::vector<uint32_t>& getMissingDataOffsets() const { return m_vMissingDataOffsets; }
+  void addMissingDataOffset(uint32_t uiOffset) { m_vMissingDataOffsets.push_back(uiOffset); }
+
 private:  
   /// start time of media sample
   double m_dStartTime;
@@ -121,6 +135,8 @@ private:
   bool m_bNaluContainsStartCode;
   /// Presentation time
   boost::posix_time::ptime m_tPresentation;
+  /// Offsets at which data is missing, empty if the sample is complete
+  std::vector<uint32_t> m_vMissingDataOffsets;
 };
 
 typedef std::deque<MediaSample> MediaSampleQueue_t;
@@ -1,12 +1,13 @@
 #pragma once
-#include <fstream>
+#include <istream>
 #include <string>
+#include <tuple>
 #include <vector>
-#include <cpputil/Buffer.h>
 #include <rtp++/media/h264/H264NalUnitTypes.h>
 #include <rtp++/media/h265/H265NalUnitTypes.h>
 #include <rtp++/media/MediaSample.h>
 #include <rtp++/media/MediaSource.h>
+#include <rtp++/util/MappedFile.h>
 
 namespace rtp_plus_plus
 {
@@ -18,11 +19,17 @@ namespace media
  * The file is parsed on startup and the starting positions for each NAL unit are
  * stored in a vector. This is a simper, more reliable and efficient way then the
  * AsyncStreamMediaApproach used previously.
+ *
+ * The file is memory mapped and the NAL units handed out reference the mapping, so
+ * looping over the file does not read or copy any data. The NAL unit and AU index of
+ * a file is stored in a sidecar file next to it (see getIndexFilename()) and reused
+ * on the next start as long as the size, modification time and inode of the file match.
  */
 class NalUnitMediaSource : public MediaSource
 {
-  typedef std::tuple<size_t, uint32_t, size_t, uint32_t> NalUnitInfo_t;
-  typedef std::vector<NalUnitInfo_t> AccessUnitInfo_t;
+  typedef std::tuple<uint64_t, uint32_t, uint64_t, uint32_t> NalUnitInfo_t;
+  /// index of the first NAL unit of the AU in m_vStartCodeInfo - number of NAL units
+  typedef std::tuple<uint32_t, uint32_t> AccessUnitInfo_t;
 
 public:
   /**
@@ -36,7 +43,8 @@ public:
    */
   NalUnitMediaSource(const std::string& sFilename, const std::string& sMediaType, bool bLoopSource, uint32_t uiLoopCount, uint32_t uiInitialBufferSize = 20000);
   /**
-   * @brief NalUnitMediaSource
+   * @brief NalUnitMediaSource The stream is read into memory since it can't be mapped.
+   * No index file is used.
    * @param in1 A reference to the istream that has opened the Annex B stream
    * @param bLoopSource Configures the source to loop on end of stream
    * @param uiLoopCount Configures the number of times the source is looped
@@ -44,6 +52,11 @@ public:
    * indefinitely
    */
   NalUnitMediaSource(std::istream& in1, const std::string& sMediaType, bool bLoopSource, uint32_t uiLoopCount, uint32_t uiInitialBufferSize = 20000);
+  /**
+   * @brief getIndexFilename returns the name of the sidecar file that stores the NAL unit
+   * and AU index of sFilename
+   */
+  static std::string getIndexFilename(const std::string& sFilename);
   /**
    * @brief isGood This method can be used to check if NAL units can be read. If the end of
    * stream is reached and the source is not configured to loop or if the maximum loop count
@@ -66,30 +79,36 @@ public:
 
 private:
   /**
-   * @brief checkInputStream makes sure that the stream is in a good state and otherwise updates m_bEos
+   * @brief setMediaType sets m_eType and updates m_bEos if the media type is not supported
    */
-  void checkInputStream();
+  void setMediaType(const std::string& sMediaType);
   /**
    * @brief parseAnnexBStream parses the stream and extracts the NAL unit and access unit info
    */
   void parseAnnexBStream();
   /**
-   * @brief readMediaSamples
+   * @brief loadIndex reads the NAL unit and access unit info from the index file
+   * @return false if the index file does not exist or does not match the media file
+   */
+  bool loadIndex(const std::string& sIndexFilename);
+  /**
+   * @brief saveIndex writes the NAL unit and access unit info to the index file
+   */
+  void saveIndex(const std::string& sIndexFilename) const;
+  /**
+   * @brief readMediaSamples returns the NAL units of the AU. The NAL units reference the file.
    * @param auInfo
    * @return
    */
   std::vector<MediaSample> readMediaSamples(const AccessUnitInfo_t& auInfo);
   /**
-   * @brief finaliseAu Stores the NAL units collected so far as an AU
+   * @brief finaliseAu Stores the NAL units [uiFirstNalUnit, uiEndNalUnit) as an AU
    */
-  void finaliseAu(AccessUnitInfo_t& vCurrentAccessUnit);
+  void finaliseAu(uint32_t uiFirstNalUnit, uint32_t uiEndNalUnit);
 private:
 
-  // stream handle when reading from file
-  std::ifstream m_in;
-
-  // stream reference used for actual read
-  std::istream& m_rIn;
+  // file contents
+  MappedFile::ptr m_pFile;
 
   enum MediaType
   {
@@ -97,7 +116,7 @@ private:
     MT_H265
   };
   MediaType m_eType;
-  std::string m_Filename;
+  std::string m_sFilename;
 
   // state of source
   bool m_bEos;
@@ -110,17 +129,12 @@ private:
   // Current (next) AU
   uint32_t m_uiCurrentAccessUnit;
 
-  // buffer to read data into
-  Buffer m_buffer;
-
   /// starting index - start code length - starting index of NAL unit header - NAL unit length (without start code)
   // vector to store the starting indices of all start codes
   std::vector<NalUnitInfo_t> m_vStartCodeInfo;
   // vector to store all AU info
   std::vector<AccessUnitInfo_t> m_vAccessUnitInfo; 
 
-  Buffer m_temporaryNalUnitBuffer;
-
   // members for keeping AU state
   // H264 SVC
   bool m_bCurrentLayerIsBaseLayer;
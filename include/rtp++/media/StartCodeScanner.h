@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace rtp_plus_plus
+{
+namespace media
+{
+
+/**
+ * @brief The StartCodeScanner class locates Annex B start codes in H.264 and H.265 byte streams.
+ *
+ * Only the 3 byte start code 00 00 01 is searched for: a 4 byte start code is a 3 byte start
+ * code preceded by a zero byte, which callers check for themselves. On x86 the buffer is
+ * compared 32 (AVX2) or 16 (SSE2) bytes at a time. The implementation is selected once at
+ * runtime according to the CPU features and falls back to a scalar search elsewhere.
+ */
+class StartCodeScanner
+{
+public:
+  /**
+   * @brief find returns the offset of the first 00 00 01 that starts at or after uiStartPos
+   * and lies completely within the first uiSize bytes of pBuffer
+   * @return The offset of the start code or uiSize if there is none
+   */
+  static size_t find(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos);
+  /**
+   * @brief findScalar is the portable implementation of find
+   */
+  static size_t findScalar(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos);
+  /**
+   * @brief getImplementation returns the name of the implementation used by find: "avx2",
+   * "sse2" or "scalar"
+   */
+  static const char* getImplementation();
+};
+
+} // media
+} // rtp_plus_plus
@@ -1,10 +1,10 @@
 #pragma once
-#include <fstream>
+#include <istream>
 #include <string>
 #include <vector>
-#include <cpputil/Buffer.h>
 #include <rtp++/media/MediaSample.h>
 #include <rtp++/media/MediaSource.h>
+#include <rtp++/util/MappedFile.h>
 
 namespace rtp_plus_plus
 {
@@ -12,7 +12,8 @@ namespace media
 {
 
 /**
- * @brief
+ * @brief The YuvMediaSource class retrieves raw YUV 4:2:0 frames from a file. The file is
+ * memory mapped and each frame references the mapping.
  */
 class YuvMediaSource : public MediaSource
 {
@@ -28,7 +29,7 @@ public:
    */
   YuvMediaSource(const std::string& sFilename, const uint32_t uiWidth, const uint32_t uiHeight, bool bLoopSource, uint32_t uiLoopCount, uint32_t uiInitialBufferSize = 20000);
   /**
-   * @brief YuvMediaSource
+   * @brief YuvMediaSource The stream is read into memory since it can't be mapped.
    * @param in1 A reference to the istream that has opened the Annex B stream
    * @param bLoopSource Configures the source to loop on end of stream
    * @param uiLoopCount Configures the number of times the source is looped
@@ -57,10 +58,6 @@ public:
   std::vector<MediaSample> getNextAccessUnit();
 
 private:
-  /**
-   * @brief checkInputStream makes sure that the stream is in a good state and otherwise updates m_bEos
-   */
-  void checkInputStream();
   /**
    * @brief parseAnnexBStream parses the stream and extracts the NAL unit and access unit info
    */
@@ -72,11 +69,8 @@ private:
   std::vector<MediaSample> readMediaSample();
 private:
 
-  // stream handle when reading from file
-  std::ifstream m_in;
-
-  // stream reference used for actual read
-  std::istream& m_rIn;
+  // file contents
+  MappedFile::ptr m_pFile;
 
   enum MediaType
   {
@@ -101,8 +95,6 @@ private:
   uint32_t m_uiTotalFrames;
   // current frame
   uint32_t m_uiCurrentFrame;
-  // buffer to read data into
-  Buffer m_buffer;
 };
 
 } // media
@@ -7,6 +7,7 @@
 #define H265_PACKETIZATION_MODE "packetization-mode"
 #define H265_PROFILE_LEVEL_ID "profile-level-id"
 #define H265_SPROP_PARAMETER_SETS "sprop-parameter-sets"
+#define H265_SPROP_MAX_DON_DIFF "sprop-max-don-diff"
 
 namespace rtp_plus_plus
 {
@@ -63,6 +64,10 @@ struct H265FormatDescription
           Pps = params[1];
         }
       }
+      else if (params[0] == H265_SPROP_MAX_DON_DIFF)
+      {
+        SpropMaxDonDiff = params[1];
+      }
     }
 
     // check if we managed to find all fields
@@ -84,6 +89,7 @@ struct H265FormatDescription
   std::string SpropParameterSets;
   std::string Sps;
   std::string Pps;
+  std::string SpropMaxDonDiff;
 
 private:
   bool m_bValid;
@@ -2,7 +2,9 @@
 #include <cpputil/BitReader.h>
 #include <cpputil/BitWriter.h>
 #include <cpputil/IBitStream.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
 #include <rtp++/rfc5285/HeaderExtensionElement.h>
+#include <rtp++/rfc5285/RtpHeaderExtension.h>
 #include <rtp++/mprtp/MpRtpHeader.h>
 
 namespace rtp_plus_plus
@@ -72,7 +74,21 @@ public:
     return rfc5285::HeaderExtensionElement(uiMpRtpExtmapId, MPRTP_SUBFLOW_RTP_HEADER_LENGTH + 1, data);
   }
 
-  static MpRtpHeaderParseResult parseMpRtpHeader(const rfc5285::HeaderExtensionElement& headerExtension)
+  /**
+   * @brief appendMpRtpHeaderExtension writes the subflow header directly into the header extension
+   * @return false if the element could not be added
+   */
+  static bool appendMpRtpHeaderExtension(rfc5285::RtpHeaderExtension& extension, uint32_t uiMpRtpExtmapId, const MpRtpSubflowRtpHeader& subflowHeader)
+  {
+    uint8_t* pData = extension.appendHeaderExtension(uiMpRtpExtmapId, MPRTP_SUBFLOW_RTP_HEADER_LENGTH + 1);
+    if (!pData) return false;
+    pData[0] = static_cast<uint8_t>((MPID_SUBFLOW_RTP_HEADER << 4) | MPRTP_SUBFLOW_RTP_HEADER_LENGTH);
+    rfc3550::RtpHeaderCodec::writeUint16(pData + 1, subflowHeader.getFlowId());
+    rfc3550::RtpHeaderCodec::writeUint16(pData + 3, subflowHeader.getFlowSpecificSequenceNumber());
+    return true;
+  }
+
+  static MpRtpHeaderParseResult parseMpRtpHeader(const rfc5285::HeaderExtensionElementView& headerExtension)
   {
     BitReader reader(headerExtension.getExtensionData(), headerExtension.getDataLength() + 1);
     uint32_t uiType = 0;
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <utility>
+#include <boost/asio/ip/udp.hpp>
 #include <cpputil/Conversion.h>
 #include <rtp++/network/AddressDescriptor.h>
 
@@ -15,6 +16,16 @@ typedef std::pair<EndPoint, EndPoint> EndPointPair_t;
  *
  * The initial version will only support IP4. Support for
  * IPv6 may be added at a later stage if required.
+ *
+ * Besides the string representation, the end point caches the binary
+ * boost::asio::ip::udp::endpoint and a hash of address and port. End points
+ * created from a string are resolved once on construction or when the address
+ * is set, while end points created from a received datagram only format the
+ * address string when getAddress() is called. No state is modified after
+ * construction, so an end point can be read from several threads.
+ *
+ * Addresses that can't be parsed, e.g. host names, leave the end point
+ * unresolved: the UDP and DCCP send paths refuse to send to such end points.
  */
 class EndPoint
 {
@@ -25,9 +36,12 @@ public:
   EndPoint()
     :m_sAddress("0.0.0.0"),
       m_uiPort(0),
-      m_uiId(0)
+      m_uiId(0),
+      m_endpoint(boost::asio::ip::address_v4::any(), 0),
+      m_bResolved(true),
+      m_bAddressFormatted(true)
   {
-
+    updateHash();
   }
 
   /**
@@ -36,9 +50,10 @@ public:
   EndPoint(const std::string& sAddress, uint16_t uiPort)
     :m_sAddress(sAddress),
     m_uiPort(uiPort),
-    m_uiId(0)
+    m_uiId(0),
+    m_bAddressFormatted(true)
   {
-
+    resolve();
   }
 
   /**
@@ -47,27 +62,140 @@ public:
   EndPoint(const AddressDescriptor& rAddress)
       :m_sAddress(rAddress.getAddress()),
       m_uiPort(rAddress.getPort()),
-      m_uiId(0)
+      m_uiId(0),
+      m_bAddressFormatted(true)
   {
+    resolve();
+  }
 
+  /**
+   * @brief Constructor for end points of received datagrams: the address string is only formatted if required
+   */
+  explicit EndPoint(const boost::asio::ip::udp::endpoint& endpoint)
+    :m_uiPort(endpoint.port()),
+      m_uiId(0),
+      m_endpoint(endpoint),
+      m_bResolved(true),
+      m_bAddressFormatted(false)
+  {
+    updateHash();
   }
 
   bool isValid() const { return m_uiPort != 0; }
 
-  std::string getAddress() const { return m_sAddress; } 
+  /**
+   * @brief returns the address string. For end points of received datagrams the
+   * string is formatted on each call.
+   */
+  std::string getAddress() const
+  {
+    if (!m_bAddressFormatted)
+      return m_endpoint.address().to_string();
+    return m_sAddress;
+  }
   uint16_t getPort() const { return m_uiPort; }
   uint32_t getId() const { return m_uiId; }
+  /**
+   * @brief returns the cached binary end point. Only valid if isResolved() is true
+   */
+  const boost::asio::ip::udp::endpoint& getUdpEndpoint() const { return m_endpoint; }
+  /**
+   * @brief returns if the address string could be parsed into an IP address
+   */
+  bool isResolved() const { return m_bResolved; }
+  /**
+   * @brief returns hash of address and port
+   */
+  std::size_t getHash() const { return m_uiHash; }
 
-  void setAddress(const std::string& sVal) { m_sAddress = sVal; }
-  void setPort(const uint16_t uiPort) { m_uiPort = uiPort; }
+  void setAddress(const std::string& sVal)
+  {
+    m_sAddress = sVal;
+    m_bAddressFormatted = true;
+    resolve();
+  }
+  void setPort(const uint16_t uiPort)
+  {
+    m_uiPort = uiPort;
+    m_endpoint.port(uiPort);
+    updateHash();
+  }
   void setId(uint32_t uiId) { m_uiId = uiId; } 
 
-  std::string toString() const { return m_sAddress + ":" + ::toString(m_uiPort); }
+  std::string toString() const { return getAddress() + ":" + ::toString(m_uiPort); }
+
+  /**
+   * @brief end points are equal if address and port are equal. The optional ID is ignored.
+   */
+  bool operator==(const EndPoint& other) const
+  {
+    if (m_uiHash != other.m_uiHash || m_uiPort != other.m_uiPort) return false;
+    if (m_bResolved && other.m_bResolved) return m_endpoint.address() == other.m_endpoint.address();
+    return getAddress() == other.getAddress();
+  }
+  bool operator!=(const EndPoint& other) const { return !(*this == other); }
+
+private:
+  void resolve()
+  {
+    boost::system::error_code ec;
+    boost::asio::ip::address address = boost::asio::ip::address::from_string(m_sAddress, ec);
+    m_bResolved = !ec;
+    m_endpoint = boost::asio::ip::udp::endpoint(m_bResolved ? address : boost::asio::ip::address(boost::asio::ip::address_v4::any()), m_uiPort);
+    updateHash();
+  }
+
+  void updateHash()
+  {
+    // FNV-1a over the address bytes and the port
+    uint64_t uiHash = 14695981039346656037ULL;
+    if (m_bResolved)
+    {
+      if (m_endpoint.address().is_v4())
+      {
+        uint32_t uiAddress = m_endpoint.address().to_v4().to_ulong();
+        for (int i = 0; i < 4; ++i)
+          uiHash = (uiHash ^ ((uiAddress >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+      }
+      else
+      {
+        boost::asio::ip::address_v6::bytes_type bytes = m_endpoint.address().to_v6().to_bytes();
+        for (size_t i = 0; i < bytes.size(); ++i)
+          uiHash = (uiHash ^ bytes[i]) * 1099511628211ULL;
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < m_sAddress.length(); ++i)
+        uiHash = (uiHash ^ (uint8_t)m_sAddress[i]) * 1099511628211ULL;
+    }
+    uiHash = (uiHash ^ (m_uiPort & 0xFF)) * 1099511628211ULL;
+    uiHash = (uiHash ^ (m_uiPort >> 8)) * 1099511628211ULL;
+    m_uiHash = static_cast<std::size_t>(uiHash);
+  }
+
 private:
+  // empty for end points constructed from a udp::endpoint
   std::string m_sAddress;
   uint16_t m_uiPort;
   // optional ID 
   uint32_t m_uiId;
+  // cached binary end point
+  boost::asio::ip::udp::endpoint m_endpoint;
+  // if the address could be parsed
+  bool m_bResolved;
+  // if m_sAddress holds the address
+  bool m_bAddressFormatted;
+  // hash of address and port
+  std::size_t m_uiHash;
+};
+
+/**
+ * @brief Hash functor to use EndPoint as key of unordered containers
+ */
+struct EndPointHash
+{
+  std::size_t operator()(const EndPoint& ep) const { return ep.getHash(); }
 };
 
 inline std::ostream& operator<< (std::ostream& ostr, const EndPoint& ep)
@@ -0,0 +1,223 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/thread/mutex.hpp>
+#include <rtp++/network/RtpNetworkInterface.h>
+
+#ifdef ENABLE_IO_URING
+#include <sys/socket.h>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <sys/uio.h>
+#include <liburing.h>
+#endif
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The IoUringRtpNetworkInterface class is a linux io_uring based alternative to UdpRtpNetworkInterface.
+ *
+ * The RTP and RTCP sockets are registered with the ring. Each socket has one multishot
+ * recvmsg operation that receives into a ring of provided buffers registered with the
+ * kernel, so that no system call or handler allocation is needed per datagram. Sends are
+ * queued as sendmsg operations and submitted with one system call per io service handler.
+ *
+ * Completions are signalled on an eventfd that is read on the io service: all callbacks
+ * are invoked on the io service thread as with the asio interfaces. Requires liburing
+ * (ENABLE_IO_URING) and linux 6.0+. If the ring can not be set up, the constructor
+ * sets the error code and the caller should fall back to UdpRtpNetworkInterface.
+ */
+class IoUringRtpNetworkInterface : public RtpNetworkInterface
+{
+public:
+  /**
+   * @brief Constructor binds the RTP and RTCP sockets
+   */
+  IoUringRtpNetworkInterface(boost::asio::io_service& rIoService, const EndPoint& rtpEp, const EndPoint& rtcpEp, boost::system::error_code& ec);
+  /**
+   * @brief Constructor
+   *
+   * This constructor takes previously constructed RTP and RTCP sockets
+   */
+  IoUringRtpNetworkInterface(boost::asio::io_service& rIoService, const EndPoint& rtpEp, const EndPoint& rtcpEp,
+    std::unique_ptr<boost::asio::ip::udp::socket> pRtpSocket, std::unique_ptr<boost::asio::ip::udp::socket> pRtcpSocket,
+    boost::system::error_code& ec);
+  /**
+   * @brief Destructor
+   */
+  virtual ~IoUringRtpNetworkInterface();
+  /**
+   * @brief This method should initalise the component and setup all required
+   */
+  virtual void reset();
+  /**
+   * @brief If this method is called the component will begin the shutdown sequence
+   */
+  virtual void shutdown();
+  /**
+   * @brief arms the multishot receive operations of the RTP and RTCP sockets
+   */
+  virtual bool recv();
+  /**
+   * @brief Getter for the number of packets dropped because the send ring was full
+   */
+  uint64_t getDroppedPacketCount() const { return m_uiDroppedPackets; }
+
+protected:
+
+  virtual bool doSendRtp(Buffer rtpBuffer, const EndPoint& rtpEp);
+  virtual bool doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpEp);
+  virtual size_t doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp);
+
+private:
+
+  /**
+   * @brief binds the RTP and RTCP sockets
+   */
+  void initialise(boost::system::error_code& ec);
+  /**
+   * @brief sets up the ring, registers the sockets, the receive buffers and the eventfd
+   */
+  void initialiseRing(boost::system::error_code& ec);
+  /**
+   * @brief tears down the ring. Pending operations are cancelled.
+   */
+  void releaseRing();
+  /**
+   * @brief queues a sendmsg operation. m_lock must be held.
+   */
+  bool queueSend(const Buffer& buffer, const EndPoint& ep, bool bRtcp);
+  /**
+   * @brief makes sure the queued operations are submitted once the current handler returns. m_lock must be held.
+   */
+  void scheduleSubmit();
+  /**
+   * @brief submits all queued operations
+   */
+  void submit();
+  /**
+   * @brief waits for the next completion notification
+   */
+  void startEventRead();
+  /**
+   * @brief drains the completion queue
+   */
+  void handleEvent(const boost::system::error_code& ec, std::size_t bytes_transferred);
+
+private:
+  /// operations are identified by the upper 32 bits of the user data
+  enum Operation
+  {
+    OP_RECV_RTP = 1,
+    OP_RECV_RTCP = 2,
+    OP_SEND = 3
+  };
+
+  enum
+  {
+    /// max number of queued operations
+    ring_entries = 4096,
+    /// max number of sends in flight
+    send_ring_capacity = 4096,
+    /// number of provided receive buffers
+    recv_buffer_count = 1024,
+    /// size of each receive buffer: the recvmsg header and the source address are stored before the datagram
+    recv_buffer_size = 2048,
+    /// id of the provided buffer group
+    recv_buffer_group = 0,
+    /// socket receive buffer size as used by UdpSocketWrapper
+    udp_receiver_buffer_size_kb = 300000,
+    /// max time that shutdown waits for queued sends to complete
+    drain_timeout_ms = 100
+  };
+
+#ifdef ENABLE_IO_URING
+  struct SendSlot
+  {
+    SendSlot()
+      :Rtcp(false),
+      Complete(false)
+    {
+    }
+    Buffer Packet;
+    EndPoint Destination;
+    bool Rtcp;
+    bool Complete;
+    struct msghdr Header;
+    struct iovec Iovec;
+    struct sockaddr_storage Address;
+  };
+  struct SentPacket
+  {
+    SentPacket(const SendSlot& slot)
+      :Packet(slot.Packet),
+      Destination(slot.Destination),
+      Rtcp(slot.Rtcp)
+    {
+    }
+    Buffer Packet;
+    EndPoint Destination;
+    bool Rtcp;
+  };
+  /**
+   * @brief arms the multishot receive of the registered socket. m_lock must be held.
+   */
+  bool armReceive(Operation eOperation);
+  /**
+   * @brief handles a receive completion. Returns the received packet in networkPacket and ep if there is one.
+   */
+  bool handleReceive(const struct io_uring_cqe* pCqe, NetworkPacket& networkPacket, EndPoint& ep);
+  /**
+   * @brief waits up to drain_timeout_ms for the queued sends to complete and empties the send ring.
+   * All queued sends are returned in vSent, including the ones that did not complete in time, so
+   * that every packet is reported. m_lock must be held.
+   */
+  void drainSends(std::vector<SentPacket>& vSent);
+#endif
+
+  //! io service
+  boost::asio::io_service& m_rIoService;
+  //! bool to keep track if the ring has been set up
+  bool m_bInitialised;
+  //! shutdown flag
+  bool m_bShuttingDown;
+  //! RTP endpoint info
+  EndPoint m_rtpEp;
+  //! RTCP endpoint info
+  EndPoint m_rtcpEp;
+  //! RTP socket: only used for the file descriptor
+  std::unique_ptr<boost::asio::ip::udp::socket> m_pRtpSocket;
+  //! RTCP socket: only used for the file descriptor
+  std::unique_ptr<boost::asio::ip::udp::socket> m_pRtcpSocket;
+  //! number of packets dropped because the send ring was full
+  uint64_t m_uiDroppedPackets;
+  //! protects the submission queue and the send ring
+  boost::mutex m_lock;
+  //! flag whether a submit has been posted to the io service
+  bool m_bSubmitPending;
+#ifdef ENABLE_IO_URING
+  //! completion notifications
+  boost::asio::posix::stream_descriptor m_eventDescriptor;
+  //! eventfd counter
+  uint64_t m_uiEventCount;
+  struct io_uring m_ring;
+  //! provided buffer ring shared by the RTP and RTCP receive operations
+  struct io_uring_buf_ring* m_pBufferRing;
+  //! memory of the provided receive buffers
+  std::vector<uint8_t> m_vReceiveBuffers;
+  //! recvmsg template of the multishot receive operations
+  struct msghdr m_receiveHeader;
+  //! sends in flight: completions are reported in the order of the sends
+  std::vector<SendSlot> m_vSendSlots;
+  uint64_t m_uiSendHead;
+  uint64_t m_uiSendTail;
+  //! completions copied out of the completion queue: callbacks may shut the ring down
+  std::vector<struct io_uring_cqe> m_vCompletions;
+  //! sends completed in the current event
+  std::vector<SentPacket> m_vSent;
+#endif
+};
+
+} // rtp_plus_plus
@@ -44,6 +44,13 @@ public:
    * This method should make the sockets ready for receiving data
    */
   virtual bool recv();
+  /**
+   * @brief Takes the arrival time of packets from kernel receive timestamps (SO_TIMESTAMPNS).
+   *
+   * Must be called before recv().
+   * @return true if kernel timestamps are supported, false otherwise
+   */
+  bool setKernelTimestamps(bool bEnable);
 
 protected:
 
@@ -73,6 +80,8 @@ private:
   EndPoint m_rtpRtcpEp;
   /// RTP/RTCP Socket
   UdpSocketWrapper::ptr m_pMuxedRtpSocket;
+  /// flag whether arrival times are taken from kernel receive timestamps
+  bool m_bKernelTimestamps;
 
   /// State management for callbacks
   enum PacketType
@@ -33,6 +33,15 @@ public:
     m_tNtpArrival(tArrival)
   {}
 
+  /**
+   * Constructor for packets that were received into an existing (e.g. pooled) buffer:
+   * the packet shares the storage of the buffer.
+   */
+  NetworkPacket(const Buffer& buffer, uint64_t tArrival)
+    :Buffer(buffer),
+    m_tNtpArrival(tArrival)
+  {}
+
   uint64_t getNtpArrivalTime() const { return m_tNtpArrival; }
   void setNtpArrivalTime(uint64_t tArrival) { m_tNtpArrival = tArrival; }
 
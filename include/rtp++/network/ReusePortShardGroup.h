@@ -0,0 +1,97 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/thread/thread.hpp>
+#include <rtp++/network/EndPoint.h>
+#include <rtp++/network/RtpNetworkInterface.h>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#ifdef SO_REUSEPORT
+/// @def ENABLE_REUSEPORT The kernel only distributes datagrams over SO_REUSEPORT sockets on linux 3.9+
+#define ENABLE_REUSEPORT
+#endif
+#endif
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The ReusePortShardGroup class binds N SO_REUSEPORT sockets to one RTP/RTCP port.
+ *
+ * Each shard has its own io_service, serviced by its own thread, and its own
+ * MuxedUdpRtpNetworkInterface. The kernel hashes the 4-tuple of incoming datagrams
+ * so that all packets of a flow are received by the same shard. The application
+ * should create one session stack per shard on the io service of that shard: the
+ * callbacks of a shard's network interface are only invoked on the shard thread,
+ * so per SSRC state owned by the shard does not require locking.
+ *
+ * Only multiplexed RTP/RTCP is supported: with separate RTCP ports the RTCP of a
+ * flow would be hashed independently of its RTP and could arrive at another shard.
+ *
+ * RtpSession binds its multiplexed socket with createReusePortSocket if the reuse-port
+ * application parameter is set, so that one session per receive thread can share a port.
+ */
+class ReusePortShardGroup : private boost::noncopyable
+{
+public:
+  /**
+   * @brief creates a UDP socket bound to ep with SO_REUSEPORT set.
+   * @param[in] ioService The io service of the socket
+   * @param[in] ep The local endpoint to bind to
+   * @param[out] ec Set if the socket could not be bound or SO_REUSEPORT is not supported
+   */
+  static std::unique_ptr<boost::asio::ip::udp::socket> createReusePortSocket(boost::asio::io_service& ioService,
+                                                                             const EndPoint& ep,
+                                                                             boost::system::error_code& ec);
+  /**
+   * @brief Constructor binds uiShards sockets to rtpRtcpEp
+   * @param[in] rtpRtcpEp The local RTP/RTCP endpoint
+   * @param[in] uiShards The number of shards. Typically the number of cores used for receiving.
+   * @param[out] ec Set if any of the sockets could not be bound
+   */
+  ReusePortShardGroup(const EndPoint& rtpRtcpEp, uint32_t uiShards, boost::system::error_code& ec);
+  /**
+   * @brief Destructor stops the shard threads
+   */
+  ~ReusePortShardGroup();
+  /**
+   * @brief Getter for the number of shards
+   */
+  uint32_t getShardCount() const { return m_vShards.size(); }
+  /**
+   * @brief Getter for the io service of the shard. Session state of the shard should use this io service.
+   */
+  boost::asio::io_service& getIoService(uint32_t uiShard) { return *m_vShards.at(uiShard)->IoService; }
+  /**
+   * @brief Getter for the network interface of the shard. The callbacks must be configured before start().
+   */
+  RtpNetworkInterface& getNetworkInterface(uint32_t uiShard) { return *m_vShards.at(uiShard)->NetworkInterface; }
+  /**
+   * @brief starts receiving on all shards and starts one thread per shard
+   */
+  void start();
+  /**
+   * @brief shuts the network interfaces down and joins the shard threads
+   */
+  void stop();
+
+private:
+  struct Shard
+  {
+    std::unique_ptr<boost::asio::io_service> IoService;
+    std::unique_ptr<boost::asio::io_service::work> Work;
+    RtpNetworkInterface::ptr NetworkInterface;
+    boost::shared_ptr<boost::thread> Thread;
+  };
+
+  EndPoint m_rtpRtcpEp;
+  std::vector<std::unique_ptr<Shard> > m_vShards;
+};
+
+} // rtp_plus_plus
@@ -3,9 +3,9 @@
 #include <cstdlib>
 #include <memory>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
@@ -15,6 +15,7 @@
 //#include <rtp++/network/RtpNetworkInterface.h>
 #include <rtp++/network/UdpForwarder.h>
 #include <rtp++/network/UdpRtpNetworkInterface.h>
+#include <rtp++/util/TimerService.h>
 
 #define FIVE_PERCENT 5
 
@@ -58,9 +59,9 @@ protected:
                           const InterfaceDescriptions_t& host1, const InterfaceDescriptions_t& host2);
 
   /// Handlers
-  void sendRtpPacket(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex );
+  void sendRtpPacket(const boost::system::error_code& ec, const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex );
 
-  void sendRtcpPacket(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep, const uint32_t uiInterfaceIndex );
+  void sendRtcpPacket(const boost::system::error_code& ec, const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep, const uint32_t uiInterfaceIndex );
 
   void onIncomingRtp( const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex );
 
@@ -73,6 +74,8 @@ protected:
 private:
   /// io service reference
   boost::asio::io_service& m_rIoService;
+  /// shared timer service for delayed forwarding
+  TimerService& m_rTimerService;
 
   /// RTP forwarder
   std::vector<std::unique_ptr<RtpNetworkInterface> > m_vRtpInterfaces;
@@ -96,10 +99,10 @@ private:
   /// Otherwise packets are reflected at the UDP layer
   bool m_bStrict;
 
-  // Map from address to port to forwarding address descriptor
-  std::map<std::string, std::map<uint16_t, EndPoint> > m_map;
-  // Map from address to port to forwarding address descriptor
-  std::map<std::string, std::map<uint16_t, NetworkProperties_t> > m_networkMap;
+  // Map from end point to forwarding end point
+  std::unordered_map<EndPoint, EndPoint, EndPointHash> m_map;
+  // Map from end point to network properties
+  std::unordered_map<EndPoint, NetworkProperties_t, EndPointHash> m_networkMap;
 };
 
 }
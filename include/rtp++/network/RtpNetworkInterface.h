@@ -18,6 +18,8 @@ namespace rtp_plus_plus
 typedef boost::function<void (const RtpPacket&, const EndPoint& ep)> RtpCb_t;
 /// Callback for RTCP packets
 typedef boost::function<void (const CompoundRtcpPacket&, const EndPoint& ep)> CompoundRtcpCb_t;
+/// Callback for generic NACKs and ACKs that are read in place
+typedef boost::function<void (const RtcpFbView&, const EndPoint& ep)> RtcpFbCb_t;
 //typedef boost::function<void (const CompoundRtcpPacket&, const EndPoint& ep)> RtcpCb_t;
 
 /// @def MEASURE_RTP_INTERARRIVAL_TIME Debug information about interarrival time in ms
@@ -73,6 +75,12 @@ public:
    * @brief Callback for incoming RTCP packets. The calling class must configure these callbacks
    */
   void setIncomingRtcpHandler(CompoundRtcpCb_t incomingRtcp) { m_incomingRtcp = incomingRtcp; }
+  /**
+   * @brief Callback for incoming generic NACKs and ACKs. If this is set, no RtcpPacketBase objects
+   * are created for them and they are not part of the compound packet passed to the incoming RTCP
+   * handler. That compound packet is empty if the received packet only contained generic NACKs and ACKs.
+   */
+  void setIncomingFbHandler(RtcpFbCb_t incomingFb) { m_incomingFb = incomingFb; }
   /**
    * Callback for outgoing RTP packets. The calling class must configure these callbacks
    */
@@ -106,12 +114,24 @@ public:
    * The sublass is responsible for implementing doSendRtp
    */
   bool send(const RtpPacket& rtpPacket, const EndPoint& destination);
+  /**
+   * This method should be called to deliver all RTP packets of a media sample
+   * to the same destination. Subclasses that can push several packets to the
+   * network at once should implement doSendRtpBatch
+   */
+  bool send(const std::vector<RtpPacket>& rtpPackets, const EndPoint& destination);
   /**
    * This method should be called to deliver an RTCP report
    * First method of asynchronous sending interface
    * The subclass is responsible for implementing doSendRtcp
    */
   bool send(const CompoundRtcpPacket& compoundPacket, const EndPoint& destination);
+  /**
+   * This method should be called to deliver an RTCP report that is followed by feedback
+   * messages that have already been written with RtcpCompoundWriter. Only compoundPacket
+   * is passed to the outgoing RTCP handler.
+   */
+  bool send(const CompoundRtcpPacket& compoundPacket, const Buffer& feedback, const EndPoint& destination);
 
 protected:
 
@@ -132,6 +152,11 @@ protected:
    *
    */
   virtual bool doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpEp) = 0;
+  /**
+   * The default implementation calls doSendRtp for each buffer until one fails
+   * @return the number of leading buffers that were queued. The remaining buffers are not sent.
+   */
+  virtual size_t doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp);
   /**
    * Second method of the asynchronous sending interface
    * This must be called by the subclass once the sending
@@ -157,6 +182,20 @@ protected:
 
 private:
 
+  /**
+   * @brief packetises, protects and sends the RTP packet via doSendRtp
+   */
+  bool packetiseAndSendRtp(const RtpPacket& rtpPacket, const EndPoint& destination);
+  /**
+   * @brief removes uiCount packets that were not queued for sending, starting at the
+   * absolute queue position uiPosition. Must be called with m_lock held.
+   */
+  void eraseUnsentRtp(uint64_t uiPosition, size_t uiCount);
+  /**
+   * @brief packetises and sends the compound RTCP packet via doSendRtcp
+   */
+  bool packetiseAndSendRtcp(const CompoundRtcpPacket& compoundPacket, const Buffer& feedback, const EndPoint& destination);
+
   /// RTP packetiser for incoming and outgoing packets
   std::unique_ptr<RtpPacketiser> m_pRtpPacketiser;
 
@@ -172,10 +211,13 @@ private:
   RtpCb_t m_incomingRtp;
   RtpCb_t m_outgoingRtp;
   CompoundRtcpCb_t m_incomingRtcp;
+  RtcpFbCb_t m_incomingFb;
   CompoundRtcpCb_t m_outgoingRtcp;
 
   /// State management for callbacks
   std::deque<RtpPacket> m_qRtp;
+  /// number of packets popped from m_qRtp: the position of the front packet
+  uint64_t m_uiRtpPacketsReported;
   std::deque<CompoundRtcpPacket> m_qRtcp;
   boost::mutex m_lock;
   boost::mutex m_rtcplock;
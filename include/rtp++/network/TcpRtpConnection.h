@@ -1,7 +1,8 @@
 #pragma once
 
-#include <deque>
+#include <atomic>
 #include <utility>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/address.hpp>
@@ -10,12 +11,12 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
-#include <boost/thread/mutex.hpp>
 
 #include <cpputil/Buffer.h>
 
 #include <rtp++/network/EndPoint.h>
 #include <rtp++/network/NetworkPacket.h>
+#include <rtp++/util/MpscRingBuffer.h>
 
 namespace rtp_plus_plus
 {
@@ -30,7 +31,25 @@ class RtpNetworkInterface;
 class TcpRtpConnection : private boost::noncopyable,
                          public boost::enable_shared_from_this<TcpRtpConnection>
 {
-  typedef std::pair<Buffer, EndPoint> NetworkPackage_t;
+  /// queued packet: the RFC 4571 length prefix is stored with the packet so that
+  /// the payload can be written without copying it into a framed buffer
+  struct NetworkPackage
+  {
+    NetworkPackage()
+    {
+      Prefix[0] = Prefix[1] = 0;
+    }
+    NetworkPackage(Buffer packet, const EndPoint& destination)
+      :Packet(packet),
+      Destination(destination)
+    {
+      Prefix[0] = static_cast<uint8_t>(packet.getSize() >> 8);
+      Prefix[1] = static_cast<uint8_t>(packet.getSize() & 0xFF);
+    }
+    Buffer Packet;
+    EndPoint Destination;
+    uint8_t Prefix[2];
+  };
 public:
 
   typedef boost::shared_ptr<TcpRtpConnection> ptr;
@@ -53,9 +72,19 @@ public:
   void stop();
 
   void connect(boost::asio::ip::tcp::resolver::iterator endpoint_iter);
-  void send(Buffer networkPacket, const EndPoint& endpoint);
+  /**
+   * @brief queues the packet for sending. May be called from multiple threads.
+   *
+   * All packets queued while a write is in progress are written with the next
+   * gather write: each packet is preceded by its RFC 4571 length prefix.
+   * @return false if the packet was dropped because the send queue is full
+   * or because it exceeds the max RFC 4571 frame size
+   */
+  bool send(Buffer networkPacket, const EndPoint& endpoint);
   void close();
 
+  uint64_t getDroppedPacketCount() const { return m_uiDroppedPackets.load(); }
+
   void onRecv(ReceiveCb_t val) { m_fnOnRecv = val; }
   void onSendComplete(SendCb_t val) { m_fnOnSend = val; }
   void onTimeout(TimeoutCb_t val) { m_fnOnTimeout = val; }
@@ -68,6 +97,7 @@ private:
   void handleConnect( const boost::system::error_code& error, boost::asio::ip::tcp::resolver::iterator endpointIterator );
   void readHeaderHandler(const boost::system::error_code& ec, std::size_t bytes_received);
   void readCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_received, uint32_t uiPacketSize);
+  void startWrite();
   void writeCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_transferred);
 
 private:
@@ -89,6 +119,8 @@ private:
   boost::asio::ip::tcp::socket m_socket;
 
   bool m_bConnectionInProgress;
+  /// set if a write was requested while the connection was in progress
+  bool m_bWritePending;
   /// Buffer for incoming data.
   //boost::array<char, 8192> m_buffer;
   unsigned char m_sizeBuffer[2]; 
@@ -104,9 +136,24 @@ private:
   TimeoutCb_t m_fnOnTimeout;
 
   /// Sender members
-  /// threading lock for queue
-  boost::mutex m_lock;
-  std::deque< NetworkPackage_t > m_vDeliveryQueue;
+  enum
+  {
+    send_queue_capacity = 4096,
+    /// max number of packets per gather write: two buffers per packet fit into one writev of asio
+    max_gather_packets = 32,
+    /// max size of an RFC 4571 frame
+    max_frame_size = 0xFFFF
+  };
+  /// bounded queue to store packets while a connection or write is in progress
+  MpscRingBuffer<NetworkPackage> m_sendQueue;
+  /// number of packets that have been queued but whose write has not completed yet
+  std::atomic<size_t> m_uiQueued;
+  /// number of packets at the head of the send queue covered by the write in progress
+  size_t m_uiWriteCount;
+  /// buffer sequence of the write in progress: the prefixes and packets stay in the send queue until completion
+  std::vector<boost::asio::const_buffer> m_vGatherBuffers;
+  /// number of packets dropped because the send queue was full
+  std::atomic<uint64_t> m_uiDroppedPackets;
 };
 
 }
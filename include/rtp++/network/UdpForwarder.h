@@ -46,15 +46,12 @@ public:
   void addForwardingPair(const EndPoint& host1, const EndPoint& host2)
   {
     VLOG(2) << "Adding forwarding pairs " << host1 << " to " << host2;
-    m_map[host1.getAddress()][host1.getPort()] = host2;
-    m_map[host2.getAddress()][host2.getPort()] = host1;
+    m_map[host1] = host2;
+    m_map[host2] = host1;
 
     for (auto& it: m_map)
     {
-      for (auto& it2: it.second)
-      {
-        VLOG(2) << "FWD MAP INFO IP: " << it.first << ":" << it2.first << " " << it2.second;
-      }
+      VLOG(2) << "FWD MAP INFO IP: " << it.first << " " << it.second;
     }
   }
 
@@ -112,7 +109,7 @@ private:
   std::deque< NetworkPackage_t > m_vDeliveryQueue;
 
   // Map from address to port to forwarding address descriptor
-  std::map<std::string, std::map<uint16_t, EndPoint> > m_map;
+  std::unordered_map<EndPoint, EndPoint, EndPointHash> m_map;
 
   /// packet loss probability
   uint32_t m_uiPacketLossProbability;
@@ -59,16 +59,45 @@ public:
    * @brief This method should make the sockets ready for receiving data
    */
   virtual bool recv();
+  /**
+   * @brief Enables batched receive on the RTP socket.
+   *
+   * Up to uiBatchSize datagrams are read per readiness event. RTCP is
+   * always received one datagram at a time given the low packet rate.
+   * @param[in] uiBatchSize The maximum number of datagrams read per readiness event. 0 or 1 disables batching.
+   * @return true if batched receive is supported, false otherwise
+   */
+  bool setReceiveBatchSize(uint32_t uiBatchSize);
+  /**
+   * @brief Enables batched send on the RTP socket.
+   *
+   * The packets of a media sample are written with sendmmsg, up to uiBatchSize
+   * messages per system call.
+   * @param[in] uiBatchSize The maximum number of messages per system call. 0 or 1 disables batching.
+   * @param[in] bSegmentationOffload If UDP segmentation offload (UDP_SEGMENT) should be used
+   * to coalesce equally sized packets to the same destination.
+   * @return true if batched send is supported, false otherwise
+   */
+  bool setSendBatchSize(uint32_t uiBatchSize, bool bSegmentationOffload);
+  /**
+   * @brief Takes the arrival time of RTP and RTCP packets from kernel receive timestamps (SO_TIMESTAMPNS).
+   *
+   * Must be called before recv().
+   * @return true if kernel timestamps are supported, false otherwise
+   */
+  bool setKernelTimestamps(bool bEnable);
 
 protected:
 
   void handleRtpPacket(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, NetworkPacket networkPacket, const EndPoint& ep);
   void handleRtcpPacket(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, NetworkPacket networkPacket, const EndPoint& ep);
+  void handleRtpPackets(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, const UdpSocketWrapper::NetworkPacketBatch_t& vPackets);
   void handleSentRtpPacket(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, Buffer buffer, const EndPoint& ep);
   void handleSentRtcpPacket(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, Buffer buffer, const EndPoint& ep);
 
   virtual bool doSendRtp(Buffer rtpBuffer, const EndPoint& rtpEp);
   virtual bool doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpEp);
+  virtual size_t doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp);
 
 private:
 
@@ -80,6 +109,10 @@ private:
    * @brief initialises previously constructed RTP and RTCP sockets
    */
   void initialiseExistingSockets(std::unique_ptr<boost::asio::ip::udp::socket> pRtpSocket, std::unique_ptr<boost::asio::ip::udp::socket> pRtcpSocket);
+  /**
+   * @brief handles errors in RTP receive
+   */
+  void handleRtpReceiveError(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource);
 
 private:
   //! io service
@@ -96,6 +129,14 @@ private:
   UdpSocketWrapper::ptr m_pRtpSocket;
   //! RTCP socket
   UdpSocketWrapper::ptr m_pRtcpSocket;
+  //! Max number of RTP datagrams read per readiness event
+  uint32_t m_uiReceiveBatchSize;
+  //! Max number of RTP messages written per system call
+  uint32_t m_uiSendBatchSize;
+  //! flag whether UDP segmentation offload should be used for RTP
+  bool m_bSegmentationOffload;
+  //! flag whether arrival times are taken from kernel receive timestamps
+  bool m_bKernelTimestamps;
 
 #ifdef RTP_DEBUG
   //! TODO RTP dump class
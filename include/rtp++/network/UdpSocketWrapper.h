@@ -1,6 +1,7 @@
 #pragma once
-#include <deque>
+#include <atomic>
 #include <utility>
+#include <vector>
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/udp.hpp>
@@ -8,10 +9,27 @@
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
-#include <boost/thread/mutex.hpp>
 #include <cpputil/Buffer.h>
 #include <rtp++/network/EndPoint.h>
 #include <rtp++/network/NetworkPacket.h>
+#include <rtp++/util/MpscRingBuffer.h>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/udp.h>
+/// @def ENABLE_RECVMMSG Batched receive via recvmmsg is only available on linux
+#define ENABLE_RECVMMSG
+/// @def ENABLE_SENDMMSG Batched send via sendmmsg is only available on linux
+#define ENABLE_SENDMMSG
+#ifdef UDP_SEGMENT
+/// @def ENABLE_UDP_GSO UDP segmentation offload requires linux 4.18 headers
+#define ENABLE_UDP_GSO
+#endif
+#ifdef SO_TIMESTAMPNS
+/// @def ENABLE_SO_TIMESTAMPNS Kernel receive timestamps with nanosecond resolution
+#define ENABLE_SO_TIMESTAMPNS
+#endif
+#endif
 
 namespace rtp_plus_plus
 {
@@ -38,6 +56,14 @@ public:
    * \typedef for receive callback
    */
   typedef boost::function<void(const boost::system::error_code&, UdpSocketWrapper::ptr, NetworkPacket, const EndPoint&)> ReceiveCb_t;
+  /**
+   * \typedef for a batch of received packets and the endpoints they were received from
+   */
+  typedef std::vector<std::pair<NetworkPacket, EndPoint> > NetworkPacketBatch_t;
+  /**
+   * \typedef for batch receive callback
+   */
+  typedef boost::function<void(const boost::system::error_code&, UdpSocketWrapper::ptr, const NetworkPacketBatch_t&)> ReceiveBatchCb_t;
   /**
    * \typedef for send callback
    */
@@ -111,10 +137,28 @@ public:
    * @brief sends the network packet to the specified endpoint
    *
    * The send callback m_fnOnSend will be invoked once the asynchronous operation has completed.
+   * This method may be called concurrently from multiple threads. If the send queue is full
+   * the packet is dropped and the send callback is not invoked.
    * @param networkPacket The packet to be sent to the endpoint
    * @param endpoint The endpoint the packet should be sent to.
+   * @return false if the packet was dropped because the send queue is full
+   */
+  bool send(Buffer networkPacket, const EndPoint& endpoint);
+  /**
+   * @brief sends the network packets to the specified endpoint
+   *
+   * The packets are queued in order. If batched send has been enabled via setSendBatchSize()
+   * the queue is flushed to the kernel with as few sendmmsg calls as possible, otherwise the
+   * packets are sent one at a time. The send callback m_fnOnSend is invoked once per packet.
+   * @param vNetworkPackets The packets to be sent to the endpoint
+   * @param endpoint The endpoint the packets should be sent to.
+   * @return false if the packets were dropped because the send queue can not hold all of them
+   */
+  bool send(const std::vector<Buffer>& vNetworkPackets, const EndPoint& endpoint);
+  /**
+   * @brief Getter for the number of packets dropped because the send queue was full
    */
-  void send(Buffer networkPacket, const EndPoint& endpoint);
+  uint64_t getDroppedPacketCount() const { return m_uiDroppedPackets.load(); }
   /**
    * @brief Closes the underlying UDP socket.
    *
@@ -131,6 +175,67 @@ public:
    * @brief configures the receive callback.
    */
   void onRecv(ReceiveCb_t val) { m_fnOnRecv = val; }
+  /**
+   * @brief configures the batch receive callback.
+   *
+   * This callback is invoked instead of m_fnOnRecv once batched receive has been enabled
+   * via setReceiveBatchSize().
+   */
+  void onRecvBatch(ReceiveBatchCb_t val) { m_fnOnRecvBatch = val; }
+  /**
+   * @brief Enables batched receive.
+   *
+   * If enabled, each readiness event drains up to uiBatchSize datagrams from the socket
+   * in a single recvmmsg call and delivers them via the batch receive callback.
+   * A batch size of 0 or 1 selects the one datagram per async_receive_from path.
+   * This setting must be configured before the first call to recv().
+   * @param[in] uiBatchSize The maximum number of datagrams read per readiness event.
+   * @return true if batched receive is supported on this platform, false otherwise.
+   */
+  bool setReceiveBatchSize(uint32_t uiBatchSize);
+  /**
+   * @brief Getter for the receive batch size
+   */
+  uint32_t getReceiveBatchSize() const { return m_uiBatchSize; }
+  /**
+   * @brief Enables batched send.
+   *
+   * If enabled, queued packets are written with sendmmsg, up to uiBatchSize
+   * messages per system call. A batch size of 0 or 1 selects the one datagram
+   * per async_send_to path.
+   * @param[in] uiBatchSize The maximum number of messages written per system call.
+   * @return true if batched send is supported on this platform, false otherwise.
+   */
+  bool setSendBatchSize(uint32_t uiBatchSize);
+  /**
+   * @brief Getter for the send batch size
+   */
+  uint32_t getSendBatchSize() const { return m_uiSendBatchSize; }
+  /**
+   * @brief Enables UDP segmentation offload (UDP_SEGMENT) for batched send.
+   *
+   * Consecutive queued packets with the same destination and size (the last one may
+   * be shorter) are handed to the kernel as one super-datagram that is split into
+   * the individual datagrams by the kernel or the NIC. Only has an effect once
+   * batched send has been enabled. If the kernel rejects the offload it is disabled again.
+   * @return true if UDP segmentation offload is supported on this platform, false otherwise.
+   */
+  bool setSegmentationOffload(bool bEnable);
+  /**
+   * @brief Enables kernel receive timestamps (SO_TIMESTAMPNS).
+   *
+   * The NTP arrival time of received packets is taken from the SCM_TIMESTAMPNS control
+   * message that the kernel returns with each datagram instead of reading the clock once
+   * the completion handler runs, so that it does not include io service queueing delay.
+   * Datagrams are read with recvmsg once the socket is readable.
+   * This setting must be configured before the first call to recv().
+   * @return true if kernel timestamps are supported on this platform, false otherwise.
+   */
+  bool setKernelTimestamps(bool bEnable);
+  /**
+   * @brief Getter for if kernel receive timestamps are enabled
+   */
+  bool getKernelTimestamps() const { return m_bKernelTimestamps; }
   /**
    * @brief configures the send callback.
    */
@@ -155,10 +260,43 @@ private:
    * @brief Callback to be invoked on asynchronous read operation
    */
   void readCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_received);
+  /**
+   * @brief Callback to be invoked once the socket is readable in kernel timestamp mode
+   */
+  void readTimestampedCompletionHandler(const boost::system::error_code& ec);
+  /**
+   * @brief Delivers the datagram in m_data received from m_lastSenderEndpoint
+   * @param[in] uiNtpArrival The NTP arrival time of the datagram
+   */
+  void handleDatagram(const boost::system::error_code& ec, std::size_t bytes_received, uint64_t uiNtpArrival);
+  /**
+   * @brief Callback to be invoked once the socket is readable in batched receive mode
+   */
+  void readBatchCompletionHandler(const boost::system::error_code& ec);
   /**
    * @brief Callback to be invoked on asynchronous write operation
    */
   void writeCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_transferred);
+  /**
+   * @brief Appends the packet to the send queue
+   * @return false if the queue is full
+   */
+  bool enqueue(const Buffer& networkPacket, const EndPoint& endpoint);
+  /**
+   * @brief Starts the write for the packet at the front of the send queue
+   *
+   * Only the thread that owns the write chain, i.e. that moved m_uiQueued away from
+   * 0 or that handles a write completion, may call this method.
+   */
+  void startWrite();
+  /**
+   * @brief Starts an asynchronous wait for the socket to become writable in batched send mode
+   */
+  void startBatchWrite();
+  /**
+   * @brief Callback to be invoked once the socket is writable in batched send mode
+   */
+  void writeBatchCompletionHandler(const boost::system::error_code& ec);
 
 private:
 
@@ -180,6 +318,8 @@ private:
   boost::asio::ip::udp::endpoint m_lastSenderEndpoint;
   //! Receive data callback
   ReceiveCb_t m_fnOnRecv;
+  //! Batch receive data callback
+  ReceiveBatchCb_t m_fnOnRecvBatch;
   //! Send data callback
   SendCb_t m_fnOnSend;
   //! Timeout data callback
@@ -192,14 +332,69 @@ private:
   enum
   {
     max_length = 1500,
-    udp_receiver_buffer_size_kb = 300000
+    udp_receiver_buffer_size_kb = 300000,
+    /// size of the control message buffer for SCM_TIMESTAMPNS in 8 byte words: CMSG_SPACE(sizeof(timespec)) = 32
+    control_words = 8
   };
   //! Buffer for receiving incoming network packets
   char m_data[max_length];
-  //! threading lock for m_vDeliveryQueue
-  boost::mutex m_lock;
-  //! Deque to store packets while component is busy
-  std::deque< NetworkPackage_t > m_vDeliveryQueue;
+  //! Max number of datagrams to be read per readiness event: 0 or 1 disables batched receive
+  uint32_t m_uiBatchSize;
+#ifdef ENABLE_RECVMMSG
+  //! Pooled receive buffers, one per batch slot
+  std::vector<Buffer> m_vBatchBuffers;
+  //! Scatter-gather entries for recvmmsg
+  std::vector<iovec> m_vBatchIovecs;
+  //! Source addresses of received datagrams
+  std::vector<sockaddr_storage> m_vBatchAddresses;
+  //! Message headers for recvmmsg
+  std::vector<mmsghdr> m_vBatchHeaders;
+  //! Control message buffers for kernel timestamps, one per batch slot
+  std::vector<uint64_t> m_vBatchControl;
+#endif
+  //! flag whether the arrival time is taken from kernel receive timestamps
+  bool m_bKernelTimestamps;
+  //! Max number of messages written per sendmmsg call: 0 or 1 disables batched send
+  uint32_t m_uiSendBatchSize;
+  //! flag whether UDP segmentation offload should be used in batched send mode
+  bool m_bSegmentationOffload;
+#ifdef ENABLE_SENDMMSG
+  //! Send constants
+  enum
+  {
+    // UDP_MAX_SEGMENTS in the linux kernel
+    max_gso_segments = 64,
+    // max UDP payload
+    max_gso_bytes = 65507
+  };
+  //! Control message buffer carrying the UDP_SEGMENT size
+  union SendControl_t
+  {
+    char buf[CMSG_SPACE(sizeof(uint16_t))];
+    cmsghdr align;
+  };
+  //! Scatter-gather entries for sendmmsg
+  std::vector<iovec> m_vSendIovecs;
+  //! Destination addresses of the messages
+  std::vector<sockaddr_storage> m_vSendAddresses;
+  //! Control messages for UDP segmentation offload
+  std::vector<SendControl_t> m_vSendControl;
+  //! Message headers for sendmmsg
+  std::vector<mmsghdr> m_vSendHeaders;
+  //! Number of queued packets contained in each message
+  std::vector<uint32_t> m_vPacketsPerMessage;
+#endif
+  //! Send queue constants
+  enum
+  {
+    send_queue_capacity = 4096
+  };
+  //! Bounded queue to store packets while component is busy
+  MpscRingBuffer<NetworkPackage_t> m_sendQueue;
+  //! Number of packets that have been queued but whose write has not completed yet
+  std::atomic<size_t> m_uiQueued;
+  //! Number of packets dropped because the send queue was full
+  std::atomic<uint64_t> m_uiDroppedPackets;
 private:
 };
 
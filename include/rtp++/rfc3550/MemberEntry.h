@@ -5,6 +5,7 @@
 #include <rtp++/MemberUpdate.h>
 #include <rtp++/RtcpPacketBase.h>
 #include <rtp++/RtpPacket.h>
+#include <rtp++/RtpTime.h>
 #include <rtp++/rfc3550/Rtcp.h>
 #include <rtp++/rfc3550/RtpConstants.h>
 #include <rtp++/rfc3550/SdesInformation.h>
@@ -80,10 +81,10 @@ public:
   bool hasBeenIntialisedWithSN() const { return m_bInit; }
   /// If RTCP has been synced
   bool isRtcpSychronised() const { return m_bIsRtcpSynchronised; }
-  /// The time stored for when the last RTP packet was sent
-  boost::posix_time::ptime getTimeLastRtpPacketSent() const { return m_tLastRtpPacketSent; }
-  /// The time stored for when the last RTP or RTCP packet was sent
-  boost::posix_time::ptime getTimeLastPacketSent() const { return m_tLastPacketSent; }
+  /// The monotonic time (see Clock) stored for when the last RTP packet was sent
+  int64_t getLastRtpPacketSentNs() const { return m_iLastRtpPacketSentNs; }
+  /// The monotonic time (see Clock) stored for when the last RTP or RTCP packet was sent
+  int64_t getLastPacketSentNs() const { return m_iLastPacketSentNs; }
   /// Whether the participant is a sender
   bool isSender() const { return m_bIsSender; }
   /// Set the participant to be a sender
@@ -205,7 +206,7 @@ public:
   // after an appropriate delay ( Perkins recommends a fixed 2 second delay ).
   // Passing in current time so that it does not have to be recalculate for all members
   // Since a slight variation in duration is not critical
-  bool isInactiveAndCanBeRemoved(boost::posix_time::ptime tNow) const;
+  bool isInactiveAndCanBeRemoved(int64_t iNowNs) const;
 
   virtual void onSrReceived(const rfc3550::RtcpSr& rSr);
   virtual void onRrReceived(const rfc3550::RtcpRr& rRr);
@@ -258,10 +259,10 @@ protected:
   std::set<uint32_t> m_localSSRCs;
   /// SSRC of this member entry
   uint32_t m_uiSSRC;
-  // Time the entry was created in the database
-  boost::posix_time::ptime m_tEntryCreated;
-  // Time BYE was received: once a BYE is received, wait a period before removing the record from the database
-  boost::posix_time::ptime m_tMarkedInactive;
+  // Monotonic time the entry was created in the database
+  int64_t m_iEntryCreatedNs;
+  // Monotonic time BYE was received: once a BYE is received, wait a period before removing the record from the database
+  int64_t m_iMarkedInactiveNs;
   // flag that stores whether init has been called
   bool m_bInit;
   // This variable stores how many sequential packets must be received before a source is regarded as valid
@@ -321,23 +322,25 @@ protected:
   uint32_t m_uiLossFraction;
   double m_dRtt;
 
-  /// This member stores the time at which the LSR was received
-  boost::posix_time::ptime m_tLsr;
-  boost::posix_time::time_duration m_tDlsr;
+  /// This member stores the monotonic time at which the LSR was received, 0 if none was received
+  int64_t m_iLsrNs;
 
-  /// Stores the time at which the last RTP packet was
+  /// Stores the monotonic time at which the last RTP packet was
   /// sent by the member (that was received successfully)
   /// and is used for tracking the number of senders
-  boost::posix_time::ptime m_tLastRtpPacketSent;
+  int64_t m_iLastRtpPacketSentNs;
 
-  /// Stores the time at which the last RTP or RTCP packet
+  /// Stores the monotonic time at which the last RTP or RTCP packet
   /// was sent by the member (that was received successfully)
   /// and is used for timing out participants
-  boost::posix_time::ptime m_tLastPacketSent;
+  int64_t m_iLastPacketSentNs;
 
-  /// Reference times for RTCP synchronisation
+  /// Reference times for RTCP synchronisation: the presentation time
+  /// in ns since the unix epoch, 0 before the first packet
   uint32_t m_uiSyncRtpRef;
-  boost::posix_time::ptime m_tSyncRef;
+  int64_t m_iSyncRefNs;
+  /// converts RTP timestamp differences to ns
+  RtpTimestampConverter m_timestampConverter;
 
   // for enabling loss reporting
   bool m_bEnableDetailedLossDetection;
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <rtp++/rfc3550/MemberEntry.h>
+
+namespace rtp_plus_plus {
+namespace rfc3550 {
+
+/**
+ * @brief The MemberTable class stores the members of an RTP session.
+ *
+ * Members are stored densely as parallel arrays (SSRC, state flags, entry) and are
+ * found via an open-addressing index keyed by SSRC. Removal moves the last member
+ * into the freed position, so member indices are only stable until the next removal.
+ *
+ * The sender, valid, inactive and unvalidated counts are maintained incrementally:
+ * code that may change the state of an entry must call touch() and the state of
+ * touched members is re-read the next time a count is requested.
+ */
+class MemberTable
+{
+public:
+  static const uint32_t NPOS = UINT32_MAX;
+
+  /**
+   * @brief Constructor
+   * @param uiInitialCapacity The initial number of members. The table grows as required.
+   */
+  explicit MemberTable(uint32_t uiInitialCapacity = 64);
+  /**
+   * @brief find returns the index of the member with the SSRC or NPOS
+   */
+  uint32_t find(uint32_t uiSSRC) const;
+  /**
+   * @brief insert inserts a new member. The SSRC must not be in the table yet.
+   * @return the index of the new member
+   */
+  uint32_t insert(uint32_t uiSSRC, std::unique_ptr<MemberEntry> pEntry);
+  /**
+   * @brief removeAt removes and deletes the member at uiIndex
+   */
+  void removeAt(uint32_t uiIndex);
+  /**
+   * @brief touch marks the state of the member at uiIndex as possibly changed
+   */
+  void touch(uint32_t uiIndex);
+
+  uint32_t size() const { return static_cast<uint32_t>(m_vSSRCs.size()); }
+  bool empty() const { return m_vSSRCs.empty(); }
+  uint32_t getSSRC(uint32_t uiIndex) const { return m_vSSRCs[uiIndex]; }
+  MemberEntry* getEntry(uint32_t uiIndex) const { return m_vEntries[uiIndex].get(); }
+
+  uint32_t getSenderCount() const;
+  uint32_t getValidCount() const;
+  uint32_t getInactiveCount() const;
+  uint32_t getUnvalidatedCount() const;
+
+private:
+  enum Flags
+  {
+    FLAG_SENDER = 0x01,
+    FLAG_VALID = 0x02,
+    FLAG_INACTIVE = 0x04,
+    FLAG_UNVALIDATED = 0x08,
+    FLAG_TOUCHED = 0x80
+  };
+
+  uint32_t getHomeSlot(uint32_t uiSSRC) const;
+  /**
+   * @brief returns the index slot holding the SSRC, or the empty slot where it would be inserted
+   */
+  uint32_t getSlot(uint32_t uiSSRC) const;
+  void eraseSlot(uint32_t uiSlot);
+  void grow();
+  /**
+   * @brief updates the counts of all touched members
+   */
+  void update() const;
+  void updateCounts(uint8_t uiFlags, int iDelta) const;
+
+  // open-addressing index: dense member index + 1, 0 = empty slot
+  std::vector<uint32_t> m_vIndex;
+  uint32_t m_uiIndexMask;
+  // members
+  std::vector<uint32_t> m_vSSRCs;
+  std::vector<std::unique_ptr<MemberEntry> > m_vEntries;
+  // state flags as of the last update
+  mutable std::vector<uint8_t> m_vFlags;
+  // members whose state may have changed since the last update
+  mutable std::vector<uint32_t> m_vTouched;
+  mutable uint32_t m_uiSenders;
+  mutable uint32_t m_uiValid;
+  mutable uint32_t m_uiInactive;
+  mutable uint32_t m_uiUnvalidated;
+};
+
+} // rfc3550
+} // rtp_plus_plus
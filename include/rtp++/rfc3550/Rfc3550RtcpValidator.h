@@ -4,6 +4,10 @@
 
 namespace rtp_plus_plus
 {
+
+/// fwd
+class RtcpCompoundView;
+
 namespace rfc3550
 {
 
@@ -33,6 +37,14 @@ public:
   * @return  true if it succeeds, false if it fails. It can be set to 0 to avoid these checks.
   */
   virtual bool validateCompoundRtcpPacket(CompoundRtcpPacket compoundPacket, uint32_t uiTotalLength);
+  /**
+   * @brief Validates a compound RTCP packet that has been indexed with RtcpCompoundView using
+   * the same rules as validateCompoundRtcpPacket. The versions, padding and lengths have already
+   * been checked by RtcpCompoundView::parse.
+   * @param compoundView The indexed compound packet
+   * @param uiTotalLength The size of the received packet or 0 to skip the compound check.
+   */
+  virtual bool validateCompoundRtcpView(const RtcpCompoundView& compoundView, uint32_t uiTotalLength);
 };
 
 }
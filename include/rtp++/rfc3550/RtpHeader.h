@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <ostream>
 #include <vector>
 #include <boost/cstdint.hpp>
@@ -36,6 +37,10 @@ namespace rfc3550
 
 /**
  * @brief The RtpHeader class
+ *
+ * The first INLINE_CSRC_COUNT CSRCs are stored inline, longer CSRC lists are stored on
+ * the heap. The RFC 5285 header extension is only allocated once it is accessed for
+ * modification so that headers without extension stay small and cheap to copy and move.
  */
 class RtpHeader
 {
@@ -44,6 +49,10 @@ class RtpHeader
 
 public:
   typedef boost::shared_ptr<RtpHeader> ptr;
+  /// the CC field is 4 bits wide
+  static const uint32_t MAX_CSRC_COUNT = 15;
+  /// the number of CSRCs that are stored without allocating
+  static const uint32_t INLINE_CSRC_COUNT = 4;
   /**
    * @brief RtpHeader
    */
@@ -99,51 +108,84 @@ public:
   {
 
   }
+  /**
+   * @brief RtpHeader copies the CSRCs and the header extension
+   */
+  RtpHeader(const RtpHeader& other);
+  /**
+   * @brief RtpHeader takes over the CSRC list and the header extension of other
+   */
+  RtpHeader(RtpHeader&& other);
+  RtpHeader& operator=(const RtpHeader& other);
+  RtpHeader& operator=(RtpHeader&& other);
   /**
    * @brief getVersion
    * @return
    */
   uint8_t getVersion() const { return m_uiVersion; }
   bool hasPadding() const { return m_bPadding; }
-  bool hasExtension() const { return m_headerExtension.containsExtensions(); }
+  bool hasExtension() const { return m_pHeaderExtension && m_pHeaderExtension->containsExtensions(); }
   uint8_t getCC() const { return m_uiCC; } 
   bool isMarkerSet() const { return m_bMarker; }
   uint8_t getPayloadType() const { return m_uiPT; }
   uint16_t getSequenceNumber() const { return m_uiSN; }
   uint32_t getRtpTimestamp() const { return m_uiRtpTimestamp; }
   uint32_t getSSRC() const { return m_uiSSRC; }
-  std::vector<uint32_t> getCSRCs() const { return m_vCCs; }
+  /**
+   * @brief getCSRC returns the CSRC at index uiIndex < getCC()
+   */
+  uint32_t getCSRC(uint32_t uiIndex) const
+  {
+    assert(uiIndex < m_uiCC);
+    return m_pCSRCs ? m_pCSRCs[uiIndex] : m_aCSRCs[uiIndex];
+  }
+  /**
+   * @brief getCSRCs returns a copy of the CSRC list. Use getCC and getCSRC on the packet path.
+   */
+  std::vector<uint32_t> getCSRCs() const
+  {
+    const uint32_t* pCSRCs = m_pCSRCs ? m_pCSRCs.get() : m_aCSRCs;
+    return std::vector<uint32_t>(pCSRCs, pCSRCs + m_uiCC);
+  }
 
-  std::size_t getHeaderExtensionCount() const { return m_headerExtension.getHeaderExtensionCount(); }
-  const rfc5285::RtpHeaderExtension& getHeaderExtension() const { return m_headerExtension; }
-  rfc5285::RtpHeaderExtension& getHeaderExtension(){ return m_headerExtension; }
-  std::vector<rfc5285::HeaderExtensionElement> getHeaderExtensions() const { return m_headerExtension.getHeaderExtensions(); }
+  std::size_t getHeaderExtensionCount() const { return m_pHeaderExtension ? m_pHeaderExtension->getHeaderExtensionCount() : 0; }
+  /**
+   * @brief getHeaderExtension returns an empty extension if the header has no extension
+   */
+  const rfc5285::RtpHeaderExtension& getHeaderExtension() const;
+  /**
+   * @brief getHeaderExtension allocates the extension if the header has none
+   */
+  rfc5285::RtpHeaderExtension& getHeaderExtension();
+  std::vector<rfc5285::HeaderExtensionElement> getHeaderExtensions() const { return getHeaderExtension().getHeaderExtensions(); }
 
   void setPadding(bool bVal) { m_bPadding = bVal; }
   void addRtpHeaderExtension(const rfc5285::HeaderExtensionElement& headerExtension)
   {
-    m_headerExtension.addHeaderExtensions(headerExtension);
+    getHeaderExtension().addHeaderExtensions(headerExtension);
   }
   void setMarkerBit(bool bVal) { m_bMarker = bVal; }
   void setPayloadType(uint8_t uiPt) { m_uiPT = uiPt; }
   void setSequenceNumber(uint16_t uiSN) { m_uiSN = uiSN; }
   void setRtpTimestamp(uint32_t uiRtpTimestamp) {m_uiRtpTimestamp = uiRtpTimestamp; }
   void setSSRC(uint32_t uiSSRC) { m_uiSSRC = uiSSRC; }
-  void addContributingSource(uint32_t uiCSRC) { m_vCCs.push_back(uiCSRC); }
+  /**
+   * @brief addContributingSource appends a CSRC. CSRCs beyond MAX_CSRC_COUNT are ignored.
+   */
+  void addContributingSource(uint32_t uiCSRC);
 
   uint32_t getSize() const
   {
     return MIN_RTP_HEADER_SIZE +
-           (4 * m_vCCs.size()) + 
-           (m_headerExtension.containsExtensions() ? m_headerExtension.getSize() : 0);
+           (4 * m_uiCC) + 
+           (hasExtension() ? m_pHeaderExtension->getSize() : 0);
   }
 
 protected:
 
   uint8_t m_uiVersion;
   bool m_bPadding;
-  bool m_bExtension;
-  uint8_t m_uiCC; 
+  uint8_t m_uiCC;
   bool m_bMarker;
   uint8_t m_uiPT;
   uint16_t m_uiSN; 
@@ -167,12 +209,22 @@ protected:
   */
   uint32_t m_uiSSRC;
 
-  std::vector<uint32_t> m_vCCs;
+  /**
+   * @brief m_aCSRCs stores up to INLINE_CSRC_COUNT CSRCs so that most RTP headers can
+   * be copied without heap allocation. Only the first m_uiCC entries are valid.
+   */
+  uint32_t m_aCSRCs[INLINE_CSRC_COUNT];
+  /**
+   * @brief m_pCSRCs stores all MAX_CSRC_COUNT CSRCs once more than INLINE_CSRC_COUNT
+   * have been added
+   */
+  std::unique_ptr<uint32_t[]> m_pCSRCs;
 
   /**
-   * @brief m_vHeaderExtensions RFC5285 header extensions
+   * @brief m_pHeaderExtension RFC5285 header extensions: null if the header has
+   * no extension
    */
-  rfc5285::RtpHeaderExtension m_headerExtension;
+  std::unique_ptr<rfc5285::RtpHeaderExtension> m_pHeaderExtension;
 };
 
 
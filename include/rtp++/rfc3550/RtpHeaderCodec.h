@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <rtp++/rfc3550/RtpHeader.h>
+
+namespace rtp_plus_plus
+{
+namespace rfc3550
+{
+
+/**
+ * @brief The RtpHeaderFields struct stores the fields and the layout of a parsed RTP header.
+ */
+struct RtpHeaderFields
+{
+  RtpHeaderFields()
+    :Padding(false),
+    Extension(false),
+    CsrcCount(0),
+    Marker(false),
+    PayloadType(0),
+    SequenceNumber(0),
+    RtpTimestamp(0),
+    SSRC(0),
+    ExtensionOffset(0),
+    HeaderSize(0),
+    PaddingSize(0)
+  {
+  }
+  bool Padding;
+  bool Extension;
+  uint8_t CsrcCount;
+  bool Marker;
+  uint8_t PayloadType;
+  uint16_t SequenceNumber;
+  uint32_t RtpTimestamp;
+  uint32_t SSRC;
+  /// offset of the RFC 5285 extension header: only valid if Extension is set
+  uint32_t ExtensionOffset;
+  /// size of the fixed header, the CSRC list and the extension
+  uint32_t HeaderSize;
+  /// number of padding bytes at the end of the packet
+  uint32_t PaddingSize;
+};
+
+/**
+ * @brief The RtpHeaderCodec class reads and writes RTP headers at byte level.
+ *
+ * The fixed header is written and read as whole 16 and 32 bit words in network
+ * byte order. The RFC 5285 extension is left to RtpHeaderExtension. The
+ * OBitStream serialisation of RtpHeader is kept as reference implementation.
+ */
+class RtpHeaderCodec
+{
+public:
+  /**
+   * @brief writes the fixed header and the CSRC list of rtpHeader to pDest
+   * @param pDest Must have space for MIN_RTP_HEADER_SIZE + 4 * CC bytes
+   * @return the number of bytes written
+   */
+  static uint32_t write(const RtpHeader& rtpHeader, uint8_t* pDest);
+  /**
+   * @brief parses and validates the RTP header in one pass
+   *
+   * The version, the length of the CSRC list and the extension and the padding
+   * count are checked against the packet size.
+   * @return true if pData contains a valid RTP header
+   */
+  static bool parse(const uint8_t* pData, uint32_t uiSize, RtpHeaderFields& fields);
+  /**
+   * @brief returns the CSRC at uiIndex of a header that has been validated by parse
+   */
+  static uint32_t readCsrc(const uint8_t* pData, uint32_t uiIndex)
+  {
+    return readUint32(pData + MIN_RTP_HEADER_SIZE + 4 * uiIndex);
+  }
+
+  static uint16_t readUint16(const uint8_t* pData)
+  {
+    return static_cast<uint16_t>((pData[0] << 8) | pData[1]);
+  }
+
+  static uint32_t readUint32(const uint8_t* pData)
+  {
+    return (static_cast<uint32_t>(pData[0]) << 24) | (static_cast<uint32_t>(pData[1]) << 16) |
+           (static_cast<uint32_t>(pData[2]) << 8) | pData[3];
+  }
+
+  static void writeUint16(uint8_t* pDest, uint16_t uiValue)
+  {
+    pDest[0] = static_cast<uint8_t>(uiValue >> 8);
+    pDest[1] = static_cast<uint8_t>(uiValue);
+  }
+
+  static void writeUint32(uint8_t* pDest, uint32_t uiValue)
+  {
+    pDest[0] = static_cast<uint8_t>(uiValue >> 24);
+    pDest[1] = static_cast<uint8_t>(uiValue >> 16);
+    pDest[2] = static_cast<uint8_t>(uiValue >> 8);
+    pDest[3] = static_cast<uint8_t>(uiValue);
+  }
+};
+
+} // rfc3550
+} // rtp_plus_plus
@@ -1,12 +1,12 @@
 #pragma once
 #include <cstdlib>
 #include <tuple>
-#include <unordered_map>
 #include <cpputil/Utility.h>
 #include <rtp++/RtpPacket.h>
 #include <rtp++/RtpSessionParameters.h>
 #include <rtp++/network/EndPoint.h>
 #include <rtp++/rfc3550/MemberEntry.h>
+#include <rtp++/rfc3550/MemberTable.h>
 #include <rtp++/rfc3550/Rtcp.h>
 #include <rtp++/rfc3611/RtcpXr.h>
 
@@ -35,13 +35,11 @@ class RtpSessionState;
 namespace rfc3550 {
 
 /// we_sent, sender list, receiver list
-typedef std::tuple<bool, std::vector<MemberEntry*>, std::vector<MemberEntry*> > RtcpReportData_t;
+/// The lists are owned by the session database and are valid until the next RTCP interval begins.
+typedef std::tuple<bool, const std::vector<MemberEntry*>&, const std::vector<MemberEntry*>& > RtcpReportData_t;
 
 class SessionDatabase
 {
-  typedef std::unordered_map<uint32_t, MemberEntry*> MemberMap_t;
-  typedef std::pair<const uint32_t, MemberEntry*> MemberEntry_t;
-
 public:
   typedef std::unique_ptr<SessionDatabase> ptr;
   /**
@@ -94,6 +92,12 @@ public:
      *          data about other senders, as well as a vector about other participants (receivers)
      */
     RtcpReportData_t gatherRTCPReportDataAndBeginNewInterval();
+    /**
+     * @brief setMaxReportedSenders limits the number of senders that are reported on per RTCP interval.
+     * If there are more senders, they are selected round robin over consecutive intervals.
+     * @param uiMaxSenders 0 = report on all senders
+     */
+    void setMaxReportedSenders(uint32_t uiMaxSenders) { m_uiMaxReportedSenders = uiMaxSenders; }
     /**
      * @brief getAverageRtcpSize
      * @return
@@ -149,6 +153,16 @@ public:
      * @param ep
      */
     void onSendRtcpPacket(const CompoundRtcpPacket& compoundPacket, const EndPoint& ep);
+    /**
+     * @brief addOutgoingFeedbackSize adds the size of feedback that was written without RtcpPacketBase
+     * objects to the compound packet passed to the next call of onSendRtcpPacket
+     */
+    void addOutgoingFeedbackSize(uint32_t uiSize) { m_uiOutgoingFeedbackSize += uiSize; }
+    /**
+     * @brief addIncomingFeedbackSize adds the size of feedback that was read in place to the
+     * compound packet passed to the next call of processIncomingRtcpPacket
+     */
+    void addIncomingFeedbackSize(uint32_t uiSize) { m_uiIncomingFeedbackSize += uiSize; }
     /**
      * @brief processIncomingRtpPacket
      * @param packet
@@ -280,7 +294,16 @@ protected:
     uint32_t m_uiRtcpBandwidthFraction;
 
     // Tables for storing participants
-    MemberMap_t m_memberDb;
+    MemberTable m_memberDb;
+    // report data of the current interval: reused to avoid allocations
+    std::vector<MemberEntry*> m_vSenderList;
+    std::vector<MemberEntry*> m_vReceiverList;
+    // round robin selection of reported senders
+    uint32_t m_uiMaxReportedSenders;
+    uint32_t m_uiNextReportedSender;
+    // size of the feedback in the next compound packet that has no RtcpPacketBase objects
+    uint32_t m_uiOutgoingFeedbackSize;
+    uint32_t m_uiIncomingFeedbackSize;
 
     /* 6.3 */
     // Time the last RTCP report was sent
@@ -5,6 +5,7 @@
 #include <cpputil/GenericParameters.h>
 #include <rtp++/IFeedbackManager.h>
 #include <rtp++/RtpSessionParameters.h>
+#include <rtp++/SequenceNumberWindow.h>
 #include <rtp++/rfc4585/Rfc4585RtcpReportManager.h>
 // TODO: get rid of inheritance?
 #include <rtp++/rto/RtoManagerInterface.h>
@@ -75,14 +76,14 @@ public:
   uint32_t getReceivedCount() const;
   /**
    * @brief getAssumedLost Gets a vector containing sequence numbers of packets assumed lost
-   * @return
+   * @return extended sequence numbers in ascending order
    *
    * This is applicable when the application is using NACK feedback
    */
   std::vector<uint32_t> getAssumedLost();
   /**
    * @brief getReceived Gets a vector containing sequence numbers of packets received.
-   * @return
+   * @return extended sequence numbers in ascending order
    *
    * This is applicable when the application is using ACK feedback
    */
@@ -130,10 +131,10 @@ private:
   FeedbackMode m_eFeedbackMode;
   // RTO
   std::unique_ptr<rto::PacketLossDetectionBase> m_pRtoEstimator;
-  // LOST
-  std::vector<uint32_t> m_vAssumedLost;
-  // received SN
-  std::vector<uint32_t> m_vReceivedSN;
+  // LOST: packets assumed lost since the last call to getAssumedLost
+  SequenceNumberWindow m_assumedLost;
+  // received SN: packets received since the last call to getReceived
+  SequenceNumberWindow m_received;
 };
 
 } // rfc4585
@@ -1,6 +1,7 @@
 #pragma once
 #include <rtp++/rfc3550/RtcpReportManager.h>
 #include <boost/date_time/posix_time/ptime.hpp>
+#include <rtp++/RtcpCompoundWriter.h>
 
 // for now only handle point to point
 #define POINT_TO_POINT true
@@ -14,6 +15,11 @@ namespace rfc4585
 {
 
 typedef boost::function<void (CompoundRtcpPacket&) > FeedbackCallback_t;
+/// Callback for feedback: generic NACKs and ACKs are written into the RtcpCompoundWriter,
+/// other feedback messages are appended to the compound packet
+typedef boost::function<void (CompoundRtcpPacket&, RtcpCompoundWriter&) > FeedbackWriterCallback_t;
+/// Callback for RTCP reports that are followed by feedback written with RtcpCompoundWriter
+typedef boost::function<void (const CompoundRtcpPacket&, const Buffer&) > RtcpFeedbackCb_t;
 
 class RtcpReportManager : public rfc3550::RtcpReportManager
 {
@@ -38,6 +44,23 @@ public:
   {
     m_fnFeedback = fnFeedback;
   }
+  /**
+   * @brief setFeedbackWriterCallback configures the callback used to retrieve feedback instead
+   * of the callback set with setFeedbackCallback. An RTCP feedback handler must be configured
+   * with setRtcpFeedbackHandler to send the written feedback.
+   */
+  void setFeedbackWriterCallback(FeedbackWriterCallback_t fnFeedback)
+  {
+    m_fnFeedbackWriter = fnFeedback;
+  }
+  /**
+   * @brief setRtcpFeedbackHandler configures the handler for RTCP reports that are followed by
+   * feedback written with RtcpCompoundWriter. All other reports are passed to the RTCP handler.
+   */
+  void setRtcpFeedbackHandler(RtcpFeedbackCb_t rtcpHandler)
+  {
+    m_onRtcpFeedback = rtcpHandler;
+  }
 
   // Note: T_rr_interval is in seconds
   double getT_rr_interval() const { return m_dT_rr_interval; }
@@ -73,6 +96,15 @@ protected:
   virtual void onRtcpIntervalTimeout(const boost::system::error_code& ec);
 
 private:
+  /**
+   * @brief retrieves the feedback for the next report using the configured callbacks
+   */
+  void retrieveFeedback();
+  /**
+   * @brief sends the RTCP report followed by the feedback written in m_feedbackWriter
+   */
+  void sendRtcpPacketWithFeedback(bool bIsMinimalPacketAllowed = false);
+
   // true for point to point sessions
   //    bool m_bPointToPoint;
   // if an early RTCP report is allowed
@@ -88,6 +120,10 @@ private:
   CompoundRtcpPacket m_vFeedback;
   // callback to retrieve feedback messages
   FeedbackCallback_t m_fnFeedback;
+  // feedback that is written without creating RtcpPacketBase objects
+  RtcpCompoundWriter m_feedbackWriter;
+  FeedbackWriterCallback_t m_fnFeedbackWriter;
+  RtcpFeedbackCb_t m_onRtcpFeedback;
 
   /// From RFC4585: for randomisation of early RTCP scheduling
   double m_dT_dither_max;
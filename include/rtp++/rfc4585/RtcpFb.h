@@ -294,15 +294,17 @@ protected:
 
 private:
 
-  // Finds the existing NACK group that the SN falls into if one exists
+  // Finds the existing NACK group that the SN falls into if one exists.
+  // The most recent group is checked first so that ascending SNs, e.g.
+  // from a SequenceNumberWindow, are packed into PID+BLP in a single pass.
   int getNackIndex(uint16_t uiSN)
   {
-    for (size_t i = 0; i < m_vBase.size(); ++i)
+    for (size_t i = m_vBase.size(); i > 0; --i)
     {
-      uint16_t uiBase = m_vBase[i];
-      if (uiSN >= uiBase && uiSN <= (uiBase + 16))
+      uint16_t uiOffset = uiSN - m_vBase[i - 1];
+      if (uiOffset <= 16)
       {
-        return i;
+        return i - 1;
       }
     }
     return -1;
@@ -54,5 +54,46 @@ private:
   unsigned char m_data[MAX_HDR_EXT_SIZE];
 };
 
+/**
+ * @brief The HeaderExtensionElementView class references the data of an extension element
+ * in place, e.g. in the received datagram or in the storage of an RtpHeaderExtension.
+ * The view is only valid as long as the referenced storage.
+ */
+class HeaderExtensionElementView
+{
+public:
+  HeaderExtensionElementView()
+    :m_uiId(0),
+      m_uiLength(0),
+      m_pData(nullptr)
+  {
+  }
+
+  HeaderExtensionElementView(uint32_t uiId, uint32_t uiDataLength, const uint8_t* pData)
+    :m_uiId(uiId),
+      m_uiLength(uiDataLength),
+      m_pData(pData)
+  {
+  }
+  /**
+   * @brief allows elements to be passed wherever a view is expected
+   */
+  HeaderExtensionElementView(const HeaderExtensionElement& element)
+    :m_uiId(element.getId()),
+      m_uiLength(element.getDataLength()),
+      m_pData(element.getExtensionData())
+  {
+  }
+
+  uint32_t getId() const { return m_uiId; }
+  uint32_t getDataLength() const { return m_uiLength; }
+  const uint8_t* getExtensionData() const { return m_pData; }
+
+private:
+  uint32_t m_uiId;
+  uint32_t m_uiLength;
+  const uint8_t* m_pData;
+};
+
 } // rfc5285
 } // rtp_plus_plus
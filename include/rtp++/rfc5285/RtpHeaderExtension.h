@@ -1,6 +1,10 @@
 #pragma once
+#include <vector>
 #include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
 #include <boost/shared_ptr.hpp>
+#include <cpputil/Buffer.h>
+#include <cpputil/IBitStream.h>
 #include <cpputil/OBitStream.h>
 #include <rtp++/rfc3550/Rfc3550.h>
 #include <rtp++/rfc5285/HeaderExtensionElement.h>
@@ -45,6 +49,16 @@ namespace rfc5285
  * On packetisation the implementation selects the one or two byte header extension depending
  * on the size of the extension elements i.e. if all extension elements are <= 16, then the one byte
  * header extension is used.
+ *
+ * The extension of a received packet is not copied: setExtensionData references the extension
+ * block in the datagram and indexes its elements. The index and the data of locally added
+ * elements are stored inline and only spill to the heap for unusually large extensions.
+ * A received extension is copied into the local storage once it is modified.
+ * Received extensions with a profile other than the RFC 5285 one and two byte headers contain
+ * no elements but are forwarded unchanged.
+ *
+ * The index and the size are updated when the extension is modified so that the const
+ * methods don't modify the extension and can be called from several threads.
  */
 class RtpHeaderExtension
 {
@@ -57,17 +71,13 @@ public:
    * @param uiExtensionLengthInWords
    */
   RtpHeaderExtension(uint16_t uiProfileDefined = DEFAULT_PROFILE_DEFINED, RtpHeaderExtensionType eType = ONE_BYTE_HEADER, uint16_t uiExtensionLengthInWords = 0, uint8_t uiAppBits = 0);
-  /**
-   * @brief RtpHeaderExtension Destructor
-   */
-  ~RtpHeaderExtension();
   /**
    * @brief clear
    */
   void clear();
   /**
    * @brief containsExtensions
-   * @return
+   * @return true if the extension has elements or references a received extension
    */
   bool containsExtensions() const;
   /**
@@ -81,22 +91,32 @@ public:
    */
   std::size_t getHeaderExtensionCount() const;
   /**
-   * @brief addHeaderExtensions
+   * @brief addHeaderExtensions copies the element into the extension
    * @param headerExtension
    * @return
    */
   void addHeaderExtensions(const HeaderExtensionElement& headerExtension);
   /**
-  * @brief getHeaderExtensions
-  * @param index
-  * @return
-  */
- const HeaderExtensionElement& getHeaderExtensions(size_t index) const;
+   * @brief appendHeaderExtension reserves space for an element so that the caller can write
+   * the element data in place.
+   * @param uiId The element id
+   * @param uiDataLength The length of the element data
+   * @return a pointer to uiDataLength bytes or nullptr if the element can't be added
+   */
+  uint8_t* appendHeaderExtension(uint32_t uiId, uint32_t uiDataLength);
   /**
-   * @brief getHeaderExtensions
-   * @return
+   * @brief getHeaderExtension returns the element at index < getHeaderExtensionCount()
+   */
+  HeaderExtensionElementView getHeaderExtension(size_t index) const;
+  /**
+   * @brief findHeaderExtension returns the first element with the extmap id uiId
+   */
+  boost::optional<HeaderExtensionElementView> findHeaderExtension(uint32_t uiId) const;
+  /**
+   * @brief getHeaderExtensions returns copies of all elements. Use getHeaderExtension or
+   * findHeaderExtension on the packet path.
    */
- const std::vector<HeaderExtensionElement>& getHeaderExtensions() const;
+  std::vector<HeaderExtensionElement> getHeaderExtensions() const;
  /**
   * @brief removeHeaderExtensions removes extension elements with specified id
   * @param uiId The id of the extension elements to be removed
@@ -125,28 +145,105 @@ public:
   uint16_t getExtensionLengthInWords() const { return m_uiExtensionLengthInWords; }
   /**
    * @brief calculateExtensionProperties determines whether to use one or two byte extension,
-   * profile, extension length in words
+   * profile, extension length in words. This is done whenever a local element is added or removed.
    */
   void calculateExtensionProperties() const;
+  /**
+   * @brief write writes the extension header and the elements to pDest
+   * @param pDest Must have space for getSize() bytes
+   * @return the number of bytes written
+   */
+  uint32_t write(uint8_t* pDest) const;
   /**
    * @brief writeExtensionData
    * @param ob
    */
   void writeExtensionData(OBitStream& ob) const;
   /**
-   * @brief readExtensionData
+   * @brief readExtensionData copies the extension header and data from the bitstream
    * @param ib
    */
   void readExtensionData(IBitStream& ib);
+  /**
+   * @brief setExtensionData references the extension header and data of a received packet
+   * without copying it.
+   * @param extension The extension header followed by the extension data. The length
+   * field must have been validated against the size of the buffer.
+   */
+  void setExtensionData(const Buffer& extension);
+
+private:
+  /**
+   * @brief The Element struct locates the data of an element relative to the received
+   * extension data or to the local element storage
+   */
+  struct Element
+  {
+    uint8_t Id;
+    uint8_t Length;
+    uint32_t Offset;
+  };
+
+  /**
+   * @brief Number of elements and bytes of element data that are stored without allocating
+   */
+  static const uint32_t INLINE_ELEMENTS = 8;
+  static const uint32_t INLINE_DATA_SIZE = 64;
+
+  /**
+   * @brief buildIndex locates the elements of the received extension
+   */
+  void buildIndex();
+  const uint8_t* getElementData(const Element& element) const;
+  /**
+   * @brief copies the elements of a received extension into the local storage
+   */
+  void detach();
+
+  const Element& getElement(uint32_t uiIndex) const
+  {
+    return uiIndex < INLINE_ELEMENTS ? m_aElements[uiIndex] : m_vElementOverflow[uiIndex - INLINE_ELEMENTS];
+  }
+  Element& getElement(uint32_t uiIndex)
+  {
+    return uiIndex < INLINE_ELEMENTS ? m_aElements[uiIndex] : m_vElementOverflow[uiIndex - INLINE_ELEMENTS];
+  }
+  void pushElement(const Element& element);
+  void eraseElement(uint32_t uiIndex);
+
+  const uint8_t* getLocalData() const
+  {
+    return m_uiDataSize > INLINE_DATA_SIZE ? m_vDataOverflow.data() : m_aData;
+  }
+  uint8_t* getLocalData()
+  {
+    return m_uiDataSize > INLINE_DATA_SIZE ? m_vDataOverflow.data() : m_aData;
+  }
+  /**
+   * @brief resizeLocalData moves the local element data between the inline buffer
+   * and the heap as required. Existing data up to the new size is preserved.
+   */
+  void resizeLocalData(uint32_t uiSize);
+
 protected:
 
-  mutable RtpHeaderExtensionType m_eType;
+  RtpHeaderExtensionType m_eType;
   mutable uint16_t m_uiProfileDefined;
   uint8_t m_uiAppBits;
   mutable uint16_t m_uiExtensionLengthInWords; // excludes the standard 4 octet header
   mutable uint32_t m_uiPadding;
 
-  std::vector<HeaderExtensionElement> m_vHeaderExtensions;
+  // extension header and data of a received packet
+  Buffer m_received;
+  // elements of the received extension or the locally added elements
+  uint32_t m_uiElementCount;
+  Element m_aElements[INLINE_ELEMENTS];
+  // elements after the first INLINE_ELEMENTS
+  std::vector<Element> m_vElementOverflow;
+  // data of locally added elements: held in m_vDataOverflow once it exceeds INLINE_DATA_SIZE
+  uint32_t m_uiDataSize;
+  uint8_t m_aData[INLINE_DATA_SIZE];
+  std::vector<uint8_t> m_vDataOverflow;
 };
 
 OBitStream& operator<< (OBitStream& ostr, const RtpHeaderExtension& extension);
@@ -28,6 +28,10 @@ public:
    * an RR or SR. Instead we just check that the report falls into the RTCP range
    */
   virtual bool validateCompoundRtcpPacket(CompoundRtcpPacket compoundPacket, uint32_t uiTotalLength);
+  /**
+   * Reduced size version of rfc3550::RtcpValidator::validateCompoundRtcpView
+   */
+  virtual bool validateCompoundRtcpView(const RtcpCompoundView& compoundView, uint32_t uiTotalLength);
 
 };
 
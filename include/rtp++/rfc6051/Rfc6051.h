@@ -4,6 +4,7 @@
 #include <cpputil/BitWriter.h>
 #include <cpputil/IBitStream.h>
 #include <rtp++/rfc5285/HeaderExtensionElement.h>
+#include <rtp++/rfc5285/RtpHeaderExtension.h>
 #include <rtp++/RtpTime.h>
 
 namespace rtp_plus_plus
@@ -41,12 +42,17 @@ public:
    * @return
    */
   static rfc5285::HeaderExtensionElement create(uint32_t uiRtpSyncExtMapId, uint64_t uiNtpTimestamp);
+  /**
+   * @brief append writes the extension element directly into the header extension
+   * @return false if the element could not be added
+   */
+  static bool append(rfc5285::RtpHeaderExtension& extension, uint32_t uiRtpSyncExtMapId, uint32_t uiNtpTimestampMsw, uint32_t uiNtpTimestampLsw);
   /**
    * @brief parseRtpSynchronisationExtensionHeader
    * @param headerExtension
    * @return
    */
-  static boost::optional<uint64_t> parseRtpSynchronisationExtensionHeader(const rfc5285::HeaderExtensionElement& headerExtension);
+  static boost::optional<uint64_t> parseRtpSynchronisationExtensionHeader(const rfc5285::HeaderExtensionElementView& headerExtension);
 };
 
 } // rfc6051
@@ -52,6 +52,23 @@ public:
   void setMtu(const uint32_t uiMtu) { m_uiMtu = uiMtu; }
 
   void setDisableStap(bool bDisable) { m_bDisableStap = bDisable; }
+  /**
+   * @brief setZeroCopy configures whether RTP packets reference the data of the media
+   * samples instead of copying it. FU-A and STAP-A packets then consist of the payload
+   * headers stored in the RtpPacket and slices of the NAL units, which are gathered when
+   * the packet is written to the network. The media sample data must not be modified
+   * after packetisation.
+   */
+  void setZeroCopy(bool bZeroCopy) { m_bZeroCopy = bZeroCopy; }
+  bool isZeroCopy() const { return m_bZeroCopy; }
+  /**
+   * @brief setDeliverIncompleteNalUnits configures whether fragmented NAL units with missing
+   * fragments are delivered instead of being discarded. The missing parts are left out of the
+   * reassembled NAL unit and their positions are stored in the media sample so that the decoder
+   * can conceal them.
+   */
+  void setDeliverIncompleteNalUnits(bool bDeliver) { m_bDeliverIncompleteNalUnits = bDeliver; }
+  bool getDeliverIncompleteNalUnits() const { return m_bDeliverIncompleteNalUnits; }
 
   virtual std::vector<RtpPacket> packetise(const media::MediaSample& mediaSample);
   virtual std::vector<RtpPacket> packetise(const std::vector<media::MediaSample>& mediaSample);
@@ -61,11 +78,14 @@ public:
   virtual std::vector<media::MediaSample> depacketize(const RtpPacketGroup& rtpPacketGroup);
 
 private:
-  bool handleStapA(IBitStream& in, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
-  bool handleStapB(IBitStream& in, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
+  bool handleStapA(IBitStream& in, const Buffer& rawData, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
+  bool handleStapB(IBitStream& in, const Buffer& rawData, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
 
-  std::list<RtpPacket>::const_iterator handleFuA(IBitStream& in, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itNextFu, std::vector<media::MediaSample>& vSamples, uint32_t uiStartSN, uint32_t forbidden, uint32_t nri, const RtpPacketGroup& rtpPacketGroup);
-  std::list<RtpPacket>::const_iterator handleFuB(IBitStream& in, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itNextFu, std::vector<media::MediaSample>& vSamples, uint32_t uiStartSN, uint32_t forbidden, uint32_t nri, const RtpPacketGroup& rtpPacketGroup);
+  /**
+   * @brief handleFu reassembles the NAL unit fragmented into the FU-A or FU-B starting at itFirstFu
+   * @return an iterator to the first packet that does not belong to the fragmented NAL unit
+   */
+  std::list<RtpPacket>::const_iterator handleFu(const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itFirstFu, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
 
   std::list<RtpPacket>::const_iterator extractNextMediaSample(const RtpPacketGroup& rtpPacketGroup, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<media::MediaSample>& vMediaSamples);
 
@@ -104,9 +124,9 @@ private:
   uint32_t m_uiSessionBandwidthKbps;
   uint32_t m_uiEstimatedFrameSize;
 
-  OBitStream m_outputStream;
-
   bool m_bDisableStap;
+  bool m_bZeroCopy;
+  bool m_bDeliverIncompleteNalUnits;
 };
 
 static std::unique_ptr<rfc6184::Rfc6184Packetiser> create()
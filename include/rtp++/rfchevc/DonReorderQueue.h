@@ -0,0 +1,164 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <rtp++/media/MediaSample.h>
+
+namespace rtp_plus_plus
+{
+namespace rfchevc
+{
+
+/**
+ * @brief The DonReorderQueue class restores the decoding order of NAL units that were
+ * received with DONL/DOND fields i.e. when sprop-max-don-diff is greater than 0.
+ *
+ * The 16-bit DON of each NAL unit is unwrapped to an absolute DON relative to the NAL unit
+ * received before it. Waiting NAL units are stored in a ring indexed by the absolute DON so
+ * that insertion and release are O(1). A NAL unit is released as soon as all NAL units that
+ * precede it in decoding order have been released. Since no NAL unit can follow a NAL unit
+ * in transmission order if it precedes it by more than sprop-max-don-diff in decoding order,
+ * gaps further than that behind the newest NAL unit are skipped as lost.
+ */
+class DonReorderQueue
+{
+public:
+  explicit DonReorderQueue(uint32_t uiMaxDonDiff = 0)
+  {
+    setMaxDonDiff(uiMaxDonDiff);
+  }
+  /**
+   * @brief setMaxDonDiff sets sprop-max-don-diff and resets the queue
+   */
+  void setMaxDonDiff(uint32_t uiMaxDonDiff)
+  {
+    m_uiMaxDonDiff = uiMaxDonDiff;
+    uint32_t uiCapacity = 1;
+    while (uiCapacity <= uiMaxDonDiff) uiCapacity <<= 1;
+    m_vSlots.assign(uiCapacity, media::MediaSample());
+    m_vOccupied.assign(uiCapacity, false);
+    m_uiMask = uiCapacity - 1;
+    reset();
+  }
+  uint32_t getMaxDonDiff() const { return m_uiMaxDonDiff; }
+  /**
+   * @brief reset discards the waiting NAL units and the DON history
+   */
+  void reset()
+  {
+    for (size_t i = 0; i < m_vSlots.size(); ++i)
+    {
+      if (m_vOccupied[i])
+      {
+        m_vSlots[i] = media::MediaSample();
+        m_vOccupied[i] = false;
+      }
+    }
+    m_bStarted = false;
+    m_uiLastDon = 0;
+    m_iLastAbsDon = 0;
+    m_iNextAbsDon = 0;
+    m_iHighestAbsDon = 0;
+    m_uiSize = 0;
+  }
+  /**
+   * @brief getSize returns the number of NAL units waiting for preceding NAL units
+   */
+  uint32_t getSize() const { return m_uiSize; }
+  /**
+   * @brief push inserts a NAL unit and appends the NAL units that can be released to vOut
+   * in decoding order
+   * @return false if the NAL unit was discarded because it is a duplicate or arrived after
+   * NAL units following it in decoding order had been released
+   */
+  bool push(const media::MediaSample& mediaSample, std::vector<media::MediaSample>& vOut)
+  {
+    const uint16_t uiDon = static_cast<uint16_t>(mediaSample.getDecodingOrderNumber());
+    int64_t iAbsDon = uiDon;
+    if (!m_bStarted)
+    {
+      m_bStarted = true;
+      m_iNextAbsDon = iAbsDon;
+      m_iHighestAbsDon = iAbsDon;
+    }
+    else
+    {
+      iAbsDon = m_iLastAbsDon + static_cast<int16_t>(uiDon - m_uiLastDon);
+    }
+    m_uiLastDon = uiDon;
+    m_iLastAbsDon = iAbsDon;
+
+    if (iAbsDon < m_iNextAbsDon)
+    {
+      return false;
+    }
+    if (iAbsDon > m_iHighestAbsDon)
+    {
+      m_iHighestAbsDon = iAbsDon;
+      if (m_uiSize == 0 && m_iHighestAbsDon - m_iNextAbsDon > m_uiMaxDonDiff)
+      {
+        // nothing is waiting: skip the gap at once
+        m_iNextAbsDon = m_iHighestAbsDon - m_uiMaxDonDiff;
+      }
+      while (m_iHighestAbsDon - m_iNextAbsDon > m_uiMaxDonDiff)
+      {
+        releaseNext(vOut);
+      }
+    }
+
+    const uint32_t uiIndex = static_cast<uint32_t>(iAbsDon) & m_uiMask;
+    if (m_vOccupied[uiIndex])
+    {
+      return false;
+    }
+    m_vSlots[uiIndex] = mediaSample;
+    m_vOccupied[uiIndex] = true;
+    ++m_uiSize;
+
+    while (m_uiSize > 0 && m_vOccupied[static_cast<uint32_t>(m_iNextAbsDon) & m_uiMask])
+    {
+      releaseNext(vOut);
+    }
+    return true;
+  }
+  /**
+   * @brief flush releases all waiting NAL units in decoding order e.g. at the end of a stream
+   */
+  void flush(std::vector<media::MediaSample>& vOut)
+  {
+    while (m_uiSize > 0)
+    {
+      releaseNext(vOut);
+    }
+  }
+
+private:
+  /**
+   * @brief releaseNext releases the NAL unit with the next absolute DON if it was received
+   */
+  void releaseNext(std::vector<media::MediaSample>& vOut)
+  {
+    const uint32_t uiIndex = static_cast<uint32_t>(m_iNextAbsDon) & m_uiMask;
+    if (m_vOccupied[uiIndex])
+    {
+      vOut.push_back(m_vSlots[uiIndex]);
+      m_vSlots[uiIndex] = media::MediaSample();
+      m_vOccupied[uiIndex] = false;
+      --m_uiSize;
+    }
+    ++m_iNextAbsDon;
+  }
+
+  std::vector<media::MediaSample> m_vSlots;
+  std::vector<bool> m_vOccupied;
+  uint32_t m_uiMask;
+  uint32_t m_uiMaxDonDiff;
+  bool m_bStarted;
+  uint16_t m_uiLastDon;
+  int64_t m_iLastAbsDon;
+  int64_t m_iNextAbsDon;
+  int64_t m_iHighestAbsDon;
+  uint32_t m_uiSize;
+};
+
+} // rfchevc
+} // rtp_plus_plus
@@ -1,7 +1,7 @@
 #pragma once
 #include <vector>
-#include <cpputil/OBitStream.h>
 #include <rtp++/PayloadPacketiserBase.h>
+#include <rtp++/rfchevc/DonReorderQueue.h>
 #include <rtp++/media/h265/H265NalUnitTypes.h>
 
 #define DEFAULT_MTU 1500
@@ -14,18 +14,20 @@ namespace rfchevc
 /// @def DEBUG_NAL_UNIT_TYPES Debug information about the next Nal Unit Type
 // #define DEBUG_NAL_UNIT_TYPES
 
-/// @def DEBUG_RFC6184_PACKETIZATION Verbose logging during parsing
-// #define DEBUG_RFC6184_PACKETIZATION
+/// @def DEBUG_RFCHEVC_PACKETIZATION Verbose logging during parsing
+// #define DEBUG_RFCHEVC_PACKETIZATION
 
 /**
-  * RFC6184 RTP packetiser implementation
-  * This implementation currently implements SINGLE_NAL_UNIT_MODE and NON_INTERLEAVED_MODE.
-  * NOTE: The packetiser has to buffer packets until it can determine that an
-  * access unit is complete in order to be able to set the sample time as well as the marker bit.
-  * The rules for determining the end of an access unit are in the standard
-  * But for simplicity sake, we have configured ffmpeg to output Access Unit Delimiters
-  * in the stream:
-  * THIS CODE WILL NOT FUNCTION CORRECTLY IF AUDs ARE NOT PRESENT.
+  * HEVC RTP packetiser implementation (RFC 7798)
+  * NAL units that fit into the MTU are sent as single NAL unit packets or aggregated into
+  * APs, larger NAL units are fragmented into FUs. In INTERLEAVED_MODE the packets carry
+  * DONL and DOND fields (sprop-max-don-diff > 0) and the depacketiser restores the decoding
+  * order of the NAL units with a DonReorderQueue. Samples without a decoding order number
+  * are numbered sequentially by the packetiser.
+  *
+  * All payload headers are decoded and encoded byte-wise. The packets are built from slices
+  * of the media samples with the payload headers stored in the RtpPacket. Unless zero copy
+  * is enabled the payload is copied into one buffer before the packet is returned.
   */
 class RfchevcPacketiser : public PayloadPacketiserBase
 {
@@ -49,6 +51,21 @@ public:
 
   uint32_t getMtu() const { return m_uiMtu; }
   void setMtu(const uint32_t uiMtu) { m_uiMtu = uiMtu; }
+  /**
+   * @brief setMaxDonDiff sets sprop-max-don-diff: the maximum difference in decoding order
+   * between a NAL unit and the NAL units that follow it in transmission order. This
+   * determines how long the depacketiser waits for NAL units that are missing in decoding
+   * order in INTERLEAVED_MODE.
+   */
+  void setMaxDonDiff(uint32_t uiMaxDonDiff) { m_reorderQueue.setMaxDonDiff(uiMaxDonDiff); }
+  uint32_t getMaxDonDiff() const { return m_reorderQueue.getMaxDonDiff(); }
+  /**
+   * @brief setZeroCopy configures whether RTP packets reference the data of the media
+   * samples instead of copying it. The media sample data must not be modified after
+   * packetisation.
+   */
+  void setZeroCopy(bool bZeroCopy) { m_bZeroCopy = bZeroCopy; }
+  bool isZeroCopy() const { return m_bZeroCopy; }
 
   virtual std::vector<RtpPacket> packetise(const media::MediaSample& mediaSample);
   virtual std::vector<RtpPacket> packetise(const std::vector<media::MediaSample>& mediaSample);
@@ -56,44 +73,51 @@ public:
   // Not every call to depacketize results in a media sample
   // some calls might results in multiple samples
   virtual std::vector<media::MediaSample> depacketize(const RtpPacketGroup& rtpPacketGroup);
+  /**
+   * @brief flush returns the NAL units that are still waiting for NAL units preceding
+   * them in decoding order e.g. at the end of a stream
+   */
+  std::vector<media::MediaSample> flush();
 
 private:
-  bool handleAPA(IBitStream& in, std::vector<media::MediaSample>& vSamples, uint32_t RtpTime);
-  bool handleAPB(IBitStream& in, std::vector<media::MediaSample>& vSamples, uint32_t RtpTime);
-
-  std::list<RtpPacket>::const_iterator handleFuA(IBitStream& in, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itNextFu, std::vector<media::MediaSample>& vSamples, uint32_t uiStartSN, uint32_t forbidden, uint32_t layerId, uint32_t tempId, uint32_t RtpTime );
-  std::list<RtpPacket>::const_iterator handleFuB(IBitStream& in, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itNextFu, std::vector<media::MediaSample>& vSamples, uint32_t uiStartSN, uint32_t forbidden, uint32_t layerId, uint32_t tempId, uint32_t RtpTime );
-
-  std::list<RtpPacket>::const_iterator extractNextMediaSample(const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<media::MediaSample>& vMediaSamples);
-
-  RtpPacket packetiseSingleNalUnit(const media::MediaSample& mediaSample);
-  std::vector<RtpPacket> packetiseNonInterleaved(const media::MediaSample& mediaSample);
-  std::vector<RtpPacket> packetiseNonInterleaved(const std::vector<media::MediaSample>& mediaSamples);
-
-  std::vector<RtpPacket> packetiseInterleaved(const media::MediaSample& mediaSample);
-  std::vector<RtpPacket> packetiseInterleaved(const std::vector<media::MediaSample>& mediaSamples);
+  /**
+   * @brief handleAp extracts the NAL units of an aggregation packet
+   */
+  void handleAp(const RtpPacket& rtpPacket, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
+  /**
+   * @brief handleFu reassembles the NAL unit fragmented into the FUs starting at itFirstFu
+   * @return an iterator to the first packet that does not belong to the fragmented NAL unit
+   */
+  std::list<RtpPacket>::const_iterator handleFu(const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itFirstFu, std::vector<media::MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup);
 
-  std::vector<media::MediaSample> depacketizeSingleNalUnit(const std::list<RtpPacket>& rtpPackets);
-  std::vector<media::MediaSample> depacketizeNonInterleaved(const std::list<RtpPacket>& rtpPackets);
-  std::vector<media::MediaSample> depacketizeInterleaved(const std::list<RtpPacket>& rtpPackets);
+  std::list<RtpPacket>::const_iterator extractNextMediaSample(const RtpPacketGroup& rtpPacketGroup, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<media::MediaSample>& vMediaSamples);
 
-  std::vector<RtpPacket> packetiseFuA(const media::MediaSample& mediaSample);
-  std::vector<RtpPacket> packetiseFuB(const media::MediaSample& mediaSample);
+  RtpPacket packetiseSingleNalUnit(const media::MediaSample& mediaSample, uint16_t uiDon);
+  std::vector<RtpPacket> packetiseFu(const media::MediaSample& mediaSample, uint16_t uiDon);
+  RtpPacket packetiseAp(const std::vector<media::MediaSample>& mediaSamples, uint32_t uiStartIndex, uint32_t uiCount);
+  /**
+   * @brief hasDonl returns true if the packets carry DONL and DOND fields
+   */
+  bool hasDonl() const;
+  /**
+   * @brief assignDon returns the DON of the sample or the next DON of the sender
+   * if the sample has none, and advances the sender DON
+   */
+  uint16_t assignDon(const media::MediaSample& mediaSample);
+  /**
+   * @brief finalisePacket copies the gathered payload into one buffer unless zero copy is enabled
+   */
+  void finalisePacket(RtpPacket& rtpPacket);
 
   /**
-   * @brief getNumberOfSamplesToAggregate This method returns
+   * @brief getNumberOfSamplesToAggregate returns the number of samples starting at uiStartIndex
+   * that fit into one AP. In INTERLEAVED_MODE the DON differences must fit into the DOND field.
    * @param uiBytesAvailableForPayload The bytes available for aggregation
    * @param mediaSamples The vector containing the media samples
    * @param uiStartIndex The start index into mediaSamples
-   * @param uiStapSize The size of the resulting STAP-A
-   * @param bFBit The F-bit according to RFC6184.
-   * @param uiNri The NRI-bits according to RFC6184
-   * @return the number of samples in the vector that can be aggregated into an STAP-A
    */
-  int32_t getNumberOfSamplesToAggregate(uint32_t uiBytesAvailableForPayload, const std::vector<media::MediaSample>& mediaSamples,
-                                        uint32_t uiStartIndex, uint32_t& uiStapSize,
-                                        bool& bFBit,  uint32_t& uiLayerId, uint32_t& uiTempId, bool Interleaved=false);
-
+  uint32_t getNumberOfSamplesToAggregate(uint32_t uiBytesAvailableForPayload, const std::vector<media::MediaSample>& mediaSamples,
+                                         uint32_t uiStartIndex) const;
 
   /// for debugging
   void printPacketListInfo(const std::list<RtpPacket>& dataList);
@@ -102,9 +126,12 @@ private:
   uint32_t m_uiMtu;
   uint32_t m_uiBytesAvailableForPayload;
   uint32_t m_uiSessionBandwidthKbps;
-  uint32_t m_uiEstimatedFrameSize;
-
-  OBitStream m_outputStream;
+  bool m_bZeroCopy;
+  // DON assigned to samples without one
+  uint16_t m_uiNextDon;
+  // DONs of the samples being packetised
+  std::vector<uint16_t> m_vDons;
+  DonReorderQueue m_reorderQueue;
 };
 
 static std::unique_ptr<rfchevc::RfchevcPacketiser> create()
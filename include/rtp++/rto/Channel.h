@@ -1,10 +1,10 @@
 #pragma once
-#include <unordered_map>
 #include <vector>
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
+#include <boost/bind.hpp>
 #include <rtp++/network/EndPoint.h>
 #include <rtp++/network/NetworkPacket.h>
+#include <rtp++/util/TimerService.h>
 
 namespace rtp_plus_plus
 {
@@ -36,7 +36,8 @@ public:
     m_fnOnRtp(fnOnRtp),
     m_fnOnRtcp(fnOnRtcp),
     m_uiIndex(0),
-    m_rIoService(rIoService)
+    m_rTimerService(boost::asio::use_service<TimerService>(rIoService)),
+    m_uiTimerGroup(m_rTimerService.createGroup())
   {
 
   }
@@ -56,11 +57,7 @@ public:
   void stop()
   {
     // RTX
-    std::for_each(m_mTimers.begin(), m_mTimers.end(), [this](const std::pair<boost::asio::deadline_timer*, boost::asio::deadline_timer*>& pair)
-    {
-      pair.second->cancel();
-    });
-    m_mTimers.clear();
+    m_rTimerService.cancel(m_uiTimerGroup);
   }
 
   /**
@@ -108,20 +105,19 @@ private:
     if (uiRand >= m_uiPacketLossProbability)
     {
       uint32_t uiDelayUs = getDelayUs();
-      boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
-      pTimer->expires_from_now(boost::posix_time::microseconds(uiDelayUs));
-      pTimer->async_wait(boost::bind(&Channel::schedulePacket, this, _1, pTimer, packet, from, to, bRtp) );
+      m_rTimerService.expiresFromNow(boost::posix_time::microseconds(uiDelayUs),
+                                     boost::bind(&Channel::schedulePacket, this, _1, packet, from, to, bRtp),
+                                     m_uiTimerGroup);
   #ifdef DEBUG_CHANNEL
       if (bRtp)
           VLOG(10) << "RTP Packet scheduled from " << from << " to " << to << " in " << uiDelayUs << "us";
       else
         VLOG(10) << "RTCP packet scheduled from " << from << " to " << to << " in " << uiDelayUs << "us";
   #endif
-      m_mTimers.insert(std::make_pair(pTimer, pTimer));
     }
   }
 
-  void schedulePacket(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, NetworkPacket packet, const EndPoint& from, const EndPoint& to, bool bRtp)
+  void schedulePacket(const boost::system::error_code& ec, NetworkPacket packet, const EndPoint& from, const EndPoint& to, bool bRtp)
   {
     if (!ec)
     {
@@ -130,9 +126,6 @@ private:
       else
         m_fnOnRtcp(packet, from, to);
     }
-
-    m_mTimers.erase(pTimer);
-    delete pTimer;
   }
 
 private:
@@ -146,10 +139,10 @@ private:
   std::vector<double> m_vDelays;
   /// index of next delay reading
   std::size_t m_uiIndex;
-  /// io_service for delay timer
-  boost::asio::io_service& m_rIoService;
-  /// Timers for delay simulation
-  std::unordered_map<boost::asio::deadline_timer*, boost::asio::deadline_timer*> m_mTimers;
+  /// Shared timer service for delay simulation
+  TimerService& m_rTimerService;
+  /// Timer group of the delayed packets
+  uint32_t m_uiTimerGroup;
 };
 
 }
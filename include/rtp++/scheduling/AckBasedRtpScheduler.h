@@ -45,6 +45,18 @@ public:
    * @param ep
    */
   void processFeedback(const rfc4585::RtcpFb& fb, const EndPoint& ep);
+  /**
+   * @brief processNacks
+   * @param nacks
+   * @param ep
+   */
+  void processNacks(const std::vector<uint16_t>& nacks, const EndPoint& ep);
+  /**
+   * @brief processAcks
+   * @param acks
+   * @param ep
+   */
+  void processAcks(const std::vector<uint16_t>& acks, const EndPoint& ep);
   /**
    * @brief retrieveFeedback
    * @return
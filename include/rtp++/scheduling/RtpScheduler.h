@@ -74,6 +74,18 @@ public:
    * @param ep
    */
   virtual void processFeedback(const rfc4585::RtcpFb& /*fb*/, const EndPoint& /*ep*/){}
+  /**
+   * @brief processNacks part of sender interface for generic NACKs read in place
+   * @param nacks
+   * @param ep
+   */
+  virtual void processNacks(const std::vector<uint16_t>& /*nacks*/, const EndPoint& /*ep*/){}
+  /**
+   * @brief processAcks part of sender interface for generic ACKs read in place
+   * @param acks
+   * @param ep
+   */
+  virtual void processAcks(const std::vector<uint16_t>& /*acks*/, const EndPoint& /*ep*/){}
   /**
    * @brief onIncomingRtp part of receiver interface
    * @param rtpPacket
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <cpputil/Buffer.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The BufferPool class is a size-classed, per-thread pool for Buffer memory.
+ *
+ * Requests are rounded up to the smallest size class that fits: MTU sized
+ * (network packets), jumbo and frame sized (media samples). The unused part
+ * of the memory block is stored as post buffer so that getSize() returns the
+ * requested size. Memory is returned to the pool of the releasing thread when
+ * the last Buffer referencing it is destroyed. Requests larger than the frame
+ * class are allocated from the heap and counted as misses.
+ *
+ * Each thread has its own free lists so allocation does not require any locking.
+ */
+class BufferPool : private boost::noncopyable
+{
+public:
+  enum SizeClass
+  {
+    SC_MTU = 0,
+    SC_JUMBO = 1,
+    SC_FRAME = 2,
+    SC_NUM_CLASSES = 3
+  };
+
+  static const uint32_t MTU_BUFFER_SIZE = 2048;
+  static const uint32_t JUMBO_BUFFER_SIZE = 9216;
+  static const uint32_t FRAME_BUFFER_SIZE = 262144;
+
+  /**
+   * @brief Pool statistics for one size class, aggregated over all threads
+   */
+  struct Statistics
+  {
+    Statistics()
+      :Hits(0), Misses(0), Outstanding(0), HighWaterMark(0)
+    {
+    }
+
+    // allocations served from a free list
+    uint64_t Hits;
+    // allocations that required a heap allocation
+    uint64_t Misses;
+    // blocks currently referenced by a Buffer
+    uint64_t Outstanding;
+    // maximum number of blocks that were outstanding at the same time
+    uint64_t HighWaterMark;
+  };
+
+  /**
+   * @brief allocate returns a Buffer of uiSize bytes from the pool of the calling thread.
+   * @param uiSize The size of the buffer
+   * @param uiPreBufferSize The number of bytes reserved in front of the data
+   * @param uiPostBufferSize The minimum number of bytes reserved after the data
+   */
+  static Buffer allocate(uint32_t uiSize, uint32_t uiPreBufferSize = 0, uint32_t uiPostBufferSize = 0);
+  /**
+   * @brief getStatistics returns the statistics of the specified size class
+   */
+  static Statistics getStatistics(SizeClass eClass);
+
+  ~BufferPool();
+
+private:
+  /**
+   * @brief Deleter of the shared array: returns the block to the pool of the releasing thread
+   */
+  struct Deleter
+  {
+    Deleter(SizeClass eClass) :m_eClass(eClass) {}
+    void operator()(uint8_t* pBlock) const;
+    SizeClass m_eClass;
+  };
+
+  BufferPool();
+
+  static BufferPool* getThreadInstance();
+
+  Buffer allocateFromClass(SizeClass eClass, uint32_t uiSize, uint32_t uiPreBufferSize);
+
+  // free blocks per size class
+  std::vector<uint8_t*> m_vFreeBlocks[SC_NUM_CLASSES];
+};
+
+std::ostream& operator<<(std::ostream& ostr, const BufferPool::Statistics& stats);
+
+} // rtp_plus_plus
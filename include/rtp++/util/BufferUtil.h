@@ -0,0 +1,24 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <cpputil/Buffer.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief sliceBuffer returns a buffer that shares the refcounted storage of
+ * buffer but only exposes uiSize bytes starting at uiOffset. The bytes outside
+ * the slice are moved into the pre and post buffer so no memory is allocated
+ * or copied. Writing to the slice modifies the original buffer.
+ */
+static Buffer sliceBuffer(const Buffer& buffer, uint32_t uiOffset, uint32_t uiSize)
+{
+  assert(uiOffset + uiSize <= buffer.getSize());
+  Buffer slice(buffer);
+  slice.setPreBufferSize(buffer.getPreBufferSize() + uiOffset);
+  slice.setPostBufferSize(buffer.getPostBufferSize() + buffer.getSize() - uiOffset - uiSize);
+  return slice;
+}
+
+} // rtp_plus_plus
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The Clock class is the time source of the packet path.
+ *
+ * Times are int64 nanoseconds:
+ * - monotonic time has an arbitrary epoch and is used for intervals and timeouts,
+ * - real time is measured since the unix epoch and is used for NTP, RTP arrival and
+ *   presentation times.
+ *
+ * The system clock is used unless another clock has been installed with Clock::install,
+ * e.g. a VirtualClock in tests and simulations.
+ */
+class Clock
+{
+public:
+  static const int64_t NS_PER_SECOND = 1000000000LL;
+
+  virtual ~Clock() {}
+  virtual int64_t getMonotonicNs() const = 0;
+  virtual int64_t getRealtimeNs() const = 0;
+
+  /**
+   * @brief install makes pClock the clock used by rtp++. Passing nullptr restores the
+   * system clock. The clock must outlive its installation. Clocks should be installed
+   * before sessions are started as the switch is not synchronised with readers.
+   */
+  static void install(const Clock* pClock);
+  /**
+   * @brief instance returns the installed clock
+   */
+  static const Clock& instance() { return *s_pClock; }
+  static int64_t monotonicNs() { return s_pClock->getMonotonicNs(); }
+  static int64_t realtimeNs() { return s_pClock->getRealtimeNs(); }
+  /**
+   * @brief universalTime returns the real time of the installed clock for code that
+   * still works with boost::posix_time
+   */
+  static boost::posix_time::ptime universalTime() { return toPosixTime(realtimeNs()); }
+  /**
+   * @brief converts nanoseconds since the unix epoch to ptime. 0 maps to not_a_date_time.
+   */
+  static boost::posix_time::ptime toPosixTime(int64_t iUnixNs);
+  /**
+   * @brief converts ptime to nanoseconds since the unix epoch. not_a_date_time maps to 0.
+   */
+  static int64_t fromPosixTime(const boost::posix_time::ptime& t);
+
+private:
+  static const Clock* s_pClock;
+};
+
+/**
+ * @brief The SystemClock class reads CLOCK_MONOTONIC and CLOCK_REALTIME, which are
+ * served from the vDSO on Linux.
+ */
+class SystemClock : public Clock
+{
+public:
+  virtual int64_t getMonotonicNs() const;
+  virtual int64_t getRealtimeNs() const;
+};
+
+/**
+ * @brief The VirtualClock class only advances when told to. Monotonic and real time
+ * advance together.
+ */
+class VirtualClock : public Clock
+{
+public:
+  explicit VirtualClock(int64_t iRealtimeNs = 0);
+
+  virtual int64_t getMonotonicNs() const { return m_iNowNs.load() - m_iStartNs; }
+  virtual int64_t getRealtimeNs() const { return m_iNowNs.load(); }
+
+  void advanceNs(int64_t iNs) { m_iNowNs += iNs; }
+  void advance(const boost::posix_time::time_duration& duration) { advanceNs(duration.total_microseconds() * 1000); }
+
+private:
+  const int64_t m_iStartNs;
+  std::atomic<int64_t> m_iNowNs;
+};
+
+} // rtp_plus_plus
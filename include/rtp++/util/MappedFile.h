@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cpputil/Buffer.h>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The MappedFile class provides access to the contents of a file that is memory
+ * mapped.
+ *
+ * Buffers returned by getBuffer() reference the mapping directly and keep it alive, so
+ * media samples can be handed out without copying and may outlive the media source
+ * that created them. The file is mapped copy-on-write: code that modifies media samples
+ * in place, e.g. GeneratedMediaSource, gets private copies of the touched pages and the
+ * file is never modified. Such modifications are visible to all buffers referencing the
+ * same part of the file though. Streams that are not backed by a file can be read into
+ * memory to get the same interface.
+ *
+ * The file must not be truncated while it is mapped: accessing a page beyond the new end
+ * of the file raises SIGBUS (EXCEPTION_IN_PAGE_ERROR on Windows) and terminates the
+ * process. Pages that have not been modified may also reflect changes that other
+ * processes make to the file.
+ */
+class MappedFile : public boost::enable_shared_from_this<MappedFile>, private boost::noncopyable
+{
+public:
+  typedef boost::shared_ptr<MappedFile> ptr;
+
+  /**
+   * @brief map maps the file copy-on-write
+   * @return The mapped file or a null pointer if the file could not be opened or mapped
+   */
+  static ptr map(const std::string& sFilename);
+  /**
+   * @brief read reads the remainder of the stream into memory
+   */
+  static ptr read(std::istream& in);
+
+  ~MappedFile();
+  /**
+   * @brief data returns a pointer to the first byte of the file
+   */
+  const uint8_t* data() const { return m_pData; }
+  /**
+   * @brief getSize returns the size of the file in bytes
+   */
+  uint64_t getSize() const { return m_uiSize; }
+  /**
+   * @brief isMapped returns true if the file is memory mapped and false if it was read
+   * into memory
+   */
+  bool isMapped() const { return m_bMapped; }
+  /**
+   * @brief getBuffer returns a buffer that references uiSize bytes starting at uiOffset
+   * without copying them. The file stays mapped as long as the buffer is referenced.
+   */
+  Buffer getBuffer(uint64_t uiOffset, uint32_t uiSize) const;
+
+private:
+  MappedFile();
+
+  const uint8_t* m_pData;
+  uint64_t m_uiSize;
+  bool m_bMapped;
+  // contents of streams that were read into memory
+  std::vector<uint8_t> m_vData;
+};
+
+} // rtp_plus_plus
@@ -0,0 +1,171 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief Bounded lock-free ring buffer for multiple producers and a single consumer.
+ *
+ * Each slot carries a sequence number (D. Vyukov's bounded queue): producers claim
+ * a slot by advancing the tail with a CAS and publish the element by storing the
+ * slot sequence. The consumer reads elements in place from the head, so an element
+ * can stay in the queue while an asynchronous operation on it is in flight.
+ *
+ * push() may be called from any thread. front(), peek() and pop() must only be
+ * called by one consumer at a time.
+ */
+template <typename T>
+class MpscRingBuffer : private boost::noncopyable
+{
+public:
+  /**
+   * @brief Constructor
+   * @param uiCapacity Max number of elements. Rounded up to the next power of 2.
+   */
+  MpscRingBuffer(size_t uiCapacity)
+    :m_uiHead(0),
+    m_uiTail(0)
+  {
+    size_t uiSize = 2;
+    while (uiSize < uiCapacity) uiSize <<= 1;
+    m_uiMask = uiSize - 1;
+    m_vSlots = std::vector<Slot>(uiSize);
+    for (size_t i = 0; i < uiSize; ++i)
+    {
+      m_vSlots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  /**
+   * @brief returns the max number of elements
+   */
+  size_t capacity() const { return m_uiMask + 1; }
+  /**
+   * @brief push appends an element. Returns false if the queue is full.
+   */
+  bool push(const T& element)
+  {
+    size_t uiPos = m_uiTail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Slot& slot = m_vSlots[uiPos & m_uiMask];
+      size_t uiSequence = slot.Sequence.load(std::memory_order_acquire);
+      intptr_t iDiff = static_cast<intptr_t>(uiSequence) - static_cast<intptr_t>(uiPos);
+      if (iDiff == 0)
+      {
+        if (m_uiTail.compare_exchange_weak(uiPos, uiPos + 1, std::memory_order_relaxed))
+        {
+          slot.Element = element;
+          slot.Sequence.store(uiPos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (iDiff < 0)
+      {
+        // the consumer has not released the slot yet
+        return false;
+      }
+      else
+      {
+        uiPos = m_uiTail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  /**
+   * @brief pushBulk appends uiCount consecutive elements, or none if there is not enough space.
+   * @param fnElement Called with the index 0..uiCount-1 and returns the element to append
+   */
+  template <typename F>
+  bool pushBulk(size_t uiCount, F fnElement)
+  {
+    if (uiCount == 0) return true;
+    if (uiCount > capacity()) return false;
+    size_t uiPos = m_uiTail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      // all slots must have been released by the consumer: only the CAS winner can claim them
+      size_t i = 0;
+      for (; i < uiCount; ++i)
+      {
+        size_t uiSequence = m_vSlots[(uiPos + i) & m_uiMask].Sequence.load(std::memory_order_acquire);
+        if (uiSequence != uiPos + i) break;
+      }
+      if (i == uiCount)
+      {
+        if (m_uiTail.compare_exchange_weak(uiPos, uiPos + uiCount, std::memory_order_relaxed))
+        {
+          for (i = 0; i < uiCount; ++i)
+          {
+            Slot& slot = m_vSlots[(uiPos + i) & m_uiMask];
+            slot.Element = fnElement(i);
+            slot.Sequence.store(uiPos + i + 1, std::memory_order_release);
+          }
+          return true;
+        }
+      }
+      else
+      {
+        intptr_t iDiff = static_cast<intptr_t>(m_vSlots[(uiPos + i) & m_uiMask].Sequence.load(std::memory_order_relaxed)) - static_cast<intptr_t>(uiPos + i);
+        // the consumer has not released the slot yet
+        if (iDiff < 0) return false;
+        uiPos = m_uiTail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  /**
+   * @brief front returns the oldest element or NULL if it has not been published yet
+   */
+  T* front() { return peek(0); }
+  /**
+   * @brief peek returns the element at uiIndex from the head or NULL if it has not been published yet
+   */
+  T* peek(size_t uiIndex)
+  {
+    if (uiIndex > m_uiMask) return NULL;
+    size_t uiPos = m_uiHead + uiIndex;
+    Slot& slot = m_vSlots[uiPos & m_uiMask];
+    if (slot.Sequence.load(std::memory_order_acquire) != uiPos + 1) return NULL;
+    return &slot.Element;
+  }
+  /**
+   * @brief pop removes the oldest element. front() must have returned the element.
+   */
+  void pop()
+  {
+    Slot& slot = m_vSlots[m_uiHead & m_uiMask];
+    assert(slot.Sequence.load(std::memory_order_relaxed) == m_uiHead + 1);
+    // release references held by the element
+    slot.Element = T();
+    slot.Sequence.store(m_uiHead + m_uiMask + 1, std::memory_order_release);
+    ++m_uiHead;
+  }
+
+private:
+  struct Slot
+  {
+    Slot() :Sequence(0) {}
+    Slot(const Slot& other) :Sequence(other.Sequence.load()), Element(other.Element) {}
+    Slot& operator=(const Slot& other)
+    {
+      Sequence.store(other.Sequence.load());
+      Element = other.Element;
+      return *this;
+    }
+    std::atomic<size_t> Sequence;
+    T Element;
+  };
+
+  std::vector<Slot> m_vSlots;
+  size_t m_uiMask;
+  // only accessed by the consumer
+  size_t m_uiHead;
+  // producers and consumer are kept on different cache lines
+  char m_pad[64];
+  std::atomic<size_t> m_uiTail;
+};
+
+} // rtp_plus_plus
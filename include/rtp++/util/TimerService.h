@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace rtp_plus_plus
+{
+
+/**
+ * @brief The TimerService class multiplexes one-shot deadlines onto a single asio timer
+ * per io_service.
+ *
+ * Pending deadlines are kept in a min-heap and the asio timer is always armed for the
+ * earliest one. This replaces allocating a deadline_timer per scheduled event on hot paths
+ * such as sample playout. There is one instance per io_service:
+ *
+ *   TimerService& timerService = boost::asio::use_service<TimerService>(ioService);
+ *
+ * Handlers are called with a default error code on expiry. Timers can be grouped so that
+ * an owner can cancel all of its pending timers at once: the handlers are then posted
+ * with boost::asio::error::operation_aborted, as with deadline_timer::cancel.
+ * All methods are thread-safe.
+ *
+ * Deadlines are in the real time of the installed Clock. A VirtualClock does not advance
+ * with the asio timer, so simulations call poll() after advancing it.
+ */
+class TimerService : public boost::asio::io_service::service
+{
+public:
+  typedef boost::function<void (const boost::system::error_code&)> Handler_t;
+
+  /// group of timers that are never cancelled
+  static const uint32_t NO_GROUP = 0;
+
+  static boost::asio::io_service::id id;
+
+  explicit TimerService(boost::asio::io_service& ioService);
+  ~TimerService();
+  /**
+   * @brief createGroup returns a new group id for use with expiresAt and cancel
+   */
+  uint32_t createGroup();
+  /**
+   * @brief expiresAt schedules handler to be called at tDeadline (UTC of Clock::universalTime)
+   */
+  void expiresAt(const boost::posix_time::ptime& tDeadline, const Handler_t& handler, uint32_t uiGroup = NO_GROUP);
+  /**
+   * @brief expiresFromNow schedules handler to be called once duration has elapsed
+   */
+  void expiresFromNow(const boost::posix_time::time_duration& duration, const Handler_t& handler, uint32_t uiGroup = NO_GROUP);
+  /**
+   * @brief cancel cancels all pending timers of the group
+   * @return the number of cancelled timers
+   */
+  std::size_t cancel(uint32_t uiGroup);
+  /**
+   * @brief poll calls the handlers of all timers that have expired according to the installed clock
+   * @return the number of expired timers
+   */
+  std::size_t poll();
+  /**
+   * @brief getPendingCount returns the number of pending timers
+   */
+  std::size_t getPendingCount() const;
+
+private:
+  virtual void shutdown_service();
+
+  struct Entry
+  {
+    Entry(const boost::posix_time::ptime& tDeadline, uint64_t uiSequence, uint32_t uiGroup, const Handler_t& handler)
+      :Deadline(tDeadline),
+      Sequence(uiSequence),
+      Group(uiGroup),
+      Handler(handler)
+    {
+    }
+    boost::posix_time::ptime Deadline;
+    // preserves the scheduling order of timers with the same deadline
+    uint64_t Sequence;
+    uint32_t Group;
+    Handler_t Handler;
+  };
+  /**
+   * @brief orders the heap so that the earliest deadline is at the front
+   */
+  struct Later
+  {
+    bool operator()(const Entry& lhs, const Entry& rhs) const
+    {
+      if (lhs.Deadline != rhs.Deadline) return lhs.Deadline > rhs.Deadline;
+      return lhs.Sequence > rhs.Sequence;
+    }
+  };
+  /**
+   * @brief arms the asio timer for the earliest deadline if it is not armed for it already.
+   * Must be called with m_lock held.
+   */
+  void arm();
+  void onTimeout(const boost::system::error_code& ec);
+
+private:
+  boost::asio::io_service& m_rIoService;
+  mutable boost::mutex m_lock;
+  boost::asio::deadline_timer m_timer;
+  std::vector<Entry> m_vHeap;
+  // deadline the timer is armed for: not_a_date_time if no wait is outstanding
+  boost::posix_time::ptime m_tArmed;
+  uint64_t m_uiSequence;
+  uint32_t m_uiNextGroup;
+  bool m_bShutdown;
+};
+
+} // rtp_plus_plus
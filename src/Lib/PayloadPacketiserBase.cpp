@@ -22,7 +22,7 @@ std::vector<RtpPacket> PayloadPacketiserBase::packetise(const MediaSample& media
   std::vector<RtpPacket> vRtpPackets;
   RtpPacket packet;
   packet.setPayload(mediaSample.getDataBuffer());
-  vRtpPackets.push_back(packet);
+  vRtpPackets.push_back(std::move(packet));
   return vRtpPackets;
 }
 
@@ -34,7 +34,7 @@ std::vector<RtpPacket> PayloadPacketiserBase::packetise(const std::vector<MediaS
   {
     RtpPacket packet;
     packet.setPayload(mediaSample.getDataBuffer());
-    vRtpPackets.push_back(packet);
+    vRtpPackets.push_back(std::move(packet));
   }
   return vRtpPackets;
 }
@@ -0,0 +1,129 @@
+#include "CorePch.h"
+#include <rtp++/RtcpCompoundView.h>
+#include <rtp++/rfc3550/Rfc3550.h>
+#include <rtp++/rfc4585/Rfc4585.h>
+
+namespace rtp_plus_plus
+{
+
+void RtcpFbView::readNacks(std::vector<uint16_t>& vSNs) const
+{
+  const uint8_t* pFci = getFci();
+  for (uint32_t uiOffset = 0; uiOffset + 4 <= getFciSize(); uiOffset += 4)
+  {
+    uint16_t uiBase = rfc3550::RtpHeaderCodec::readUint16(pFci + uiOffset);
+    uint16_t uiMask = rfc3550::RtpHeaderCodec::readUint16(pFci + uiOffset + 2);
+    vSNs.push_back(uiBase);
+    for (int j = 15; j >= 0; --j)
+    {
+      if ((uiMask >> j) & 0x1)
+        vSNs.push_back(static_cast<uint16_t>(uiBase + (16 - j)));
+    }
+  }
+}
+
+void RtcpFbView::readAcks(std::vector<uint16_t>& vSNs) const
+{
+  const uint8_t* pFci = getFci();
+  for (uint32_t uiOffset = 0; uiOffset + 4 <= getFciSize(); uiOffset += 4)
+  {
+    uint16_t uiBase = rfc3550::RtpHeaderCodec::readUint16(pFci + uiOffset);
+    uint16_t uiMask = rfc3550::RtpHeaderCodec::readUint16(pFci + uiOffset + 2);
+    for (int j = 15; j >= 0; --j)
+    {
+      if ((uiMask >> j) & 0x1)
+        vSNs.push_back(static_cast<uint16_t>(uiBase - (j + 1)));
+    }
+    vSNs.push_back(uiBase);
+  }
+}
+
+RtcpCompoundView::RtcpCompoundView()
+  :m_pData(nullptr),
+    m_uiCount(0)
+{
+
+}
+
+bool RtcpCompoundView::parse(const uint8_t* pData, uint32_t uiSize)
+{
+  m_pData = pData;
+  m_uiCount = 0;
+  m_vOverflow.clear();
+  uint32_t uiOffset = 0;
+  while (uiOffset < uiSize)
+  {
+    if (uiSize - uiOffset < 4)
+    {
+      VLOG(2) << "Truncated RTCP header at offset " << uiOffset;
+      return false;
+    }
+    const uint8_t* pPacket = pData + uiOffset;
+    if ((pPacket[0] >> 6) != rfc3550::RTP_VERSION_NUMBER)
+    {
+      LOG_FIRST_N(WARNING, 1) << "Unsupported RTP version number: " << (pPacket[0] >> 6);
+      return false;
+    }
+    uint32_t uiPacketSize = (rfc3550::RtpHeaderCodec::readUint16(pPacket + 2) + 1) << 2;
+    if (uiPacketSize > uiSize - uiOffset)
+    {
+      VLOG(2) << "RTCP length " << uiPacketSize << " exceeds remaining " << uiSize - uiOffset << " bytes";
+      return false;
+    }
+    RtcpPacketView packet(pPacket, uiPacketSize);
+    // padding is only allowed on the last packet and is included in the length
+    if (packet.getPadding())
+    {
+      uint8_t uiPadding = pPacket[uiPacketSize - 1];
+      if (uiOffset + uiPacketSize != uiSize || uiPadding == 0 || uiPadding > uiPacketSize - 4)
+      {
+        VLOG(2) << "Invalid RTCP padding";
+        return false;
+      }
+    }
+
+    // make sure that the typed views stay within the packet
+    uint32_t uiMinLength = 0;
+    switch (packet.getPacketType())
+    {
+      case rfc3550::PT_RTCP_SR:
+        uiMinLength = rfc3550::BASIC_SR_LENGTH + rfc3550::BASIC_RR_BLOCK_LENGTH * packet.getTypeSpecific();
+        break;
+      case rfc3550::PT_RTCP_RR:
+        uiMinLength = rfc3550::BASIC_RR_LENGTH + rfc3550::BASIC_RR_BLOCK_LENGTH * packet.getTypeSpecific();
+        break;
+      case rfc3550::PT_RTCP_BYE:
+        uiMinLength = packet.getTypeSpecific();
+        break;
+      case rfc4585::PT_RTCP_GENERIC_FEEDBACK:
+      case rfc4585::PT_RTCP_PAYLOAD_SPECIFIC:
+        uiMinLength = rfc4585::BASIC_FB_LENGTH;
+        break;
+    }
+    if (packet.getLength() < uiMinLength)
+    {
+      VLOG(2) << "RTCP packet type " << (uint32_t)packet.getPacketType() << " too short: " << packet.getLength();
+      return false;
+    }
+
+    if (m_uiCount < INLINE_PACKETS)
+      m_packets[m_uiCount] = packet;
+    else
+      m_vOverflow.push_back(packet);
+    ++m_uiCount;
+    uiOffset += uiPacketSize;
+  }
+  return m_uiCount > 0;
+}
+
+uint32_t RtcpCompoundView::find(uint8_t uiPacketType, uint32_t uiStart) const
+{
+  for (uint32_t i = uiStart; i < m_uiCount; ++i)
+  {
+    if ((*this)[i].getPacketType() == uiPacketType)
+      return i;
+  }
+  return m_uiCount;
+}
+
+} // rtp_plus_plus
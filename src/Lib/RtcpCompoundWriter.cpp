@@ -0,0 +1,229 @@
+#include "CorePch.h"
+#include <rtp++/RtcpCompoundWriter.h>
+#include <cstring>
+#include <rtp++/rfc3550/Rfc3550.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
+#include <rtp++/rfc4585/Rfc4585.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
+
+namespace rtp_plus_plus
+{
+
+using rfc3550::RtpHeaderCodec;
+
+RtcpCompoundWriter::RtcpCompoundWriter(uint32_t uiCapacity)
+  :m_buffer(BufferPool::allocate(uiCapacity)),
+    m_uiOffset(0),
+    m_uiPacketCount(0),
+    m_uiReportOffset(UINT32_MAX)
+{
+
+}
+
+void RtcpCompoundWriter::reset()
+{
+  m_uiOffset = 0;
+  m_uiPacketCount = 0;
+  m_uiReportOffset = UINT32_MAX;
+}
+
+Buffer RtcpCompoundWriter::getBuffer() const
+{
+  return sliceBuffer(m_buffer, 0, m_uiOffset);
+}
+
+uint8_t* RtcpCompoundWriter::beginPacket(uint8_t uiTypeSpecific, uint8_t uiPacketType, uint32_t uiSize)
+{
+  assert(uiSize % 4 == 0);
+  if (uiSize > getRemaining()) return nullptr;
+  uint8_t* pPacket = &m_buffer[0] + m_uiOffset;
+  pPacket[0] = static_cast<uint8_t>((rfc3550::RTP_VERSION_NUMBER << 6) | (uiTypeSpecific & 0x1F));
+  pPacket[1] = uiPacketType;
+  RtpHeaderCodec::writeUint16(pPacket + 2, static_cast<uint16_t>((uiSize >> 2) - 1));
+  return pPacket;
+}
+
+void RtcpCompoundWriter::setLength(uint32_t uiOffset, uint32_t uiSize)
+{
+  RtpHeaderCodec::writeUint16(&m_buffer[0] + uiOffset + 2, static_cast<uint16_t>((uiSize >> 2) - 1));
+}
+
+bool RtcpCompoundWriter::writeSr(uint32_t uiSSRC, uint32_t uiNtpTimestampMsw, uint32_t uiNtpTimestampLsw,
+                                 uint32_t uiRtpTimestamp, uint32_t uiSendersPacketCount, uint32_t uiSendersOctetCount)
+{
+  const uint32_t uiSize = (rfc3550::BASIC_SR_LENGTH + 1) << 2;
+  uint8_t* pPacket = beginPacket(0, rfc3550::PT_RTCP_SR, uiSize);
+  if (!pPacket) return false;
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSSRC);
+  RtpHeaderCodec::writeUint32(pPacket + 8, uiNtpTimestampMsw);
+  RtpHeaderCodec::writeUint32(pPacket + 12, uiNtpTimestampLsw);
+  RtpHeaderCodec::writeUint32(pPacket + 16, uiRtpTimestamp);
+  RtpHeaderCodec::writeUint32(pPacket + 20, uiSendersPacketCount);
+  RtpHeaderCodec::writeUint32(pPacket + 24, uiSendersOctetCount);
+  m_uiReportOffset = m_uiOffset;
+  m_uiOffset += uiSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::writeRr(uint32_t uiReporterSSRC)
+{
+  const uint32_t uiSize = (rfc3550::BASIC_RR_LENGTH + 1) << 2;
+  uint8_t* pPacket = beginPacket(0, rfc3550::PT_RTCP_RR, uiSize);
+  if (!pPacket) return false;
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiReporterSSRC);
+  m_uiReportOffset = m_uiOffset;
+  m_uiOffset += uiSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::addReportBlock(uint32_t uiReporteeSSRC, uint8_t uiFractionLost, int32_t iCumulativeNumberOfPacketsLost,
+                                        uint32_t uiExtendedHighestSNReceived, uint32_t uiInterarrivalJitter,
+                                        uint32_t uiLastSr, uint32_t uiDelaySinceLastSr)
+{
+  const uint32_t uiSize = rfc3550::BASIC_RR_BLOCK_LENGTH << 2;
+  // report blocks can only be appended to an SR or RR that is the last packet
+  if (m_uiReportOffset == UINT32_MAX) return false;
+  uint8_t* pReport = &m_buffer[0] + m_uiReportOffset;
+  uint32_t uiReportSize = (RtpHeaderCodec::readUint16(pReport + 2) + 1) << 2;
+  if (m_uiReportOffset + uiReportSize != m_uiOffset) return false;
+  uint8_t uiCount = pReport[0] & 0x1F;
+  if (uiCount == rfc3550::MAX_SOURCES_PER_RTCP_RR || uiSize > getRemaining()) return false;
+
+  uint8_t* pBlock = &m_buffer[0] + m_uiOffset;
+  RtpHeaderCodec::writeUint32(pBlock, uiReporteeSSRC);
+  RtpHeaderCodec::writeUint32(pBlock + 4, static_cast<uint32_t>(iCumulativeNumberOfPacketsLost) & 0xFFFFFF);
+  pBlock[4] = uiFractionLost;
+  RtpHeaderCodec::writeUint32(pBlock + 8, uiExtendedHighestSNReceived);
+  RtpHeaderCodec::writeUint32(pBlock + 12, uiInterarrivalJitter);
+  RtpHeaderCodec::writeUint32(pBlock + 16, uiLastSr);
+  RtpHeaderCodec::writeUint32(pBlock + 20, uiDelaySinceLastSr);
+  m_uiOffset += uiSize;
+
+  pReport[0] = static_cast<uint8_t>((pReport[0] & 0xE0) | (uiCount + 1));
+  setLength(m_uiReportOffset, uiReportSize + uiSize);
+  return true;
+}
+
+bool RtcpCompoundWriter::writeSdesCname(uint32_t uiSSRC, const std::string& sCname)
+{
+  if (sCname.length() > rfc3550::RTP_MAX_SDES) return false;
+  // chunk: SSRC, CNAME item and at least one null octet up to the next word boundary
+  uint32_t uiItemSize = rfc3550::SDES_ITEM_HEADER_LENGTH + sCname.length();
+  uint32_t uiChunkSize = 4 + ((uiItemSize + 4) & ~0x3);
+  uint8_t* pPacket = beginPacket(1, rfc3550::PT_RTCP_SDES, 4 + uiChunkSize);
+  if (!pPacket) return false;
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSSRC);
+  pPacket[8] = rfc3550::RTCP_SDES_TYPE_CNAME;
+  pPacket[9] = static_cast<uint8_t>(sCname.length());
+  memcpy(pPacket + 10, sCname.data(), sCname.length());
+  memset(pPacket + 8 + uiItemSize, 0, uiChunkSize - 4 - uiItemSize);
+  m_uiOffset += 4 + uiChunkSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::writeBye(uint32_t uiSSRC)
+{
+  uint8_t* pPacket = beginPacket(1, rfc3550::PT_RTCP_BYE, 8);
+  if (!pPacket) return false;
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSSRC);
+  m_uiOffset += 8;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::writeFb(uint8_t uiPacketType, uint8_t uiFormat, uint32_t uiSenderSSRC, uint32_t uiSourceSSRC,
+                                 const uint8_t* pFci, uint32_t uiFciSize)
+{
+  assert(uiFciSize % 4 == 0);
+  uint32_t uiSize = ((rfc4585::BASIC_FB_LENGTH + 1) << 2) + uiFciSize;
+  uint8_t* pPacket = beginPacket(uiFormat, uiPacketType, uiSize);
+  if (!pPacket) return false;
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSenderSSRC);
+  RtpHeaderCodec::writeUint32(pPacket + 8, uiSourceSSRC);
+  if (uiFciSize > 0)
+    memcpy(pPacket + 12, pFci, uiFciSize);
+  m_uiOffset += uiSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::writeGenericNack(uint32_t uiSenderSSRC, uint32_t uiSourceSSRC, const std::vector<uint16_t>& vSNs)
+{
+  const uint32_t uiHeaderSize = (rfc4585::BASIC_FB_LENGTH + 1) << 2;
+  if (uiHeaderSize > getRemaining()) return false;
+  uint8_t* pPacket = &m_buffer[0] + m_uiOffset;
+  uint8_t* pFci = pPacket + uiHeaderSize;
+  uint32_t uiFciSize = 0;
+  // the FCI is built in place: a sequence number is added to the first entry that covers it
+  for (uint16_t uiSN : vSNs)
+  {
+    bool bCovered = false;
+    for (uint32_t uiEntry = 0; uiEntry < uiFciSize; uiEntry += 4)
+    {
+      uint16_t uiDiff = uiSN - RtpHeaderCodec::readUint16(pFci + uiEntry);
+      if (uiDiff <= 16)
+      {
+        if (uiDiff > 0)
+        {
+          uint16_t uiMask = RtpHeaderCodec::readUint16(pFci + uiEntry + 2);
+          RtpHeaderCodec::writeUint16(pFci + uiEntry + 2, uiMask | (0x1 << (16 - uiDiff)));
+        }
+        bCovered = true;
+        break;
+      }
+    }
+    if (!bCovered)
+    {
+      if (uiHeaderSize + uiFciSize + 4 > getRemaining()) return false;
+      RtpHeaderCodec::writeUint16(pFci + uiFciSize, uiSN);
+      RtpHeaderCodec::writeUint16(pFci + uiFciSize + 2, 0);
+      uiFciSize += 4;
+    }
+  }
+  beginPacket(rfc4585::TL_FB_GENERIC_NACK, rfc4585::PT_RTCP_GENERIC_FEEDBACK, uiHeaderSize + uiFciSize);
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSenderSSRC);
+  RtpHeaderCodec::writeUint32(pPacket + 8, uiSourceSSRC);
+  m_uiOffset += uiHeaderSize + uiFciSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+bool RtcpCompoundWriter::writeGenericAck(uint32_t uiSenderSSRC, uint32_t uiSourceSSRC, const std::vector<uint16_t>& vSNs)
+{
+  const uint32_t uiHeaderSize = (rfc4585::BASIC_FB_LENGTH + 1) << 2;
+  if (uiHeaderSize > getRemaining()) return false;
+  uint8_t* pPacket = &m_buffer[0] + m_uiOffset;
+  uint8_t* pFci = pPacket + uiHeaderSize;
+  uint32_t uiFciSize = 0;
+  // each entry covers its base and the 16 preceding sequence numbers, starting with the highest
+  uint16_t uiBase = 0;
+  for (auto rit = vSNs.rbegin(); rit != vSNs.rend(); ++rit)
+  {
+    uint16_t uiDiff = uiBase - *rit;
+    if (uiFciSize == 0 || uiDiff > 16)
+    {
+      if (uiHeaderSize + uiFciSize + 4 > getRemaining()) return false;
+      uiBase = *rit;
+      RtpHeaderCodec::writeUint16(pFci + uiFciSize, uiBase);
+      RtpHeaderCodec::writeUint16(pFci + uiFciSize + 2, 0);
+      uiFciSize += 4;
+    }
+    else if (uiDiff > 0)
+    {
+      uint8_t* pMask = pFci + uiFciSize - 2;
+      RtpHeaderCodec::writeUint16(pMask, RtpHeaderCodec::readUint16(pMask) | (0x1 << (uiDiff - 1)));
+    }
+  }
+  beginPacket(rfc4585::TL_FB_GENERIC_ACK, rfc4585::PT_RTCP_GENERIC_FEEDBACK, uiHeaderSize + uiFciSize);
+  RtpHeaderCodec::writeUint32(pPacket + 4, uiSenderSSRC);
+  RtpHeaderCodec::writeUint32(pPacket + 8, uiSourceSSRC);
+  m_uiOffset += uiHeaderSize + uiFciSize;
+  ++m_uiPacketCount;
+  return true;
+}
+
+} // rtp_plus_plus
@@ -1,5 +1,6 @@
 #include <CorePch.h>
 #include <rtp++/RtpJitterBuffer.h>
+#include <rtp++/util/Clock.h>
 #include <limits>
 
 // #define DEBUG_RTP_LOSSES
@@ -84,7 +85,7 @@ bool RtpJitterBuffer::doAddRtpPacket(const RtpPacket& packet, const boost::posix
     }
     else
     {
-      boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+      boost::posix_time::ptime tNow = Clock::universalTime();
 //      tPlayout = calculatePlayoutTime(packet);
       uint32_t uiOldestTs = m_playoutBufferList.front().getRtpTimestamp();
 
@@ -1,5 +1,6 @@
 #include "CorePch.h"
 #include <rtp++/RtpJitterBufferV2.h>
+#include <rtp++/util/Clock.h>
 
 namespace rtp_plus_plus
 {
@@ -145,7 +146,7 @@ RtpJitterBufferV2::doAddRtpPacket(const RtpPacket& packet,
            << " SN: " << packet.getExtendedSequenceNumber()
            << " PTS: " << tPresentation
            << " Playout: " << tPlayout
-           << " Now: " << boost::posix_time::microsec_clock::universal_time();
+           << " Now: " << Clock::universalTime();
 
   // search through our list to see if there is a associated RtpPacketGroup.
   // This can be identfied by a similar timestamp or presentation time
@@ -181,7 +182,7 @@ RtpJitterBufferV2::doAddRtpPacket(const RtpPacket& packet,
     if (it != m_recentHistory.rend())
     {
       // found in recently processed list: packet is late
-      boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+      boost::posix_time::ptime tNow = Clock::universalTime();
       // we're assuming that this number is fairly small. Downcast should be fine.
       uiLateMs = static_cast<uint32_t>((tNow - tPlayout).total_milliseconds());
 
@@ -207,7 +208,7 @@ RtpJitterBufferV2::doAddRtpPacket(const RtpPacket& packet,
       // Packet belongs to a new group as long as the history is long enough
       // to have stored sufficient packets
       // Check how the calculated playout time relates to the current time
-      boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+      boost::posix_time::ptime tNow = Clock::universalTime();
       if (tPlayout < tNow)
       {
         // we're assuming that this number is fairly small. Downcast should be fine.
@@ -9,7 +9,11 @@
 #include <cpputil/OBitStream.h>
 #include <rtp++/RtpTime.h>
 #include <rtp++/rfc3550/RtcpParser.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
+#include <rtp++/rfc4585/Rfc4585.h>
 #include <rtp++/rfc5285/RtpHeaderExtension.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
 
 #define COMPONENT_LOG_LEVEL 10
 
@@ -46,54 +50,8 @@ bool RtpPacketiser::validate(const CompoundRtcpPacket& rtcpPackets)
 
 Buffer RtpPacketiser::packetise( const RtpPacket& rtpPacket )
 {
-  Buffer buffer(new uint8_t[rtpPacket.getSize()], rtpPacket.getSize());
-
-  OBitStream ob(buffer);
-  ob.write( rtpPacket.getHeader().getVersion(),         2);
-  ob.write( rtpPacket.getHeader().hasPadding(),         1);
-  ob.write( rtpPacket.getHeader().hasExtension(),       1);
-  ob.write( rtpPacket.getHeader().getCC(),              4);
-  ob.write( rtpPacket.getHeader().isMarkerSet(),        1);
-  ob.write( (uint32_t) rtpPacket.getHeader().getPayloadType(),    7);
-  ob.write( rtpPacket.getHeader().getSequenceNumber(), 16);
-  ob.write( rtpPacket.getHeader().getRtpTimestamp(),   32);
-  ob.write( rtpPacket.getHeader().getSSRC(),           32);
-#if 0
-  Logger& rLogger = Logger::getInstance();
-  LOG_INFO(rLogger, LOG_FUNCTION, "RTP Packet size: %1%", ob.bytesUsed());
-#endif
-  assert(ob.bytesUsed() == 12);
-
-  std::vector<uint32_t> vCSRCs = rtpPacket.getHeader().getCSRCs();
-  std::for_each(vCSRCs.begin(), vCSRCs.end(), [&ob](uint32_t uiCSRC)
-  {
-    ob.write(uiCSRC,     32);
-  } 
-  );
-
-  // write extension header
-  const rfc5285::RtpHeaderExtension& headerExtension = rtpPacket.getHeader().getHeaderExtension();
-  if (headerExtension.containsExtensions())
-  {
-#ifdef DEBUG_MPRTP
-      // Potentially expensive???: create a work around if this proves to be a problem
-      mprtp::MpRtpSubflowRtpHeader* pSubflowHeader = dynamic_cast<mprtp::MpRtpSubflowRtpHeader*>(pExtension.get());
-      if (pSubflowHeader)
-      {
-        uint16_t uiFlowId = pSubflowHeader->getFlowId();
-        uint16_t uiFlowSpecificSequenceNumber = pSubflowHeader->getFlowSpecificSequenceNumber();
-
-        VLOG(2) << "Sending packet with SN " << rtpPacket.getSequenceNumber()
-                << " FlowId: " << uiFlowId
-                << " FSSN: " << uiFlowSpecificSequenceNumber;
-      }
-#endif
-    headerExtension.writeExtensionData(ob);
-  }
-
-  // write packet data
-  memcpy(&buffer[ob.bytesUsed()], rtpPacket.getPayload().data(), rtpPacket.getPayload().getSize());
-
+  Buffer buffer = BufferPool::allocate(rtpPacket.getSize());
+  writeRtpPacket(rtpPacket, buffer);
   return buffer;
 }
 
@@ -103,34 +61,20 @@ Buffer RtpPacketiser::packetise( const RtpPacket& rtpPacket, uint32_t uiPreferre
   assert(uiPreferredBufferSize >= rtpPacket.getSize());
 
   uint32_t uiPostBuffer = uiPreferredBufferSize - rtpPacket.getSize();
-  Buffer buffer(new uint8_t[uiPreferredBufferSize], uiPreferredBufferSize, 0, uiPostBuffer);
-
-  OBitStream ob(buffer);
-  ob.write( rtpPacket.getHeader().getVersion(),         2);
-  ob.write( rtpPacket.getHeader().hasPadding(),         1);
-  ob.write( rtpPacket.getHeader().hasExtension(),       1);
-  ob.write( rtpPacket.getHeader().getCC(),              4);
-  ob.write( rtpPacket.getHeader().isMarkerSet(),        1);
-  ob.write( (uint32_t) rtpPacket.getHeader().getPayloadType(),    7);
-  ob.write( rtpPacket.getHeader().getSequenceNumber(), 16);
-  ob.write( rtpPacket.getHeader().getRtpTimestamp(),   32);
-  ob.write( rtpPacket.getHeader().getSSRC(),           32);
-#if 0
-  Logger& rLogger = Logger::getInstance();
-  LOG_INFO(rLogger, LOG_FUNCTION, "RTP Packet size: %1%", ob.bytesUsed());
-#endif
-  assert(ob.bytesUsed() == 12);
+  Buffer buffer = BufferPool::allocate(rtpPacket.getSize(), 0, uiPostBuffer);
+  writeRtpPacket(rtpPacket, buffer);
+  return buffer;
+}
 
-  std::vector<uint32_t> vCSRCs = rtpPacket.getHeader().getCSRCs();
-  std::for_each(vCSRCs.begin(), vCSRCs.end(), [&ob](uint32_t uiCSRC)
-  {
-    ob.write(uiCSRC,     32);
-  }
-  );
+void RtpPacketiser::writeRtpPacket( const RtpPacket& rtpPacket, Buffer& buffer )
+{
+  // fixed header and CSRCs are written at byte level
+  uint8_t* pDest = &buffer[0];
+  uint32_t uiOffset = rfc3550::RtpHeaderCodec::write(rtpPacket.getHeader(), pDest);
 
   // write extension header
-  rfc5285::RtpHeaderExtension extension = rtpPacket.getHeader().getHeaderExtension();
-  if (extension.containsExtensions())
+  const rfc5285::RtpHeaderExtension& headerExtension = rtpPacket.getHeader().getHeaderExtension();
+  if (headerExtension.containsExtensions())
   {
 #ifdef DEBUG_MPRTP
       // Potentially expensive???: create a work around if this proves to be a problem
@@ -145,13 +89,12 @@ Buffer RtpPacketiser::packetise( const RtpPacket& rtpPacket, uint32_t uiPreferre
                 << " FSSN: " << uiFlowSpecificSequenceNumber;
       }
 #endif
-    extension.writeExtensionData(ob);
+    uiOffset += headerExtension.write(pDest + uiOffset);
   }
+  assert(uiOffset == rtpPacket.getHeader().getSize());
 
-  // write packet data
-  memcpy(&buffer[ob.bytesUsed()], rtpPacket.getPayload().data(), rtpPacket.getPayload().getSize());
-
-  return buffer;
+  // write packet data: this is the only copy of gathered payloads
+  rtpPacket.writePayload(pDest + uiOffset);
 }
 
 Buffer RtpPacketiser::packetise( CompoundRtcpPacket rtcpPackets )
@@ -168,7 +111,7 @@ Buffer RtpPacketiser::packetise( CompoundRtcpPacket rtcpPackets, uint32_t uiPref
 {
   // allocate a few (4) bytes of prebuffer space
   const uint32_t uiPreBufferBytes = 4;
-  Buffer buffer(new uint8_t[uiPreferredBufferSize], uiPreferredBufferSize, uiPreBufferBytes, 0);
+  Buffer buffer = BufferPool::allocate(uiPreferredBufferSize - uiPreBufferBytes, uiPreBufferBytes);
   OBitStream ob(buffer);
 
   std::for_each(rtcpPackets.begin(), rtcpPackets.end(), [&ob](RtcpPacketBase::ptr pRtcpPacket)
@@ -178,70 +121,56 @@ Buffer RtpPacketiser::packetise( CompoundRtcpPacket rtcpPackets, uint32_t uiPref
   return ob.str();
 }
 
-boost::optional<RtpPacket> RtpPacketiser::doDepacketise( Buffer buffer )
+Buffer RtpPacketiser::packetise( CompoundRtcpPacket rtcpPackets, const Buffer& feedback )
 {
-  if (buffer.getSize() < 12)
+  OBitStream ob;
+  std::for_each(rtcpPackets.begin(), rtcpPackets.end(), [&ob](RtcpPacketBase::ptr pRtcpPacket)
   {
-    LOG(WARNING) << "Invalid RTP packet. Too small";
-    return boost::optional<RtpPacket>();
-  }
+    ob << pRtcpPacket.get();
+  });
+  // the feedback is already serialised
+  ob.writeBytes(feedback.data(), feedback.getSize());
+  return ob.str();
+}
 
-  IBitStream ib(buffer);
+Buffer RtpPacketiser::packetise( CompoundRtcpPacket rtcpPackets, const Buffer& feedback, uint32_t uiPreferredBufferSize )
+{
+  const uint32_t uiPreBufferBytes = 4;
+  Buffer buffer = BufferPool::allocate(uiPreferredBufferSize - uiPreBufferBytes, uiPreBufferBytes);
+  OBitStream ob(buffer);
 
-  uint32_t uiVersion   = UINT_MAX;
-  uint32_t uiPadding   = UINT_MAX;
-  uint32_t uiExtension = UINT_MAX;
-  uint32_t uiCC        = UINT_MAX;
-  uint32_t uiMarker    = UINT_MAX;
-  uint32_t uiPayload   = UINT_MAX;
-  uint32_t uiSN        = UINT_MAX;
-  uint32_t uiTS        = UINT_MAX;
-  uint32_t uiSSRC      = UINT_MAX;
+  std::for_each(rtcpPackets.begin(), rtcpPackets.end(), [&ob](RtcpPacketBase::ptr pRtcpPacket)
+  {
+    ob << pRtcpPacket.get();
+  });
+  ob.writeBytes(feedback.data(), feedback.getSize());
+  return ob.str();
+}
 
-  // RTP version: 2 bits
-  ib.read(uiVersion, 2);
-  // we don't support RTP version other than version 2
-  if (uiVersion != rfc3550::RTP_VERSION_NUMBER)
+boost::optional<RtpPacket> RtpPacketiser::doDepacketise( Buffer buffer )
+{
+  rfc3550::RtpHeaderFields fields;
+  if (!rfc3550::RtpHeaderCodec::parse(buffer.data(), buffer.getSize(), fields))
   {
-    LOG(WARNING) << "Invalid RTP Version number";
+    LOG(WARNING) << "Invalid RTP packet of size " << buffer.getSize();
     return boost::optional<RtpPacket>();
   }
-  // Padding: 1 bit
-  ib.read(uiPadding, 1);
-  // Extension: 1 bit
-  ib.read(uiExtension, 1);
-  // CC: 4 bits
-  ib.read(uiCC, 4);
-  // Marker: 1 bit
-  ib.read(uiMarker, 1);
-  // Payload type: 7 bits
-  ib.read(uiPayload, 7);
-  // Sequence Number: 16 bits
-  ib.read(uiSN, 16);
-  // Timestamp: 32 bits
-  ib.read(uiTS, 32);
-  // SSRC: 32 bits
-  ib.read(uiSSRC, 32);
-
-  rfc3550::RtpHeader header( i2b(uiPadding), i2b(uiMarker), uiPayload, uiSN, uiTS, uiSSRC) ;
-  for (size_t i = 0; i < uiCC; ++i)
+
+  rfc3550::RtpHeader header(fields.Padding, fields.Marker, fields.PayloadType, fields.SequenceNumber, fields.RtpTimestamp, fields.SSRC);
+  for (size_t i = 0; i < fields.CsrcCount; ++i)
   {
-    uint32_t uiCSRC = UINT_MAX;
-    // SSRC: 32 bits
-    ib.read(uiCSRC, 32);
-    header.addContributingSource(uiCSRC);
+    header.addContributingSource(rfc3550::RtpHeaderCodec::readCsrc(buffer.data(), i));
   }
 
-  if (uiExtension)
+  if (fields.Extension)
   {
-    rfc5285::RtpHeaderExtension& extension = header.getHeaderExtension();
-    extension.readExtensionData(ib);
+    // the length of the extension has been validated: the elements are parsed on demand
+    // from the storage of the received datagram
+    header.getHeaderExtension().setExtensionData(sliceBuffer(buffer, fields.ExtensionOffset, fields.HeaderSize - fields.ExtensionOffset));
   }
 
-  uint32_t uiPayloadSize = ib.getBytesRemaining();
-  uint8_t* pPayload = new uint8_t[uiPayloadSize];
-  Buffer payload(pPayload, uiPayloadSize);
-  ib.readBytes(pPayload, uiPayloadSize);
+  // the payload references the storage of the received datagram
+  Buffer payload = sliceBuffer(buffer, fields.HeaderSize, buffer.getSize() - fields.HeaderSize);
 
   RtpPacket packet;
   packet.setRtpHeader(header);
@@ -335,24 +264,78 @@ RtcpPacketBase::ptr RtpPacketiser::parseRtcpPacket(IBitStream& ib)
   }
 }
 
-CompoundRtcpPacket RtpPacketiser::doDepacketiseRtcp( Buffer buffer )
+RtcpPacketBase::ptr RtpPacketiser::createRtcpPacket(const Buffer& buffer, const RtcpCompoundView& compoundView, uint32_t uiIndex)
+{
+  const RtcpPacketView& packet = compoundView[uiIndex];
+  // making this code more robust by allowing multiple parsers to be registered.
+  // This method returns the first packet successfully parsed
+  for (auto& pParser : m_vRtcpParsers)
+  {
+    if (!pParser->canHandleRtcpType(packet.getPacketType())) continue;
+    // the parser can only read the body of this packet
+    IBitStream ib(sliceBuffer(buffer, compoundView.getOffset(uiIndex) + 4, packet.getBodySize()));
+    RtcpPacketBase::ptr pRtcpPacket = pParser->parseRtcpPacket(ib, packet.getVersion(), packet.getPadding(),
+                                                               packet.getTypeSpecific(), packet.getPacketType(),
+                                                               packet.getLength());
+    if (pRtcpPacket) return pRtcpPacket;
+  }
+  return RtcpPacketBase::ptr();
+}
+
+bool RtpPacketiser::isGenericFeedback(const RtcpPacketView& packet) const
+{
+  if (packet.getPacketType() != rfc4585::PT_RTCP_GENERIC_FEEDBACK) return false;
+  if (packet.getTypeSpecific() != rfc4585::TL_FB_GENERIC_NACK &&
+      packet.getTypeSpecific() != rfc4585::TL_FB_GENERIC_ACK)
+    return false;
+  // without a parser the packet would be skipped
+  return !findRtcpParsers(rfc4585::PT_RTCP_GENERIC_FEEDBACK).empty();
+}
+
+CompoundRtcpPacket RtpPacketiser::doDepacketiseRtcp( Buffer buffer, const RtcpFbViewHandler_t& onFb )
 {
   VLOG(COMPONENT_LOG_LEVEL) << "Depacketising RTCP: parsing buffer: " << buffer.getSize();
   CompoundRtcpPacket compoundPacket;
 
-  IBitStream ib(buffer);
+  // the headers and lengths are checked before any packet object is created
+  RtcpCompoundView compoundView;
+  if (!compoundView.parse(buffer.data(), buffer.getSize()))
+  {
+    // as before, the packets preceding a malformed packet are still returned
+    VLOG(COMPONENT_LOG_LEVEL) << "Malformed compound RTCP packet of size " << buffer.getSize()
+                              << ": valid packets: " << compoundView.size();
+    if (compoundView.empty())
+      return compoundPacket;
+  }
+
+  // generic NACKs and ACKs are read in place: the compound packet is validated before they are handled
+  const bool bFbInPlace = !onFb.empty();
+  if (bFbInPlace && m_bValidate && !m_pValidator->validateCompoundRtcpView(compoundView, buffer.getSize()))
+    return compoundPacket;
 
-  while (ib.getBitsRemaining())
+  compoundPacket.reserve(compoundView.size());
+  for (uint32_t i = 0; i < compoundView.size(); ++i)
   {
-    RtcpPacketBase::ptr pRtcp = parseRtcpPacket(ib);
-    // if something went wrong, exit!
-    if (pRtcp) compoundPacket.push_back(pRtcp);
-    else break;
+    if (bFbInPlace && isGenericFeedback(compoundView[i]))
+    {
+      onFb(RtcpFbView(compoundView[i]));
+      continue;
+    }
+    RtcpPacketBase::ptr pRtcp = createRtcpPacket(buffer, compoundView, i);
+    if (pRtcp)
+    {
+      compoundPacket.push_back(pRtcp);
+    }
+    else
+    {
+      // the framing is known so the next packet can still be parsed
+      LOG(WARNING) << "Skipping RTCP packet type: " << (uint32_t)compoundView[i].getPacketType();
+    }
   }
 
   VLOG(COMPONENT_LOG_LEVEL) << "Depacketising RTCP: packets parsed: " << compoundPacket.size();
 
-  if ( m_bValidate )
+  if ( m_bValidate && !bFbInPlace )
   {
     VLOG(COMPONENT_LOG_LEVEL) << "Validating RTCP compound packet: " << compoundPacket.size();
     if ( m_pValidator->validateCompoundRtcpPacket(compoundPacket, buffer.getSize()))
@@ -387,6 +370,16 @@ CompoundRtcpPacket RtpPacketiser::depacketiseRtcp( NetworkPacket packet )
   return packets;
 }
 
+CompoundRtcpPacket RtpPacketiser::depacketiseRtcp( NetworkPacket packet, const RtcpFbViewHandler_t& onFb )
+{
+  CompoundRtcpPacket packets = doDepacketiseRtcp(packet, onFb);
+  for (RtcpPacketBase::ptr& pRtcpPacket : packets)
+  {
+    pRtcpPacket->setArrivalTimeNtp(packet.getNtpArrivalTime());
+  }
+  return packets;
+}
+
 std::vector<int> RtpPacketiser::findRtcpParsers( uint32_t uiType ) const
 {
   std::vector<int> indices;
@@ -0,0 +1,290 @@
+#include "CorePch.h"
+#include <rtp++/RtpRingJitterBuffer.h>
+#include <rtp++/util/Clock.h>
+
+namespace rtp_plus_plus
+{
+
+RtpRingJitterBuffer::ptr RtpRingJitterBuffer::create(uint32_t uiPlayoutBufferLatency, uint32_t uiCapacity)
+{
+  return std::unique_ptr<RtpRingJitterBuffer>( new RtpRingJitterBuffer(uiPlayoutBufferLatency, uiCapacity) );
+}
+
+static uint32_t roundUpToPowerOfTwo(uint32_t uiValue)
+{
+  uint32_t uiPower = 1;
+  while (uiPower < uiValue) uiPower <<= 1;
+  return uiPower;
+}
+
+RtpRingJitterBuffer::RtpRingJitterBuffer(uint32_t uiPlayoutBufferLatency, uint32_t uiCapacity)
+  :IRtpJitterBuffer(uiPlayoutBufferLatency),
+    m_vSlots(roundUpToPowerOfTwo(uiCapacity)),
+    m_uiMask(static_cast<uint32_t>(m_vSlots.size()) - 1),
+    m_uiFirstRtpTs(0),
+    m_uiRtpDiffMs(0),
+    m_uiFirstSN(UINT_MAX),
+    m_uiLastSN(UINT_MAX),
+    m_uiTotalPackets(0),
+    m_uiTotalLatePackets(0),
+    m_uiTotalDuplicates(0),
+    m_uiTotalOverflows(0),
+    m_bRtcpSync(false),
+    m_recentHistory(150)
+{
+
+}
+
+RtpRingJitterBuffer::~RtpRingJitterBuffer()
+{
+  VLOG(10) << "Total packets: " << m_uiTotalPackets
+             << " First SN: " << m_uiFirstSN
+             << " Last SN: " << m_uiLastSN
+             << " Late: " << m_uiTotalLatePackets
+             << " Dup: " << m_uiTotalDuplicates
+             << " Overflow: " << m_uiTotalOverflows;
+}
+
+const RtpPacketGroup
+RtpRingJitterBuffer::getNextPlayoutBufferNode()
+{
+  boost::mutex::scoped_lock l(m_listLock);
+  assert(!m_qPlayoutOrder.empty());
+  uint32_t uiRtpTs = m_qPlayoutOrder.front();
+  m_qPlayoutOrder.pop_front();
+  auto it = m_mFrames.find(uiRtpTs);
+  assert(it != m_mFrames.end());
+  const Frame& frame = it->second;
+
+  // the slot of the first SN always holds a packet of the frame since
+  // buffered slots are never overwritten
+  Slot& first = getSlot(frame.FirstSN);
+  first.State = SLOT_PLAYED;
+  RtpPacketGroup node(first.Packet, frame.Presentation, frame.RtcpSynchronised, frame.Playout);
+  // played slots only need the SN and RTP TS: release the packet data
+  first.Packet = RtpPacket();
+  for (uint32_t uiSN = frame.FirstSN; uiSN != frame.LastSN; )
+  {
+    ++uiSN;
+    Slot& slot = getSlot(uiSN);
+    // skip lost packets and packets of interleaved frames
+    if (slot.State == SLOT_BUFFERED && slot.ExtendedSN == uiSN &&
+        slot.RtpTs == uiRtpTs)
+    {
+      slot.State = SLOT_PLAYED;
+      // packets are visited in SN order: this always appends
+      node.insert(slot.Packet);
+      slot.Packet = RtpPacket();
+    }
+  }
+  m_mFrames.erase(it);
+  // add frame to history
+  m_recentHistory.push_back(uiRtpTs);
+  return node;
+}
+
+boost::posix_time::ptime
+RtpRingJitterBuffer::calculatePlayoutTime(const RtpPacket& packet,
+                                          const boost::posix_time::ptime& tPresentation,
+                                          bool bRtcpSynchronised)
+{
+  // the playout time calculation is the same as that of RtpJitterBufferV2
+  // presentation time jumps when RTCP sync occurs
+  if (!m_bRtcpSync)
+  {
+    if (bRtcpSynchronised)
+    {
+      // reset for resynchronisation
+      m_bRtcpSync = true;
+      m_tFirstSyncedPts = tPresentation;
+      // handle the case where the first packet is synced already
+      if (m_tFirstPacket.is_not_a_date_time())
+      {
+        // in this case m_uiFirstRtpTs has not been set yet, so set it first
+        m_uiFirstRtpTs = packet.getRtpTimestamp();
+      }
+
+      m_uiRtpDiffMs = (packet.getRtpTimestamp() - m_uiFirstRtpTs)*1000/m_uiClockFrequency;
+
+      VLOG(5) << "RTCP sync: resetting presentation time calc. Diff RTP: " << m_uiRtpDiffMs << " ms"
+              << " Diff PTS after sync:" << (m_tFirstSyncedPts - m_tFirstPts).total_milliseconds() << " ms";
+    }
+  }
+
+  m_uiLastSN = packet.getExtendedSequenceNumber();
+
+  if (m_tFirstPacket.is_not_a_date_time())
+  {
+    // store time reference points: everything is relative to the arrival time of the first packet
+    m_tFirstPacket = packet.getArrivalTime();
+    m_tFirstPts = tPresentation;
+    m_uiFirstSN = packet.getExtendedSequenceNumber();
+    m_uiFirstRtpTs = packet.getRtpTimestamp();
+
+    VLOG(5) << "Using " << m_uiPlayoutBufferLatencyMs << "ms playout buffer with "
+            << m_vSlots.size() << " slots. Clock frequency: "
+            << m_uiClockFrequency << "Hz"
+            << " 1st packet arrival: " << m_tFirstPacket
+            << " PTS: " << m_tFirstPts;
+
+    return m_tFirstPacket + boost::posix_time::milliseconds(m_uiPlayoutBufferLatencyMs);
+  }
+  else
+  {
+    if (m_tFirstSyncedPts.is_not_a_date_time())
+    {
+      // measure difference in presentation time and add to first packet time
+      boost::posix_time::time_duration duration = tPresentation - m_tFirstPts;
+      return m_tFirstPacket + duration + boost::posix_time::milliseconds(m_uiPlayoutBufferLatencyMs);
+    }
+    else
+    {
+      // relative to the arrival of the *first* packet: the RTP offset between the first RTP
+      // and the first synced RTP packet has to be added (see RtpJitterBufferV2)
+      boost::posix_time::time_duration duration = tPresentation - m_tFirstSyncedPts;
+      return m_tFirstPacket + duration + boost::posix_time::milliseconds(m_uiPlayoutBufferLatencyMs + m_uiRtpDiffMs);
+    }
+  }
+}
+
+bool
+RtpRingJitterBuffer::doAddRtpPacket(const RtpPacket& packet,
+                                    const boost::posix_time::ptime& tPresentation,
+                                    bool bRtcpSynchronised,
+                                    const boost::posix_time::ptime& tPlayout,
+                                    uint32_t &uiLateMs, bool &bDuplicate)
+{
+  boost::mutex::scoped_lock l(m_listLock);
+  ++m_uiTotalPackets;
+
+  const uint32_t uiSN = packet.getExtendedSequenceNumber();
+  const uint32_t uiRtpTs = packet.getRtpTimestamp();
+
+  VLOG(15) << LOG_MODIFY_WITH_CARE
+           << " RTP TS: " << uiRtpTs
+           << " SN: " << uiSN
+           << " PTS: " << tPresentation
+           << " Playout: " << tPlayout
+           << " Now: " << Clock::universalTime();
+
+  Slot& slot = getSlot(uiSN);
+  if (slot.State != SLOT_EMPTY && slot.ExtendedSN == uiSN)
+  {
+    ++m_uiTotalDuplicates;
+    bDuplicate = true;
+    if (slot.State == SLOT_PLAYED)
+    {
+      // the frame has already been played out: the packet is late too
+      boost::posix_time::ptime tNow = Clock::universalTime();
+      uiLateMs = (tNow > tPlayout) ? static_cast<uint32_t>((tNow - tPlayout).total_milliseconds()) : 1;
+      ++m_uiTotalLatePackets;
+    }
+    return false;
+  }
+
+  auto it = m_mFrames.find(uiRtpTs);
+  if (it != m_mFrames.end())
+  {
+    if (!isSlotAvailable(slot, uiSN))
+    {
+      LOG(WARNING) << "RTP discard: jitter buffer full. SN: " << uiSN
+                   << " Capacity: " << m_vSlots.size();
+      ++m_uiTotalOverflows;
+      return false;
+    }
+    // update frame
+    slot.ExtendedSN = uiSN;
+    slot.State = SLOT_BUFFERED;
+    slot.RtpTs = uiRtpTs;
+    slot.Packet = packet;
+    Frame& frame = it->second;
+    // do signed comparison to handle wrap-around cases
+    if (static_cast<int32_t>(uiSN - frame.FirstSN) < 0) frame.FirstSN = uiSN;
+    if (static_cast<int32_t>(uiSN - frame.LastSN) > 0) frame.LastSN = uiSN;
+    return false;
+  }
+
+  if (hasBeenPlayedOut(packet))
+  {
+    boost::posix_time::ptime tNow = Clock::universalTime();
+    // the frame may have been played out before its playout time
+    uiLateMs = (tNow > tPlayout) ? static_cast<uint32_t>((tNow - tPlayout).total_milliseconds()) : 1;
+    LOG(WARNING) << LOG_MODIFY_WITH_CARE
+                 << " RTP discard: packet is late by " << uiLateMs
+                 << " ms. SN: " << uiSN
+                 << " PTS: " << tPresentation
+                 << " Playout: " << tPlayout
+                 << " Now: " << tNow;
+    ++m_uiTotalLatePackets;
+    return false;
+  }
+
+  // Packet belongs to a new frame as long as the history is long enough
+  // Check how the calculated playout time relates to the current time
+  boost::posix_time::ptime tNow = Clock::universalTime();
+  if (tPlayout < tNow)
+  {
+    // we're assuming that this number is fairly small. Downcast should be fine.
+    uiLateMs = static_cast<uint32_t>((tNow - tPlayout).total_milliseconds());
+    LOG(WARNING) << LOG_MODIFY_WITH_CARE
+                 << " RTP discard: packet is late by " << uiLateMs
+                 << " ms but not in history. SN: " << uiSN
+                 << " PTS: " << tPresentation
+                 << " Playout: " << tPlayout
+                 << " Now: " << tNow;
+    ++m_uiTotalLatePackets;
+    return false;
+  }
+
+  if (!isSlotAvailable(slot, uiSN))
+  {
+    LOG(WARNING) << "RTP discard: jitter buffer full. SN: " << uiSN
+                 << " Capacity: " << m_vSlots.size();
+    ++m_uiTotalOverflows;
+    return false;
+  }
+
+  // create new frame
+  slot.ExtendedSN = uiSN;
+  slot.State = SLOT_BUFFERED;
+  slot.RtpTs = uiRtpTs;
+  slot.Packet = packet;
+  m_mFrames.insert(std::make_pair(uiRtpTs, Frame(uiSN, tPresentation, bRtcpSynchronised, tPlayout)));
+  insertAccordingToPts(uiRtpTs, tPresentation);
+  return true;
+}
+
+bool
+RtpRingJitterBuffer::hasBeenPlayedOut(const RtpPacket& packet)
+{
+  const uint32_t uiSN = packet.getExtendedSequenceNumber();
+  const uint32_t uiRtpTs = packet.getRtpTimestamp();
+  // common case: a neighbouring packet of the same frame has been played out
+  const Slot& previous = getSlot(uiSN - 1);
+  if (previous.State == SLOT_PLAYED && previous.ExtendedSN == uiSN - 1 &&
+      previous.RtpTs == uiRtpTs)
+    return true;
+  const Slot& next = getSlot(uiSN + 1);
+  if (next.State == SLOT_PLAYED && next.ExtendedSN == uiSN + 1 &&
+      next.RtpTs == uiRtpTs)
+    return true;
+
+  // neighbours were lost or overwritten: search the recent history
+  return std::find(m_recentHistory.rbegin(), m_recentHistory.rend(), uiRtpTs) != m_recentHistory.rend();
+}
+
+void
+RtpRingJitterBuffer::insertAccordingToPts(uint32_t uiRtpTs, const boost::posix_time::ptime& tPresentation)
+{
+  // frames usually arrive in presentation order: search from the back
+  std::deque<uint32_t>::reverse_iterator it;
+  it = std::find_if(m_qPlayoutOrder.rbegin(),
+                    m_qPlayoutOrder.rend(),
+                    [this, tPresentation](uint32_t uiTs)
+  {
+      return ( m_mFrames.find(uiTs)->second.Presentation < tPresentation );
+  });
+  m_qPlayoutOrder.insert(it.base(), uiRtpTs);
+}
+
+} // rtp_plus_plus
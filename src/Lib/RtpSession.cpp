@@ -16,7 +16,9 @@
 #include <rtp++/mprtp/MpRtpFeedbackManager.h>
 #include <rtp++/mprtp/MpRtpSessionDatabase.h>
 #include <rtp++/mprtp/MpRtcpReportManager.h>
+#include <rtp++/network/IoUringRtpNetworkInterface.h>
 #include <rtp++/network/MuxedUdpRtpNetworkInterface.h>
+#include <rtp++/network/ReusePortShardGroup.h>
 #include <rtp++/network/RtspAdapterRtpNetworkInterface.h>
 #include <rtp++/network/SctpRtpNetworkInterface.h>
 #include <rtp++/network/UdpRtpNetworkInterface.h>
@@ -44,6 +46,7 @@
 #include <rtp++/rfchevc/RfchevcPacketiser.h>
 #include <rtp++/sctp/SctpRtpPolicy.h>
 #include <rtp++/TransmissionManager.h>
+#include <rtp++/util/Clock.h>
 
 // #define DEBUG_OUTGOING_RTP
 
@@ -57,6 +60,41 @@ namespace rtp_plus_plus
 
 using media::MediaSample;
 
+/**
+ * @brief returns if the io_uring I/O backend has been configured and compiled in
+ */
+static bool useIoUringBackend(const GenericParameters& applicationParameters)
+{
+  boost::optional<std::string> sIoBackend = applicationParameters.getStringParameter(app::ApplicationParameters::io_backend);
+  if (!sIoBackend || *sIoBackend != "io_uring") return false;
+#ifdef ENABLE_IO_URING
+  return true;
+#else
+  LOG_FIRST_N(WARNING, 1) << "io_uring support has not been compiled in, using asio";
+  return false;
+#endif
+}
+
+/**
+ * @brief creates a multiplexed UDP RTP/RTCP interface. If reuse-port has been configured, the socket
+ * is bound with SO_REUSEPORT so that the sessions of other receive threads can bind the same port:
+ * the kernel then distributes the flows over the sessions (see ReusePortShardGroup).
+ */
+static std::unique_ptr<RtpNetworkInterface> createMuxedUdpRtpNetworkInterface(boost::asio::io_service& ioService,
+                                                                              const EndPoint& rtpEp,
+                                                                              const GenericParameters& applicationParameters,
+                                                                              boost::system::error_code& ec)
+{
+  boost::optional<bool> bReusePort = applicationParameters.getBoolParameter(app::ApplicationParameters::reuse_port);
+  if (!bReusePort || !*bReusePort)
+    return std::unique_ptr<RtpNetworkInterface>(new MuxedUdpRtpNetworkInterface(ioService, rtpEp, ec));
+
+  VLOG(2) << "Binding multiplexed RTP/RTCP socket " << rtpEp << " with SO_REUSEPORT";
+  std::unique_ptr<boost::asio::ip::udp::socket> pRtpRtcpSocket = ReusePortShardGroup::createReusePortSocket(ioService, rtpEp, ec);
+  if (ec) return std::unique_ptr<RtpNetworkInterface>();
+  return std::unique_ptr<RtpNetworkInterface>(new MuxedUdpRtpNetworkInterface(ioService, rtpEp, std::move(pRtpRtcpSocket)));
+}
+
 RtpSession::ptr RtpSession::create(boost::asio::io_service& rIoService,
                                        const RtpSessionParameters& rtpParameters,
                                        RtpReferenceClock& rtpReferenceClock,
@@ -93,6 +131,7 @@ RtpSession::RtpSession(boost::asio::io_service& ioService,
 #endif
     m_state(SS_STOPPED),
     m_rtpSessionState(rtpParameters.getPayloadType()),
+    m_arrivalTimestampConverter(rtpParameters.getRtpTimestampFrequency()),
     m_uiByeSentCount(0),
     m_uiLastAUStartSN(0),
     m_uiLastAUPacketCount(0),
@@ -123,6 +162,7 @@ RtpSession::RtpSession(boost::asio::io_service& ioService,
 #endif
     m_state(SS_STOPPED),
     m_rtpSessionState(rtpParameters.getPayloadType()),
+    m_arrivalTimestampConverter(rtpParameters.getRtpTimestampFrequency()),
     m_uiByeSentCount(0),
     m_uiLastAUStartSN(0),
     m_uiLastAUPacketCount(0),
@@ -316,8 +356,7 @@ void RtpSession::setRtpHeaderValues(std::vector<RtpPacket>& rtpPackets, uint32_t
         {
           if (uiNtpMws != 0 && uiNtpLws != 0)
           {
-            rfc5285::HeaderExtensionElement rapidSyncHeader = rfc6051::RtpSynchronisationExtensionHeader::create(m_uiRapidSyncExtmapId, uiNtpMws, uiNtpLws);
-            rtpPacket.addRtpHeaderExtension(rapidSyncHeader);
+            rfc6051::RtpSynchronisationExtensionHeader::append(rtpPacket.getHeaderExtension(), m_uiRapidSyncExtmapId, uiNtpMws, uiNtpLws);
           }
           else
           {
@@ -334,8 +373,7 @@ void RtpSession::setRtpHeaderValues(std::vector<RtpPacket>& rtpPackets, uint32_t
       {
         if (uiNtpMws != 0 && uiNtpLws != 0)
         {
-          rfc5285::HeaderExtensionElement rapidSyncHeader = rfc6051::RtpSynchronisationExtensionHeader::create(m_uiRapidSyncExtmapId, uiNtpMws, uiNtpLws);
-          rtpPackets[0].addRtpHeaderExtension(rapidSyncHeader);
+          rfc6051::RtpSynchronisationExtensionHeader::append(rtpPackets[0].getHeaderExtension(), m_uiRapidSyncExtmapId, uiNtpMws, uiNtpLws);
         }
         else
         {
@@ -445,7 +483,7 @@ const EndPoint& RtpSession::lookupEndPoint(uint16_t uiSubflowId)
   return flow.getRemoteEndPoint().first;
 }
 
-void RtpSession::handleMpRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader)
+void RtpSession::handleMpRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader)
 {
   VLOG(15) << "Handling incoming MPRTP extension header";
   mprtp::MpRtpHeaderParseResult result = mprtp::MpRtpHeaderExtension::parseMpRtpHeader(extensionHeader);
@@ -481,14 +519,13 @@ void RtpSession::sendRtpPacket(const RtpPacket& rtpPacket, uint32_t uiSubflowId)
       mprtp::MpRtpSubflowRtpHeader subflowHeader = generateMpRtpExtensionHeader(uiSubflowId, true);
       RtpPacket& packet = const_cast<RtpPacket&>(rtpPacket);
       packet.setMpRtpSubflowHeader(subflowHeader);
-      rfc5285::HeaderExtensionElement extensionHeader = mprtp::MpRtpHeaderExtension::generateMpRtpHeaderExtension(m_uiMpRtpExtmapId, subflowHeader);
       packet.getHeaderExtension().removeHeaderExtension(m_uiMpRtpExtmapId);
-      packet.addRtpHeaderExtension(extensionHeader);
+      mprtp::MpRtpHeaderExtension::appendMpRtpHeaderExtension(packet.getHeaderExtension(), m_uiMpRtpExtmapId, subflowHeader);
       VLOG(5) << LOG_MODIFY_WITH_CARE
               << " RTX Packet sent SN: " << rtpPacket.getSequenceNumber()
               << " Flow Id: " << uiSubflowId
               << " FSSN: " << subflowHeader.getFlowSpecificSequenceNumber()
-              << " Time: " << boost::posix_time::microsec_clock::universal_time();
+              << " Time: " << Clock::universalTime();
     }
     else
     {
@@ -496,13 +533,12 @@ void RtpSession::sendRtpPacket(const RtpPacket& rtpPacket, uint32_t uiSubflowId)
       mprtp::MpRtpSubflowRtpHeader subflowHeader = generateMpRtpExtensionHeader(uiSubflowId);
       RtpPacket& packet = const_cast<RtpPacket&>(rtpPacket);
       packet.setMpRtpSubflowHeader(subflowHeader);
-      rfc5285::HeaderExtensionElement extensionHeader = mprtp::MpRtpHeaderExtension::generateMpRtpHeaderExtension(m_uiMpRtpExtmapId, subflowHeader);
-      packet.addRtpHeaderExtension(extensionHeader);
+      mprtp::MpRtpHeaderExtension::appendMpRtpHeaderExtension(packet.getHeaderExtension(), m_uiMpRtpExtmapId, subflowHeader);
       VLOG(5) << LOG_MODIFY_WITH_CARE
               << " Packet sent SN: " << rtpPacket.getSequenceNumber()
               << " Flow Id: " << uiSubflowId
               << " FSSN: " << subflowHeader.getFlowSpecificSequenceNumber()
-              << " Time: " << boost::posix_time::microsec_clock::universal_time();
+              << " Time: " << Clock::universalTime();
     }
     // last method for RtpSessionManager to modify packet
     const EndPoint& ep = lookupEndPoint(uiSubflowId);
@@ -538,12 +574,36 @@ void RtpSession::sendRtpPackets(const std::vector<RtpPacket>& rtpPackets)
     // HACK for SCTP: the RtpPacket contains the ID of the SCTP channel
     // The SCTP network interface looks for this id in the end point
     EndPoint endpoint = m_parameters.getRemoteEndPoint(0).first;
-    // sending packets as fast as possible
+    bool bSameId = true;
     for (auto& rtpPacket: rtpPackets)
     {
-      endpoint.setId(rtpPacket.getId());
-      if (m_beforeOutgoingRtp) m_beforeOutgoingRtp(rtpPacket, endpoint);
-      m_vRtpInterfaces[0]->send(rtpPacket, endpoint);
+      if (rtpPacket.getId() != rtpPackets.front().getId())
+      {
+        bSameId = false;
+        break;
+      }
+    }
+
+    if (bSameId && rtpPackets.size() > 1)
+    {
+      // hand all packets of the sample to the network interface at once so that it can batch the sends
+      endpoint.setId(rtpPackets.front().getId());
+      if (m_beforeOutgoingRtp)
+      {
+        for (auto& rtpPacket: rtpPackets)
+          m_beforeOutgoingRtp(rtpPacket, endpoint);
+      }
+      m_vRtpInterfaces[0]->send(rtpPackets, endpoint);
+    }
+    else
+    {
+      // sending packets as fast as possible
+      for (auto& rtpPacket: rtpPackets)
+      {
+        endpoint.setId(rtpPacket.getId());
+        if (m_beforeOutgoingRtp) m_beforeOutgoingRtp(rtpPacket, endpoint);
+        m_vRtpInterfaces[0]->send(rtpPacket, endpoint);
+      }
     }
   }
 }
@@ -586,13 +646,49 @@ std::vector<RtpNetworkInterface::ptr> RtpSession::createRtpNetworkInterfaces(con
 
 void RtpSession::configureNetworkInterface(RtpNetworkInterface::ptr& pRtpInterface,
                                            const RtpSessionParameters &rtpParameters,
-                                           const GenericParameters& /*applicationParameters*/)
+                                           const GenericParameters& applicationParameters)
 {
   if (rfc3711::isSecureProfile(rtpParameters))
   {
     pRtpInterface->secureRtp(true);
   }
 
+  boost::optional<uint32_t> uiRecvBatch = applicationParameters.getUintParameter(app::ApplicationParameters::recv_batch);
+  if (uiRecvBatch && *uiRecvBatch > 1)
+  {
+    UdpRtpNetworkInterface* pUdpInterface = dynamic_cast<UdpRtpNetworkInterface*>(pRtpInterface.get());
+    if (pUdpInterface)
+    {
+      VLOG(2) << "Using batched UDP receive: " << *uiRecvBatch;
+      pUdpInterface->setReceiveBatchSize(*uiRecvBatch);
+    }
+  }
+
+  boost::optional<uint32_t> uiSendBatch = applicationParameters.getUintParameter(app::ApplicationParameters::send_batch);
+  if (uiSendBatch && *uiSendBatch > 1)
+  {
+    UdpRtpNetworkInterface* pUdpInterface = dynamic_cast<UdpRtpNetworkInterface*>(pRtpInterface.get());
+    if (pUdpInterface)
+    {
+      boost::optional<bool> bUdpGso = applicationParameters.getBoolParameter(app::ApplicationParameters::udp_gso);
+      VLOG(2) << "Using batched UDP send: " << *uiSendBatch << " GSO: " << (bUdpGso && *bUdpGso);
+      pUdpInterface->setSendBatchSize(*uiSendBatch, bUdpGso && *bUdpGso);
+    }
+  }
+
+  boost::optional<bool> bKernelTimestamps = applicationParameters.getBoolParameter(app::ApplicationParameters::kernel_timestamps);
+  if (bKernelTimestamps && *bKernelTimestamps)
+  {
+    UdpRtpNetworkInterface* pUdpInterface = dynamic_cast<UdpRtpNetworkInterface*>(pRtpInterface.get());
+    MuxedUdpRtpNetworkInterface* pMuxedInterface = dynamic_cast<MuxedUdpRtpNetworkInterface*>(pRtpInterface.get());
+    bool bSupported = false;
+    if (pUdpInterface)
+      bSupported = pUdpInterface->setKernelTimestamps(true);
+    else if (pMuxedInterface)
+      bSupported = pMuxedInterface->setKernelTimestamps(true);
+    VLOG(2) << "Using kernel receive timestamps: " << bSupported;
+  }
+
   if (rtpParameters.isXrEnabled())
   {
     pRtpInterface->registerRtcpParser( rfc3611::RtcpParser::create() );
@@ -667,7 +763,7 @@ void RtpSession::configureNetworkInterface(RtpNetworkInterface::ptr& pRtpInterfa
   }
 }
 
-void RtpSession::handleRtcpRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader)
+void RtpSession::handleRtcpRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader)
 {
   assert(!m_vRtpInterfaces.empty());
   // just using packetiser from first RTP interface
@@ -679,7 +775,7 @@ void RtpSession::handleRtcpRtpExtensionHeader(const RtpPacket& rtpPacket, rfc528
   onIncomingRtcp(rtcp, ep);
 }
 
-void RtpSession::handleRapidSyncRtpExtensionHeader(const RtpPacket& rtpPacket, rfc5285::HeaderExtensionElement& extensionHeader)
+void RtpSession::handleRapidSyncRtpExtensionHeader(const RtpPacket& rtpPacket, const rfc5285::HeaderExtensionElementView& extensionHeader)
 {
   boost::optional<uint64_t> ntpTs = rfc6051::RtpSynchronisationExtensionHeader::parseRtpSynchronisationExtensionHeader(extensionHeader);
   if (ntpTs)
@@ -753,12 +849,41 @@ std::vector<RtpNetworkInterface::ptr> RtpSession::createRtpNetworkInterfacesSing
           LOG(WARNING) << "Failed to lookup existing RTCP port for " << rtcpEp;
           return std::vector<RtpNetworkInterface::ptr>();
         }
-        pRtpInterface = std::unique_ptr<UdpRtpNetworkInterface>(new UdpRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, std::move(pRtpSocket), std::move(pRtcpSocket)));
+        if (useIoUringBackend(applicationParameters))
+        {
+          // the sockets have been handed over: there is no fallback
+          boost::system::error_code ec;
+          pRtpInterface = std::unique_ptr<IoUringRtpNetworkInterface>(new IoUringRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, std::move(pRtpSocket), std::move(pRtcpSocket), ec));
+          if (ec)
+          {
+            LOG(WARNING) << "Error constructing io_uring RTP interfaces: " << ec.message();
+            return std::vector<RtpNetworkInterface::ptr>();
+          }
+        }
+        else
+        {
+          pRtpInterface = std::unique_ptr<UdpRtpNetworkInterface>(new UdpRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, std::move(pRtpSocket), std::move(pRtcpSocket)));
+        }
       }
       else
       {
         boost::system::error_code ec;
-        pRtpInterface = std::unique_ptr<UdpRtpNetworkInterface>(new UdpRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, ec));
+        if (useIoUringBackend(applicationParameters))
+        {
+          VLOG(2) << "Using io_uring I/O backend";
+          pRtpInterface = std::unique_ptr<IoUringRtpNetworkInterface>(new IoUringRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, ec));
+          if (ec)
+          {
+            // e.g. the kernel does not support multishot receive
+            LOG(WARNING) << "Error constructing io_uring RTP interfaces, falling back to asio: " << ec.message();
+            pRtpInterface.reset();
+            ec = boost::system::error_code();
+          }
+        }
+        if (!pRtpInterface)
+        {
+          pRtpInterface = std::unique_ptr<UdpRtpNetworkInterface>(new UdpRtpNetworkInterface(m_rIoService, rtpEp, rtcpEp, ec));
+        }
         if (ec)
         {
           LOG(WARNING) << "Error constructing RTP interfaces: " << ec.message();
@@ -789,7 +914,7 @@ std::vector<RtpNetworkInterface::ptr> RtpSession::createRtpNetworkInterfacesSing
         else
         {
           boost::system::error_code ec;
-          pRtpInterface = std::unique_ptr<MuxedUdpRtpNetworkInterface>(new MuxedUdpRtpNetworkInterface(m_rIoService, rtpEp, ec));
+          pRtpInterface = createMuxedUdpRtpNetworkInterface(m_rIoService, rtpEp, applicationParameters, ec);
           if (ec)
           {
             LOG(WARNING) << "Error constructing RTP/RTCP interfaces: " << ec.message();
@@ -1120,6 +1245,12 @@ PayloadPacketiserBase::ptr RtpSession::createPayloadPacketiser(const RtpSessionP
       if (disableStap)
         pPacketiser->setDisableStap(*disableStap);
     }
+    boost::optional<bool> zeroCopy = applicationParameters.getBoolParameter(app::ApplicationParameters::zero_copy_packetisation);
+    if (zeroCopy)
+      pPacketiser->setZeroCopy(*zeroCopy);
+    boost::optional<bool> deliverIncomplete = applicationParameters.getBoolParameter(app::ApplicationParameters::deliver_incomplete_nal_units);
+    if (deliverIncomplete)
+      pPacketiser->setDeliverIncompleteNalUnits(*deliverIncomplete);
     return PayloadPacketiserBase::ptr(pPacketiser);
   }
   else if (rtpParameters.getEncodingName() == rfc6190::H264_SVC )
@@ -1147,9 +1278,17 @@ PayloadPacketiserBase::ptr RtpSession::createPayloadPacketiser(const RtpSessionP
       std::string sFmtp = fmtp[0];
       media::h265::H265FormatDescription description(sFmtp);
       rfchevc::RfchevcPacketiser::PacketizationMode eMode = static_cast<rfchevc::RfchevcPacketiser::PacketizationMode>(convert<uint32_t>(description.PacketizationMode, 0));
+      // DONL fields are present if sprop-max-don-diff is greater than 0
+      uint32_t uiMaxDonDiff = convert<uint32_t>(description.SpropMaxDonDiff, 0);
+      if (uiMaxDonDiff > 0)
+        eMode = rfchevc::RfchevcPacketiser::INTERLEAVED_MODE;
       // configure packetization mode
       pPacketiser->setPacketizationMode(eMode);
+      pPacketiser->setMaxDonDiff(uiMaxDonDiff);
     }
+    boost::optional<bool> zeroCopy = applicationParameters.getBoolParameter(app::ApplicationParameters::zero_copy_packetisation);
+    if (zeroCopy)
+      pPacketiser->setZeroCopy(*zeroCopy);
     return PayloadPacketiserBase::ptr(pPacketiser);
   }
   else if (rtpParameters.getEncodingName() == rfc4867::AMR)
@@ -1165,16 +1304,25 @@ PayloadPacketiserBase::ptr RtpSession::createPayloadPacketiser(const RtpSessionP
 }
 
 rfc3550::SessionDatabase::ptr RtpSession::createSessionDatabase(const RtpSessionParameters& rtpParameters,
-                                                                const GenericParameters& /*applicationParameters*/)
+                                                                const GenericParameters& applicationParameters)
 {
+  rfc3550::SessionDatabase::ptr pSessionDb;
   if (mprtp::isMpRtpSession(rtpParameters))
   {
-    return mprtp::MpRtpSessionDatabase::create(m_rtpSessionState, rtpParameters);
+    pSessionDb = mprtp::MpRtpSessionDatabase::create(m_rtpSessionState, rtpParameters);
   }
   else
   {
-    return rfc3550::SessionDatabase::create(m_rtpSessionState, rtpParameters);
+    pSessionDb = rfc3550::SessionDatabase::create(m_rtpSessionState, rtpParameters);
   }
+
+  boost::optional<uint32_t> uiMaxReportedSenders = applicationParameters.getUintParameter(app::ApplicationParameters::max_reported_senders);
+  if (uiMaxReportedSenders)
+  {
+    VLOG(2) << "Reporting on at most " << *uiMaxReportedSenders << " senders per RTCP interval";
+    pSessionDb->setMaxReportedSenders(*uiMaxReportedSenders);
+  }
+  return pSessionDb;
 }
 
 bool RtpSession::tryScheduleEarlyFeedback(uint16_t uiFlow, boost::posix_time::ptime& tScheduled, uint32_t& uiMs)
@@ -1260,8 +1408,9 @@ RtpSession::createRtcpReportManagers(const RtpSessionParameters &rtpParameters,
       }
 
       // configure callback used for feedback information
-      pFbReportManager->setFeedbackCallback(boost::bind(&RtpSession::onGenerateFeedback, this, _1));
+      pFbReportManager->setFeedbackWriterCallback(boost::bind(&RtpSession::onGenerateFeedback, this, _1, _2));
       pFbReportManager->setRtcpHandler(boost::bind(&RtpSession::onRtcpReportGeneration, this, _1));
+      pFbReportManager->setRtcpFeedbackHandler(boost::bind(&RtpSession::onRtcpReportGeneration, this, _1, _2));
       vRtcpReportManagers.push_back( std::move(pFbReportManager));
     }
     else
@@ -1273,11 +1422,11 @@ RtpSession::createRtcpReportManagers(const RtpSessionParameters &rtpParameters,
   return vRtcpReportManagers;
 }
 
-void RtpSession::onGenerateFeedback(CompoundRtcpPacket& feedback)
+void RtpSession::onGenerateFeedback(CompoundRtcpPacket& feedback, RtcpCompoundWriter& writer)
 {
   if (m_onFeedback)
   {
-    m_onFeedback(feedback);
+    m_onFeedback(feedback, writer);
   }
 #if 0
   if (m_pFeedbackManager)
@@ -1389,6 +1538,8 @@ void RtpSession::initialiseRtpNetworkInterfaces(const RtpSessionParameters &rtpP
 
     pRtpInterface->setIncomingRtpHandler(boost::bind(&RtpSession::onIncomingRtp, this, _1, _2) );
     pRtpInterface->setIncomingRtcpHandler(boost::bind(&RtpSession::onIncomingRtcp, this, _1, _2) );
+    if (m_incomingFb)
+      pRtpInterface->setIncomingFbHandler(boost::bind(&RtpSession::onIncomingFb, this, _1, _2) );
     pRtpInterface->setOutgoingRtpHandler(boost::bind(&RtpSession::onOutgoingRtp, this, _1, _2) );
     pRtpInterface->setOutgoingRtcpHandler(boost::bind(&RtpSession::onOutgoingRtcp, this, _1, _2) );
   }
@@ -1410,16 +1561,17 @@ void RtpSession::onIncomingRtp( const RtpPacket& rtpPacket, const EndPoint& ep )
 #endif
 
   // convert arrival time to RTP time
-  uint32_t uiRtpTime = RtpTime::convertTimeToRtpTimestamp(rtpPacket.getArrivalTime(), m_parameters.getRtpTimestampFrequency(), m_rtpSessionState.getRtpTimestampBase());
+  uint32_t uiRtpTime = m_arrivalTimestampConverter.toRtpTimestamp(rtpPacket.getArrivalTimeNs(), m_rtpSessionState.getRtpTimestampBase());
   RtpPacket& rPacket = const_cast<RtpPacket&>(rtpPacket);
   rPacket.setRtpArrivalTimestamp(uiRtpTime);
 
-  // process extension headers
+  // process extension headers: the elements reference the received datagram
   const rfc5285::RtpHeaderExtension& extension = rtpPacket.getHeaderExtension();
-  std::vector<rfc5285::HeaderExtensionElement> vExtensions = extension.getHeaderExtensions();
-  VLOG(12) << "RTP header has " << vExtensions.size() << " extensions";
-  for (rfc5285::HeaderExtensionElement& ext: vExtensions)
+  const std::size_t uiExtensionCount = extension.getHeaderExtensionCount();
+  VLOG(12) << "RTP header has " << uiExtensionCount << " extensions";
+  for (std::size_t i = 0; i < uiExtensionCount; ++i)
   {
+    rfc5285::HeaderExtensionElementView ext = extension.getHeaderExtension(i);
     auto it = m_mExtensionHeaderHandlers.find(ext.getId());
     if (it != m_mExtensionHeaderHandlers.end())
     {
@@ -1486,7 +1638,7 @@ void RtpSession::onOutgoingRtp( const RtpPacket& rtpPacket, const EndPoint& ep )
 #endif
 
   // store RTP TS and local system time mapping
-  m_tLastRtpPacketSent = boost::posix_time::microsec_clock::universal_time();
+  m_tLastRtpPacketSent = Clock::universalTime();
   m_uiRtpTsLastRtpPacketSent = rtpPacket.getHeader().getRtpTimestamp();
 
   m_pSessionDb->onSendRtpPacket(rtpPacket, ep);
@@ -1549,6 +1701,13 @@ void RtpSession::onIncomingRtcp( const CompoundRtcpPacket& compoundRtcp, const E
   VLOG(10) << "[" << this << "] RTCP reports processed successfully: " << compoundRtcp.size();
 }
 
+void RtpSession::onIncomingFb( const RtcpFbView& fb, const EndPoint& ep )
+{
+  // the size is accounted for when the rest of the compound packet is processed
+  m_pSessionDb->addIncomingFeedbackSize(fb.getSize());
+  if (m_incomingFb) m_incomingFb(fb, ep);
+}
+
 void RtpSession::onOutgoingRtcp( const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep )
 {
   m_pSessionDb->onSendRtcpPacket(compoundRtcp, ep);
@@ -1604,6 +1763,21 @@ void RtpSession::onRtcpReportGeneration(const CompoundRtcpPacket &rtcp)
   m_rtpSessionStatistics.newInterval();
 }
 
+void RtpSession::onRtcpReportGeneration(const CompoundRtcpPacket& rtcp, const Buffer& feedback)
+{
+  const EndPoint rtcpEp = m_parameters.getRemoteEndPoint(0).second;
+  // the feedback is not part of the compound packet passed to onOutgoingRtcp
+  m_pSessionDb->addOutgoingFeedbackSize(feedback.getSize());
+  if (!m_vRtpInterfaces[0]->send(rtcp, feedback, rtcpEp))
+  {
+    VLOG(2) << "Failed to send RTCP packet";
+    onOutgoingRtcp(rtcp, rtcpEp);
+  }
+
+  // reset state for next interval
+  m_rtpSessionStatistics.newInterval();
+}
+
 void RtpSession::onRtcpReportGeneration( const CompoundRtcpPacket& rtcp, uint32_t uiInterfaceIndex, const EndPoint& rtcpEp )
 {
   assert(uiInterfaceIndex < m_vRtpInterfaces.size());
@@ -3,6 +3,7 @@
 #include <cpputil/ExceptionBase.h>
 #include <rtp++/RtpJitterBuffer.h>
 #include <rtp++/RtpJitterBufferV2.h>
+#include <rtp++/RtpRingJitterBuffer.h>
 #include <rtp++/PtsBasedJitterBuffer.h>
 #include <rtp++/application/ApplicationParameters.h>
 #include <rtp++/application/ApplicationUtil.h>
@@ -17,8 +18,8 @@
 #include <rtp++/rfc4585/FeedbackManager.h>
 #include <rtp++/scheduling/SchedulerFactory.h>
 #include <rtp++/TransmissionManager.h>
+#include <rtp++/util/Clock.h>
 
-using boost::asio::deadline_timer;
 using boost::optional;
 
 namespace rtp_plus_plus
@@ -30,6 +31,7 @@ using media::MediaSample;
 static const uint32_t STANDARD_JITTER_BUFFER = 0;
 static const uint32_t PTS_JITTER_BUFFER = 1;
 static const uint32_t JITTER_BUFFER_V2 = 2;
+static const uint32_t RING_JITTER_BUFFER = 3;
 
 std::unique_ptr<RtpSessionManager> RtpSessionManager::create(boost::asio::io_service& ioService,
                                                              const GenericParameters& applicationParameters)
@@ -41,6 +43,8 @@ RtpSessionManager::RtpSessionManager(boost::asio::io_service& ioService,
                                      const GenericParameters& applicationParameters)
   :IRtpSessionManager(applicationParameters),
     m_rIoService(ioService),
+    m_rTimerService(boost::asio::use_service<TimerService>(ioService)),
+    m_uiPlayoutTimerGroup(m_rTimerService.createGroup()),
     m_bExitOnBye(false),
     m_bAnalyse(false),
     m_bFirstSyncedVideo(false),
@@ -71,6 +75,11 @@ RtpSessionManager::RtpSessionManager(boost::asio::io_service& ioService,
         m_pReceiverBuffer = RtpJitterBuffer::create(uiBufLat);
         break;
       }
+      case RING_JITTER_BUFFER:
+      {
+        m_pReceiverBuffer = RtpRingJitterBuffer::create(uiBufLat);
+        break;
+      }
       case JITTER_BUFFER_V2:
       default:
       {
@@ -148,7 +157,7 @@ RtpSessionManager::~RtpSessionManager()
   }
 }
 
-void RtpSessionManager::onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp)
+void RtpSessionManager::onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp, RtcpCompoundWriter& writer)
 {
   VLOG(12) << "RtpSessionManager::onFeedbackGeneration";
   const RtpSessionState& state = m_pRtpSession->getRtpSessionState();
@@ -161,7 +170,7 @@ void RtpSessionManager::onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp)
       const int MAX_RTX = 30;
       if (vLost.size() < MAX_RTX)
       {
-        boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+        boost::posix_time::ptime tNow = Clock::universalTime();
         VLOG(2) << "Adding NACKS for " << ::toString(vLost);
         // TODO: notify fb manager of RTX request time
 #if 1
@@ -172,8 +181,9 @@ void RtpSessionManager::onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp)
           m_pFeedbackManager->onRtxRequested(tNow, uiSN);
         }
 #endif
-        rfc4585::RtcpGenericNack::ptr pNack = rfc4585::RtcpGenericNack::create(vLost, state.getRemoteSSRC(), state.getSSRC());
-        compoundRtcp.push_back(pNack);
+        m_vOutgoingFbSNs.assign(vLost.begin(), vLost.end());
+        if (!writer.writeGenericNack(state.getRemoteSSRC(), state.getSSRC(), m_vOutgoingFbSNs))
+          LOG(WARNING) << "No space for generic NACK with " << vLost.size() << " packets in RTCP packet";
       }
       else
       {
@@ -200,8 +210,9 @@ void RtpSessionManager::onFeedbackGeneration(CompoundRtcpPacket& compoundRtcp)
       {
         m_uiLastReceived = uiLastReceived;
         VLOG(2) << "Got last " << vReceived.size() << " received sequence numbers: " << ::toString(vReceived);
-        rfc4585::RtcpGenericAck::ptr pAck = rfc4585::RtcpGenericAck::create(vReceived, state.getRemoteSSRC(), state.getSSRC());
-        compoundRtcp.push_back(pAck);
+        m_vOutgoingFbSNs.assign(vReceived.begin(), vReceived.end());
+        if (!writer.writeGenericAck(state.getRemoteSSRC(), state.getSSRC(), m_vOutgoingFbSNs))
+          LOG(WARNING) << "No space for generic ACK in RTCP packet";
       }
     }
   }
@@ -256,7 +267,7 @@ void RtpSessionManager::onMpFeedbackGeneration(uint16_t uiFlowId, CompoundRtcpPa
       const int MAX_RTX = 30;
       if (vLost.size() < MAX_RTX)
       {
-        boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+        boost::posix_time::ptime tNow = Clock::universalTime();
         VLOG(2) << "Adding NACKS for " << ::toString(vLost);
         // TODO: notify fb manager of RTX request time
 #if 1
@@ -287,7 +298,7 @@ void RtpSessionManager::onMpFeedbackGeneration(uint16_t uiFlowId, CompoundRtcpPa
       const int MAX_RTX = 30;
       if (vLost.size() < MAX_RTX)
       {
-        boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+        boost::posix_time::ptime tNow = Clock::universalTime();
         VLOG(2) << "Adding NACKS for " << ::toString(vLost);
         // TODO: notify fb manager of RTX request time
 #if 1
@@ -329,7 +340,7 @@ void RtpSessionManager::onMpFeedbackGeneration(uint16_t uiFlowId, CompoundRtcpPa
       // We would have to create one RTO per source to be able
       // to handle multiple sources?
 
-      boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+      boost::posix_time::ptime tNow = Clock::universalTime();
 #if 1
       for (auto& loss : vFlowSpecificLosses)
       {
@@ -359,6 +370,8 @@ void RtpSessionManager::setRtpSession(RtpSession::ptr pRtpSession)
         boost::bind(&RtpSessionManager::handleIncomingRtp, this, _1, _2, _3, _4, _5));
   m_pRtpSession->setIncomingRtcpHandler(
         boost::bind(&RtpSessionManager::handleIncomingRtcp, this, _1, _2));
+  m_pRtpSession->setIncomingFbHandler(
+        boost::bind(&RtpSessionManager::handleIncomingFb, this, _1, _2));
   m_pRtpSession->setBeforeOutgoingRtpHandler(
         boost::bind(&RtpSessionManager::handleBeforeOutgoingRtp, this, _1, _2));
   m_pRtpSession->setOutgoingRtpHandler(
@@ -370,7 +383,7 @@ void RtpSessionManager::setRtpSession(RtpSession::ptr pRtpSession)
   m_pRtpSession->setRtpSessionCompleteHandler(
         boost::bind(&RtpSessionManager::handleRtpSessionComplete, this));
   m_pRtpSession->setFeedbackCallback(
-        boost::bind(&RtpSessionManager::onFeedbackGeneration, this, _1));
+        boost::bind(&RtpSessionManager::onFeedbackGeneration, this, _1, _2));
   m_pRtpSession->setMpFeedbackCallback(
         boost::bind(&RtpSessionManager::onMpFeedbackGeneration, this, _1, _2));
 
@@ -404,6 +417,13 @@ void RtpSessionManager::setRtpSession(RtpSession::ptr pRtpSession)
                                                                                      m_rIoService,
                                                                                      eMode,
                                                                                      rtpParameters.getRetransmissionTimeout()));
+    optional<uint32_t> uiRtxHistoryBytes = m_applicationParameters.getUintParameter(app::ApplicationParameters::rtx_history_bytes);
+    if (uiRtxHistoryBytes)
+    {
+      // the age limit only applies in NACK mode where it is the rtx-time
+      uint32_t uiMaxAgeMs = (eMode == TxBufferManagementMode::NACK_TIMED_MODE) ? rtpParameters.getRetransmissionTimeout() : 0;
+      m_pTxManager->setHistoryLimits(uiMaxAgeMs, *uiRtxHistoryBytes);
+    }
   }
 
   if (m_pRtpSession->isMpRtpSession())
@@ -520,13 +540,7 @@ boost::system::error_code RtpSessionManager::stop()
   // stop all scheduled samples
   // cancel all scheduled media sample events
   VLOG(10) << "[" << this << "] Shutting down Playout timers";
-  {
-    boost::mutex::scoped_lock l(m_timerLock);
-    for (auto& pair : m_mPlayoutTimers)
-    {
-      pair.second->cancel();
-    }
-  }
+  m_rTimerService.cancel(m_uiPlayoutTimerGroup);
 
   return boost::system::error_code();
 }
@@ -840,18 +854,14 @@ void RtpSessionManager::doHandleIncomingRtp(const RtpPacket& rtpPacket, const En
   bool bDuplicate = false;
   if (m_pReceiverBuffer->addRtpPacket(rtpPacket, tPresentation, bRtcpSynchronised, tPlayout, uiLateMs, bDuplicate))
   {
-    using boost::asio::deadline_timer;
     // a playout time has now been scheduled: create a timed event
-    deadline_timer* pTimer = new deadline_timer(m_rIoService);
 #ifdef DEBUG_PLAYOUT_DEADLINE
     ptime tNow = microsec_clock::universal_time();
     long diffMs = (tPlayout - tNow).total_milliseconds();
     VLOG(10) << "Scheduling packet for playout at " << tPlayout << " (in " << diffMs << "ms)";
 #endif
-    pTimer->expires_at(tPlayout);
-    pTimer->async_wait(boost::bind(&RtpSessionManager::onScheduledSampleTimeout, this, _1, pTimer) );
-    boost::mutex::scoped_lock l(m_timerLock);
-    m_mPlayoutTimers.insert(std::make_pair(pTimer, pTimer));
+    m_rTimerService.expiresAt(tPlayout, boost::bind(&RtpSessionManager::onScheduledSampleTimeout, this, _1),
+                              m_uiPlayoutTimerGroup);
   }
   else
   {
@@ -967,8 +977,7 @@ void RtpSessionManager::prepareSampleForOutput(const std::vector<MediaSample>& v
   }
 }
 
-void RtpSessionManager::onScheduledSampleTimeout(const boost::system::error_code& ec,
-                                                 boost::asio::deadline_timer* pTimer)
+void RtpSessionManager::onScheduledSampleTimeout(const boost::system::error_code& ec)
 {
   if (ec != boost::asio::error::operation_aborted)
   {
@@ -984,13 +993,6 @@ void RtpSessionManager::onScheduledSampleTimeout(const boost::system::error_code
     }
   }
 
-  {
-    boost::mutex::scoped_lock l(m_timerLock);
-    std::size_t uiRemoved = m_mPlayoutTimers.erase(pTimer);
-    assert(uiRemoved == 1);
-  }
-  delete pTimer;
-
   triggerNotification();
 }
 
@@ -1080,6 +1082,37 @@ void RtpSessionManager::doHandleFb(const rfc4585::RtcpFb& fb, const EndPoint& ep
   m_pScheduler->processFeedback(fb, ep);
 }
 
+void RtpSessionManager::handleIncomingFb(const RtcpFbView& fb, const EndPoint& ep)
+{
+  VLOG(6) << "Received FB from " << ep;
+  m_vIncomingFbSNs.clear();
+  switch (fb.getFormat())
+  {
+    case rfc4585::TL_FB_GENERIC_NACK:
+    {
+      fb.readNacks(m_vIncomingFbSNs);
+      VLOG(10) << "Received generic NACK containing " << m_vIncomingFbSNs.size();
+      handleNacks(m_vIncomingFbSNs, ep);
+      assert(m_pScheduler);
+      m_pScheduler->processNacks(m_vIncomingFbSNs, ep);
+      break;
+    }
+    case rfc4585::TL_FB_GENERIC_ACK:
+    {
+      fb.readAcks(m_vIncomingFbSNs);
+      VLOG(10) << "Received generic ACK of size (" << m_vIncomingFbSNs.size() << ") containing SNs " << ::toString(m_vIncomingFbSNs);
+      handleAcks(m_vIncomingFbSNs, ep);
+      assert(m_pScheduler);
+      m_pScheduler->processAcks(m_vIncomingFbSNs, ep);
+      break;
+    }
+    default:
+    {
+      LOG_FIRST_N(WARNING, 1) << "Unhandled generic feedback report type: " << (uint32_t)fb.getFormat();
+    }
+  }
+}
+
 void RtpSessionManager::handleNacks(const std::vector<uint16_t>& nacks, const EndPoint &ep)
 {
   VLOG(6) << "Received NACKS: " << ::toString(nacks);
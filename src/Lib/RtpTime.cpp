@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <cpputil/Utility.h>
+#include <rtp++/util/Clock.h>
 
 // -DDEBUG_RTP_TIMESTAMP_CONVERSION
 // #define DEBUG_RTP_TIMESTAMP_CONVERSION
@@ -54,20 +55,7 @@ uint32_t RtpTime::convertTimeToRtpTimestamp( const boost::posix_time::ptime& tAr
 
 uint32_t RtpTime::currentTimeToRtpTimestamp(uint32_t uiTimestampFrequency, uint32_t uiTimestampBase)
 {
-  boost::posix_time::ptime tEpoch(boost::gregorian::date(1970,1,1));
-  boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
-  boost::posix_time::time_duration diff = tNow - tEpoch;
-  uint32_t uiSeconds = static_cast<uint32_t>(diff.total_seconds());
-  uint32_t uiMicroseconds = static_cast<uint32_t>(diff.fractional_seconds());
-
-  uint32_t uiRtpTimestamp = uiTimestampFrequency * uiSeconds;
-  uiRtpTimestamp += (uint32_t)((((double)uiMicroseconds * uiTimestampFrequency)/1000000.0)+0.5);
-
-#ifdef DEBUG_RTP_TIMESTAMP_CONVERSION
-  DLOG(INFO) << "Seconds: " << uiSeconds << " Microseconds: " << uiMicroseconds << "RTP TS: " << uiRtpTimestamp;
-#endif
-
-    return uiTimestampBase + uiRtpTimestamp;
+  return RtpTimestampConverter(uiTimestampFrequency).toRtpTimestamp(Clock::realtimeNs(), uiTimestampBase);
 }
 
 void RtpTime::convertRtpToSystemTimestamp(uint32_t& uiSeconds, uint32_t& uiMicroseconds, uint32_t uiRtpTimestamp, uint32_t uiTimestampFrequency)
@@ -96,21 +84,20 @@ void RtpTime::getTimeDifference(boost::posix_time::ptime t1, boost::posix_time::
 
 void RtpTime::getTimeElapsedSince(boost::gregorian::date epoch, uint32_t& uiSeconds, uint32_t& uiMicroseconds)
 {
-  getTimeDifference(boost::posix_time::ptime(epoch), boost::posix_time::microsec_clock::universal_time(), uiSeconds, uiMicroseconds);
+  getTimeDifference(boost::posix_time::ptime(epoch), Clock::universalTime(), uiSeconds, uiMicroseconds);
 }
 
 boost::posix_time::ptime RtpTime::convertCurrentTimeToNtpTimestamp()
 {
-  boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
-  uint32_t uiNtpMsw = 0, uiNtpLsw = 0;
-  RtpTime::convertToNtpTimestamp(tNow, uiNtpMsw, uiNtpLsw);
-  return convertNtpTimestampToPosixTime(uiNtpMsw, uiNtpLsw);
+  uint64_t uiNtp = convertUnixNsToNtpTimestamp(Clock::realtimeNs());
+  return convertNtpTimestampToPosixTime(static_cast<uint32_t>(uiNtp >> 32), static_cast<uint32_t>(uiNtp & 0xFFFFFFFF));
 }
 
 void RtpTime::convertCurrentTimeToNtpTimestamp(uint32_t& uiNtpMsw, uint32_t& uiNtpLsw)
 {
-  boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
-  RtpTime::convertToNtpTimestamp(tNow, uiNtpMsw, uiNtpLsw);
+  uint64_t uiNtp = convertUnixNsToNtpTimestamp(Clock::realtimeNs());
+  uiNtpMsw = static_cast<uint32_t>(uiNtp >> 32);
+  uiNtpLsw = static_cast<uint32_t>(uiNtp & 0xFFFFFFFF);
 }
 
 void RtpTime::convertToNtpTimestamp(boost::posix_time::ptime t1, uint32_t& uiNtpMsw, uint32_t& uiNtpLsw)
@@ -158,6 +145,14 @@ boost::posix_time::ptime RtpTime::convertNtpTimestampToPosixTime(uint32_t uiNtpM
   return tTime;
 }
 
+uint64_t RtpTime::convertUnixTimeToNtpTimestamp(uint64_t uiSeconds, uint32_t uiNanoseconds)
+{
+  // seconds between 1900 and 1970
+  const uint64_t uiUnixEpochOffset = 2208988800ULL;
+  uint64_t uiFraction = (static_cast<uint64_t>(uiNanoseconds) << 32) / 1000000000ULL;
+  return ((uiSeconds + uiUnixEpochOffset) << 32) | (uiFraction & 0xFFFFFFFF);
+}
+
 void RtpTime::split(uint64_t uiNtp, uint32_t& uiNtpMsw, uint32_t& uiNtpLsw)
 {
   uiNtpLsw = static_cast<uint32_t>(uiNtp); //& 0xFFFFFFFF;
@@ -181,46 +176,22 @@ void RtpTime::getTimeElapsedSinceNTPEpoch(uint32_t& uiSeconds, uint32_t& uiMicro
 
 void RtpTime::getNTPTimeStamp(uint64_t& uiNtpTime)
 {
-  uint32_t uiSeconds = 0, uiMicroseconds = 0;
-  getTimeElapsedSinceNTPEpoch(uiSeconds, uiMicroseconds);
-  // now convert into the 2^32 range: 2^32/10^6 = 2^26/(10^6/2^6)
-  double dFractionalPart = (uiMicroseconds/15625.0) * 0x04000000;
-  uint64_t uiLsw = static_cast<uint64_t>(dFractionalPart + 0.5);
-  uiNtpTime = (static_cast<uint64_t>(uiSeconds) << 32) | (uiLsw);
+  uiNtpTime = convertUnixNsToNtpTimestamp(Clock::realtimeNs());
 }
 
 void RtpTime::getNTPTimeStamp(uint32_t& uiNtpMsw, uint32_t& uiNtpLsw)
 {
-  uint32_t uiSeconds = 0, uiMicroseconds = 0;
-  getTimeElapsedSinceNTPEpoch(uiSeconds, uiMicroseconds);
-  // now convert into the 2^32 range: 2^32/10^6 = 2^26/(10^6/2^6)
-  double dFractionalPart = (uiMicroseconds/15625.0) * 0x04000000;
-  uiNtpMsw = uiSeconds;
-  uiNtpLsw = static_cast<uint32_t>(dFractionalPart + 0.5);
+  split(convertUnixNsToNtpTimestamp(Clock::realtimeNs()), uiNtpMsw, uiNtpLsw);
 }
 
 uint64_t RtpTime::getNTPTimeStamp()
 {
-  uint64_t uiNtpTime = 0;
-  uint32_t uiSeconds = 0, uiMicroseconds = 0;
-  getTimeElapsedSince(boost::gregorian::date(1900,1,1), uiSeconds, uiMicroseconds);
-  // now convert into the 2^32 range: 2^32/10^6 = 2^26/(10^6/2^6)
-  double dFractionalPart = (uiMicroseconds/15625.0) * 0x04000000;
-  uint32_t uiLsw = static_cast<uint32_t>(dFractionalPart + 0.5);
-  uiNtpTime = (static_cast<uint64_t>(uiSeconds) << 32) | (uiLsw);
-  return uiNtpTime;
+  return convertUnixNsToNtpTimestamp(Clock::realtimeNs());
 }
 
 uint32_t RtpTime::getMiddle32bitsOfNTPTimeStamp()
 {
-  uint32_t uiNtpTime = 0;
-  uint32_t uiSeconds = 0, uiMicroseconds = 0;
-  getTimeElapsedSince(boost::gregorian::date(1900,1,1), uiSeconds, uiMicroseconds);
-  // now convert into the 2^32 range: 2^32/10^6 = 2^26/(10^6/2^6)
-  double dFractionalPart = (uiMicroseconds/15625.0) * 0x04000000;
-  uint32_t uiLsw = static_cast<uint32_t>(dFractionalPart + 0.5);
-  uiNtpTime = ((uiSeconds << 16)&0xFFFF0000) | ((uiLsw >> 16) & 0xFFFF);
-  return uiNtpTime;
+  return static_cast<uint32_t>((convertUnixNsToNtpTimestamp(Clock::realtimeNs()) >> 16) & 0xFFFFFFFF);
 }
 
 uint32_t RtpTime::convertDelaySinceLastSenderReportToDlsr(double dDelaySeconds)
@@ -274,4 +245,40 @@ boost::posix_time::ptime RtpTime::getPresentationTime(uint32_t uiRtpSyncRef, con
   return tPresentation;
 }
 
+uint64_t RtpTime::convertUnixNsToNtpTimestamp(int64_t iUnixNs)
+{
+  return convertUnixTimeToNtpTimestamp(static_cast<uint64_t>(iUnixNs / 1000000000LL), static_cast<uint32_t>(iUnixNs % 1000000000LL));
+}
+
+int64_t RtpTime::convertNtpTimestampToUnixNs(uint64_t uiNtp)
+{
+  const int64_t iUnixEpochOffset = 2208988800LL;
+  int64_t iSeconds = static_cast<int64_t>(uiNtp >> 32) - iUnixEpochOffset;
+  int64_t iNanoseconds = static_cast<int64_t>(((uiNtp & 0xFFFFFFFF) * 1000000000ULL + 0x80000000ULL) >> 32);
+  return iSeconds * 1000000000LL + iNanoseconds;
+}
+
+RtpTimestampConverter::RtpTimestampConverter(uint32_t uiTimestampFrequency)
+  :m_uiTimestampFrequency(uiTimestampFrequency)
+{
+  assert(uiTimestampFrequency < (1u << 28));
+}
+
+uint32_t RtpTimestampConverter::toRtpTimestamp(int64_t iTimeNs, uint32_t uiTimestampBase) const
+{
+  uint64_t uiSeconds = static_cast<uint64_t>(iTimeNs / 1000000000LL);
+  uint64_t uiNanoseconds = static_cast<uint64_t>(iTimeNs % 1000000000LL);
+  // round to the nearest tick: the product stays below 2^58 and the division
+  // by a constant is compiled to a multiplication
+  uint32_t uiTicks = static_cast<uint32_t>((uiNanoseconds * m_uiTimestampFrequency + 500000000ULL) / 1000000000ULL);
+  // RTP timestamps wrap: only the lower 32 bits of the product are needed
+  return uiTimestampBase + static_cast<uint32_t>(uiSeconds) * m_uiTimestampFrequency + uiTicks;
+}
+
+int64_t RtpTimestampConverter::toNs(int32_t iRtpTimestampDiff) const
+{
+  if (m_uiTimestampFrequency == 0) return 0;
+  return static_cast<int64_t>(iRtpTimestampDiff) * 1000000000LL / m_uiTimestampFrequency;
+}
+
 } // rtp_plus_plus
@@ -1,13 +1,10 @@
 #include "CorePch.h"
 #include <rtp++/TransmissionManager.h>
 #include <boost/asio/io_service.hpp>
-#include <boost/asio/deadline_timer.hpp>
 #include <boost/bind.hpp>
 #include <rtp++/rfc3550/RtpHeader.h>
 #include <rtp++/mprtp/MpRtpHeader.h>
 
-using boost::asio::deadline_timer;
-
 #define COMPONENT_LOG_LEVEL 10
 
 namespace rtp_plus_plus
@@ -17,11 +14,18 @@ TransmissionManager::TransmissionManager(RtpSessionState& rtpSessionState, boost
   TxBufferManagementMode eMode, uint32_t uiRtxTimeMs, uint32_t uiRecvBufferSize)
   :m_eMode(eMode),
     m_rtpSessionState(rtpSessionState),
-    m_rIoService(ioService),
     m_uiRtxTimeMs(uiRtxTimeMs),
+    m_vTxHistory(DEFAULT_HISTORY_SIZE),
+    m_uiTxMask(DEFAULT_HISTORY_SIZE - 1),
+    m_uiOldestSN(0),
+    m_uiStoredPackets(0),
+    m_uiStoredBytes(0),
+    m_uiMaxPackets(eMode == TxBufferManagementMode::CIRCULAR_MODE ? CIRCULAR_HISTORY_SIZE : DEFAULT_HISTORY_SIZE),
+    m_uiMaxAgeMs(eMode == TxBufferManagementMode::NACK_TIMED_MODE ? uiRtxTimeMs : 0),
+    m_uiMaxBytes(0),
+    m_bIsMpRtpSession(false),
     m_qRecentArrivals(uiRecvBufferSize),
-    m_uiLastReceivedExtendedSN(0),
-    m_qCircularBuffer(30) // store 30 packets in circular mode?
+    m_uiLastReceivedExtendedSN(0)
 {
   VLOG(2) << "Transmission manager: "
           << " Mode: " << ((eMode== TxBufferManagementMode::CIRCULAR_MODE) ? "circular" : ((eMode == TxBufferManagementMode::NACK_TIMED_MODE) ? "nack" : "ack"))
@@ -31,89 +35,43 @@ TransmissionManager::TransmissionManager(RtpSessionState& rtpSessionState, boost
           << " RTX Payload Type: " << (int)m_rtpSessionState.getRtxPayloadType();
 }
 
+void TransmissionManager::setHistoryLimits(uint32_t uiMaxAgeMs, uint32_t uiMaxBytes)
+{
+  VLOG(2) << "Retransmission history limits: " << uiMaxAgeMs << " ms " << uiMaxBytes << " bytes";
+  boost::mutex::scoped_lock l( m_rtxLock );
+  m_uiMaxAgeMs = uiMaxAgeMs;
+  m_uiMaxBytes = uiMaxBytes;
+}
+
+uint32_t TransmissionManager::getHistorySize() const
+{
+  boost::mutex::scoped_lock l( m_rtxLock );
+  return m_uiStoredPackets;
+}
+
 void TransmissionManager::storePacketForRetransmission(const RtpPacket& rtpPacket)
 {
   // don't store retransmission packets
   if (rtpPacket.getHeader().getPayloadType() != m_rtpSessionState.getRtxPayloadType())
   {
-    switch (m_eMode)
-    {
-      case TxBufferManagementMode::CIRCULAR_MODE:
-      {
-#if 1
-        m_qCircularBuffer.push_back(rtpPacket.getSequenceNumber());
-
-        boost::mutex::scoped_lock l( m_rtxLock );
-        insertPacketIntoTxBuffer(rtpPacket);
-
-        const int MAX_CIRCULAR = 30;
-        if (m_qCircularBuffer.size() > MAX_CIRCULAR)
-        {
-          uint16_t uiOldestSN = m_qCircularBuffer.front();
-          m_qCircularBuffer.pop_front();
-          removePacketFromTxBuffer(uiOldestSN);
-        }
-#else
-        // TODO: circular buffer that rotates out packets
-        assert(false);
-#endif
-        break;
-      }
-      case TxBufferManagementMode::NACK_TIMED_MODE:
-      {
-        VLOG(15) << "Storing and scheduling " << rtpPacket.getSequenceNumber() << " for removal in " << m_uiRtxTimeMs << "ms";
-        deadline_timer* pTimer = new deadline_timer(m_rIoService);
-        pTimer->expires_from_now(boost::posix_time::milliseconds(m_uiRtxTimeMs));
-
-        boost::mutex::scoped_lock l( m_rtxLock );
-        insertPacketIntoTxBuffer(rtpPacket);
-        m_mRtxTimers.insert(std::make_pair(pTimer, pTimer));
-
-        pTimer->async_wait(boost::bind(&TransmissionManager::onRemoveRtpPacketTimeout, this, _1, pTimer, rtpPacket.getSequenceNumber()) );
-        break;
-      }
-      case TxBufferManagementMode::ACK_MODE:
-      {
-        boost::mutex::scoped_lock l( m_rtxLock );
-        insertPacketIntoTxBuffer(rtpPacket);
-        break;
-      }
-    }
+    // the mode only determines the history limits: see constructor
+    boost::mutex::scoped_lock l( m_rtxLock );
+    insertPacketIntoTxBuffer(rtpPacket);
   }
 }
 
 void TransmissionManager::stop()
 {
-  // RTX
-  VLOG(10) << "[" << this << "] Shutting down RTX timers";
-  switch (m_eMode)
-  {
-    case TxBufferManagementMode::CIRCULAR_MODE:
-    {
-      break;
-    }
-    case TxBufferManagementMode::NACK_TIMED_MODE:
-    {
-      std::for_each(m_mRtxTimers.begin(), m_mRtxTimers.end(),
-                    [this](const std::pair<deadline_timer*, deadline_timer*>& pair)
-      {
-        pair.second->cancel();
-      });
-      break;
-    }
-    case TxBufferManagementMode::ACK_MODE:
-    {
-      break;
-    }
-  }
+  // RTX: packets are expired lazily so there are no timers to cancel
+  VLOG(10) << "[" << this << "] Stopping. Packets in RTX history: " << getHistorySize();
 }
 
 boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uint16_t uiSN)
 {
   // check if we still have the packet in our retransmission buffer
   boost::mutex::scoped_lock l( m_rtxLock );
-  auto it = m_mTxMap.find(uiSN);
-  if (it != m_mTxMap.end())
+  RtpPacketInfo* pInfo = findPacketInTxBuffer(uiSN);
+  if (pInfo)
   {
     // we still have the packet in our retransmission buffer
     auto it2 = m_mSnMap.left.find(uiSN);
@@ -121,7 +79,7 @@ boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uin
     {
       // RTP
       VLOG(6) << "Sending RTX for SN " << uiSN;
-      RtpPacket rtxRtpPacket = generateRtxPacketSsrcMultiplexing(it->second.originalRtpPacket);
+      RtpPacket rtxRtpPacket = generateRtxPacketSsrcMultiplexing(pInfo->originalRtpPacket);
       return boost::optional<RtpPacket>(rtxRtpPacket);
     }
     else
@@ -131,7 +89,7 @@ boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uin
       uint16_t uiFSSN = uiFlowFssn & 0xFF;
       uint16_t uiFlowId = uiFlowFssn >> 16;
       VLOG(2) << "Sending RTX for SN: " << uiSN << " Flow Id: " << uiFlowId << " FSSN " << uiFSSN;
-      RtpPacket rtxRtpPacket = generateRtxPacketSsrcMultiplexing(it->second.originalRtpPacket, uiFlowId, uiFSSN);
+      RtpPacket rtxRtpPacket = generateRtxPacketSsrcMultiplexing(pInfo->originalRtpPacket, uiFlowId, uiFSSN);
       return boost::optional<RtpPacket>(rtxRtpPacket);
     }
   }
@@ -142,12 +100,9 @@ boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uin
   }
 }
 
-TransmissionManager::RtpPacketInfo* TransmissionManager::lookupRtpPacketInfo(uint16_t uiSN)\
+TransmissionManager::RtpPacketInfo* TransmissionManager::lookupRtpPacketInfo(uint16_t uiSN)
 {
-  auto it = m_mTxMap.find(uiSN);
-  if (it == m_mTxMap.end()) return nullptr;
-  else
-    return &(it->second);
+  return findPacketInTxBuffer(uiSN);
 }
 
 boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uint16_t uiFlowId, uint16_t uiFSSN)
@@ -157,9 +112,10 @@ boost::optional<RtpPacket> TransmissionManager::generateRetransmissionPacket(uin
   // check if we still have the packet in our retransmission buffer
   boost::mutex::scoped_lock l( m_rtxLock );
   auto it = m_mSnMap.right.find(uiFlowIdFssn);
-  if (it != m_mSnMap.right.end())
+  RtpPacketInfo* pInfo = (it != m_mSnMap.right.end()) ? findPacketInTxBuffer(it->second) : nullptr;
+  if (pInfo)
   {
-    RtpPacket& rtpPacket = m_mTxMap.at(it->second).originalRtpPacket;
+    RtpPacket& rtpPacket = pInfo->originalRtpPacket;
     // we still have the packet in our retransmission buffer
 #if 0
     VLOG(2) << "Sending RTX for SN: " << it->second << " Flow Id: " << uiFlowId << " FSSN " << uiFSSN;
@@ -190,43 +146,107 @@ bool TransmissionManager::lookupSequenceNumber(uint16_t& uiSN, uint16_t uiFlowId
   }
 }
 
-void TransmissionManager::onRemoveRtpPacketTimeout(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, uint16_t uiSN)
+void TransmissionManager::insertPacketIntoTxBuffer(const RtpPacket& rtpPacket)
 {
-  assert(m_eMode == TxBufferManagementMode::NACK_TIMED_MODE);
-  VLOG(15) << "Removing " << uiSN << " from rtx";
-  // remove timer from map
+  const uint16_t uiSN = rtpPacket.getSequenceNumber();
+  VLOG(COMPONENT_LOG_LEVEL) << "Inserting packet SN " << uiSN << " into TX buffer";
+  boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+
+  if (m_uiStoredPackets > 0)
   {
-    boost::mutex::scoped_lock l( m_rtxLock );
-    std::size_t uiErased = m_mRtxTimers.erase(pTimer);
-    assert(uiErased == 1);
-    removePacketFromTxBuffer(uiSN);
+    // packets are stored in SN order: an older packet would not fit into the ring window
+    if (static_cast<int16_t>(uiSN - m_uiOldestSN) < 0)
+    {
+      VLOG(COMPONENT_LOG_LEVEL) << "Not storing SN " << uiSN << ": older than " << m_uiOldestSN;
+      return;
+    }
+    // make room: the ring holds the SNs [m_uiOldestSN, m_uiOldestSN + ring size)
+    while (m_uiStoredPackets > 0 && static_cast<uint16_t>(uiSN - m_uiOldestSN) >= m_vTxHistory.size())
+    {
+      skipToOldestStoredPacket();
+      removePacketFromTxBuffer(m_uiOldestSN);
+      ++m_uiOldestSN;
+    }
+  }
+  if (m_uiStoredPackets == 0)
+  {
+    m_uiOldestSN = uiSN;
   }
-  delete pTimer;
-}
 
-void TransmissionManager::insertPacketIntoTxBuffer(const RtpPacket& rtpPacket)
-{
-  VLOG(COMPONENT_LOG_LEVEL) << "Inserting packet SN " << rtpPacket.getSequenceNumber() << " into TX buffer";
-  RtpPacketInfo entry(rtpPacket);
-  m_mTxMap.insert(std::make_pair(rtpPacket.getSequenceNumber(), entry ));
+  // the packet is stored again e.g. when it is resent
+  removePacketFromTxBuffer(uiSN);
+
+  TxSlot& slot = getTxSlot(uiSN);
+  slot.bStored = true;
+  slot.info.assign(rtpPacket, tNow);
+  ++m_uiStoredPackets;
+  m_uiStoredBytes += slot.info.rtpPacketSize;
+
   boost::optional<mprtp::MpRtpSubflowRtpHeader> pSubflowHeader = rtpPacket.getMpRtpSubflowHeader();
   if (pSubflowHeader)
   {
+    m_bIsMpRtpSession = true;
     uint32_t uiFlowIdFssn = (pSubflowHeader->getFlowId() << 16) | pSubflowHeader->getFlowSpecificSequenceNumber();
-    m_mSnMap.insert(sn_mapping(rtpPacket.getSequenceNumber(), uiFlowIdFssn));
+    m_mSnMap.insert(sn_mapping(uiSN, uiFlowIdFssn));
   }
+
+  expirePacketsFromTxBuffer(tNow);
 }
 
 void TransmissionManager::removePacketFromTxBuffer(uint16_t uiSN)
 {
+  if (!isStored(uiSN)) return;
   VLOG(COMPONENT_LOG_LEVEL) << "Removing packet SN " << uiSN << " from TX buffer";
-  m_mTxMap.erase(uiSN);
+  TxSlot& slot = getTxSlot(uiSN);
+  slot.bStored = false;
+  // release the payload: the slot itself is reused
+  slot.info.originalRtpPacket.setPayload(Buffer());
+  --m_uiStoredPackets;
+  m_uiStoredBytes -= slot.info.rtpPacketSize;
   if (m_bIsMpRtpSession)
   {
     m_mSnMap.left.erase(uiSN);
   }
 }
 
+void TransmissionManager::skipToOldestStoredPacket()
+{
+  assert(m_uiStoredPackets > 0);
+  // SNs that were not stored or have been removed leave gaps
+  while (!isStored(m_uiOldestSN))
+  {
+    ++m_uiOldestSN;
+  }
+}
+
+void TransmissionManager::expirePacketsFromTxBuffer(const boost::posix_time::ptime& tNow)
+{
+  while (m_uiStoredPackets > 0)
+  {
+    skipToOldestStoredPacket();
+    const RtpPacketInfo& oldest = getTxSlot(m_uiOldestSN).info;
+    bool bExpired = (m_uiStoredPackets > m_uiMaxPackets) ||
+        (m_uiMaxBytes != 0 && m_uiStoredBytes > m_uiMaxBytes) ||
+        (m_uiMaxAgeMs != 0 && (tNow - oldest.tStored).total_milliseconds() > m_uiMaxAgeMs);
+    if (!bExpired) break;
+    removePacketFromTxBuffer(m_uiOldestSN);
+    ++m_uiOldestSN;
+  }
+}
+
+TransmissionManager::RtpPacketInfo* TransmissionManager::findPacketInTxBuffer(uint16_t uiSN)
+{
+  if (!isStored(uiSN)) return nullptr;
+  RtpPacketInfo& info = getTxSlot(uiSN).info;
+  if (m_uiMaxAgeMs != 0)
+  {
+    // expiry is lazy: the packet may still be stored
+    boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+    if ((tNow - info.tStored).total_milliseconds() > m_uiMaxAgeMs) return nullptr;
+  }
+  return &info;
+}
+
 RtpPacket TransmissionManager::generateRtxPacket(const RtpPacket& rtpPacket)
 {
   // copy original RTP header
@@ -255,19 +275,19 @@ RtpPacket TransmissionManager::generateRtxPacketSsrcMultiplexing(const RtpPacket
 
   // use original SN as first 2 bytes of payload
   Buffer newPayload;
-  uint32_t uiNewSize = rtpPacket.getPayload().getSize() + 2;
+  const Buffer payload = rtpPacket.getContiguousPayload();
+  uint32_t uiNewSize = payload.getSize() + 2;
   uint8_t* pNewPayload = new uint8_t[uiNewSize];
   newPayload.setData(pNewPayload, uiNewSize);
   OBitStream out(newPayload);
   out.write(uiOriginalSequenceNumber, 16);
-  const uint8_t* pData = rtpPacket.getPayload().data();
-  bool bRes = out.writeBytes(pData, rtpPacket.getPayload().getSize());
+  bool bRes = out.writeBytes(payload.data(), payload.getSize());
   assert(bRes);
   packet.setPayload(newPayload);
 
   VLOG(5) << "Generated RTX packet for SN " << rtpPacket.getSequenceNumber()
           << " SSRC :" << rtpPacket.getSSRC()
-          << " old payload size: " << rtpPacket.getPayload().getSize()
+          << " old payload size: " << payload.getSize()
           << " RTX SN: " << packet.getSequenceNumber()
           << " RTX SSRC: " << packet.getSSRC()
           << " new payload size: " << packet.getPayloadSize();
@@ -286,15 +306,15 @@ RtpPacket TransmissionManager::generateRtxPacketSsrcMultiplexing(const RtpPacket
 
   // use original SN as first 2 bytes of payload
   Buffer newPayload;
-  uint32_t uiNewSize = rtpPacket.getPayload().getSize() + 6;
+  const Buffer payload = rtpPacket.getContiguousPayload();
+  uint32_t uiNewSize = payload.getSize() + 6;
   uint8_t* pNewPayload = new uint8_t[uiNewSize];
   newPayload.setData(pNewPayload, uiNewSize);
   OBitStream out(newPayload);
   out.write(uiOriginalSequenceNumber, 16);
   out.write(uiFlowId, 16);
   out.write(uiFSSN, 16);
-  const uint8_t* pData = rtpPacket.getPayload().data();
-  bool bRes = out.writeBytes(pData, rtpPacket.getPayload().getSize());
+  bool bRes = out.writeBytes(payload.data(), payload.getSize());
   assert(bRes);
   packet.setPayload(newPayload);
 
@@ -414,26 +434,27 @@ void TransmissionManager::ack(const std::vector<uint16_t>& acks)
   std::vector<uint16_t> newlyAcked;
   boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
   std::ostringstream ostr;
+  boost::mutex::scoped_lock l( m_rtxLock );
   for (auto ack : acks)
   {
-    auto it = m_mTxMap.find(ack);
+    RtpPacketInfo* pInfo = findPacketInTxBuffer(ack);
     // update time
-    if (it != m_mTxMap.end())
+    if (pInfo)
     {
       // only update newly acked
-      if (it->second.tAcked.is_not_a_date_time())
+      if (pInfo->tAcked.is_not_a_date_time())
       {
-        it->second.tAcked = tNow;
+        pInfo->tAcked = tNow;
         newlyAcked.push_back(ack);
       }
       // remove
       int32_t iAckMs = -1;
-      if (!it->second.tAcked.is_not_a_date_time())
+      if (!pInfo->tAcked.is_not_a_date_time())
       {
-        iAckMs = (it->second.tAcked - it->second.tStored).total_milliseconds();
+        iAckMs = (pInfo->tAcked - pInfo->tStored).total_milliseconds();
       }
 
-      ostr << it->second.originalRtpPacket.getSequenceNumber()
+      ostr << pInfo->originalRtpPacket.getSequenceNumber()
            << " (" << iAckMs << " ms) ";
       // we don't want to delete the meta info: we could just delete the payload?
 #if 0
@@ -443,6 +464,7 @@ void TransmissionManager::ack(const std::vector<uint16_t>& acks)
 #endif
     }
   }
+  l.unlock();
   VLOG(2) << "Ack times: " << ostr.str();
 
   if (m_onAck) m_onAck(newlyAcked);
@@ -451,11 +473,14 @@ void TransmissionManager::ack(const std::vector<uint16_t>& acks)
 void TransmissionManager::nack(const std::vector<uint16_t>& nacks)
 {
   boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
-  for (auto nack : nacks)
   {
-    auto it = m_mTxMap.find(nack);
-    if (it != m_mTxMap.end())
-      it->second.tNacked = tNow;
+    boost::mutex::scoped_lock l( m_rtxLock );
+    for (auto nack : nacks)
+    {
+      RtpPacketInfo* pInfo = findPacketInTxBuffer(nack);
+      if (pInfo)
+        pInfo->tNacked = tNow;
+    }
   }
 
   if (m_onNack) m_onNack(nacks);
@@ -483,4 +508,17 @@ TransmissionManager::RtpPacketInfo::~RtpPacketInfo()
 {
 }
 
+void TransmissionManager::RtpPacketInfo::assign(const RtpPacket& rtpPacket, const boost::posix_time::ptime& tNow)
+{
+  // assigning into the existing packet reuses its storage
+  originalRtpPacket = rtpPacket;
+  rtpPacketSize = rtpPacket.getSize();
+  rtpPayloadSize = rtpPacket.getPayloadSize();
+  tStored = tNow;
+  tAcked = boost::posix_time::not_a_date_time;
+  tNacked = boost::posix_time::not_a_date_time;
+  tReceived = boost::posix_time::not_a_date_time;
+  bProcessedByScheduler = false;
+}
+
 } // rtp_plus_plus
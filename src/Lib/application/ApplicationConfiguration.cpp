@@ -50,7 +50,7 @@ ApplicationConfiguration::ApplicationConfiguration()
   m_receiverOptions.add_options()
       (ApplicationParameters::aout.c_str(), po::value<std::string>(&Receiver.AudioFilename)->default_value("audio-"), "Audio Output [file|cout]")
       (ApplicationParameters::vout.c_str(), po::value<std::string>(&Receiver.VideoFilename)->default_value("video-"), "Video Output [file|cout]")
-      (ApplicationParameters::jitter_buffer_type.c_str(), po::value<uint32_t>(&Receiver.JitterBufferType)->default_value(2), "RTP jitter buffer type (0=std, 1=pts, 2=v2)")
+      (ApplicationParameters::jitter_buffer_type.c_str(), po::value<uint32_t>(&Receiver.JitterBufferType)->default_value(2), "RTP jitter buffer type (0=std, 1=pts, 2=v2, 3=ring)")
       (ApplicationParameters::buf_lat.c_str(), po::value<uint32_t>(&Receiver.BufferLatency)->default_value(100), "RTP playout buffer latency")
       (ApplicationParameters::pred.c_str(), po::value<std::string>(&Receiver.Predictor), "Predictor to be used in RTO [mavg|ar2]")
       (ApplicationParameters::mp_pred.c_str(), po::value<std::string>(&Receiver.MpPredictor), "Predictor to be used in MPRTP [mp-single|mp-cross|mp-comp]")
@@ -100,6 +100,8 @@ ApplicationConfiguration::ApplicationConfiguration()
       (ApplicationParameters::rtcp_rs.c_str(), po::bool_switch(&RtpRtcp.RtcpRs)->default_value(false), "RTCP reduced size")
       (ApplicationParameters::rtcp_rtp_header_ext.c_str(), po::bool_switch(&RtpRtcp.RtcpRtpHeaderExt)->default_value(false), "RTCP RTP header ext")
       (ApplicationParameters::rtx_time.c_str(), po::value<uint32_t>(&RtpRtcp.RtxTime)->default_value(0), "rtx-time (ms)")
+      (ApplicationParameters::rtx_history_bytes.c_str(), po::value<uint32_t>(&RtpRtcp.RtxHistoryBytes)->default_value(0), "Size limit of the RTX history in bytes (0 = unlimited)")
+      (ApplicationParameters::max_reported_senders.c_str(), po::value<uint32_t>(&RtpRtcp.MaxReportedSenders)->default_value(0), "Maximum number of senders reported on per RTCP interval (0 = all)")
       (ApplicationParameters::enable_mprtp.c_str(), po::bool_switch(&RtpRtcp.EnableMpRtp)->default_value(false), "Enable MPRTP support")
       (ApplicationParameters::rtcp_mux.c_str(), po::bool_switch(&RtpRtcp.RtcpMux)->default_value(false), "Enable RTCP-mux support")
       (ApplicationParameters::rapid_sync_mode.c_str(), po::value<uint32_t>(&RtpRtcp.RapidSyncMode)->default_value(0), "Rapid Sync Mode (0 = none, 1 = all")
@@ -114,6 +116,8 @@ ApplicationConfiguration::ApplicationConfiguration()
       (ApplicationParameters::force_rtp_ssrc.c_str(), po::bool_switch(&RtpRtcp.ForceRtpSsrc)->default_value(false), "Force RTP SSRC")
       (ApplicationParameters::rtp_ssrc.c_str(), po::value<uint32_t>(&RtpRtcp.RtpSsrc), "RTP SSRC")
       (ApplicationParameters::rtp_summarise_stats.c_str(), po::bool_switch(&RtpRtcp.SummariseStats)->default_value(false), "Summarise RTP session stats")
+      (ApplicationParameters::zero_copy_packetisation.c_str(), po::bool_switch(&RtpRtcp.ZeroCopyPacketisation)->default_value(false), "Reference H.264 and H.265 media samples from RTP packets instead of copying them")
+      (ApplicationParameters::deliver_incomplete_nal_units.c_str(), po::bool_switch(&RtpRtcp.DeliverIncompleteNalUnits)->default_value(false), "Deliver H.264 NAL units with missing fragments for error concealment")
       ;
   const std::string LocalInterfacesDescrip("Local network interfaces to be used by the client. "\
     "If this parameter is set to 0.0.0.0, the client will attempt to auto-detect the IP addresses. "\
@@ -128,6 +132,12 @@ ApplicationConfiguration::ApplicationConfiguration()
     (ApplicationParameters::remote_host.c_str(), po::value<std::string>(&Network.RemoteHost)->default_value(""), "Remote host")
     (ApplicationParameters::fqdn.c_str(), po::value<std::string>(&Network.FQDN)->default_value(""), "SIP FQDN (optional) used in \"Contact\"")
     (ApplicationParameters::domain.c_str(), po::value<std::string>(&Network.Domain), "SIP Domain (optional) used in generated Call-ID")
+    (ApplicationParameters::recv_batch.c_str(), po::value<uint32_t>(&Network.RecvBatch)->default_value(0), "Max UDP datagrams read per receive (linux recvmmsg). 0 = disabled")
+    (ApplicationParameters::send_batch.c_str(), po::value<uint32_t>(&Network.SendBatch)->default_value(0), "Max RTP datagrams written per send (linux sendmmsg). 0 = disabled")
+    (ApplicationParameters::udp_gso.c_str(), po::bool_switch(&Network.UdpGso)->default_value(false), "Use UDP segmentation offload for batched sends (requires send-batch)")
+    (ApplicationParameters::io_backend.c_str(), po::value<std::string>(&Network.IoBackend)->default_value("asio"), "I/O backend for UDP RTP/RTCP [asio|io_uring]. io_uring requires linux 6.0+ and liburing")
+    (ApplicationParameters::kernel_timestamps.c_str(), po::bool_switch(&Network.KernelTimestamps)->default_value(false), "Take UDP arrival times from kernel receive timestamps (linux SO_TIMESTAMPNS)")
+    (ApplicationParameters::reuse_port.c_str(), po::bool_switch(&Network.ReusePort)->default_value(false), "Bind multiplexed RTP/RTCP ports with SO_REUSEPORT so that one session per receive thread can share the port (linux 3.9+)")
     ;
 
   m_multipathOptions.add_options()
@@ -371,12 +381,20 @@ GenericParameters ApplicationConfiguration::getGenericParameters()
         }
         if (RtpRtcp.DisableStap)
           applicationParameters.setBoolParameter(ApplicationParameters::disable_stap, RtpRtcp.DisableStap);
+        if (RtpRtcp.ZeroCopyPacketisation)
+          applicationParameters.setBoolParameter(ApplicationParameters::zero_copy_packetisation, RtpRtcp.ZeroCopyPacketisation);
+        if (RtpRtcp.DeliverIncompleteNalUnits)
+          applicationParameters.setBoolParameter(ApplicationParameters::deliver_incomplete_nal_units, RtpRtcp.DeliverIncompleteNalUnits);
         if (RtpRtcp.RapidSyncMode > 0)
           applicationParameters.setUintParameter(ApplicationParameters::rapid_sync_mode, RtpRtcp.RapidSyncMode);
         if (RtpRtcp.ExtractNtp)
           applicationParameters.setBoolParameter(ApplicationParameters::extract_ntp_ts, RtpRtcp.ExtractNtp);
         if (RtpRtcp.SummariseStats)
           applicationParameters.setBoolParameter(ApplicationParameters::rtp_summarise_stats, RtpRtcp.SummariseStats);
+        if (RtpRtcp.RtxHistoryBytes > 0)
+          applicationParameters.setUintParameter(ApplicationParameters::rtx_history_bytes, RtpRtcp.RtxHistoryBytes);
+        if (RtpRtcp.MaxReportedSenders > 0)
+          applicationParameters.setUintParameter(ApplicationParameters::max_reported_senders, RtpRtcp.MaxReportedSenders);
 
         break;
       }
@@ -387,6 +405,18 @@ GenericParameters ApplicationConfiguration::getGenericParameters()
           applicationParameters.setStringParameter(ApplicationParameters::fqdn, Network.FQDN);
         if (!Network.Domain.empty())
           applicationParameters.setStringParameter(ApplicationParameters::domain, Network.Domain);
+        if (Network.RecvBatch > 1)
+          applicationParameters.setUintParameter(ApplicationParameters::recv_batch, Network.RecvBatch);
+        if (Network.SendBatch > 1)
+          applicationParameters.setUintParameter(ApplicationParameters::send_batch, Network.SendBatch);
+        if (Network.UdpGso)
+          applicationParameters.setBoolParameter(ApplicationParameters::udp_gso, Network.UdpGso);
+        if (!Network.IoBackend.empty())
+          applicationParameters.setStringParameter(ApplicationParameters::io_backend, Network.IoBackend);
+        if (Network.KernelTimestamps)
+          applicationParameters.setBoolParameter(ApplicationParameters::kernel_timestamps, Network.KernelTimestamps);
+        if (Network.ReusePort)
+          applicationParameters.setBoolParameter(ApplicationParameters::reuse_port, Network.ReusePort);
         break;
       }
       case MULTIPATH:
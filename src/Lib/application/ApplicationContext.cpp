@@ -1,5 +1,6 @@
 #include "CorePch.h"
 #include <rtp++/application/ApplicationContext.h>
+#include <rtp++/util/BufferPool.h>
 
 #ifdef ENABLE_SCTP_USERLAND
 #include <stdarg.h>
@@ -86,6 +87,10 @@ bool ApplicationContext::cleanupApplication()
 
   // call any code here that needs to be called on application termination
   cleanupUserlandSctp();
+
+  VLOG(2) << "Buffer pool MTU: " << BufferPool::getStatistics(BufferPool::SC_MTU);
+  VLOG(2) << "Buffer pool jumbo: " << BufferPool::getStatistics(BufferPool::SC_JUMBO);
+  VLOG(2) << "Buffer pool frame: " << BufferPool::getStatistics(BufferPool::SC_FRAME);
   return true;
 }
 
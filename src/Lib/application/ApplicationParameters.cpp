@@ -66,6 +66,8 @@ const std::string ApplicationParameters::mavg_hist = "mavg-hist";
 const std::string ApplicationParameters::pto = "pto";
 const std::string ApplicationParameters::t_rr_interval = "T_rr_interval";
 const std::string ApplicationParameters::disable_stap = "disable-stap";
+const std::string ApplicationParameters::zero_copy_packetisation = "zero-copy-packetisation";
+const std::string ApplicationParameters::deliver_incomplete_nal_units = "deliver-incomplete-nal-units";
 const std::string ApplicationParameters::rapid_sync_mode = "rapid-sync-mode";
 const std::string ApplicationParameters::scheduler = "scheduler";
 const std::string ApplicationParameters::scheduler_param = "scheduler-param";
@@ -99,6 +101,12 @@ const std::string ApplicationParameters::register_with_proxy = "register-with-pr
 const std::string ApplicationParameters::sip_callee = "sip-callee";
 const std::string ApplicationParameters::domain = "domain";
 const std::string ApplicationParameters::public_ip = "public-ip";
+const std::string ApplicationParameters::recv_batch = "recv-batch";
+const std::string ApplicationParameters::send_batch = "send-batch";
+const std::string ApplicationParameters::udp_gso = "udp-gso";
+const std::string ApplicationParameters::io_backend = "io-backend";
+const std::string ApplicationParameters::kernel_timestamps = "kernel-timestamps";
+const std::string ApplicationParameters::reuse_port = "reuse-port";
 // parameter values
 const uint32_t ApplicationParameters::defaultMtu = 1500;
 const std::string ApplicationParameters::mavg = "mavg";
@@ -120,6 +128,8 @@ const std::string ApplicationParameters::rtcp_fb = "rtcp-fb";
 const std::string ApplicationParameters::rtcp_xr = "rtcp-xr";
 const std::string ApplicationParameters::rtcp_rs = "rtcp-rs";
 const std::string ApplicationParameters::rtx_time = "rtx-time";
+const std::string ApplicationParameters::rtx_history_bytes = "rtx-history-bytes";
+const std::string ApplicationParameters::max_reported_senders = "max-reported-senders";
 
 const std::string ApplicationParameters::no_audio = "no-audio";
 const std::string ApplicationParameters::audio_media_type = "audio-media-type";
@@ -29,11 +29,10 @@ boost::optional<rfc5285::HeaderExtensionElement> RtcpHeaderExtension::create(uin
   return boost::optional<rfc5285::HeaderExtensionElement>(ext);
 }
 
-CompoundRtcpPacket RtcpHeaderExtension::parse(const rfc5285::HeaderExtensionElement& headerExtension, RtpPacketiser& rtpPacketiser)
+CompoundRtcpPacket RtcpHeaderExtension::parse(const rfc5285::HeaderExtensionElementView& headerExtension, RtpPacketiser& rtpPacketiser)
 {
   uint32_t uiLen = headerExtension.getDataLength();
   VLOG(COMPONENT_LOG_LEVEL) << "Parsing extension of length " << uiLen;
-  uint8_t* pData = const_cast<uint8_t*>(headerExtension.getExtensionData());
   // make a copy for Buffer to manage
   uint8_t* pCopy = new uint8_t[uiLen];
   memcpy(pCopy, headerExtension.getExtensionData(), uiLen);
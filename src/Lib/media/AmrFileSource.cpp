@@ -0,0 +1,143 @@
+#include "CorePch.h"
+#include <rtp++/media/AmrFileSource.h>
+
+namespace rtp_plus_plus
+{
+namespace media
+{
+
+namespace
+{
+
+const char AMR_MAGIC[] = "#!AMR\n";
+const char AMR_WB_MAGIC[] = "#!AMR-WB\n";
+
+const uint32_t FT_INVALID = 0xFFFF;
+// speech data bytes following the frame header per frame type
+const uint32_t FRAME_SIZES[16] =
+{
+  12, 13, 15, 17,
+  19, 20, 26, 31,
+  5, FT_INVALID, FT_INVALID, FT_INVALID,
+  FT_INVALID, FT_INVALID, FT_INVALID, 0
+};
+const uint32_t FRAME_SIZES_WIDEBAND[16] =
+{
+  17, 23, 32, 36,
+  40, 46, 50, 58,
+  60, 5, FT_INVALID, FT_INVALID,
+  FT_INVALID, FT_INVALID, 0, 0
+};
+
+} // anon
+
+AmrFileSource::AmrFileSource(const std::string& sFilename, bool bLoopSource, uint32_t uiLoopCount)
+  :m_pFile(MappedFile::map(sFilename)),
+    m_bWideband(false),
+    m_bEos(false),
+    m_bLoopSource(bLoopSource),
+    m_uiLoopCount(uiLoopCount),
+    m_uiCurrentLoop(0),
+    m_uiCurrentFrame(0)
+{
+  parseFile();
+}
+
+AmrFileSource::AmrFileSource(std::istream& in1, bool bLoopSource, uint32_t uiLoopCount)
+  :m_pFile(MappedFile::read(in1)),
+    m_bWideband(false),
+    m_bEos(false),
+    m_bLoopSource(bLoopSource),
+    m_uiLoopCount(uiLoopCount),
+    m_uiCurrentLoop(0),
+    m_uiCurrentFrame(0)
+{
+  parseFile();
+}
+
+bool AmrFileSource::isGood() const
+{
+  if (m_bEos) return false;
+  return true;
+}
+
+boost::optional<MediaSample> AmrFileSource::getNextMediaSample()
+{
+  if (m_bEos) return boost::optional<MediaSample>();
+
+  MediaSample mediaSample;
+  mediaSample.setData(m_pFile->getBuffer(m_vFrameOffsets[m_uiCurrentFrame], m_vFrameSizes[m_uiCurrentFrame]));
+  ++m_uiCurrentFrame;
+  if (m_uiCurrentFrame == m_vFrameOffsets.size())
+  {
+    if (m_bLoopSource && (m_uiLoopCount == 0 || m_uiCurrentLoop < m_uiLoopCount))
+    {
+      m_uiCurrentFrame = 0;
+      ++m_uiCurrentLoop;
+    }
+    else
+    {
+      m_bEos = true;
+    }
+  }
+  return boost::optional<MediaSample>(mediaSample);
+}
+
+std::vector<MediaSample> AmrFileSource::getNextAccessUnit()
+{
+  std::vector<MediaSample> vFrame;
+  boost::optional<MediaSample> pMediaSample = getNextMediaSample();
+  if (pMediaSample)
+    vFrame.push_back(*pMediaSample);
+  return vFrame;
+}
+
+void AmrFileSource::parseFile()
+{
+  if (!m_pFile)
+  {
+    m_bEos = true;
+    return;
+  }
+
+  const uint8_t* pData = m_pFile->data();
+  const uint64_t uiSize = m_pFile->getSize();
+  uint64_t uiPos = 0;
+  if (uiSize >= sizeof(AMR_WB_MAGIC) - 1 && memcmp(pData, AMR_WB_MAGIC, sizeof(AMR_WB_MAGIC) - 1) == 0)
+  {
+    m_bWideband = true;
+    uiPos = sizeof(AMR_WB_MAGIC) - 1;
+  }
+  else if (uiSize >= sizeof(AMR_MAGIC) - 1 && memcmp(pData, AMR_MAGIC, sizeof(AMR_MAGIC) - 1) == 0)
+  {
+    uiPos = sizeof(AMR_MAGIC) - 1;
+  }
+  else
+  {
+    LOG(WARNING) << "Unsupported AMR file: only the single channel storage format is supported";
+    m_bEos = true;
+    return;
+  }
+
+  const uint32_t* pFrameSizes = m_bWideband ? FRAME_SIZES_WIDEBAND : FRAME_SIZES;
+  while (uiPos < uiSize)
+  {
+    uint8_t uiFrameHeader = pData[uiPos];
+    uint32_t uiFrameSize = pFrameSizes[(uiFrameHeader & 0x78) >> 3];
+    if (uiFrameSize == FT_INVALID || uiPos + 1 + uiFrameSize > uiSize)
+    {
+      LOG(WARNING) << "Invalid AMR frame header " << (int)uiFrameHeader << " at offset " << uiPos;
+      break;
+    }
+    m_vFrameOffsets.push_back(uiPos);
+    m_vFrameSizes.push_back(uiFrameSize + 1);
+    uiPos += uiFrameSize + 1;
+  }
+
+  VLOG(2) << "AMR" << (m_bWideband ? "-WB" : "") << " file frames: " << m_vFrameOffsets.size();
+  if (m_vFrameOffsets.empty())
+    m_bEos = true;
+}
+
+} // media
+} // rtp_plus_plus
@@ -1,24 +1,27 @@
 #include "CorePch.h"
 #include <rtp++/media/BufferedMediaReader.h>
 
+#include <algorithm>
 #include <cassert>
 #include <istream>
 #include <memory>
 
 #include <rtp++/media/MediaStreamParser.h>
+#include <rtp++/util/BufferPool.h>
 
 namespace rtp_plus_plus
 {
 namespace media
 {
 
-const uint32_t BufferedMediaReader::DEFAULT_READ_SIZE = 1024;
+const uint32_t BufferedMediaReader::DEFAULT_READ_SIZE = 64 * 1024;
 
 BufferedMediaReader::BufferedMediaReader(std::istream& source, uint32_t uiInitialBufferSize,
                                          uint32_t uiReadSize)
   :m_in(source),
-    m_buffer(new uint8_t[uiInitialBufferSize], uiInitialBufferSize),
+    m_buffer(BufferPool::allocate(uiInitialBufferSize)),
     m_uiReadSize(uiReadSize),
+    m_uiReadPos(0),
     m_uiCurrentPos(0),
     m_bNeedMoreData(true),
     m_bEof(false)
@@ -32,8 +35,9 @@ BufferedMediaReader::BufferedMediaReader(std::istream& source,
                                          uint32_t uiReadSize)
   :m_in(source),
     m_pMediaStreamParser(std::move(pMediaStreamParser)),
-    m_buffer(new uint8_t[uiInitialBufferSize], uiInitialBufferSize),
+    m_buffer(BufferPool::allocate(uiInitialBufferSize)),
     m_uiReadSize(uiReadSize),
+    m_uiReadPos(0),
     m_uiCurrentPos(0),
     m_bNeedMoreData(true),
     m_bEof(false)
@@ -63,14 +67,12 @@ boost::optional<MediaSample> BufferedMediaReader::readAndExtractMedia()
   {
     readMoreDataIfNecessary();
     int32_t iSize = 0;
-    // NOTE: iSize determines whether any bytes were consumed and should be moved up
-    pMediaSample = m_pMediaStreamParser->extract(m_buffer.data(), m_uiCurrentPos, iSize, false);
+    // NOTE: iSize determines whether any bytes were consumed
+    pMediaSample = m_pMediaStreamParser->extract(m_buffer.data() + m_uiReadPos, m_uiCurrentPos - m_uiReadPos, iSize, false);
     if (iSize > 0)
     {
-      // copy remaining data to front of buffer
-      memmove(&m_buffer[0], &m_buffer[iSize], m_uiCurrentPos - iSize);
-      // update pointer for new reads
-      m_uiCurrentPos = m_uiCurrentPos - iSize;
+      // the consumed data is only discarded once more data has to be read
+      m_uiReadPos += iSize;
     }
     else
     {
@@ -85,13 +87,21 @@ void BufferedMediaReader::readMoreDataIfNecessary()
 {
   if (m_bNeedMoreData)
   {
+    // copy remaining data to front of buffer
+    if (m_uiReadPos > 0)
+    {
+      memmove(&m_buffer[0], &m_buffer[m_uiReadPos], m_uiCurrentPos - m_uiReadPos);
+      m_uiCurrentPos -= m_uiReadPos;
+      m_uiReadPos = 0;
+    }
+
     // check if there's enough space in the buffer for the read, else resize it
     if (m_buffer.getSize() - m_uiCurrentPos < m_uiReadSize )
     {
-      uint32_t uiBufferSize = m_buffer.getSize() * 2;
-      uint8_t* pNewBuffer = new uint8_t[uiBufferSize];
-      memcpy((char*)pNewBuffer, (char*)m_buffer.data(), m_uiCurrentPos);
-      m_buffer.setData(pNewBuffer, uiBufferSize);
+      uint32_t uiBufferSize = std::max(m_buffer.getSize() * 2, m_uiCurrentPos + m_uiReadSize);
+      Buffer newBuffer = BufferPool::allocate(uiBufferSize);
+      memcpy((char*)newBuffer.data(), (char*)m_buffer.data(), m_uiCurrentPos);
+      m_buffer = newBuffer;
     }
 
     m_in.read((char*) m_buffer.data() + m_uiCurrentPos, m_uiReadSize);
@@ -1,65 +1,163 @@
 #include "CorePch.h"
-#include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <boost/filesystem.hpp>
 #include <rtp++/media/NalUnitMediaSource.h>
+#include <rtp++/media/StartCodeScanner.h>
 #include <rtp++/media/h264/H264NalUnitTypes.h>
 #include <rtp++/media/h265/H265NalUnitTypes.h>
 #include <rtp++/rfc6184/Rfc6184.h>
 #include <rtp++/rfc6190/Rfc6190.h>
 #include <rtp++/rfchevc/Rfchevc.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
 
 
 namespace rtp_plus_plus
 {
 namespace media
 {
-const size_t READ_SIZE=20000u;
+
+namespace
+{
+
+const char INDEX_MAGIC[8] = { 'R', 'T', 'P', 'N', 'A', 'L', 'I', 'X' };
+const uint32_t INDEX_VERSION = 2;
+// magic, version, media type, file size, modification time, file id, NAL unit count, AU count
+const size_t INDEX_HEADER_SIZE = 8 + 4 + 4 + 8 + 8 + 8 + 8 + 8;
+// start code index, start code length, NAL unit length
+const size_t INDEX_NAL_UNIT_SIZE = 8 + 1 + 4;
+// first NAL unit, NAL unit count
+const size_t INDEX_AU_SIZE = 4 + 4;
+
+// the index is stored in little endian byte order
+void writeLe(std::vector<uint8_t>& vOut, uint64_t uiValue, size_t uiBytes)
+{
+  for (size_t i = 0; i < uiBytes; ++i)
+  {
+    vOut.push_back(static_cast<uint8_t>(uiValue >> (8 * i)));
+  }
+}
+
+uint64_t readLe(const uint8_t* pData, size_t uiBytes)
+{
+  uint64_t uiValue = 0;
+  for (size_t i = 0; i < uiBytes; ++i)
+  {
+    uiValue |= static_cast<uint64_t>(pData[i]) << (8 * i);
+  }
+  return uiValue;
+}
+
+/**
+ * @brief getFileVersion returns the modification time of the file with the highest
+ * resolution the platform offers and an id of the file (the inode) so that a file that
+ * is modified within a second or replaced by a file of the same size is detected.
+ * @return false if the file does not exist
+ */
+bool getFileVersion(const std::string& sFilename, uint64_t& uiModified, uint64_t& uiFileId)
+{
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(sFilename.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) return false;
+  BY_HANDLE_FILE_INFORMATION info;
+  BOOL bRes = GetFileInformationByHandle(hFile, &info);
+  CloseHandle(hFile);
+  if (!bRes) return false;
+  // 100 ns intervals
+  uiModified = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+  uiFileId = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+#else
+  struct stat st;
+  if (stat(sFilename.c_str(), &st) != 0) return false;
+#if defined(__APPLE__)
+  uiModified = static_cast<uint64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+  uiModified = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+  uiModified = static_cast<uint64_t>(st.st_mtime) * 1000000000;
+#endif
+  uiFileId = static_cast<uint64_t>(st.st_ino);
+#endif
+  return true;
+}
+
+} // anon
 
 NalUnitMediaSource::NalUnitMediaSource(const std::string& sFilename, const std::string& sMediaType, bool bLoopSource, uint32_t uiLoopCount, uint32_t uiInitialBufferSize)
-  :m_in(sFilename.c_str() , std::ifstream::in | std::ifstream::binary),
-    m_rIn(m_in),
+  :m_pFile(MappedFile::map(sFilename)),
+    m_sFilename(sFilename),
     m_bEos(false),
     m_bLoopSource(bLoopSource),
     m_uiLoopCount(uiLoopCount),
     m_uiCurrentLoop(0),
     m_uiCurrentAccessUnit(0),
-    m_buffer(new uint8_t[uiInitialBufferSize], uiInitialBufferSize),
-    m_temporaryNalUnitBuffer(new uint8_t[1000], 1000),
+    m_bCurrentLayerIsBaseLayer(true),
     m_bFirstH265NalUnit(true)
 {
-  if (sMediaType == rfc6184::H264 || sMediaType == rfc6190::H264_SVC)
-  {
-    m_eType = MT_H264;
-    VLOG(5) << "H264 Nal unit source";
-  }
-  else if (sMediaType == rfchevc::H265)
+  setMediaType(sMediaType);
+  if (!m_pFile)
   {
-    m_eType = MT_H265;
-    VLOG(5) << "H265 Nal unit source";
+    m_bEos = true;
+    return;
   }
-  else
+  if (m_bEos) return;
+
+  const std::string sIndexFilename = getIndexFilename(sFilename);
+  if (loadIndex(sIndexFilename))
   {
-    LOG(WARNING) << "Unsupported Nal unit source";
-    m_bEos = true;
+    VLOG(2) << "Loaded index of " << sFilename << ": " << m_vStartCodeInfo.size() << " NAL units " << m_vAccessUnitInfo.size() << " AUs";
+    return;
   }
-  checkInputStream();
   parseAnnexBStream();
+  if (!m_vAccessUnitInfo.empty())
+    saveIndex(sIndexFilename);
 }
 
 
 
 NalUnitMediaSource::NalUnitMediaSource(std::istream& in1, const std::string& sMediaType, bool bLoopSource, uint32_t uiLoopCount, uint32_t uiInitialBufferSize)
-  :m_rIn(in1),
+  :m_pFile(MappedFile::read(in1)),
     m_bEos(false),
     m_bLoopSource(bLoopSource),
     m_uiLoopCount(uiLoopCount),
     m_uiCurrentLoop(0),
     m_uiCurrentAccessUnit(0),
-    m_buffer(new uint8_t[uiInitialBufferSize], uiInitialBufferSize)
+    m_bCurrentLayerIsBaseLayer(true),
+    m_bFirstH265NalUnit(true)
 {
-  checkInputStream();
-  parseAnnexBStream();
+  setMediaType(sMediaType);
+  if (!m_bEos)
+    parseAnnexBStream();
 }
 
+std::string NalUnitMediaSource::getIndexFilename(const std::string& sFilename)
+{
+  return sFilename + ".nalidx";
+}
+
+void NalUnitMediaSource::setMediaType(const std::string& sMediaType)
+{
+  if (sMediaType == rfc6184::H264 || sMediaType == rfc6190::H264_SVC)
+  {
+    m_eType = MT_H264;
+    VLOG(5) << "H264 Nal unit source";
+  }
+  else if (sMediaType == rfchevc::H265)
+  {
+    m_eType = MT_H265;
+    VLOG(5) << "H265 Nal unit source";
+  }
+  else
+  {
+    LOG(WARNING) << "Unsupported Nal unit source";
+    m_bEos = true;
+  }
+}
 
 bool NalUnitMediaSource::isGood() const
 {
@@ -115,55 +213,26 @@ std::vector<MediaSample> NalUnitMediaSource::getNextAccessUnit()
   }
 }
 
-void NalUnitMediaSource::checkInputStream()
-{
-  if (!m_rIn.good())  m_bEos = true;
-}
-
 std::vector<MediaSample> NalUnitMediaSource::readMediaSamples(const AccessUnitInfo_t& auInfo)
 {
   std::vector<MediaSample> vAu;
 
-  uint32_t uiAuLength = std::accumulate(auInfo.begin(), auInfo.end(), 0, [](int iSum, const NalUnitInfo_t& nalUnitInfo)
-  {
-    return iSum + std::get<1>(nalUnitInfo) + std::get<3>(nalUnitInfo);
-  });
-
-  assert(!auInfo.empty());
-  const NalUnitInfo_t& info = auInfo[0];
-
-  // read NAL unit from file
-  size_t uiStartCodeIndex = std::get<0>(info);
+  const uint32_t uiFirstNalUnit = std::get<0>(auInfo);
+  const uint32_t uiNalUnitCount = std::get<1>(auInfo);
+  assert(uiNalUnitCount > 0);
+  vAu.reserve(uiNalUnitCount);
 
-  // resize buffer if necessary
-  if (m_buffer.getSize() < uiAuLength)
-  {
-    LOG(WARNING) << "Resizing buffer for AU. Size: " << m_buffer.getSize() << " New: " << uiAuLength + 1000;
-    m_buffer.setData(new uint8_t[uiAuLength + 1000], uiAuLength + 1000);
-  }
-
-  m_rIn.seekg(uiStartCodeIndex, std::ios_base::beg);
-  m_rIn.read((char*) m_buffer.data(), uiAuLength);
-  size_t count = static_cast<size_t>(m_rIn.gcount());
-  assert(count == uiAuLength);
-
-  uint32_t uiNaluOffsetInBuffer = 0;
-  for (const NalUnitInfo_t& nalInfo: auInfo)
+  for (uint32_t i = uiFirstNalUnit; i < uiFirstNalUnit + uiNalUnitCount; ++i)
   {
+    const NalUnitInfo_t& nalInfo = m_vStartCodeInfo[i];
     uint32_t uiStartCodeLen = std::get<1>(nalInfo);
-    uint32_t uiNalLen = std::get<3>(nalInfo);
-    Buffer mediaData(new uint8_t[uiNalLen], uiNalLen);
-
-    //NB: skip start code
-    memcpy((char*)mediaData.data(), (char*)(m_buffer.data() + uiNaluOffsetInBuffer + uiStartCodeLen), uiNalLen);
 
     MediaSample mediaSample;
-    mediaSample.setData(mediaData);
+    //NB: skip start code
+    mediaSample.setData(m_pFile->getBuffer(std::get<2>(nalInfo), std::get<3>(nalInfo)));
     // HACK to avoid parsing NAL unit later on
     mediaSample.setStartCodeLengthHint(uiStartCodeLen);
     vAu.push_back(mediaSample);
-
-    uiNaluOffsetInBuffer += uiStartCodeLen + uiNalLen;
   }
 
   return vAu;
@@ -171,74 +240,45 @@ std::vector<MediaSample> NalUnitMediaSource::readMediaSamples(const AccessUnitIn
 
 void NalUnitMediaSource::parseAnnexBStream()
 {
-  // only search for 3 byte start code
-  char startCode[3] = {0, 0, 1};
+  const uint8_t* pData = m_pFile->data();
+  const uint64_t uiTotalFileSize = m_pFile->getSize();
 
-  m_rIn.seekg(0, std::ios_base::end);
-  size_t uiTotalFileSize = m_rIn.tellg();
-  m_rIn.seekg(0, std::ios_base::beg);
-
-  size_t uiPreviouslyProcessedData = 0;
-  size_t uiDataFromPreviousRead = 0;
   // NB: index to NAL unit, not start code
-  size_t uiPreviousNalUnitIndex = 0;
-  
-  uint32_t uiMaxSize = 0;
-  while (m_rIn.good())
+  uint64_t uiPreviousNalUnitIndex = 0;
+
+  // Only 3 byte start codes are searched for: the preceding byte tells if it
+  // is a 4 byte one. A start code in the last 3 bytes of the file is ignored
+  // since it can't be followed by a NAL unit.
+  const size_t uiSearchSize = uiTotalFileSize > 0 ? static_cast<size_t>(uiTotalFileSize - 1) : 0;
+  for (size_t i = StartCodeScanner::find(pData, uiSearchSize, 0); i < uiSearchSize;
+       i = StartCodeScanner::find(pData, uiSearchSize, i + 3))
   {
-    size_t uiRead = std::min(READ_SIZE, m_buffer.getSize() - uiDataFromPreviousRead);
-    m_rIn.read((char*) m_buffer.data() + uiDataFromPreviousRead, uiRead);
-
-    size_t count = static_cast<size_t>(m_rIn.gcount());
-    size_t uiTotalDataInBuffer = uiDataFromPreviousRead + count;
-
-    // go through read data and search for start codes
-    // end at -3 since there might be a scenario where there
-    // is a 4 or a 3 byte start code starting in the last 3 bytes. 
-    // In the case of the 4 byte start code, we would only be able 
-    // to match this after the next read
-    for (size_t i = 0; i < uiTotalDataInBuffer - 3; ++i)
-    {
-      if (memcmp(&m_buffer[i], startCode, 3) == 0)
-      {
-        size_t index;
-        uint32_t uiStartCodeLen;
+    uint64_t index;
+    uint32_t uiStartCodeLen;
 
-        // check if this is a 3 byte or 4 byte start code
-        if ( i > 0 && m_buffer[i-1] == 0)
-        {
-          // map to global offset
-          index = i-1 + uiPreviouslyProcessedData;
-          uiStartCodeLen = 4;
-        }
-        else
-        {
-          // map to global offset
-          index = i + uiPreviouslyProcessedData;
-          uiStartCodeLen = 3;
-        }
+    // check if this is a 3 byte or 4 byte start code
+    if ( i > 0 && pData[i-1] == 0)
+    {
+      index = i-1;
+      uiStartCodeLen = 4;
+    }
+    else
+    {
+      index = i;
+      uiStartCodeLen = 3;
+    }
 
-        size_t uiNalUnitIndex = index + uiStartCodeLen;
+    uint64_t uiNalUnitIndex = index + uiStartCodeLen;
 
-        // update size in previously stored info
-        if (!m_vStartCodeInfo.empty())
-        {
-          size_t uiSize = uiNalUnitIndex - uiPreviousNalUnitIndex - uiStartCodeLen;
-          std::get<3>(m_vStartCodeInfo[m_vStartCodeInfo.size() - 1 ]) = uiSize; 
-          if (uiSize > uiMaxSize) uiMaxSize = uiSize;
-        }
-        // store current NAL unit
-        m_vStartCodeInfo.push_back(std::make_tuple(index, uiStartCodeLen, uiNalUnitIndex, 0));
-        
-        uiPreviousNalUnitIndex = uiNalUnitIndex;
-      }
+    // update size in previously stored info
+    if (!m_vStartCodeInfo.empty())
+    {
+      std::get<3>(m_vStartCodeInfo[m_vStartCodeInfo.size() - 1 ]) = static_cast<uint32_t>(uiNalUnitIndex - uiPreviousNalUnitIndex - uiStartCodeLen);
     }
-    // shift data, but leave last 3 bytes in case there is a start code to be matched
-    // this means that the last 3 bytes of the file will not be checked for a start code
-    // but that's ok since that wouldn't make sense anyway
-    uiPreviouslyProcessedData += (uiTotalDataInBuffer - 3);
-    uiDataFromPreviousRead = 3;
-    memmove(&m_buffer[0], &m_buffer[uiTotalDataInBuffer-3], 3);
+    // store current NAL unit
+    m_vStartCodeInfo.push_back(std::make_tuple(index, uiStartCodeLen, uiNalUnitIndex, 0));
+
+    uiPreviousNalUnitIndex = uiNalUnitIndex;
   }
 
   if (m_vStartCodeInfo.empty())
@@ -248,27 +288,15 @@ void NalUnitMediaSource::parseAnnexBStream()
   }
 
   // update size of final NAL unit
-  uint32_t uiSize = uiTotalFileSize - uiPreviousNalUnitIndex;
-  std::get<3>(m_vStartCodeInfo[m_vStartCodeInfo.size() - 1 ]) = uiSize; 
-
-  // adjust temp buffer
-  if (uiSize > uiMaxSize) uiMaxSize = uiSize; 
-  if (uiMaxSize > m_temporaryNalUnitBuffer.getSize())
-    m_temporaryNalUnitBuffer.setData(new uint8_t[uiMaxSize], uiMaxSize);
-
-  m_rIn.clear();
+  std::get<3>(m_vStartCodeInfo[m_vStartCodeInfo.size() - 1 ]) = static_cast<uint32_t>(uiTotalFileSize - uiPreviousNalUnitIndex);
 
-  AccessUnitInfo_t vCurrentAccessUnit;
-  for (size_t i = 0; i < m_vStartCodeInfo.size(); ++i)
+  uint32_t uiFirstNalUnitInAu = 0;
+  for (uint32_t i = 0; i < m_vStartCodeInfo.size(); ++i)
   {
-    NalUnitInfo_t& info = m_vStartCodeInfo[i];
-    // read NAL unit from file
-    size_t uiIndex = std::get<2>(info);
-    uint32_t uiSize = std::get<3>(info);
-    m_rIn.seekg(uiIndex, std::ios_base::beg);
-    m_rIn.read((char*) m_temporaryNalUnitBuffer.data(), uiSize);
-    size_t count = static_cast<size_t>(m_rIn.gcount());
-    assert(count == uiSize);
+    const NalUnitInfo_t& info = m_vStartCodeInfo[i];
+    // the NAL unit header is read from the file: short NAL units are zero padded
+    uint8_t header[3] = { 0, 0, 0 };
+    memcpy(header, pData + std::get<2>(info), std::min<uint32_t>(std::get<3>(info), sizeof(header)));
 
     switch (m_eType)
     {
@@ -276,21 +304,19 @@ void NalUnitMediaSource::parseAnnexBStream()
     case MT_H264:
       {
         using h264::NalUnitType;
-        NalUnitType eType = h264::getNalUnitType(m_temporaryNalUnitBuffer[0]);
+        NalUnitType eType = h264::getNalUnitType(header[0]);
 
         if (eType == media::h264::NUT_ACCESS_UNIT_DELIMITER ||
             (!m_bCurrentLayerIsBaseLayer && (eType != media::h264::NUT_CODED_SLICE_EXT && eType != media::h264::NUT_RESERVED_21) ) )
         {
-          finaliseAu(vCurrentAccessUnit);
+          finaliseAu(uiFirstNalUnitInAu, i);
+          uiFirstNalUnitInAu = i;
           m_bCurrentLayerIsBaseLayer = true;
         }
         else if(eType == media::h264::NUT_CODED_SLICE_EXT || eType == media::h264::NUT_RESERVED_21)
         {
           m_bCurrentLayerIsBaseLayer = false;
         }
-
-        // add AU to current AU
-        vCurrentAccessUnit.push_back(info);
         break;
       }
     case MT_H265:
@@ -299,7 +325,7 @@ void NalUnitMediaSource::parseAnnexBStream()
         NalUnitType eType;
         uint32_t uiLayerId = 0, uiTemporalId = 0;
         bool bFirstCTB = false;
-        h265::getNalUnitInfo(&m_temporaryNalUnitBuffer[0], eType, uiLayerId, uiTemporalId, bFirstCTB);
+        h265::getNalUnitInfo(header, eType, uiLayerId, uiTemporalId, bFirstCTB);
 #if 0
         VLOG(5) << "DBG: NALU Type: " << media::h265::toString(eType);
 #endif
@@ -317,7 +343,8 @@ void NalUnitMediaSource::parseAnnexBStream()
                   << " uiLayerId: " << uiLayerId
                   << " previous type: " << media::h265::toString(m_ePrevH265Type);
 
-          finaliseAu(vCurrentAccessUnit);
+          finaliseAu(uiFirstNalUnitInAu, i);
+          uiFirstNalUnitInAu = i;
         }
         else
         {
@@ -327,8 +354,6 @@ void NalUnitMediaSource::parseAnnexBStream()
                   << " uiLayerId: " << uiLayerId
                   << " previous type: " << media::h265::toString(m_ePrevH265Type);
         }
-        // add AU to current AU
-        vCurrentAccessUnit.push_back(info);
         // store for next pass
         m_bFirstH265NalUnit = false;
         m_ePrevH265Type = eType;
@@ -338,17 +363,132 @@ void NalUnitMediaSource::parseAnnexBStream()
   }
 
   // store final AU
-  finaliseAu(vCurrentAccessUnit);
+  finaliseAu(uiFirstNalUnitInAu, static_cast<uint32_t>(m_vStartCodeInfo.size()));
 }
 
-void NalUnitMediaSource::finaliseAu(AccessUnitInfo_t& vCurrentAccessUnit)
+void NalUnitMediaSource::finaliseAu(uint32_t uiFirstNalUnit, uint32_t uiEndNalUnit)
 {
   // new AU: store previously seen AUs
-  if (!vCurrentAccessUnit.empty()) // the first will be empty
+  if (uiEndNalUnit > uiFirstNalUnit) // the first will be empty
+  {
+    m_vAccessUnitInfo.push_back(std::make_tuple(uiFirstNalUnit, uiEndNalUnit - uiFirstNalUnit));
+  }
+}
+
+bool NalUnitMediaSource::loadIndex(const std::string& sIndexFilename)
+{
+  boost::system::error_code ec;
+  if (!boost::filesystem::exists(sIndexFilename, ec)) return false;
+  uint64_t uiModified = 0, uiFileId = 0;
+  if (!getFileVersion(m_sFilename, uiModified, uiFileId)) return false;
+
+  MappedFile::ptr pIndex = MappedFile::map(sIndexFilename);
+  if (!pIndex || pIndex->getSize() < INDEX_HEADER_SIZE) return false;
+  const uint8_t* pData = pIndex->data();
+  if (memcmp(pData, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+      readLe(pData + 8, 4) != INDEX_VERSION ||
+      readLe(pData + 12, 4) != static_cast<uint32_t>(m_eType) ||
+      readLe(pData + 16, 8) != m_pFile->getSize() ||
+      readLe(pData + 24, 8) != uiModified ||
+      readLe(pData + 32, 8) != uiFileId)
+  {
+    VLOG(2) << "Index " << sIndexFilename << " does not match " << m_sFilename;
+    return false;
+  }
+  const uint64_t uiNalUnits = readLe(pData + 40, 8);
+  const uint64_t uiAccessUnits = readLe(pData + 48, 8);
+  if (uiNalUnits == 0 || uiAccessUnits == 0 || uiNalUnits > UINT32_MAX || uiAccessUnits > uiNalUnits ||
+      pIndex->getSize() != INDEX_HEADER_SIZE + uiNalUnits * INDEX_NAL_UNIT_SIZE + uiAccessUnits * INDEX_AU_SIZE)
+  {
+    LOG(WARNING) << "Invalid index " << sIndexFilename;
+    return false;
+  }
+
+  std::vector<NalUnitInfo_t> vStartCodeInfo;
+  vStartCodeInfo.reserve(static_cast<size_t>(uiNalUnits));
+  const uint8_t* pNalUnit = pData + INDEX_HEADER_SIZE;
+  for (uint64_t i = 0; i < uiNalUnits; ++i, pNalUnit += INDEX_NAL_UNIT_SIZE)
+  {
+    uint64_t uiIndex = readLe(pNalUnit, 8);
+    uint32_t uiStartCodeLen = pNalUnit[8];
+    uint32_t uiNalLen = static_cast<uint32_t>(readLe(pNalUnit + 9, 4));
+    if ((uiStartCodeLen != 3 && uiStartCodeLen != 4) || uiIndex + uiStartCodeLen + uiNalLen > m_pFile->getSize())
+    {
+      LOG(WARNING) << "Invalid NAL unit in index " << sIndexFilename;
+      return false;
+    }
+    vStartCodeInfo.push_back(std::make_tuple(uiIndex, uiStartCodeLen, uiIndex + uiStartCodeLen, uiNalLen));
+  }
+
+  std::vector<AccessUnitInfo_t> vAccessUnitInfo;
+  vAccessUnitInfo.reserve(static_cast<size_t>(uiAccessUnits));
+  const uint8_t* pAccessUnit = pNalUnit;
+  for (uint64_t i = 0; i < uiAccessUnits; ++i, pAccessUnit += INDEX_AU_SIZE)
+  {
+    uint32_t uiFirstNalUnit = static_cast<uint32_t>(readLe(pAccessUnit, 4));
+    uint32_t uiNalUnitCount = static_cast<uint32_t>(readLe(pAccessUnit + 4, 4));
+    if (uiNalUnitCount == 0 || static_cast<uint64_t>(uiFirstNalUnit) + uiNalUnitCount > uiNalUnits)
+    {
+      LOG(WARNING) << "Invalid AU in index " << sIndexFilename;
+      return false;
+    }
+    vAccessUnitInfo.push_back(std::make_tuple(uiFirstNalUnit, uiNalUnitCount));
+  }
+
+  m_vStartCodeInfo.swap(vStartCodeInfo);
+  m_vAccessUnitInfo.swap(vAccessUnitInfo);
+  return true;
+}
+
+void NalUnitMediaSource::saveIndex(const std::string& sIndexFilename) const
+{
+  uint64_t uiModified = 0, uiFileId = 0;
+  if (!getFileVersion(m_sFilename, uiModified, uiFileId)) return;
+
+  std::vector<uint8_t> vIndex;
+  vIndex.reserve(INDEX_HEADER_SIZE + m_vStartCodeInfo.size() * INDEX_NAL_UNIT_SIZE + m_vAccessUnitInfo.size() * INDEX_AU_SIZE);
+  vIndex.insert(vIndex.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+  writeLe(vIndex, INDEX_VERSION, 4);
+  writeLe(vIndex, static_cast<uint32_t>(m_eType), 4);
+  writeLe(vIndex, m_pFile->getSize(), 8);
+  writeLe(vIndex, uiModified, 8);
+  writeLe(vIndex, uiFileId, 8);
+  writeLe(vIndex, m_vStartCodeInfo.size(), 8);
+  writeLe(vIndex, m_vAccessUnitInfo.size(), 8);
+  for (const NalUnitInfo_t& info : m_vStartCodeInfo)
+  {
+    writeLe(vIndex, std::get<0>(info), 8);
+    writeLe(vIndex, std::get<1>(info), 1);
+    writeLe(vIndex, std::get<3>(info), 4);
+  }
+  for (const AccessUnitInfo_t& auInfo : m_vAccessUnitInfo)
+  {
+    writeLe(vIndex, std::get<0>(auInfo), 4);
+    writeLe(vIndex, std::get<1>(auInfo), 4);
+  }
+
+  // write to a temporary file first so that concurrent sources never read a partial index.
+  // The name is unique so that sources that index the same file concurrently don't
+  // write to the same temporary file.
+  boost::system::error_code ec;
+  const std::string sTemporaryFilename = sIndexFilename + "." + boost::filesystem::unique_path().string() + ".tmp";
+  {
+    std::ofstream out(sTemporaryFilename.c_str(), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    out.write(reinterpret_cast<const char*>(&vIndex[0]), vIndex.size());
+    if (!out.good())
+    {
+      LOG(WARNING) << "Failed to write index " << sIndexFilename;
+      out.close();
+      boost::filesystem::remove(sTemporaryFilename, ec);
+      return;
+    }
+  }
+  boost::filesystem::rename(sTemporaryFilename, sIndexFilename, ec);
+  if (ec)
   {
-    m_vAccessUnitInfo.push_back(vCurrentAccessUnit);
+    LOG(WARNING) << "Failed to write index " << sIndexFilename << ": " << ec.message();
+    boost::filesystem::remove(sTemporaryFilename, ec);
   }
-  vCurrentAccessUnit.clear();
 }
 
 } // media
@@ -0,0 +1,190 @@
+#include "CorePch.h"
+#include <rtp++/media/StartCodeScanner.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RTP_START_CODE_SCANNER_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#define RTP_TARGET_SSE2
+#define RTP_TARGET_AVX2
+#else
+#include <immintrin.h>
+#define RTP_TARGET_SSE2 __attribute__((target("sse2")))
+#define RTP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace rtp_plus_plus
+{
+namespace media
+{
+
+namespace
+{
+
+typedef size_t (*FindFunction)(const uint8_t*, size_t, size_t);
+
+#ifdef RTP_START_CODE_SCANNER_X86
+
+inline uint32_t ctz(uint32_t uiBits)
+{
+#ifdef _MSC_VER
+  unsigned long uiIndex;
+  _BitScanForward(&uiIndex, uiBits);
+  return uiIndex;
+#else
+  return __builtin_ctz(uiBits);
+#endif
+}
+
+/**
+ * @brief findSse2 compares the bytes at i, i + 1 and i + 2 of 16 positions at once against 00 00 01
+ */
+RTP_TARGET_SSE2
+size_t findSse2(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  size_t i = uiStartPos;
+  for (; i + 18 <= uiSize; i += 16)
+  {
+    const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer + i));
+    const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer + i + 1));
+    const __m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuffer + i + 2));
+    const __m128i match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(first, zero), _mm_cmpeq_epi8(second, zero)),
+                                        _mm_cmpeq_epi8(third, one));
+    const uint32_t uiMask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+    if (uiMask)
+      return i + ctz(uiMask);
+  }
+  return StartCodeScanner::findScalar(pBuffer, uiSize, i);
+}
+
+/**
+ * @brief findAvx2 compares the bytes at i, i + 1 and i + 2 of 32 positions at once against 00 00 01
+ */
+RTP_TARGET_AVX2
+size_t findAvx2(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi8(1);
+  size_t i = uiStartPos;
+  for (; i + 34 <= uiSize; i += 32)
+  {
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBuffer + i));
+    const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBuffer + i + 1));
+    const __m256i third = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBuffer + i + 2));
+    const __m256i match = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(first, zero), _mm256_cmpeq_epi8(second, zero)),
+                                           _mm256_cmpeq_epi8(third, one));
+    const uint32_t uiMask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+    if (uiMask)
+      return i + ctz(uiMask);
+  }
+  return findSse2(pBuffer, uiSize, i);
+}
+
+bool isAvx2Supported()
+{
+#ifdef _MSC_VER
+  int aRegisters[4];
+  __cpuid(aRegisters, 0);
+  if (aRegisters[0] < 7) return false;
+  __cpuid(aRegisters, 1);
+  // OSXSAVE and AVX
+  const int iOsxsaveAvx = (1 << 27) | (1 << 28);
+  if ((aRegisters[2] & iOsxsaveAvx) != iOsxsaveAvx) return false;
+  // the OS saves the XMM and YMM registers
+  if ((_xgetbv(0) & 6) != 6) return false;
+  __cpuidex(aRegisters, 7, 0);
+  return (aRegisters[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+bool isSse2Supported()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(_MSC_VER)
+  int aRegisters[4];
+  __cpuid(aRegisters, 1);
+  return (aRegisters[3] & (1 << 26)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+#endif
+
+struct Implementation
+{
+  Implementation()
+    :Find(&StartCodeScanner::findScalar),
+      Name("scalar")
+  {
+#ifdef RTP_START_CODE_SCANNER_X86
+    if (isAvx2Supported())
+    {
+      Find = &findAvx2;
+      Name = "avx2";
+    }
+    else if (isSse2Supported())
+    {
+      Find = &findSse2;
+      Name = "sse2";
+    }
+#endif
+  }
+  FindFunction Find;
+  const char* Name;
+};
+
+const Implementation& getSelectedImplementation()
+{
+  static const Implementation implementation;
+  return implementation;
+}
+
+} // anon
+
+size_t StartCodeScanner::find(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos)
+{
+  return getSelectedImplementation().Find(pBuffer, uiSize, uiStartPos);
+}
+
+size_t StartCodeScanner::findScalar(const uint8_t* pBuffer, size_t uiSize, size_t uiStartPos)
+{
+  size_t i = uiStartPos;
+  while (i + 3 <= uiSize)
+  {
+    // the third byte rules out start codes at i, i + 1 and i + 2 unless it is 0 or 1
+    const uint8_t uiThird = pBuffer[i + 2];
+    if (uiThird > 1)
+    {
+      i += 3;
+    }
+    else if (uiThird == 0)
+    {
+      ++i;
+    }
+    else
+    {
+      if (pBuffer[i] == 0 && pBuffer[i + 1] == 0)
+        return i;
+      i += 3;
+    }
+  }
+  return uiSize;
+}
+
+const char* StartCodeScanner::getImplementation()
+{
+  return getSelectedImplementation().Name;
+}
+
+} // media
+} // rtp_plus_plus
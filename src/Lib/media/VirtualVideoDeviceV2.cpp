@@ -9,6 +9,7 @@
 #include <rtp++/media/IVideoCodecTransform.h>
 #include <rtp++/media/MediaTypes.h>
 #include <rtp++/media/NalUnitMediaSource.h>
+#include <rtp++/media/StartCodeScanner.h>
 #include <rtp++/media/YuvMediaSource.h>
 #include <rtp++/rfc6184/Rfc6184.h>
 #include <rtp++/rfc6190/Rfc6190.h>
@@ -177,29 +178,26 @@ VirtualVideoDeviceV2::VirtualVideoDeviceV2(boost::asio::io_service& ioService,
       NalUnitType ePreviousType = NUT_UNSPECIFIED;
       int32_t iPreviousIndex = -1;
 
-      char startCode[3] = { 0, 0, 1};
-      for (size_t i = 0; i < bufferSize - 3; ++i)
+      for (size_t i = StartCodeScanner::find(buffer, bufferSize - 1, 0); i < bufferSize - 1;
+           i = StartCodeScanner::find(buffer, bufferSize - 1, i + 3))
       {
-        if (memcmp(&buffer[i], startCode, 3) == 0)
+        if (ePreviousType == NUT_SEQUENCE_PARAMETER_SET)
         {
-          if (ePreviousType == NUT_SEQUENCE_PARAMETER_SET)
-          {
-            assert (iPreviousIndex != -1);
-            m_sSps = std::string((const char*)&(buffer[iPreviousIndex + 3]), (i - iPreviousIndex - 3));
-          }
-          else if (ePreviousType == NUT_PICTURE_PARAMETER_SET)
-          {
-            assert (iPreviousIndex != -1);
-            m_sPps = std::string((const char*)(&buffer[iPreviousIndex + 3]), (i - iPreviousIndex - 3));
-          }
+          assert (iPreviousIndex != -1);
+          m_sSps = std::string((const char*)&(buffer[iPreviousIndex + 3]), (i - iPreviousIndex - 3));
+        }
+        else if (ePreviousType == NUT_PICTURE_PARAMETER_SET)
+        {
+          assert (iPreviousIndex != -1);
+          m_sPps = std::string((const char*)(&buffer[iPreviousIndex + 3]), (i - iPreviousIndex - 3));
+        }
 
-          if (!m_sSps.empty() && !m_sPps.empty())
-          {
-            break;
-          }
-          ePreviousType = getNalUnitType(buffer[i + 3]);
-          iPreviousIndex = i;
+        if (!m_sSps.empty() && !m_sPps.empty())
+        {
+          break;
         }
+        ePreviousType = getNalUnitType(buffer[i + 3]);
+        iPreviousIndex = i;
       }
 
       if (m_sSps.empty() || m_sPps.empty() )
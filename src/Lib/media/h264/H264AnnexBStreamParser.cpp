@@ -2,6 +2,7 @@
 #include <rtp++/media/h264/H264AnnexBStreamParser.h>
 
 #include <rtp++/media/MediaStreamParser.h>
+#include <rtp++/media/StartCodeScanner.h>
 #include <rtp++/media/h264/H264NalUnitTypes.h>
 
 namespace rtp_plus_plus
@@ -357,30 +358,24 @@ std::vector<MediaSample> H264AnnexBStreamParser::extractAll(const uint8_t* pBuff
 
 bool H264AnnexBStreamParser::searchForNextNalStartCodeAndNalUnitType(const uint8_t* pBuffer, uint32_t uiBufferSize, uint32_t uiStartPos, uint32_t& uiPos, uint8_t& uiNut, uint32_t& uiStartCodeLen)
 {
-  int8_t start_code_3[3] = {0, 0, 1};
-  // assume start code at the beginning
-  for (size_t i = uiStartPos; i < uiBufferSize - 4; ++i)
+  // the NAL unit header following the start code must be in the buffer
+  if (uiBufferSize < 5) return false;
+  size_t i = StartCodeScanner::find(pBuffer, uiBufferSize - 2, uiStartPos);
+  if (i == uiBufferSize - 2) return false;
+  // found next NAL start code: check if this is a 3 or 4 byte start code
+  if (i > 0 && pBuffer[i-1] == 0)
   {
-    if (memcmp((char*)&pBuffer[i], start_code_3, 3) == 0)
-    {
-      // found next NAL start code: check if this is a 3 or 4 byte start code
-      if (pBuffer[i-1] == 0)
-      {
-        // 4 byte start code
-        uiPos = i - 1;
-        uiNut = pBuffer[i+3] & 0x1F;
-        uiStartCodeLen = 4;
-      }
-      else
-      {
-        uiPos = i;
-        uiNut = pBuffer[i+3] & 0x1F;
-        uiStartCodeLen = 3;
-      }
-      return true;
-    }
+    // 4 byte start code
+    uiPos = i - 1;
+    uiStartCodeLen = 4;
+  }
+  else
+  {
+    uiPos = i;
+    uiStartCodeLen = 3;
   }
-  return false;
+  uiNut = pBuffer[i+3] & 0x1F;
+  return true;
 }
 
 }
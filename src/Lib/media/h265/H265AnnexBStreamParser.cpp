@@ -2,6 +2,7 @@
 #include <rtp++/media/h265/H265AnnexBStreamParser.h>
 
 #include <rtp++/media/MediaStreamParser.h>
+#include <rtp++/media/StartCodeScanner.h>
 #include <rtp++/media/h265/H265NalUnitTypes.h>
 
 namespace rtp_plus_plus
@@ -350,39 +351,36 @@ H265AnnexBStreamParser::searchForNextNalStartCodeAndNalUnitType(const uint8_t* p
                                                                 bool & bFirstCTB,
                                                                 uint32_t& uiStartCodeLen)
 {
-  int8_t start_code_3[3] = {0, 0, 1};
   bFirstCTB = false;
-  // assume start code at the beginning
-  for (size_t i = uiStartPos; i < uiBufferSize - 4; ++i)
+  // the NAL unit header following the start code must be in the buffer
+  if (uiBufferSize < 5) return false;
+  size_t i = StartCodeScanner::find(pBuffer, uiBufferSize - 2, uiStartPos);
+  if (i == uiBufferSize - 2) return false;
+  // found next NAL start code: check if this is a 3 or 4 byte start code
+  if (i > 0 && pBuffer[i-1] == 0)
   {
-    if (memcmp((char*)&pBuffer[i], start_code_3, 3) == 0)
-    {
-      // found next NAL start code: check if this is a 3 or 4 byte start code
-      if (pBuffer[i-1] == 0)
-      {
-        // 4 byte start code
-        uiPos = i - 1;
-        uiStartCodeLen = 4;
-      }
-      else
-      {
-        uiPos = i;
-        uiStartCodeLen = 3;
-      }
-      uiNut = ( pBuffer[i+3] & 0x7E ) >> 1;
-      uiLayerId = ( (pBuffer[i+3] & 0x01 ) << 5) + ((pBuffer[i+4] & 0xF8 ) >> 3);
-      NalUnitType eNut = static_cast<media::h265::NalUnitType>(uiNut);
-      bFirstCTB = (( pBuffer[i+5] & 0x80 ) !=0)*
-          (eNut != media::h265::NUT_VPS)*
-          (eNut!=media::h265::NUT_SPS)*
-          (eNut!=media::h265::NUT_PPS)*
-          (eNut!=media::h265::NUT_PREFIX_SEI)*
-          (eNut!=media::h265::NUT_SUFFIX_SEI)*
-          (eNut!=media::h265::NUT_FD);
-      return true;
-    }
+    // 4 byte start code
+    uiPos = i - 1;
+    uiStartCodeLen = 4;
+  }
+  else
+  {
+    uiPos = i;
+    uiStartCodeLen = 3;
   }
-  return false;
+  uiNut = ( pBuffer[i+3] & 0x7E ) >> 1;
+  uiLayerId = ( (pBuffer[i+3] & 0x01 ) << 5) + ((pBuffer[i+4] & 0xF8 ) >> 3);
+  NalUnitType eNut = static_cast<media::h265::NalUnitType>(uiNut);
+  // the first slice segment flag follows the NAL unit header
+  bFirstCTB = (i + 5 < uiBufferSize) &&
+      (( pBuffer[i+5] & 0x80 ) != 0) &&
+      (eNut != media::h265::NUT_VPS) &&
+      (eNut != media::h265::NUT_SPS) &&
+      (eNut != media::h265::NUT_PPS) &&
+      (eNut != media::h265::NUT_PREFIX_SEI) &&
+      (eNut != media::h265::NUT_SUFFIX_SEI) &&
+      (eNut != media::h265::NUT_FD);
+  return true;
 }
 
 }
@@ -9,6 +9,7 @@
 #include <rtp++/mprtp/MpRtpHeader.h>
 #include <rtp++/rfc3550/Rfc3550.h>
 #include <rtp++/rfc3611/Rfc3611.h>
+#include <rtp++/util/Clock.h>
 
 namespace rtp_plus_plus
 {
@@ -174,8 +175,8 @@ void MpRtpMemberEntry::doReceiveRtpPacket(const RtpPacket& rtpPacket)
   // replicating base class code: the sequence number jumps on multiple paths
   // don't work with update_seq
   // Nor do the jitter calculations apply!
-  m_tLastRtpPacketSent = boost::posix_time::microsec_clock::universal_time();
-  m_tLastPacketSent = m_tLastRtpPacketSent;
+  m_iLastRtpPacketSentNs = Clock::monotonicNs();
+  m_iLastPacketSentNs = m_iLastRtpPacketSentNs;
   m_bIsSender = true;
   ++m_uiRtpPacketsReceivedDuringLastInterval;
 
@@ -108,7 +108,7 @@ void DccpRtpConnection::handleConnect( const boost::system::error_code& error, d
       Buffer networkPacket = package.first;
       EndPoint ep = package.second;
 
-      boost::asio::ip::dccp::endpoint destination(boost::asio::ip::address::from_string(ep.getAddress()), ep.getPort());
+      boost::asio::ip::dccp::endpoint destination(ep.getUdpEndpoint().address(), ep.getPort());
       m_socket.async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
                               destination,
                               boost::bind(&DccpRtpConnection::writeCompletionHandler,
@@ -149,13 +149,18 @@ void DccpRtpConnection::handleConnect( const boost::system::error_code& error, d
 void DccpRtpConnection::send(Buffer networkPacket, const EndPoint& endpoint)
 {
   VLOG(10) << "Outgoing data packet of size " << networkPacket.getSize();
+  if (!endpoint.isResolved())
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] Unable to send to unresolved address " << endpoint;
+    return;
+  }
   boost::mutex::scoped_lock l(m_lock);
   bool bBusyWriting = !m_vDeliveryQueue.empty();
   m_vDeliveryQueue.push_back( std::make_pair(networkPacket, endpoint) );
 
   if (!m_bConnectionInProgress && !bBusyWriting)
   {
-    boost::asio::ip::dccp::endpoint destination(boost::asio::ip::address::from_string(endpoint.getAddress()), endpoint.getPort());
+    boost::asio::ip::dccp::endpoint destination(endpoint.getUdpEndpoint().address(), endpoint.getPort());
     m_socket.async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
                             destination,
                             boost::bind(&DccpRtpConnection::writeCompletionHandler,
@@ -221,7 +226,7 @@ void DccpRtpConnection::writeCompletionHandler(const boost::system::error_code&
       NetworkPackage_t package = m_vDeliveryQueue.front();
       Buffer networkPacket = package.first;
       EndPoint ep = package.second;
-      boost::asio::ip::dccp::endpoint endPoint(boost::asio::ip::address::from_string(ep.getAddress()), ep.getPort());
+      boost::asio::ip::dccp::endpoint endPoint(ep.getUdpEndpoint().address(), ep.getPort());
       m_socket.async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
                               endPoint,
                               boost::bind(&DccpRtpConnection::writeCompletionHandler,
@@ -268,8 +273,7 @@ void DccpRtpConnection::readCompletionHandler(const boost::system::error_code& e
     uint8_t* pData = new uint8_t[bytes_received];
     memcpy(pData, m_data, bytes_received);
     networkPacket.setData(pData, bytes_received);
-    ep.setAddress(m_lastSenderEndpoint.address().to_string());
-    ep.setPort(m_lastSenderEndpoint.port());
+    ep = EndPoint(boost::asio::ip::udp::endpoint(m_lastSenderEndpoint.address(), m_lastSenderEndpoint.port()));
     read();
   }
   // let calling clas handle error and logging
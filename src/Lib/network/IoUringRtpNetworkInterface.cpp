@@ -0,0 +1,596 @@
+#include "CorePch.h"
+#include <rtp++/network/IoUringRtpNetworkInterface.h>
+#include <boost/bind.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <rtp++/RtpTime.h>
+#include <rtp++/util/BufferPool.h>
+
+#ifdef ENABLE_IO_URING
+#include <sys/eventfd.h>
+#endif
+
+namespace rtp_plus_plus
+{
+
+#ifdef ENABLE_IO_URING
+// indices of the registered sockets
+static const int RTP_FILE_INDEX = 0;
+static const int RTCP_FILE_INDEX = 1;
+
+static struct io_uring_sqe* getSqe(struct io_uring& ring)
+{
+  struct io_uring_sqe* pSqe = io_uring_get_sqe(&ring);
+  if (!pSqe)
+  {
+    // the submission queue is full: flush it and retry
+    io_uring_submit(&ring);
+    pSqe = io_uring_get_sqe(&ring);
+  }
+  return pSqe;
+}
+#endif
+
+static std::unique_ptr<boost::asio::ip::udp::socket> bindSocket(boost::asio::io_service& ioService, const EndPoint& ep,
+                                                                 uint32_t uiReceiveBufferSize, boost::system::error_code& ec)
+{
+  const boost::asio::ip::udp::endpoint& endpoint = ep.getUdpEndpoint();
+  std::unique_ptr<boost::asio::ip::udp::socket> pSocket(new boost::asio::ip::udp::socket(ioService));
+  pSocket->open(endpoint.protocol(), ec);
+  if (ec) return std::unique_ptr<boost::asio::ip::udp::socket>();
+  pSocket->bind(endpoint, ec);
+  if (ec)
+  {
+    LOG(WARNING) << "Failed to bind socket to " << ep << ": " << ec.message();
+    return std::unique_ptr<boost::asio::ip::udp::socket>();
+  }
+  // it helps to increase the buffer size to lessen packet loss
+  boost::system::error_code ecDummy;
+  pSocket->set_option(boost::asio::socket_base::receive_buffer_size(uiReceiveBufferSize), ecDummy);
+  return pSocket;
+}
+
+IoUringRtpNetworkInterface::IoUringRtpNetworkInterface(boost::asio::io_service& rIoService, const EndPoint& rtpEp, const EndPoint& rtcpEp, boost::system::error_code& ec)
+  :RtpNetworkInterface(std::unique_ptr<RtpPacketiser>(new RtpPacketiser())),
+  m_rIoService(rIoService),
+  m_bInitialised(false),
+  m_bShuttingDown(false),
+  m_rtpEp(rtpEp),
+  m_rtcpEp(rtcpEp),
+  m_uiDroppedPackets(0),
+  m_bSubmitPending(false)
+#ifdef ENABLE_IO_URING
+  ,m_eventDescriptor(rIoService),
+  m_uiEventCount(0),
+  m_pBufferRing(NULL),
+  m_uiSendHead(0),
+  m_uiSendTail(0)
+#endif
+{
+  initialise(ec);
+  if (ec) return;
+  initialiseRing(ec);
+}
+
+IoUringRtpNetworkInterface::IoUringRtpNetworkInterface(boost::asio::io_service& rIoService, const EndPoint& rtpEp, const EndPoint& rtcpEp,
+  std::unique_ptr<boost::asio::ip::udp::socket> pRtpSocket, std::unique_ptr<boost::asio::ip::udp::socket> pRtcpSocket,
+  boost::system::error_code& ec)
+  :RtpNetworkInterface(std::unique_ptr<RtpPacketiser>(new RtpPacketiser())),
+  m_rIoService(rIoService),
+  m_bInitialised(false),
+  m_bShuttingDown(false),
+  m_rtpEp(rtpEp),
+  m_rtcpEp(rtcpEp),
+  m_pRtpSocket(std::move(pRtpSocket)),
+  m_pRtcpSocket(std::move(pRtcpSocket)),
+  m_uiDroppedPackets(0),
+  m_bSubmitPending(false)
+#ifdef ENABLE_IO_URING
+  ,m_eventDescriptor(rIoService),
+  m_uiEventCount(0),
+  m_pBufferRing(NULL),
+  m_uiSendHead(0),
+  m_uiSendTail(0)
+#endif
+{
+  VLOG(5) << "Using existing RTP socket " << m_rtpEp << " and RTCP socket " << m_rtcpEp;
+  initialiseRing(ec);
+}
+
+IoUringRtpNetworkInterface::~IoUringRtpNetworkInterface()
+{
+  shutdown();
+}
+
+void IoUringRtpNetworkInterface::initialise(boost::system::error_code& ec)
+{
+  // This check should be sufficient
+  assert(m_rtpEp.getPort() != m_rtcpEp.getPort());
+  VLOG(5) << "Creating RTP socket " << m_rtpEp;
+  m_pRtpSocket = bindSocket(m_rIoService, m_rtpEp, udp_receiver_buffer_size_kb, ec);
+  if (ec) return;
+  VLOG(5) << "Creating RTCP socket " << m_rtcpEp;
+  m_pRtcpSocket = bindSocket(m_rIoService, m_rtcpEp, udp_receiver_buffer_size_kb, ec);
+}
+
+void IoUringRtpNetworkInterface::initialiseRing(boost::system::error_code& ec)
+{
+#ifdef ENABLE_IO_URING
+  int iRes = io_uring_queue_init(ring_entries, &m_ring, 0);
+  if (iRes < 0)
+  {
+    ec = boost::system::error_code(-iRes, boost::system::system_category());
+    LOG(WARNING) << "Failed to set up io_uring: " << ec.message();
+    return;
+  }
+  // from here on releaseRing() cleans up
+  m_bInitialised = true;
+  m_bShuttingDown = false;
+
+  int fds[2];
+  fds[RTP_FILE_INDEX] = m_pRtpSocket->native_handle();
+  fds[RTCP_FILE_INDEX] = m_pRtcpSocket->native_handle();
+  iRes = io_uring_register_files(&m_ring, fds, 2);
+  if (iRes < 0)
+  {
+    ec = boost::system::error_code(-iRes, boost::system::system_category());
+    LOG(WARNING) << "Failed to register sockets with io_uring: " << ec.message();
+    releaseRing();
+    return;
+  }
+
+  // the kernel picks a free buffer for each received datagram
+  m_vReceiveBuffers.resize(recv_buffer_count * recv_buffer_size);
+  m_pBufferRing = io_uring_setup_buf_ring(&m_ring, recv_buffer_count, recv_buffer_group, 0, &iRes);
+  if (!m_pBufferRing)
+  {
+    ec = boost::system::error_code(-iRes, boost::system::system_category());
+    LOG(WARNING) << "Failed to register io_uring receive buffers: " << ec.message();
+    releaseRing();
+    return;
+  }
+  for (uint32_t i = 0; i < recv_buffer_count; ++i)
+  {
+    io_uring_buf_ring_add(m_pBufferRing, &m_vReceiveBuffers[i * recv_buffer_size], recv_buffer_size, i,
+                          io_uring_buf_ring_mask(recv_buffer_count), i);
+  }
+  io_uring_buf_ring_advance(m_pBufferRing, recv_buffer_count);
+
+  int iEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (iEventFd < 0)
+  {
+    ec = boost::system::error_code(errno, boost::system::system_category());
+    LOG(WARNING) << "Failed to create eventfd: " << ec.message();
+    releaseRing();
+    return;
+  }
+  m_eventDescriptor.assign(iEventFd, ec);
+  if (ec)
+  {
+    close(iEventFd);
+    releaseRing();
+    return;
+  }
+  iRes = io_uring_register_eventfd(&m_ring, iEventFd);
+  if (iRes < 0)
+  {
+    ec = boost::system::error_code(-iRes, boost::system::system_category());
+    LOG(WARNING) << "Failed to register eventfd with io_uring: " << ec.message();
+    releaseRing();
+    return;
+  }
+
+  // the kernel stores the source address and the datagram in the provided buffer
+  memset(&m_receiveHeader, 0, sizeof(m_receiveHeader));
+  m_receiveHeader.msg_namelen = sizeof(struct sockaddr_storage);
+
+  m_vSendSlots = std::vector<SendSlot>(send_ring_capacity);
+  m_uiSendHead = 0;
+  m_uiSendTail = 0;
+  VLOG(2) << "[" << this << "] io_uring RTP network interface ready " << m_rtpEp << " " << m_rtcpEp;
+#else
+  ec = boost::asio::error::operation_not_supported;
+  LOG(WARNING) << "io_uring support has not been compiled in";
+#endif
+}
+
+void IoUringRtpNetworkInterface::releaseRing()
+{
+#ifdef ENABLE_IO_URING
+  if (!m_bInitialised) return;
+  m_bInitialised = false;
+  boost::system::error_code ec;
+  if (m_eventDescriptor.is_open())
+    m_eventDescriptor.close(ec);
+  if (m_pBufferRing)
+  {
+    io_uring_free_buf_ring(&m_ring, m_pBufferRing, recv_buffer_count, recv_buffer_group);
+    m_pBufferRing = NULL;
+  }
+  // cancels the pending operations. The send slots stay allocated until destruction.
+  io_uring_queue_exit(&m_ring);
+#endif
+}
+
+void IoUringRtpNetworkInterface::reset()
+{
+  boost::system::error_code ec;
+  initialise(ec);
+  if (!ec)
+    initialiseRing(ec);
+  if (ec)
+  {
+    assert(false);
+  }
+}
+
+void IoUringRtpNetworkInterface::shutdown()
+{
+  VLOG(5) << "[" << this << "] Shutting down io_uring RTP network interface";
+#ifdef ENABLE_IO_URING
+  std::vector<SentPacket> vSent;
+#endif
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    if (m_bInitialised)
+    {
+      m_bShuttingDown = true;
+#ifdef ENABLE_IO_URING
+      drainSends(vSent);
+#endif
+      releaseRing();
+      boost::system::error_code ec;
+      m_pRtpSocket->close(ec);
+      m_pRtcpSocket->close(ec);
+    }
+  }
+
+#ifdef ENABLE_IO_URING
+  // the callbacks are invoked without holding the lock as in handleEvent
+  for (const SentPacket& sent : vSent)
+  {
+    if (sent.Rtcp)
+      onRtcpSent(sent.Packet, sent.Destination);
+    else
+      onRtpSent(sent.Packet, sent.Destination);
+  }
+#endif
+}
+
+bool IoUringRtpNetworkInterface::recv()
+{
+#ifdef ENABLE_IO_URING
+  boost::mutex::scoped_lock l(m_lock);
+  if (!m_bInitialised) return false;
+  if (!armReceive(OP_RECV_RTP) || !armReceive(OP_RECV_RTCP))
+    return false;
+  io_uring_submit(&m_ring);
+  startEventRead();
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool IoUringRtpNetworkInterface::doSendRtp(Buffer rtpBuffer, const EndPoint& rtpEp)
+{
+  boost::mutex::scoped_lock l(m_lock);
+  if (!queueSend(rtpBuffer, rtpEp, false))
+    return false;
+  scheduleSubmit();
+  return true;
+}
+
+size_t IoUringRtpNetworkInterface::doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp)
+{
+  boost::mutex::scoped_lock l(m_lock);
+  size_t uiQueued = 0;
+  while (uiQueued < vRtpBuffers.size() && queueSend(vRtpBuffers[uiQueued], rtpEp, false))
+    ++uiQueued;
+  if (uiQueued > 0)
+    scheduleSubmit();
+  return uiQueued;
+}
+
+bool IoUringRtpNetworkInterface::doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpEp)
+{
+  boost::mutex::scoped_lock l(m_lock);
+  if (!queueSend(rtcpBuffer, rtcpEp, true))
+    return false;
+  scheduleSubmit();
+  return true;
+}
+
+bool IoUringRtpNetworkInterface::queueSend(const Buffer& buffer, const EndPoint& ep, bool bRtcp)
+{
+#ifdef ENABLE_IO_URING
+  if (!m_bInitialised)
+  {
+    // only log first occurence
+    LOG_FIRST_N(INFO, 1) << "Shutting down, unable to deliver packets";
+    return false;
+  }
+  if (!ep.isResolved())
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] Unable to send to unresolved address " << ep;
+    return false;
+  }
+
+  struct io_uring_sqe* pSqe = NULL;
+  if (m_uiSendTail - m_uiSendHead == m_vSendSlots.size() || !(pSqe = getSqe(m_ring)))
+  {
+    ++m_uiDroppedPackets;
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] io_uring send ring full, dropping packet to " << ep << " Dropped: " << m_uiDroppedPackets;
+    return false;
+  }
+
+  const uint32_t uiSlot = m_uiSendTail % m_vSendSlots.size();
+  SendSlot& slot = m_vSendSlots[uiSlot];
+  slot.Packet = buffer;
+  slot.Destination = ep;
+  slot.Rtcp = bRtcp;
+  slot.Complete = false;
+  const boost::asio::ip::udp::endpoint& destination = ep.getUdpEndpoint();
+  memcpy(&slot.Address, destination.data(), destination.size());
+  slot.Iovec.iov_base = const_cast<uint8_t*>(slot.Packet.data());
+  slot.Iovec.iov_len = slot.Packet.getSize();
+  memset(&slot.Header, 0, sizeof(slot.Header));
+  slot.Header.msg_name = &slot.Address;
+  slot.Header.msg_namelen = destination.size();
+  slot.Header.msg_iov = &slot.Iovec;
+  slot.Header.msg_iovlen = 1;
+
+  io_uring_prep_sendmsg(pSqe, bRtcp ? RTCP_FILE_INDEX : RTP_FILE_INDEX, &slot.Header, 0);
+  pSqe->flags |= IOSQE_FIXED_FILE;
+  io_uring_sqe_set_data64(pSqe, (static_cast<uint64_t>(OP_SEND) << 32) | uiSlot);
+  ++m_uiSendTail;
+  return true;
+#else
+  (void)buffer;
+  (void)ep;
+  (void)bRtcp;
+  return false;
+#endif
+}
+
+void IoUringRtpNetworkInterface::scheduleSubmit()
+{
+  // the sends queued by the current handler, e.g. all packets of a sample, are submitted with one system call
+  if (!m_bSubmitPending)
+  {
+    m_bSubmitPending = true;
+    m_rIoService.post(boost::bind(&IoUringRtpNetworkInterface::submit, this));
+  }
+}
+
+void IoUringRtpNetworkInterface::submit()
+{
+#ifdef ENABLE_IO_URING
+  boost::mutex::scoped_lock l(m_lock);
+  m_bSubmitPending = false;
+  if (!m_bInitialised) return;
+  int iRes = io_uring_submit(&m_ring);
+  if (iRes < 0)
+  {
+    LOG(WARNING) << "io_uring submit failed: " << strerror(-iRes);
+  }
+#endif
+}
+
+void IoUringRtpNetworkInterface::startEventRead()
+{
+#ifdef ENABLE_IO_URING
+  m_eventDescriptor.async_read_some(boost::asio::buffer(&m_uiEventCount, sizeof(m_uiEventCount)),
+    boost::bind(&IoUringRtpNetworkInterface::handleEvent, this,
+    boost::asio::placeholders::error,
+    boost::asio::placeholders::bytes_transferred));
+#endif
+}
+
+void IoUringRtpNetworkInterface::handleEvent(const boost::system::error_code& ec, std::size_t /*bytes_transferred*/)
+{
+#ifdef ENABLE_IO_URING
+  if (ec)
+  {
+    if (ec != boost::asio::error::operation_aborted)
+      LOG(WARNING) << "Error reading io_uring eventfd: " << ec.message();
+    else
+      VLOG(10) << "Shutting down: " << ec.message();
+    return;
+  }
+
+  // copy the completions out: the callbacks below may shut the ring down
+  m_vCompletions.clear();
+  unsigned uiHead;
+  struct io_uring_cqe* pCqe;
+  io_uring_for_each_cqe(&m_ring, uiHead, pCqe)
+  {
+    m_vCompletions.push_back(*pCqe);
+  }
+  io_uring_cq_advance(&m_ring, m_vCompletions.size());
+  VLOG(15) << "[" << this << "] io_uring completions: " << m_vCompletions.size();
+
+  m_vSent.clear();
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    for (const struct io_uring_cqe& cqe : m_vCompletions)
+    {
+      if ((cqe.user_data >> 32) != OP_SEND) continue;
+      SendSlot& slot = m_vSendSlots[cqe.user_data & 0xFFFFFFFF];
+      slot.Complete = true;
+      if (cqe.res < 0)
+        LOG(WARNING) << "Send failed to " << slot.Destination << " Ec: " << strerror(-cqe.res);
+    }
+    // report the sends in the order in which they were queued
+    while (m_uiSendHead != m_uiSendTail)
+    {
+      SendSlot& slot = m_vSendSlots[m_uiSendHead % m_vSendSlots.size()];
+      if (!slot.Complete) break;
+      m_vSent.push_back(SentPacket(slot));
+      slot.Packet = Buffer();
+      slot.Complete = false;
+      ++m_uiSendHead;
+    }
+  }
+
+  bool bRearmRtp = false;
+  bool bRearmRtcp = false;
+  for (const struct io_uring_cqe& cqe : m_vCompletions)
+  {
+    if (!m_bInitialised) return;
+    Operation eOperation = static_cast<Operation>(cqe.user_data >> 32);
+    if (eOperation == OP_SEND) continue;
+
+    NetworkPacket networkPacket;
+    EndPoint ep;
+    if (handleReceive(&cqe, networkPacket, ep))
+    {
+      if (eOperation == OP_RECV_RTP)
+        processIncomingRtpPacket(networkPacket, ep);
+      else
+        processIncomingRtcpPacket(networkPacket, ep);
+    }
+    // the multishot receive terminates e.g. if no buffer was available
+    if (!(cqe.flags & IORING_CQE_F_MORE))
+    {
+      if (eOperation == OP_RECV_RTP) bRearmRtp = true;
+      else bRearmRtcp = true;
+    }
+  }
+
+  if (bRearmRtp || bRearmRtcp)
+  {
+    // re-arm once the buffers of this event have been returned to the kernel
+    boost::mutex::scoped_lock l(m_lock);
+    if (m_bInitialised && !m_bShuttingDown)
+    {
+      VLOG(10) << "[" << this << "] Re-arming multishot receive RTP: " << bRearmRtp << " RTCP: " << bRearmRtcp;
+      if (bRearmRtp) armReceive(OP_RECV_RTP);
+      if (bRearmRtcp) armReceive(OP_RECV_RTCP);
+      io_uring_submit(&m_ring);
+    }
+  }
+
+  for (const SentPacket& sent : m_vSent)
+  {
+    if (sent.Rtcp)
+      onRtcpSent(sent.Packet, sent.Destination);
+    else
+      onRtpSent(sent.Packet, sent.Destination);
+  }
+
+  if (m_bInitialised)
+    startEventRead();
+#else
+  (void)ec;
+#endif
+}
+
+#ifdef ENABLE_IO_URING
+bool IoUringRtpNetworkInterface::armReceive(Operation eOperation)
+{
+  struct io_uring_sqe* pSqe = getSqe(m_ring);
+  if (!pSqe)
+  {
+    LOG(WARNING) << "Failed to arm io_uring receive: submission queue full";
+    return false;
+  }
+  io_uring_prep_recvmsg_multishot(pSqe, eOperation == OP_RECV_RTP ? RTP_FILE_INDEX : RTCP_FILE_INDEX, &m_receiveHeader, 0);
+  pSqe->flags |= IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+  pSqe->buf_group = recv_buffer_group;
+  io_uring_sqe_set_data64(pSqe, static_cast<uint64_t>(eOperation) << 32);
+  return true;
+}
+
+bool IoUringRtpNetworkInterface::handleReceive(const struct io_uring_cqe* pCqe, NetworkPacket& networkPacket, EndPoint& ep)
+{
+  if (pCqe->res < 0)
+  {
+    if (pCqe->res == -ENOBUFS)
+      LOG_EVERY_N(WARNING, 100) << "[" << this << "] io_uring receive buffers exhausted";
+    else if (pCqe->res != -ECANCELED)
+      LOG(WARNING) << "Error in receive: " << strerror(-pCqe->res);
+    return false;
+  }
+  if (!(pCqe->flags & IORING_CQE_F_BUFFER)) return false;
+
+  const uint16_t uiBufferId = pCqe->flags >> IORING_CQE_BUFFER_SHIFT;
+  uint8_t* pBuffer = &m_vReceiveBuffers[uiBufferId * recv_buffer_size];
+  bool bValid = false;
+  struct io_uring_recvmsg_out* pOut = io_uring_recvmsg_validate(pBuffer, pCqe->res, &m_receiveHeader);
+  if (!pOut)
+  {
+    LOG(WARNING) << "Invalid io_uring recvmsg result";
+  }
+  else if (pOut->flags & MSG_TRUNC)
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] Dropping truncated datagram";
+  }
+  else
+  {
+    const uint32_t uiLength = io_uring_recvmsg_payload_length(pOut, pCqe->res, &m_receiveHeader);
+    Buffer data = BufferPool::allocate(uiLength);
+    memcpy(const_cast<uint8_t*>(data.data()), io_uring_recvmsg_payload(pOut, &m_receiveHeader), uiLength);
+    networkPacket = NetworkPacket(data, RtpTime::getNTPTimeStamp());
+
+    boost::asio::ip::udp::endpoint source;
+    const size_t uiNameLength = std::min<size_t>(std::min<size_t>(pOut->namelen, m_receiveHeader.msg_namelen), source.capacity());
+    memcpy(source.data(), io_uring_recvmsg_name(pOut), uiNameLength);
+    source.resize(uiNameLength);
+    ep = EndPoint(source);
+    VLOG(10) << "[" << this << "] Received " << uiLength << " from " << ep;
+    bValid = true;
+  }
+
+  // hand the buffer back to the kernel
+  io_uring_buf_ring_add(m_pBufferRing, pBuffer, recv_buffer_size, uiBufferId, io_uring_buf_ring_mask(recv_buffer_count), 0);
+  io_uring_buf_ring_advance(m_pBufferRing, 1);
+  return bValid;
+}
+
+void IoUringRtpNetworkInterface::drainSends(std::vector<SentPacket>& vSent)
+{
+  if (m_uiSendHead == m_uiSendTail) return;
+
+  // UDP sends complete quickly: wait for them instead of cancelling them with the ring
+  io_uring_submit(&m_ring);
+  struct __kernel_timespec timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_nsec = drain_timeout_ms * 1000 * 1000;
+  uint64_t uiOutstanding = 0;
+  for (uint64_t i = m_uiSendHead; i != m_uiSendTail; ++i)
+  {
+    if (!m_vSendSlots[i % m_vSendSlots.size()].Complete) ++uiOutstanding;
+  }
+  while (uiOutstanding > 0)
+  {
+    struct io_uring_cqe* pCqe = NULL;
+    if (io_uring_wait_cqe_timeout(&m_ring, &pCqe, &timeout) < 0)
+    {
+      VLOG(5) << "[" << this << "] " << uiOutstanding << " io_uring sends did not complete before shutdown";
+      break;
+    }
+    // receive completions are dropped: the provided buffers are released with the ring
+    if ((pCqe->user_data >> 32) == OP_SEND)
+    {
+      SendSlot& slot = m_vSendSlots[pCqe->user_data & 0xFFFFFFFF];
+      if (!slot.Complete)
+      {
+        slot.Complete = true;
+        --uiOutstanding;
+      }
+    }
+    io_uring_cqe_seen(&m_ring, pCqe);
+  }
+
+  while (m_uiSendHead != m_uiSendTail)
+  {
+    SendSlot& slot = m_vSendSlots[m_uiSendHead % m_vSendSlots.size()];
+    vSent.push_back(SentPacket(slot));
+    slot.Packet = Buffer();
+    slot.Complete = false;
+    ++m_uiSendHead;
+  }
+}
+#endif
+
+} // rtp_plus_plus
@@ -11,7 +11,8 @@ MuxedUdpRtpNetworkInterface::MuxedUdpRtpNetworkInterface(boost::asio::io_service
   m_rIoService(rIoService),
   m_bInitialised(false),
   m_bShuttingDown(false),
-  m_rtpRtcpEp(rtpRtcpEp)
+  m_rtpRtcpEp(rtpRtcpEp),
+  m_bKernelTimestamps(false)
 {
   initialise(ec);
 }
@@ -22,7 +23,8 @@ MuxedUdpRtpNetworkInterface::MuxedUdpRtpNetworkInterface(boost::asio::io_service
   m_rIoService(rIoService),
   m_bInitialised(false),
   m_bShuttingDown(false),
-  m_rtpRtcpEp(rtpRtcpEp)
+  m_rtpRtcpEp(rtpRtcpEp),
+  m_bKernelTimestamps(false)
 {
   initialiseExistingSocket(std::move(pRtpRtcpSocket));
 }
@@ -61,6 +63,14 @@ bool MuxedUdpRtpNetworkInterface::recv()
   return true;
 }
 
+bool MuxedUdpRtpNetworkInterface::setKernelTimestamps(bool bEnable)
+{
+  // store the setting so that it survives reset()
+  m_bKernelTimestamps = bEnable;
+  if (!m_pMuxedRtpSocket) return false;
+  return m_pMuxedRtpSocket->setKernelTimestamps(bEnable);
+}
+
 void MuxedUdpRtpNetworkInterface::handleMuxedRtpRtcpPacket(const boost::system::error_code& ec,
                                                            UdpSocketWrapper::ptr pSource,
                                                            NetworkPacket networkPacket,
@@ -120,8 +130,6 @@ void MuxedUdpRtpNetworkInterface::handleSentRtpRtcpPacket(const boost::system::e
                                                           Buffer buffer,
                                                           const EndPoint& ep)
 {
-  // Note: this mutex must be locked carefully to not interfere
-  // with the mutexin the UdpSocketWrapper
   PacketType eType;
   {
     boost::mutex::scoped_lock l(m_lock);
@@ -152,14 +160,16 @@ bool MuxedUdpRtpNetworkInterface::doSendRtp(Buffer rtpBuffer, const EndPoint& rt
     return false;
   }
   // we need to keep track of the packet oder in which RTP/RTCP is sent
-  // RTP and RTCP may be sent concurrently: need to lock type queue
-  // Note: this mutex must be locked carefully to not interfere
-  // with the mutexin the UdpSocketWrapper
+  // RTP and RTCP may be sent concurrently: the lock is held while queueing
+  // so that the type queue matches the order of the socket send queue
+  boost::mutex::scoped_lock l(m_lock);
+  m_qTypes.push_back(RTP_PACKET);
+  if (!m_pMuxedRtpSocket->send(rtpBuffer, rtpEp))
   {
-    boost::mutex::scoped_lock l(m_lock);
-    m_qTypes.push_back(RTP_PACKET);
+    // the packet was dropped: no send completion will be reported
+    m_qTypes.pop_back();
+    return false;
   }
-  m_pMuxedRtpSocket->send(rtpBuffer, rtpEp);
   return true;
 }
 
@@ -172,14 +182,16 @@ bool MuxedUdpRtpNetworkInterface::doSendRtcp(Buffer rtcpBuffer, const EndPoint&
     return false;
   }
   // RTP and RTCP may be sent concurrently if we are using multiple threads
-  // running the asio service: need to lock type queue
-  // Note: this mutex must be locked carefully to not interfere
-  // with the mutexin the UdpSocketWrapper
+  // running the asio service: the lock is held while queueing so that the
+  // type queue matches the order of the socket send queue
+  boost::mutex::scoped_lock l(m_lock);
+  m_qTypes.push_back(COMPOUND_RTCP_PACKET);
+  if (!m_pMuxedRtpSocket->send(rtcpBuffer, rtcpEp ))
   {
-    boost::mutex::scoped_lock l(m_lock);
-    m_qTypes.push_back(COMPOUND_RTCP_PACKET);
+    // the packet was dropped: no send completion will be reported
+    m_qTypes.pop_back();
+    return false;
   }
-  m_pMuxedRtpSocket->send(rtcpBuffer, rtcpEp );
   return true;
 }
 
@@ -201,6 +213,7 @@ void MuxedUdpRtpNetworkInterface::initialise(boost::system::error_code& ec)
                                         this, _1, _2, _3, _4));
   m_pMuxedRtpSocket->onSendComplete(boost::bind(&MuxedUdpRtpNetworkInterface::handleSentRtpRtcpPacket,
                                                 this, _1, _2, _3, _4));
+  if (m_bKernelTimestamps) m_pMuxedRtpSocket->setKernelTimestamps(true);
   LOG(INFO) << "Muxing RTP and RTCP on port " << m_rtpRtcpEp.getPort();
 
   m_bInitialised = true;
@@ -224,6 +237,7 @@ void MuxedUdpRtpNetworkInterface::initialiseExistingSocket(std::unique_ptr<boost
     this, _1, _2, _3, _4));
   m_pMuxedRtpSocket->onSendComplete(boost::bind(&MuxedUdpRtpNetworkInterface::handleSentRtpRtcpPacket,
     this, _1, _2, _3, _4));
+  if (m_bKernelTimestamps) m_pMuxedRtpSocket->setKernelTimestamps(true);
   LOG(INFO) << "Muxing RTP and RTCP on port " << m_rtpRtcpEp.getPort();
 
   m_bInitialised = true;
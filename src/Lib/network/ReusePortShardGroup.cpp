@@ -0,0 +1,102 @@
+#include "CorePch.h"
+#include <rtp++/network/ReusePortShardGroup.h>
+#include <boost/asio/socket_base.hpp>
+#include <boost/bind.hpp>
+#include <rtp++/network/MuxedUdpRtpNetworkInterface.h>
+
+namespace rtp_plus_plus
+{
+
+#ifdef ENABLE_REUSEPORT
+typedef boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
+
+std::unique_ptr<boost::asio::ip::udp::socket> ReusePortShardGroup::createReusePortSocket(boost::asio::io_service& ioService,
+                                                                                         const EndPoint& ep,
+                                                                                         boost::system::error_code& ec)
+{
+#ifdef ENABLE_REUSEPORT
+  const boost::asio::ip::udp::endpoint& endpoint = ep.getUdpEndpoint();
+  std::unique_ptr<boost::asio::ip::udp::socket> pSocket(new boost::asio::ip::udp::socket(ioService));
+  pSocket->open(endpoint.protocol(), ec);
+  if (ec) return std::unique_ptr<boost::asio::ip::udp::socket>();
+  // this needs to happen before the bind
+  pSocket->set_option(reuse_port(true), ec);
+  if (ec)
+  {
+    LOG(WARNING) << "Failed to set SO_REUSEPORT for " << ep << ": " << ec.message();
+    return std::unique_ptr<boost::asio::ip::udp::socket>();
+  }
+  pSocket->bind(endpoint, ec);
+  if (ec)
+  {
+    LOG(WARNING) << "Failed to bind SO_REUSEPORT socket to " << ep << ": " << ec.message();
+    return std::unique_ptr<boost::asio::ip::udp::socket>();
+  }
+  return pSocket;
+#else
+  LOG(WARNING) << "SO_REUSEPORT is not supported on this platform";
+  ec = boost::asio::error::operation_not_supported;
+  return std::unique_ptr<boost::asio::ip::udp::socket>();
+#endif
+}
+
+ReusePortShardGroup::ReusePortShardGroup(const EndPoint& rtpRtcpEp, uint32_t uiShards, boost::system::error_code& ec)
+  :m_rtpRtcpEp(rtpRtcpEp)
+{
+  VLOG(2) << "Creating " << uiShards << " receive shards for " << m_rtpRtcpEp;
+  for (uint32_t i = 0; i < uiShards; ++i)
+  {
+    std::unique_ptr<Shard> pShard(new Shard());
+    pShard->IoService = std::unique_ptr<boost::asio::io_service>(new boost::asio::io_service());
+    std::unique_ptr<boost::asio::ip::udp::socket> pSocket = createReusePortSocket(*pShard->IoService, m_rtpRtcpEp, ec);
+    if (ec)
+    {
+      m_vShards.clear();
+      return;
+    }
+    pShard->NetworkInterface = RtpNetworkInterface::ptr(new MuxedUdpRtpNetworkInterface(*pShard->IoService, m_rtpRtcpEp, std::move(pSocket)));
+    m_vShards.push_back(std::move(pShard));
+  }
+}
+
+ReusePortShardGroup::~ReusePortShardGroup()
+{
+  stop();
+}
+
+void ReusePortShardGroup::start()
+{
+  for (size_t i = 0; i < m_vShards.size(); ++i)
+  {
+    Shard& shard = *m_vShards[i];
+    if (shard.Thread) continue;
+    shard.Work = std::unique_ptr<boost::asio::io_service::work>(new boost::asio::io_service::work(*shard.IoService));
+    shard.NetworkInterface->recv();
+    shard.Thread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&boost::asio::io_service::run, boost::ref(*shard.IoService))));
+    VLOG(5) << "Started receive shard " << i << " for " << m_rtpRtcpEp;
+  }
+}
+
+void ReusePortShardGroup::stop()
+{
+  for (size_t i = 0; i < m_vShards.size(); ++i)
+  {
+    Shard& shard = *m_vShards[i];
+    if (!shard.Thread) continue;
+    // the socket must be closed on the shard thread
+    shard.IoService->post(boost::bind(&RtpNetworkInterface::shutdown, shard.NetworkInterface.get()));
+    shard.Work.reset();
+  }
+  for (size_t i = 0; i < m_vShards.size(); ++i)
+  {
+    Shard& shard = *m_vShards[i];
+    if (!shard.Thread) continue;
+    shard.Thread->join();
+    shard.Thread.reset();
+    shard.IoService->reset();
+    VLOG(5) << "Stopped receive shard " << i << " for " << m_rtpRtcpEp;
+  }
+}
+
+} // rtp_plus_plus
@@ -30,6 +30,7 @@ RtpForwarder::RtpForwarder(boost::asio::io_service& rIoService, const InterfaceD
                            const InterfaceDescriptions_t& host1, const InterfaceDescriptions_t& host2,
                            std::vector<NetworkProperties_t> networkProps, bool bStrict)
   :m_rIoService(rIoService),
+    m_rTimerService(boost::asio::use_service<TimerService>(rIoService)),
     m_vNetworkProperties(networkProps),
     m_uiPacketLossProbability(0),
     m_bStrict(bStrict)
@@ -55,6 +56,7 @@ RtpForwarder::RtpForwarder(boost::asio::io_service& rIoService, const InterfaceD
                            const std::vector<double>& vDelays,
                            bool bStrict)
   :m_rIoService(rIoService),
+    m_rTimerService(boost::asio::use_service<TimerService>(rIoService)),
     m_uiPacketLossProbability(uiLossProbability),
     m_vDelays(vDelays),
     m_bStrict(bStrict)
@@ -140,16 +142,16 @@ void RtpForwarder::setupRtpForwarders(const InterfaceDescriptions_t& localInterf
         AddressDescriptor rtcpAddress1 = std::get<1>(host1_descriptors[k]);
         AddressDescriptor rtpAddress2 = std::get<0>(host2_descriptors[k]);
         AddressDescriptor rtcpAddress2 = std::get<1>(host2_descriptors[k]);
-        m_map[rtpAddress1.getAddress()][rtpAddress1.getPort()] = EndPoint(rtpAddress2);
-        m_map[rtpAddress2.getAddress()][rtpAddress2.getPort()] = EndPoint(rtpAddress1);
-        m_map[rtcpAddress1.getAddress()][rtcpAddress1.getPort()] = EndPoint(rtcpAddress2);
-        m_map[rtcpAddress2.getAddress()][rtcpAddress2.getPort()] = EndPoint(rtcpAddress1);
+        m_map[EndPoint(rtpAddress1)] = EndPoint(rtpAddress2);
+        m_map[EndPoint(rtpAddress2)] = EndPoint(rtpAddress1);
+        m_map[EndPoint(rtcpAddress1)] = EndPoint(rtcpAddress2);
+        m_map[EndPoint(rtcpAddress2)] = EndPoint(rtcpAddress1);
         // network chars
         NetworkProperties_t networkProps = (j < m_vNetworkProperties.size()) ? m_vNetworkProperties[j] : std::make_tuple(0u, 0u, 0u);
-        m_networkMap[rtpAddress1.getAddress()][rtpAddress1.getPort()] = networkProps;
-        m_networkMap[rtpAddress2.getAddress()][rtpAddress2.getPort()] = networkProps;
-        m_networkMap[rtcpAddress1.getAddress()][rtcpAddress1.getPort()] = networkProps;
-        m_networkMap[rtcpAddress2.getAddress()][rtcpAddress2.getPort()] = networkProps;
+        m_networkMap[EndPoint(rtpAddress1)] = networkProps;
+        m_networkMap[EndPoint(rtpAddress2)] = networkProps;
+        m_networkMap[EndPoint(rtcpAddress1)] = networkProps;
+        m_networkMap[EndPoint(rtcpAddress2)] = networkProps;
 
       }
 
@@ -239,9 +241,8 @@ void RtpForwarder::setupUdpForwarders(const InterfaceDescriptions_t& localInterf
   }
 }
 
-void RtpForwarder::sendRtpPacket(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex )
+void RtpForwarder::sendRtpPacket(const boost::system::error_code& ec, const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex )
 {
-  delete pTimer;
   if (!ec)
   {
     // send immediately
@@ -249,9 +250,8 @@ void RtpForwarder::sendRtpPacket(const boost::system::error_code& ec, boost::asi
   }
 }
 
-void RtpForwarder::sendRtcpPacket(const boost::system::error_code& ec, boost::asio::deadline_timer* pTimer, const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep, const uint32_t uiInterfaceIndex )
+void RtpForwarder::sendRtcpPacket(const boost::system::error_code& ec, const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep, const uint32_t uiInterfaceIndex )
 {
-  delete pTimer;
   if (!ec)
   {
     // send immediately
@@ -262,8 +262,8 @@ void RtpForwarder::sendRtcpPacket(const boost::system::error_code& ec, boost::as
 void RtpForwarder::onIncomingRtp( const RtpPacket& rtpPacket, const EndPoint& ep, const uint32_t uiInterfaceIndex )
 {
   double dRtt = extractRTTFromRtpPacket(rtpPacket);
-  EndPoint& forwardTo = m_map[ep.getAddress()][ep.getPort()];
-  NetworkProperties_t& networkProps = m_networkMap[ep.getAddress()][ep.getPort()];
+  EndPoint& forwardTo = m_map[ep];
+  NetworkProperties_t& networkProps = m_networkMap[ep];
 
   LOG_EVERY_N(INFO, 100) << "Received RTP from " << ep.getAddress() << ":" << ep.getPort()
                          << " One way RTT: " << dRtt << "s Fwd: " << forwardTo.getAddress() << ":" << forwardTo.getPort();
@@ -276,13 +276,12 @@ void RtpForwarder::onIncomingRtp( const RtpPacket& rtpPacket, const EndPoint& ep
   {
     if (uiOwd + uiJitter > 0)
     {
-      boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
       // calculate random jitter value
       uint32_t uiJitterNow = rand()%uiJitter;
       double dBase = uiOwd - uiJitter/2.0;
       if (dBase < 0.0) dBase = 0.0;
-      pTimer->expires_from_now(boost::posix_time::milliseconds(static_cast<uint32_t>(dBase + uiJitterNow)));
-      pTimer->async_wait(boost::bind(&RtpForwarder::sendRtpPacket, shared_from_this(), _1, pTimer, rtpPacket, forwardTo, uiInterfaceIndex));
+      m_rTimerService.expiresFromNow(boost::posix_time::milliseconds(static_cast<uint32_t>(dBase + uiJitterNow)),
+                                     boost::bind(&RtpForwarder::sendRtpPacket, shared_from_this(), _1, rtpPacket, forwardTo, uiInterfaceIndex));
     }
     else
     {
@@ -306,18 +305,17 @@ void RtpForwarder::onOutgoingRtp( const RtpPacket& rtpPacket, const EndPoint& ep
 void RtpForwarder::onIncomingRtcp( const CompoundRtcpPacket& compoundRtcp, const EndPoint& ep, const uint32_t uiInterfaceIndex )
 {
   VLOG(1) << "Received RTCP from " << ep.getAddress() << ":" << ep.getPort() << " on interface " << uiInterfaceIndex;
-  EndPoint forwardTo = m_map[ep.getAddress()][ep.getPort()];
-  NetworkProperties_t& networkProps = m_networkMap[ep.getAddress()][ep.getPort()];
+  EndPoint forwardTo = m_map[ep];
+  NetworkProperties_t& networkProps = m_networkMap[ep];
   uint32_t uiOwd = std::get<1>(networkProps);
   uint32_t uiJitter = std::get<2>(networkProps);
 
   if (uiOwd + uiJitter > 0)
   {
-    boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
     // calculate random jitter value
     uint32_t uiJitterNow = rand()%uiJitter;
-    pTimer->expires_from_now(boost::posix_time::milliseconds(uiOwd + uiJitterNow));
-    pTimer->async_wait(boost::bind(&RtpForwarder::sendRtcpPacket, shared_from_this(), _1, pTimer, compoundRtcp, forwardTo, uiInterfaceIndex));
+    m_rTimerService.expiresFromNow(boost::posix_time::milliseconds(uiOwd + uiJitterNow),
+                                   boost::bind(&RtpForwarder::sendRtcpPacket, shared_from_this(), _1, compoundRtcp, forwardTo, uiInterfaceIndex));
   }
   else
   {
@@ -1,6 +1,8 @@
 #include "CorePch.h"
 #include <rtp++/network/RtpNetworkInterface.h>
 #include <cpputil/FileUtil.h>
+#include <rtp++/RtpTime.h>
+#include <rtp++/util/Clock.h>
 
 // #define DEBUG_RTCP
 
@@ -10,14 +12,16 @@ namespace rtp_plus_plus
 {
 
 RtpNetworkInterface::RtpNetworkInterface()
-  :m_bSecureRtp(false)
+  :m_bSecureRtp(false),
+    m_uiRtpPacketsReported(0)
 {
 
 }
 
 RtpNetworkInterface::RtpNetworkInterface(std::unique_ptr<RtpPacketiser> pPacketiser)
   :m_pRtpPacketiser(std::move(pPacketiser)),
-    m_bSecureRtp(false)
+    m_bSecureRtp(false),
+    m_uiRtpPacketsReported(0)
 {
 
 }
@@ -96,11 +100,35 @@ bool RtpNetworkInterface::send(const RtpPacket& rtpPacket, const EndPoint& desti
   // TODO: could estimate the incoming framerate here: this would be useful when needing to fragment a frame over multiple RTP packets
 
   // we need to keep track of the packet oder in which RTP/RTCP is sent
+  uint64_t uiPosition = 0;
   {
     boost::mutex::scoped_lock l(m_lock);
+    uiPosition = m_uiRtpPacketsReported + m_qRtp.size();
     m_qRtp.push_back(rtpPacket);
   }
 
+  if (!packetiseAndSendRtp(rtpPacket, destination))
+  {
+    // the packet was not queued: onRtpSent will not be called for it
+    boost::mutex::scoped_lock l(m_lock);
+    eraseUnsentRtp(uiPosition, 1);
+    return false;
+  }
+  return true;
+}
+
+void RtpNetworkInterface::eraseUnsentRtp(uint64_t uiPosition, size_t uiCount)
+{
+  // other threads may have queued packets behind the unsent ones in the meantime
+  // and completions pop from the front: locate the unsent packets by position
+  assert(uiPosition >= m_uiRtpPacketsReported);
+  assert(uiPosition - m_uiRtpPacketsReported + uiCount <= m_qRtp.size());
+  std::deque<RtpPacket>::iterator it = m_qRtp.begin() + static_cast<size_t>(uiPosition - m_uiRtpPacketsReported);
+  m_qRtp.erase(it, it + uiCount);
+}
+
+bool RtpNetworkInterface::packetiseAndSendRtp(const RtpPacket& rtpPacket, const EndPoint& destination)
+{
 #if 1
   VLOG(15) << "RTP sending SN: " << rtpPacket.getSequenceNumber()
            << " TS: " << rtpPacket.getRtpTimestamp()
@@ -160,7 +188,67 @@ bool RtpNetworkInterface::send(const RtpPacket& rtpPacket, const EndPoint& desti
   }
 }
 
+bool RtpNetworkInterface::send(const std::vector<RtpPacket>& rtpPackets, const EndPoint& destination)
+{
+  if (m_bSecureRtp)
+  {
+    // SRTP protection is applied per packet
+    bool bSuccess = true;
+    for (const RtpPacket& rtpPacket : rtpPackets)
+    {
+      if (!send(rtpPacket, destination))
+        bSuccess = false;
+    }
+    return bSuccess;
+  }
+
+  // we need to keep track of the packet oder in which RTP/RTCP is sent
+  uint64_t uiPosition = 0;
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    uiPosition = m_uiRtpPacketsReported + m_qRtp.size();
+    m_qRtp.insert(m_qRtp.end(), rtpPackets.begin(), rtpPackets.end());
+  }
+
+  std::vector<Buffer> vRtpBuffers;
+  vRtpBuffers.reserve(rtpPackets.size());
+  for (const RtpPacket& rtpPacket : rtpPackets)
+  {
+    VLOG(15) << "RTP sending SN: " << rtpPacket.getSequenceNumber()
+             << " TS: " << rtpPacket.getRtpTimestamp()
+             << " to " << destination;
+    vRtpBuffers.push_back(m_pRtpPacketiser->packetise(rtpPacket));
+#ifdef RTP_DEBUG
+    m_rtpDump.dumpRtp(vRtpBuffers.back());
+#endif
+  }
+  size_t uiQueued = doSendRtpBatch(vRtpBuffers, destination);
+  if (uiQueued < rtpPackets.size())
+  {
+    // the remaining packets were not queued: onRtpSent will not be called for them
+    boost::mutex::scoped_lock l(m_lock);
+    eraseUnsentRtp(uiPosition + uiQueued, rtpPackets.size() - uiQueued);
+    return false;
+  }
+  return true;
+}
+
+size_t RtpNetworkInterface::doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp)
+{
+  for (size_t i = 0; i < vRtpBuffers.size(); ++i)
+  {
+    if (!doSendRtp(vRtpBuffers[i], rtpEp))
+      return i;
+  }
+  return vRtpBuffers.size();
+}
+
 bool RtpNetworkInterface::send(const CompoundRtcpPacket& compoundPacket, const EndPoint& destination)
+{
+  return send(compoundPacket, Buffer(), destination);
+}
+
+bool RtpNetworkInterface::send(const CompoundRtcpPacket& compoundPacket, const Buffer& feedback, const EndPoint& destination)
 {
 #ifdef RTCP_STRICT
   if (!m_pRtpPacketiser->validate(compoundPacket))
@@ -175,9 +263,21 @@ bool RtpNetworkInterface::send(const CompoundRtcpPacket& compoundPacket, const E
     m_qRtcp.push_back(compoundPacket);
   }
 
+  if (!packetiseAndSendRtcp(compoundPacket, feedback, destination))
+  {
+    // the packet was not queued: onRtcpSent will not be called for it
+    boost::mutex::scoped_lock l(m_rtcplock);
+    m_qRtcp.pop_back();
+    return false;
+  }
+  return true;
+}
+
+bool RtpNetworkInterface::packetiseAndSendRtcp(const CompoundRtcpPacket& compoundPacket, const Buffer& feedback, const EndPoint& destination)
+{
   if (m_bSecureRtp)
   {
-    Buffer rtcpBuffer = m_pRtpPacketiser->packetise(compoundPacket, 1460);
+    Buffer rtcpBuffer = m_pRtpPacketiser->packetise(compoundPacket, feedback, 1460);
     // send the packet using the networking interface
     // TODO: how to handle MTU etc?!?
     // TODO: payload packetiser MTU needs to be adapted?!?
@@ -214,7 +314,7 @@ bool RtpNetworkInterface::send(const CompoundRtcpPacket& compoundPacket, const E
   }
   else
   {
-    Buffer rtcpBuffer = m_pRtpPacketiser->packetise(compoundPacket);
+    Buffer rtcpBuffer = m_pRtpPacketiser->packetise(compoundPacket, feedback);
     return doSendRtcp(rtcpBuffer, destination);
   }
 }
@@ -230,6 +330,7 @@ void RtpNetworkInterface::onRtpSent(Buffer buffer, const EndPoint& ep)
   const RtpPacket& rtpPacket = m_qRtp.front();
   if (m_outgoingRtp) m_outgoingRtp(rtpPacket, ep);
   m_qRtp.pop_front();
+  ++m_uiRtpPacketsReported;
 }
 
 void RtpNetworkInterface::onRtcpSent(Buffer buffer, const EndPoint& ep)
@@ -250,8 +351,12 @@ void RtpNetworkInterface::processIncomingRtpPacket(NetworkPacket networkPacket,
   boost::optional<RtpPacket> rtpPacket = m_pRtpPacketiser->depacketise(networkPacket);
   if (rtpPacket)
   {
-    boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+    // the arrival time is stamped by the socket layer, possibly by the kernel: avoid a second clock read
+    int64_t iNowNs = (networkPacket.getNtpArrivalTime() != 0)
+        ? RtpTime::convertNtpTimestampToUnixNs(networkPacket.getNtpArrivalTime())
+        : Clock::realtimeNs();
 #ifdef MEASURE_RTP_INTERARRIVAL_TIME
+    boost::posix_time::ptime tNow = Clock::toPosixTime(iNowNs);
     if (!m_tPreviousArrival.is_not_a_date_time())
     {
       VLOG(10) << "[" << this << "] Difference: " << (tNow - m_tPreviousArrival).total_milliseconds() << " ms";
@@ -260,7 +365,7 @@ void RtpNetworkInterface::processIncomingRtpPacket(NetworkPacket networkPacket,
 #endif
 
     // Set RTP arrival time: this is needed for jitter calculations
-    rtpPacket->setArrivalTime(tNow);
+    rtpPacket->setArrivalTimeNs(iNowNs);
     rtpPacket->setSource(ep);
 
 #ifdef DEBUG_RTP
@@ -287,8 +392,15 @@ void RtpNetworkInterface::processIncomingRtcpPacket(NetworkPacket networkPacket,
 #endif
 
   // parse RTCP packet
-  CompoundRtcpPacket compoundPacket =  m_pRtpPacketiser->depacketiseRtcp(networkPacket);
-  if (compoundPacket.empty())
+  uint32_t uiFeedbackCount = 0;
+  CompoundRtcpPacket compoundPacket = m_incomingFb
+      ? m_pRtpPacketiser->depacketiseRtcp(networkPacket, [this, &ep, &uiFeedbackCount](const RtcpFbView& fb)
+        {
+          ++uiFeedbackCount;
+          m_incomingFb(fb, ep);
+        })
+      : m_pRtpPacketiser->depacketiseRtcp(networkPacket);
+  if (compoundPacket.empty() && uiFeedbackCount == 0)
   {
     LOG(WARNING) << "Failed to parse RCTP packet";
     static int iRtcpErrorFile = 0;
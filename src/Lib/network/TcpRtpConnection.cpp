@@ -1,11 +1,12 @@
 #include "CorePch.h"
 #include <rtp++/network/TcpRtpConnection.h>
+#include <algorithm>
 #include <boost/bind.hpp>
 #include <boost/asio/ip/multicast.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/make_shared.hpp>
-#include <cpputil/OBitStream.h>
+#include <boost/thread/thread.hpp>
 #include <rtp++/RtpTime.h>
 #include <rtp++/network/NetworkPacket.h>
 
@@ -30,8 +31,14 @@ TcpRtpConnection::TcpRtpConnection(boost::asio::io_service& ioService)
   :m_rIoService(ioService),
   m_timer(ioService),
   m_socket(m_rIoService),
-  m_bConnectionInProgress(false)
+  m_bConnectionInProgress(false),
+  m_bWritePending(false),
+  m_sendQueue(send_queue_capacity),
+  m_uiQueued(0),
+  m_uiWriteCount(0),
+  m_uiDroppedPackets(0)
 {
+  m_vGatherBuffers.reserve(2 * max_gather_packets);
   VLOG(2) << "TcpRtpConnection constructor";
 }
 
@@ -52,8 +59,14 @@ TcpRtpConnection::TcpRtpConnection(boost::asio::io_service& ioService, const std
 #else
   m_socket(m_rIoService),
 #endif
-  m_bConnectionInProgress(false)
+  m_bConnectionInProgress(false),
+  m_bWritePending(false),
+  m_sendQueue(send_queue_capacity),
+  m_uiQueued(0),
+  m_uiWriteCount(0),
+  m_uiDroppedPackets(0)
 {
+  m_vGatherBuffers.reserve(2 * max_gather_packets);
   initialise();
   VLOG(2) << "TcpRtpConnection constructor: socket bound to " << sBindIp << ":" << uiBindPort;
 }
@@ -122,25 +135,12 @@ void TcpRtpConnection::handleConnect( const boost::system::error_code& error, tc
     m_bConnectionInProgress = false;
     // start read
     start();
-    // check for queued writes
-     // send next sample if one was queued in the meantime
-    if ( !m_vDeliveryQueue.empty() )
+    // check for writes queued while connecting
+    if (m_bWritePending)
     {
-#if 0
-      DLOG(INFO) << "Sending queued packet Queue size: " << m_vDeliveryQueue.size();
-#endif
-      NetworkPackage_t package = m_vDeliveryQueue.front();
-      Buffer networkPacket = package.first;
-      EndPoint ep = package.second;
-      boost::asio::async_write( m_socket,
-        boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
-        boost::bind(&TcpRtpConnection::writeCompletionHandler,
-        shared_from_this(),
-        boost::asio::placeholders::error,
-        boost::asio::placeholders::bytes_transferred)
-        );
+      m_bWritePending = false;
+      startWrite();
     }
-
   }
   else
   {
@@ -170,36 +170,71 @@ void TcpRtpConnection::handleConnect( const boost::system::error_code& error, tc
   }
 }
 
-void TcpRtpConnection::send(Buffer networkPacket, const EndPoint& endpoint)
+bool TcpRtpConnection::send(Buffer networkPacket, const EndPoint& endpoint)
 {
   VLOG(10) << "Outgoing data packet of size " << networkPacket.getSize();
-  // prepend size for TCP framing
-  Buffer newBuffer(new uint8_t[networkPacket.getSize() + 2], networkPacket.getSize() + 2);
-  OBitStream out(newBuffer);
-  uint16_t uiSize = networkPacket.getSize();
-  out.write(uiSize, 16);
-
-  const uint8_t* pDest = networkPacket.data();
-  out.writeBytes(pDest, uiSize);
-
-  boost::mutex::scoped_lock l(m_lock);
-  bool bBusyWriting = !m_vDeliveryQueue.empty();
-  m_vDeliveryQueue.push_back( std::make_pair(newBuffer, endpoint) );
-  if (!m_bConnectionInProgress && !bBusyWriting)
+  if (networkPacket.getSize() > max_frame_size)
   {
-    boost::asio::async_write(m_socket, boost::asio::buffer(newBuffer.data(), newBuffer.getSize()),
-      boost::bind(&TcpRtpConnection::writeCompletionHandler,
-      shared_from_this(),
-      boost::asio::placeholders::error,
-      boost::asio::placeholders::bytes_transferred)
-      );
+    ++m_uiDroppedPackets;
+    LOG(WARNING) << "[" << this << "] Packet of size " << networkPacket.getSize() << " exceeds the RFC 4571 frame size, dropping packet";
+    return false;
+  }
+
+  // the length prefix is written from the queue slot: no copy of the packet is needed for TCP framing
+  if (!m_sendQueue.push(NetworkPackage(networkPacket, endpoint)))
+  {
+    uint64_t uiDropped = ++m_uiDroppedPackets;
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] Send queue full, dropping packet to " << endpoint << " Dropped: " << uiDropped;
+    return false;
+  }
+  // the thread that moves the count away from 0 starts the write chain on the io service thread
+  if (m_uiQueued.fetch_add(1) == 0)
+  {
+    m_rIoService.post(boost::bind(&TcpRtpConnection::startWrite, shared_from_this()));
   }
   else
   {
-#if 1
-    VLOG(10) << "Packet queued, connection or write in progress";
-#endif
+    VLOG(10) << "Packet queued, write in progress";
   }
+  return true;
+}
+
+void TcpRtpConnection::startWrite()
+{
+  if (m_bConnectionInProgress)
+  {
+    VLOG(10) << "Packet queued, connection in progress";
+    m_bWritePending = true;
+    return;
+  }
+
+  // the packet is counted but its producer may not have published it yet
+  NetworkPackage* pPackage = m_sendQueue.front();
+  while (!pPackage)
+  {
+    boost::this_thread::yield();
+    pPackage = m_sendQueue.front();
+  }
+
+  // coalesce all published packets into one gather write
+  size_t uiQueued = std::min<size_t>(m_uiQueued.load(), max_gather_packets);
+  m_vGatherBuffers.clear();
+  m_uiWriteCount = 0;
+  while (pPackage)
+  {
+    m_vGatherBuffers.push_back(boost::asio::buffer(pPackage->Prefix, sizeof(pPackage->Prefix)));
+    m_vGatherBuffers.push_back(boost::asio::buffer(pPackage->Packet.data(), pPackage->Packet.getSize()));
+    ++m_uiWriteCount;
+    pPackage = (m_uiWriteCount < uiQueued) ? m_sendQueue.peek(m_uiWriteCount) : NULL;
+  }
+  VLOG(10) << "Writing " << m_uiWriteCount << " packets";
+
+  boost::asio::async_write(m_socket, m_vGatherBuffers,
+    boost::bind(&TcpRtpConnection::writeCompletionHandler,
+    shared_from_this(),
+    boost::asio::placeholders::error,
+    boost::asio::placeholders::bytes_transferred)
+    );
 }
 
 void TcpRtpConnection::close()
@@ -234,8 +269,6 @@ void TcpRtpConnection::initialise()
 
 void TcpRtpConnection::writeCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_transferred)
 {
-  boost::mutex::scoped_lock l(m_lock);
-
 #ifdef LOG_TCP_INFO
   /* Fill tcp_info structure with data */
   uint32_t tcp_info_length = sizeof(tcp_info);
@@ -279,38 +312,33 @@ void TcpRtpConnection::writeCompletionHandler(const boost::system::error_code& e
   }
 #endif
 
-  NetworkPackage_t package = m_vDeliveryQueue.front();
-  m_vDeliveryQueue.pop_front();
-  if (m_fnOnSend)
+  if (!ec)
   {
-    m_fnOnSend(ec, shared_from_this(), package.first, package.second);
+      VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Sent " << bytes_transferred << " in " << m_uiWriteCount << " packets";
   }
-
-  if (!ec)
+  else
   {
-      VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Sent " << bytes_transferred << " to " << package.second.getAddress() << ":" << package.second.getPort();
+    LOG(WARNING) << "Send failed: " << ec.message();
+  }
 
-    // send next sample if one was queued in the meantime
-    if ( !m_vDeliveryQueue.empty() )
+  // report the packets of the gather write in order
+  size_t uiWritten = m_uiWriteCount;
+  m_uiWriteCount = 0;
+  m_vGatherBuffers.clear();
+  for (size_t i = 0; i < uiWritten; ++i)
+  {
+    NetworkPackage package = *m_sendQueue.front();
+    m_sendQueue.pop();
+    if (m_fnOnSend)
     {
-#if 0
-      DLOG(INFO) << "Sending queued packet Queue size: " << m_vDeliveryQueue.size();
-#endif
-      NetworkPackage_t package = m_vDeliveryQueue.front();
-      Buffer networkPacket = package.first;
-      EndPoint ep = package.second;
-      boost::asio::async_write( m_socket,
-        boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
-        boost::bind(&TcpRtpConnection::writeCompletionHandler,
-        shared_from_this(),
-        boost::asio::placeholders::error,
-        boost::asio::placeholders::bytes_transferred)
-        );
+      m_fnOnSend(ec, shared_from_this(), package.Packet, package.Destination);
     }
   }
-  else
+
+  // send next packets if some were queued in the meantime
+  if (m_uiQueued.fetch_sub(uiWritten) > uiWritten)
   {
-    LOG(WARNING) << "Send failed: " << ec.message();
+    startWrite();
   }
 }
 
@@ -6,6 +6,7 @@
 #include <boost/asio/placeholders.hpp>
 #include <boost/make_shared.hpp>
 #include <rtp++/RtpTime.h>
+#include <rtp++/util/BufferPool.h>
 
 namespace rtp_plus_plus
 {
@@ -97,12 +98,17 @@ UdpForwarder::UdpForwarder(boost::asio::io_service& ioService,
 
 void UdpForwarder::send(Buffer networkPacket, const EndPoint& endpoint)
 {
+  if (!endpoint.isResolved())
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "] Unable to forward to unresolved address " << endpoint;
+    return;
+  }
   boost::mutex::scoped_lock l(m_lock);
   bool bBusyWriting = !m_vDeliveryQueue.empty();
   m_vDeliveryQueue.push_back( std::make_pair(networkPacket, endpoint) );
   if (!bBusyWriting)
   {
-    boost::asio::ip::udp::endpoint destination(boost::asio::ip::address::from_string(endpoint.getAddress()), endpoint.getPort());
+    const boost::asio::ip::udp::endpoint& destination = endpoint.getUdpEndpoint();
     m_socket.async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
                             destination,
                             boost::bind(&UdpForwarder::writeCompletionHandler,
@@ -220,7 +226,7 @@ void UdpForwarder::writeCompletionHandler(const boost::system::error_code& ec, s
       NetworkPackage_t package = m_vDeliveryQueue.front();
       Buffer networkPacket = package.first;
       EndPoint ep = package.second;
-      boost::asio::ip::udp::endpoint endPoint(boost::asio::ip::address::from_string(ep.getAddress()), ep.getPort());
+      const boost::asio::ip::udp::endpoint& endPoint = ep.getUdpEndpoint();
       m_socket.async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
                               endPoint,
                               boost::bind(&UdpForwarder::writeCompletionHandler,
@@ -262,91 +268,68 @@ void UdpForwarder::readCompletionHandler(const boost::system::error_code& ec, st
     uint32_t uiRand = rand()%100;
     if (uiRand >= m_uiPacketLossProbability)
     {
-      uint8_t* pData = new uint8_t[bytes_received];
-      memcpy(pData, m_data, bytes_received);
-      Buffer networkPacket;
-      networkPacket.setData(pData, bytes_received);
-      ep.setAddress(m_lastSenderEndpoint.address().to_string());
-      ep.setPort(m_lastSenderEndpoint.port());
+      Buffer networkPacket = BufferPool::allocate(bytes_received);
+      memcpy(const_cast<uint8_t*>(networkPacket.data()), m_data, bytes_received);
+      ep = EndPoint(m_lastSenderEndpoint);
       // check if the packet is from an unknown source???
-      auto it = m_map.find(ep.getAddress());
+      auto it = m_map.find(ep);
       if (it == m_map.end())
       {
         LOG(WARNING) << m_sIpAddress << ":" << m_uiPort << " Packet from unknown source: " << ep;
         for (auto& it: m_map)
         {
-          for (auto& it2: it.second)
-          {
-            VLOG(2) << "FWD MAP INFO IP: " << it.first << ":" << it2.first << " " << it2.second;
-          }
+          VLOG(2) << "FWD MAP INFO IP: " << it.first << " " << it.second;
         }
         recv();
         return;
       }
       else
       {
-        auto it2 = it->second.find(ep.getPort());
-        if (it2 == it->second.end() )
+        EndPoint forwardTo = it->second;
+        if (m_bUseJitter)
         {
-          LOG(WARNING) << m_sIpAddress << ":" << m_uiPort << " Packet from unknown source port: " << ep;
-          for (auto& it: m_map)
+          if (m_uiOwdMs + m_uiJitterMs > 0)
           {
-            for (auto& it2: it.second)
+            // send packet delayed
+            boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
+            // calculate random jitter value
+            uint32_t uiWait = m_uiOwdMs;
+            if (m_uiJitterMs)
             {
-              VLOG(2) << "FWD MAP INFO IP: " << it.first << ":" << it2.first << " " << it2.second;
+              uint32_t uiJitter = rand()%m_uiJitterMs;
+              double dBase = static_cast<double>(m_uiOwdMs);
+              dBase -= m_uiJitterMs/2.0;
+              if (dBase < 0.0) dBase = 0.0;
+              uiWait = static_cast<uint32_t>(dBase + uiJitter);
             }
+            pTimer->expires_from_now(boost::posix_time::milliseconds(uiWait));
+            pTimer->async_wait(boost::bind(&UdpForwarder::sendPacketDelayed, shared_from_this(), _1, pTimer, networkPacket, forwardTo));
+            m_mTimers.insert(std::make_pair(pTimer, pTimer));
+          }
+          else
+          {
+            // send packet immediately
+            send(networkPacket, forwardTo);
           }
-          recv();
-          return;
         }
         else
         {
-          EndPoint forwardTo = m_map[ep.getAddress()][ep.getPort()];
-          if (m_bUseJitter)
+          if (!m_vDelays.empty())
           {
-            if (m_uiOwdMs + m_uiJitterMs > 0)
-            {
-              // send packet delayed
-              boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
-              // calculate random jitter value
-              uint32_t uiWait = m_uiOwdMs;
-              if (m_uiJitterMs)
-              {
-                uint32_t uiJitter = rand()%m_uiJitterMs;
-                double dBase = static_cast<double>(m_uiOwdMs);
-                dBase -= m_uiJitterMs/2.0;
-                if (dBase < 0.0) dBase = 0.0;
-                uiWait = static_cast<uint32_t>(dBase + uiJitter);
-              }
-              pTimer->expires_from_now(boost::posix_time::milliseconds(uiWait));
-              pTimer->async_wait(boost::bind(&UdpForwarder::sendPacketDelayed, shared_from_this(), _1, pTimer, networkPacket, forwardTo));
-              m_mTimers.insert(std::make_pair(pTimer, pTimer));
-            }
-            else
-            {
-              // send packet immediately
-              send(networkPacket, forwardTo);
-            }
+            uint32_t uiDelayMs = static_cast<uint32_t>(m_vDelays[m_uiDelayIndex] * 1000 + 0.5);
+
+            // send packet delayed
+            boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
+            pTimer->expires_from_now(boost::posix_time::milliseconds(uiDelayMs));
+            pTimer->async_wait(boost::bind(&UdpForwarder::sendPacketDelayed, shared_from_this(), _1, pTimer, networkPacket, forwardTo));
+            m_mTimers.insert(std::make_pair(pTimer, pTimer));
+
+            m_uiDelayIndex = (m_uiDelayIndex + 1) % m_vDelays.size();
           }
           else
           {
-            if (!m_vDelays.empty())
-            {
-              uint32_t uiDelayMs = static_cast<uint32_t>(m_vDelays[m_uiDelayIndex] * 1000 + 0.5);
-
-              // send packet delayed
-              boost::asio::deadline_timer* pTimer = new boost::asio::deadline_timer(m_rIoService);
-              pTimer->expires_from_now(boost::posix_time::milliseconds(uiDelayMs));
-              pTimer->async_wait(boost::bind(&UdpForwarder::sendPacketDelayed, shared_from_this(), _1, pTimer, networkPacket, forwardTo));
-              m_mTimers.insert(std::make_pair(pTimer, pTimer));
-
-              m_uiDelayIndex = (m_uiDelayIndex + 1) % m_vDelays.size();
-            }
-            else
-            {
-              // send packet immediately
-              send(networkPacket, forwardTo);
-            }
+            // send packet immediately
+            send(networkPacket, forwardTo);
           }
         }
       }
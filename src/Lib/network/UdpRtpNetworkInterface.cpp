@@ -17,7 +17,11 @@ UdpRtpNetworkInterface::UdpRtpNetworkInterface(boost::asio::io_service& rIoServi
   m_bInitialised(false),
   m_bShuttingDown(false),
   m_rtpEp(rtpEp),
-  m_rtcpEp(rtcpEp)
+  m_rtcpEp(rtcpEp),
+  m_uiReceiveBatchSize(0),
+  m_uiSendBatchSize(0),
+  m_bSegmentationOffload(false),
+  m_bKernelTimestamps(false)
 #ifdef RTP_DEBUG
   ,m_rtpDump("dump.rtp")
 #endif
@@ -32,7 +36,11 @@ UdpRtpNetworkInterface::UdpRtpNetworkInterface(boost::asio::io_service& rIoServi
   m_bInitialised(false),
   m_bShuttingDown(false),
   m_rtpEp(rtpEp),
-  m_rtcpEp(rtcpEp)
+  m_rtcpEp(rtcpEp),
+  m_uiReceiveBatchSize(0),
+  m_uiSendBatchSize(0),
+  m_bSegmentationOffload(false),
+  m_bKernelTimestamps(false)
 #ifdef RTP_DEBUG
   , m_rtpDump("dump.rtp")
 #endif
@@ -51,6 +59,11 @@ void UdpRtpNetworkInterface::initialise(boost::system::error_code& ec)
   m_pRtpSocket = UdpSocketWrapper::create(m_rIoService, m_rtpEp.getAddress(), m_rtpEp.getPort(), ec);
   if (ec) return;
   m_pRtpSocket->onRecv(boost::bind(&UdpRtpNetworkInterface::handleRtpPacket, this, _1, _2, _3, _4));
+  m_pRtpSocket->onRecvBatch(boost::bind(&UdpRtpNetworkInterface::handleRtpPackets, this, _1, _2, _3));
+  m_pRtpSocket->setReceiveBatchSize(m_uiReceiveBatchSize);
+  m_pRtpSocket->setSendBatchSize(m_uiSendBatchSize);
+  m_pRtpSocket->setSegmentationOffload(m_bSegmentationOffload);
+  if (m_bKernelTimestamps) m_pRtpSocket->setKernelTimestamps(true);
   m_pRtpSocket->onSendComplete(boost::bind(&UdpRtpNetworkInterface::handleSentRtpPacket, this, _1, _2, _3, _4));
   // This check should be sufficient
   assert (m_rtpEp.getPort() != m_rtcpEp.getPort());
@@ -60,6 +73,7 @@ void UdpRtpNetworkInterface::initialise(boost::system::error_code& ec)
   if (ec) return;
   m_pRtcpSocket->onRecv(boost::bind(&UdpRtpNetworkInterface::handleRtcpPacket, this, _1, _2, _3, _4));
   m_pRtcpSocket->onSendComplete(boost::bind(&UdpRtpNetworkInterface::handleSentRtcpPacket, this, _1, _2, _3, _4));
+  if (m_bKernelTimestamps) m_pRtcpSocket->setKernelTimestamps(true);
 
   m_bInitialised = true;
   m_bShuttingDown = false;
@@ -113,6 +127,11 @@ void UdpRtpNetworkInterface::initialiseExistingSockets(std::unique_ptr<boost::as
   VLOG(5) << "Using existing RTP socket " << m_rtpEp;
   m_pRtpSocket = UdpSocketWrapper::create(m_rIoService, m_rtpEp.getAddress(), m_rtpEp.getPort(), std::move(pRtpSocket));
   m_pRtpSocket->onRecv(boost::bind(&UdpRtpNetworkInterface::handleRtpPacket, this, _1, _2, _3, _4));
+  m_pRtpSocket->onRecvBatch(boost::bind(&UdpRtpNetworkInterface::handleRtpPackets, this, _1, _2, _3));
+  m_pRtpSocket->setReceiveBatchSize(m_uiReceiveBatchSize);
+  m_pRtpSocket->setSendBatchSize(m_uiSendBatchSize);
+  m_pRtpSocket->setSegmentationOffload(m_bSegmentationOffload);
+  if (m_bKernelTimestamps) m_pRtpSocket->setKernelTimestamps(true);
   m_pRtpSocket->onSendComplete(boost::bind(&UdpRtpNetworkInterface::handleSentRtpPacket, this, _1, _2, _3, _4));
   // This check should be sufficient
   assert(m_rtpEp.getPort() != m_rtcpEp.getPort());
@@ -121,6 +140,7 @@ void UdpRtpNetworkInterface::initialiseExistingSockets(std::unique_ptr<boost::as
   m_pRtcpSocket = UdpSocketWrapper::create(m_rIoService, m_rtcpEp.getAddress(), m_rtcpEp.getPort(), std::move(pRtcpSocket));
   m_pRtcpSocket->onRecv(boost::bind(&UdpRtpNetworkInterface::handleRtcpPacket, this, _1, _2, _3, _4));
   m_pRtcpSocket->onSendComplete(boost::bind(&UdpRtpNetworkInterface::handleSentRtcpPacket, this, _1, _2, _3, _4));
+  if (m_bKernelTimestamps) m_pRtcpSocket->setKernelTimestamps(true);
 
   m_bInitialised = true;
   m_bShuttingDown = false;
@@ -159,6 +179,33 @@ bool UdpRtpNetworkInterface::recv()
   return true;
 }
 
+bool UdpRtpNetworkInterface::setReceiveBatchSize(uint32_t uiBatchSize)
+{
+  // store the setting so that it survives reset()
+  m_uiReceiveBatchSize = uiBatchSize;
+  if (!m_pRtpSocket) return false;
+  return m_pRtpSocket->setReceiveBatchSize(uiBatchSize);
+}
+
+bool UdpRtpNetworkInterface::setSendBatchSize(uint32_t uiBatchSize, bool bSegmentationOffload)
+{
+  // store the setting so that it survives reset()
+  m_uiSendBatchSize = uiBatchSize;
+  m_bSegmentationOffload = bSegmentationOffload;
+  if (!m_pRtpSocket) return false;
+  if (!m_pRtpSocket->setSendBatchSize(uiBatchSize)) return false;
+  if (bSegmentationOffload && !m_pRtpSocket->setSegmentationOffload(true)) return false;
+  return true;
+}
+
+bool UdpRtpNetworkInterface::setKernelTimestamps(bool bEnable)
+{
+  // store the setting so that it survives reset()
+  m_bKernelTimestamps = bEnable;
+  if (!m_pRtpSocket || !m_pRtcpSocket) return false;
+  return m_pRtpSocket->setKernelTimestamps(bEnable) && m_pRtcpSocket->setKernelTimestamps(bEnable);
+}
+
 bool UdpRtpNetworkInterface::doSendRtp(Buffer rtpBuffer, const EndPoint& rtpEp)
 {
   if (!m_bInitialised)
@@ -172,8 +219,20 @@ bool UdpRtpNetworkInterface::doSendRtp(Buffer rtpBuffer, const EndPoint& rtpEp)
   LOG_FIRST_N(INFO, 1) << "Sending 1st RTP packet";
 #endif
 
-  m_pRtpSocket->send(rtpBuffer, rtpEp);
-  return true;
+  return m_pRtpSocket->send(rtpBuffer, rtpEp);
+}
+
+size_t UdpRtpNetworkInterface::doSendRtpBatch(const std::vector<Buffer>& vRtpBuffers, const EndPoint& rtpEp)
+{
+  if (!m_bInitialised)
+  {
+    // only log first occurence
+    LOG_FIRST_N(INFO, 1) << "Shutting down, unable to deliver RTP packets";
+    return 0;
+  }
+
+  // the socket queues either all or none of the packets
+  return m_pRtpSocket->send(vRtpBuffers, rtpEp) ? vRtpBuffers.size() : 0;
 }
 
 bool UdpRtpNetworkInterface::doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpEp)
@@ -189,8 +248,7 @@ bool UdpRtpNetworkInterface::doSendRtcp(Buffer rtcpBuffer, const EndPoint& rtcpE
   LOG_FIRST_N(INFO, 1) << "Sending 1st RTCP packet";
 #endif
 
-  m_pRtcpSocket->send(rtcpBuffer, rtcpEp );
-  return true;
+  return m_pRtcpSocket->send(rtcpBuffer, rtcpEp );
 }
 
 void UdpRtpNetworkInterface::handleRtpPacket(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, NetworkPacket networkPacket, const EndPoint& ep)
@@ -205,24 +263,48 @@ void UdpRtpNetworkInterface::handleRtpPacket(const boost::system::error_code& ec
   }
   else
   {
-#ifdef _WIN32
-    // http://stackoverflow.com/questions/13995830/windows-boost-asio-10061-in-async-receive-from-on-on-async-send-to
-    if (ec == boost::asio::error::connection_refused || ec == boost::asio::error::connection_reset)
-    {
-      VLOG(10) << "WIN32 Error in receive: " << ec.message();
-      // just start next read
-      pSource->recv();
-      return;
-    }
+    handleRtpReceiveError(ec, pSource);
+  }
+}
+
+void UdpRtpNetworkInterface::handleRtpPackets(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, const UdpSocketWrapper::NetworkPacketBatch_t& vPackets)
+{
+#ifdef DEBUG_INCOMING_RTP
+  LOG_EVERY_N(INFO, 100) << "[" << this << "] Read  " << google::COUNTER << "RTP packet batches";
 #endif
-    if (ec != boost::asio::error::operation_aborted)
-    {
-      LOG(WARNING) << "Error in receive: " << ec.message();
-    }
-    else
+  if (!ec)
+  {
+    for (const std::pair<NetworkPacket, EndPoint>& packet : vPackets)
     {
-      VLOG(10) << "Shutting down: " << ec.message();
+      processIncomingRtpPacket(packet.first, packet.second);
     }
+    pSource->recv();
+  }
+  else
+  {
+    handleRtpReceiveError(ec, pSource);
+  }
+}
+
+void UdpRtpNetworkInterface::handleRtpReceiveError(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource)
+{
+#ifdef _WIN32
+  // http://stackoverflow.com/questions/13995830/windows-boost-asio-10061-in-async-receive-from-on-on-async-send-to
+  if (ec == boost::asio::error::connection_refused || ec == boost::asio::error::connection_reset)
+  {
+    VLOG(10) << "WIN32 Error in receive: " << ec.message();
+    // just start next read
+    pSource->recv();
+    return;
+  }
+#endif
+  if (ec != boost::asio::error::operation_aborted)
+  {
+    LOG(WARNING) << "Error in receive: " << ec.message();
+  }
+  else
+  {
+    VLOG(10) << "Shutting down: " << ec.message();
   }
 }
 
@@ -1,19 +1,47 @@
 #include "CorePch.h"
 #include <rtp++/network/UdpSocketWrapper.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <boost/bind.hpp>
 #include <boost/asio/ip/multicast.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/asio/placeholders.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/system/system_error.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/throw_exception.hpp>
 #include <rtp++/RtpTime.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
 
 using namespace boost::asio::ip;
 
 namespace rtp_plus_plus
 {
 
+#ifdef ENABLE_SO_TIMESTAMPNS
+/**
+ * @brief returns the SCM_TIMESTAMPNS arrival time of the received message as NTP timestamp.
+ *
+ * Falls back to the current time if the kernel did not provide a timestamp.
+ */
+static uint64_t getKernelTimestamp(msghdr& header)
+{
+  for (cmsghdr* pCmsg = CMSG_FIRSTHDR(&header); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&header, pCmsg))
+  {
+    if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_TIMESTAMPNS)
+    {
+      timespec ts;
+      memcpy(&ts, CMSG_DATA(pCmsg), sizeof(ts));
+      return RtpTime::convertUnixTimeToNtpTimestamp(ts.tv_sec, ts.tv_nsec);
+    }
+  }
+  LOG_FIRST_N(WARNING, 1) << "Datagram without kernel timestamp";
+  return RtpTime::getNTPTimeStamp();
+}
+#endif
+
 UdpSocketWrapper::ptr UdpSocketWrapper::create(boost::asio::io_service& ioService, const std::string& sBindIp, unsigned short uiBindPort)
 {
   return boost::make_shared<UdpSocketWrapper>(boost::ref(ioService), boost::ref(sBindIp), uiBindPort);
@@ -38,7 +66,14 @@ UdpSocketWrapper::UdpSocketWrapper(boost::asio::io_service& ioService, const std
   m_endpoint(m_address, uiBindPort),
   m_pSocket(new udp::socket(m_rIoService)),
   m_bTimeOut(false),
-  m_uiTimeoutMs(1000)
+  m_uiTimeoutMs(1000),
+  m_uiBatchSize(0),
+  m_bKernelTimestamps(false),
+  m_uiSendBatchSize(0),
+  m_bSegmentationOffload(false),
+  m_sendQueue(send_queue_capacity),
+  m_uiQueued(0),
+  m_uiDroppedPackets(0)
 {
   boost::system::error_code ec = initialise();
   if (ec)
@@ -57,7 +92,14 @@ UdpSocketWrapper::UdpSocketWrapper(boost::asio::io_service& ioService, const std
   m_endpoint(m_address, uiBindPort),
   m_pSocket(new udp::socket(m_rIoService)),
   m_bTimeOut(false),
-  m_uiTimeoutMs(1000)
+  m_uiTimeoutMs(1000),
+  m_uiBatchSize(0),
+  m_bKernelTimestamps(false),
+  m_uiSendBatchSize(0),
+  m_bSegmentationOffload(false),
+  m_sendQueue(send_queue_capacity),
+  m_uiQueued(0),
+  m_uiDroppedPackets(0)
 {
   ec = initialise();
 }
@@ -71,7 +113,14 @@ UdpSocketWrapper::UdpSocketWrapper(boost::asio::io_service& ioService, const std
   m_endpoint(m_address, uiBindPort),
   m_pSocket(std::move(pSocket)),
   m_bTimeOut(false),
-  m_uiTimeoutMs(1000)
+  m_uiTimeoutMs(1000),
+  m_uiBatchSize(0),
+  m_bKernelTimestamps(false),
+  m_uiSendBatchSize(0),
+  m_bSegmentationOffload(false),
+  m_sendQueue(send_queue_capacity),
+  m_uiQueued(0),
+  m_uiDroppedPackets(0)
 {
 
 }
@@ -81,28 +130,143 @@ UdpSocketWrapper::~UdpSocketWrapper()
   VLOG(10) << "[" << this << "] Destructor";
 }
 
-void UdpSocketWrapper::send(Buffer networkPacket, const EndPoint& endpoint)
+bool UdpSocketWrapper::setReceiveBatchSize(uint32_t uiBatchSize)
 {
-  boost::mutex::scoped_lock l(m_lock);
-  bool bBusyWriting = !m_vDeliveryQueue.empty();
-  m_vDeliveryQueue.push_back( std::make_pair(networkPacket, endpoint) );
-  if (!bBusyWriting)
-  {
-    boost::asio::ip::udp::endpoint destination(boost::asio::ip::address::from_string(endpoint.getAddress()), endpoint.getPort());
-    m_pSocket->async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
-      destination,
-      boost::bind(&UdpSocketWrapper::writeCompletionHandler,
-      shared_from_this(),
-      boost::asio::placeholders::error,
-      boost::asio::placeholders::bytes_transferred)
-      );
+#ifdef ENABLE_RECVMMSG
+  m_uiBatchSize = uiBatchSize;
+  if (m_uiBatchSize <= 1)
+    return true;
+
+  VLOG(5) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Enabling batched receive: " << m_uiBatchSize;
+  // slots handed to the application are replaced from the buffer pool
+  m_vBatchBuffers.resize(m_uiBatchSize);
+  for (size_t i = 0; i < m_vBatchBuffers.size(); ++i)
+  {
+    if (m_vBatchBuffers[i].getSize() == 0)
+      m_vBatchBuffers[i] = BufferPool::allocate(max_length);
   }
-  else
+  m_vBatchIovecs.resize(m_uiBatchSize);
+  m_vBatchAddresses.resize(m_uiBatchSize);
+  m_vBatchHeaders.resize(m_uiBatchSize);
+  m_vBatchControl.resize(m_uiBatchSize * control_words);
+  return true;
+#else
+  if (uiBatchSize > 1)
   {
-#if 0
-    DLOG(INFO) << "Packet queued, write in progress";
+    LOG(WARNING) << "Batched receive is not supported on this platform";
+  }
+  return false;
+#endif
+}
+
+bool UdpSocketWrapper::setSendBatchSize(uint32_t uiBatchSize)
+{
+#ifdef ENABLE_SENDMMSG
+  // changing modes while packets are in flight would break the write chain
+  if (m_uiQueued.load() != 0)
+  {
+    LOG(WARNING) << "Send batch size can not be changed while packets are queued";
+    return false;
+  }
+  m_uiSendBatchSize = uiBatchSize;
+  if (m_uiSendBatchSize <= 1)
+    return true;
+
+  VLOG(5) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Enabling batched send: " << m_uiSendBatchSize;
+  m_vSendAddresses.resize(m_uiSendBatchSize);
+  m_vSendControl.resize(m_uiSendBatchSize);
+  m_vSendHeaders.resize(m_uiSendBatchSize);
+  m_vPacketsPerMessage.resize(m_uiSendBatchSize);
+  return true;
+#else
+  if (uiBatchSize > 1)
+  {
+    LOG(WARNING) << "Batched send is not supported on this platform";
+  }
+  return false;
 #endif
+}
+
+bool UdpSocketWrapper::setSegmentationOffload(bool bEnable)
+{
+#ifdef ENABLE_UDP_GSO
+  m_bSegmentationOffload = bEnable;
+  return true;
+#else
+  if (bEnable)
+  {
+    LOG(WARNING) << "UDP segmentation offload is not supported on this platform";
   }
+  return false;
+#endif
+}
+
+bool UdpSocketWrapper::setKernelTimestamps(bool bEnable)
+{
+#ifdef ENABLE_SO_TIMESTAMPNS
+  int iEnable = bEnable ? 1 : 0;
+  if (::setsockopt(m_pSocket->native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &iEnable, sizeof(iEnable)) != 0)
+  {
+    LOG(WARNING) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Failed to set SO_TIMESTAMPNS: " << strerror(errno);
+    return false;
+  }
+  VLOG(5) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Kernel receive timestamps: " << bEnable;
+  m_bKernelTimestamps = bEnable;
+  return true;
+#else
+  if (bEnable)
+  {
+    LOG(WARNING) << "Kernel receive timestamps are not supported on this platform";
+  }
+  return false;
+#endif
+}
+
+bool UdpSocketWrapper::enqueue(const Buffer& networkPacket, const EndPoint& endpoint)
+{
+  if (!endpoint.isResolved())
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Unable to send to unresolved address " << endpoint;
+    return false;
+  }
+  if (m_sendQueue.push(std::make_pair(networkPacket, endpoint)))
+    return true;
+
+  uint64_t uiDropped = ++m_uiDroppedPackets;
+  LOG_EVERY_N(WARNING, 100) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Send queue full, dropping packet to " << endpoint << " Dropped: " << uiDropped;
+  return false;
+}
+
+bool UdpSocketWrapper::send(const std::vector<Buffer>& vNetworkPackets, const EndPoint& endpoint)
+{
+  if (vNetworkPackets.empty()) return true;
+  if (!endpoint.isResolved())
+  {
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Unable to send to unresolved address " << endpoint;
+    return false;
+  }
+
+  // all packets are queued or none so that the caller can account for dropped packets
+  if (!m_sendQueue.pushBulk(vNetworkPackets.size(), [&](size_t i) { return std::make_pair(vNetworkPackets[i], endpoint); }))
+  {
+    uint64_t uiDropped = (m_uiDroppedPackets += vNetworkPackets.size());
+    LOG_EVERY_N(WARNING, 100) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Send queue full, dropping " << vNetworkPackets.size() << " packets to " << endpoint << " Dropped: " << uiDropped;
+    return false;
+  }
+  // the thread that moves the count away from 0 starts the write chain
+  if (m_uiQueued.fetch_add(vNetworkPackets.size()) == 0)
+    startWrite();
+  return true;
+}
+
+bool UdpSocketWrapper::send(Buffer networkPacket, const EndPoint& endpoint)
+{
+  if (!enqueue(networkPacket, endpoint))
+    return false;
+  // the thread that moves the count away from 0 starts the write chain
+  if (m_uiQueued.fetch_add(1) == 0)
+    startWrite();
+  return true;
 }
 
 void UdpSocketWrapper::close()
@@ -113,11 +277,38 @@ void UdpSocketWrapper::close()
 
 void UdpSocketWrapper::recv()
 {
+#ifdef ENABLE_RECVMMSG
+  if (m_uiBatchSize > 1)
+  {
+    // wait for the socket to become readable and then drain it with recvmmsg
+    m_pSocket->async_receive(boost::asio::null_buffers(),
+      boost::bind(&UdpSocketWrapper::readBatchCompletionHandler, shared_from_this(),
+      boost::asio::placeholders::error));
+  }
+#ifdef ENABLE_SO_TIMESTAMPNS
+  else if (m_bKernelTimestamps)
+  {
+    // wait for the socket to become readable: recvmsg returns the timestamp with the datagram
+    m_pSocket->async_receive(boost::asio::null_buffers(),
+      boost::bind(&UdpSocketWrapper::readTimestampedCompletionHandler, shared_from_this(),
+      boost::asio::placeholders::error));
+  }
+#endif
+  else
+  {
+    m_pSocket->async_receive_from(
+      boost::asio::buffer(m_data, max_length), m_lastSenderEndpoint,
+      boost::bind(&UdpSocketWrapper::readCompletionHandler, shared_from_this(),
+      boost::asio::placeholders::error,
+      boost::asio::placeholders::bytes_transferred));
+  }
+#else
   m_pSocket->async_receive_from(
     boost::asio::buffer(m_data, max_length), m_lastSenderEndpoint,
     boost::bind(&UdpSocketWrapper::readCompletionHandler, shared_from_this(),
     boost::asio::placeholders::error,
     boost::asio::placeholders::bytes_transferred));
+#endif
 
   if (m_bTimeOut)
   {
@@ -180,12 +371,36 @@ boost::system::error_code UdpSocketWrapper::initialise()
   return boost::system::error_code();
 }
 
-void UdpSocketWrapper::writeCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_transferred)
+void UdpSocketWrapper::startWrite()
 {
-  boost::mutex::scoped_lock l(m_lock);
+  if (m_uiSendBatchSize > 1)
+  {
+    startBatchWrite();
+    return;
+  }
 
-  NetworkPackage_t package = m_vDeliveryQueue.front();
-  m_vDeliveryQueue.pop_front();
+  // the packet is counted but its producer may not have published it yet
+  NetworkPackage_t* pPackage = m_sendQueue.front();
+  while (!pPackage)
+  {
+    boost::this_thread::yield();
+    pPackage = m_sendQueue.front();
+  }
+  const Buffer& networkPacket = pPackage->first;
+  const boost::asio::ip::udp::endpoint& destination = pPackage->second.getUdpEndpoint();
+  m_pSocket->async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
+    destination,
+    boost::bind(&UdpSocketWrapper::writeCompletionHandler,
+    shared_from_this(),
+    boost::asio::placeholders::error,
+    boost::asio::placeholders::bytes_transferred)
+    );
+}
+
+void UdpSocketWrapper::writeCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_transferred)
+{
+  NetworkPackage_t package = *m_sendQueue.front();
+  m_sendQueue.pop();
   if (m_fnOnSend)
     m_fnOnSend(ec, shared_from_this(), package.first, package.second);
   else
@@ -194,33 +409,187 @@ void UdpSocketWrapper::writeCompletionHandler(const boost::system::error_code& e
   if (!ec)
   {
     VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Sent " << bytes_transferred << " to " << package.second.getAddress() << ":" << package.second.getPort();
+  }
+  else
+  {
+    LOG(WARNING) << "Send failed from " << m_sIpAddress << ":" << m_uiPort << " to " << package.second << " Ec: " << ec.message();
+  }
+
+  // send next sample if one was queued in the meantime
+  size_t size = m_uiQueued.fetch_sub(1) - 1;
+  if (size > 0)
+  {
+    VLOG_IF(5, size > 1) << "Send queue: " << size;
+    startWrite();
+  }
+}
+
+void UdpSocketWrapper::startBatchWrite()
+{
+  // wait for the socket to become writable and then flush the queue with sendmmsg
+  m_pSocket->async_send(boost::asio::null_buffers(),
+    boost::bind(&UdpSocketWrapper::writeBatchCompletionHandler, shared_from_this(),
+    boost::asio::placeholders::error));
+}
+
+void UdpSocketWrapper::writeBatchCompletionHandler(const boost::system::error_code& ec)
+{
+#ifdef ENABLE_SENDMMSG
+  // only packets that have been published by their producers can be written
+  const size_t uiCounted = m_uiQueued.load();
+  size_t uiQueued = 0;
+  while (uiQueued < uiCounted && m_sendQueue.peek(uiQueued))
+    ++uiQueued;
+
+  if (uiQueued == 0)
+  {
+    // the producer that started the chain has not published its packet yet
+    boost::this_thread::yield();
+    startBatchWrite();
+    return;
+  }
 
-    // send next sample if one was queued in the meantime
-    if ( !m_vDeliveryQueue.empty() )
+  if (ec)
+  {
+    // report the queued packets as failed and carry on with packets queued in the meantime
+    LOG_IF(WARNING, ec != boost::asio::error::operation_aborted) << "Send failed from " << m_sIpAddress << ":" << m_uiPort << " Ec: " << ec.message();
+    for (size_t i = 0; i < uiQueued; ++i)
     {
-#if 0
-      DLOG(INFO) << "Sending queued packet Queue size: " << m_vDeliveryQueue.size();
-#else
-      size_t size = m_vDeliveryQueue.size();
-      VLOG_IF(5, size > 1) << "Send queue: " << size;
+      NetworkPackage_t package = *m_sendQueue.front();
+      m_sendQueue.pop();
+      if (m_fnOnSend)
+        m_fnOnSend(ec, shared_from_this(), package.first, package.second);
+    }
+    if (m_uiQueued.fetch_sub(uiQueued) > uiQueued)
+      startBatchWrite();
+    return;
+  }
+
+  // group the queued packets into messages: with segmentation offload consecutive packets
+  // to the same destination are coalesced into one message with one iovec per packet
+  uint32_t uiMessages = 0;
+  size_t uiIndex = 0;
+  // the iovecs must not be reallocated once the headers point into the vector
+  m_vSendIovecs.resize(std::min<size_t>(uiQueued, m_bSegmentationOffload ? m_uiSendBatchSize * max_gso_segments : m_uiSendBatchSize));
+  while (uiMessages < m_uiSendBatchSize && uiIndex < uiQueued)
+  {
+    const EndPoint& ep = m_sendQueue.peek(uiIndex)->second;
+    const uint32_t uiSegmentSize = m_sendQueue.peek(uiIndex)->first.getSize();
+    uint32_t uiPackets = 1;
+    uint32_t uiTotalBytes = uiSegmentSize;
+#ifdef ENABLE_UDP_GSO
+    if (m_bSegmentationOffload)
+    {
+      // all segments must have the same size: only the last one may be shorter
+      while (uiIndex + uiPackets < uiQueued && uiIndex + uiPackets < m_vSendIovecs.size() && uiPackets < max_gso_segments)
+      {
+        const NetworkPackage_t& next = *m_sendQueue.peek(uiIndex + uiPackets);
+        uint32_t uiSize = next.first.getSize();
+        if (uiSize > uiSegmentSize || uiTotalBytes + uiSize > max_gso_bytes ||
+            next.second != ep)
+          break;
+        ++uiPackets;
+        uiTotalBytes += uiSize;
+        if (uiSize < uiSegmentSize)
+          break;
+      }
+    }
+#endif
+
+    for (uint32_t i = 0; i < uiPackets; ++i)
+    {
+      Buffer& networkPacket = m_sendQueue.peek(uiIndex + i)->first;
+      m_vSendIovecs[uiIndex + i].iov_base = const_cast<uint8_t*>(networkPacket.data());
+      m_vSendIovecs[uiIndex + i].iov_len = networkPacket.getSize();
+    }
+
+    const boost::asio::ip::udp::endpoint& destination = ep.getUdpEndpoint();
+    memcpy(&m_vSendAddresses[uiMessages], destination.data(), destination.size());
+
+    mmsghdr& header = m_vSendHeaders[uiMessages];
+    memset(&header, 0, sizeof(mmsghdr));
+    header.msg_hdr.msg_name = &m_vSendAddresses[uiMessages];
+    header.msg_hdr.msg_namelen = destination.size();
+    header.msg_hdr.msg_iov = &m_vSendIovecs[uiIndex];
+    header.msg_hdr.msg_iovlen = uiPackets;
+#ifdef ENABLE_UDP_GSO
+    if (uiPackets > 1)
+    {
+      header.msg_hdr.msg_control = m_vSendControl[uiMessages].buf;
+      header.msg_hdr.msg_controllen = sizeof(m_vSendControl[uiMessages].buf);
+      cmsghdr* pCmsg = CMSG_FIRSTHDR(&header.msg_hdr);
+      pCmsg->cmsg_level = SOL_UDP;
+      pCmsg->cmsg_type = UDP_SEGMENT;
+      pCmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      uint16_t uiGsoSize = uiSegmentSize;
+      memcpy(CMSG_DATA(pCmsg), &uiGsoSize, sizeof(uint16_t));
+    }
+#endif
+    m_vPacketsPerMessage[uiMessages] = uiPackets;
+    uiIndex += uiPackets;
+    ++uiMessages;
+  }
+
+  int iSent = ::sendmmsg(m_pSocket->native_handle(), &m_vSendHeaders[0], uiMessages, MSG_DONTWAIT);
+  if (iSent < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+      // socket buffer full: wait until it is writable again
+      startBatchWrite();
+      return;
+    }
+#ifdef ENABLE_UDP_GSO
+    if (m_bSegmentationOffload && (errno == EIO || errno == EINVAL))
+    {
+      // kernel or device doesn't support segmentation offload for this socket: fall back to sendmmsg
+      LOG(WARNING) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] UDP segmentation offload failed, disabling: " << strerror(errno);
+      m_bSegmentationOffload = false;
+      startBatchWrite();
+      return;
+    }
 #endif
-      NetworkPackage_t package = m_vDeliveryQueue.front();
-      Buffer networkPacket = package.first;
-      EndPoint ep = package.second;
-      boost::asio::ip::udp::endpoint endPoint(boost::asio::ip::address::from_string(ep.getAddress()), ep.getPort());
-      m_pSocket->async_send_to( boost::asio::buffer(networkPacket.data(), networkPacket.getSize()),
-        endPoint,
-        boost::bind(&UdpSocketWrapper::writeCompletionHandler,
-        shared_from_this(),
-        boost::asio::placeholders::error,
-        boost::asio::placeholders::bytes_transferred)
-        );
+    // fail the packets of the first message and carry on with the rest
+    boost::system::error_code ecSend(errno, boost::system::system_category());
+    LOG(WARNING) << "Send failed from " << m_sIpAddress << ":" << m_uiPort << " to " << m_sendQueue.front()->second << " Ec: " << ecSend.message();
+    uiIndex = m_vPacketsPerMessage[0];
+    for (uint32_t i = 0; i < m_vPacketsPerMessage[0]; ++i)
+    {
+      NetworkPackage_t package = *m_sendQueue.front();
+      m_sendQueue.pop();
+      if (m_fnOnSend)
+        m_fnOnSend(ecSend, shared_from_this(), package.first, package.second);
     }
   }
   else
   {
-    LOG(WARNING) << "Send failed from " << m_sIpAddress << ":" << m_uiPort << " to " << package.second << " Ec: " << ec.message();
+    VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort << "] Sent " << iSent << "/" << uiMessages << " messages containing " << uiIndex << " packets";
+    uiIndex = 0;
+    for (int i = 0; i < iSent; ++i)
+    {
+      for (uint32_t j = 0; j < m_vPacketsPerMessage[i]; ++j)
+      {
+        NetworkPackage_t package = *m_sendQueue.front();
+        m_sendQueue.pop();
+        if (m_fnOnSend)
+          m_fnOnSend(ec, shared_from_this(), package.first, package.second);
+        else
+          VLOG(2) << "Send callback has not been set";
+      }
+      uiIndex += m_vPacketsPerMessage[i];
+    }
   }
+
+  // uiIndex now holds the number of packets that have been completed
+  size_t size = m_uiQueued.fetch_sub(uiIndex) - uiIndex;
+  if (size > 0)
+  {
+    VLOG_IF(5, size > m_uiSendBatchSize) << "Send queue: " << size;
+    startBatchWrite();
+  }
+#else
+  assert(false);
+#endif
 }
 
 void UdpSocketWrapper::timeoutHandler(const boost::system::error_code& ec)
@@ -235,13 +604,61 @@ void UdpSocketWrapper::timeoutHandler(const boost::system::error_code& ec)
 }
 
 void UdpSocketWrapper::readCompletionHandler(const boost::system::error_code& ec, std::size_t bytes_received)
+{
+  handleDatagram(ec, bytes_received, RtpTime::getNTPTimeStamp());
+}
+
+void UdpSocketWrapper::readTimestampedCompletionHandler(const boost::system::error_code& ec)
+{
+#ifdef ENABLE_SO_TIMESTAMPNS
+  if (ec)
+  {
+    handleDatagram(ec, 0, 0);
+    return;
+  }
+
+  iovec iov;
+  iov.iov_base = m_data;
+  iov.iov_len = max_length;
+  sockaddr_storage address;
+  uint64_t control[control_words];
+  msghdr header;
+  memset(&header, 0, sizeof(header));
+  header.msg_name = &address;
+  header.msg_namelen = sizeof(address);
+  header.msg_iov = &iov;
+  header.msg_iovlen = 1;
+  header.msg_control = control;
+  header.msg_controllen = sizeof(control);
+
+  ssize_t iReceived = ::recvmsg(m_pSocket->native_handle(), &header, MSG_DONTWAIT);
+  if (iReceived < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+      // spurious wakeup: wait for the next readiness event
+      recv();
+      return;
+    }
+    handleDatagram(boost::system::error_code(errno, boost::system::system_category()), 0, 0);
+    return;
+  }
+  memcpy(m_lastSenderEndpoint.data(), &address, header.msg_namelen);
+  m_lastSenderEndpoint.resize(header.msg_namelen);
+  handleDatagram(ec, iReceived, getKernelTimestamp(header));
+#else
+  assert(false);
+#endif
+}
+
+void UdpSocketWrapper::handleDatagram(const boost::system::error_code& ec, std::size_t bytes_received, uint64_t uiNtpArrival)
 {
 // #define DEBUG_NTP
 #ifdef DEBUG_NTP
-  DLOG(INFO) << "NTP arrival time: " << convertNtpTimestampToPosixTime(getNTPTimeStamp());
+  DLOG(INFO) << "NTP arrival time: " << convertNtpTimestampToPosixTime(uiNtpArrival);
 #endif
 
-  NetworkPacket networkPacket(RtpTime::getNTPTimeStamp());
+  NetworkPacket networkPacket(uiNtpArrival);
   if (m_bTimeOut)
   {
     // cancel timeout
@@ -253,11 +670,10 @@ void UdpSocketWrapper::readCompletionHandler(const boost::system::error_code& ec
   {
     VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort  << "] Received " << bytes_received << " from " << m_lastSenderEndpoint.address().to_string() << ":" << m_lastSenderEndpoint.port();
 
-    uint8_t* pData = new uint8_t[bytes_received];
-    memcpy(pData, m_data, bytes_received);
-    networkPacket.setData(pData, bytes_received);
-    ep.setAddress(m_lastSenderEndpoint.address().to_string());
-    ep.setPort(m_lastSenderEndpoint.port());
+    Buffer data = BufferPool::allocate(bytes_received);
+    memcpy(const_cast<uint8_t*>(data.data()), m_data, bytes_received);
+    networkPacket = NetworkPacket(data, networkPacket.getNtpArrivalTime());
+    ep = EndPoint(m_lastSenderEndpoint);
   }
   // let calling clas handle error and logging
 #if 0
@@ -275,4 +691,92 @@ void UdpSocketWrapper::readCompletionHandler(const boost::system::error_code& ec
     VLOG(2) << "Recv callback has not been set";
 }
 
+void UdpSocketWrapper::readBatchCompletionHandler(const boost::system::error_code& ec)
+{
+#ifdef ENABLE_RECVMMSG
+  if (m_bTimeOut)
+  {
+    // cancel timeout
+    m_timer.cancel();
+  }
+
+  NetworkPacketBatch_t vPackets;
+  if (ec)
+  {
+    // let calling class handle error and logging
+    if (m_fnOnRecvBatch)
+      m_fnOnRecvBatch(ec, shared_from_this(), vPackets);
+    else
+      VLOG(2) << "Recv batch callback has not been set";
+    return;
+  }
+
+  for (size_t i = 0; i < m_uiBatchSize; ++i)
+  {
+    m_vBatchIovecs[i].iov_base = const_cast<uint8_t*>(m_vBatchBuffers[i].data());
+    m_vBatchIovecs[i].iov_len = max_length;
+    memset(&m_vBatchHeaders[i], 0, sizeof(mmsghdr));
+    m_vBatchHeaders[i].msg_hdr.msg_iov = &m_vBatchIovecs[i];
+    m_vBatchHeaders[i].msg_hdr.msg_iovlen = 1;
+    m_vBatchHeaders[i].msg_hdr.msg_name = &m_vBatchAddresses[i];
+    m_vBatchHeaders[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    if (m_bKernelTimestamps)
+    {
+      m_vBatchHeaders[i].msg_hdr.msg_control = &m_vBatchControl[i * control_words];
+      m_vBatchHeaders[i].msg_hdr.msg_controllen = control_words * sizeof(uint64_t);
+    }
+  }
+
+  int iReceived = ::recvmmsg(m_pSocket->native_handle(), &m_vBatchHeaders[0], m_uiBatchSize, MSG_DONTWAIT, NULL);
+  if (iReceived < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+    {
+      // spurious wakeup: wait for the next readiness event
+      recv();
+      return;
+    }
+    boost::system::error_code ecRecv(errno, boost::system::system_category());
+    if (m_fnOnRecvBatch)
+      m_fnOnRecvBatch(ecRecv, shared_from_this(), vPackets);
+    else
+      VLOG(2) << "Recv batch callback has not been set";
+    return;
+  }
+
+  // all datagrams of the batch were already queued in the socket buffer: one timestamp suffices
+  // unless the kernel timestamped each of them
+  uint64_t uiNtpArrival = m_bKernelTimestamps ? 0 : RtpTime::getNTPTimeStamp();
+  vPackets.reserve(iReceived);
+  for (int i = 0; i < iReceived; ++i)
+  {
+    uint32_t uiBytesReceived = m_vBatchHeaders[i].msg_len;
+#ifdef ENABLE_SO_TIMESTAMPNS
+    if (m_bKernelTimestamps)
+      uiNtpArrival = getKernelTimestamp(m_vBatchHeaders[i].msg_hdr);
+#endif
+    boost::asio::ip::udp::endpoint sender;
+    memcpy(sender.data(), &m_vBatchAddresses[i], m_vBatchHeaders[i].msg_hdr.msg_namelen);
+    sender.resize(m_vBatchHeaders[i].msg_hdr.msg_namelen);
+
+    VLOG(10) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort  << "] Received " << uiBytesReceived << " from " << sender.address().to_string() << ":" << sender.port();
+
+    // hand the slot over to the packet and replace it from the pool: the block
+    // returns to the pool once the application releases the packet
+    NetworkPacket networkPacket(sliceBuffer(m_vBatchBuffers[i], 0, uiBytesReceived), uiNtpArrival);
+    m_vBatchBuffers[i] = BufferPool::allocate(max_length);
+    vPackets.push_back(std::make_pair(networkPacket, EndPoint(sender)));
+  }
+
+  VLOG_IF(10, iReceived > 1) << "[" << this << "][" << m_sIpAddress << ":" << m_uiPort  << "] Batch size: " << iReceived;
+
+  if (m_fnOnRecvBatch)
+    m_fnOnRecvBatch(ec, shared_from_this(), vPackets);
+  else
+    VLOG(2) << "Recv batch callback has not been set";
+#else
+  assert(false);
+#endif
+}
+
 } // rtp_plus_plus
@@ -3,6 +3,7 @@
 #include <cpputil/Utility.h>
 #include <rtp++/RtpTime.h>
 #include <rtp++/rfc3550/Rtcp.h>
+#include <rtp++/util/Clock.h>
 
 namespace rtp_plus_plus
 {
@@ -11,7 +12,8 @@ namespace rfc3550
 
 MemberEntry::MemberEntry()
   :m_uiSSRC(0),
-  m_tEntryCreated(boost::posix_time::microsec_clock::universal_time()),
+  m_iEntryCreatedNs(Clock::monotonicNs()),
+  m_iMarkedInactiveNs(0),
   m_bInit(false),
   m_uiProbation(MIN_SEQUENTIAL),
   m_bIsSender(false),
@@ -41,7 +43,11 @@ MemberEntry::MemberEntry()
   m_uiLost(0),
   m_uiLossFraction(0),
   m_dRtt(0.0),
+  m_iLsrNs(0),
+  m_iLastRtpPacketSentNs(0),
+  m_iLastPacketSentNs(0),
   m_uiSyncRtpRef(0),
+  m_iSyncRefNs(0),
   m_bEnableDetailedLossDetection(true)
 {
 
@@ -49,7 +55,8 @@ MemberEntry::MemberEntry()
 
 MemberEntry::MemberEntry(uint32_t uiSSRC)
   :m_uiSSRC(uiSSRC),
-  m_tEntryCreated(boost::posix_time::microsec_clock::universal_time()),
+  m_iEntryCreatedNs(Clock::monotonicNs()),
+  m_iMarkedInactiveNs(0),
   m_bInit(false),
   m_uiProbation(MIN_SEQUENTIAL),
   m_bIsSender(false),
@@ -79,7 +86,11 @@ MemberEntry::MemberEntry(uint32_t uiSSRC)
   m_uiLost(0),
   m_uiLossFraction(0),
   m_dRtt(0.0),
+  m_iLsrNs(0),
+  m_iLastRtpPacketSentNs(0),
+  m_iLastPacketSentNs(0),
   m_uiSyncRtpRef(0),
+  m_iSyncRefNs(0),
   m_bEnableDetailedLossDetection(true)
 {
 
@@ -237,38 +248,40 @@ void MemberEntry::onReceiveRtpPacket( const RtpPacket& packet, uint32_t uiRtpTim
 
   // calculate presentation time of RTP packet
   // Before RTCP sync, we use wall clock as reference time
-  if (m_tSyncRef.is_not_a_date_time())
+  if (m_iSyncRefNs == 0)
   {
     m_uiSyncRtpRef = packet.getRtpTimestamp();
-    m_tSyncRef = m_tLastRtpPacketSent;
+    m_iSyncRefNs = (packet.getArrivalTimeNs() != 0) ? packet.getArrivalTimeNs() : Clock::realtimeNs();
   }
 
-  tPresentation = RtpTime::getPresentationTime(m_uiSyncRtpRef, m_tSyncRef, packet.getRtpTimestamp(), uiRtpTimestampFrequency);
+  if (m_timestampConverter.getTimestampFrequency() != uiRtpTimestampFrequency)
+    m_timestampConverter = RtpTimestampConverter(uiRtpTimestampFrequency);
+  int64_t iPresentationNs = m_timestampConverter.getPresentationTime(m_uiSyncRtpRef, m_iSyncRefNs, packet.getRtpTimestamp());
+  tPresentation = Clock::toPosixTime(iPresentationNs);
 
   bIsRtcpSyncronised = m_bIsRtcpSynchronised;
 
   // Save these as the new synchronization timestamp & time
   m_uiSyncRtpRef = rtpPacket.getRtpTimestamp();
-  m_tSyncRef = tPresentation;
+  m_iSyncRefNs = iPresentationNs;
 }
 
 void MemberEntry::onSendRtpPacket( const RtpPacket& packet )
 {
-  m_tLastRtpPacketSent = boost::posix_time::microsec_clock::universal_time();
-  m_tLastPacketSent = m_tLastRtpPacketSent;
+  m_iLastRtpPacketSentNs = Clock::monotonicNs();
+  m_iLastPacketSentNs = m_iLastRtpPacketSentNs;
   m_bIsSender = true;
 }
 
 void MemberEntry::processRtpPacket(uint16_t uiSequenceNumber, uint32_t uiRtpTs, uint32_t uiRtpArrivalTs)
 {
-  m_tLastRtpPacketSent = boost::posix_time::microsec_clock::universal_time();
-  m_tLastPacketSent = m_tLastRtpPacketSent;
+  m_iLastRtpPacketSentNs = Clock::monotonicNs();
+  m_iLastPacketSentNs = m_iLastRtpPacketSentNs;
   m_bIsSender = true;
 
   ++m_uiRtpPacketsReceivedDuringLastInterval;
   update_seq(uiSequenceNumber);
 
-  // TODO: revise loss estimator, profiling has shown it to be expensive
   if (m_bEnableDetailedLossDetection)
     m_lossEstimator.addSequenceNumber(uiSequenceNumber);
 
@@ -312,16 +325,16 @@ void MemberEntry::processRtpPacket(uint16_t uiSequenceNumber, uint32_t uiRtpTs,
 
 void MemberEntry::onReceiveRtcpPacket()
 {
-  m_tLastPacketSent = boost::posix_time::microsec_clock::universal_time();
+  m_iLastPacketSentNs = Clock::monotonicNs();
   ++m_uiRtcpPacketsReceivedDuringLastInterval;
 }
 
-bool MemberEntry::isInactiveAndCanBeRemoved( boost::posix_time::ptime tNow ) const
+bool MemberEntry::isInactiveAndCanBeRemoved( int64_t iNowNs ) const
 {
   // A participant can be removed of
   // - he has been inactive for more than BYE_TIMEOUT_SECONDS
   // - the last RTP or RTCP packet was sent more than
-  return m_bInactive && ((tNow - m_tMarkedInactive).total_seconds() >= (int64_t)BYE_TIMEOUT_SECONDS);
+  return m_bInactive && ((iNowNs - m_iMarkedInactiveNs) >= (int64_t)BYE_TIMEOUT_SECONDS * Clock::NS_PER_SECOND);
 }
 
 void MemberEntry::onSrReceived( const rfc3550::RtcpSr& rSr )
@@ -335,11 +348,11 @@ void MemberEntry::onSrReceived( const rfc3550::RtcpSr& rSr )
   // Save these as the new synchronization timestamp & time
   m_bIsRtcpSynchronised = true;
   m_uiSyncRtpRef = rSr.getRtpTimestamp();
-  m_tSyncRef = RtpTime::convertNtpTimestampToPosixTime(rSr.getNtpTimestampMsw(), rSr.getNtpTimestampLsw());
+  m_iSyncRefNs = RtpTime::convertNtpTimestampToUnixNs((static_cast<uint64_t>(rSr.getNtpTimestampMsw()) << 32) | rSr.getNtpTimestampLsw());
 
   m_bIsSender = true;
 
-  m_tLsr = boost::posix_time::microsec_clock::universal_time();
+  m_iLsrNs = Clock::monotonicNs();
   // update time last SR received
   uint32_t uiNtpMsw = rSr.getNtpTimestampMsw();
   uint32_t uiNtpLsw = rSr.getNtpTimestampLsw();
@@ -352,7 +365,7 @@ void MemberEntry::onSrReceived( const rfc3550::RtcpSr& rSr )
             << " " << convertNtpTimestampToPosixTime(rSr.getArrivalTimeNtp())
             << " with SR NTP " << hex(uiNtpMsw) << "." << hex(uiNtpLsw)
             << " " << convertNtpTimestampToPosixTime(uiNtpMsw, uiNtpLsw)
-            << " m_tLsr: " << m_tLsr;
+            << " m_iLsrNs: " << m_iLsrNs;
 
 #endif
 
@@ -379,32 +392,19 @@ uint32_t MemberEntry::getDlsr() const
 void MemberEntry::finaliseRRData()
 {
   // this value is only calculated if an SR has been received
-  if (!m_tLsr.is_not_a_date_time())
-  {
-    const boost::posix_time::ptime tNow =  boost::posix_time::microsec_clock::universal_time();
-    m_tDlsr = tNow - m_tLsr;
-  }
-  else
-  {
-    m_tDlsr = boost::posix_time::seconds(0);
-  }
+  int64_t iDlsrNs = (m_iLsrNs != 0) ? Clock::monotonicNs() - m_iLsrNs : 0;
 #ifdef DEBUG_RTT
-  DLOG(INFO) << "[" << this << "]" << "finalising RR data: LSR: " << hex(m_uiLsr) << " " << m_tLsr;
+  DLOG(INFO) << "[" << this << "]" << "finalising RR data: LSR: " << hex(m_uiLsr) << " " << m_iLsrNs;
 #endif
 
-  // calculate time elapsed in seconds
-  uint32_t uiSeconds = static_cast<uint32_t>(m_tDlsr.total_seconds());
-  uint32_t uiMicroseconds = static_cast<uint32_t>(m_tDlsr.fractional_seconds());
-
-  double dDelay = (double)uiSeconds + uiMicroseconds/1000000.0;
-  m_uiDlsr = RtpTime::convertDelaySinceLastSenderReportToDlsr(dDelay);
+  // DLSR is expressed in units of 1/65536 seconds
+  m_uiDlsr = static_cast<uint32_t>((static_cast<uint64_t>(iDlsrNs) << 16) / Clock::NS_PER_SECOND);
 
 #ifdef DEBUG_RTT
   DLOG(INFO) << "[" << this << "] SSRC: " << hex(m_uiSSRC)
              << " DLSR: " << hex(m_uiDlsr) << " = "
-             << m_tDlsr.total_milliseconds() << "ms ("
-             << dDelay <<  "s) Last SR received: "
-             << m_tLsr;
+             << iDlsrNs / 1000000 << "ms Last SR received: "
+             << m_iLsrNs;
 #endif
 
   if (m_bEnableDetailedLossDetection)
@@ -513,7 +513,7 @@ void MemberEntry::setInactive()
 {
   m_bInactive = true;
   DLOG(INFO) << "SSRC " << hex(m_uiSSRC) << " marked inactive";
-  m_tMarkedInactive = boost::posix_time::microsec_clock::universal_time();
+  m_iMarkedInactiveNs = Clock::monotonicNs();
 }
 
 void MemberEntry::init_seq( uint16_t seq )
@@ -0,0 +1,181 @@
+#include "CorePch.h"
+#include <rtp++/rfc3550/MemberTable.h>
+
+namespace rtp_plus_plus
+{
+namespace rfc3550
+{
+
+MemberTable::MemberTable(uint32_t uiInitialCapacity)
+  :m_uiIndexMask(0),
+    m_uiSenders(0),
+    m_uiValid(0),
+    m_uiInactive(0),
+    m_uiUnvalidated(0)
+{
+  // keep the index at most half full
+  uint32_t uiSlots = 16;
+  while (uiSlots < uiInitialCapacity * 2) uiSlots <<= 1;
+  m_vIndex.resize(uiSlots, 0);
+  m_uiIndexMask = uiSlots - 1;
+  m_vSSRCs.reserve(uiInitialCapacity);
+  m_vEntries.reserve(uiInitialCapacity);
+  m_vFlags.reserve(uiInitialCapacity);
+}
+
+uint32_t MemberTable::getHomeSlot(uint32_t uiSSRC) const
+{
+  // SSRCs should be random but are not always, e.g. when forced on the command line
+  uint32_t uiHash = uiSSRC ^ (uiSSRC >> 16);
+  uiHash *= 0x45d9f3b;
+  uiHash ^= uiHash >> 16;
+  return uiHash & m_uiIndexMask;
+}
+
+uint32_t MemberTable::getSlot(uint32_t uiSSRC) const
+{
+  uint32_t uiSlot = getHomeSlot(uiSSRC);
+  while (m_vIndex[uiSlot] != 0 && m_vSSRCs[m_vIndex[uiSlot] - 1] != uiSSRC)
+  {
+    uiSlot = (uiSlot + 1) & m_uiIndexMask;
+  }
+  return uiSlot;
+}
+
+uint32_t MemberTable::find(uint32_t uiSSRC) const
+{
+  uint32_t uiSlot = getSlot(uiSSRC);
+  return (m_vIndex[uiSlot] == 0) ? NPOS : m_vIndex[uiSlot] - 1;
+}
+
+uint32_t MemberTable::insert(uint32_t uiSSRC, std::unique_ptr<MemberEntry> pEntry)
+{
+  assert(find(uiSSRC) == NPOS);
+  if ((m_vSSRCs.size() + 1) * 2 > m_vIndex.size())
+  {
+    grow();
+  }
+  uint32_t uiIndex = size();
+  m_vIndex[getSlot(uiSSRC)] = uiIndex + 1;
+  m_vSSRCs.push_back(uiSSRC);
+  m_vEntries.push_back(std::move(pEntry));
+  // the member is counted on the next update
+  m_vFlags.push_back(0);
+  touch(uiIndex);
+  return uiIndex;
+}
+
+void MemberTable::removeAt(uint32_t uiIndex)
+{
+  assert(uiIndex < size());
+  // the touched list refers to member indices which are about to change
+  update();
+  updateCounts(m_vFlags[uiIndex], -1);
+  eraseSlot(getSlot(m_vSSRCs[uiIndex]));
+
+  uint32_t uiLast = size() - 1;
+  if (uiIndex != uiLast)
+  {
+    // move the last member into the freed position
+    m_vIndex[getSlot(m_vSSRCs[uiLast])] = uiIndex + 1;
+    m_vSSRCs[uiIndex] = m_vSSRCs[uiLast];
+    m_vEntries[uiIndex] = std::move(m_vEntries[uiLast]);
+    m_vFlags[uiIndex] = m_vFlags[uiLast];
+  }
+  m_vSSRCs.pop_back();
+  m_vEntries.pop_back();
+  m_vFlags.pop_back();
+}
+
+void MemberTable::eraseSlot(uint32_t uiSlot)
+{
+  // backward shift deletion: move subsequent entries of the probe sequence into the gap
+  uint32_t uiGap = uiSlot;
+  uint32_t uiNext = uiSlot;
+  while (true)
+  {
+    uiNext = (uiNext + 1) & m_uiIndexMask;
+    if (m_vIndex[uiNext] == 0) break;
+    uint32_t uiHome = getHomeSlot(m_vSSRCs[m_vIndex[uiNext] - 1]);
+    // the entry stays if its home slot lies cyclically in (gap, next]
+    bool bStays = (uiGap <= uiNext) ? (uiGap < uiHome && uiHome <= uiNext)
+                                    : (uiGap < uiHome || uiHome <= uiNext);
+    if (!bStays)
+    {
+      m_vIndex[uiGap] = m_vIndex[uiNext];
+      uiGap = uiNext;
+    }
+  }
+  m_vIndex[uiGap] = 0;
+}
+
+void MemberTable::grow()
+{
+  uint32_t uiSlots = static_cast<uint32_t>(m_vIndex.size()) * 2;
+  m_vIndex.assign(uiSlots, 0);
+  m_uiIndexMask = uiSlots - 1;
+  for (uint32_t i = 0; i < size(); ++i)
+  {
+    m_vIndex[getSlot(m_vSSRCs[i])] = i + 1;
+  }
+}
+
+void MemberTable::touch(uint32_t uiIndex)
+{
+  if ((m_vFlags[uiIndex] & FLAG_TOUCHED) == 0)
+  {
+    m_vFlags[uiIndex] |= FLAG_TOUCHED;
+    m_vTouched.push_back(uiIndex);
+  }
+}
+
+void MemberTable::update() const
+{
+  for (uint32_t uiIndex : m_vTouched)
+  {
+    const MemberEntry* pEntry = m_vEntries[uiIndex].get();
+    uint8_t uiFlags = (pEntry->isSender() ? FLAG_SENDER : 0) |
+        (pEntry->isValid() ? FLAG_VALID : 0) |
+        (pEntry->isInactive() ? FLAG_INACTIVE : 0) |
+        (pEntry->isUnvalidated() ? FLAG_UNVALIDATED : 0);
+    updateCounts(m_vFlags[uiIndex] & ~FLAG_TOUCHED, -1);
+    updateCounts(uiFlags, 1);
+    m_vFlags[uiIndex] = uiFlags;
+  }
+  m_vTouched.clear();
+}
+
+void MemberTable::updateCounts(uint8_t uiFlags, int iDelta) const
+{
+  if (uiFlags & FLAG_SENDER) m_uiSenders += iDelta;
+  if (uiFlags & FLAG_VALID) m_uiValid += iDelta;
+  if (uiFlags & FLAG_INACTIVE) m_uiInactive += iDelta;
+  if (uiFlags & FLAG_UNVALIDATED) m_uiUnvalidated += iDelta;
+}
+
+uint32_t MemberTable::getSenderCount() const
+{
+  update();
+  return m_uiSenders;
+}
+
+uint32_t MemberTable::getValidCount() const
+{
+  update();
+  return m_uiValid;
+}
+
+uint32_t MemberTable::getInactiveCount() const
+{
+  update();
+  return m_uiInactive;
+}
+
+uint32_t MemberTable::getUnvalidatedCount() const
+{
+  update();
+  return m_uiUnvalidated;
+}
+
+} // rfc3550
+} // rtp_plus_plus
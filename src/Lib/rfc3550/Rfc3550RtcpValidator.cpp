@@ -1,5 +1,6 @@
 #include "CorePch.h"
 #include <rtp++/rfc3550/Rfc3550RtcpValidator.h>
+#include <rtp++/RtcpCompoundView.h>
 
 #if 0
 #include <boost/lambda/lambda.hpp>
@@ -66,5 +67,21 @@ bool RtcpValidator::validateCompoundRtcpPacket(CompoundRtcpPacket compoundPacket
   return true;
 }
 
+bool RtcpValidator::validateCompoundRtcpView(const RtcpCompoundView& compoundView, uint32_t uiTotalLength)
+{
+  EXIT_ON_TRUE(compoundView.empty(), "Empty compound RTCP packet");
+
+  // check if is compound packet
+  if (uiTotalLength != 0)
+    EXIT_ON_TRUE(compoundView[0].getSize() == uiTotalLength, "No compound RTCP packet");
+
+  // check if first packet is SR or RR
+  EXIT_ON_TRUE((compoundView[0].getPacketType() != PT_RTCP_SR) &&
+    (compoundView[0].getPacketType() != PT_RTCP_RR),
+    "First packet is no SR/RR: " << (uint32_t)compoundView[0].getPacketType());
+
+  return true;
+}
+
 }
 }
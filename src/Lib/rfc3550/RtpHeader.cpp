@@ -6,21 +6,119 @@ namespace rtp_plus_plus
 namespace rfc3550
 {
 
+RtpHeader::RtpHeader(const RtpHeader& other)
+  :m_uiVersion(other.m_uiVersion),
+  m_bPadding(other.m_bPadding),
+  m_uiCC(other.m_uiCC),
+  m_bMarker(other.m_bMarker),
+  m_uiPT(other.m_uiPT),
+  m_uiSN(other.m_uiSN),
+  m_uiRtpTimestamp(other.m_uiRtpTimestamp),
+  m_uiSSRC(other.m_uiSSRC)
+{
+  memcpy(m_aCSRCs, other.m_aCSRCs, sizeof(m_aCSRCs));
+  if (other.m_pCSRCs)
+  {
+    m_pCSRCs.reset(new uint32_t[MAX_CSRC_COUNT]);
+    memcpy(m_pCSRCs.get(), other.m_pCSRCs.get(), MAX_CSRC_COUNT * sizeof(uint32_t));
+  }
+  if (other.m_pHeaderExtension)
+    m_pHeaderExtension.reset(new rfc5285::RtpHeaderExtension(*other.m_pHeaderExtension));
+}
+
+RtpHeader::RtpHeader(RtpHeader&& other)
+  :m_uiVersion(other.m_uiVersion),
+  m_bPadding(other.m_bPadding),
+  m_uiCC(other.m_uiCC),
+  m_bMarker(other.m_bMarker),
+  m_uiPT(other.m_uiPT),
+  m_uiSN(other.m_uiSN),
+  m_uiRtpTimestamp(other.m_uiRtpTimestamp),
+  m_uiSSRC(other.m_uiSSRC),
+  m_pCSRCs(std::move(other.m_pCSRCs)),
+  m_pHeaderExtension(std::move(other.m_pHeaderExtension))
+{
+  memcpy(m_aCSRCs, other.m_aCSRCs, sizeof(m_aCSRCs));
+  other.m_uiCC = 0;
+}
+
+RtpHeader& RtpHeader::operator=(const RtpHeader& other)
+{
+  if (this != &other)
+  {
+    RtpHeader copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+RtpHeader& RtpHeader::operator=(RtpHeader&& other)
+{
+  if (this != &other)
+  {
+    m_uiVersion = other.m_uiVersion;
+    m_bPadding = other.m_bPadding;
+    m_uiCC = other.m_uiCC;
+    m_bMarker = other.m_bMarker;
+    m_uiPT = other.m_uiPT;
+    m_uiSN = other.m_uiSN;
+    m_uiRtpTimestamp = other.m_uiRtpTimestamp;
+    m_uiSSRC = other.m_uiSSRC;
+    memcpy(m_aCSRCs, other.m_aCSRCs, sizeof(m_aCSRCs));
+    m_pCSRCs = std::move(other.m_pCSRCs);
+    m_pHeaderExtension = std::move(other.m_pHeaderExtension);
+    other.m_uiCC = 0;
+  }
+  return *this;
+}
+
+const rfc5285::RtpHeaderExtension& RtpHeader::getHeaderExtension() const
+{
+  static const rfc5285::RtpHeaderExtension EMPTY_EXTENSION;
+  return m_pHeaderExtension ? *m_pHeaderExtension : EMPTY_EXTENSION;
+}
+
+rfc5285::RtpHeaderExtension& RtpHeader::getHeaderExtension()
+{
+  if (!m_pHeaderExtension)
+    m_pHeaderExtension.reset(new rfc5285::RtpHeaderExtension());
+  return *m_pHeaderExtension;
+}
+
+void RtpHeader::addContributingSource(uint32_t uiCSRC)
+{
+  if (m_uiCC == MAX_CSRC_COUNT)
+  {
+    LOG(WARNING) << "RTP header already contains " << MAX_CSRC_COUNT << " CSRCs, ignoring " << uiCSRC;
+    return;
+  }
+
+  if (m_uiCC == INLINE_CSRC_COUNT && !m_pCSRCs)
+  {
+    m_pCSRCs.reset(new uint32_t[MAX_CSRC_COUNT]);
+    memcpy(m_pCSRCs.get(), m_aCSRCs, sizeof(m_aCSRCs));
+  }
+  if (m_pCSRCs)
+    m_pCSRCs[m_uiCC++] = uiCSRC;
+  else
+    m_aCSRCs[m_uiCC++] = uiCSRC;
+}
+
 std::ostream& operator<<( std::ostream& ostr, const RtpHeader& rtpHeader )
 {
   ostr << "RTP header:";
   ostr << " V: "    << (int)rtpHeader.m_uiVersion;
   ostr << " P: "    << rtpHeader.m_bPadding;
-  ostr << " X: "    << rtpHeader.m_bExtension;
+  ostr << " X: "    << rtpHeader.hasExtension();
   ostr << " CC: "   << (int)rtpHeader.m_uiCC;
   ostr << " M: "    << rtpHeader.m_bMarker;
   ostr << " PT: "   << (int)rtpHeader.m_uiPT;
   ostr << " SN: "   << rtpHeader.m_uiSN;
   ostr << " TS: "   << rtpHeader.m_uiRtpTimestamp;
   ostr << " SSRC: " << rtpHeader.m_uiSSRC;
-  for (size_t i = 0; i < rtpHeader.m_vCCs.size(); ++i)
+  for (uint32_t i = 0; i < rtpHeader.m_uiCC; ++i)
   {
-    ostr << " CSRC: " << rtpHeader.m_vCCs[i];
+    ostr << " CSRC: " << rtpHeader.getCSRC(i);
   }
   return ostr;
 }
@@ -37,15 +135,13 @@ OBitStream& operator<<( OBitStream& ob, const RtpHeader& rtpHeader )
   ob.write( rtpHeader.getRtpTimestamp(),   32);
   ob.write( rtpHeader.getSSRC(),           32);
 
-  std::vector<uint32_t> vCSRCs = rtpHeader.getCSRCs();
-  std::for_each(vCSRCs.begin(), vCSRCs.end(), [&ob](uint32_t uiCSRC)
+  for (uint32_t i = 0; i < rtpHeader.getCC(); ++i)
   {
-    ob.write(uiCSRC,     32);
-  } 
-  );
+    ob.write(rtpHeader.getCSRC(i), 32);
+  }
 
   // write extension header
-  rfc5285::RtpHeaderExtension extension = rtpHeader.getHeaderExtension();
+  const rfc5285::RtpHeaderExtension& extension = rtpHeader.getHeaderExtension();
   if (extension.containsExtensions())
   {
     extension.writeExtensionData(ob);
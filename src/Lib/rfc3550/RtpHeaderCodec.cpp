@@ -0,0 +1,68 @@
+#include "CorePch.h"
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
+
+namespace rtp_plus_plus
+{
+namespace rfc3550
+{
+
+uint32_t RtpHeaderCodec::write(const RtpHeader& rtpHeader, uint8_t* pDest)
+{
+  pDest[0] = static_cast<uint8_t>((rtpHeader.getVersion() << 6) |
+                                  (rtpHeader.hasPadding() ? 0x20 : 0) |
+                                  (rtpHeader.hasExtension() ? 0x10 : 0) |
+                                  (rtpHeader.getCC() & 0x0F));
+  pDest[1] = static_cast<uint8_t>((rtpHeader.isMarkerSet() ? 0x80 : 0) | (rtpHeader.getPayloadType() & 0x7F));
+  writeUint16(pDest + 2, rtpHeader.getSequenceNumber());
+  writeUint32(pDest + 4, rtpHeader.getRtpTimestamp());
+  writeUint32(pDest + 8, rtpHeader.getSSRC());
+
+  uint32_t uiOffset = MIN_RTP_HEADER_SIZE;
+  for (uint32_t i = 0; i < rtpHeader.getCC(); ++i, uiOffset += 4)
+  {
+    writeUint32(pDest + uiOffset, rtpHeader.getCSRC(i));
+  }
+  return uiOffset;
+}
+
+bool RtpHeaderCodec::parse(const uint8_t* pData, uint32_t uiSize, RtpHeaderFields& fields)
+{
+  if (uiSize < MIN_RTP_HEADER_SIZE) return false;
+  // we don't support RTP version other than version 2
+  if ((pData[0] >> 6) != RTP_VERSION_NUMBER) return false;
+
+  fields.Padding = (pData[0] & 0x20) != 0;
+  fields.Extension = (pData[0] & 0x10) != 0;
+  fields.CsrcCount = pData[0] & 0x0F;
+  fields.Marker = (pData[1] & 0x80) != 0;
+  fields.PayloadType = pData[1] & 0x7F;
+  fields.SequenceNumber = readUint16(pData + 2);
+  fields.RtpTimestamp = readUint32(pData + 4);
+  fields.SSRC = readUint32(pData + 8);
+
+  uint32_t uiHeaderSize = MIN_RTP_HEADER_SIZE + 4 * fields.CsrcCount;
+  if (uiSize < uiHeaderSize) return false;
+
+  if (fields.Extension)
+  {
+    if (uiSize < uiHeaderSize + MIN_EXTENSION_HEADER_SIZE) return false;
+    fields.ExtensionOffset = uiHeaderSize;
+    // the length excludes the 4 byte extension header
+    uint32_t uiExtensionLengthInWords = readUint16(pData + uiHeaderSize + 2);
+    uiHeaderSize += MIN_EXTENSION_HEADER_SIZE + 4 * uiExtensionLengthInWords;
+    if (uiSize < uiHeaderSize) return false;
+  }
+  fields.HeaderSize = uiHeaderSize;
+
+  fields.PaddingSize = 0;
+  if (fields.Padding)
+  {
+    // the last octet contains the number of padding octets including itself
+    fields.PaddingSize = pData[uiSize - 1];
+    if (fields.PaddingSize == 0 || fields.PaddingSize > uiSize - uiHeaderSize) return false;
+  }
+  return true;
+}
+
+} // rfc3550
+} // rtp_plus_plus
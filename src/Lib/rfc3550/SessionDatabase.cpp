@@ -5,6 +5,7 @@
 #include <rtp++/RtpSessionState.h>
 #include <rtp++/rfc3550/ComputeRtcpInterval.h>
 #include <rtp++/rfc3611/XrMemberEntry.h>
+#include <rtp++/util/Clock.h>
 
 #define COMPONENT_LOG_LEVEL 10
 
@@ -24,6 +25,10 @@ SessionDatabase::SessionDatabase( RtpSessionState& rtpSessionState,
   :m_rtpSessionState(rtpSessionState),
     m_rtpParameters(rtpParameters),
     m_uiRtcpBandwidthFraction(RECOMMENDED_RTCP_BANDWIDTH_PERCENTAGE),
+    m_uiMaxReportedSenders(0),
+    m_uiNextReportedSender(0),
+    m_uiOutgoingFeedbackSize(0),
+    m_uiIncomingFeedbackSize(0),
     m_dTransmissionInterval(0),
     m_bUseReducedMinimum(false),
     m_bXrEnabled(rtpParameters.isXrEnabled())
@@ -39,11 +44,6 @@ SessionDatabase::SessionDatabase( RtpSessionState& rtpSessionState,
 
 SessionDatabase::~SessionDatabase()
 {
-  std::for_each(m_memberDb.begin(), m_memberDb.end(), [](MemberEntry_t& entry)
-  {
-    MemberEntry* pEntry = entry.second;
-    delete pEntry;
-  });
 }
 
 void SessionDatabase::updateSSRCs()
@@ -74,10 +74,10 @@ void SessionDatabase::initialiseLocalSSRCs()
 
 bool SessionDatabase::isSourceValid(uint32_t uiSSRC) const
 {
-  auto it = m_memberDb.find(uiSSRC);
-  if (it != m_memberDb.end())
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  if (uiIndex != MemberTable::NPOS)
   {
-    return it->second->isValid();
+    return m_memberDb.getEntry(uiIndex)->isValid();
   }
   else
   {
@@ -88,11 +88,11 @@ bool SessionDatabase::isSourceValid(uint32_t uiSSRC) const
 bool SessionDatabase::isSender(const uint32_t uiSSRC) const
 {
   // get our member entry
-  auto it = m_memberDb.find(uiSSRC);
-  if (it == m_memberDb.end()) return false;
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  if (uiIndex == MemberTable::NPOS) return false;
   else
   {
-    const MemberEntry* pEntry = it->second;
+    const MemberEntry* pEntry = m_memberDb.getEntry(uiIndex);
     // store previous interval history
     return (pEntry->isSender());
   }
@@ -100,11 +100,11 @@ bool SessionDatabase::isSender(const uint32_t uiSSRC) const
 
 bool SessionDatabase::isSourceSynchronised(const uint32_t uiSSRC) const
 {
-  auto it = m_memberDb.find(uiSSRC);
-  if (it == m_memberDb.end()) return false;
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  if (uiIndex == MemberTable::NPOS) return false;
   else
   {
-    const MemberEntry* pEntry = it->second;
+    const MemberEntry* pEntry = m_memberDb.getEntry(uiIndex);
     // store previous interval history
     return (pEntry->isRtcpSychronised());
   }
@@ -120,9 +120,9 @@ bool SessionDatabase::isOurSSRC(uint32_t uiSSRC) const
 RtcpReportData_t SessionDatabase::gatherRTCPReportDataAndBeginNewInterval()
 {
   // get our member entry
-  auto it = m_memberDb.find(m_rtpSessionState.getSSRC());
-  assert(it != m_memberDb.end());
-  MemberEntry* pOurEntry = it->second;
+  uint32_t uiOurIndex = m_memberDb.find(m_rtpSessionState.getSSRC());
+  assert(uiOurIndex != MemberTable::NPOS);
+  MemberEntry* pOurEntry = m_memberDb.getEntry(uiOurIndex);
   if (pOurEntry->isSender())
   {
     //VLOG(2) << "WE ARE A SENDER";
@@ -134,44 +134,47 @@ RtcpReportData_t SessionDatabase::gatherRTCPReportDataAndBeginNewInterval()
     m_we_sent = false;
   }
 
-  std::vector<MemberEntry*> vSenderList;
+  m_vSenderList.clear();
+  m_vReceiverList.clear();
 
   // we do this by checking if the participant *sent* a packet
   // only add a reportblock if the participant sent something
-
-  std::for_each(m_memberDb.begin(), m_memberDb.end(), [&vSenderList, this]( std::pair<const uint32_t, MemberEntry*>& entry)
+  // If the number of reported senders is limited, start where the last interval stopped
+  const uint32_t uiMembers = m_memberDb.size();
+  if (m_uiNextReportedSender >= uiMembers) m_uiNextReportedSender = 0;
+  uint32_t uiIndex = m_uiNextReportedSender;
+  for (uint32_t i = 0; i < uiMembers; ++i, ++uiIndex)
   {
-    // check if we have received data in the last reporting interval from each participant
-    MemberEntry* pEntry = entry.second;
-    if (pEntry->isSender())
+    if (uiIndex == uiMembers) uiIndex = 0;
+    MemberEntry* pEntry = m_memberDb.getEntry(uiIndex);
+    if (!isOurSSRC(m_memberDb.getSSRC(uiIndex)))
     {
-      if (!isOurSSRC(entry.first))
+      // check if we have received data in the last reporting interval from each participant
+      if (pEntry->isSender())
       {
-        pEntry->finaliseRRData();
-        vSenderList.push_back(pEntry);
+        if (m_uiMaxReportedSenders == 0)
+        {
+          pEntry->finaliseRRData();
+          m_vSenderList.push_back(pEntry);
+        }
+        else if (m_vSenderList.size() < m_uiMaxReportedSenders)
+        {
+          pEntry->finaliseRRData();
+          m_vSenderList.push_back(pEntry);
+          m_uiNextReportedSender = uiIndex + 1;
+        }
       }
-    }
-    pEntry->newReportingInterval();
-  });
-
-  // add receiver info
-  std::vector<MemberEntry*> vReceiverList;
-  std::for_each(m_memberDb.begin(), m_memberDb.end(), [&vReceiverList, this]( std::pair<const uint32_t, MemberEntry*>& entry)
-  {
-    // check if we have received data in the last reporting interval from each participant
-    MemberEntry* pEntry = entry.second;
-    if (!pEntry->isSender())
-    {
-      if (!isOurSSRC(entry.first))
+      else
       {
+        // add receiver info
         pEntry->finaliseData();
-        vReceiverList.push_back(pEntry);
+        m_vReceiverList.push_back(pEntry);
       }
     }
     pEntry->newReportingInterval();
-  });
+  }
 
-  return std::make_tuple(m_we_sent, vSenderList, vReceiverList);
+  return RtcpReportData_t(m_we_sent, m_vSenderList, m_vReceiverList);
 }
 
 void SessionDatabase::onSendRtpPacket(const RtpPacket& packet, const EndPoint &ep)
@@ -187,15 +190,16 @@ void SessionDatabase::onSendRtcpPacket(const CompoundRtcpPacket& compoundPacket,
   if (m_initial)
   {
     m_initial = false;
-    m_tp = boost::posix_time::microsec_clock::universal_time();
+    m_tp = Clock::universalTime();
   }
   else
   {
     m_tp_prev = m_tp;
-    m_tp = boost::posix_time::microsec_clock::universal_time();
+    m_tp = Clock::universalTime();
   }
 
-  m_avg_rtcp_size = 0.0625 * compoundRtcpPacketSize(compoundPacket) + 0.9375 * m_avg_rtcp_size;
+  m_avg_rtcp_size = 0.0625 * (compoundRtcpPacketSize(compoundPacket) + m_uiOutgoingFeedbackSize) + 0.9375 * m_avg_rtcp_size;
+  m_uiOutgoingFeedbackSize = 0;
 
 #ifdef DEBUG_RTCP_SCHEDULING
   LOG(INFO) << "Updated average RTCP size: " << m_avg_rtcp_size;
@@ -223,10 +227,12 @@ void SessionDatabase::processOutgoingRtpPacket(const RtpPacket& packet)
   // update local state
   // this method also uses the MemberEntry info to set the extended RTP sequence number on the packet
 #if 0
-  VLOG(2) << "DBG: SSRC: " << packet.getSSRC() << " in DB: " << (m_memberDb.find(packet.getSSRC()) != m_memberDb.end());
-  assert(m_memberDb.find(packet.getSSRC()) != m_memberDb.end());
+  VLOG(2) << "DBG: SSRC: " << packet.getSSRC() << " in DB: " << (m_memberDb.find(packet.getSSRC()) != MemberTable::NPOS);
+  assert(m_memberDb.find(packet.getSSRC()) != MemberTable::NPOS);
 #endif
-  m_memberDb[packet.getSSRC()]->onSendRtpPacket(packet);
+  uint32_t uiIndex = m_memberDb.find(packet.getSSRC());
+  m_memberDb.getEntry(uiIndex)->onSendRtpPacket(packet);
+  m_memberDb.touch(uiIndex);
 }
 
 void SessionDatabase::processIncomingRtpPacket(const RtpPacket& packet, const EndPoint &ep, uint32_t uiRtpTimestampFrequency, bool &bIsSSRCValid, bool &bIsRtcpSyncronised, boost::posix_time::ptime& tPresentation)
@@ -243,19 +249,19 @@ void SessionDatabase::processIncomingRtpPacket(const RtpPacket& packet, const En
   bIsSSRCValid = isSourceValid(uiSSRC);
   // update local state
   // this method also uses the MemberEntry info to set the extended RTP sequence number on the packet
-  m_memberDb[packet.getSSRC()]->onReceiveRtpPacket(packet, uiRtpTimestampFrequency, bIsRtcpSyncronised, tPresentation);
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  m_memberDb.getEntry(uiIndex)->onReceiveRtpPacket(packet, uiRtpTimestampFrequency, bIsRtcpSyncronised, tPresentation);
+  m_memberDb.touch(uiIndex);
 
   /*
    * The same processing occurs for each
    * CSRC in a validated RTP packet.
    */
-  const std::vector<uint32_t> vCSRCs = packet.getHeader().getCSRCs();
-  std::for_each(vCSRCs.begin(),
-      vCSRCs.end(),
-      [this, packet](uint32_t uiCSRC)
+  const rfc3550::RtpHeader& header = packet.getHeader();
+  for (uint32_t i = 0; i < header.getCC(); ++i)
   {
-    processParticipant(uiCSRC, packet);
-  });
+    processParticipant(header.getCSRC(i), packet);
+  }
 }
 
 void SessionDatabase::processIncomingRtcpPacket(const CompoundRtcpPacket& compoundPacket, const EndPoint& ep)
@@ -273,7 +279,8 @@ void SessionDatabase::processIncomingRtcpPacket(const CompoundRtcpPacket& compou
 
      where packet_size is the size of the RTCP packet just received.
   */
-  m_avg_rtcp_size = 0.0625 * compoundRtcpPacketSize(compoundPacket) + 0.9375 * m_avg_rtcp_size;
+  m_avg_rtcp_size = 0.0625 * (compoundRtcpPacketSize(compoundPacket) + m_uiIncomingFeedbackSize) + 0.9375 * m_avg_rtcp_size;
+  m_uiIncomingFeedbackSize = 0;
 
 #ifdef DEBUG_RTCP_SCHEDULING
   LOG(INFO) << "Updated average RTCP size: " << m_avg_rtcp_size;
@@ -287,7 +294,7 @@ void SessionDatabase::processIncomingRtcpPacket(const RtcpPacketBase& packet, co
 
 bool SessionDatabase::isNewSSRC(uint32_t uiSSRC) const
 {
-  return m_memberDb.find(uiSSRC) == m_memberDb.end();
+  return m_memberDb.find(uiSSRC) == MemberTable::NPOS;
 }
 
 void SessionDatabase::processParticipant(uint32_t uiSSRC, const RtpPacket& packet)
@@ -349,10 +356,10 @@ void SessionDatabase::processSdesReportBlocks(const std::vector<rfc3550::RtcpSde
   {
     uint32_t uiSSRC = report.getSSRC_CSRC1();
     // look up SSRC
-    auto it = m_memberDb.find(uiSSRC);
-    if (it != m_memberDb.end())
+    uint32_t uiIndex = m_memberDb.find(uiSSRC);
+    if (uiIndex != MemberTable::NPOS)
     {
-      it->second->updateSdesInfo(report);
+      m_memberDb.getEntry(uiIndex)->updateSdesInfo(report);
     }
   });
 }
@@ -363,10 +370,11 @@ void SessionDatabase::processBye(const rfc3550::RtcpBye& bye)
   std::for_each(vSSRCs.begin(), vSSRCs.end(), [this](uint32_t uiSSRC)
   {
     // look up SSRC
-    auto it = m_memberDb.find(uiSSRC);
-    if (it != m_memberDb.end())
+    uint32_t uiIndex = m_memberDb.find(uiSSRC);
+    if (uiIndex != MemberTable::NPOS)
     {
-      it->second->onByeReceived();
+      m_memberDb.getEntry(uiIndex)->onByeReceived();
+      m_memberDb.touch(uiIndex);
     }
   });
 
@@ -473,26 +481,17 @@ void SessionDatabase::doProcessIncomingRtcpPacket(const RtcpPacketBase& packet,
 
 uint32_t SessionDatabase::getActiveMemberCount() const
 {
-  return std::count_if(m_memberDb.begin(), m_memberDb.end(), [](MemberEntry_t entry)
-  {
-    return entry.second->isValid();
-  });
+  return m_memberDb.getValidCount();
 }
 
 uint32_t SessionDatabase::getInactiveMemberCount() const
 {
-  return std::count_if(m_memberDb.begin(), m_memberDb.end(), [](MemberEntry_t entry)
-  {
-    return entry.second->isInactive();
-  });
+  return m_memberDb.getInactiveCount();
 }
 
 uint32_t SessionDatabase::getUnvalidatedMemberCount() const
 {
-  return std::count_if(m_memberDb.begin(), m_memberDb.end(), [](MemberEntry_t entry)
-  {
-    return entry.second->isUnvalidated();
-  });
+  return m_memberDb.getUnvalidatedCount();
 }
 
 uint32_t SessionDatabase::getTotalMemberCount() const
@@ -502,11 +501,7 @@ uint32_t SessionDatabase::getTotalMemberCount() const
 
 uint32_t SessionDatabase::getSenderCount() const
 {
-  // assert (m_senders == getSenderCount());
-  return std::count_if(m_memberDb.begin(), m_memberDb.end(), [](MemberEntry_t entry)
-  {
-    return entry.second->isSender();
-  });
+  return m_memberDb.getSenderCount();
 }
 
 void SessionDatabase::checkMemberDatabase()
@@ -538,40 +533,40 @@ void SessionDatabase::checkMemberDatabase()
                                                             false,
                                                             false); // randomisation should not be applied to timeouts
 
-  boost::posix_time::ptime tCurrent = boost::posix_time::microsec_clock::universal_time();
+  const int64_t iCurrentNs = Clock::monotonicNs();
 
   uint32_t uiTimeoutMs = static_cast<uint32_t>(dTransmissionInterval * 1000 * TIMEOUT_MULTIPLIER + 0.5);
-  boost::posix_time::ptime tTimeout = tCurrent - boost::posix_time::milliseconds(uiTimeoutMs);
+  const int64_t iTimeoutNs = iCurrentNs - static_cast<int64_t>(uiTimeoutMs) * 1000000;
 
   // go through participant list to check
   uint32_t uiSenderTimeoutMs = static_cast<uint32_t>(dTransmissionInterval * 1000 * 2 + 0.5);
-  boost::posix_time::ptime tSenderTimeout = tCurrent - boost::posix_time::milliseconds(uiSenderTimeoutMs);
+  const int64_t iSenderTimeoutNs = iCurrentNs - static_cast<int64_t>(uiSenderTimeoutMs) * 1000000;
 
 #ifdef DDEBUG_SSRC_TIMEOUT
   VLOG(5) << "SSRC timeout :" << uiTimeoutMs << "ms sender timeout: " << uiSenderTimeoutMs << "ms Deterministic: " << dTransmissionInterval << "s";
 #endif
 
-  // go through participant list
-  std::vector<uint32_t> vRemovalList;
-  std::for_each(m_memberDb.begin(), m_memberDb.end(), [this, &tCurrent, &tTimeout, &tSenderTimeout, &vRemovalList]( MemberEntry_t& entry)
+  // go through participant list: iterating backwards since removal moves the last member
+  for (uint32_t uiIndex = m_memberDb.size(); uiIndex-- > 0; )
   {
-    MemberEntry* pEntry = entry.second;
+    const uint32_t uiSSRC = m_memberDb.getSSRC(uiIndex);
+    MemberEntry* pEntry = m_memberDb.getEntry(uiIndex);
     // make sure we don't want to time ourselves out
-    if ( !isOurSSRC(entry.first) )
+    if ( !isOurSSRC(uiSSRC) )
     {
       // check for timeout and for inactive members
-      if (pEntry->getTimeLastPacketSent() < tTimeout || pEntry->isInactiveAndCanBeRemoved(tCurrent))
+      if (pEntry->getLastPacketSentNs() < iTimeoutNs || pEntry->isInactiveAndCanBeRemoved(iCurrentNs))
       {
-        VLOG(2) << "Marking participant for removal: " << hex(entry.first)
-                << " Now: " << tCurrent
-                << " Last packet sent: " << pEntry->getTimeLastPacketSent()
-                << " Timeout: " << tTimeout;
-        vRemovalList.push_back(entry.first);
+        VLOG(2) << "Removing participant " << hex(uiSSRC) << " from session database"
+                << " Last packet sent: " << (iCurrentNs - pEntry->getLastPacketSentNs()) / 1000000 << "ms ago"
+                << " Timeout: " << uiTimeoutMs << "ms";
+        m_memberDb.removeAt(uiIndex);
+        continue;
       }
     }
 
     // Don't want to timeout our own SSRC or RTX SSRC
-    // if ( !isOurSSRC(entry.first) )
+    // if ( !isOurSSRC(uiSSRC) )
     {
       // NOTE: RG: how do we handle RX sessions in which there are not frequent
       // RTP packets. Currently we are still sending RTCP to keep the session alive
@@ -579,25 +574,14 @@ void SessionDatabase::checkMemberDatabase()
       // the last RTP packet was sent
       // TODO: could still add code to identify which SSRC belongs to a sender RX session
       // update the sender status of members
-      if (pEntry->isSender() && pEntry->getTimeLastPacketSent() < tSenderTimeout)
+      if (pEntry->isSender() && pEntry->getLastPacketSentNs() < iSenderTimeoutNs)
       {
-        VLOG(2) << "Participant " << hex(entry.first) << " is no longer a sender";
+        VLOG(2) << "Participant " << hex(uiSSRC) << " is no longer a sender";
         pEntry->setSender(false);
+        m_memberDb.touch(uiIndex);
       }
     }
-  });
-
-  // remove from session database
-  std::for_each(vRemovalList.begin(), vRemovalList.end(), [this](uint32_t uiSSRC)
-  {
-    auto it = m_memberDb.find(uiSSRC);
-    if (it != m_memberDb.end())
-    {
-      VLOG(2) << "Removing participant " << hex(uiSSRC) << " from session database";
-      delete it->second;
-      m_memberDb.erase(it);
-    }
-  });
+  }
 }
 
 void SessionDatabase::RFC3550_initialization()
@@ -629,14 +613,16 @@ uint32_t SessionDatabase::calculateEstimatedRtcpSize() const
 
 MemberEntry* SessionDatabase::lookupMemberEntryInSessionDb(uint32_t uiSSRC)
 {
-  auto it = m_memberDb.find(uiSSRC);
-  if (it == m_memberDb.end())
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  if (uiIndex == MemberTable::NPOS)
   {
     return nullptr;
   }
   else
   {
-    return it->second;
+    // the caller may change the state of the member
+    m_memberDb.touch(uiIndex);
+    return m_memberDb.getEntry(uiIndex);
   }
 }
 
@@ -656,31 +642,35 @@ MemberEntry* SessionDatabase::createMemberEntry(uint32_t uiSSRC)
 
 MemberEntry* SessionDatabase::insertSSRCIfNotInSessionDb(uint32_t uiSSRC)
 {
-  auto it = m_memberDb.find(uiSSRC);
-  if (it == m_memberDb.end())
+  uint32_t uiIndex = m_memberDb.find(uiSSRC);
+  if (uiIndex == MemberTable::NPOS)
   {
     DLOG(INFO) << "Inserting new SSRC into DB: " << hex(uiSSRC);
-    m_memberDb[uiSSRC] = createMemberEntry(uiSSRC);
+    MemberEntry* pEntry = createMemberEntry(uiSSRC);
+    uiIndex = m_memberDb.insert(uiSSRC, std::unique_ptr<MemberEntry>(pEntry));
 
     // Member entries need to know what the local SSRCs are
     // so that they can determine if a report is important
     // and needs to be processed
     // add local SSRCS for report types that are about the local participant
-    m_memberDb[uiSSRC]->addLocalSSRC(m_rtpSessionState.getSSRC());
+    pEntry->addLocalSSRC(m_rtpSessionState.getSSRC());
     if (m_rtpParameters.isRetransmissionEnabled())
     {
-      m_memberDb[uiSSRC]->addLocalSSRC(m_rtpSessionState.getRtxSSRC());
+      pEntry->addLocalSSRC(m_rtpSessionState.getRtxSSRC());
     }
 
     // turn of detailed loss detection: the "analyse" cmd flag has been added which
     // stores all sequence numbers and logs them at the end of the session. This is more
     // accurate in scenarios where packets may arrive out of order
-    m_memberDb[uiSSRC]->disableDetailedLossDetection();
+    pEntry->disableDetailedLossDetection();
 
     // set update callback here so that we always forward notifications
-    m_memberDb[uiSSRC]->setUpdateCallback(std::bind(&SessionDatabase::onMemberUpdate, this, std::placeholders::_1));
+    pEntry->setUpdateCallback(std::bind(&SessionDatabase::onMemberUpdate, this, std::placeholders::_1));
+    return pEntry;
   }
-  return m_memberDb[uiSSRC];
+  // the caller may change the state of the member
+  m_memberDb.touch(uiIndex);
+  return m_memberDb.getEntry(uiIndex);
 }
 
 } // rfc3550
@@ -67,18 +67,11 @@ bool MuxedTcpRtpNetworkInterface::recv()
 
 bool MuxedTcpRtpNetworkInterface::sendDataOverTcp(Buffer buffer, const EndPoint& ep, bool bIsRtp)
 {
-  if (bIsRtp)
-  {
-    // we need to keep track of the packet oder in which RTP/RTCP is sent
-    // RTP and RTCP may be sent concurrently: need to lock type queue
-    boost::mutex::scoped_lock l(m_lock);
-    m_qTypes.push_back(RTP_PACKET);
-  }
-  else
-  {
-    boost::mutex::scoped_lock l(m_lock);
-    m_qTypes.push_back(COMPOUND_RTCP_PACKET);
-  }
+  // we need to keep track of the packet oder in which RTP/RTCP is sent
+  // RTP and RTCP may be sent concurrently: the lock is held while queueing
+  // so that the type queue matches the order of the connection send queue
+  boost::mutex::scoped_lock l(m_lock);
+  m_qTypes.push_back(bIsRtp ? RTP_PACKET : COMPOUND_RTCP_PACKET);
 
   if (m_bIsActiveConnection)
   {
@@ -99,19 +92,29 @@ bool MuxedTcpRtpNetworkInterface::sendDataOverTcp(Buffer buffer, const EndPoint&
 //        LOG(INFO) << "Connection previously created!!!!!";
 //      }
 //    }
-    m_pConnection->send(buffer, m_localRtpEp);
+    if (!m_pConnection->send(buffer, m_localRtpEp))
+    {
+      // the packet was dropped: no send completion will be reported
+      m_qTypes.pop_back();
+      return false;
+    }
     return true;
   }
   else
   {
     if (m_bConnected && m_pConnection)
     {
-      m_pConnection->send(buffer, m_localRtpEp);
+      if (!m_pConnection->send(buffer, m_localRtpEp))
+      {
+        m_qTypes.pop_back();
+        return false;
+      }
       return true;
     }
     else
     {
       VLOG(2)  << "Couldn't get connection for RTP: connection in progress?";
+      m_qTypes.pop_back();
       return false;
     }
   }
@@ -20,6 +20,20 @@ namespace rtp_plus_plus
 namespace rfc4585
 {
 
+// retrieves the marked sequence numbers in ascending order and clears them
+static std::vector<uint32_t> takeMarked(SequenceNumberWindow& window)
+{
+  std::vector<uint32_t> vSN;
+  if (window.getCount() == 0) return vSN;
+  vSN.reserve(window.getCount());
+  window.forEachMarked(window.getLowest(), window.getHighest() + 1, [&vSN](uint32_t uiSN)
+  {
+    vSN.push_back(uiSN);
+  });
+  window.unmarkAll();
+  return vSN;
+}
+
 FeedbackManager::FeedbackManager(const RtpSessionParameters& rtpParameters,
                                  const GenericParameters &applicationParameters,
                                  boost::asio::io_service &rIoService)
@@ -122,7 +136,7 @@ void FeedbackManager::onPacketArrival(const boost::posix_time::ptime& tArrival,
     }
     case FB_ACK:
     {
-      m_vReceivedSN.push_back(uiSN);
+      m_received.mark(uiSN);
       break;
     }
   }
@@ -136,7 +150,7 @@ void FeedbackManager::onPacketArrival(const boost::posix_time::ptime &tArrival,
 void FeedbackManager::onRtpPacketAssumedLost(uint32_t uiSN)
 {
   VLOG(1) << "Packet " << uiSN << " assumed lost";
-  m_vAssumedLost.push_back(uiSN);
+  m_assumedLost.mark(uiSN);
 
   if (m_onLoss) m_onLoss(uiSN);
 }
@@ -166,7 +180,7 @@ void FeedbackManager::onRtxPacketArrival(const boost::posix_time::ptime& tArriva
     }
     case FB_ACK:
     {
-      m_vReceivedSN.push_back(uiOriginalSN);
+      m_received.mark(m_received.extend(uiOriginalSN));
       break;
     }
   }
@@ -214,14 +228,10 @@ bool FeedbackManager::onRtpPacketLate(uint32_t uiSN)
 {
   VLOG(1) << "Packet " << uiSN << " late";
   // try remove packet if it is not too late already
-  for (auto it = m_vAssumedLost.begin(); it != m_vAssumedLost.end(); ++it)
+  if (m_assumedLost.unmark(uiSN))
   {
-    if (uiSN == *it)
-    {
-      VLOG(5) << "Removed late packet from feedback request: " << uiSN;
-      m_vAssumedLost.erase(it);
-      return true;
-    }
+    VLOG(5) << "Removed late packet from feedback request: " << uiSN;
+    return true;
   }
   VLOG(5) << "Too late to remove late packet from feedback request: " << uiSN;
   return false;
@@ -298,26 +308,22 @@ void FeedbackManager::addGenericAcks(CompoundRtcpPacket &vFeedback)
 
 uint32_t FeedbackManager::getAssumedLostCount() const
 {
-  return m_vAssumedLost.size();
+  return m_assumedLost.getCount();
 }
 
 uint32_t FeedbackManager::getReceivedCount() const
 {
-  return m_vReceivedSN.size();
+  return m_received.getCount();
 }
 
 std::vector<uint32_t> FeedbackManager::getAssumedLost()
 {
-  std::vector<uint32_t> vAssumedLost;
-  std::swap(vAssumedLost, m_vAssumedLost);
-  return vAssumedLost;
+  return takeMarked(m_assumedLost);
 }
 
 std::vector<uint32_t> FeedbackManager::getReceived()
 {
-  std::vector<uint32_t> vReceivedSN;
-  std::swap(vReceivedSN, m_vReceivedSN);
-  return vReceivedSN;
+  return takeMarked(m_received);
 }
 
 } // rfc4585
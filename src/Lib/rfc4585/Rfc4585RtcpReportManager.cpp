@@ -165,6 +165,38 @@ CompoundRtcpPacket RtcpReportManager::createAdditionalReports(const rfc3550::Rtc
   return rtcpPackets;
 }
 
+void RtcpReportManager::retrieveFeedback()
+{
+  m_feedbackWriter.reset();
+  if (m_fnFeedbackWriter && m_onRtcpFeedback)
+  {
+    m_fnFeedbackWriter(m_vFeedback, m_feedbackWriter);
+    VLOG_IF(COMPONENT_LOG_LEVEL, m_feedbackWriter.getPacketCount() > 0) << "Wrote " << m_feedbackWriter.getPacketCount()
+                                                                        << " feedback messages (" << m_feedbackWriter.getSize() << " bytes)";
+  }
+  else if (m_fnFeedback)
+  {
+    m_fnFeedback(m_vFeedback);
+  }
+  else
+  {
+    LOG_FIRST_N(WARNING, 1) << "No feedback callback configured";
+  }
+  VLOG_IF(COMPONENT_LOG_LEVEL, !m_vFeedback.empty()) << "Retrieved " << m_vFeedback.size() << " feedback messages for insertion into RTCP compound packet";
+}
+
+void RtcpReportManager::sendRtcpPacketWithFeedback(bool bIsMinimalPacketAllowed)
+{
+  if (m_feedbackWriter.getPacketCount() == 0)
+  {
+    sendRtcpPacket(bIsMinimalPacketAllowed);
+    return;
+  }
+  // the written feedback is appended to the compound packet when it is packetised
+  CompoundRtcpPacket compoundPacket = generateCompoundRtcpPacket(false, bIsMinimalPacketAllowed);
+  m_onRtcpFeedback(compoundPacket, m_feedbackWriter.getBuffer());
+}
+
 void RtcpReportManager::onRtcpIntervalTimeout(const boost::system::error_code& ec)
 {
   if (m_bShuttingDown)
@@ -185,15 +217,7 @@ void RtcpReportManager::onRtcpIntervalTimeout(const boost::system::error_code& e
 
       // get feedback from feedback callback
       // we need this to determine whether FB can be suppressed
-      if (m_fnFeedback)
-      {
-        m_fnFeedback(m_vFeedback);
-        VLOG_IF(COMPONENT_LOG_LEVEL, !m_vFeedback.empty()) << "Retrieved " << m_vFeedback.size() << " feedback messages for insertion into RTCP compound packet";
-      }
-      else
-      {
-        LOG_FIRST_N(WARNING, 1) << "No feedback callback configured";
-      }
+      retrieveFeedback();
 
       // Do timer reconsideration according to RFC4585
       if (m_dT_rr_interval != 0.0 && !m_t_rr_last.is_not_a_date_time())
@@ -206,14 +230,14 @@ void RtcpReportManager::onRtcpIntervalTimeout(const boost::system::error_code& e
           VLOG(COMPONENT_LOG_LEVEL) << "Sending regular RTCP packet #1";
   #endif
           // schedule regular
-          sendRtcpPacket();
+          sendRtcpPacketWithFeedback();
           // store t_rr_last as in RFC4585
           m_t_rr_last = m_tNext;
         }
         else
         {
           // t_rr_last MUST remain unchanged for both these cases
-          if (m_vFeedback.empty())
+          if (m_vFeedback.empty() && m_feedbackWriter.getPacketCount() == 0)
           {
             // suppress RTCP
   #ifdef DEBUG_RTCP_SCHEDULING
@@ -223,10 +247,11 @@ void RtcpReportManager::onRtcpIntervalTimeout(const boost::system::error_code& e
           else
           {
   #ifdef DEBUG_RTCP_SCHEDULING
-            VLOG(COMPONENT_LOG_LEVEL) << "Scheduling minimal or regular RTCP with " << m_vFeedback.size() << " feedback messages";
+            VLOG(COMPONENT_LOG_LEVEL) << "Scheduling minimal or regular RTCP with "
+                                      << m_vFeedback.size() + m_feedbackWriter.getPacketCount() << " feedback messages";
   #endif
             // schedule minimal or regular RTCP
-            sendRtcpPacket(m_bSupportsReducedSize);
+            sendRtcpPacketWithFeedback(m_bSupportsReducedSize);
           }
         }
       }
@@ -236,7 +261,7 @@ void RtcpReportManager::onRtcpIntervalTimeout(const boost::system::error_code& e
         VLOG(COMPONENT_LOG_LEVEL) << "Scheduling regular RTCP #2";
   #endif
         // schedule regular
-        sendRtcpPacket();
+        sendRtcpPacketWithFeedback();
         // store t_rr_last as in RFC4585
         m_t_rr_last = m_tNext;
       }
@@ -3,6 +3,8 @@
 #include <boost/foreach.hpp>
 
 #include <cpputil/IBitStream.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
 
 #define DEFAULT_MTU 1500
 #define DEFAULT_BUFFER_SIZE_BYTES 10000
@@ -163,7 +165,7 @@ std::vector<RtpPacket> Rfc4867Packetiser::processStoredMediaSamples()
   
   // TODO: marker bit?
   rtpPacket.getHeader().setMarkerBit(true);
-  rtpPackets.push_back(rtpPacket);
+  rtpPackets.push_back(std::move(rtpPacket));
 
   m_vMediaSamples.clear();
   return rtpPackets;
@@ -235,15 +237,27 @@ std::vector<MediaSample> Rfc4867Packetiser::depacketize(const RtpPacketGroup& rt
 #endif
     }
 
+    if (uiPacketsToBeRead == 1 && rtpPacket.getPayloadSize() >= m_uiFrameSize + 2)
+    {
+      // single frame: the TOC preceding the frame data is identical to the
+      // storage format frame header, so the sample can reference the payload
+      MediaSample mediaSample;
+      mediaSample.setData(sliceBuffer(rtpPacket.getPayload(), 1, m_uiFrameSize + 1));
+      mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
+      mediaSample.setMarker(rtpPacketGroup.isRtcpSynchronised());
+      vSamples.push_back(mediaSample);
+      continue;
+    }
+
     uint8_t* pSource = const_cast<uint8_t*>(rtpPacket.getPayload().data()) + 1 + uiPacketsToBeRead;
     for (size_t i = 0; i < uiPacketsToBeRead; ++i)
     {
       MediaSample mediaSample;
-      uint8_t* pData = new uint8_t[m_uiFrameSize + 1];
+      Buffer payload = BufferPool::allocate(m_uiFrameSize + 1);
+      uint8_t* pData = const_cast<uint8_t*>(payload.data());
       pData[0] = (toc & ~0x80);
       memcpy(pData + 1, pSource, m_uiFrameSize);
       VLOG(12) << "Framesize: " << m_uiFrameSize << " header: " << pData[0] << " value: " << (int)pData[0] << " TOC: " << toc << " value: " << (int)toc;
-      Buffer payload(pData, m_uiFrameSize + 1);
       mediaSample.setData(payload);
       mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
       mediaSample.setMarker(rtpPacketGroup.isRtcpSynchronised());
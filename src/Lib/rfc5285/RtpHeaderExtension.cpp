@@ -1,6 +1,7 @@
 #include "CorePch.h"
 #include <rtp++/rfc5285/RtpHeaderExtension.h>
 #include <cpputil/Utility.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
 
 #define COMPONENT_LOG_LEVEL 10
 
@@ -12,49 +13,115 @@ namespace rfc5285
 RtpHeaderExtension::RtpHeaderExtension(uint16_t uiProfileDefined, RtpHeaderExtensionType eType, uint16_t uiExtensionLengthInWords, uint8_t uiAppBits)
   :m_eType(eType),
     m_uiProfileDefined(uiProfileDefined),
-    m_uiExtensionLengthInWords(uiExtensionLengthInWords),
     m_uiAppBits(uiAppBits),
-    m_uiPadding(0)
+    m_uiExtensionLengthInWords(uiExtensionLengthInWords),
+    m_uiPadding(0),
+    m_uiElementCount(0),
+    m_uiDataSize(0)
 {
 }
 
-RtpHeaderExtension::~RtpHeaderExtension()
+void RtpHeaderExtension::clear()
 {
+  m_received = Buffer();
+  m_uiElementCount = 0;
+  m_vElementOverflow.clear();
+  m_uiDataSize = 0;
+  m_vDataOverflow.clear();
 }
 
-void RtpHeaderExtension::clear()
+bool RtpHeaderExtension::containsExtensions() const
 {
-  m_vHeaderExtensions.clear();
+  return m_received.getSize() > 0 || m_uiElementCount > 0;
 }
 
-bool RtpHeaderExtension::containsExtensions() const { return !empty(); }
-
 bool RtpHeaderExtension::empty() const
 {
-  return m_vHeaderExtensions.empty();
+  return m_uiElementCount == 0;
+}
+
+std::size_t RtpHeaderExtension::getHeaderExtensionCount() const
+{
+  return m_uiElementCount;
+}
+
+HeaderExtensionElementView RtpHeaderExtension::getHeaderExtension(size_t index) const
+{
+  assert(index < m_uiElementCount);
+  const Element& element = getElement(static_cast<uint32_t>(index));
+  return HeaderExtensionElementView(element.Id, element.Length, getElementData(element));
 }
 
-std::size_t RtpHeaderExtension::getHeaderExtensionCount() const { return m_vHeaderExtensions.size(); }
+boost::optional<HeaderExtensionElementView> RtpHeaderExtension::findHeaderExtension(uint32_t uiId) const
+{
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
+  {
+    const Element& element = getElement(i);
+    if (element.Id == uiId)
+      return boost::optional<HeaderExtensionElementView>(HeaderExtensionElementView(element.Id, element.Length, getElementData(element)));
+  }
+  return boost::optional<HeaderExtensionElementView>();
+}
 
-const HeaderExtensionElement& RtpHeaderExtension::getHeaderExtensions(size_t index) const
+std::vector<HeaderExtensionElement> RtpHeaderExtension::getHeaderExtensions() const
 {
-  return m_vHeaderExtensions.at(index);
+  std::vector<HeaderExtensionElement> vHeaderExtensions;
+  for (size_t i = 0; i < getHeaderExtensionCount(); ++i)
+  {
+    HeaderExtensionElementView view = getHeaderExtension(i);
+    vHeaderExtensions.push_back(HeaderExtensionElement(view.getId(), view.getDataLength(), view.getExtensionData()));
+  }
+  return vHeaderExtensions;
 }
 
 void RtpHeaderExtension::addHeaderExtensions(const HeaderExtensionElement& headerExtension)
 {
-  m_vHeaderExtensions.push_back(headerExtension);
+  uint8_t* pData = appendHeaderExtension(headerExtension.getId(), headerExtension.getDataLength());
+  if (pData)
+    memcpy(pData, headerExtension.getExtensionData(), headerExtension.getDataLength());
 }
 
-const std::vector<HeaderExtensionElement>& RtpHeaderExtension::getHeaderExtensions() const { return m_vHeaderExtensions; }
+uint8_t* RtpHeaderExtension::appendHeaderExtension(uint32_t uiId, uint32_t uiDataLength)
+{
+  if (m_received.getSize() > 0)
+    detach();
+
+  if (uiId == 0 || uiId > 255 || uiDataLength > 255)
+  {
+    LOG(WARNING) << "Invalid extension element id " << uiId << " len: " << uiDataLength;
+    return nullptr;
+  }
+
+  Element element;
+  element.Id = static_cast<uint8_t>(uiId);
+  element.Length = static_cast<uint8_t>(uiDataLength);
+  element.Offset = m_uiDataSize;
+  pushElement(element);
+  resizeLocalData(m_uiDataSize + uiDataLength);
+  calculateExtensionProperties();
+  return getLocalData() + element.Offset;
+}
 
 uint32_t RtpHeaderExtension::removeHeaderExtension(const uint32_t uiId)
 {
-  for (auto it = m_vHeaderExtensions.begin(); it != m_vHeaderExtensions.end(); ++it)
+  if (m_received.getSize() > 0)
+    detach();
+
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
   {
-    if (it->getId() == uiId)
+    if (getElement(i).Id == uiId)
     {
-      m_vHeaderExtensions.erase(it);
+      // compact the data of the following elements
+      const Element removed = getElement(i);
+      uint8_t* pData = getLocalData();
+      memmove(pData + removed.Offset, pData + removed.Offset + removed.Length, m_uiDataSize - removed.Offset - removed.Length);
+      resizeLocalData(m_uiDataSize - removed.Length);
+      eraseElement(i);
+      for (uint32_t j = i; j < m_uiElementCount; ++j)
+      {
+        getElement(j).Offset -= removed.Length;
+      }
+      calculateExtensionProperties();
       return 1;
     }
   }
@@ -63,15 +130,17 @@ uint32_t RtpHeaderExtension::removeHeaderExtension(const uint32_t uiId)
 
 uint32_t RtpHeaderExtension::getSize() const
 {
-  if (m_uiExtensionLengthInWords == 0)
-    calculateExtensionProperties();
+  // a received extension is forwarded as is, including extensions of unknown profiles
+  if (m_received.getSize() > 0)
+    return m_received.getSize();
 
-  // if there are no header extensions, then don't count the 4 bytes of the
-  // header extension header
-  if (m_uiExtensionLengthInWords == 0)
+  if (empty())
   {
+    // if there are no header extensions, then don't count the 4 bytes of the
+    // header extension header
     return 0;
   }
+
   return rfc3550::MIN_EXTENSION_HEADER_SIZE + (4* m_uiExtensionLengthInWords);
 }
 
@@ -79,31 +148,35 @@ void RtpHeaderExtension::calculateExtensionProperties() const
 {
   VLOG(COMPONENT_LOG_LEVEL) << "RtpHeaderExtension::calculateExtensionProperties";
   // first check if there are any elements with a length greater than 16
-  // if not, we will use the one byte header extension
-  uint32_t uiTotalBytes = 0;
-  for (HeaderExtensionElement element : m_vHeaderExtensions)
+  // if not, we will use the one byte header extension unless the two byte
+  // header has been configured
+  // the properties of a received extension are those of the received header
+  if (m_received.getSize() > 0) return;
+
+  RtpHeaderExtensionType eType = m_eType;
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
   {
-    VLOG(COMPONENT_LOG_LEVEL) << "Element length: " << element.getDataLength();
-    uiTotalBytes += element.getDataLength();
-    if (element.getDataLength() > 16)
+    const Element& element = getElement(i);
+    if (element.Length > 16 || element.Length == 0 || element.Id > 14)
     {
-      VLOG(COMPONENT_LOG_LEVEL) << "Using two byte extension header: " << element.getDataLength();
-      m_eType = TWO_BYTE_HEADER;
+      VLOG(COMPONENT_LOG_LEVEL) << "Using two byte extension header: id " << (uint32_t)element.Id << " len: " << (uint32_t)element.Length;
+      eType = TWO_BYTE_HEADER;
     }
   }
 
-  switch (m_eType)
+  uint32_t uiTotalBytes = m_uiDataSize;
+  switch (eType)
   {
     case ONE_BYTE_HEADER:
     {
       m_uiProfileDefined = 0xBEDE;
-      uiTotalBytes += m_vHeaderExtensions.size();
+      uiTotalBytes += m_uiElementCount;
       break;
     }
     case TWO_BYTE_HEADER:
     {
       m_uiProfileDefined = (0x0100 << 4) | (m_uiAppBits & 0x0F);
-      uiTotalBytes += 2 * m_vHeaderExtensions.size();
+      uiTotalBytes += 2 * m_uiElementCount;
       break;
     }
     default:
@@ -115,89 +188,151 @@ void RtpHeaderExtension::calculateExtensionProperties() const
   VLOG(COMPONENT_LOG_LEVEL) << "Profile defined: " << m_uiProfileDefined << "(" << hex(m_uiProfileDefined) << ") Total bytes: " << uiTotalBytes;
 
   uint32_t uiRem = uiTotalBytes % 4;
-  if ( uiRem == 0)
-  {
-    m_uiExtensionLengthInWords = uiTotalBytes/4;
-  }
-  else
-  {
-    m_uiPadding = 4 - uiRem;
-    m_uiExtensionLengthInWords = uiTotalBytes/4 + 1;
-  }
+  m_uiPadding = (uiRem == 0) ? 0 : 4 - uiRem;
+  m_uiExtensionLengthInWords = (uiTotalBytes + m_uiPadding)/4;
 }
 
-void RtpHeaderExtension::writeExtensionData(OBitStream& ob) const
+uint32_t RtpHeaderExtension::write(uint8_t* pDest) const
 {
-  // this also sets m_eType
-  calculateExtensionProperties();
+  if (m_received.getSize() > 0)
+  {
+    // forward the received extension unchanged
+    memcpy(pDest, m_received.data(), m_received.getSize());
+    return m_received.getSize();
+  }
+
+  // the header type has been selected via the profile when the elements were added
+  const bool bOneByteHeader = m_uiProfileDefined == PROFILE_ONE_BYTE_HEADER;
 
-  ob.write( m_uiProfileDefined, 16);
-  ob.write( m_uiExtensionLengthInWords, 16);
-  switch (m_eType)
+  rfc3550::RtpHeaderCodec::writeUint16(pDest, m_uiProfileDefined);
+  rfc3550::RtpHeaderCodec::writeUint16(pDest + 2, m_uiExtensionLengthInWords);
+  uint32_t uiOffset = rfc3550::MIN_EXTENSION_HEADER_SIZE;
+  const uint8_t* pData = getLocalData();
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
   {
-    case ONE_BYTE_HEADER:
+    const Element& element = getElement(i);
+    VLOG(COMPONENT_LOG_LEVEL) << "Writing extension element id " << (uint32_t)element.Id << " len: " << (uint32_t)element.Length;
+    if (bOneByteHeader)
     {
-      for (size_t i = 0; i < m_vHeaderExtensions.size(); ++i)
-      {
-        const HeaderExtensionElement& header = m_vHeaderExtensions[i];
-        VLOG(COMPONENT_LOG_LEVEL) << "Writing extension element id " << header.getId() << " len: " << header.getDataLength();
-        ob.write(header.getId(), 4);
-        // NOTE that this fields stores length - 1 in one byte headers
-        ob.write(header.getDataLength() - 1, 4);
-        const uint8_t* pData = header.getExtensionData();
-        ob.writeBytes(pData, header.getDataLength());
-      }
-      break;
+      // NOTE that this fields stores length - 1 in one byte headers
+      pDest[uiOffset++] = static_cast<uint8_t>((element.Id << 4) | (element.Length - 1));
     }
-    case TWO_BYTE_HEADER:
+    else
     {
-      for (size_t i = 0; i < m_vHeaderExtensions.size(); ++i)
-      {
-        const HeaderExtensionElement& header = m_vHeaderExtensions[i];
-        VLOG(COMPONENT_LOG_LEVEL) << "Writing extension element id " << header.getId() << " len: " << header.getDataLength();
-        ob.write(header.getId(), 8);
-        // NOTE that this fields stores length - 1 in one byte headers
-        ob.write(header.getDataLength(), 8);
-        const uint8_t* pData = header.getExtensionData();
-        ob.writeBytes(pData, header.getDataLength());
-      }
-      break;
+      pDest[uiOffset++] = element.Id;
+      pDest[uiOffset++] = element.Length;
     }
+    memcpy(pDest + uiOffset, pData + element.Offset, element.Length);
+    uiOffset += element.Length;
   }
   // padding
-  for (size_t i = 0; i < m_uiPadding; ++i)
-  {
-    ob.write(0, 8);
-  }
+  memset(pDest + uiOffset, 0, m_uiPadding);
+  uiOffset += m_uiPadding;
+  assert(uiOffset == rfc3550::MIN_EXTENSION_HEADER_SIZE + 4 * m_uiExtensionLengthInWords);
+  return uiOffset;
+}
+
+void RtpHeaderExtension::writeExtensionData(OBitStream& ob) const
+{
+  std::vector<uint8_t> vExtension(getSize());
+  if (vExtension.empty()) return;
+  uint32_t uiSize = write(&vExtension[0]);
+  ob.writeBytes(&vExtension[0], uiSize);
 }
 
 void RtpHeaderExtension::readExtensionData(IBitStream& ib)
 {
-  bool res = ib.read(m_uiProfileDefined, 16);
+  uint32_t uiProfileDefined = 0;
+  uint32_t uiExtensionLengthInWords = 0;
+  bool res = ib.read(uiProfileDefined, 16);
+  assert(res);
+  res = ib.read(uiExtensionLengthInWords, 16);
   assert(res);
-  res = ib.read(m_uiExtensionLengthInWords, 16);
+
+  uint32_t uiSize = rfc3550::MIN_EXTENSION_HEADER_SIZE + 4 * uiExtensionLengthInWords;
+  uint8_t* pExtension = new uint8_t[uiSize];
+  rfc3550::RtpHeaderCodec::writeUint16(pExtension, uiProfileDefined);
+  rfc3550::RtpHeaderCodec::writeUint16(pExtension + 2, uiExtensionLengthInWords);
+  res = ib.readBytes(pExtension + rfc3550::MIN_EXTENSION_HEADER_SIZE, uiSize - rfc3550::MIN_EXTENSION_HEADER_SIZE);
   assert(res);
+  setExtensionData(Buffer(pExtension, uiSize));
+}
+
+void RtpHeaderExtension::setExtensionData(const Buffer& extension)
+{
+  assert(extension.getSize() >= rfc3550::MIN_EXTENSION_HEADER_SIZE);
+  clear();
+  m_received = extension;
+  m_uiProfileDefined = rfc3550::RtpHeaderCodec::readUint16(extension.data());
+  m_uiExtensionLengthInWords = rfc3550::RtpHeaderCodec::readUint16(extension.data() + 2);
+  assert(extension.getSize() == rfc3550::MIN_EXTENSION_HEADER_SIZE + 4u * m_uiExtensionLengthInWords);
+  buildIndex();
+}
+
+const uint8_t* RtpHeaderExtension::getElementData(const Element& element) const
+{
+  if (m_received.getSize() > 0)
+    return m_received.data() + rfc3550::MIN_EXTENSION_HEADER_SIZE + element.Offset;
+  return getLocalData() + element.Offset;
+}
+
+void RtpHeaderExtension::pushElement(const Element& element)
+{
+  if (m_uiElementCount < INLINE_ELEMENTS)
+    m_aElements[m_uiElementCount] = element;
+  else
+    m_vElementOverflow.push_back(element);
+  ++m_uiElementCount;
+}
+
+void RtpHeaderExtension::eraseElement(uint32_t uiIndex)
+{
+  assert(uiIndex < m_uiElementCount);
+  for (uint32_t i = uiIndex + 1; i < m_uiElementCount; ++i)
+  {
+    getElement(i - 1) = getElement(i);
+  }
+  if (m_uiElementCount > INLINE_ELEMENTS)
+    m_vElementOverflow.pop_back();
+  --m_uiElementCount;
+}
+
+void RtpHeaderExtension::resizeLocalData(uint32_t uiSize)
+{
+  if (uiSize > INLINE_DATA_SIZE)
+  {
+    if (m_uiDataSize <= INLINE_DATA_SIZE)
+      m_vDataOverflow.assign(m_aData, m_aData + m_uiDataSize);
+    m_vDataOverflow.resize(uiSize);
+  }
+  else if (m_uiDataSize > INLINE_DATA_SIZE)
+  {
+    memcpy(m_aData, m_vDataOverflow.data(), uiSize);
+    m_vDataOverflow.clear();
+  }
+  m_uiDataSize = uiSize;
+}
+
+void RtpHeaderExtension::buildIndex()
+{
+  m_uiElementCount = 0;
+  m_vElementOverflow.clear();
 
   VLOG(COMPONENT_LOG_LEVEL) << "read profile defined " << m_uiProfileDefined << "(" << hex(m_uiProfileDefined) << ") length in words: " << m_uiExtensionLengthInWords;
+  const uint8_t* pData = m_received.data() + rfc3550::MIN_EXTENSION_HEADER_SIZE;
+  const uint32_t uiTotalBytes = m_received.getSize() - rfc3550::MIN_EXTENSION_HEADER_SIZE;
   if (m_uiProfileDefined == PROFILE_ONE_BYTE_HEADER)
   {
-    int32_t iTotalBytesToRead = m_uiExtensionLengthInWords * 4;
-    while (iTotalBytesToRead > 0)
+    uint32_t uiOffset = 0;
+    while (uiOffset < uiTotalBytes)
     {
-      uint32_t uiId = 0;
-      uint32_t uiLength = 0;
-      unsigned char data[HeaderExtensionElement::MAX_HDR_EXT_SIZE];
-      res = ib.read(uiId, 4);
-      assert(res);
-      res = ib.read(uiLength, 4);
-      assert(res);
-      --iTotalBytesToRead;
-      if ( uiId == 15)
+      uint32_t uiId = pData[uiOffset] >> 4;
+      uint32_t uiLength = pData[uiOffset] & 0x0F;
+      ++uiOffset;
+      if (uiId == 15)
       {
         // invalid according to rfc5285: skip rest of headers
-        LOG(WARNING) << " Invalid id for one byte extension header: " << uiId << " skipping rest of extension header: " << iTotalBytesToRead << " bytes";
-        res = ib.skipBytes(iTotalBytesToRead);
-        assert(res);
+        LOG(WARNING) << " Invalid id for one byte extension header: " << uiId << " skipping rest of extension header: " << uiTotalBytes - uiOffset << " bytes";
         break;
       }
       else if (uiId == 0 && uiLength == 0)
@@ -208,47 +343,35 @@ void RtpHeaderExtension::readExtensionData(IBitStream& ib)
 
       VLOG(COMPONENT_LOG_LEVEL) << "Read extension element id " << uiId << " len: " << uiLength + 1;
       // sanity check: one byte header extension length = len field + 1
-      if (uiLength + 1 > (uint32_t) iTotalBytesToRead)
+      if (uiLength + 1 > uiTotalBytes - uiOffset)
       {
-        LOG(WARNING) << " Error parsing one byte extension header: Length " << uiLength << " larger than bytes remaining " << iTotalBytesToRead << " skipping rest of extension header: " << iTotalBytesToRead << " bytes";
-        res = ib.skipBytes(iTotalBytesToRead);
-        assert(res);
+        LOG(WARNING) << " Error parsing one byte extension header: Length " << uiLength << " larger than bytes remaining " << uiTotalBytes - uiOffset << " skipping rest of extension header";
         break;
       }
-      uint8_t* pData = (uint8_t*)data;
-      res = ib.readBytes(pData, uiLength + 1);
-      assert(res);
-
-      HeaderExtensionElement headerExtension(uiId, uiLength + 1, data);
-      m_vHeaderExtensions.push_back(headerExtension);
-
-      iTotalBytesToRead -= (uiLength + 1);
+      Element element;
+      element.Id = static_cast<uint8_t>(uiId);
+      element.Length = static_cast<uint8_t>(uiLength + 1);
+      element.Offset = uiOffset;
+      pushElement(element);
+      uiOffset += uiLength + 1;
     }
   }
   else if ((m_uiProfileDefined >> 4) == 0x100)
   {
-    int32_t iTotalBytesToRead = m_uiExtensionLengthInWords * 4;
-    VLOG(COMPONENT_LOG_LEVEL) << "Parsing two byte header extensions: Total bytes: " << iTotalBytesToRead;
-    while (iTotalBytesToRead > 0)
+    VLOG(COMPONENT_LOG_LEVEL) << "Parsing two byte header extensions: Total bytes: " << uiTotalBytes;
+    uint32_t uiOffset = 0;
+    while (uiOffset < uiTotalBytes)
     {
-      VLOG(COMPONENT_LOG_LEVEL) << "bytes left: " << iTotalBytesToRead;
-      uint32_t uiId = 0;
-      uint32_t uiLength = 0;
-      unsigned char data[HeaderExtensionElement::MAX_HDR_EXT_SIZE];
-      res = ib.read(uiId, 8);
-      assert(res);
-      --iTotalBytesToRead;
-      if (iTotalBytesToRead == 0)
+      uint32_t uiId = pData[uiOffset++];
+      if (uiOffset == uiTotalBytes)
       {
         if (uiId != 0)
         {
           LOG(WARNING) << "Malformed extension, this should be a padding byte but has value " << uiId;
         }
-        continue;
+        break;
       }
-      res = ib.read(uiLength, 8);
-      assert(res);
-      --iTotalBytesToRead;
+      uint32_t uiLength = pData[uiOffset++];
       if (uiId == 0 && uiLength == 0)
       {
         // this is a padding byte which we should just ignore
@@ -256,30 +379,51 @@ void RtpHeaderExtension::readExtensionData(IBitStream& ib)
       }
 
       VLOG(COMPONENT_LOG_LEVEL) << "Read extension element id " << uiId << " len: " << uiLength;
-      if (uiLength > (uint32_t) iTotalBytesToRead)
+      if (uiLength > uiTotalBytes - uiOffset)
       {
-        LOG(WARNING) << " Error parsing two byte extension header: Length " << uiLength << " larger than bytes remaining " << iTotalBytesToRead << " skipping rest of extension header: " << iTotalBytesToRead << " bytes";
-        res = ib.skipBytes(iTotalBytesToRead);
-        assert(res);
+        LOG(WARNING) << " Error parsing two byte extension header: Length " << uiLength << " larger than bytes remaining " << uiTotalBytes - uiOffset << " skipping rest of extension header";
         break;
       }
-      uint8_t* pData = (uint8_t*)data;
-      res = ib.readBytes(pData, uiLength);
-      assert(res);
-
-      HeaderExtensionElement headerExtension(uiId, uiLength, data);
-      m_vHeaderExtensions.push_back(headerExtension);
-
-      iTotalBytesToRead -= uiLength;
+      Element element;
+      element.Id = static_cast<uint8_t>(uiId);
+      element.Length = static_cast<uint8_t>(uiLength);
+      element.Offset = uiOffset;
+      pushElement(element);
+      uiOffset += uiLength;
     }
   }
   else
   {
-    // for now we'll just skip the header
-    LOG(WARNING) << " Unsupported header extension profile: " << m_uiProfileDefined << "(" << hex(m_uiProfileDefined) << ") skipping extension header: " << m_uiExtensionLengthInWords << " words";
-    res = ib.skipBytes(m_uiExtensionLengthInWords * 4);
-    assert(res);
+    // the extension has no elements but is kept so that it can be forwarded
+    LOG(WARNING) << " Unsupported header extension profile: " << m_uiProfileDefined << "(" << hex(m_uiProfileDefined) << ") not parsing extension header: " << m_uiExtensionLengthInWords << " words";
+  }
+}
+
+void RtpHeaderExtension::detach()
+{
+  if (m_uiElementCount == 0)
+  {
+    VLOG(COMPONENT_LOG_LEVEL) << "Discarding received extension without elements: profile " << hex(m_uiProfileDefined);
+  }
+
+  // the offsets are relative to the received extension data
+  const uint8_t* pReceived = m_received.data() + rfc3550::MIN_EXTENSION_HEADER_SIZE;
+  uint32_t uiSize = 0;
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
+    uiSize += getElement(i).Length;
+
+  resizeLocalData(uiSize);
+  uint8_t* pData = getLocalData();
+  uint32_t uiOffset = 0;
+  for (uint32_t i = 0; i < m_uiElementCount; ++i)
+  {
+    Element& element = getElement(i);
+    memcpy(pData + uiOffset, pReceived + element.Offset, element.Length);
+    element.Offset = uiOffset;
+    uiOffset += element.Length;
   }
+  m_received = Buffer();
+  calculateExtensionProperties();
 }
 
 } // rfc5285
@@ -1,5 +1,6 @@
 #include "CorePch.h"
 #include <rtp++/rfc5506/Rfc5506RtcpValidator.h>
+#include <rtp++/RtcpCompoundView.h>
 
 #define COMPONENT_LOG_LEVEL 10
 
@@ -64,5 +65,16 @@ bool RtcpValidator::validateCompoundRtcpPacket(CompoundRtcpPacket compoundPacket
   return true;
 }
 
+bool RtcpValidator::validateCompoundRtcpView(const RtcpCompoundView& compoundView, uint32_t /*uiTotalLength*/)
+{
+  EXIT_ON_TRUE(compoundView.empty(), "Empty compound RTCP packet");
+
+  // check if first packet falls into RTCP range
+  EXIT_ON_TRUE((compoundView[0].getPacketType() < rfc3550::PT_RTCP_SR),
+               "First packet is no valid RTCP packet");
+
+  return true;
+}
+
 } // rfc5506
 } // rtp_plus_plus
@@ -1,5 +1,6 @@
 #include "CorePch.h"
 #include <rtp++/rfc6051/Rfc6051.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
 
 namespace rtp_plus_plus
 {
@@ -29,7 +30,16 @@ rfc5285::HeaderExtensionElement RtpSynchronisationExtensionHeader::create(uint32
   return create(uiRtpSyncExtMapId, uiNtpTimestampMsw, uiNtpTimestampLsw);
 }
 
-boost::optional<uint64_t> RtpSynchronisationExtensionHeader::parseRtpSynchronisationExtensionHeader(const rfc5285::HeaderExtensionElement& headerExtension)
+bool RtpSynchronisationExtensionHeader::append(rfc5285::RtpHeaderExtension& extension, uint32_t uiRtpSyncExtMapId, uint32_t uiNtpTimestampMsw, uint32_t uiNtpTimestampLsw)
+{
+  uint8_t* pData = extension.appendHeaderExtension(uiRtpSyncExtMapId, RTP_SYNC_HEADER_EXT_64_LENGTH);
+  if (!pData) return false;
+  rfc3550::RtpHeaderCodec::writeUint32(pData, uiNtpTimestampMsw);
+  rfc3550::RtpHeaderCodec::writeUint32(pData + 4, uiNtpTimestampLsw);
+  return true;
+}
+
+boost::optional<uint64_t> RtpSynchronisationExtensionHeader::parseRtpSynchronisationExtensionHeader(const rfc5285::HeaderExtensionElementView& headerExtension)
 {
   BitReader reader(headerExtension.getExtensionData(), headerExtension.getDataLength());
 
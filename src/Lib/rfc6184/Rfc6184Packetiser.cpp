@@ -3,6 +3,8 @@
 #include <boost/foreach.hpp>
 
 #include <cpputil/IBitStream.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
 #include <rtp++/media/h264/H264NalUnitTypes.h>
 
 #define DEFAULT_MTU 1500
@@ -34,8 +36,9 @@ Rfc6184Packetiser::Rfc6184Packetiser()
     m_uiBytesAvailableForPayload(m_uiMtu - IP_UDP_RTP_HEADER_SIZE), // NB: this header does not account for the RTP extension header
     m_uiSessionBandwidthKbps(0),
     m_uiEstimatedFrameSize(DEFAULT_BUFFER_SIZE_BYTES),
-    m_outputStream(m_uiEstimatedFrameSize, false),
-    m_bDisableStap(false)
+    m_bDisableStap(false),
+    m_bZeroCopy(false),
+    m_bDeliverIncompleteNalUnits(false)
 {
 
 }
@@ -46,8 +49,9 @@ Rfc6184Packetiser::Rfc6184Packetiser(const uint32_t uiMtu, const uint32_t uiSess
     m_uiBytesAvailableForPayload(m_uiMtu - IP_UDP_RTP_HEADER_SIZE), // NB: this header does not account for the RTP extension header
     m_uiSessionBandwidthKbps(uiSessionBandwidthKbps),
     m_uiEstimatedFrameSize(m_uiSessionBandwidthKbps > 0 ? m_uiSessionBandwidthKbps*10 : DEFAULT_BUFFER_SIZE_BYTES),
-    m_outputStream(m_uiEstimatedFrameSize, false),
-    m_bDisableStap(false)
+    m_bDisableStap(false),
+    m_bZeroCopy(false),
+    m_bDeliverIncompleteNalUnits(false)
 {
   // the estimated frame size is set to m_uiSessionBandwidthKbps*10 = m_uiSessionBandwidthKbps*1000/(8*12.5) assuming
   // that the framerate is 12.5 frames per second. Note: this will be resized automatically by the reading code
@@ -139,7 +143,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetise(const std::vector<MediaSampl
   }
 }
 
-bool Rfc6184Packetiser::handleStapA(IBitStream& in, std::vector<MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup)
+bool Rfc6184Packetiser::handleStapA(IBitStream& in, const Buffer& rawData, std::vector<MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup)
 {
   bool bError = false;
   uint32_t uiSize = 0;
@@ -147,11 +151,11 @@ bool Rfc6184Packetiser::handleStapA(IBitStream& in, std::vector<MediaSample>& vS
   {
     if (uiSize > 0)
     {
-      // allocate memory for NAL unit
-      uint8_t* pBuffer = new uint8_t[uiSize];
-      Buffer dataBuffer(pBuffer, uiSize);
-      if (in.readBytes(pBuffer, uiSize))
+      // the NAL unit references the payload of the aggregation packet
+      uint32_t uiOffset = rawData.getSize() - in.getBytesRemaining();
+      if (in.skipBytes(uiSize))
       {
+        Buffer dataBuffer = sliceBuffer(rawData, uiOffset, uiSize);
 #ifdef DEBUG_RFC6184_PACKETIZATION
         uint32_t stap_forbidden = 0, stap_nri = 0, stap_type = 0;
         IBitStream inTemp(dataBuffer);
@@ -182,7 +186,7 @@ bool Rfc6184Packetiser::handleStapA(IBitStream& in, std::vector<MediaSample>& vS
   return !bError;
 }
 
-bool Rfc6184Packetiser::handleStapB(IBitStream& in, std::vector<MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup)
+bool Rfc6184Packetiser::handleStapB(IBitStream& in, const Buffer& rawData, std::vector<MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup)
 {
   bool bError = false;
   uint32_t uiSize = 0;
@@ -192,11 +196,11 @@ bool Rfc6184Packetiser::handleStapB(IBitStream& in, std::vector<MediaSample>& vS
   {
     if (uiSize > 0)
     {
-      // allocate memory for NAL unit
-      uint8_t* pBuffer = new uint8_t[uiSize];
-      Buffer dataBuffer(pBuffer, uiSize);
-      if (in.readBytes(pBuffer, uiSize))
+      // the NAL unit references the payload of the aggregation packet
+      uint32_t uiOffset = rawData.getSize() - in.getBytesRemaining();
+      if (in.skipBytes(uiSize))
       {
+        Buffer dataBuffer = sliceBuffer(rawData, uiOffset, uiSize);
 #ifdef DEBUG_RFC6184_PACKETIZATION
         uint32_t stap_forbidden = 0, stap_nri = 0, stap_type = 0;
         IBitStream inTemp(dataBuffer);
@@ -229,288 +233,109 @@ bool Rfc6184Packetiser::handleStapB(IBitStream& in, std::vector<MediaSample>& vS
 }
 
 
-std::list<RtpPacket>::const_iterator Rfc6184Packetiser::handleFuA(IBitStream& in,
-                                                              const std::list<RtpPacket>& rtpPackets,
-                                                              std::list<RtpPacket>::const_iterator itNextFu,
-                                                              std::vector<MediaSample>& vSamples,
-                                                              uint32_t uiStartSN,
-                                                              uint32_t forbidden,
-                                                              uint32_t nri,
-                                                              const RtpPacketGroup& rtpPacketGroup)
+std::list<RtpPacket>::const_iterator Rfc6184Packetiser::handleFu(const std::list<RtpPacket>& rtpPackets,
+                                                             std::list<RtpPacket>::const_iterator itFirstFu,
+                                                             std::vector<MediaSample>& vSamples,
+                                                             const RtpPacketGroup& rtpPacketGroup)
 {
-  uint32_t fu_start = 0, fu_end = 0, fu_reserved = 0, fu_type = 0;
-  if (( in.read(fu_start,    1) ) &&
-      ( in.read(fu_end,      1) ) &&
-      ( in.read(fu_reserved, 1) ) &&
-      ( in.read(fu_type,     5) )
-     )
+  const Buffer firstFu = itFirstFu->getPayload();
+  const uint8_t* pFirstFu = firstFu.data();
+  // FU indicator: F, NRI and type (FU-A or FU-B)
+  const uint8_t uiIndicator = pFirstFu[0];
+  const bool bFuB = (uiIndicator & 0x1F) == NUT_FU_B;
+  // the FU-B additionally contains the DON after the FU header
+  const uint32_t uiFirstHeaderSize = bFuB ? 4 : 2;
+  if (firstFu.getSize() < uiFirstHeaderSize)
   {
+    LOG(WARNING) << "Failed to read FU header. SN: " << itFirstFu->getExtendedSequenceNumber();
+    return ++itFirstFu;
+  }
+  // FU header: S, E, R and the type of the fragmented NAL unit
+  const uint8_t uiFuHeader = pFirstFu[1];
+  const uint8_t uiNalType = uiFuHeader & 0x1F;
+  const uint16_t uiDON = bFuB ? ((pFirstFu[2] << 8) | pFirstFu[3]) : 0;
+
 #ifdef DEBUG_RFC6184_PACKETIZATION
-    VLOG(2) << "First FU: SN: " << uiStartSN << " start: " << fu_start << " end: " << fu_end << " res: " << fu_reserved << " Type: " << rfc6184::toString((NalUnitType)fu_type);
+  VLOG(2) << "First FU: SN: " << itFirstFu->getExtendedSequenceNumber() << " start: " << ((uiFuHeader >> 7) & 0x01) << " end: " << ((uiFuHeader >> 6) & 0x01) << " Type: " << rfc6184::toString((NalUnitType)uiNalType);
 #endif
 
-    // make sure start is set for first FU
-    if ( fu_start != 0 )
+  // first pass: find the fragments of the NAL unit and the size of the reassembled NAL unit.
+  // Subsequent fragments are always sent as FU-A, a start bit or a different NAL unit type
+  // means that the end of this NAL unit was lost and that the next one has started.
+  uint32_t uiNalUnitSize = 1 + firstFu.getSize() - uiFirstHeaderSize;
+  bool bLoss = (uiFuHeader & 0x80) == 0;
+  bool bEnd = (uiFuHeader & 0x40) != 0;
+  uint32_t uiPreviousSN = itFirstFu->getExtendedSequenceNumber();
+  std::list<RtpPacket>::const_iterator itEnd = itFirstFu;
+  for (++itEnd; !bEnd && itEnd != rtpPackets.end(); ++itEnd)
+  {
+    const Buffer nextFu = itEnd->getPayload();
+    const uint8_t* pNextFu = nextFu.data();
+    if (nextFu.getSize() < 2 ||
+        (pNextFu[0] & 0x1F) != NUT_FU_A ||
+        (pNextFu[1] & 0x80) != 0 ||
+        (pNextFu[1] & 0x1F) != uiNalType)
     {
-      assert( fu_end == 0);
-      assert( fu_reserved == 0 );
-
-      m_outputStream.reset();
-      // write NAL unit header based on FU indicator and FU header
-      m_outputStream.write(forbidden, 1);
-      m_outputStream.write(nri, 2);
-      m_outputStream.write(fu_type, 5);
-      // write rest of FU into output NAL unit
-      m_outputStream.write(in);
-      // check for all subsequent packets and end bits
-      uint32_t uiPreviousSN = uiStartSN;
-      // search for end of FU until either end of list or a non-FU unit is encountered
-      for (std::list<RtpPacket>::const_iterator itNext = itNextFu; itNext != rtpPackets.end(); ++itNext)
-      {
-        const RtpPacket& nextFU = *itNext;
-        uint32_t uiNextSN = nextFU.getExtendedSequenceNumber();
-        if (uiNextSN == uiPreviousSN + 1)
-        {
-          Buffer fuData = nextFU.getPayload();
-          IBitStream inNextFu(fuData);
-
-          uint32_t forbidden = 0, nri = 0, type = 0;
-          uint32_t nextfu_start = 0, nextfu_end = 0, nextfu_reserved = 0, nextfu_type = 0;
-          // read FU indicator
-          // read FU header
-          if (( inNextFu.read(forbidden, 1)) &&
-              ( inNextFu.read(nri, 2)) &&
-              ( inNextFu.read(type, 5 )) &&
-              ( inNextFu.read(nextfu_start,    1) ) &&
-              ( inNextFu.read(nextfu_end,      1) ) &&
-              ( inNextFu.read(nextfu_reserved, 1) ) &&
-              ( inNextFu.read(nextfu_type,     5) )
-             )
-          {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-            VLOG(2) << "Next FU: SN: " << nextFU.getExtendedSequenceNumber() << " start: " << nextfu_start << " end: " << nextfu_end << " res: " << nextfu_reserved << " Type: " << rfc6184::toString((NalUnitType)nextfu_type);
-#endif
-            if (type != NUT_FU_A)
-            {
-              // something's gone wrong: this is a different NALU
-#ifdef DEBUG_RFC6184_PACKETIZATION
-              printPacketListInfo(rtpPackets);
-#endif
-              // return the current iterator so the next NALU can be extracted
-              return itNext;
-            }
-            else
-            {
-              assert( nextfu_start == 0);
-              assert( nextfu_reserved == 0 );
-              if (nextfu_end != 0)
-              {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(2) << "Found end of FU ";
-#endif
-                m_outputStream.write(inNextFu);
-                Buffer outputNalUnit = m_outputStream.data();
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(1) << "Successfully put FU together - Size: " << outputNalUnit.getSize();
-#endif
-                MediaSample mediaSample;
-                mediaSample.setData(outputNalUnit);
-                mediaSample.setRtpTime(rtpPacketGroup.getRtpTimestamp());
-                mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
-                vSamples.push_back(mediaSample);
-                return ++itNext;
-              }
-              else
-              {
-                m_outputStream.write(inNextFu);
-                uiPreviousSN = uiNextSN;
-              }
-            }
-          }
-          else
-          {
-            LOG(WARNING) << "Failed to parse next FU A header";
-            return rtpPackets.end();
-            // TODO: could try to continue parsing?
-            //return ++itNext;
-          }
-        }
-        else
-        {
-          // missing packet
-          LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
-          // discard previous data
-          // For debugging
-#ifdef DEBUG_RFC6184_PACKETIZATION
-          printPacketListInfo(rtpPackets);
-#endif
-          return rtpPackets.end();
-          // TODO: could try to continue parsing?
-        }
-      }
-      return rtpPackets.end();
+      break;
     }
-    else
+    const uint32_t uiNextSN = itEnd->getExtendedSequenceNumber();
+    if (uiNextSN != uiPreviousSN + 1)
     {
-      // start not set on first FU
-      LOG(WARNING) << "TODO: start bit not set on first FU. SN: " << uiStartSN;
-      return rtpPackets.end();
-      // TODO: could try to continue parsing?
-      //return itNextFu;
+      LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
+      bLoss = true;
     }
+    uiPreviousSN = uiNextSN;
+    uiNalUnitSize += nextFu.getSize() - 2;
+    bEnd = (pNextFu[1] & 0x40) != 0;
   }
-  else
-  {
-    LOG(WARNING) << "Failed to read FU A header";
-    return rtpPackets.end();
-    // TODO: could try to continue parsing?
-    //return itNextFu;
-  }
-}
+  bLoss = bLoss || !bEnd;
 
-std::list<RtpPacket>::const_iterator Rfc6184Packetiser::handleFuB(IBitStream& in,
-                                                              const std::list<RtpPacket>& rtpPackets,
-                                                              std::list<RtpPacket>::const_iterator itNextFu,
-                                                              std::vector<MediaSample>& vSamples,
-                                                              uint32_t uiStartSN,
-                                                              uint32_t forbidden,
-                                                              uint32_t nri,
-                                                              const RtpPacketGroup& rtpPacketGroup)
-{
-  uint32_t fu_start = 0, fu_end = 0, fu_reserved = 0, fu_type = 0;
-  uint16_t uiDON = 0 ;
-  if (( in.read(fu_start,    1) ) &&
-      ( in.read(fu_end,      1) ) &&
-      ( in.read(fu_reserved, 1) ) &&
-      ( in.read(fu_type,     5) ) &&
-      ( in.read(uiDON,     16) )
-     )
+  if (bLoss && !m_bDeliverIncompleteNalUnits)
   {
+    LOG(WARNING) << "Discarding incomplete fragmented NAL unit. SN: " << itFirstFu->getExtendedSequenceNumber() << "-" << uiPreviousSN;
 #ifdef DEBUG_RFC6184_PACKETIZATION
-    VLOG(2) << "First FU: SN: " << uiStartSN << " start: " << fu_start << " end: " << fu_end << " res: " << fu_reserved << " Type: " << rfc6184::toString((NalUnitType)fu_type);
-#endif
-
-    // make sure start is set for first FU
-    if ( fu_start != 0 )
-    {
-      assert( fu_end == 0);
-      assert( fu_reserved == 0 );
-
-      m_outputStream.reset();
-      // write NAL unit header based on FU indicator and FU header
-      m_outputStream.write(forbidden, 1);
-      m_outputStream.write(nri, 2);
-      m_outputStream.write(fu_type, 5);
-      // write rest of FU into output NAL unit
-      m_outputStream.write(in);
-      // check for all subsequent packets and end bits
-      uint32_t uiPreviousSN = uiStartSN;
-      // search for end of FU until either end of list or a non-FU unit is encountered
-      for (std::list<RtpPacket>::const_iterator itNext = itNextFu; itNext != rtpPackets.end(); )
-      {
-        const RtpPacket& nextFU = *itNext;
-        uint32_t uiNextSN = nextFU.getExtendedSequenceNumber();
-        if (uiNextSN == uiPreviousSN + 1)
-        {
-          Buffer fuData = nextFU.getPayload();
-          IBitStream inNextFu(fuData);
-
-          uint32_t type = 0;
-          uint32_t nextfu_start = 0, nextfu_end = 0, nextfu_reserved = 0, nextfu_type = 0;
-          // read FU indicator
-          // read FU header
-          if (( inNextFu.read(forbidden, 1)) &&
-              ( inNextFu.read(nri, 2)) &&
-              ( inNextFu.read(type, 5 )) &&
-              ( inNextFu.read(nextfu_start,    1) ) &&
-              ( inNextFu.read(nextfu_end,      1) ) &&
-              ( inNextFu.read(nextfu_reserved, 1) ) &&
-              ( inNextFu.read(nextfu_type,     5) )
-              )
-          {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-            VLOG(2) << "Next FU: SN: " << nextFU.getExtendedSequenceNumber() << " start: " << nextfu_start << " end: " << nextfu_end << " res: " << nextfu_reserved << " Type: " << rfc6184::toString((NalUnitType)nextfu_type);
-#endif
-            if (type != NUT_FU_A)
-            {
-              // something's gone wrong: this is a different NALU
-#ifdef DEBUG_RFC6184_PACKETIZATION
-              printPacketListInfo(rtpPackets);
-#endif
-              // return the current iterator so the next NALU can be extracted
-              return itNext;
-            }
-            else
-            {
-              assert( nextfu_start == 0);
-              assert( nextfu_reserved == 0 );
-              if (nextfu_end != 0)
-              {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(2) << "Found end of FU ";
+    printPacketListInfo(rtpPackets);
 #endif
-                m_outputStream.write(inNextFu);
-                Buffer outputNalUnit = m_outputStream.data();
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(1) << "Successfully put FU together - Size: " << outputNalUnit.getSize();
-#endif
-                MediaSample mediaSample;
-                mediaSample.setData(outputNalUnit);
-                mediaSample.setDecodingOrderNumber(uiDON);
-                mediaSample.setRtpTime(rtpPacketGroup.getRtpTimestamp());
-                mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
-                vSamples.push_back(mediaSample);
-                return ++itNext;
-              }
-              else
-              {
-                m_outputStream.write(inNextFu);
-                uiPreviousSN = uiNextSN;
-              }
-            }
-          }
-          else
-          {
-            LOG(WARNING) << "Failed to parse next FU A header";
-            return rtpPackets.end();
-            // TODO: could try to continue parsing?
-            //return ++itNext;
-          }
-        }
-        else
-        {
-          // missing packet
-          LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
-          // discard previous data
-          // For debugging
-#ifdef DEBUG_RFC6184_PACKETIZATION
-          printPacketListInfo(rtpPackets);
-#endif
-          return rtpPackets.end();
-          // TODO: could try to continue parsing?
-        }
-        ++itNext;
-      }
-      return rtpPackets.end();
-    }
-    else
-    {
-      // start not set on first FU
-      LOG(WARNING) << "TODO: start bit not set on first FU";
-      return rtpPackets.end();
-      // TODO: could try to continue parsing?
-      //return itNextFu;
-    }
+    return itEnd;
   }
-  else
+
+  // second pass: copy the fragments into a buffer of the exact size
+  MediaSample mediaSample;
+  Buffer outputNalUnit = BufferPool::allocate(uiNalUnitSize);
+  uint8_t* pOut = &outputNalUnit[0];
+  // NAL unit header: F and NRI from the FU indicator, type from the FU header
+  pOut[0] = (uiIndicator & 0xE0) | uiNalType;
+  uint32_t uiOffset = 1;
+  if ((uiFuHeader & 0x80) == 0)
+    mediaSample.addMissingDataOffset(uiOffset);
+  memcpy(pOut + uiOffset, pFirstFu + uiFirstHeaderSize, firstFu.getSize() - uiFirstHeaderSize);
+  uiOffset += firstFu.getSize() - uiFirstHeaderSize;
+  uiPreviousSN = itFirstFu->getExtendedSequenceNumber();
+  std::list<RtpPacket>::const_iterator it = itFirstFu;
+  for (++it; it != itEnd; ++it)
   {
-    LOG(WARNING) << "Failed to read FU A header";
-    return rtpPackets.end();
-    // TODO: could try to continue parsing?
-    //return itNextFu;
+    const Buffer nextFu = it->getPayload();
+    if (it->getExtendedSequenceNumber() != uiPreviousSN + 1)
+      mediaSample.addMissingDataOffset(uiOffset);
+    uiPreviousSN = it->getExtendedSequenceNumber();
+    memcpy(pOut + uiOffset, nextFu.data() + 2, nextFu.getSize() - 2);
+    uiOffset += nextFu.getSize() - 2;
   }
-}
+  if (!bEnd)
+    mediaSample.addMissingDataOffset(uiOffset);
+  assert(uiOffset == uiNalUnitSize);
 
+#ifdef DEBUG_RFC6184_PACKETIZATION
+  VLOG(1) << "Put FU together - Size: " << outputNalUnit.getSize() << " complete: " << mediaSample.isComplete();
+#endif
+  mediaSample.setData(outputNalUnit);
+  if (bFuB)
+    mediaSample.setDecodingOrderNumber(uiDON);
+  mediaSample.setRtpTime(rtpPacketGroup.getRtpTimestamp());
+  mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
+  vSamples.push_back(mediaSample);
+  return itEnd;
+}
 
 std::list<RtpPacket>::const_iterator Rfc6184Packetiser::extractNextMediaSample(const RtpPacketGroup& rtpPacketGroup, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<MediaSample>& vMediaSamples)
 {
@@ -555,26 +380,22 @@ std::list<RtpPacket>::const_iterator Rfc6184Packetiser::extractNextMediaSample(c
           case NUT_STAP_A:
           {
             // Need to parse single time aggregation packets and split into multiple NAL units
-            handleStapA(in, vMediaSamples, rtpPacketGroup);
+            handleStapA(in, rawData, vMediaSamples, rtpPacketGroup);
             return ++it;
             break;
           }
           case NUT_STAP_B:
           {
             // Need to parse single time aggregation packets and split into multiple NAL units
-            handleStapB(in, vMediaSamples, rtpPacketGroup);
+            handleStapB(in, rawData, vMediaSamples, rtpPacketGroup);
             return ++it;
             break;
           }
           case NUT_FU_A:
-          {
-            return handleFuA(in, rtpPackets, ++it, vMediaSamples, rtpPacket.getExtendedSequenceNumber(), forbidden, nri, rtpPacketGroup);
-            break;
-          }
           case NUT_FU_B:
           {
-            return handleFuB(in, rtpPackets, ++it, vMediaSamples, rtpPacket.getExtendedSequenceNumber(), forbidden, nri, rtpPacketGroup);
-             break;
+            return handleFu(rtpPackets, it, vMediaSamples, rtpPacketGroup);
+            break;
           }
           default:
           {
@@ -673,11 +494,18 @@ RtpPacket Rfc6184Packetiser::packetiseSingleNalUnit(const MediaSample& mediaSamp
     LOG(WARNING) << "Sample size may be greater than network MTU";
   // Note: the RTP header will be populated in the RTP session
   RtpPacket packet;
-  // NOTE: we have to copy the payload since it belongs to the media sample
-  // and we don't have control of what will happen to the memory
-  Buffer mediaData(new uint8_t[mediaSample.getPayloadSize()], mediaSample.getPayloadSize());
-  memcpy((char*)mediaData.data(), (char*)mediaSample.getDataBuffer().data(), mediaSample.getPayloadSize());
-  packet.setPayload(mediaData);
+  if (m_bZeroCopy)
+  {
+    packet.setPayload(mediaSample.getDataBuffer());
+  }
+  else
+  {
+    // NOTE: we have to copy the payload since it belongs to the media sample
+    // and we don't have control of what will happen to the memory
+    Buffer mediaData = BufferPool::allocate(mediaSample.getPayloadSize());
+    memcpy((char*)mediaData.data(), (char*)mediaSample.getDataBuffer().data(), mediaSample.getPayloadSize());
+    packet.setPayload(mediaData);
+  }
   packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
 
   return packet;
@@ -690,75 +518,57 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseFuA(const MediaSample& mediaS
   assert (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload);
 
   VLOG(15) << "NAL unit too big " << mediaSample.getDataBuffer().getSize() << "- fragmenting";
-  bool bStart = true;
 
-  Buffer buffer = mediaSample.getDataBuffer();
-  IBitStream in(buffer);
-  // forbidden
-  in.skipBits(1);
-  // nri
-  uint32_t uiNri = 0, uiNut = 0;
-  in.read(uiNri, 2);
-  //  NUT
-  in.read(uiNut, 5);
+  const Buffer& buffer = mediaSample.getDataBuffer();
+  const uint8_t uiNalHeader = buffer.data()[0];
+  const uint32_t uiMaxBytesPerPayload = m_uiBytesAvailableForPayload - 2 /* FU headers */;
+  vRtpPackets.reserve((buffer.getSize() - 1 + uiMaxBytesPerPayload - 1) / uiMaxBytesPerPayload);
+
+  // FU indicator: F = 0, the NRI of the NAL unit and type FU-A
+  uint8_t aFuHeaders[2];
+  aFuHeaders[0] = (uiNalHeader & 0x60) | static_cast<uint8_t>(NUT_FU_A);
 
   // the NAL unit header forms part of the Fu indicator and FU header: subtract it from the total
-  uint32_t uiBytesToPacketize = in.getBytesRemaining();
+  uint32_t uiOffset = 1;
+  uint32_t uiBytesToPacketize = buffer.getSize() - 1;
   while (uiBytesToPacketize > 0)
   {
     RtpPacket packet;
-    // packetize FU
-
-    // Fu indicator
-    OBitStream out1;
-    out1.write(0, 1);
-    out1.write(uiNri, 2);
-    out1.write(static_cast<uint32_t>(NUT_FU_A), 5);
-
-    uint32_t uiMaxBytesPerPayload = m_uiBytesAvailableForPayload - 2 /* FU headers */;
-    // FU header
-    if (bStart)
+    // FU header: S | E | R followed by the NAL unit type
+    aFuHeaders[1] = uiNalHeader & 0x1F;
+    if (uiOffset == 1)
     {
-      /// S | E | R = 1 | 0 | 0
-      out1.write(1, 1);
-      out1.write(0, 1);
-      out1.write(0, 1);
-
-      bStart = false;
+      aFuHeaders[1] |= 0x80;
     }
-    else
+    else if (uiBytesToPacketize <= uiMaxBytesPerPayload)
     {
-      // check if this is the last packet
-      if (uiBytesToPacketize <= uiMaxBytesPerPayload)
-      {
-        /// S | E | R = 0 | 1 | 0
-        out1.write(0, 1);
-        out1.write(1, 1);
-        out1.write(0, 1);
-        // TODO: is this correct?
-        packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
-      }
-      else
-      {
-        /// S | E | R = 0 | 0 | 0
-        // out1.write(0, 3);
-        out1.write(0, 1);
-        out1.write(0, 1);
-        out1.write(0, 1);
-      }
+      aFuHeaders[1] |= 0x40;
+      // TODO: is this correct?
+      packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
     }
-    out1.write( uiNut, 5);
 
     // Payload
-    uint32_t uiBytesToWrite = std::min(in.getBytesRemaining(), uiMaxBytesPerPayload);
-    bool bRes = out1.write(in, uiBytesToWrite);
-    assert(bRes);
+    uint32_t uiBytesToWrite = std::min(uiBytesToPacketize, uiMaxBytesPerPayload);
+    if (m_bZeroCopy)
+    {
+      // the FU headers are stored in the packet and the fragment references the NAL unit
+      packet.setPayload(sliceBuffer(buffer, uiOffset, uiBytesToWrite));
+      packet.setPayloadHeader(aFuHeaders, 2);
+    }
+    else
+    {
+      Buffer payload = BufferPool::allocate(uiBytesToWrite + 2);
+      uint8_t* pPayload = &payload[0];
+      pPayload[0] = aFuHeaders[0];
+      pPayload[1] = aFuHeaders[1];
+      memcpy(pPayload + 2, buffer.data() + uiOffset, uiBytesToWrite);
+      packet.setPayload(payload);
+    }
+    uiOffset += uiBytesToWrite;
     uiBytesToPacketize -= uiBytesToWrite;
 
     VLOG(15) << "FU size: " << uiBytesToWrite;
-    // create RTP packet
-    packet.setPayload(out1.data());
-    vRtpPackets.push_back(packet);
+    vRtpPackets.push_back(std::move(packet));
   }
 
   return vRtpPackets;
@@ -846,7 +656,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseFuB(const MediaSample& mediaS
     VLOG(15) << "FU size: " << uiBytesToWrite;
     // create RTP packet
     packet.setPayload(out1.data());
-    vRtpPackets.push_back(packet);
+    vRtpPackets.push_back(std::move(packet));
   }
 
   return vRtpPackets;
@@ -904,7 +714,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseInterleaved(const MediaSample
     out1.write(in,mediaSample.getPayloadSize()-1);
     packet.setPayload(out1.data());
     packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
-    vRtpPackets.push_back(packet);
+    vRtpPackets.push_back(std::move(packet));
   }
   return vRtpPackets;
 }
@@ -964,7 +774,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseNonInterleaved(const std::vec
     {
       // FU-A
       std::vector<RtpPacket> vFuRtpPackets = packetiseFuA(mediaSample);
-      vRtpPackets.insert(vRtpPackets.end(), vFuRtpPackets.begin(), vFuRtpPackets.end());
+      vRtpPackets.insert(vRtpPackets.end(), std::make_move_iterator(vFuRtpPackets.begin()), std::make_move_iterator(vFuRtpPackets.end()));
       // update packetisation info
       for (size_t i = 0; i < vFuRtpPackets.size(); ++i)
       {
@@ -996,27 +806,55 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseNonInterleaved(const std::vec
       {
         RtpPacket packet;
         // STAP-A indicator
-        OBitStream out1(uiStapSize);
-        out1.write(bFBit, 1);
-        out1.write(uiNri, 2);
-        out1.write(static_cast<uint32_t>(NUT_STAP_A), 5);
-        // we can aggregate some packets
-        for (size_t i = iCurrentPacket; i < iCurrentPacket + iCount; ++i)
+        const uint8_t uiStapIndicator = (bFBit ? 0x80 : 0x00) | static_cast<uint8_t>(uiNri << 5) | static_cast<uint8_t>(NUT_STAP_A);
+        if (m_bZeroCopy)
         {
-          const MediaSample& mediaSample = mediaSamples[i];
-          out1.write(mediaSample.getPayloadSize(), 16);
-          VLOG(15) << "Copying media sample data into STAP-A: " << mediaSample.getPayloadSize() << " bytes";
-          // copy rest of stream
-          IBitStream in(mediaSample.getDataBuffer());
-          out1.write(in);
-
-          // update packetisation info
-          m_vLastPacketisationInfo[i].push_back(iRtpPacketIndex);
+          // the STAP-A indicator and NAL unit sizes are stored in the packet and the
+          // NAL units are referenced
+          for (size_t i = iCurrentPacket; i < iCurrentPacket + iCount; ++i)
+          {
+            const MediaSample& mediaSample = mediaSamples[i];
+            const uint8_t aNalSize[2] = { static_cast<uint8_t>(mediaSample.getPayloadSize() >> 8),
+                                          static_cast<uint8_t>(mediaSample.getPayloadSize()) };
+            if (i == iCurrentPacket)
+            {
+              const uint8_t aStapHeader[3] = { uiStapIndicator, aNalSize[0], aNalSize[1] };
+              packet.setPayload(mediaSample.getDataBuffer());
+              packet.setPayloadHeader(aStapHeader, 3);
+            }
+            else
+            {
+              packet.addPayloadSegment(aNalSize, 2, mediaSample.getDataBuffer());
+            }
+            // update packetisation info
+            m_vLastPacketisationInfo[i].push_back(iRtpPacketIndex);
+          }
+        }
+        else
+        {
+          Buffer payload = BufferPool::allocate(uiStapSize);
+          uint8_t* pPayload = &payload[0];
+          uint32_t uiOffset = 0;
+          pPayload[uiOffset++] = uiStapIndicator;
+          // we can aggregate some packets
+          for (size_t i = iCurrentPacket; i < iCurrentPacket + iCount; ++i)
+          {
+            const MediaSample& mediaSample = mediaSamples[i];
+            pPayload[uiOffset++] = static_cast<uint8_t>(mediaSample.getPayloadSize() >> 8);
+            pPayload[uiOffset++] = static_cast<uint8_t>(mediaSample.getPayloadSize());
+            VLOG(15) << "Copying media sample data into STAP-A: " << mediaSample.getPayloadSize() << " bytes";
+            memcpy(pPayload + uiOffset, mediaSample.getDataBuffer().data(), mediaSample.getPayloadSize());
+            uiOffset += mediaSample.getPayloadSize();
+
+            // update packetisation info
+            m_vLastPacketisationInfo[i].push_back(iRtpPacketIndex);
+          }
+          assert(uiOffset == uiStapSize);
+          packet.setPayload(payload);
         }
-        packet.setPayload(out1.data());
         // the marker bit gets set according to the last sample in the STAP
         packet.getHeader().setMarkerBit(mediaSamples[iCurrentPacket + iCount - 1].isMarkerSet());
-        vRtpPackets.push_back(packet);
+        vRtpPackets.push_back(std::move(packet));
 
         // update packetisation info
         ++iRtpPacketIndex;
@@ -1084,7 +922,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseInterleaved(const std::vector
         out1.write(in,mediaSample.getPayloadSize()-1);
         packet.setPayload(out1.data());
         packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
-        vRtpPackets.push_back(packet);
+        vRtpPackets.push_back(std::move(packet));
         // update packetisation info
         m_vLastPacketisationInfo[iCurrentPacket].push_back(iRtpPacketIndex);
         ++iRtpPacketIndex;
@@ -1116,7 +954,7 @@ std::vector<RtpPacket> Rfc6184Packetiser::packetiseInterleaved(const std::vector
         packet.setPayload(out1.data());
         // the marker bit gets set according to the last sample in the STAP
         packet.getHeader().setMarkerBit(mediaSamples[iCurrentPacket + iCount - 1].isMarkerSet());
-        vRtpPackets.push_back(packet);
+        vRtpPackets.push_back(std::move(packet));
 
         // update packetisation info
         ++iRtpPacketIndex;
@@ -1,14 +1,13 @@
 #include "CorePch.h"
 #include <rtp++/rfchevc/RfchevcPacketiser.h>
-#include <boost/foreach.hpp>
 
-#include <cpputil/IBitStream.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
 #include <rtp++/media/h265/H265NalUnitTypes.h>
 
 #define DEFAULT_MTU 1500
-#define DEFAULT_BUFFER_SIZE_BYTES 10000
 #define IP_UDP_RTP_HEADER_SIZE 40
-// #define DEBUG_RFC6184_PACKETIZATION
+// #define DEBUG_RFCHEVC_PACKETIZATION
 
 namespace rtp_plus_plus
 {
@@ -18,6 +17,38 @@ namespace rfchevc
 using namespace media::h265;
 using media::MediaSample;
 
+namespace
+{
+/// size of the HEVC NAL unit header and RTP payload header
+const uint32_t PAYLOAD_HEADER_SIZE = 2;
+/// size of the FU header
+const uint32_t FU_HEADER_SIZE = 1;
+/// size of the DONL field
+const uint32_t DONL_SIZE = 2;
+/// size of the NAL unit size field in APs
+const uint32_t AP_NALU_SIZE_SIZE = 2;
+
+inline uint8_t getType(const uint8_t* pHeader)
+{
+  return (pHeader[0] >> 1) & 0x3F;
+}
+
+inline uint32_t getLayerId(const uint8_t* pHeader)
+{
+  return ((pHeader[0] & 0x01) << 5) | (pHeader[1] >> 3);
+}
+
+inline uint32_t getTid(const uint8_t* pHeader)
+{
+  return pHeader[1] & 0x07;
+}
+
+inline uint16_t getDon(const media::MediaSample& mediaSample)
+{
+  return static_cast<uint16_t>(mediaSample.getDecodingOrderNumber());
+}
+}
+
 RfchevcPacketiser::ptr RfchevcPacketiser::create()
 {
   return std::unique_ptr<RfchevcPacketiser>(new RfchevcPacketiser());
@@ -33,8 +64,8 @@ RfchevcPacketiser::RfchevcPacketiser()
   m_uiMtu(DEFAULT_MTU),
   m_uiBytesAvailableForPayload(m_uiMtu - IP_UDP_RTP_HEADER_SIZE), // NB: this header does not account for the RTP extension header
   m_uiSessionBandwidthKbps(0),
-  m_uiEstimatedFrameSize(DEFAULT_BUFFER_SIZE_BYTES),
-  m_outputStream(m_uiEstimatedFrameSize, false)
+  m_bZeroCopy(false),
+  m_uiNextDon(0)
 {
 
 }
@@ -44,1073 +75,495 @@ RfchevcPacketiser::RfchevcPacketiser(const uint32_t uiMtu, const uint32_t uiSess
   m_uiMtu(uiMtu),
   m_uiBytesAvailableForPayload(m_uiMtu - IP_UDP_RTP_HEADER_SIZE), // NB: this header does not account for the RTP extension header
   m_uiSessionBandwidthKbps(uiSessionBandwidthKbps),
-  m_uiEstimatedFrameSize(m_uiSessionBandwidthKbps > 0 ? m_uiSessionBandwidthKbps*10 : DEFAULT_BUFFER_SIZE_BYTES),
-  m_outputStream(m_uiEstimatedFrameSize, false)
+  m_bZeroCopy(false),
+  m_uiNextDon(0)
 {
-  // the estimated frame size is set to m_uiSessionBandwidthKbps*10 = m_uiSessionBandwidthKbps*1000/(8*12.5) assuming
-  // that the framerate is 12.5 frames per second. Note: this will be resized automatically by the reading code
-  // but if it proves to be inefficient we can increase the frame size
   assert(uiMtu != 0);
-
 }
 
-
 std::vector<RtpPacket> RfchevcPacketiser::packetise(const MediaSample& mediaSample)
 {
 #ifdef DEBUG_NAL_UNIT_TYPES
-  const uint8_t* pData = mediaSample.getDataBuffer().data();
-  uint8_t uiNut = ( pData[0] & 0x7E ) >> 1;
-  rfchevc::NalUnitType eNextType = static_cast<rfchevc::NalUnitType>(uiNut);
-  DLOG(INFO) << "Next NAL type: " << rfchevc::toString(eNextType);
+  DLOG(INFO) << "Next NAL type: " << toString(static_cast<NalUnitType>(getType(mediaSample.getDataBuffer().data())));
 #endif
-
-  switch(m_eMode)
-  {
-    case INTERLEAVED_MODE:
-    {
-      return packetiseInterleaved(mediaSample);
-      break;
-    }
-    default:
-    case NON_INTERLEAVED_MODE:
-    {
-      return packetiseNonInterleaved(mediaSample);
-      break;
-    }
-  }
+  return packetise(std::vector<MediaSample>(1, mediaSample));
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetise(const std::vector<MediaSample>& mediaSamples)
+bool RfchevcPacketiser::hasDonl() const
 {
-  m_vLastPacketisationInfo.clear();
-  for (size_t i = 0; i < mediaSamples.size(); ++i )
-  {
-    m_vLastPacketisationInfo.push_back(std::vector<uint32_t>());
-  }
-
-  switch(m_eMode)
-  {
-    case INTERLEAVED_MODE:
-    {
-      return packetiseInterleaved(mediaSamples);
-      break;
-    }
-    default:
-    case NON_INTERLEAVED_MODE:
-    {
-      return packetiseNonInterleaved(mediaSamples);
-      break;
-    }
-  }
+  return m_eMode == INTERLEAVED_MODE;
 }
 
-bool RfchevcPacketiser::handleAPA(IBitStream& in, std::vector<MediaSample>& vSamples, uint32_t RtpTime)
+uint16_t RfchevcPacketiser::assignDon(const MediaSample& mediaSample)
 {
-  bool bError = false;
-  uint32_t uiSize = 0;
-  while (!bError && in.read(uiSize, 16))
-  {
-    if (uiSize > 0)
-    {
-      // allocate memory for NAL unit
-      uint8_t* pBuffer = new uint8_t[uiSize];
-      Buffer dataBuffer(pBuffer, uiSize);
-      if (in.readBytes(pBuffer, uiSize))
-      {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-        uint32_t stap_forbidden = 0, stap_layerid = 0, stap_tempid = 0, stap_type = 0;
-        IBitStream inTemp(dataBuffer);
-        if (( inTemp.read(stap_forbidden, 1)) &&
-            ( inTemp.read(stap_type, 6 )) &&
-            ( inTemp.read(stap_layerid, 6)) &&
-            ( inTemp.read(stap_tempid, 6)))
-        {
-          VLOG(1) << "STAP A: Parsed NAL unit type: " << stap_type << " " << toString((NalUnitType)stap_type);
-        }
-#endif
-        MediaSample mediaSample;
-        mediaSample.setData(dataBuffer);
-        mediaSample.setRtpTime(RtpTime);
-        vSamples.push_back(mediaSample);
-      }
-      else
-      {
-        bError = true;
-        LOG(WARNING) << "Failed to read STAP A Nal unit data";
-      }
-    }
-    else
-    {
-      DLOG(INFO) << "TODO: Zero size: padding?";
-    }
-  }
-  return !bError;
+  // a DON of 65535 can't be told apart from an unset DON: in a sequential
+  // stream it is also the value that the counter assigns
+  const uint16_t uiDon = (mediaSample.getDecodingOrderNumber() == -1) ? m_uiNextDon : getDon(mediaSample);
+  m_uiNextDon = uiDon + 1;
+  return uiDon;
 }
 
-bool RfchevcPacketiser::handleAPB(IBitStream& in, std::vector<MediaSample>& vSamples, uint32_t RtpTime)
+void RfchevcPacketiser::finalisePacket(RtpPacket& rtpPacket)
 {
-  bool bError = false;
-  uint32_t uiSize = 0;
-  uint16_t uiDON = 0;
-  uint8_t uiDONd = 0;
-  in.read(uiDON, 16);
-  while (!bError && in.read(uiSize, 16))
-  {
-    if (uiSize > 0)
-    {
-      // allocate memory for NAL unit
-      uint8_t* pBuffer = new uint8_t[uiSize];
-      Buffer dataBuffer(pBuffer, uiSize);
-      if (in.readBytes(pBuffer, uiSize))
-      {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-        uint32_t stap_forbidden = 0, stap_nri = 0, stap_type = 0;
-        IBitStream inTemp(dataBuffer);
-        if (( inTemp.read(stap_forbidden, 1)) &&
-            ( inTemp.read(stap_nri, 2)) &&
-            ( inTemp.read(stap_type, 5 )))
-        {
-          VLOG(1) << "STAP A: Parsed NAL unit type: " << stap_type << " " << toString((NalUnitType)stap_type);
-        }
-#endif
-        MediaSample mediaSample;
-        mediaSample.setData(dataBuffer);
-        mediaSample.setDecodingOrderNumber(uiDON);
-        mediaSample.setRtpTime(RtpTime);
-        vSamples.push_back(mediaSample);
-      }
-      else
-      {
-        bError = true;
-        LOG(WARNING) << "Failed to read STAP A Nal unit data";
-      }
-    }
-    else
-    {
-      DLOG(INFO) << "TODO: Zero size: padding?";
-    }
-  in.read(uiDONd, 8);
-  uiDON+=uiDONd+1;
-  }
-  return !bError;
+  if (m_bZeroCopy) return;
+  // NOTE: we have to copy the payload since it belongs to the media sample
+  // and we don't have control of what will happen to the memory
+  Buffer payload = BufferPool::allocate(rtpPacket.getPayloadSize());
+  rtpPacket.writePayload(&payload[0]);
+  rtpPacket.setPayload(payload);
 }
 
-
-std::list<RtpPacket>::const_iterator RfchevcPacketiser::handleFuA(IBitStream& in,
-                                                              const std::list<RtpPacket>& rtpPackets,
-                                                              std::list<RtpPacket>::const_iterator itNextFu,
-                                                              std::vector<MediaSample>& vSamples,
-                                                              uint32_t uiStartSN,
-                                                              uint32_t forbidden,
-                                                              uint32_t layerId,
-                                                              uint32_t tempId,
-                                                              uint32_t RtpTime)
+RtpPacket RfchevcPacketiser::packetiseSingleNalUnit(const MediaSample& mediaSample, uint16_t uiDon)
 {
-  uint32_t fu_start = 0, fu_end = 0, fu_type = 0;
-  if (( in.read(fu_start,    1) ) &&
-      ( in.read(fu_end,      1) ) &&
-      ( in.read(fu_type,     6) )
-     )
+  // there is only one NAL per RTP packet
+  if (mediaSample.getDataBuffer().getSize() > 1460)
+    LOG(WARNING) << "Sample size may be greater than network MTU";
+  // Note: the RTP header will be populated in the RTP session
+  RtpPacket packet;
+  const Buffer& data = mediaSample.getDataBuffer();
+  if (hasDonl() && data.getSize() >= PAYLOAD_HEADER_SIZE)
   {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-    VLOG(2) << "First FU: SN: " << uiStartSN << " start: " << fu_start << " end: " << fu_end << " res: " << fu_reserved << " Type: " << rfc6184::toString((NalUnitType)fu_type);
-#endif
-
-    // make sure start is set for first FU
-    if ( fu_start != 0 )
-    {
-      assert( fu_end == 0);
-
-      m_outputStream.reset();
-      // write NAL unit header based on FU indicator and FU header
-      m_outputStream.write(forbidden, 1);
-      m_outputStream.write(fu_type, 6);
-      m_outputStream.write(layerId, 6);
-      m_outputStream.write(tempId, 3);
-      // write rest of FU into output NAL unit
-      m_outputStream.write(in);
-      // check for all subsequent packets and end bits
-      uint32_t uiPreviousSN = uiStartSN;
-      // search for end of FU until either end of list or a non-FU unit is encountered
-      for (std::list<RtpPacket>::const_iterator itNext = itNextFu; itNext != rtpPackets.end(); ++itNext)
-      {
-        const RtpPacket& nextFU = *itNext;
-        uint32_t uiNextSN = nextFU.getExtendedSequenceNumber();
-        if (uiNextSN == uiPreviousSN + 1)
-        {
-          Buffer fuData = nextFU.getPayload();
-          IBitStream inNextFu(fuData);
-
-          uint32_t type = 0;
-          uint32_t nextfu_start = 0, nextfu_end = 0, nextfu_type = 0;
-          // read FU indicator
-          // read FU header
-          if (( inNextFu.read(forbidden, 1)) &&
-              ( inNextFu.read(type, 6 )) &&
-              ( inNextFu.read(layerId, 6)) &&
-              ( inNextFu.read(tempId, 3)) &&
-              ( inNextFu.read(nextfu_start,    1) ) &&
-              ( inNextFu.read(nextfu_end,      1) ) &&
-              ( inNextFu.read(nextfu_type,     6) )
-             )
-          {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-            VLOG(2) << "Next FU: SN: " << nextFU.getExtendedSequenceNumber() << " start: " << nextfu_start << " end: " << nextfu_end << " res: " << nextfu_reserved << " Type: " << rfc6184::toString((NalUnitType)nextfu_type);
-#endif
-            if (type != NUT_FU)
-            {
-              // something's gone wrong: this is a different NALU
-#ifdef DEBUG_RFC6184_PACKETIZATION
-              printPacketListInfo(rtpPackets);
-#endif
-              // return the current iterator so the next NALU can be extracted
-              return itNext;
-            }
-            else
-            {
-              assert( nextfu_start == 0);
-              if (nextfu_end != 0)
-              {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(2) << "Found end of FU ";
-#endif
-                m_outputStream.write(inNextFu);
-                Buffer outputNalUnit = m_outputStream.data();
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(1) << "Successfully put FU together - Size: " << outputNalUnit.getSize();
-#endif
-                MediaSample mediaSample;
-                mediaSample.setData(outputNalUnit);
-                mediaSample.setRtpTime(RtpTime);
-                vSamples.push_back(mediaSample);
-                return ++itNext;
-              }
-              else
-              {
-                m_outputStream.write(inNextFu);
-                uiPreviousSN = uiNextSN;
-              }
-            }
-          }
-          else
-          {
-            LOG(WARNING) << "Failed to parse next FU A header";
-            return rtpPackets.end();
-            // TODO: could try to continue parsing?
-            //return ++itNext;
-          }
-        }
-        else
-        {
-          // missing packet
-          LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
-          // discard previous data
-          // For debugging
-#ifdef DEBUG_RFC6184_PACKETIZATION
-          printPacketListInfo(rtpPackets);
-#endif
-          return rtpPackets.end();
-          // TODO: could try to continue parsing?
-        }
-      }
-      return rtpPackets.end();
-    }
-    else
-    {
-      // start not set on first FU
-      LOG(WARNING) << "TODO: start bit not set on first FU";
-      return rtpPackets.end();
-      // TODO: could try to continue parsing?
-      //return itNextFu;
-    }
+    // the DONL field is inserted between the NAL unit header and the NAL unit payload
+    const uint8_t aHeader[] = { data.data()[0], data.data()[1], static_cast<uint8_t>(uiDon >> 8), static_cast<uint8_t>(uiDon & 0xFF) };
+    packet.setPayload(sliceBuffer(data, PAYLOAD_HEADER_SIZE, data.getSize() - PAYLOAD_HEADER_SIZE));
+    packet.setPayloadHeader(aHeader, sizeof(aHeader));
   }
   else
   {
-    LOG(WARNING) << "Failed to read FU A header";
-    return rtpPackets.end();
-    // TODO: could try to continue parsing?
-    //return itNextFu;
+    packet.setPayload(data);
   }
+  packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
+  finalisePacket(packet);
+  return packet;
 }
 
-std::list<RtpPacket>::const_iterator RfchevcPacketiser::handleFuB(IBitStream& in,
-                                                              const std::list<RtpPacket>& rtpPackets,
-                                                              std::list<RtpPacket>::const_iterator itNextFu,
-                                                              std::vector<MediaSample>& vSamples,
-                                                              uint32_t uiStartSN,
-                                                              uint32_t forbidden,
-                                                              uint32_t layerId,
-                                                              uint32_t tempId,
-                                                              uint32_t RtpTime)
+std::vector<RtpPacket> RfchevcPacketiser::packetiseFu(const MediaSample& mediaSample, uint16_t uiDon)
 {
-  uint32_t fu_start = 0, fu_end = 0, fu_type = 0;
-  uint16_t uiDON = 0 ;
-  if (( in.read(fu_start,    1) ) &&
-      ( in.read(fu_end,      1) ) &&
-      ( in.read(fu_type,     6) ) &&
-      ( in.read(uiDON,     16) )
-     )
-  {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-    VLOG(2) << "First FU: SN: " << uiStartSN << " start: " << fu_start << " end: " << fu_end << " res: " << fu_reserved << " Type: " << rfc6184::toString((NalUnitType)fu_type);
-#endif
-
-    // make sure start is set for first FU
-    if ( fu_start != 0 )
-    {
-      assert( fu_end == 0);
-
-      m_outputStream.reset();
-      // write NAL unit header based on FU indicator and FU header
-      m_outputStream.write(forbidden, 1);
-      m_outputStream.write(fu_type, 6);
-      m_outputStream.write(layerId, 6);
-      m_outputStream.write(tempId, 3);
-
-      // write rest of FU into output NAL unit
-      m_outputStream.write(in);
-      // check for all subsequent packets and end bits
-      uint32_t uiPreviousSN = uiStartSN;
-      // search for end of FU until either end of list or a non-FU unit is encountered
-      for (std::list<RtpPacket>::const_iterator itNext = itNextFu; itNext != rtpPackets.end(); )
-      {
-        const RtpPacket& nextFU = *itNext;
-        uint32_t uiNextSN = nextFU.getExtendedSequenceNumber();
-        if (uiNextSN == uiPreviousSN + 1)
-        {
-          Buffer fuData = nextFU.getPayload();
-          IBitStream inNextFu(fuData);
-
-          uint32_t  type = 0;
-          uint32_t nextfu_start = 0, nextfu_end = 0, nextfu_type = 0;
-          // read FU indicator
-          // read FU header
-          if (( inNextFu.read(forbidden, 1)) &&
-              ( inNextFu.read(type, 6 )) &&
-              ( inNextFu.read(layerId, 6)) &&
-              ( inNextFu.read(tempId, 3)) &&
-              ( inNextFu.read(nextfu_start,    1) ) &&
-              ( inNextFu.read(nextfu_end,      1) ) &&
-              ( inNextFu.read(nextfu_type,     6) )
-             )
-          {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-            VLOG(2) << "Next FU: SN: " << nextFU.getExtendedSequenceNumber() << " start: " << nextfu_start << " end: " << nextfu_end << " res: " << nextfu_reserved << " Type: " << rfc6184::toString((NalUnitType)nextfu_type);
-#endif
-            if (type != NUT_FU)
-            {
-              // something's gone wrong: this is a different NALU
-#ifdef DEBUG_RFC6184_PACKETIZATION
-              printPacketListInfo(rtpPackets);
-#endif
-              // return the current iterator so the next NALU can be extracted
-              return itNext;
-            }
-            else
-            {
-              assert( nextfu_start == 0);
-              if (nextfu_end != 0)
-              {
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(2) << "Found end of FU ";
-#endif
-                m_outputStream.write(inNextFu);
-                Buffer outputNalUnit = m_outputStream.data();
-#ifdef DEBUG_RFC6184_PACKETIZATION
-                VLOG(1) << "Successfully put FU together - Size: " << outputNalUnit.getSize();
-#endif
-                MediaSample mediaSample;
-                mediaSample.setData(outputNalUnit);
-                mediaSample.setDecodingOrderNumber(uiDON);
-                mediaSample.setRtpTime(RtpTime);
-                vSamples.push_back(mediaSample);
-                return ++itNext;
-              }
-              else
-              {
-                m_outputStream.write(inNextFu);
-                uiPreviousSN = uiNextSN;
-              }
-            }
-          }
-          else
-          {
-            LOG(WARNING) << "Failed to parse next FU A header";
-            return rtpPackets.end();
-            // TODO: could try to continue parsing?
-            //return ++itNext;
-          }
-        }
-        else
-        {
-          // missing packet
-          LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
-          // discard previous data
-          // For debugging
-#ifdef DEBUG_RFC6184_PACKETIZATION
-          printPacketListInfo(rtpPackets);
-#endif
-          return rtpPackets.end();
-          // TODO: could try to continue parsing?
-        }
-        ++itNext;
-      }
-      return rtpPackets.end();
-    }
-    else
-    {
-      // start not set on first FU
-      LOG(WARNING) << "TODO: start bit not set on first FU";
-      return rtpPackets.end();
-      // TODO: could try to continue parsing?
-      //return itNextFu;
-    }
-  }
-  else
-  {
-    LOG(WARNING) << "Failed to read FU A header";
-    return rtpPackets.end();
-    // TODO: could try to continue parsing?
-    //return itNextFu;
-  }
-}
+  std::vector<RtpPacket> vRtpPackets;
+  const Buffer& data = mediaSample.getDataBuffer();
+  assert(data.getSize() > m_uiBytesAvailableForPayload - (hasDonl() ? DONL_SIZE : 0));
 
+  VLOG(15) << "NAL unit too big " << data.getSize() << "- fragmenting";
+  const uint8_t* pData = data.data();
+  // the payload header copies F, LayerId and TID from the NAL unit header
+  const uint8_t uiPayloadHeader0 = (pData[0] & 0x81) | (NUT_FU << 1);
+  const uint8_t uiNut = getType(pData);
 
-std::list<RtpPacket>::const_iterator RfchevcPacketiser::extractNextMediaSample(const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<MediaSample>& vMediaSamples)
-{
-#ifdef DEBUG_RFC6184_PACKETIZATION
-  VLOG(5) << "extractNextMediaSample: " << rtpPackets.size();
-#endif
-  std::list<RtpPacket>::const_iterator it;
-  for (it = itStart; it != rtpPackets.end(); ++it)
+  // the NAL unit header is restored from the payload header and the FU header
+  uint32_t uiOffset = PAYLOAD_HEADER_SIZE;
+  bool bStart = true;
+  while (uiOffset < data.getSize())
   {
-    // once a sample if found, return iterator to next element
-    // check nal unit type
-    const RtpPacket& rtpPacket = *it;
-
-#ifdef DEBUG_RFC6184_PACKETIZATION
-    VLOG(5) << "extractNextMediaSample: SN " << rtpPacket.getExtendedSequenceNumber();
-#endif
+    RtpPacket packet;
+    // the DONL field is only present in the first fragment
+    const uint32_t uiHeaderSize = PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE + ((bStart && hasDonl()) ? DONL_SIZE : 0);
+    const uint32_t uiBytesToWrite = std::min(data.getSize() - uiOffset, m_uiBytesAvailableForPayload - uiHeaderSize);
+    const bool bEnd = uiOffset + uiBytesToWrite == data.getSize();
+
+    uint8_t aHeader[PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE + DONL_SIZE];
+    aHeader[0] = uiPayloadHeader0;
+    aHeader[1] = pData[1];
+    // FU header: S | E | FuType
+    aHeader[2] = (bStart ? 0x80 : 0x00) | (bEnd ? 0x40 : 0x00) | uiNut;
+    aHeader[3] = static_cast<uint8_t>(uiDon >> 8);
+    aHeader[4] = static_cast<uint8_t>(uiDon & 0xFF);
+
+    packet.setPayload(sliceBuffer(data, uiOffset, uiBytesToWrite));
+    packet.setPayloadHeader(aHeader, uiHeaderSize);
+    if (bEnd)
+      packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
+    finalisePacket(packet);
+    VLOG(15) << "FU size: " << uiBytesToWrite;
+    vRtpPackets.push_back(std::move(packet));
 
-    Buffer rawData = rtpPacket.getPayload();
-    IBitStream in(rawData);
-    uint32_t forbidden = 0, layerId = 0, tempId = 0, type = 0;
-    if (( in.read(forbidden, 1)) &&
-        ( in.read(type, 6 )) &&
-        ( in.read(layerId, 6)) &&
-        ( in.read(tempId, 3)))
-    {
-//#ifdef DEBUG_RFC6184_PACKETIZATION
-      VLOG(5) << "Forbidden: " << forbidden << " type: " << type << "(" << rfchevc::toString(static_cast<rfchevc::NalUnitType>(type)) << ") "<< " layer ID " << layerId << " tempId "<< tempId   ;
-//#endif
-      if (type <= NUT_RSV_47 )
-      {
-        MediaSample mediaSample;
-        mediaSample.setData(rawData);
-        mediaSample.setRtpTime(rtpPacket.getRtpTimestamp());
-        vMediaSamples.push_back(mediaSample);
-        return ++it;
-      }
-      else
-      {
-        // according to type, extract media data
-        switch (type)
-        {
-          case NUT_AP:
-          {
-            // Need to parse single time aggregation packets and split into multiple NAL units
-            if(true)
-                handleAPA(in, vMediaSamples, rtpPacket.getRtpTimestamp());
-            else
-                handleAPB(in, vMediaSamples, rtpPacket.getRtpTimestamp());
-            return ++it;
-            break;
-          }
-          case NUT_FU:
-          {
-            if(true)
-                return handleFuA(in, rtpPackets, ++it, vMediaSamples, rtpPacket.getExtendedSequenceNumber(), forbidden, layerId, tempId, rtpPacket.getRtpTimestamp());
-            else
-                return handleFuB(in, rtpPackets, ++it, vMediaSamples, rtpPacket.getExtendedSequenceNumber(), forbidden, layerId, tempId, rtpPacket.getRtpTimestamp());
-            break;
-          }
-          default:
-          {
-            LOG(WARNING) << "The NAL unit type " << type << " is not allowed in non-interleaved mode";
-            return rtpPackets.end();
-            break;
-          }
-        }
-      }
-    }
-    else
-    {
-      LOG(FATAL) << "Failed to read FU A header";
-      return rtpPackets.end();
-    }
+    uiOffset += uiBytesToWrite;
+    bStart = false;
   }
-
-  return it;
+  return vRtpPackets;
 }
 
-std::vector<MediaSample> RfchevcPacketiser::depacketizeNonInterleaved(const std::list<RtpPacket>& rtpPackets)
+RtpPacket RfchevcPacketiser::packetiseAp(const std::vector<MediaSample>& mediaSamples, uint32_t uiStartIndex, uint32_t uiCount)
 {
-  std::vector<MediaSample> vSamples;
-  std::list<RtpPacket>::const_iterator it = rtpPackets.begin();
-  while (it != rtpPackets.end())
+  // F is set if it is set in any aggregated NAL unit, LayerId and TID are the lowest values
+  bool bFBit = false;
+  uint32_t uiLayerId = 0x3F;
+  uint32_t uiTid = 0x07;
+  for (size_t i = uiStartIndex; i < uiStartIndex + uiCount; ++i)
   {
-    it = extractNextMediaSample(rtpPackets, it, vSamples);
+    const uint8_t* pHeader = mediaSamples[i].getDataBuffer().data();
+    if ((pHeader[0] & 0x80) != 0) bFBit = true;
+    uiLayerId = std::min(uiLayerId, getLayerId(pHeader));
+    uiTid = std::min(uiTid, getTid(pHeader));
   }
-  return vSamples;
-}
 
-std::vector<MediaSample> RfchevcPacketiser::depacketizeInterleaved(const std::list<RtpPacket>& rtpPackets)
-{
-  std::vector<MediaSample> vSamples;
-  std::list<RtpPacket>::const_iterator it = rtpPackets.begin();
-  while (it != rtpPackets.end())
+  // the payload header, the optional DONL and the size of the first NAL unit precede it
+  // in the packet while the following NAL units are appended as segments
+  RtpPacket packet;
+  const MediaSample& first = mediaSamples[uiStartIndex];
+  uint8_t aHeader[PAYLOAD_HEADER_SIZE + DONL_SIZE + AP_NALU_SIZE_SIZE];
+  uint32_t uiHeaderSize = 0;
+  aHeader[uiHeaderSize++] = (bFBit ? 0x80 : 0x00) | (NUT_AP << 1) | static_cast<uint8_t>(uiLayerId >> 5);
+  aHeader[uiHeaderSize++] = static_cast<uint8_t>(((uiLayerId & 0x1F) << 3) | uiTid);
+  if (hasDonl())
   {
-    it = extractNextMediaSample(rtpPackets, it, vSamples);
+    aHeader[uiHeaderSize++] = static_cast<uint8_t>(m_vDons[uiStartIndex] >> 8);
+    aHeader[uiHeaderSize++] = static_cast<uint8_t>(m_vDons[uiStartIndex] & 0xFF);
   }
-  return vSamples;
-}
+  aHeader[uiHeaderSize++] = static_cast<uint8_t>(first.getPayloadSize() >> 8);
+  aHeader[uiHeaderSize++] = static_cast<uint8_t>(first.getPayloadSize() & 0xFF);
+  packet.setPayload(first.getDataBuffer());
+  packet.setPayloadHeader(aHeader, uiHeaderSize);
 
-
-std::vector<MediaSample> RfchevcPacketiser::depacketize(const RtpPacketGroup& rtpPacketGroup)
-{
-  std::vector<MediaSample> vSamples;
-  const std::list<RtpPacket>& rtpPackets = rtpPacketGroup.getRtpPackets();
-  switch (m_eMode)
+  for (size_t i = uiStartIndex + 1; i < uiStartIndex + uiCount; ++i)
   {
-    case NON_INTERLEAVED_MODE:
+    const MediaSample& mediaSample = mediaSamples[i];
+    uint8_t aPrefix[1 + AP_NALU_SIZE_SIZE];
+    uint32_t uiPrefixSize = 0;
+    if (hasDonl())
     {
-      vSamples = depacketizeNonInterleaved(rtpPackets);
-      break;
-    }
-    case INTERLEAVED_MODE:
-    {
-      vSamples = depacketizeInterleaved(rtpPackets);
-      break;
-    }
-    default:
-    {
-      LOG(FATAL) << "The interleaved packetization mode has not been implemented.";
-      return std::vector<MediaSample>();
-      break;
+      // DOND: the DON difference to the previous NAL unit minus 1
+      aPrefix[uiPrefixSize++] = static_cast<uint8_t>(m_vDons[i] - m_vDons[i - 1] - 1);
     }
+    aPrefix[uiPrefixSize++] = static_cast<uint8_t>(mediaSample.getPayloadSize() >> 8);
+    aPrefix[uiPrefixSize++] = static_cast<uint8_t>(mediaSample.getPayloadSize() & 0xFF);
+    VLOG(15) << "Aggregating media sample into AP: " << mediaSample.getPayloadSize() << " bytes";
+    packet.addPayloadSegment(aPrefix, uiPrefixSize, mediaSample.getDataBuffer());
   }
-
-  // setting the marker here adds no value
-#if 0
-
-  // set marker bit if set on last sample.
-  if (!rtpPackets.empty() && !vSamples.empty())
-  {
-    vSamples[vSamples.size() - 1].setMarker(rtpPackets.back().getHeader().isMarkerSet());
-  }
-#else
-  // we will rather use the marker bit to indicate that RTCP sync has occurred
-  for (MediaSample& mediaSample : vSamples)
-  {
-    mediaSample.setMarker(rtpPacketGroup.isRtcpSynchronised());
-  }
-#endif
-  return vSamples;
-}
-
-RtpPacket RfchevcPacketiser::packetiseSingleNalUnit(const MediaSample& mediaSample)
-{
-  // there is only one NAL per RTP packet
-  if (mediaSample.getDataBuffer().getSize() > 1460)
-    LOG(WARNING) << "Sample size may be greater than network MTU";
-  // Note: the RTP header will be populated in the RTP session
-  RtpPacket packet;
-  // NOTE: we have to copy the payload since it belongs to the media sample
-  // and we don't have control of what will happen to the memory
-  Buffer mediaData(new uint8_t[mediaSample.getPayloadSize()], mediaSample.getPayloadSize());
-  memcpy((char*)mediaData.data(), (char*)mediaSample.getDataBuffer().data(), mediaSample.getPayloadSize());
-  packet.setPayload(mediaData);
-  packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
+  // the marker bit gets set according to the last sample in the AP
+  packet.getHeader().setMarkerBit(mediaSamples[uiStartIndex + uiCount - 1].isMarkerSet());
+  finalisePacket(packet);
   return packet;
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetiseFuA(const MediaSample& mediaSample)
+uint32_t RfchevcPacketiser::getNumberOfSamplesToAggregate(uint32_t uiBytesAvailableForPayload,
+                                                          const std::vector<MediaSample>& mediaSamples,
+                                                          uint32_t uiStartIndex) const
 {
-  std::vector<RtpPacket> vRtpPackets;
-  // for now don't do STAP
-  assert (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload);
-
-  VLOG(15) << "NAL unit too big " << mediaSample.getDataBuffer().getSize() << "- fragmenting";
-  bool bStart = true;
-
-  Buffer buffer = mediaSample.getDataBuffer();
-  IBitStream in(buffer);
-  // forbidden
-  in.skipBits(1);
-  // NUT
-  uint32_t uiLayerId = 0, uiTempId = 0, uiNut = 0;
-  in.read(uiNut, 6);
-  //  LayerId
-  in.read(uiLayerId, 6);
-  //  TempId
-  in.read(uiTempId, 3);
-
-  // the NAL unit header forms part of the Fu indicator and FU header: subtract it from the total
-  uint32_t uiBytesToPacketize = in.getBytesRemaining();
-  while (uiBytesToPacketize > 0)
+  uint32_t uiCount = 0;
+  uint32_t uiApSize = PAYLOAD_HEADER_SIZE;
+  for (size_t i = uiStartIndex; i < mediaSamples.size(); ++i)
   {
-    RtpPacket packet;
-    // packetize FU
-
-    // Fu indicator
-    OBitStream out1;
-    out1.write(0, 1);
-    out1.write(static_cast<uint32_t>(NUT_FU), 6);
-    out1.write(uiLayerId, 6);
-    out1.write(uiTempId, 3);
-
-    uint32_t uiMaxBytesPerPayload = m_uiBytesAvailableForPayload - 3 /* FU headers */;
-    // FU header
-    if (bStart)
-    {
-      /// S | E = 1 | 0
-      out1.write(1, 1);
-      out1.write(0, 1);
-
-      bStart = false;
-    }
-    else
+    const MediaSample& mediaSample = mediaSamples[i];
+    if (mediaSample.getPayloadSize() < PAYLOAD_HEADER_SIZE)
+      break;
+    uint32_t uiSizeRequiredForThisNal = AP_NALU_SIZE_SIZE + mediaSample.getPayloadSize();
+    if (hasDonl())
     {
-      // check if this is the last packet
-      if (uiBytesToPacketize <= uiMaxBytesPerPayload)
+      if (i == uiStartIndex)
       {
-        /// S | E = 0 | 1
-        out1.write(0, 1);
-        out1.write(1, 1);
-        // TODO: is this correct?
-        packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
+        uiSizeRequiredForThisNal += DONL_SIZE;
       }
       else
       {
-        /// S | E = 0 | 0
-        // out1.write(0, 3);
-        out1.write(0, 1);
-        out1.write(0, 1);
+        // the DON difference must be representable by the 8-bit DOND field
+        const uint16_t uiDond = m_vDons[i] - m_vDons[i - 1] - 1;
+        if (uiDond > 255)
+          break;
+        uiSizeRequiredForThisNal += 1;
       }
     }
-    out1.write( uiNut, 6);
-
-    // Payload
-    uint32_t uiBytesToWrite = std::min(in.getBytesRemaining(), uiMaxBytesPerPayload);
-    bool bRes = out1.write(in, uiBytesToWrite);
-    assert(bRes);
-    uiBytesToPacketize -= uiBytesToWrite;
-
-    VLOG(15) << "FU size: " << uiBytesToWrite;
-    // create RTP packet
-    packet.setPayload(out1.data());
-    vRtpPackets.push_back(packet);
+    if (uiApSize + uiSizeRequiredForThisNal > uiBytesAvailableForPayload)
+      break;
+    uiApSize += uiSizeRequiredForThisNal;
+    ++uiCount;
   }
-
-  return vRtpPackets;
+  return uiCount;
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetiseFuB(const MediaSample& mediaSample)
+std::vector<RtpPacket> RfchevcPacketiser::packetise(const std::vector<MediaSample>& mediaSamples)
 {
-  std::vector<RtpPacket> vRtpPackets;
-  // for now don't do STAP
-  assert (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload - 5);
-
-  VLOG(15) << "NAL unit too big " << mediaSample.getDataBuffer().getSize() << "- fragmenting";
-  bool bStart = true;
-
-  Buffer buffer = mediaSample.getDataBuffer();
-  IBitStream in(buffer);
-  // forbidden
-  in.skipBits(1);
-  // NUT
-  uint32_t uiLayerId = 0, uiTempId = 0, uiNut = 0;
-  in.read(uiNut, 6);
-  //  LayerId
-  in.read(uiLayerId, 6);
-  //  TempId
-  in.read(uiTempId, 3);
-
-  // the NAL unit header forms part of the Fu indicator and FU header: subtract it from the total
-  uint32_t uiBytesToPacketize = in.getBytesRemaining();
-  while (uiBytesToPacketize > 0)
+  m_vLastPacketisationInfo.clear();
+  m_vLastPacketisationInfo.resize(mediaSamples.size());
+  m_vDons.clear();
+  if (hasDonl())
   {
-    RtpPacket packet;
-    // packetize FU
-
-    // Fu indicator
-    OBitStream out1;
-    out1.write(0, 1);
-    out1.write(static_cast<uint32_t>(NUT_FU), 6);
-    out1.write(uiLayerId, 6);
-    out1.write(uiTempId, 3);
-
+    for (const MediaSample& mediaSample : mediaSamples)
+      m_vDons.push_back(assignDon(mediaSample));
+  }
 
-    uint32_t uiMaxBytesPerPayload;
-    // FU header
-    if (bStart)
+  std::vector<RtpPacket> vRtpPackets;
+  uint32_t uiCurrentSample = 0;
+  uint32_t uiRtpPacketIndex = 0;
+  while (uiCurrentSample < mediaSamples.size())
+  {
+    const MediaSample& mediaSample = mediaSamples[uiCurrentSample];
+    if (mediaSample.getPayloadSize() > m_uiBytesAvailableForPayload - (hasDonl() ? DONL_SIZE : 0))
     {
-      uiMaxBytesPerPayload = m_uiBytesAvailableForPayload - 5 /* FU headers */;
-      /// S | E  = 1 | 0
-      out1.write(1, 1);
-      out1.write(0, 1);
-      out1.write( uiNut, 6);
-      out1.write(mediaSample.getDecodingOrderNumber(),16);
-
-      bStart = false;
+      std::vector<RtpPacket> vFuRtpPackets = packetiseFu(mediaSample, hasDonl() ? m_vDons[uiCurrentSample] : 0);
+      for (size_t i = 0; i < vFuRtpPackets.size(); ++i)
+      {
+        m_vLastPacketisationInfo[uiCurrentSample].push_back(uiRtpPacketIndex++);
+      }
+      vRtpPackets.insert(vRtpPackets.end(), std::make_move_iterator(vFuRtpPackets.begin()), std::make_move_iterator(vFuRtpPackets.end()));
+      ++uiCurrentSample;
     }
     else
     {
-      uiMaxBytesPerPayload = m_uiBytesAvailableForPayload - 3 /* FU headers */;
-      // check if this is the last packet
-      if (uiBytesToPacketize <= uiMaxBytesPerPayload)
+      uint32_t uiCount = getNumberOfSamplesToAggregate(m_uiBytesAvailableForPayload, mediaSamples, uiCurrentSample);
+      if (uiCount < 2)
       {
-        /// S | E  = 0 | 1
-        out1.write(0, 1);
-        out1.write(1, 1);
-        out1.write( uiNut, 6);
-        // TODO: is this correct?
-        packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
+        vRtpPackets.push_back(packetiseSingleNalUnit(mediaSample, hasDonl() ? m_vDons[uiCurrentSample] : 0));
+        m_vLastPacketisationInfo[uiCurrentSample].push_back(uiRtpPacketIndex++);
+        ++uiCurrentSample;
       }
       else
       {
-        /// S | E = 0 | 0
-        // out1.write(0, 3);
-        out1.write(0, 1);
-        out1.write(0, 1);
-        out1.write( uiNut, 6);
+        vRtpPackets.push_back(packetiseAp(mediaSamples, uiCurrentSample, uiCount));
+        for (size_t i = uiCurrentSample; i < uiCurrentSample + uiCount; ++i)
+        {
+          m_vLastPacketisationInfo[i].push_back(uiRtpPacketIndex);
+        }
+        ++uiRtpPacketIndex;
+        uiCurrentSample += uiCount;
       }
     }
-
-    // Payload
-    uint32_t uiBytesToWrite = std::min(in.getBytesRemaining(), uiMaxBytesPerPayload);
-    bool bRes = out1.write(in, uiBytesToWrite);
-    assert(bRes);
-    uiBytesToPacketize -= uiBytesToWrite;
-
-    VLOG(15) << "FU size: " << uiBytesToWrite;
-    // create RTP packet
-    packet.setPayload(out1.data());
-    vRtpPackets.push_back(packet);
   }
-
   return vRtpPackets;
 }
 
-
-std::vector<RtpPacket> RfchevcPacketiser::packetiseNonInterleaved(const MediaSample& mediaSample)
+void RfchevcPacketiser::handleAp(const RtpPacket& rtpPacket, std::vector<MediaSample>& vSamples, const RtpPacketGroup& rtpPacketGroup)
 {
-  std::vector<RtpPacket> vRtpPackets;
-  // for now don't do STAP
-  if (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload)
+  const Buffer& rawData = rtpPacket.getPayload();
+  const uint8_t* pData = rawData.data();
+  const uint32_t uiSize = rawData.getSize();
+  uint32_t uiOffset = PAYLOAD_HEADER_SIZE;
+  uint16_t uiDon = 0;
+  if (hasDonl())
   {
-    vRtpPackets = packetiseFuA(mediaSample);
+    if (uiSize < PAYLOAD_HEADER_SIZE + DONL_SIZE)
+    {
+      LOG(WARNING) << "Failed to read AP DONL. SN: " << rtpPacket.getExtendedSequenceNumber();
+      return;
+    }
+    uiDon = (pData[2] << 8) | pData[3];
+    uiOffset += DONL_SIZE;
   }
-  else
+
+  bool bFirst = true;
+  while (uiOffset < uiSize)
   {
-    // Note: the RTP header will be populated in the RTP session
-    vRtpPackets.push_back(packetiseSingleNalUnit(mediaSample));
+    if (hasDonl() && !bFirst)
+    {
+      uiDon += pData[uiOffset++] + 1;
+    }
+    if (uiOffset + AP_NALU_SIZE_SIZE > uiSize)
+    {
+      LOG(WARNING) << "Failed to read AP NAL unit size. SN: " << rtpPacket.getExtendedSequenceNumber();
+      return;
+    }
+    const uint32_t uiNalUnitSize = (pData[uiOffset] << 8) | pData[uiOffset + 1];
+    uiOffset += AP_NALU_SIZE_SIZE;
+    if (uiNalUnitSize == 0 || uiOffset + uiNalUnitSize > uiSize)
+    {
+      LOG(WARNING) << "Invalid AP NAL unit size: " << uiNalUnitSize << " SN: " << rtpPacket.getExtendedSequenceNumber();
+      return;
+    }
+#ifdef DEBUG_RFCHEVC_PACKETIZATION
+    VLOG(1) << "AP: Parsed NAL unit type: " << toString((NalUnitType)getType(pData + uiOffset));
+#endif
+    // the NAL unit references the payload of the aggregation packet
+    MediaSample mediaSample;
+    mediaSample.setData(sliceBuffer(rawData, uiOffset, uiNalUnitSize));
+    if (hasDonl())
+      mediaSample.setDecodingOrderNumber(uiDon);
+    mediaSample.setRtpTime(rtpPacket.getRtpTimestamp());
+    mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
+    vSamples.push_back(mediaSample);
+    uiOffset += uiNalUnitSize;
+    bFirst = false;
   }
-  return vRtpPackets;
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetiseInterleaved(const MediaSample& mediaSample)
+std::list<RtpPacket>::const_iterator RfchevcPacketiser::handleFu(const std::list<RtpPacket>& rtpPackets,
+                                                             std::list<RtpPacket>::const_iterator itFirstFu,
+                                                             std::vector<MediaSample>& vSamples,
+                                                             const RtpPacketGroup& rtpPacketGroup)
 {
-  std::vector<RtpPacket> vRtpPackets;
-  // for now don't do STAP
-  if (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload-5)//In STAP-B we need additionally 2 bytes for DON and 2 for NALU length
+  const Buffer& firstFu = itFirstFu->getPayload();
+  const uint8_t* pFirstFu = firstFu.data();
+  if (firstFu.getSize() < PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE)
   {
-    vRtpPackets = packetiseFuB(mediaSample);
+    LOG(WARNING) << "Failed to read FU header. SN: " << itFirstFu->getExtendedSequenceNumber();
+    return ++itFirstFu;
   }
-  else
+  // FU header: S, E and the type of the fragmented NAL unit
+  const uint8_t uiFuHeader = pFirstFu[2];
+  const uint8_t uiNut = uiFuHeader & 0x3F;
+  const bool bStart = (uiFuHeader & 0x80) != 0;
+  // the DONL field is only present in the first fragment
+  const uint32_t uiFirstHeaderSize = PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE + ((bStart && hasDonl()) ? DONL_SIZE : 0);
+  if (firstFu.getSize() < uiFirstHeaderSize)
   {
-    // Note: the RTP header will be populated in the RTP session
-    RtpPacket packet;
-    // STAP-A indicator
-    OBitStream out1(mediaSample.getPayloadSize() + 5);
-    IBitStream in(mediaSample.getDataBuffer());
-    // forbidden
-    in.skipBits(1);
-    // NUT
-    uint32_t uiLayerId = 0, uiTempId = 0, uiNut = 0;
-    in.read(uiNut, 6);
-    //  LayerId
-    in.read(uiLayerId, 6);
-    //  TempId
-    in.read(uiTempId, 3);
-
-    out1.write(0, 1);
-    out1.write(static_cast<uint32_t>(NUT_AP), 6);
-    out1.write(uiLayerId, 6);
-    out1.write(uiTempId, 3);
-    out1.write(mediaSample.getDecodingOrderNumber(), 16);
-    out1.write(mediaSample.getPayloadSize(), 16);
-    out1.write(0, 1);
-    out1.write(uiNut, 6);
-    out1.write(uiLayerId, 6);
-    out1.write(uiTempId, 3);
-    out1.write(in,mediaSample.getPayloadSize()-2);
-    packet.setPayload(out1.data());
-    packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
-    vRtpPackets.push_back(packet);
+    LOG(WARNING) << "Failed to read FU DONL. SN: " << itFirstFu->getExtendedSequenceNumber();
+    return ++itFirstFu;
   }
-  return vRtpPackets;
-}
-
-int32_t RfchevcPacketiser::getNumberOfSamplesToAggregate(uint32_t uiBytesAvailableForPayload,
-                                                         const std::vector<MediaSample>& mediaSamples,
-                                                         uint32_t uiStartIndex, uint32_t& uiStapSize,
-                                                         bool& bFBit, uint32_t& uiLayerId, uint32_t& uiTempId, bool Interleaved )
-{
-  int iNalUnitsToAggregate = 0;
-  uiStapSize = 0;
-  bFBit = false;
-  uiLayerId = -1;
-  uiTempId = -1;
 
-  // subtract first byte of STAP-A
-  ++uiStapSize;
-  --uiBytesAvailableForPayload;
+#ifdef DEBUG_RFCHEVC_PACKETIZATION
+  VLOG(2) << "First FU: SN: " << itFirstFu->getExtendedSequenceNumber() << " start: " << bStart << " end: " << ((uiFuHeader & 0x40) != 0) << " Type: " << toString((NalUnitType)uiNut);
+#endif
 
-  for (size_t i = uiStartIndex; uiBytesAvailableForPayload > 0 && i < mediaSamples.size(); ++i)
+  // first pass: find the fragments and the size of the reassembled NAL unit. A start bit or
+  // a different NAL unit type means that the end of this NAL unit was lost.
+  uint32_t uiNalUnitSize = PAYLOAD_HEADER_SIZE + firstFu.getSize() - uiFirstHeaderSize;
+  bool bLoss = !bStart;
+  bool bEnd = (uiFuHeader & 0x40) != 0;
+  uint32_t uiPreviousSN = itFirstFu->getExtendedSequenceNumber();
+  std::list<RtpPacket>::const_iterator itEnd = itFirstFu;
+  for (++itEnd; !bEnd && itEnd != rtpPackets.end(); ++itEnd)
   {
-    // add 2 bytes for the length of the NAL unit
-    uint32_t uiSizeRequiredForThisNal = mediaSamples[i].getPayloadSize() + 2 + 1*(Interleaved==true&&i==uiStartIndex) + 1*(Interleaved==true) ;
-    if (uiSizeRequiredForThisNal > uiBytesAvailableForPayload)
+    const Buffer& nextFu = itEnd->getPayload();
+    const uint8_t* pNextFu = nextFu.data();
+    if (nextFu.getSize() < PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE ||
+        getType(pNextFu) != NUT_FU ||
+        (pNextFu[2] & 0x80) != 0 ||
+        (pNextFu[2] & 0x3F) != uiNut)
+    {
       break;
+    }
+    const uint32_t uiNextSN = itEnd->getExtendedSequenceNumber();
+    if (uiNextSN != uiPreviousSN + 1)
+    {
+      LOG(WARNING) << "Missing sequence number in FU - SN: " << uiNextSN << " Prev: " << uiPreviousSN;
+      bLoss = true;
+    }
+    uiPreviousSN = uiNextSN;
+    uiNalUnitSize += nextFu.getSize() - PAYLOAD_HEADER_SIZE - FU_HEADER_SIZE;
+    bEnd = (pNextFu[2] & 0x40) != 0;
+  }
 
-    uint16_t uiNalHeader = (mediaSamples[i].getDataBuffer().data()[0]<<8)+mediaSamples[i].getDataBuffer().data()[1];
-    // F-Bit
-    if ((uiNalHeader & 0x8000) != 0) bFBit = true;
-    // LayerId
-    uint32_t uiCurrentLayerId = (uiNalHeader & 0x01F8) >> 3;
-    if (uiCurrentLayerId < uiLayerId) uiLayerId = uiCurrentLayerId;
-    uint32_t uiCurrentTempId = (uiNalHeader & 0x0007);
-    if (uiCurrentTempId < uiTempId) uiTempId = uiCurrentTempId;
+  if (bLoss || !bEnd)
+  {
+    LOG(WARNING) << "Discarding incomplete fragmented NAL unit. SN: " << itFirstFu->getExtendedSequenceNumber() << "-" << uiPreviousSN;
+#ifdef DEBUG_RFCHEVC_PACKETIZATION
+    printPacketListInfo(rtpPackets);
+#endif
+    return itEnd;
+  }
 
-    ++iNalUnitsToAggregate;
-    uiStapSize += uiSizeRequiredForThisNal;
-    uiBytesAvailableForPayload -= uiSizeRequiredForThisNal;
+  // second pass: copy the fragments into a buffer of the exact size
+  Buffer outputNalUnit = BufferPool::allocate(uiNalUnitSize);
+  uint8_t* pOut = &outputNalUnit[0];
+  // NAL unit header: F, LayerId and TID from the payload header, type from the FU header
+  pOut[0] = (pFirstFu[0] & 0x81) | (uiNut << 1);
+  pOut[1] = pFirstFu[1];
+  uint32_t uiOffset = PAYLOAD_HEADER_SIZE;
+  for (std::list<RtpPacket>::const_iterator it = itFirstFu; it != itEnd; ++it)
+  {
+    const Buffer& fu = it->getPayload();
+    const uint32_t uiHeaderSize = (it == itFirstFu) ? uiFirstHeaderSize : PAYLOAD_HEADER_SIZE + FU_HEADER_SIZE;
+    memcpy(pOut + uiOffset, fu.data() + uiHeaderSize, fu.getSize() - uiHeaderSize);
+    uiOffset += fu.getSize() - uiHeaderSize;
   }
+  assert(uiOffset == uiNalUnitSize);
 
-  return iNalUnitsToAggregate;
+#ifdef DEBUG_RFCHEVC_PACKETIZATION
+  VLOG(1) << "Successfully put FU together - Size: " << outputNalUnit.getSize();
+#endif
+  MediaSample mediaSample;
+  mediaSample.setData(outputNalUnit);
+  if (hasDonl())
+    mediaSample.setDecodingOrderNumber((pFirstFu[3] << 8) | pFirstFu[4]);
+  mediaSample.setRtpTime(rtpPacketGroup.getRtpTimestamp());
+  mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
+  vSamples.push_back(mediaSample);
+  return itEnd;
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetiseNonInterleaved(const std::vector<MediaSample>& mediaSamples)
+std::list<RtpPacket>::const_iterator RfchevcPacketiser::extractNextMediaSample(const RtpPacketGroup& rtpPacketGroup, const std::list<RtpPacket>& rtpPackets, std::list<RtpPacket>::const_iterator itStart, std::vector<MediaSample>& vMediaSamples)
 {
-  std::vector<RtpPacket> vRtpPackets;
-  uint32_t iCurrentPacket = 0;
-  int iRtpPacketIndex = 0;
-  while (iCurrentPacket < mediaSamples.size())
+  const RtpPacket& rtpPacket = *itStart;
+  const Buffer& rawData = rtpPacket.getPayload();
+  if (rawData.getSize() < PAYLOAD_HEADER_SIZE)
   {
-    const MediaSample& mediaSample = mediaSamples[iCurrentPacket];
-    if (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload)
+    LOG(WARNING) << "Failed to read payload header. SN: " << rtpPacket.getExtendedSequenceNumber();
+    return ++itStart;
+  }
+  const uint8_t* pData = rawData.data();
+  const uint8_t uiType = getType(pData);
+#ifdef DEBUG_RFCHEVC_PACKETIZATION
+  VLOG(5) << "extractNextMediaSample: SN " << rtpPacket.getExtendedSequenceNumber() << " type: " << toString(static_cast<NalUnitType>(uiType)) << " layer ID " << getLayerId(pData) << " TID " << getTid(pData);
+#endif
+  switch (uiType)
+  {
+    case NUT_AP:
     {
-      // FU-A
-      std::vector<RtpPacket> vFuRtpPackets = packetiseFuA(mediaSample);
-      vRtpPackets.insert(vRtpPackets.end(), vFuRtpPackets.begin(), vFuRtpPackets.end());
-
-      // update packetisation info
-      for (size_t i = 0; i < vFuRtpPackets.size(); ++i)
-      {
-        m_vLastPacketisationInfo[iCurrentPacket].push_back(iRtpPacketIndex);
-        ++iRtpPacketIndex;
-      }
-
-      ++iCurrentPacket;
+      handleAp(rtpPacket, vMediaSamples, rtpPacketGroup);
+      return ++itStart;
     }
-    else
+    case NUT_FU:
     {
-      // see if we can do STAPs
-      bool bFBit = false;
-      uint32_t uiLayerId = 0;
-      uint32_t uiTempId = 0;
-      uint32_t uiStapSize = 0;
-      int32_t iCount = getNumberOfSamplesToAggregate(m_uiBytesAvailableForPayload, mediaSamples, iCurrentPacket, uiStapSize, bFBit, uiLayerId, uiTempId);
-      if (iCount < 2)
+      return handleFu(rtpPackets, itStart, vMediaSamples, rtpPacketGroup);
+    }
+    default:
+    {
+      if (uiType > NUT_RSV_47)
       {
-        // Single Nal Unit
-        vRtpPackets.push_back(packetiseSingleNalUnit(mediaSample));
-        // update packetisation info
-        m_vLastPacketisationInfo[iCurrentPacket].push_back(iRtpPacketIndex);
-        ++iRtpPacketIndex;
-
-        ++iCurrentPacket;
+        LOG(WARNING) << "The payload type " << (uint32_t)uiType << " is not supported";
+        return ++itStart;
       }
-      else
+      MediaSample mediaSample;
+      if (hasDonl())
       {
-        RtpPacket packet;
-        // STAP-A indicator
-        OBitStream out1(uiStapSize);
-        out1.write(bFBit, 1);
-        out1.write(static_cast<uint32_t>(NUT_AP), 6);
-        out1.write(uiLayerId, 6);
-        out1.write(uiTempId, 3);
-        // we can aggregate some packets
-        for (size_t i = iCurrentPacket; i < (uint32_t)iCurrentPacket + iCount; ++i)
+        if (rawData.getSize() < PAYLOAD_HEADER_SIZE + DONL_SIZE)
         {
-          const MediaSample& mediaSample = mediaSamples[i];
-          out1.write(mediaSample.getPayloadSize(), 16);
-          VLOG(15) << "Copying media sample data into STAP-A: " << mediaSample.getPayloadSize() << " bytes";
-          // copy rest of stream
-          IBitStream in(mediaSample.getDataBuffer());
-          out1.write(in);
-
-          // update packetisation info
-          m_vLastPacketisationInfo[i].push_back(iRtpPacketIndex);
+          LOG(WARNING) << "Failed to read DONL. SN: " << rtpPacket.getExtendedSequenceNumber();
+          return ++itStart;
         }
-        packet.setPayload(out1.data());
-        // the marker bit gets set according to the last sample in the STAP
-        packet.getHeader().setMarkerBit(mediaSamples[iCurrentPacket + iCount - 1].isMarkerSet());
-        vRtpPackets.push_back(packet);
-
-        // update packetisation info
-        ++iRtpPacketIndex;
-
-        iCurrentPacket += iCount;
+        // remove the DONL field between the NAL unit header and the NAL unit payload
+        Buffer nalUnit = BufferPool::allocate(rawData.getSize() - DONL_SIZE);
+        nalUnit[0] = pData[0];
+        nalUnit[1] = pData[1];
+        memcpy(&nalUnit[PAYLOAD_HEADER_SIZE], pData + PAYLOAD_HEADER_SIZE + DONL_SIZE, rawData.getSize() - PAYLOAD_HEADER_SIZE - DONL_SIZE);
+        mediaSample.setData(nalUnit);
+        mediaSample.setDecodingOrderNumber((pData[2] << 8) | pData[3]);
+      }
+      else
+      {
+        mediaSample.setData(rawData);
       }
+      mediaSample.setRtpTime(rtpPacket.getRtpTimestamp());
+      mediaSample.setPresentationTime(rtpPacketGroup.getPresentationTime());
+      vMediaSamples.push_back(mediaSample);
+      return ++itStart;
     }
   }
-  return vRtpPackets;
 }
 
-std::vector<RtpPacket> RfchevcPacketiser::packetiseInterleaved(const std::vector<MediaSample>& mediaSamples)
+std::vector<MediaSample> RfchevcPacketiser::depacketize(const RtpPacketGroup& rtpPacketGroup)
 {
-  std::vector<RtpPacket> vRtpPackets;
-  uint32_t iCurrentPacket = 0;
-  uint16_t uiBaseDON = 0;
-  uint8_t uiDiffDON = 0;
-  while (iCurrentPacket < mediaSamples.size())
+  std::vector<MediaSample> vSamples;
+  const std::list<RtpPacket>& rtpPackets = rtpPacketGroup.getRtpPackets();
+  std::list<RtpPacket>::const_iterator it = rtpPackets.begin();
+  while (it != rtpPackets.end())
   {
-    const MediaSample& mediaSample = mediaSamples[iCurrentPacket];
-    if (mediaSample.getDataBuffer().getSize() > m_uiBytesAvailableForPayload-4)
-    {
-      // FU-A
-      std::vector<RtpPacket> vFuRtpPackets = packetiseFuB(mediaSample);
-      vRtpPackets.insert(vRtpPackets.end(), vFuRtpPackets.begin(), vFuRtpPackets.end());
-      ++iCurrentPacket;
-    }
-    else
-    {
-      // see if we can do STAPs
-      bool bFBit = false;
-      uint32_t uiLayerId = 0;
-      uint32_t uiTempId = 0;
-      uint32_t uiStapSize = 0;
-      uiBaseDON = mediaSample.getDecodingOrderNumber();
-      int32_t iCount = getNumberOfSamplesToAggregate(m_uiBytesAvailableForPayload, mediaSamples, iCurrentPacket, uiStapSize, bFBit, uiLayerId, uiTempId, true);
-      if (iCount == 1)
-      {
-        // Single Nal Unit
-        RtpPacket packet;
-        // STAP-A indicator
-        OBitStream out1(uiStapSize);
+    it = extractNextMediaSample(rtpPacketGroup, rtpPackets, it, vSamples);
+  }
 
-        IBitStream in(mediaSample.getDataBuffer());
-        // forbidden
-        in.skipBits(1);
-        //NUT
-        uint32_t uiNut = 0;
-        in.read(uiNut, 6);
-        // LayerId
-        in.read(uiLayerId, 6);
-        // TempId
-        in.read(uiLayerId, 3);
+  // we use the marker bit to indicate that RTCP sync has occurred
+  for (MediaSample& mediaSample : vSamples)
+  {
+    mediaSample.setMarker(rtpPacketGroup.isRtcpSynchronised());
+  }
 
-        out1.write(bFBit, 1);
-        out1.write(static_cast<uint32_t>(NUT_AP), 6);
-        out1.write(uiLayerId, 6);
-        out1.write(uiTempId, 3);
-        out1.write(mediaSample.getDecodingOrderNumber(), 16);
-        out1.write(mediaSample.getPayloadSize(), 16);
-        out1.write(bFBit, 1);
-        out1.write(uiNut, 6);
-        out1.write(uiLayerId, 6);
-        out1.write(uiTempId, 3);
-        out1.write(in,mediaSample.getPayloadSize()-2);
-        packet.setPayload(out1.data());
-        packet.getHeader().setMarkerBit(mediaSample.isMarkerSet());
-        vRtpPackets.push_back(packet);
-        ++iCurrentPacket;
-      }
-      else
-      {
-        RtpPacket packet;
-        // STAP-A indicator
-        OBitStream out1(uiStapSize);
-        out1.write(bFBit, 1);
-        out1.write(static_cast<uint32_t>(NUT_AP), 6);
-        out1.write(uiLayerId, 6);
-        out1.write(uiTempId, 3);
-        // we can aggregate some packets
-        for (size_t i = iCurrentPacket; i < (uint32_t)iCount; ++i)
-        {
-          const MediaSample& mediaSample = mediaSamples[i];
-          if(uiBaseDON == mediaSample.getDecodingOrderNumber()){
-              out1.write(mediaSample.getDecodingOrderNumber(), 16);
-              uiBaseDON = mediaSample.getDecodingOrderNumber();
-          }
-          else{
-              uiBaseDON += 1;
-              uiDiffDON = mediaSample.getDecodingOrderNumber() - uiBaseDON;
-              out1.write(uiDiffDON , 8);
-              uiBaseDON = mediaSample.getDecodingOrderNumber();
-          }
-          out1.write(mediaSample.getPayloadSize(), 16);
-          VLOG(15) << "Copying media sample data into STAP-A: " << mediaSample.getPayloadSize() << " bytes";
-          // copy rest of stream
-          IBitStream in(mediaSample.getDataBuffer());
-          out1.write(in);
-        }
-        packet.setPayload(out1.data());
-        vRtpPackets.push_back(packet);
+  if (!hasDonl())
+    return vSamples;
 
-        iCurrentPacket += iCount;
-      }
+  // restore the decoding order which may span several packet groups
+  std::vector<MediaSample> vOrderedSamples;
+  for (const MediaSample& mediaSample : vSamples)
+  {
+    if (!m_reorderQueue.push(mediaSample, vOrderedSamples))
+    {
+      LOG(WARNING) << "Discarding late or duplicate NAL unit. DON: " << getDon(mediaSample);
     }
   }
-  return vRtpPackets;
+  return vOrderedSamples;
 }
 
-
-std::vector<MediaSample> RfchevcPacketiser::depacketizeSingleNalUnit(const std::list<RtpPacket>& rtpPackets)
+std::vector<MediaSample> RfchevcPacketiser::flush()
 {
   std::vector<MediaSample> vSamples;
-  // there is only one NAL per RTP packet
-  // SPS and PPS could have the same timestamp and thus be grouped together
-  for(const RtpPacket& rtpPacket: rtpPackets)
-  {
-    // check nal unit type
-    const Buffer rawData = rtpPacket.getPayload();
-    IBitStream in(rawData);
-    uint32_t forbidden = 0, layerId = 0, tempId, type = 0;
-    if (( in.read(forbidden, 1)) &&
-        ( in.read(type, 6)) &&
-        ( in.read(layerId, 6 )) &&
-        ( in.read(tempId, 3 )) )
-    {
-        DLOG(INFO) << "Forbidden: " << forbidden << " LayerId: " << layerId << "TempId" << tempId << " type: " << type;
-      if (type > NUT_RSV_47)
-      {
-        LOG(WARNING) << "The NAL unit type " << type << " is not allowed in single nal unit mode";
-      }
-      else
-      {
-        MediaSample mediaSample;
-        mediaSample.setData(rawData);
-        vSamples.push_back(mediaSample);
-      }
-    }
-    else
-    {
-      LOG(FATAL) << "Failed to read NAL unit data";
-    }
-  }
+  m_reorderQueue.flush(vSamples);
   return vSamples;
 }
 
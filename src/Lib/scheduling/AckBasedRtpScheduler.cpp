@@ -325,6 +325,17 @@ void AckBasedRtpScheduler::processFeedback(const rfc4585::RtcpFb& fb, const EndP
   }
 }
 
+void AckBasedRtpScheduler::processNacks(const std::vector<uint16_t>& nacks, const EndPoint& /*ep*/)
+{
+  VLOG(10) << "Received generic NACK containing " << nacks.size();
+  nack(nacks);
+}
+
+void AckBasedRtpScheduler::processAcks(const std::vector<uint16_t>& acks, const EndPoint& /*ep*/)
+{
+  ack(acks);
+}
+
 void AckBasedRtpScheduler::ack(const std::vector<uint16_t>& acks)
 {
   // lookup sizes
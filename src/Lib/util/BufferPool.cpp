@@ -0,0 +1,145 @@
+#include "CorePch.h"
+#include <rtp++/util/BufferPool.h>
+#include <atomic>
+#include <boost/shared_array.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace rtp_plus_plus
+{
+
+namespace
+{
+
+const uint32_t CLASS_SIZES[BufferPool::SC_NUM_CLASSES] =
+{
+  BufferPool::MTU_BUFFER_SIZE,
+  BufferPool::JUMBO_BUFFER_SIZE,
+  BufferPool::FRAME_BUFFER_SIZE
+};
+
+// upper bound of free blocks kept per thread: the rest is returned to the heap
+const size_t MAX_FREE_BLOCKS[BufferPool::SC_NUM_CLASSES] = { 1024, 128, 8 };
+
+struct Counters
+{
+  std::atomic<uint64_t> Hits;
+  std::atomic<uint64_t> Misses;
+  std::atomic<uint64_t> Outstanding;
+  std::atomic<uint64_t> HighWaterMark;
+};
+
+// counters are shared by all threads
+Counters g_counters[BufferPool::SC_NUM_CLASSES];
+
+// the pool is deleted when the thread exits
+boost::thread_specific_ptr<BufferPool> g_pThreadPool;
+
+}
+
+BufferPool::BufferPool()
+{
+
+}
+
+BufferPool::~BufferPool()
+{
+  for (size_t i = 0; i < SC_NUM_CLASSES; ++i)
+  {
+    for (uint8_t* pBlock : m_vFreeBlocks[i])
+    {
+      delete[] pBlock;
+    }
+  }
+}
+
+BufferPool* BufferPool::getThreadInstance()
+{
+  BufferPool* pPool = g_pThreadPool.get();
+  if (!pPool)
+  {
+    pPool = new BufferPool();
+    g_pThreadPool.reset(pPool);
+  }
+  return pPool;
+}
+
+Buffer BufferPool::allocate(uint32_t uiSize, uint32_t uiPreBufferSize, uint32_t uiPostBufferSize)
+{
+  uint32_t uiRequired = uiSize + uiPreBufferSize + uiPostBufferSize;
+  for (size_t i = 0; i < SC_NUM_CLASSES; ++i)
+  {
+    if (uiRequired <= CLASS_SIZES[i])
+    {
+      return getThreadInstance()->allocateFromClass(static_cast<SizeClass>(i), uiSize, uiPreBufferSize);
+    }
+  }
+  // too large for the pool: allocate from the heap
+  g_counters[SC_FRAME].Misses.fetch_add(1, std::memory_order_relaxed);
+  return Buffer(new uint8_t[uiRequired], uiRequired, uiPreBufferSize, uiPostBufferSize);
+}
+
+Buffer BufferPool::allocateFromClass(SizeClass eClass, uint32_t uiSize, uint32_t uiPreBufferSize)
+{
+  Counters& counters = g_counters[eClass];
+  uint8_t* pBlock = NULL;
+  std::vector<uint8_t*>& vFreeBlocks = m_vFreeBlocks[eClass];
+  if (!vFreeBlocks.empty())
+  {
+    pBlock = vFreeBlocks.back();
+    vFreeBlocks.pop_back();
+    counters.Hits.fetch_add(1, std::memory_order_relaxed);
+  }
+  else
+  {
+    pBlock = new uint8_t[CLASS_SIZES[eClass]];
+    counters.Misses.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t uiOutstanding = counters.Outstanding.fetch_add(1, std::memory_order_relaxed) + 1;
+  uint64_t uiHighWaterMark = counters.HighWaterMark.load(std::memory_order_relaxed);
+  while (uiOutstanding > uiHighWaterMark &&
+         !counters.HighWaterMark.compare_exchange_weak(uiHighWaterMark, uiOutstanding, std::memory_order_relaxed))
+  {
+  }
+
+  uint32_t uiBlockSize = CLASS_SIZES[eClass];
+  return Buffer(boost::shared_array<uint8_t>(pBlock, Deleter(eClass)),
+                uiBlockSize, uiPreBufferSize, uiBlockSize - uiPreBufferSize - uiSize);
+}
+
+void BufferPool::Deleter::operator()(uint8_t* pBlock) const
+{
+  g_counters[m_eClass].Outstanding.fetch_sub(1, std::memory_order_relaxed);
+  // don't create a pool here: this might be called while the thread is exiting
+  BufferPool* pPool = g_pThreadPool.get();
+  if (pPool && pPool->m_vFreeBlocks[m_eClass].size() < MAX_FREE_BLOCKS[m_eClass])
+  {
+    pPool->m_vFreeBlocks[m_eClass].push_back(pBlock);
+  }
+  else
+  {
+    delete[] pBlock;
+  }
+}
+
+BufferPool::Statistics BufferPool::getStatistics(SizeClass eClass)
+{
+  Statistics stats;
+  const Counters& counters = g_counters[eClass];
+  stats.Hits = counters.Hits.load(std::memory_order_relaxed);
+  stats.Misses = counters.Misses.load(std::memory_order_relaxed);
+  stats.Outstanding = counters.Outstanding.load(std::memory_order_relaxed);
+  stats.HighWaterMark = counters.HighWaterMark.load(std::memory_order_relaxed);
+  return stats;
+}
+
+std::ostream& operator<<(std::ostream& ostr, const BufferPool::Statistics& stats)
+{
+  ostr << "Hits: " << stats.Hits
+       << " Misses: " << stats.Misses
+       << " Outstanding: " << stats.Outstanding
+       << " High water mark: " << stats.HighWaterMark;
+  return ostr;
+}
+
+} // rtp_plus_plus
@@ -0,0 +1,68 @@
+#include "CorePch.h"
+#include <rtp++/util/Clock.h>
+#ifdef _WIN32
+#include <boost/chrono.hpp>
+#else
+#include <time.h>
+#endif
+
+namespace rtp_plus_plus
+{
+
+static SystemClock g_systemClock;
+
+const Clock* Clock::s_pClock = &g_systemClock;
+
+void Clock::install(const Clock* pClock)
+{
+  s_pClock = pClock ? pClock : &g_systemClock;
+}
+
+boost::posix_time::ptime Clock::toPosixTime(int64_t iUnixNs)
+{
+  if (iUnixNs == 0) return boost::posix_time::ptime();
+  static const boost::posix_time::ptime tEpoch(boost::gregorian::date(1970, 1, 1));
+  return tEpoch + boost::posix_time::microseconds(iUnixNs / 1000);
+}
+
+int64_t Clock::fromPosixTime(const boost::posix_time::ptime& t)
+{
+  if (t.is_special()) return 0;
+  static const boost::posix_time::ptime tEpoch(boost::gregorian::date(1970, 1, 1));
+  return (t - tEpoch).total_microseconds() * 1000;
+}
+
+#ifdef _WIN32
+int64_t SystemClock::getMonotonicNs() const
+{
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t SystemClock::getRealtimeNs() const
+{
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::system_clock::now().time_since_epoch()).count();
+}
+#else
+int64_t SystemClock::getMonotonicNs() const
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec;
+}
+
+int64_t SystemClock::getRealtimeNs() const
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec;
+}
+#endif
+
+VirtualClock::VirtualClock(int64_t iRealtimeNs)
+  :m_iStartNs(iRealtimeNs),
+    m_iNowNs(iRealtimeNs)
+{
+
+}
+
+} // rtp_plus_plus
@@ -0,0 +1,146 @@
+#include "CorePch.h"
+#include <rtp++/util/MappedFile.h>
+#include <cassert>
+#include <iterator>
+#include <boost/shared_array.hpp>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rtp_plus_plus
+{
+
+namespace
+{
+
+/**
+ * @brief Deleter of the buffers referencing the file: releases the reference to the file
+ * instead of the memory
+ */
+struct KeepAlive
+{
+  KeepAlive(boost::shared_ptr<const MappedFile> pFile) :m_pFile(pFile) {}
+  void operator()(uint8_t*) const {}
+  boost::shared_ptr<const MappedFile> m_pFile;
+};
+
+} // anon
+
+MappedFile::MappedFile()
+  :m_pData(NULL),
+    m_uiSize(0),
+    m_bMapped(false)
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_bMapped)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(m_pData);
+#else
+    munmap(const_cast<uint8_t*>(m_pData), m_uiSize);
+#endif
+  }
+}
+
+MappedFile::ptr MappedFile::map(const std::string& sFilename)
+{
+  ptr pFile(new MappedFile());
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(sFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    LOG(WARNING) << "Failed to open " << sFilename;
+    return ptr();
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(hFile, &size))
+  {
+    LOG(WARNING) << "Failed to get size of " << sFilename;
+    CloseHandle(hFile);
+    return ptr();
+  }
+  if (size.QuadPart > 0)
+  {
+    // copy-on-write so that the buffers can be written to without modifying the file
+    HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void* pView = hMapping ? MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    // the view keeps the mapping and the file open
+    if (hMapping) CloseHandle(hMapping);
+    if (!pView)
+    {
+      LOG(WARNING) << "Failed to map " << sFilename;
+      CloseHandle(hFile);
+      return ptr();
+    }
+    pFile->m_pData = static_cast<const uint8_t*>(pView);
+    pFile->m_uiSize = size.QuadPart;
+    pFile->m_bMapped = true;
+  }
+  CloseHandle(hFile);
+#else
+  int fd = open(sFilename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    LOG(WARNING) << "Failed to open " << sFilename;
+    return ptr();
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+  {
+    LOG(WARNING) << "Failed to get size of " << sFilename;
+    close(fd);
+    return ptr();
+  }
+  // an empty file can't be mapped
+  if (st.st_size > 0)
+  {
+    // copy-on-write so that the buffers can be written to without modifying the file
+    void* pMapping = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (pMapping == MAP_FAILED)
+    {
+      LOG(WARNING) << "Failed to map " << sFilename;
+      close(fd);
+      return ptr();
+    }
+#ifdef MADV_SEQUENTIAL
+    // sources read the file front to back
+    madvise(pMapping, st.st_size, MADV_SEQUENTIAL);
+#endif
+    pFile->m_pData = static_cast<const uint8_t*>(pMapping);
+    pFile->m_uiSize = st.st_size;
+    pFile->m_bMapped = true;
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+#endif
+  return pFile;
+}
+
+MappedFile::ptr MappedFile::read(std::istream& in)
+{
+  ptr pFile(new MappedFile());
+  pFile->m_vData.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  pFile->m_pData = pFile->m_vData.empty() ? NULL : &pFile->m_vData[0];
+  pFile->m_uiSize = pFile->m_vData.size();
+  return pFile;
+}
+
+Buffer MappedFile::getBuffer(uint64_t uiOffset, uint32_t uiSize) const
+{
+  assert(uiOffset + uiSize <= m_uiSize);
+  // the mapping is writable: see map
+  uint8_t* pData = const_cast<uint8_t*>(m_pData) + uiOffset;
+  return Buffer(boost::shared_array<uint8_t>(pData, KeepAlive(shared_from_this())), uiSize);
+}
+
+} // rtp_plus_plus
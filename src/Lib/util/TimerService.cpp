@@ -0,0 +1,135 @@
+#include "CorePch.h"
+#include <rtp++/util/TimerService.h>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <rtp++/util/Clock.h>
+
+namespace rtp_plus_plus
+{
+
+boost::asio::io_service::id TimerService::id;
+
+TimerService::TimerService(boost::asio::io_service& ioService)
+  :boost::asio::io_service::service(ioService),
+    m_rIoService(ioService),
+    m_timer(ioService),
+    m_uiSequence(0),
+    m_uiNextGroup(NO_GROUP + 1),
+    m_bShutdown(false)
+{
+
+}
+
+TimerService::~TimerService()
+{
+
+}
+
+uint32_t TimerService::createGroup()
+{
+  boost::mutex::scoped_lock l(m_lock);
+  return m_uiNextGroup++;
+}
+
+void TimerService::expiresAt(const boost::posix_time::ptime& tDeadline, const Handler_t& handler, uint32_t uiGroup)
+{
+  boost::mutex::scoped_lock l(m_lock);
+  if (m_bShutdown) return;
+  m_vHeap.push_back(Entry(tDeadline, m_uiSequence++, uiGroup, handler));
+  std::push_heap(m_vHeap.begin(), m_vHeap.end(), Later());
+  arm();
+}
+
+void TimerService::expiresFromNow(const boost::posix_time::time_duration& duration, const Handler_t& handler, uint32_t uiGroup)
+{
+  expiresAt(Clock::universalTime() + duration, handler, uiGroup);
+}
+
+std::size_t TimerService::cancel(uint32_t uiGroup)
+{
+  std::vector<Entry> vCancelled;
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    auto it = std::partition(m_vHeap.begin(), m_vHeap.end(), [uiGroup](const Entry& entry)
+    {
+      return entry.Group != uiGroup;
+    });
+    if (it == m_vHeap.end()) return 0;
+    vCancelled.assign(it, m_vHeap.end());
+    m_vHeap.erase(it, m_vHeap.end());
+    std::make_heap(m_vHeap.begin(), m_vHeap.end(), Later());
+    // the timer is left armed: an early expiry re-arms it for the new front
+  }
+
+  const boost::system::error_code ec = boost::asio::error::operation_aborted;
+  for (Entry& entry : vCancelled)
+  {
+    m_rIoService.post(boost::bind(entry.Handler, ec));
+  }
+  return vCancelled.size();
+}
+
+std::size_t TimerService::getPendingCount() const
+{
+  boost::mutex::scoped_lock l(m_lock);
+  return m_vHeap.size();
+}
+
+void TimerService::shutdown_service()
+{
+  boost::mutex::scoped_lock l(m_lock);
+  m_bShutdown = true;
+  m_vHeap.clear();
+  boost::system::error_code ec;
+  m_timer.cancel(ec);
+}
+
+void TimerService::arm()
+{
+  if (m_vHeap.empty()) return;
+  const boost::posix_time::ptime& tDeadline = m_vHeap.front().Deadline;
+  if (!m_tArmed.is_not_a_date_time() && m_tArmed <= tDeadline) return;
+  // this aborts an outstanding wait for a later deadline. The wait is relative as the
+  // deadline is in the time of the installed clock.
+  m_timer.expires_from_now(tDeadline - Clock::universalTime());
+  m_tArmed = tDeadline;
+  m_timer.async_wait(boost::bind(&TimerService::onTimeout, this, _1));
+}
+
+void TimerService::onTimeout(const boost::system::error_code& ec)
+{
+  // aborted waits have been superseded by one for an earlier deadline
+  if (ec == boost::asio::error::operation_aborted) return;
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    m_tArmed = boost::posix_time::ptime();
+  }
+  poll();
+}
+
+std::size_t TimerService::poll()
+{
+  std::vector<Entry> vExpired;
+  {
+    boost::mutex::scoped_lock l(m_lock);
+    if (m_bShutdown) return 0;
+    boost::posix_time::ptime tNow = Clock::universalTime();
+    while (!m_vHeap.empty() && m_vHeap.front().Deadline <= tNow)
+    {
+      std::pop_heap(m_vHeap.begin(), m_vHeap.end(), Later());
+      vExpired.push_back(std::move(m_vHeap.back()));
+      m_vHeap.pop_back();
+    }
+    arm();
+  }
+
+  // handlers are called without holding the lock so that they can schedule new timers
+  const boost::system::error_code success;
+  for (Entry& entry : vExpired)
+  {
+    entry.Handler(success);
+  }
+  return vExpired.size();
+}
+
+} // rtp_plus_plus
@@ -2,6 +2,9 @@
 #include <cpputil/RunningAverageQueue.h>
 #include <cpputil/IBitStream.h>
 #include <cpputil/OBitStream.h>
+#include <rtp++/util/BufferPool.h>
+#include <rtp++/util/BufferUtil.h>
+#include <rtp++/util/MpscRingBuffer.h>
 
 namespace rtp_plus_plus
 {
@@ -43,6 +46,66 @@ BOOST_AUTO_TEST_CASE( tc_test_CppUtil )
   BOOST_CHECK_EQUAL(queue2.getAverage(), uiTotal/static_cast<double>(uiCount));
 }
 
+BOOST_AUTO_TEST_CASE( tc_test_BufferPool )
+{
+  BufferPool::Statistics before = BufferPool::getStatistics(BufferPool::SC_MTU);
+  const uint8_t* pData = NULL;
+  {
+    Buffer buffer = BufferPool::allocate(1200);
+    BOOST_CHECK_EQUAL(buffer.getSize(), 1200);
+    pData = buffer.data();
+    // the slice shares the storage of the buffer
+    Buffer slice = sliceBuffer(buffer, 12, 100);
+    BOOST_CHECK_EQUAL(slice.getSize(), 100);
+    BOOST_CHECK_EQUAL(slice.data() == pData + 12, true);
+  }
+  // the block must be reused once all references have been released
+  Buffer buffer = BufferPool::allocate(100);
+  BOOST_CHECK_EQUAL(buffer.data() == pData, true);
+  BufferPool::Statistics after = BufferPool::getStatistics(BufferPool::SC_MTU);
+  BOOST_CHECK_EQUAL(after.Hits, before.Hits + 1);
+  BOOST_CHECK_EQUAL(after.HighWaterMark >= 1, true);
+
+  // larger requests are served from the larger size classes
+  Buffer frame = BufferPool::allocate(BufferPool::JUMBO_BUFFER_SIZE + 1);
+  BOOST_CHECK_EQUAL(frame.getSize(), BufferPool::JUMBO_BUFFER_SIZE + 1);
+}
+
+BOOST_AUTO_TEST_CASE( tc_test_MpscRingBuffer )
+{
+  // the capacity is rounded up to a power of 2
+  MpscRingBuffer<uint32_t> queue(3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 4);
+  BOOST_CHECK_EQUAL(queue.front() == NULL, true);
+  for (uint32_t i = 0; i < 4; ++i)
+  {
+    BOOST_CHECK_EQUAL(queue.push(i), true);
+  }
+  // backpressure: the queue is full
+  BOOST_CHECK_EQUAL(queue.push(4), false);
+  BOOST_CHECK_EQUAL(*queue.peek(3), 3);
+  BOOST_CHECK_EQUAL(*queue.front(), 0);
+  queue.pop();
+  BOOST_CHECK_EQUAL(queue.push(4), true);
+  for (uint32_t i = 1; i < 5; ++i)
+  {
+    BOOST_CHECK_EQUAL(*queue.front(), i);
+    queue.pop();
+  }
+  BOOST_CHECK_EQUAL(queue.front() == NULL, true);
+
+  // bulk pushes are all or nothing
+  BOOST_CHECK_EQUAL(queue.pushBulk(3, [](size_t i) { return static_cast<uint32_t>(10 + i); }), true);
+  BOOST_CHECK_EQUAL(queue.pushBulk(2, [](size_t i) { return static_cast<uint32_t>(20 + i); }), false);
+  BOOST_CHECK_EQUAL(queue.pushBulk(1, [](size_t i) { return static_cast<uint32_t>(20 + i); }), true);
+  for (uint32_t i = 0; i < 3; ++i)
+  {
+    BOOST_CHECK_EQUAL(*queue.front(), 10 + i);
+    queue.pop();
+  }
+  BOOST_CHECK_EQUAL(*queue.front(), 20);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
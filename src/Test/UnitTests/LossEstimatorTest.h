@@ -1,6 +1,7 @@
 #pragma once
 
 #include <rtp++/LossEstimator.h>
+#include <rtp++/SequenceNumberWindow.h>
 
 namespace rtp_plus_plus
 {
@@ -286,6 +287,89 @@ BOOST_AUTO_TEST_CASE( tc_test_lossEstimationBehaviour)
   BOOST_CHECK_EQUAL(vLost.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE( tc_test_sequenceNumberWindow)
+{
+  SequenceNumberWindow window;
+  const uint32_t uiWindowSize = SequenceNumberWindow::WINDOW_SIZE;
+  BOOST_CHECK_EQUAL(window.isEmpty(), true);
+  BOOST_CHECK_EQUAL(window.mark(100), true);
+  BOOST_CHECK_EQUAL(window.mark(100), false);
+  BOOST_CHECK_EQUAL(window.mark(101), true);
+  // gap crossing word boundaries
+  BOOST_CHECK_EQUAL(window.mark(300), true);
+  BOOST_CHECK_EQUAL(window.getHighest(), 300);
+  BOOST_CHECK_EQUAL(window.getCount(), 3);
+  BOOST_CHECK_EQUAL(window.countUnmarked(100, 301), 198);
+  BOOST_CHECK_EQUAL(window.countMarked(0, 1000), 3);
+
+  std::vector<uint32_t> vMissing;
+  window.forEachUnmarked(60, 130, [&vMissing](uint32_t uiSN) { vMissing.push_back(uiSN); });
+  // SNs below the first marked one are part of the window
+  BOOST_CHECK_EQUAL(vMissing.size(), 68);
+  BOOST_CHECK_EQUAL(vMissing[0], 60);
+  BOOST_CHECK_EQUAL(vMissing[39], 99);
+  BOOST_CHECK_EQUAL(vMissing[40], 102);
+  BOOST_CHECK_EQUAL(vMissing[67], 129);
+
+  std::vector<uint32_t> vMarked;
+  window.forEachMarked(0, 1000, [&vMarked](uint32_t uiSN) { vMarked.push_back(uiSN); });
+  BOOST_CHECK_EQUAL(vMarked.size(), 3);
+  BOOST_CHECK_EQUAL(vMarked[0], 100);
+  BOOST_CHECK_EQUAL(vMarked[1], 101);
+  BOOST_CHECK_EQUAL(vMarked[2], 300);
+
+  BOOST_CHECK_EQUAL(window.unmark(101), true);
+  BOOST_CHECK_EQUAL(window.unmark(101), false);
+  BOOST_CHECK_EQUAL(window.isMarked(101), false);
+  BOOST_CHECK_EQUAL(window.getCount(), 2);
+
+  // sliding forgets old SNs and keeps the count consistent
+  BOOST_CHECK_EQUAL(window.mark(100 + uiWindowSize), true);
+  BOOST_CHECK_EQUAL(window.getLowest(), 101);
+  BOOST_CHECK_EQUAL(window.isMarked(100), false);
+  BOOST_CHECK_EQUAL(window.isMarked(300), true);
+  BOOST_CHECK_EQUAL(window.getCount(), 2);
+  // too old to be marked
+  BOOST_CHECK_EQUAL(window.mark(50), false);
+  BOOST_CHECK_EQUAL(window.getCount(), 2);
+  // jump larger than the window
+  BOOST_CHECK_EQUAL(window.mark(300 + 3 * uiWindowSize), true);
+  BOOST_CHECK_EQUAL(window.getCount(), 1);
+  BOOST_CHECK_EQUAL(window.countMarked(0, window.getHighest() + 1), 1);
+
+  // 16-bit sequence numbers are extended relative to the highest one
+  SequenceNumberWindow window2;
+  window2.mark(0x1FFFE);
+  BOOST_CHECK_EQUAL(window2.extend(0xFFFF), 0x1FFFF);
+  BOOST_CHECK_EQUAL(window2.extend(0x0001), 0x20001);
+  BOOST_CHECK_EQUAL(window2.extend(0xFFF0), 0x1FFF0);
+}
+
+BOOST_AUTO_TEST_CASE( tc_test_lossEstimationBoundedWindow)
+{
+  // run over several sequence number cycles dropping every 100th packet
+  LossEstimator estimator;
+  std::vector<uint16_t> vDropped;
+  uint32_t uiLostCount = 0;
+  uint16_t uiSN = 65000;
+  for (size_t i = 0; i < 300000; ++i, ++uiSN)
+  {
+    if (i % 100 == 50)
+      vDropped.push_back(uiSN);
+    else
+      estimator.addSequenceNumber(uiSN);
+
+    if (i % 1000 == 999)
+    {
+      std::vector<uint16_t> vLost = estimator.getEstimatedLostSequenceNumbers();
+      BOOST_CHECK(vLost == vDropped);
+      uiLostCount += vLost.size();
+      vDropped.clear();
+    }
+  }
+  BOOST_CHECK_EQUAL(uiLostCount, 3000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
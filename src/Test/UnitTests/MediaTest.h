@@ -1,13 +1,18 @@
 #pragma once
 #include <fstream>
 #include <boost/filesystem.hpp>
+#include <rtp++/media/AmrFileSource.h>
 #include <rtp++/media/AsyncStreamMediaSource.h>
 #include <rtp++/media/BufferedMediaReader.h>
 #include <rtp++/media/h264/H264AnnexBStreamParser.h>
+#include <rtp++/media/NalUnitMediaSource.h>
+#include <rtp++/media/StartCodeScanner.h>
 #include <rtp++/media/StreamMediaSource.h>
 #include <rtp++/media/VirtualVideoDeviceV2.h>
+#include <rtp++/media/YuvMediaSource.h>
 #include <rtp++/rfc6184/Rfc6184.h>
 #include <rtp++/application/ApplicationUtil.h>
+#include <rtp++/util/MappedFile.h>
 
 #define MEDIA_TEST_LOG_LEVEL 5
 #define MEDIA_TEST_LOG_LEVEL_VERBOSE 5
@@ -220,6 +225,220 @@ BOOST_AUTO_TEST_CASE( tc_test_H264AnnexBStreamParser_FFMPEF)
   test_H264AnnexBStreamParser("data/ffmpeg_rtp.264");
 }
 
+
+BOOST_AUTO_TEST_CASE( tc_test_StartCodeScanner)
+{
+  VLOG(MEDIA_TEST_LOG_LEVEL) << "test_StartCodeScanner: " << media::StartCodeScanner::getImplementation();
+  // mostly zeros and ones so that there are many partial matches
+  std::vector<uint8_t> vData(1000);
+  uint32_t uiSeed = 12345;
+  for (size_t i = 0; i < vData.size(); ++i)
+  {
+    uiSeed = uiSeed * 1103515245 + 12345;
+    uint32_t uiValue = (uiSeed >> 16) % 8;
+    vData[i] = static_cast<uint8_t>(uiValue < 5 ? 0 : (uiValue < 7 ? 1 : uiValue));
+  }
+
+  for (size_t uiSize = 0; uiSize < 100; ++uiSize)
+  {
+    for (size_t uiStart = 0; uiStart <= uiSize; ++uiStart)
+    {
+      size_t uiExpected = uiSize;
+      for (size_t i = uiStart; i + 3 <= uiSize; ++i)
+      {
+        if (vData[i] == 0 && vData[i + 1] == 0 && vData[i + 2] == 1)
+        {
+          uiExpected = i;
+          break;
+        }
+      }
+      BOOST_CHECK_EQUAL(media::StartCodeScanner::find(&vData[0], uiSize, uiStart), uiExpected);
+      BOOST_CHECK_EQUAL(media::StartCodeScanner::findScalar(&vData[0], uiSize, uiStart), uiExpected);
+    }
+  }
+
+  // start codes far apart and at every offset relative to the vector width
+  std::vector<uint8_t> vSparse(vData.size(), 0xFF);
+  for (size_t uiPos = 0; uiPos + 3 <= vSparse.size(); uiPos += 37)
+  {
+    vSparse[uiPos] = 0;
+    vSparse[uiPos + 1] = 0;
+    vSparse[uiPos + 2] = 1;
+  }
+  size_t uiCount = 0;
+  for (size_t i = media::StartCodeScanner::find(&vSparse[0], vSparse.size(), 0); i < vSparse.size();
+       i = media::StartCodeScanner::find(&vSparse[0], vSparse.size(), i + 3))
+  {
+    BOOST_CHECK_EQUAL(i % 37, 0);
+    ++uiCount;
+  }
+  BOOST_CHECK_EQUAL(uiCount, (vSparse.size() - 3) / 37 + 1);
+
+  // 3 and 4 byte start codes in the H.264 parser
+  const uint8_t stream[] = { 0, 0, 0, 1, 0x09, 0xF0,
+                             0, 0, 1, 0x67, 0x42, 0x00, 0x1E,
+                             0, 0, 0, 1, 0x68, 0xCE,
+                             0, 0, 1, 0x65, 0x88, 0x84, 0x00 };
+  media::h264::H264AnnexBStreamParser parser;
+  std::vector<MediaSample> vSamples = parser.extractAll(stream, sizeof(stream), 0.0);
+  BOOST_CHECK_EQUAL(vSamples.size(), 4);
+  if (vSamples.size() == 4)
+  {
+    BOOST_CHECK_EQUAL(vSamples[0].getPayloadSize(), 2);
+    BOOST_CHECK_EQUAL(vSamples[0].getStartCodeLengthHint(), 4);
+    BOOST_CHECK_EQUAL(vSamples[1].getPayloadSize(), 4);
+    BOOST_CHECK_EQUAL(vSamples[1].getStartCodeLengthHint(), 3);
+    BOOST_CHECK_EQUAL(vSamples[2].getPayloadSize(), 2);
+    BOOST_CHECK_EQUAL(vSamples[2].getStartCodeLengthHint(), 4);
+    BOOST_CHECK_EQUAL(vSamples[3].getPayloadSize(), 4);
+    BOOST_CHECK_EQUAL(vSamples[3].getDataBuffer().data()[0], 0x65);
+  }
+}
+
+static std::vector<std::vector<uint8_t> > readNalUnits(media::NalUnitMediaSource& source)
+{
+  std::vector<std::vector<uint8_t> > vNalUnits;
+  while (source.isGood())
+  {
+    std::vector<MediaSample> vAu = source.getNextAccessUnit();
+    BOOST_REQUIRE(!vAu.empty());
+    BOOST_CHECK(vAu[vAu.size() - 1].isMarkerSet());
+    for (const MediaSample& mediaSample: vAu)
+    {
+      const uint8_t* pData = mediaSample.getDataBuffer().data();
+      vNalUnits.push_back(std::vector<uint8_t>(pData, pData + mediaSample.getPayloadSize()));
+    }
+  }
+  return vNalUnits;
+}
+
+BOOST_AUTO_TEST_CASE( tc_test_MappedFileSources)
+{
+  bfs::path tempDir = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(tempDir);
+
+  // AUD, SPS, PPS, IDR, AUD, non-IDR slice
+  const uint8_t stream[] = { 0, 0, 0, 1, 0x09, 0xF0,
+                             0, 0, 1, 0x67, 0x42, 0x00, 0x1E,
+                             0, 0, 0, 1, 0x68, 0xCE,
+                             0, 0, 1, 0x65, 0x88, 0x84, 0x00, 0x21,
+                             0, 0, 0, 1, 0x09, 0xF0,
+                             0, 0, 1, 0x41, 0x9A, 0x02 };
+  const std::string sH264File = (tempDir / "test.264").string();
+  {
+    std::ofstream out(sH264File.c_str(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(stream), sizeof(stream));
+  }
+
+  std::vector<std::vector<uint8_t> > vScanned;
+  {
+    media::NalUnitMediaSource source(sH264File, rfc6184::H264, false, 0);
+    vScanned = readNalUnits(source);
+  }
+  BOOST_CHECK(bfs::exists(media::NalUnitMediaSource::getIndexFilename(sH264File)));
+  BOOST_REQUIRE_EQUAL(vScanned.size(), 6);
+  BOOST_CHECK_EQUAL(vScanned[1].size(), 4);
+  BOOST_CHECK_EQUAL(vScanned[1][0], 0x67);
+  BOOST_CHECK_EQUAL(vScanned[3].size(), 5);
+  BOOST_CHECK_EQUAL(vScanned[5].size(), 3);
+  BOOST_CHECK_EQUAL(vScanned[5][0], 0x41);
+
+  // the second source uses the index and must produce the same NAL units
+  media::NalUnitMediaSource indexedSource(sH264File, rfc6184::H264, false, 0);
+  BOOST_CHECK(readNalUnits(indexedSource) == vScanned);
+
+  // the stream constructor parses the data without an index
+  std::ifstream in(sH264File.c_str(), std::ios::binary);
+  media::NalUnitMediaSource streamSource(in, rfc6184::H264, false, 0);
+  BOOST_CHECK(readNalUnits(streamSource) == vScanned);
+
+  // a stale index is ignored and rewritten
+  {
+    std::ofstream out(sH264File.c_str(), std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char*>(stream) + 27, 12);
+  }
+  media::NalUnitMediaSource updatedSource(sH264File, rfc6184::H264, false, 0);
+  BOOST_CHECK_EQUAL(readNalUnits(updatedSource).size(), 8);
+
+  // so is the index of a file that is replaced by a file of the same size
+  {
+    const std::string sReplacement = (tempDir / "replacement.264").string();
+    {
+      const uint8_t slice[] = { 0, 0, 1, 0x41, 0x9A, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+      std::ofstream out(sReplacement.c_str(), std::ios::binary);
+      out.write(reinterpret_cast<const char*>(stream), sizeof(stream));
+      out.write(reinterpret_cast<const char*>(slice), sizeof(slice));
+    }
+    bfs::rename(sReplacement, sH264File);
+  }
+  media::NalUnitMediaSource replacedSource(sH264File, rfc6184::H264, false, 0);
+  BOOST_CHECK_EQUAL(readNalUnits(replacedSource).size(), 7);
+  // no temporary index files are left behind
+  uint32_t uiFiles = 0;
+  for (bfs::directory_iterator it(tempDir); it != bfs::directory_iterator(); ++it)
+    ++uiFiles;
+  BOOST_CHECK_EQUAL(uiFiles, 2);
+
+  // 2x2 YUV 4:2:0 frames of 6 bytes
+  const std::string sYuvFile = (tempDir / "test.yuv").string();
+  {
+    std::ofstream out(sYuvFile.c_str(), std::ios::binary);
+    for (char c = 0; c < 18; ++c)
+      out.put(c);
+  }
+  media::YuvMediaSource yuvSource(sYuvFile, 2, 2, true, 1);
+  for (uint32_t i = 0; i < 6; ++i)
+  {
+    BOOST_REQUIRE(yuvSource.isGood());
+    std::vector<MediaSample> vFrame = yuvSource.getNextAccessUnit();
+    BOOST_REQUIRE_EQUAL(vFrame.size(), 1);
+    BOOST_CHECK_EQUAL(vFrame[0].getPayloadSize(), 6);
+    BOOST_CHECK_EQUAL(vFrame[0].getDataBuffer().data()[0], (i % 3) * 6);
+  }
+  BOOST_CHECK(yuvSource.getNextAccessUnit().empty());
+  BOOST_CHECK(!yuvSource.isGood());
+
+  // the mapping is copy-on-write: samples can be modified in place without modifying the file
+  {
+    MappedFile::ptr pYuvFile = MappedFile::map(sYuvFile);
+    BOOST_REQUIRE(pYuvFile);
+    BOOST_CHECK(pYuvFile->isMapped());
+    Buffer frame = pYuvFile->getBuffer(6, 6);
+    const_cast<uint8_t*>(frame.data())[0] = 0xFF;
+    BOOST_CHECK_EQUAL(pYuvFile->data()[6], 0xFF);
+  }
+  {
+    std::ifstream yuvIn(sYuvFile.c_str(), std::ios::binary);
+    yuvIn.seekg(6);
+    BOOST_CHECK_EQUAL(yuvIn.get(), 6);
+  }
+
+  // AMR frames of mode 7 (31 bytes of speech data) and 0 (12 bytes) and a NO_DATA frame
+  const std::string sAmrFile = (tempDir / "test.amr").string();
+  {
+    std::ofstream out(sAmrFile.c_str(), std::ios::binary);
+    out << "#!AMR\n";
+    out.put(0x3C);
+    out << std::string(31, 'a');
+    out.put(0x04);
+    out << std::string(12, 'b');
+    out.put(0x7C);
+  }
+  media::AmrFileSource amrSource(sAmrFile, false, 0);
+  BOOST_CHECK(!amrSource.isWideband());
+  const uint32_t uiAmrFrameSizes[] = { 32, 13, 1 };
+  for (uint32_t uiFrameSize: uiAmrFrameSizes)
+  {
+    BOOST_REQUIRE(amrSource.isGood());
+    boost::optional<MediaSample> pFrame = amrSource.getNextMediaSample();
+    BOOST_REQUIRE(pFrame);
+    BOOST_CHECK_EQUAL(pFrame->getPayloadSize(), uiFrameSize);
+  }
+  BOOST_CHECK(!amrSource.isGood());
+
+  bfs::remove_all(tempDir);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }// test
@@ -0,0 +1,83 @@
+#pragma once
+#include <rtp++/rfc3550/MemberTable.h>
+
+namespace rtp_plus_plus
+{
+namespace test
+{
+
+BOOST_AUTO_TEST_SUITE(MemberTableTest)
+BOOST_AUTO_TEST_CASE(test_MemberTableInsertRemove)
+{
+  rfc3550::MemberTable table(4);
+  // sequential SSRCs collide more than random ones
+  const uint32_t uiMembers = 1000;
+  for (uint32_t uiSSRC = 0; uiSSRC < uiMembers; ++uiSSRC)
+  {
+    uint32_t uiIndex = table.insert(uiSSRC, std::unique_ptr<rfc3550::MemberEntry>(new rfc3550::MemberEntry(uiSSRC)));
+    BOOST_CHECK_EQUAL(table.getSSRC(uiIndex), uiSSRC);
+  }
+  BOOST_CHECK_EQUAL(table.size(), uiMembers);
+  BOOST_CHECK(table.find(uiMembers) == rfc3550::MemberTable::NPOS);
+
+  // remove every other member
+  for (uint32_t uiSSRC = 0; uiSSRC < uiMembers; uiSSRC += 2)
+  {
+    table.removeAt(table.find(uiSSRC));
+  }
+  BOOST_CHECK_EQUAL(table.size(), uiMembers / 2);
+  for (uint32_t uiSSRC = 0; uiSSRC < uiMembers; ++uiSSRC)
+  {
+    uint32_t uiIndex = table.find(uiSSRC);
+    if (uiSSRC % 2 == 0)
+    {
+      BOOST_CHECK(uiIndex == rfc3550::MemberTable::NPOS);
+    }
+    else
+    {
+      BOOST_REQUIRE(uiIndex != rfc3550::MemberTable::NPOS);
+      BOOST_CHECK_EQUAL(table.getEntry(uiIndex)->getSSRC(), uiSSRC);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_MemberTableCounts)
+{
+  rfc3550::MemberTable table;
+  for (uint32_t uiSSRC = 1; uiSSRC <= 10; ++uiSSRC)
+  {
+    table.insert(uiSSRC, std::unique_ptr<rfc3550::MemberEntry>(new rfc3550::MemberEntry(uiSSRC)));
+  }
+  BOOST_CHECK_EQUAL(table.getUnvalidatedCount(), 10);
+  BOOST_CHECK_EQUAL(table.getValidCount(), 0);
+  BOOST_CHECK_EQUAL(table.getSenderCount(), 0);
+
+  for (uint32_t uiSSRC = 1; uiSSRC <= 4; ++uiSSRC)
+  {
+    uint32_t uiIndex = table.find(uiSSRC);
+    table.getEntry(uiIndex)->setValidated();
+    table.getEntry(uiIndex)->setSender(true);
+    table.touch(uiIndex);
+  }
+  BOOST_CHECK_EQUAL(table.getUnvalidatedCount(), 6);
+  BOOST_CHECK_EQUAL(table.getValidCount(), 4);
+  BOOST_CHECK_EQUAL(table.getSenderCount(), 4);
+
+  uint32_t uiIndex = table.find(1);
+  table.getEntry(uiIndex)->onByeReceived();
+  table.touch(uiIndex);
+  BOOST_CHECK_EQUAL(table.getInactiveCount(), 1);
+  BOOST_CHECK_EQUAL(table.getValidCount(), 3);
+
+  // removing members updates the counts
+  table.removeAt(table.find(1));
+  table.removeAt(table.find(2));
+  BOOST_CHECK_EQUAL(table.getInactiveCount(), 0);
+  BOOST_CHECK_EQUAL(table.getSenderCount(), 2);
+  BOOST_CHECK_EQUAL(table.getValidCount(), 2);
+  BOOST_CHECK_EQUAL(table.size(), 8);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+} // test
+} // rtp_plus_plus
@@ -1,16 +1,66 @@
 #pragma once
+#include <set>
 #include <boost/test/unit_test.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
+#include <rtp++/RtpPacketiser.h>
 #include <rtp++/network/AddressDescriptor.h>
 #include <rtp++/network/AddressDescriptorParser.h>
+#include <rtp++/network/EndPoint.h>
 #include <rtp++/network/PortAllocationManager.h>
+#include <rtp++/network/ReusePortShardGroup.h>
+#include <rtp++/network/RtpNetworkInterface.h>
+#include <rtp++/network/UdpSocketWrapper.h>
 
 namespace rtp_plus_plus
 {
 namespace test
 {
 
+/**
+ * @brief The QueueingRtpNetworkInterface class accepts a limited number of RTP packets.
+ * A rejected packet first lets another sender queue a packet to emulate a concurrent send.
+ */
+class QueueingRtpNetworkInterface : public RtpNetworkInterface
+{
+public:
+  QueueingRtpNetworkInterface()
+    :RtpNetworkInterface(std::unique_ptr<RtpPacketiser>(new RtpPacketiser())),
+      m_uiAccept(0),
+      m_bConcurrentSend(false)
+  {
+  }
+  virtual void reset() {}
+  virtual void shutdown() {}
+  virtual bool recv() { return true; }
+  void complete(uint32_t uiPackets)
+  {
+    for (uint32_t i = 0; i < uiPackets; ++i)
+      onRtpSent(Buffer(), EndPoint());
+  }
+
+  uint32_t m_uiAccept;
+  bool m_bConcurrentSend;
+
+protected:
+  virtual bool doSendRtp(Buffer /*rtpBuffer*/, const EndPoint& rtpEp)
+  {
+    if (m_uiAccept > 0)
+    {
+      --m_uiAccept;
+      return true;
+    }
+    if (m_bConcurrentSend)
+    {
+      m_bConcurrentSend = false;
+      m_uiAccept = 1;
+      send(RtpPacket(rfc3550::RtpHeader(false, false, 96, 999, 0, 1)), rtpEp);
+    }
+    return false;
+  }
+  virtual bool doSendRtcp(Buffer /*rtcpBuffer*/, const EndPoint& /*rtcpEp*/) { return false; }
+};
+
 BOOST_AUTO_TEST_SUITE(NetworkTest)
 BOOST_AUTO_TEST_CASE(test_parseAddressDescriptors_single_line)
 {
@@ -204,6 +254,134 @@ BOOST_AUTO_TEST_CASE(test_portAllocationManager)
 
 }
 
+BOOST_AUTO_TEST_CASE(test_endPointResolution)
+{
+  EndPoint ep1("127.0.0.1", 5004);
+  BOOST_CHECK_EQUAL(ep1.isResolved(), true);
+  BOOST_CHECK_EQUAL(ep1.getUdpEndpoint().address().to_string(), "127.0.0.1");
+  BOOST_CHECK_EQUAL(ep1.getUdpEndpoint().port(), 5004);
+
+  // end points of received datagrams format the address on demand
+  boost::asio::ip::udp::endpoint sender(boost::asio::ip::address::from_string("127.0.0.1"), 5004);
+  EndPoint ep2(sender);
+  BOOST_CHECK_EQUAL(ep1 == ep2, true);
+  BOOST_CHECK_EQUAL(ep1.getHash(), ep2.getHash());
+  BOOST_CHECK_EQUAL(ep2.getAddress(), "127.0.0.1");
+
+  ep2.setPort(5005);
+  BOOST_CHECK_EQUAL(ep1 != ep2, true);
+  BOOST_CHECK_EQUAL(ep2.getUdpEndpoint().port(), 5005);
+
+  // host names are not resolved
+  EndPoint ep3("localhost", 5004);
+  BOOST_CHECK_EQUAL(ep3.isResolved(), false);
+  BOOST_CHECK_EQUAL(ep3 == EndPoint("localhost", 5004), true);
+  BOOST_CHECK_EQUAL(ep3.getAddress(), "localhost");
+
+  // packets are not sent to unresolved end points
+  boost::asio::io_service ioService;
+  boost::system::error_code ec;
+  UdpSocketWrapper::ptr pSocket = UdpSocketWrapper::create(ioService, "127.0.0.1", 0, ec);
+  BOOST_REQUIRE(!ec);
+  BOOST_CHECK_EQUAL(pSocket->send(Buffer(new uint8_t[4], 4), ep3), false);
+  BOOST_CHECK_EQUAL(pSocket->send(std::vector<Buffer>(1, Buffer(new uint8_t[4], 4)), ep3), false);
+  pSocket->close();
+}
+
+BOOST_AUTO_TEST_CASE(test_rtpSendQueueRollback)
+{
+  std::vector<uint16_t> vReported;
+  QueueingRtpNetworkInterface networkInterface;
+  networkInterface.setOutgoingRtpHandler([&vReported](const RtpPacket& rtpPacket, const EndPoint&)
+  {
+    vReported.push_back(rtpPacket.getSequenceNumber());
+  });
+
+  std::vector<RtpPacket> vPackets;
+  for (uint16_t i = 0; i < 3; ++i)
+    vPackets.push_back(RtpPacket(rfc3550::RtpHeader(false, false, 96, 100 + i, 0, 1)));
+  EndPoint ep("127.0.0.1", 5004);
+
+  // only the first packet of the batch is queued while another packet is sent concurrently
+  networkInterface.m_uiAccept = 1;
+  networkInterface.m_bConcurrentSend = true;
+  BOOST_CHECK_EQUAL(networkInterface.send(vPackets, ep), false);
+  // the single packet path behaves the same
+  BOOST_CHECK_EQUAL(networkInterface.send(vPackets[2], ep), false);
+  networkInterface.complete(2);
+  BOOST_REQUIRE_EQUAL(vReported.size(), 2);
+  BOOST_CHECK_EQUAL(vReported[0], 100);
+  BOOST_CHECK_EQUAL(vReported[1], 999);
+}
+
+#ifdef ENABLE_REUSEPORT
+/**
+* @brief Binds several SO_REUSEPORT shards to one port and checks that the flows are
+* distributed over the shards without splitting a flow.
+*
+* This method might fail if the used port is already bound!
+*/
+BOOST_AUTO_TEST_CASE(test_reusePortShardGroup)
+{
+  const uint32_t uiShards = 4;
+  const EndPoint ep("127.0.0.1", 5030);
+  boost::system::error_code ec;
+  ReusePortShardGroup group(ep, uiShards, ec);
+  BOOST_REQUIRE(!ec);
+  BOOST_CHECK_EQUAL(group.getShardCount(), uiShards);
+
+  // sockets without SO_REUSEPORT can not bind the port
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket socket(ioService);
+  socket.open(boost::asio::ip::udp::v4());
+  socket.bind(ep.getUdpEndpoint(), ec);
+  BOOST_CHECK_EQUAL(ec == boost::asio::error::address_in_use, true);
+  ec = boost::system::error_code();
+  // but sessions that set it can
+  std::unique_ptr<boost::asio::ip::udp::socket> pSocket = ReusePortShardGroup::createReusePortSocket(ioService, ep, ec);
+  BOOST_CHECK_EQUAL(ec == boost::system::error_code(), true);
+  BOOST_REQUIRE(pSocket);
+  pSocket->close();
+
+  // the SSRCs received by each shard are only accessed on the shard thread until it has been joined
+  std::vector<std::set<uint32_t> > vSsrcs(uiShards);
+  for (uint32_t i = 0; i < uiShards; ++i)
+  {
+    std::set<uint32_t>& ssrcs = vSsrcs[i];
+    group.getNetworkInterface(i).setIncomingRtpHandler([&ssrcs](const RtpPacket& rtpPacket, const EndPoint&)
+    {
+      ssrcs.insert(rtpPacket.getSSRC());
+    });
+  }
+  group.start();
+
+  // one sender socket and SSRC per flow
+  const uint32_t uiFlows = uiShards * 4;
+  for (uint32_t i = 0; i < uiFlows; ++i)
+  {
+    boost::asio::ip::udp::socket sender(ioService, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+    for (uint16_t j = 0; j < 5; ++j)
+    {
+      Buffer packet = RtpPacketiser::packetise(RtpPacket(rfc3550::RtpHeader(false, false, 96, j, 0, 1000 + i)));
+      sender.send_to(boost::asio::buffer(packet.data(), packet.getSize()), ep.getUdpEndpoint(), 0, ec);
+    }
+  }
+  boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+  group.stop();
+
+  std::set<uint32_t> received;
+  size_t uiReceived = 0;
+  for (uint32_t i = 0; i < uiShards; ++i)
+  {
+    uiReceived += vSsrcs[i].size();
+    received.insert(vSsrcs[i].begin(), vSsrcs[i].end());
+  }
+  // each flow is received by exactly one shard
+  BOOST_CHECK_EQUAL(received.size(), uiFlows);
+  BOOST_CHECK_EQUAL(uiReceived, uiFlows);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
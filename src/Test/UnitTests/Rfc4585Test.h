@@ -5,6 +5,7 @@
 #include <rtp++/rfc4566/SdpParser.h>
 #include <rtp++/rfc4585/FeedbackManager.h>
 #include <rtp++/rfc4585/Rfc4585.h>
+#include <rtp++/rfc4585/RtcpFb.h>
 
 #define RFC4585_TEST_LOG_LEVEL 10
 
@@ -63,6 +64,26 @@ BOOST_AUTO_TEST_CASE(test_FeedbackManager)
   feedbackManager.onRtxPacketArrival(tNow, uiLostExtendedSN);
 }
 
+BOOST_AUTO_TEST_CASE(test_GenericNackPacking)
+{
+  VLOG(RFC4585_TEST_LOG_LEVEL) << "test_GenericNackPacking";
+  // ascending extended SNs as returned by the feedback manager, crossing the 16-bit wrap
+  std::vector<uint32_t> vLost;
+  vLost.push_back(0xFFFE);
+  vLost.push_back(0xFFFF);
+  vLost.push_back(0x10000);
+  vLost.push_back(0x10005);
+  vLost.push_back(0x1000E);
+  vLost.push_back(0x1000F);
+  vLost.push_back(0x10030);
+  rfc4585::RtcpGenericNack::ptr pNack = rfc4585::RtcpGenericNack::create(vLost);
+  // PID 65534 covers up to 14, PID 15 and PID 48
+  BOOST_CHECK_EQUAL(pNack->calculateLength(), 3);
+  std::vector<uint16_t> vNacks = pNack->getNacks();
+  BOOST_CHECK_EQUAL(vNacks.size(), vLost.size());
+  BOOST_CHECK_EQUAL(vNacks[2], 0);
+}
+
 BOOST_AUTO_TEST_CASE(test_SdpParsing)
 {
   VLOG(RFC4585_TEST_LOG_LEVEL) << "test_SdpParsing";
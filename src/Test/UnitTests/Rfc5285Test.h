@@ -315,6 +315,177 @@ BOOST_AUTO_TEST_CASE(test_ParseRtcpRtpHeaderExtension)
   BOOST_CHECK_EQUAL( acks[2], uiSN + 2);
 }
 
+/**
+ * @brief test_LazyHeaderExtension tests that the elements of a received packet are looked up
+ * in the datagram and that the extension is copied once it is modified
+ */
+BOOST_AUTO_TEST_CASE(test_LazyHeaderExtension)
+{
+  using namespace mprtp;
+  VLOG(RFC5285_TEST_LOG_LEVEL) << "test_LazyHeaderExtension";
+  uint32_t uiTsId = 1;
+  uint32_t uiMpRtpId = 2;
+
+  RtpPacket rtpPacket(rfc3550::RtpHeader(false, false, 96, 100, 200, 300));
+  BOOST_CHECK_EQUAL( rfc6051::RtpSynchronisationExtensionHeader::append(rtpPacket.getHeaderExtension(), uiTsId, 0x01020304, 0x05060708), true);
+  MpRtpSubflowRtpHeader subflowHeader(5, 12345);
+  BOOST_CHECK_EQUAL( MpRtpHeaderExtension::appendMpRtpHeaderExtension(rtpPacket.getHeaderExtension(), uiMpRtpId, subflowHeader), true);
+  BOOST_CHECK_EQUAL( rtpPacket.getHeader().getHeaderExtensionCount(), 2);
+  // one byte header: 4 + (1 + 8) + (1 + 5) + 1 padding
+  BOOST_CHECK_EQUAL( rtpPacket.getHeaderExtension().getSize(), 20);
+
+  // the in place writers produce the same bytes as the element based ones
+  RtpHeaderExtension reference;
+  reference.addHeaderExtensions(rfc6051::RtpSynchronisationExtensionHeader::create(uiTsId, 0x01020304, 0x05060708));
+  reference.addHeaderExtensions(MpRtpHeaderExtension::generateMpRtpHeaderExtension(uiMpRtpId, subflowHeader));
+  uint8_t data[20];
+  uint8_t referenceData[20];
+  BOOST_CHECK_EQUAL( rtpPacket.getHeaderExtension().write(data), 20);
+  BOOST_CHECK_EQUAL( reference.write(referenceData), 20);
+  BOOST_CHECK_EQUAL( memcmp(data, referenceData, 20), 0);
+
+  Buffer packet = RtpPacketiser::packetise(rtpPacket);
+  RtpPacketiser rtpPacketiser;
+  boost::optional<RtpPacket> parsed = rtpPacketiser.depacketise(packet);
+  BOOST_CHECK_EQUAL( parsed.is_initialized(), true);
+  const RtpHeaderExtension& extension = parsed->getHeaderExtension();
+  BOOST_CHECK_EQUAL( extension.getHeaderExtensionCount(), 2);
+  BOOST_CHECK_EQUAL( extension.getSize(), 20);
+
+  // the elements reference the received packet
+  boost::optional<HeaderExtensionElementView> sync = extension.findHeaderExtension(uiTsId);
+  BOOST_CHECK_EQUAL( sync.is_initialized(), true);
+  BOOST_CHECK( sync->getExtensionData() > packet.data() && sync->getExtensionData() < packet.data() + packet.getSize());
+  boost::optional<uint64_t> uiTs = rfc6051::RtpSynchronisationExtensionHeader::parseRtpSynchronisationExtensionHeader(*sync);
+  BOOST_CHECK_EQUAL( *uiTs, 0x0102030405060708ULL);
+  boost::optional<HeaderExtensionElementView> mprtp = extension.findHeaderExtension(uiMpRtpId);
+  BOOST_CHECK_EQUAL( mprtp.is_initialized(), true);
+  boost::optional<MpRtpSubflowRtpHeader> subflowHeader2 = MpRtpHeaderExtension::parseMpRtpHeader(*mprtp).SubflowHeader;
+  BOOST_CHECK_EQUAL( subflowHeader2->getFlowId(), 5);
+  BOOST_CHECK_EQUAL( subflowHeader2->getFlowSpecificSequenceNumber(), 12345);
+  BOOST_CHECK_EQUAL( extension.findHeaderExtension(3).is_initialized(), false);
+
+  // an unmodified received extension is forwarded as is
+  Buffer forwarded = RtpPacketiser::packetise(*parsed);
+  BOOST_CHECK_EQUAL( forwarded.getSize(), packet.getSize());
+  BOOST_CHECK_EQUAL( memcmp(forwarded.data(), packet.data(), packet.getSize()), 0);
+
+  // modifying the extension copies the remaining elements out of the datagram
+  RtpPacket modified = *parsed;
+  BOOST_CHECK_EQUAL( modified.getHeaderExtension().removeHeaderExtension(uiTsId), 1);
+  BOOST_CHECK_EQUAL( modified.getHeader().getHeaderExtensionCount(), 1);
+  mprtp = modified.getHeaderExtension().findHeaderExtension(uiMpRtpId);
+  BOOST_CHECK_EQUAL( mprtp.is_initialized(), true);
+  BOOST_CHECK( mprtp->getExtensionData() < packet.data() || mprtp->getExtensionData() >= packet.data() + packet.getSize());
+  BOOST_CHECK_EQUAL( MpRtpHeaderExtension::parseMpRtpHeader(*mprtp).SubflowHeader->getFlowSpecificSequenceNumber(), 12345);
+  // 4 + (1 + 5) + 2 padding
+  BOOST_CHECK_EQUAL( modified.getHeaderExtension().getSize(), 12);
+  // the original packet is unchanged
+  BOOST_CHECK_EQUAL( parsed->getHeader().getHeaderExtensionCount(), 2);
+}
+
+/**
+ * @brief test_HeaderExtensionLocalStorage tests adding and removing elements of different sizes
+ */
+BOOST_AUTO_TEST_CASE(test_HeaderExtensionLocalStorage)
+{
+  VLOG(RFC5285_TEST_LOG_LEVEL) << "test_HeaderExtensionLocalStorage";
+  RtpHeaderExtension headerExtension;
+  uint8_t small[16];
+  memset(small, 0x11, sizeof(small));
+  uint8_t large[200];
+  memset(large, 0x22, sizeof(large));
+  headerExtension.addHeaderExtensions(HeaderExtensionElement(1, sizeof(small), small));
+  headerExtension.addHeaderExtensions(HeaderExtensionElement(2, sizeof(large), large));
+  headerExtension.addHeaderExtensions(HeaderExtensionElement(3, sizeof(small), small));
+  BOOST_CHECK_EQUAL( headerExtension.getHeaderExtensionCount(), 3);
+  // two byte header: 4 + (2 + 16) + (2 + 200) + (2 + 16) + 2 padding
+  BOOST_CHECK_EQUAL( headerExtension.getSize(), 244);
+
+  BOOST_CHECK_EQUAL( headerExtension.removeHeaderExtension(2), 1);
+  BOOST_CHECK_EQUAL( headerExtension.removeHeaderExtension(2), 0);
+  boost::optional<HeaderExtensionElementView> element = headerExtension.findHeaderExtension(3);
+  BOOST_CHECK_EQUAL( element.is_initialized(), true);
+  BOOST_CHECK_EQUAL( element->getDataLength(), sizeof(small));
+  BOOST_CHECK_EQUAL( memcmp(element->getExtensionData(), small, sizeof(small)), 0);
+  // back to the one byte header: 4 + (1 + 16) * 2 + 2 padding
+  BOOST_CHECK_EQUAL( headerExtension.getSize(), 40);
+
+  RtpHeaderExtension copy = headerExtension;
+  headerExtension.clear();
+  BOOST_CHECK_EQUAL( headerExtension.empty(), true);
+  BOOST_CHECK_EQUAL( headerExtension.getSize(), 0);
+  BOOST_CHECK_EQUAL( copy.getHeaderExtensionCount(), 2);
+  BOOST_CHECK_EQUAL( copy.getHeaderExtension(1).getId(), 3);
+
+  // more elements than are indexed inline
+  RtpHeaderExtension many;
+  for (uint32_t i = 1; i <= 12; ++i)
+  {
+    many.addHeaderExtensions(HeaderExtensionElement(i, 1, small));
+  }
+  BOOST_CHECK_EQUAL( many.removeHeaderExtension(2), 1);
+  BOOST_CHECK_EQUAL( many.getHeaderExtensionCount(), 11);
+  BOOST_CHECK_EQUAL( many.getHeaderExtension(7).getId(), 9);
+  BOOST_CHECK_EQUAL( many.getHeaderExtension(10).getId(), 12);
+  // one byte header: 4 + (1 + 1) * 11 + 2 padding
+  BOOST_CHECK_EQUAL( many.getSize(), 28);
+}
+
+/**
+ * @brief test_HeaderExtensionManyElements tests received extensions with many elements,
+ * with more than 64 KB of data and with an unsupported profile
+ */
+BOOST_AUTO_TEST_CASE(test_HeaderExtensionManyElements)
+{
+  VLOG(RFC5285_TEST_LOG_LEVEL) << "test_HeaderExtensionManyElements";
+  const uint32_t uiElements = 300;
+  RtpHeaderExtension headerExtension;
+  for (uint32_t i = 0; i < uiElements; ++i)
+  {
+    uint8_t* pData = headerExtension.appendHeaderExtension(1 + i % 255, 255);
+    BOOST_REQUIRE(pData != nullptr);
+    memset(pData, static_cast<uint8_t>(i), 255);
+  }
+  BOOST_CHECK_EQUAL( headerExtension.getHeaderExtensionCount(), uiElements);
+  // two byte header: 4 + (2 + 255) * 300
+  const uint32_t uiSize = headerExtension.getSize();
+  BOOST_CHECK_EQUAL( uiSize, 4 + 257 * uiElements);
+
+  uint8_t* pExtension = new uint8_t[uiSize];
+  BOOST_CHECK_EQUAL( headerExtension.write(pExtension), uiSize);
+  RtpHeaderExtension received;
+  received.setExtensionData(Buffer(pExtension, uiSize));
+  BOOST_CHECK_EQUAL( received.getHeaderExtensionCount(), uiElements);
+  for (uint32_t i = 0; i < uiElements; ++i)
+  {
+    HeaderExtensionElementView element = received.getHeaderExtension(i);
+    BOOST_CHECK_EQUAL( element.getId(), 1 + i % 255);
+    BOOST_CHECK_EQUAL( element.getDataLength(), 255);
+    BOOST_CHECK_EQUAL( element.getExtensionData()[254], static_cast<uint8_t>(i));
+  }
+
+  // an extension with an unsupported profile has no elements but is forwarded
+  uint8_t unknown[] = { 0x12, 0x34, 0x00, 0x02, 1, 2, 3, 4, 5, 6, 7, 8 };
+  uint8_t* pUnknown = new uint8_t[sizeof(unknown)];
+  memcpy(pUnknown, unknown, sizeof(unknown));
+  RtpPacket rtpPacket(rfc3550::RtpHeader(false, false, 96, 100, 200, 300));
+  rtpPacket.getHeaderExtension().setExtensionData(Buffer(pUnknown, sizeof(unknown)));
+  BOOST_CHECK_EQUAL( rtpPacket.getHeaderExtension().getHeaderExtensionCount(), 0);
+  BOOST_CHECK_EQUAL( rtpPacket.getHeaderExtension().getSize(), sizeof(unknown));
+  BOOST_CHECK( rtpPacket.getHeader().hasExtension());
+  Buffer packet = RtpPacketiser::packetise(rtpPacket);
+  BOOST_CHECK_EQUAL( packet.getSize(), 12 + sizeof(unknown));
+  RtpPacketiser rtpPacketiser;
+  boost::optional<RtpPacket> parsed = rtpPacketiser.depacketise(packet);
+  BOOST_REQUIRE( parsed.is_initialized());
+  BOOST_CHECK_EQUAL( parsed->getHeaderExtension().getProfileDefined(), 0x1234);
+  BOOST_CHECK_EQUAL( parsed->getHeaderExtension().getSize(), sizeof(unknown));
+  Buffer forwarded = RtpPacketiser::packetise(*parsed);
+  BOOST_CHECK_EQUAL( forwarded.getSize(), packet.getSize());
+  BOOST_CHECK_EQUAL( memcmp(forwarded.data(), packet.data(), packet.getSize()), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
@@ -1,6 +1,7 @@
 #pragma once
 #include <cpputil/FileUtil.h>
 #include <rtp++/RtpJitterBuffer.h>
+#include <rtp++/RtpPacketiser.h>
 #include <rtp++/RtpTime.h>
 #include <rtp++/media/BufferedMediaReader.h>
 #include <rtp++/media/h264/H264AnnexBStreamParser.h>
@@ -213,6 +214,142 @@ BOOST_AUTO_TEST_CASE(test_Rfc6184Packetisation)
   std::vector<RtpPacket> vPackets = pPacketiser->packetise(largeMediaSample);
   BOOST_CHECK_EQUAL( vPackets.size(), 4);
 }
+static MediaSample createNalUnit(uint8_t uiNalHeader, uint32_t uiSize)
+{
+  MediaSample mediaSample;
+  uint8_t* pData = new uint8_t[uiSize];
+  for (uint32_t i = 0; i < uiSize; ++i)
+    pData[i] = static_cast<uint8_t>(i);
+  pData[0] = uiNalHeader;
+  mediaSample.setData(Buffer(pData, uiSize));
+  return mediaSample;
+}
+
+BOOST_AUTO_TEST_CASE(test_Rfc6184ZeroCopy)
+{
+  VLOG(RFC6184_TEST_LOG_LEVEL) << "test_Rfc6184ZeroCopy";
+  // SPS and PPS are aggregated into an STAP-A, the IDR is fragmented and the slice is sent as is
+  std::vector<MediaSample> vSamples;
+  vSamples.push_back(createNalUnit(0x67, 20));
+  vSamples.push_back(createNalUnit(0x68, 6));
+  vSamples.push_back(createNalUnit(0x65, 5000));
+  vSamples.push_back(createNalUnit(0x41, 100));
+  vSamples[3].setMarker(true);
+
+  rfc6184::Rfc6184Packetiser packetiser;
+  packetiser.setPacketizationMode(rfc6184::Rfc6184Packetiser::NON_INTERLEAVED_MODE);
+  std::vector<RtpPacket> vCopied = packetiser.packetise(vSamples);
+  packetiser.setZeroCopy(true);
+  std::vector<RtpPacket> vReferenced = packetiser.packetise(vSamples);
+  BOOST_CHECK_EQUAL(vCopied.size(), 6);
+  BOOST_CHECK_EQUAL(vReferenced.size(), vCopied.size());
+
+  // the packets are identical on the wire
+  for (size_t i = 0; i < vCopied.size() && i < vReferenced.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vCopied[i].isPayloadGathered(), false);
+    BOOST_CHECK_EQUAL(vReferenced[i].getPayloadSize(), vCopied[i].getPayloadSize());
+    BOOST_CHECK_EQUAL(vReferenced[i].getHeader().isMarkerSet(), vCopied[i].getHeader().isMarkerSet());
+    Buffer copied = RtpPacketiser::packetise(vCopied[i]);
+    Buffer referenced = RtpPacketiser::packetise(vReferenced[i]);
+    BOOST_CHECK_EQUAL(referenced.getSize(), copied.getSize());
+    BOOST_CHECK_EQUAL(memcmp(referenced.data(), copied.data(), copied.getSize()), 0);
+    Buffer contiguous = vReferenced[i].getContiguousPayload();
+    BOOST_CHECK_EQUAL(contiguous.getSize(), vCopied[i].getPayload().getSize());
+    BOOST_CHECK_EQUAL(memcmp(contiguous.data(), vCopied[i].getPayload().data(), contiguous.getSize()), 0);
+  }
+
+  // STAP-A: indicator and first size inline, second NAL unit as segment
+  BOOST_CHECK_EQUAL(vCopied[0].getPayload().data()[0], 0x78);
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayloadHeaderSize(), 3);
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayload().data(), vSamples[0].getDataBuffer().data());
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayloadSegments().size(), 1);
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayloadSegments()[0].Data.data(), vSamples[1].getDataBuffer().data());
+  // FU-A: the fragments reference the IDR
+  BOOST_CHECK_EQUAL(vReferenced[1].getPayloadHeaderSize(), 2);
+  BOOST_CHECK_EQUAL(vReferenced[1].getPayloadHeader()[0], 0x7C);
+  BOOST_CHECK_EQUAL(vReferenced[1].getPayloadHeader()[1], 0x85);
+  BOOST_CHECK_EQUAL(vReferenced[1].getPayload().data(), vSamples[2].getDataBuffer().data() + 1);
+  BOOST_CHECK_EQUAL(vReferenced[4].getPayloadHeader()[1], 0x45);
+  // single NAL unit
+  BOOST_CHECK_EQUAL(vReferenced[5].getPayload().data(), vSamples[3].getDataBuffer().data());
+  BOOST_CHECK_EQUAL(vReferenced[5].getHeader().isMarkerSet(), true);
+}
+static std::vector<MediaSample> depacketiseFuTestPackets(rfc6184::Rfc6184Packetiser& packetiser, const std::vector<RtpPacket>& vPackets, uint32_t uiLostIndex)
+{
+  std::unique_ptr<RtpPacketGroup> pGroup;
+  for (size_t i = 0; i < vPackets.size(); ++i)
+  {
+    if (i == uiLostIndex) continue;
+    RtpPacket rtpPacket = vPackets[i];
+    rtpPacket.setExtendedSequenceNumber(1000 + i);
+    rtpPacket.getHeader().setRtpTimestamp(3000);
+    if (pGroup)
+      pGroup->insert(rtpPacket);
+    else
+      pGroup = std::unique_ptr<RtpPacketGroup>(new RtpPacketGroup(rtpPacket, boost::posix_time::ptime(), false, boost::posix_time::ptime()));
+  }
+  return packetiser.depacketize(*pGroup);
+}
+
+BOOST_AUTO_TEST_CASE(test_Rfc6184FuReassembly)
+{
+  VLOG(RFC6184_TEST_LOG_LEVEL) << "test_Rfc6184FuReassembly";
+  std::vector<MediaSample> vSamples;
+  vSamples.push_back(createNalUnit(0x65, 5000));
+  vSamples.push_back(createNalUnit(0x41, 100));
+
+  rfc6184::Rfc6184Packetiser packetiser;
+  packetiser.setPacketizationMode(rfc6184::Rfc6184Packetiser::NON_INTERLEAVED_MODE);
+  packetiser.setDisableStap(true);
+  std::vector<RtpPacket> vPackets = packetiser.packetise(vSamples);
+  BOOST_CHECK_EQUAL(vPackets.size(), 5);
+  const Buffer idr = vSamples[0].getDataBuffer();
+  const uint32_t uiSecondFragmentSize = vPackets[1].getPayload().getSize() - 2;
+  const uint32_t uiLastFragmentSize = vPackets[3].getPayload().getSize() - 2;
+  const uint32_t uiNone = vPackets.size();
+
+  // all fragments received
+  std::vector<MediaSample> vNalUnits = depacketiseFuTestPackets(packetiser, vPackets, uiNone);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 2);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getPayloadSize(), idr.getSize());
+  BOOST_CHECK_EQUAL(memcmp(vNalUnits[0].getDataBuffer().data(), idr.data(), idr.getSize()), 0);
+  BOOST_CHECK_EQUAL(vNalUnits[0].isComplete(), true);
+  BOOST_CHECK_EQUAL(vNalUnits[1].getPayloadSize(), 100);
+
+  // a lost fragment discards the NAL unit but not the ones that follow it
+  vNalUnits = depacketiseFuTestPackets(packetiser, vPackets, 1);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 1);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getDataBuffer().data()[0], 0x41);
+
+  // incomplete NAL units are delivered with the offsets of the missing data
+  packetiser.setDeliverIncompleteNalUnits(true);
+  vNalUnits = depacketiseFuTestPackets(packetiser, vPackets, 1);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 2);
+  BOOST_CHECK_EQUAL(vNalUnits[0].isComplete(), false);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getPayloadSize(), idr.getSize() - uiSecondFragmentSize);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getMissingDataOffsets().size(), 1);
+  const uint32_t uiMissingOffset = vNalUnits[0].getMissingDataOffsets()[0];
+  BOOST_CHECK_EQUAL(uiMissingOffset, vPackets[0].getPayload().getSize() - 1);
+  BOOST_CHECK_EQUAL(memcmp(vNalUnits[0].getDataBuffer().data(), idr.data(), uiMissingOffset), 0);
+  BOOST_CHECK_EQUAL(memcmp(vNalUnits[0].getDataBuffer().data() + uiMissingOffset, idr.data() + uiMissingOffset + uiSecondFragmentSize, idr.getSize() - uiMissingOffset - uiSecondFragmentSize), 0);
+  BOOST_CHECK_EQUAL(vNalUnits[1].isComplete(), true);
+
+  // lost end fragment
+  vNalUnits = depacketiseFuTestPackets(packetiser, vPackets, 3);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 2);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getPayloadSize(), idr.getSize() - uiLastFragmentSize);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getMissingDataOffsets().size(), 1);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getMissingDataOffsets()[0], vNalUnits[0].getPayloadSize());
+
+  // lost start fragment: the NAL unit header is restored from the FU indicator and header
+  vNalUnits = depacketiseFuTestPackets(packetiser, vPackets, 0);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 2);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getDataBuffer().data()[0], 0x65);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getMissingDataOffsets().size(), 1);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getMissingDataOffsets()[0], 1);
+}
+
 /**
   * The purpose of this unit test is to make sure that the packetisation
   * and depacketisation processes are correct. To do this, ffmpeg_rtp.264
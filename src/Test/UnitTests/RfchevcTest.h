@@ -0,0 +1,247 @@
+#pragma once
+#include <rtp++/RtpPacketGroup.h>
+#include <rtp++/RtpPacketiser.h>
+#include <rtp++/rfchevc/DonReorderQueue.h>
+#include <rtp++/rfchevc/RfchevcPacketiser.h>
+
+namespace rtp_plus_plus
+{
+namespace test
+{
+
+using media::MediaSample;
+
+static MediaSample createHevcNalUnit(uint8_t uiType, uint32_t uiSize, int16_t iDon = -1)
+{
+  MediaSample mediaSample;
+  uint8_t* pData = new uint8_t[uiSize];
+  for (uint32_t i = 0; i < uiSize; ++i)
+    pData[i] = static_cast<uint8_t>(i * 7);
+  // LayerId 0, TID 1
+  pData[0] = uiType << 1;
+  pData[1] = 0x01;
+  mediaSample.setData(Buffer(pData, uiSize));
+  mediaSample.setDecodingOrderNumber(iDon);
+  return mediaSample;
+}
+
+static std::vector<MediaSample> depacketiseHevcPackets(rfchevc::RfchevcPacketiser& packetiser, const std::vector<RtpPacket>& vPackets, uint32_t uiStartSN, int iLostIndex = -1)
+{
+  std::unique_ptr<RtpPacketGroup> pGroup;
+  for (size_t i = 0; i < vPackets.size(); ++i)
+  {
+    if (static_cast<int>(i) == iLostIndex) continue;
+    // received packets consist of one payload buffer
+    RtpPacket rtpPacket = vPackets[i];
+    rtpPacket.setPayload(vPackets[i].getContiguousPayload());
+    rtpPacket.setExtendedSequenceNumber(uiStartSN + i);
+    rtpPacket.getHeader().setRtpTimestamp(9000);
+    if (pGroup)
+      pGroup->insert(rtpPacket);
+    else
+      pGroup = std::unique_ptr<RtpPacketGroup>(new RtpPacketGroup(rtpPacket, boost::posix_time::ptime(), false, boost::posix_time::ptime()));
+  }
+  return packetiser.depacketize(*pGroup);
+}
+
+static void checkSameNalUnits(const std::vector<MediaSample>& vExpected, const std::vector<MediaSample>& vActual)
+{
+  BOOST_CHECK_EQUAL(vActual.size(), vExpected.size());
+  for (size_t i = 0; i < vActual.size() && i < vExpected.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vActual[i].getPayloadSize(), vExpected[i].getPayloadSize());
+    BOOST_CHECK_EQUAL(memcmp(vActual[i].getDataBuffer().data(), vExpected[i].getDataBuffer().data(), vExpected[i].getPayloadSize()), 0);
+    BOOST_CHECK_EQUAL(vActual[i].getDecodingOrderNumber(), vExpected[i].getDecodingOrderNumber());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(RfchevcTest)
+BOOST_AUTO_TEST_CASE(test_RfchevcPacketisation)
+{
+  // VPS, SPS and PPS are aggregated into an AP, the IDR is fragmented and the slice is sent as is
+  std::vector<MediaSample> vSamples;
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_VPS, 24));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_SPS, 40));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_PPS, 8));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_IDR_W_RADL, 10000));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_R, 100));
+  vSamples[4].setMarker(true);
+
+  rfchevc::RfchevcPacketiser packetiser;
+  std::vector<RtpPacket> vCopied = packetiser.packetise(vSamples);
+  packetiser.setZeroCopy(true);
+  std::vector<RtpPacket> vReferenced = packetiser.packetise(vSamples);
+  // AP + 7 FUs + single NAL unit
+  BOOST_CHECK_EQUAL(vCopied.size(), 9);
+  BOOST_CHECK_EQUAL(vReferenced.size(), vCopied.size());
+  for (size_t i = 0; i < vCopied.size() && i < vReferenced.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vCopied[i].isPayloadGathered(), false);
+    Buffer copied = RtpPacketiser::packetise(vCopied[i]);
+    Buffer referenced = RtpPacketiser::packetise(vReferenced[i]);
+    BOOST_CHECK_EQUAL(referenced.getSize(), copied.getSize());
+    BOOST_CHECK_EQUAL(memcmp(referenced.data(), copied.data(), copied.getSize()), 0);
+  }
+  // AP: payload header type 48, first NAL unit referenced after the payload header and size
+  BOOST_CHECK_EQUAL(vCopied[0].getPayload().data()[0], 48 << 1);
+  BOOST_CHECK_EQUAL(vCopied[0].getPayload().data()[1], 0x01);
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayloadHeaderSize(), 4);
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayload().data(), vSamples[0].getDataBuffer().data());
+  BOOST_CHECK_EQUAL(vReferenced[0].getPayloadSegments().size(), 2);
+  // FU: payload header type 49 and FU header with S and E bits
+  BOOST_CHECK_EQUAL(vCopied[1].getPayload().data()[0], 49 << 1);
+  BOOST_CHECK_EQUAL(vCopied[1].getPayload().data()[2], 0x80 | media::h265::NUT_IDR_W_RADL);
+  BOOST_CHECK_EQUAL(vCopied[7].getPayload().data()[2], 0x40 | media::h265::NUT_IDR_W_RADL);
+  BOOST_CHECK_EQUAL(vReferenced[1].getPayload().data(), vSamples[3].getDataBuffer().data() + 2);
+  BOOST_CHECK_EQUAL(vCopied[8].getHeader().isMarkerSet(), true);
+
+  std::vector<MediaSample> vNalUnits = depacketiseHevcPackets(packetiser, vCopied, 100);
+  checkSameNalUnits(vSamples, vNalUnits);
+
+  // a lost fragment only discards the fragmented NAL unit
+  vNalUnits = depacketiseHevcPackets(packetiser, vCopied, 100, 3);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), 4);
+  BOOST_CHECK_EQUAL(vNalUnits[3].getPayloadSize(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(test_RfchevcDonl)
+{
+  std::vector<MediaSample> vSamples;
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_VPS, 24, 65533));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_SPS, 40, 65534));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_PPS, 8, 65535));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_IDR_W_RADL, 5000, 0));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_R, 100, 1));
+
+  rfchevc::RfchevcPacketiser packetiser;
+  packetiser.setPacketizationMode(rfchevc::RfchevcPacketiser::INTERLEAVED_MODE);
+  packetiser.setMaxDonDiff(8);
+  std::vector<RtpPacket> vPackets = packetiser.packetise(vSamples);
+  // AP with DONL and DOND, 4 FUs, single NAL unit with DONL
+  BOOST_CHECK_EQUAL(vPackets.size(), 6);
+  const uint8_t* pAp = vPackets[0].getPayload().data();
+  BOOST_CHECK_EQUAL(pAp[2], 0xFF);
+  BOOST_CHECK_EQUAL(pAp[3], 0xFD);
+  BOOST_CHECK_EQUAL(pAp[4] << 8 | pAp[5], 24);
+  // DOND of the SPS
+  BOOST_CHECK_EQUAL(pAp[6 + 24], 0);
+  // DONL follows the FU header in the first fragment only
+  BOOST_CHECK_EQUAL(vPackets[1].getPayload().data()[3], 0);
+  BOOST_CHECK_EQUAL(vPackets[1].getPayload().data()[4], 0);
+  BOOST_CHECK_EQUAL(vPackets[5].getPayload().getSize(), 100 + 2);
+
+  std::vector<MediaSample> vNalUnits = depacketiseHevcPackets(packetiser, vPackets, 65530);
+  checkSameNalUnits(vSamples, vNalUnits);
+
+  // NAL units sent out of decoding order are reordered across packet groups
+  std::vector<MediaSample> vReversed;
+  vReversed.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_R, 30, 4));
+  vReversed.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_N, 20, 3));
+  vReversed.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_N, 10, 2));
+  std::vector<MediaSample> vOrdered;
+  for (size_t i = 0; i < vReversed.size(); ++i)
+  {
+    std::vector<RtpPacket> vSingle = packetiser.packetise(vReversed[i]);
+    BOOST_CHECK_EQUAL(vSingle.size(), 1);
+    std::vector<MediaSample> vReleased = depacketiseHevcPackets(packetiser, vSingle, 10 + i);
+    vOrdered.insert(vOrdered.end(), vReleased.begin(), vReleased.end());
+  }
+  BOOST_CHECK_EQUAL(vOrdered.size(), 3);
+  for (size_t i = 0; i < vOrdered.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vOrdered[i].getDecodingOrderNumber(), i + 2);
+  }
+  BOOST_CHECK_EQUAL(packetiser.flush().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_RfchevcDonlUnsetDon)
+{
+  // media sources don't set a DON: the packetiser numbers the NAL units in sending order
+  std::vector<MediaSample> vSamples;
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_VPS, 24));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_SPS, 40));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_PPS, 8));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_IDR_W_RADL, 5000));
+  vSamples.push_back(createHevcNalUnit(media::h265::NUT_TRAIL_R, 100));
+
+  rfchevc::RfchevcPacketiser packetiser;
+  packetiser.setPacketizationMode(rfchevc::RfchevcPacketiser::INTERLEAVED_MODE);
+  packetiser.setMaxDonDiff(8);
+  std::vector<RtpPacket> vPackets = packetiser.packetise(vSamples);
+  // VPS, SPS and PPS are still aggregated: AP, 4 FUs, single NAL unit
+  BOOST_CHECK_EQUAL(vPackets.size(), 6);
+  const uint8_t* pAp = vPackets[0].getPayload().data();
+  BOOST_CHECK_EQUAL(pAp[2] << 8 | pAp[3], 0);
+
+  std::vector<MediaSample> vNalUnits = depacketiseHevcPackets(packetiser, vPackets, 200);
+  BOOST_CHECK_EQUAL(vNalUnits.size(), vSamples.size());
+  for (size_t i = 0; i < vNalUnits.size() && i < vSamples.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vNalUnits[i].getPayloadSize(), vSamples[i].getPayloadSize());
+    BOOST_CHECK_EQUAL(memcmp(vNalUnits[i].getDataBuffer().data(), vSamples[i].getDataBuffer().data(), vSamples[i].getPayloadSize()), 0);
+    BOOST_CHECK_EQUAL(vNalUnits[i].getDecodingOrderNumber(), i);
+  }
+
+  // the numbering continues with the next call
+  std::vector<RtpPacket> vNext = packetiser.packetise(createHevcNalUnit(media::h265::NUT_TRAIL_R, 50));
+  BOOST_REQUIRE_EQUAL(vNext.size(), 1);
+  vNalUnits = depacketiseHevcPackets(packetiser, vNext, 206);
+  BOOST_REQUIRE_EQUAL(vNalUnits.size(), 1);
+  BOOST_CHECK_EQUAL(vNalUnits[0].getDecodingOrderNumber(), 5);
+  BOOST_CHECK_EQUAL(packetiser.flush().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_DonReorderQueue)
+{
+  rfchevc::DonReorderQueue queue(4);
+  std::vector<MediaSample> vOut;
+  MediaSample mediaSample;
+
+  // in order NAL units are released immediately, across the DON wrap around
+  mediaSample.setDecodingOrderNumber(static_cast<int16_t>(65535));
+  BOOST_CHECK_EQUAL(queue.push(mediaSample, vOut), true);
+  mediaSample.setDecodingOrderNumber(0);
+  BOOST_CHECK_EQUAL(queue.push(mediaSample, vOut), true);
+  BOOST_CHECK_EQUAL(vOut.size(), 2);
+
+  // 2 and 3 wait for 1
+  mediaSample.setDecodingOrderNumber(3);
+  queue.push(mediaSample, vOut);
+  mediaSample.setDecodingOrderNumber(2);
+  queue.push(mediaSample, vOut);
+  BOOST_CHECK_EQUAL(vOut.size(), 2);
+  BOOST_CHECK_EQUAL(queue.getSize(), 2);
+  mediaSample.setDecodingOrderNumber(1);
+  queue.push(mediaSample, vOut);
+  BOOST_CHECK_EQUAL(vOut.size(), 5);
+  BOOST_CHECK_EQUAL(vOut[2].getDecodingOrderNumber(), 1);
+  BOOST_CHECK_EQUAL(vOut[4].getDecodingOrderNumber(), 3);
+
+  // duplicates and late NAL units are discarded
+  mediaSample.setDecodingOrderNumber(3);
+  BOOST_CHECK_EQUAL(queue.push(mediaSample, vOut), false);
+
+  // 4 is lost: 5 is released once 9 shows that 4 cannot arrive any more
+  mediaSample.setDecodingOrderNumber(5);
+  queue.push(mediaSample, vOut);
+  mediaSample.setDecodingOrderNumber(7);
+  queue.push(mediaSample, vOut);
+  BOOST_CHECK_EQUAL(vOut.size(), 5);
+  mediaSample.setDecodingOrderNumber(9);
+  queue.push(mediaSample, vOut);
+  BOOST_CHECK_EQUAL(vOut.size(), 6);
+  BOOST_CHECK_EQUAL(vOut[5].getDecodingOrderNumber(), 5);
+  mediaSample.setDecodingOrderNumber(4);
+  BOOST_CHECK_EQUAL(queue.push(mediaSample, vOut), false);
+
+  queue.flush(vOut);
+  BOOST_CHECK_EQUAL(vOut.size(), 8);
+  BOOST_CHECK_EQUAL(vOut[6].getDecodingOrderNumber(), 7);
+  BOOST_CHECK_EQUAL(vOut[7].getDecodingOrderNumber(), 9);
+  BOOST_CHECK_EQUAL(queue.getSize(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // test
+} // rtp_plus_plus
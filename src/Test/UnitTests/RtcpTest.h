@@ -1,8 +1,13 @@
 #pragma once
 #include <cpputil/Buffer.h>
 #include <cpputil/FileUtil.h>
+#include <rtp++/RtcpCompoundView.h>
+#include <rtp++/RtcpCompoundWriter.h>
 #include <rtp++/RtpPacketiser.h>
+#include <rtp++/experimental/RtcpGenericAck.h>
 #include <rtp++/experimental/RtcpHeaderExtension.h>
+#include <rtp++/rfc3550/Rtcp.h>
+#include <rtp++/rfc4585/Rfc4585RtcpParser.h>
 #include <rtp++/rfc5506/Rfc5506RtcpValidator.h>
 
 namespace rtp_plus_plus
@@ -65,6 +70,179 @@ BOOST_AUTO_TEST_CASE(test_ParseRtcpRr)
   BOOST_CHECK_EQUAL( rtcp.size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(test_RtcpCompoundWriterAndView)
+{
+  std::vector<uint16_t> vNacks = { 100, 101, 105, 116, 117, 200 };
+  std::vector<uint16_t> vAcks = { 65530, 65533, 2, 5, 40 };
+  std::sort(vAcks.begin(), vAcks.end());
+
+  RtcpCompoundWriter writer;
+  BOOST_CHECK(writer.writeRr(0x11223344));
+  BOOST_CHECK(writer.addReportBlock(0x55667788, 12, -3, 70000, 42, 0xAABBCCDD, 65536));
+  BOOST_CHECK(writer.writeSdesCname(0x11223344, "user@host"));
+  BOOST_CHECK(writer.writeGenericNack(0x11223344, 0x55667788, vNacks));
+  BOOST_CHECK(writer.writeGenericAck(0x11223344, 0x55667788, vAcks));
+  // report blocks can only be added directly after an SR or RR
+  BOOST_CHECK(!writer.addReportBlock(0x55667788, 0, 0, 0, 0, 0, 0));
+  BOOST_CHECK_EQUAL(writer.getPacketCount(), 4);
+  Buffer buffer = writer.getBuffer();
+  BOOST_CHECK_EQUAL(buffer.getSize(), writer.getSize());
+
+  RtcpCompoundView view;
+  BOOST_CHECK(view.parse(buffer.data(), buffer.getSize()));
+  BOOST_CHECK_EQUAL(view.size(), 4);
+  BOOST_CHECK_EQUAL(view[0].getPacketType(), rfc3550::PT_RTCP_RR);
+  RtcpRrView rr(view[0]);
+  BOOST_CHECK_EQUAL(rr.getReporterSSRC(), 0x11223344);
+  BOOST_CHECK_EQUAL(rr.getReportCount(), 1);
+  RtcpReportBlockView block = rr.getReportBlock(0);
+  BOOST_CHECK_EQUAL(block.getReporteeSSRC(), 0x55667788);
+  BOOST_CHECK_EQUAL(block.getFractionLost(), 12);
+  BOOST_CHECK_EQUAL(block.getCumulativeNumberOfPacketsLost(), -3);
+  BOOST_CHECK_EQUAL(block.getExtendedHighestSNReceived(), 70000);
+  BOOST_CHECK_EQUAL(block.getInterarrivalJitter(), 42);
+  BOOST_CHECK_EQUAL(block.getLastSr(), 0xAABBCCDD);
+  BOOST_CHECK_EQUAL(block.getDelaySinceLastSr(), 65536);
+
+  uint32_t uiFb = view.find(rfc4585::PT_RTCP_GENERIC_FEEDBACK);
+  BOOST_CHECK_EQUAL(uiFb, 2);
+  RtcpFbView nack(view[uiFb]);
+  BOOST_CHECK_EQUAL(nack.getFormat(), rfc4585::TL_FB_GENERIC_NACK);
+  BOOST_CHECK_EQUAL(nack.getSourceSSRC(), 0x55667788);
+  std::vector<uint16_t> vSNs;
+  nack.readNacks(vSNs);
+  BOOST_CHECK(vSNs == vNacks);
+
+  RtcpFbView ack(view[view.find(rfc4585::PT_RTCP_GENERIC_FEEDBACK, uiFb + 1)]);
+  BOOST_CHECK_EQUAL(ack.getFormat(), rfc4585::TL_FB_GENERIC_ACK);
+  vSNs.clear();
+  ack.readAcks(vSNs);
+  std::sort(vSNs.begin(), vSNs.end());
+  BOOST_CHECK(vSNs == vAcks);
+
+  // the registered parsers create the same packets from the buffer
+  RtpPacketiser rtpPacketiser;
+  rtpPacketiser.setValidateRtcp(true);
+  rtpPacketiser.registerRtcpParser(std::unique_ptr<RtcpParserInterface>(new rfc4585::RtcpParser()));
+  CompoundRtcpPacket rtcp = rtpPacketiser.depacketiseRtcp(buffer);
+  BOOST_CHECK_EQUAL(rtcp.size(), 4);
+  BOOST_CHECK_EQUAL(compoundRtcpPacketSize(rtcp), buffer.getSize());
+  rfc3550::RtcpSdes* pSdes = static_cast<rfc3550::RtcpSdes*>(rtcp[1].get());
+  BOOST_CHECK_EQUAL(pSdes->getSdesReports().at(0).getCName(), "user@host");
+  rfc4585::RtcpGenericNack* pNack = static_cast<rfc4585::RtcpGenericNack*>(rtcp[2].get());
+  BOOST_CHECK(pNack->getNacks() == vNacks);
+  rfc4585::RtcpGenericAck* pAck = static_cast<rfc4585::RtcpGenericAck*>(rtcp[3].get());
+  std::vector<uint16_t> vParsedAcks = pAck->getAcks();
+  std::sort(vParsedAcks.begin(), vParsedAcks.end());
+  BOOST_CHECK(vParsedAcks == vAcks);
+
+  // truncated and corrupted packets are rejected before any packet is created but the
+  // valid packets preceding them are kept
+  BOOST_CHECK(!view.parse(buffer.data(), buffer.getSize() - 4));
+  BOOST_CHECK_EQUAL(view.size(), 3);
+  rtpPacketiser.setValidateRtcp(false);
+  uint8_t* pTruncated = new uint8_t[buffer.getSize() - 4];
+  memcpy(pTruncated, buffer.data(), buffer.getSize() - 4);
+  Buffer truncated(pTruncated, buffer.getSize() - 4);
+  BOOST_CHECK_EQUAL(rtpPacketiser.depacketiseRtcp(truncated).size(), 3);
+  Buffer corrupt = RtpPacketiser::packetise(rtcp);
+  corrupt[0] = 0x41;
+  BOOST_CHECK(!view.parse(corrupt.data(), corrupt.getSize()));
+  BOOST_CHECK(view.empty());
+  BOOST_CHECK(rtpPacketiser.depacketiseRtcp(corrupt).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_RtcpCompoundViewManyPackets)
+{
+  // more packets than can be indexed without allocating
+  const uint32_t uiPackets = RtcpCompoundView::INLINE_PACKETS + 8;
+  RtcpCompoundWriter writer;
+  BOOST_CHECK(writer.writeRr(0x11223344));
+  for (uint32_t i = 1; i < uiPackets; ++i)
+  {
+    BOOST_CHECK(writer.writeGenericNack(0x11223344, i, std::vector<uint16_t>(1, static_cast<uint16_t>(i))));
+  }
+  BOOST_CHECK_EQUAL(writer.getPacketCount(), uiPackets);
+  Buffer buffer = writer.getBuffer();
+
+  RtcpCompoundView view;
+  BOOST_CHECK(view.parse(buffer.data(), buffer.getSize()));
+  BOOST_CHECK_EQUAL(view.size(), uiPackets);
+  for (uint32_t i = 1; i < uiPackets; ++i)
+  {
+    BOOST_CHECK_EQUAL(view.find(rfc4585::PT_RTCP_GENERIC_FEEDBACK, i), i);
+    RtcpFbView nack(view[i]);
+    BOOST_CHECK_EQUAL(nack.getSourceSSRC(), i);
+  }
+  BOOST_CHECK_EQUAL(view.getOffset(uiPackets - 1) + view[uiPackets - 1].getSize(), buffer.getSize());
+
+  RtpPacketiser rtpPacketiser;
+  rtpPacketiser.setValidateRtcp(false);
+  rtpPacketiser.registerRtcpParser(std::unique_ptr<RtcpParserInterface>(new rfc4585::RtcpParser()));
+  CompoundRtcpPacket rtcp = rtpPacketiser.depacketiseRtcp(buffer);
+  BOOST_CHECK_EQUAL(rtcp.size(), uiPackets);
+  BOOST_CHECK_EQUAL(compoundRtcpPacketSize(rtcp), buffer.getSize());
+}
+
+BOOST_AUTO_TEST_CASE(test_RtcpFeedbackInPlace)
+{
+  std::vector<uint16_t> vNacks = { 100, 101, 105, 116, 117, 200 };
+  std::vector<uint16_t> vAcks = { 65533, 65535, 0, 3 };
+  RtcpCompoundWriter writer;
+  BOOST_CHECK(writer.writeRr(0x11223344));
+  BOOST_CHECK(writer.writeGenericNack(0x11223344, 0x55667788, vNacks));
+  // the ACKs may wrap around
+  BOOST_CHECK(writer.writeGenericAck(0x11223344, 0x55667788, vAcks));
+  Buffer buffer = writer.getBuffer();
+
+  RtpPacketiser rtpPacketiser;
+  rtpPacketiser.setValidateRtcp(true);
+  rtpPacketiser.registerRtcpParser(std::unique_ptr<RtcpParserInterface>(new rfc4585::RtcpParser()));
+  std::vector<uint16_t> vReadNacks;
+  std::vector<uint16_t> vReadAcks;
+  auto onFb = [&vReadNacks, &vReadAcks](const RtcpFbView& fb)
+  {
+    BOOST_CHECK_EQUAL(fb.getSourceSSRC(), 0x55667788);
+    if (fb.getFormat() == rfc4585::TL_FB_GENERIC_NACK)
+      fb.readNacks(vReadNacks);
+    else if (fb.getFormat() == rfc4585::TL_FB_GENERIC_ACK)
+      fb.readAcks(vReadAcks);
+  };
+  // only the RR is created
+  CompoundRtcpPacket rtcp = rtpPacketiser.depacketiseRtcp(NetworkPacket(buffer, 12345), onFb);
+  BOOST_CHECK_EQUAL(rtcp.size(), 1);
+  BOOST_CHECK_EQUAL(rtcp[0]->getPacketType(), rfc3550::PT_RTCP_RR);
+  BOOST_CHECK_EQUAL(rtcp[0]->getArrivalTimeNtp(), 12345);
+  BOOST_CHECK(vReadNacks == vNacks);
+  std::sort(vReadAcks.begin(), vReadAcks.end());
+  std::vector<uint16_t> vSortedAcks = vAcks;
+  std::sort(vSortedAcks.begin(), vSortedAcks.end());
+  BOOST_CHECK(vReadAcks == vSortedAcks);
+
+  // feedback written separately is appended to the packetised objects
+  RtcpCompoundWriter feedbackWriter;
+  BOOST_CHECK(feedbackWriter.writeGenericNack(0x11223344, 0x55667788, vNacks));
+  Buffer packetised = RtpPacketiser::packetise(rtcp, feedbackWriter.getBuffer());
+  BOOST_CHECK_EQUAL(packetised.getSize(), compoundRtcpPacketSize(rtcp) + feedbackWriter.getSize());
+  RtcpCompoundView view;
+  BOOST_CHECK(view.parse(packetised.data(), packetised.getSize()));
+  BOOST_CHECK_EQUAL(view.size(), 2);
+  vReadNacks.clear();
+  RtcpFbView(view[1]).readNacks(vReadNacks);
+  BOOST_CHECK(vReadNacks == vNacks);
+
+  // a compound packet has to start with an SR or RR
+  vReadNacks.clear();
+  BOOST_CHECK(rtpPacketiser.depacketiseRtcp(NetworkPacket(feedbackWriter.getBuffer(), 0), onFb).empty());
+  BOOST_CHECK(vReadNacks.empty());
+  // unless reduced-size RTCP is used
+  RtpPacketiser reducedSizePacketiser(std::unique_ptr<rfc3550::RtcpValidator>(new rfc5506::RtcpValidator()));
+  reducedSizePacketiser.setValidateRtcp(true);
+  reducedSizePacketiser.registerRtcpParser(std::unique_ptr<RtcpParserInterface>(new rfc4585::RtcpParser()));
+  BOOST_CHECK(reducedSizePacketiser.depacketiseRtcp(NetworkPacket(feedbackWriter.getBuffer(), 0), onFb).empty());
+  BOOST_CHECK(vReadNacks == vNacks);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
@@ -1,6 +1,7 @@
 #pragma once
 #include <tuple> 
 #include <rtp++/RtpJitterBufferV2.h>
+#include <rtp++/RtpRingJitterBuffer.h>
 
 /**
   * This class gives us access to the playout buffer internals
@@ -16,9 +17,10 @@ class RtpJitterBufferV2Test
 public:
   static void test()
   {
-    test_insertion();
+    test_insertion<RtpJitterBufferV2>();
   }
 
+  template <typename JitterBuffer>
   static void test_insertion()
   {
     // create test data
@@ -76,7 +78,7 @@ public:
       rtpPackets.push_back(packet);
     }
 
-    RtpJitterBufferV2 buffer(1000);
+    JitterBuffer buffer(1000);
 
     for (size_t i = 0; i < packet_info.size(); ++i)
     {
@@ -112,6 +114,60 @@ public:
       }
     }
   }
+
+  static void test_ring_wrap_around()
+  {
+    boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+    // 4 slots
+    RtpRingJitterBuffer buffer(1000, 3);
+    BOOST_CHECK_EQUAL( buffer.getCapacity(), 4 );
+
+    // TS SN res
+    typedef std::tuple<uint32_t, uint32_t, bool> PacketInfo_t;
+    std::vector<PacketInfo_t> packet_info;
+    // frame spanning the extended SN wrap-around received out of order
+    packet_info.push_back( std::make_tuple(0,    0,          true ) );
+    packet_info.push_back( std::make_tuple(0,    UINT_MAX,   false ) );
+    packet_info.push_back( std::make_tuple(0,    UINT_MAX-1, false ) );
+    // new frame
+    packet_info.push_back( std::make_tuple(3600, 1,          true ) );
+    // ring is full: slot of SN 2 is occupied by SN UINT_MAX-1
+    packet_info.push_back( std::make_tuple(3600, 2,          false ) );
+
+    for (size_t i = 0; i < packet_info.size(); ++i)
+    {
+      RtpPacket packet;
+      packet.setArrivalTime(tNow);
+      packet.getHeader().setRtpTimestamp(std::get<0>(packet_info[i]));
+      packet.setExtendedSequenceNumber(std::get<1>(packet_info[i]));
+      boost::posix_time::ptime tPlayout;
+      uint32_t uiLate = 0;
+      bool bDup = false;
+      bool bRes = buffer.addRtpPacket(packet, tNow + boost::posix_time::milliseconds(40 * std::get<0>(packet_info[i])/3600),
+                                      false, tPlayout, uiLate, bDup);
+      BOOST_CHECK_EQUAL( bRes, std::get<2>(packet_info[i]) );
+      BOOST_CHECK_EQUAL( uiLate, 0 );
+      BOOST_CHECK_EQUAL( bDup, false );
+    }
+
+    // packets are played out in SN order across the wrap-around
+    const RtpPacketGroup group = buffer.getNextPlayoutBufferNode();
+    BOOST_CHECK_EQUAL( group.getSize(), 3 );
+    BOOST_CHECK_EQUAL( group.getRtpPackets().front().getExtendedSequenceNumber(), UINT_MAX-1 );
+    BOOST_CHECK_EQUAL( group.getRtpPackets().back().getExtendedSequenceNumber(), 0 );
+
+    // slots of the played frame can be reused
+    RtpPacket packet;
+    packet.setArrivalTime(tNow);
+    packet.getHeader().setRtpTimestamp(3600);
+    packet.setExtendedSequenceNumber(2);
+    boost::posix_time::ptime tPlayout;
+    uint32_t uiLate = 0;
+    bool bDup = false;
+    BOOST_CHECK_EQUAL( buffer.addRtpPacket(packet, tNow + boost::posix_time::milliseconds(40), false, tPlayout, uiLate, bDup), false );
+    const RtpPacketGroup group2 = buffer.getNextPlayoutBufferNode();
+    BOOST_CHECK_EQUAL( group2.getSize(), 2 );
+  }
 };
 
 }
@@ -0,0 +1,154 @@
+#pragma once
+#include <cpputil/Buffer.h>
+#include <cpputil/OBitStream.h>
+#include <rtp++/RtpPacketiser.h>
+#include <rtp++/rfc3550/RtpHeaderCodec.h>
+
+namespace rtp_plus_plus
+{
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(RtpPacketiserTest)
+BOOST_AUTO_TEST_CASE(test_RtpHeaderCodec)
+{
+  rfc3550::RtpHeader header(false, true, 96, 0xBEEF, 0x12345678, 0xCAFEBABE);
+  header.addContributingSource(0x01020304);
+  header.addContributingSource(0x05060708);
+
+  // the bitstream serialisation is the reference implementation
+  OBitStream ob;
+  ob << header;
+  Buffer reference = ob.str();
+
+  uint8_t data[64];
+  uint32_t uiSize = rfc3550::RtpHeaderCodec::write(header, data);
+  BOOST_CHECK_EQUAL(uiSize, header.getSize());
+  BOOST_CHECK_EQUAL(uiSize, reference.getSize());
+  BOOST_CHECK_EQUAL(memcmp(data, reference.data(), uiSize), 0);
+
+  rfc3550::RtpHeaderFields fields;
+  BOOST_CHECK_EQUAL(rfc3550::RtpHeaderCodec::parse(data, uiSize, fields), true);
+  BOOST_CHECK_EQUAL(fields.Marker, true);
+  BOOST_CHECK_EQUAL(fields.PayloadType, 96);
+  BOOST_CHECK_EQUAL(fields.SequenceNumber, 0xBEEF);
+  BOOST_CHECK_EQUAL(fields.RtpTimestamp, 0x12345678);
+  BOOST_CHECK_EQUAL(fields.SSRC, 0xCAFEBABE);
+  BOOST_CHECK_EQUAL(fields.CsrcCount, 2);
+  BOOST_CHECK_EQUAL(fields.HeaderSize, uiSize);
+  BOOST_CHECK_EQUAL(rfc3550::RtpHeaderCodec::readCsrc(data, 1), 0x05060708);
+
+  // truncated CSRC list
+  BOOST_CHECK_EQUAL(rfc3550::RtpHeaderCodec::parse(data, uiSize - 1, fields), false);
+  // padding count larger than the payload
+  data[0] |= 0x20;
+  data[uiSize - 1] = 9;
+  BOOST_CHECK_EQUAL(rfc3550::RtpHeaderCodec::parse(data, uiSize, fields), false);
+  // wrong version
+  data[0] = 0x40;
+  BOOST_CHECK_EQUAL(rfc3550::RtpHeaderCodec::parse(data, uiSize, fields), false);
+}
+
+BOOST_AUTO_TEST_CASE(test_RtpPacketRoundTrip)
+{
+  rfc3550::RtpHeader header(false, false, 97, 1000, 90000, 0x11223344);
+  header.addContributingSource(0x55667788);
+  RtpPacket rtpPacket(header);
+  uint8_t payload[] = { 1, 2, 3, 4, 5 };
+  Buffer payloadBuffer(new uint8_t[sizeof(payload)], sizeof(payload));
+  memcpy(&payloadBuffer[0], payload, sizeof(payload));
+  rtpPacket.setPayload(payloadBuffer);
+
+  Buffer packet = RtpPacketiser::packetise(rtpPacket);
+  BOOST_CHECK_EQUAL(packet.getSize(), rtpPacket.getSize());
+
+  RtpPacketiser rtpPacketiser;
+  boost::optional<RtpPacket> parsed = rtpPacketiser.depacketise(packet);
+  BOOST_CHECK_EQUAL(parsed.is_initialized(), true);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getPayloadType(), 97);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getSequenceNumber(), 1000);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getRtpTimestamp(), 90000);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getSSRC(), 0x11223344);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getCSRCs().size(), 1);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getCSRCs()[0], 0x55667788);
+  BOOST_CHECK_EQUAL(parsed->getPayload().getSize(), sizeof(payload));
+  BOOST_CHECK_EQUAL(memcmp(parsed->getPayload().data(), payload, sizeof(payload)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_RtpPacketInlineCsrcs)
+{
+  rfc3550::RtpHeader header(false, true, 96, 2000, 180000, 0xAABBCCDD);
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    header.addContributingSource(0x1000 + i);
+  }
+  // the 16th CSRC is ignored
+  BOOST_CHECK_EQUAL(header.getCC(), 15);
+  BOOST_CHECK_EQUAL(header.getSize(), 12 + 15 * 4);
+
+  RtpPacket rtpPacket(header);
+  Buffer payloadBuffer(new uint8_t[100], 100);
+  memset(&payloadBuffer[0], 0x42, 100);
+  rtpPacket.setPayload(payloadBuffer);
+  rtpPacket.setArrivalTimeNs(1234567890123LL);
+  rtpPacket.setSendTimeNs(1234567000000LL);
+
+  Buffer packet = RtpPacketiser::packetise(rtpPacket);
+  RtpPacketiser rtpPacketiser;
+  boost::optional<RtpPacket> parsed = rtpPacketiser.depacketise(packet);
+  BOOST_CHECK_EQUAL(parsed.is_initialized(), true);
+  BOOST_CHECK_EQUAL(parsed->getHeader().getCC(), 15);
+  std::vector<uint32_t> vCSRCs = parsed->getHeader().getCSRCs();
+  BOOST_CHECK_EQUAL(vCSRCs.size(), 15);
+  for (uint32_t i = 0; i < 15; ++i)
+  {
+    BOOST_CHECK_EQUAL(parsed->getHeader().getCSRC(i), 0x1000 + i);
+    BOOST_CHECK_EQUAL(vCSRCs[i], 0x1000 + i);
+  }
+
+  // copies and moves carry the header, the payload and the times
+  RtpPacket copy(rtpPacket);
+  std::vector<RtpPacket> vRtpPackets;
+  vRtpPackets.push_back(std::move(copy));
+  const RtpPacket& moved = vRtpPackets[0];
+  BOOST_CHECK_EQUAL(moved.getHeader().getCC(), 15);
+  BOOST_CHECK_EQUAL(moved.getHeader().getCSRC(14), 0x100E);
+  BOOST_CHECK_EQUAL(moved.getHeader().getSequenceNumber(), 2000);
+  BOOST_CHECK_EQUAL(moved.getPayload().getSize(), 100);
+  BOOST_CHECK_EQUAL(moved.getPayload().data(), rtpPacket.getPayload().data());
+  BOOST_CHECK_EQUAL(moved.getArrivalTimeNs(), 1234567890123LL);
+  BOOST_CHECK_EQUAL(moved.getSendTimeNs(), 1234567000000LL);
+  BOOST_CHECK_EQUAL(moved.getSize(), rtpPacket.getSize());
+
+  // headers with few CSRCs and without extension don't allocate
+  BOOST_CHECK_LE(sizeof(rfc3550::RtpHeader), 64u);
+  rfc3550::RtpHeader small(false, false, 96, 1, 2, 3);
+  small.addContributingSource(0x2000);
+  small.addContributingSource(0x2001);
+  BOOST_CHECK(!small.hasExtension());
+  BOOST_CHECK_EQUAL(small.getHeaderExtension().getSize(), 0);
+  BOOST_CHECK_EQUAL(small.getSize(), 12 + 2 * 4);
+
+  // the extension is copied with the header and taken over on moves
+  rfc3550::RtpHeader extended(small);
+  uint8_t* pData = extended.getHeaderExtension().appendHeaderExtension(1, 2);
+  BOOST_REQUIRE(pData != nullptr);
+  pData[0] = 0x12;
+  pData[1] = 0x34;
+  BOOST_CHECK(extended.hasExtension());
+  BOOST_CHECK(!small.hasExtension());
+  rfc3550::RtpHeader extendedCopy(extended);
+  extendedCopy.getHeaderExtension().removeHeaderExtension(1);
+  BOOST_CHECK(!extendedCopy.hasExtension());
+  BOOST_CHECK_EQUAL(extended.getHeaderExtensionCount(), 1);
+  rfc3550::RtpHeader extendedMove(std::move(extended));
+  BOOST_CHECK_EQUAL(extendedMove.getHeaderExtensionCount(), 1);
+  BOOST_CHECK_EQUAL(extendedMove.getCSRC(1), 0x2001);
+  BOOST_CHECK_EQUAL(extendedMove.getSize(), 12 + 2 * 4 + 8);
+  small = extendedMove;
+  BOOST_CHECK_EQUAL(small.getHeaderExtension().getHeaderExtension(0).getExtensionData()[1], 0x34);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // test
+} // rtp_plus_plus
@@ -1,5 +1,6 @@
 #pragma once
 #include <rtp++/RtpJitterBuffer.h>
+#include <rtp++/RtpRingJitterBuffer.h>
 
 /**
   * This class gives us access to the playout buffer internals
@@ -110,6 +111,78 @@ public:
     BOOST_CHECK_EQUAL( 2, testBuffer.getDuplicateSequenceNumberCount() );
   }
 
+  /**
+   * The RtpPlayoutBuffer scenario against the ring buffer which has no node list:
+   * the frames are played out and checked instead.
+   */
+  static void test_RtpRingJitterBuffer()
+  {
+    RtpRingJitterBuffer playoutBuffer(1000);
+
+    typedef std::pair<uint32_t, uint32_t> TS_XSN_PAIR_t;
+    std::vector<TS_XSN_PAIR_t> packet_info;
+    packet_info.push_back( std::make_pair(UINT_MAX - 30, 5) );
+    packet_info.push_back( std::make_pair(UINT_MAX - 20, 6) );
+    // duplicate SN
+    packet_info.push_back( std::make_pair(UINT_MAX - 20, 6) );
+    // node update
+    packet_info.push_back( std::make_pair(UINT_MAX - 20, 7) );
+    packet_info.push_back( std::make_pair(UINT_MAX - 10, 8) );
+    packet_info.push_back( std::make_pair(UINT_MAX,      9) );
+    // wrap around
+    packet_info.push_back( std::make_pair(20,            10) );
+    // re-ordering
+    packet_info.push_back( std::make_pair(10,            11) );
+    // duplicate SN
+    packet_info.push_back( std::make_pair(10,            11) );
+
+    // the ring orders frames by presentation time: use 1 ms per RTP TS tick
+    boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+    uint32_t uiDuplicates = 0;
+    for (size_t i = 0; i < packet_info.size(); ++i)
+    {
+      RtpPacket packet;
+      packet.setArrivalTime(tNow);
+      packet.getHeader().setRtpTimestamp(packet_info[i].first);
+      packet.setExtendedSequenceNumber(packet_info[i].second);
+      int32_t iOffsetMs = static_cast<int32_t>(packet_info[i].first - packet_info[0].first);
+      boost::posix_time::ptime tPlayout;
+      bool bDup = false;
+      uint32_t uiLate = 0;
+      playoutBuffer.addRtpPacket(packet, tNow + boost::posix_time::milliseconds(iOffsetMs), false, tPlayout, uiLate, bDup);
+      BOOST_CHECK_EQUAL( uiLate, 0 );
+      if (bDup) ++uiDuplicates;
+    }
+
+    // test order and number of nodes
+    std::vector<uint32_t> expected_timestamps;
+    expected_timestamps.push_back(UINT_MAX - 30);
+    expected_timestamps.push_back(UINT_MAX - 20);
+    expected_timestamps.push_back(UINT_MAX - 10);
+    expected_timestamps.push_back(UINT_MAX );
+    expected_timestamps.push_back(10);
+    expected_timestamps.push_back(20);
+
+    std::vector<RtpPacketGroup> nodes;
+    for (size_t i = 0; i < expected_timestamps.size(); ++i)
+    {
+      nodes.push_back(playoutBuffer.getNextPlayoutBufferNode());
+      BOOST_CHECK_EQUAL( expected_timestamps[i], nodes[i].getRtpTimestamp() );
+    }
+
+    // test node update: the second node should have 2 elements
+    std::list<RtpPacket> groupedRtpPackets = nodes[1].getRtpPackets();
+    BOOST_CHECK_EQUAL( 2, groupedRtpPackets.size());
+    // check order of coded data
+    auto data_it = groupedRtpPackets.begin();
+    BOOST_CHECK_EQUAL( 6, data_it->getSequenceNumber());
+    ++data_it;
+    BOOST_CHECK_EQUAL( 7, data_it->getSequenceNumber());
+
+    // test duplicate sequence number
+    BOOST_CHECK_EQUAL( 2, uiDuplicates );
+  }
+
 private:
   RtpJitterBuffer& m_playoutBuffer;
 };
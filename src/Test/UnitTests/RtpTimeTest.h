@@ -3,6 +3,7 @@
 #include <rtp++/RtpReferenceClock.h>
 #include <rtp++/RtpSessionState.h>
 #include <rtp++/RtpTime.h>
+#include <rtp++/util/Clock.h>
 
 namespace rtp_plus_plus
 {
@@ -436,6 +437,73 @@ BOOST_AUTO_TEST_CASE(test_NtpConversion)
   BOOST_CHECK_EQUAL(tAfterConversion == tNtp, true);
 }
 
+BOOST_AUTO_TEST_CASE(tc_test_UnixTimeToNtp)
+{
+  // 2000-01-01 00:00:00.5 UTC
+  uint64_t uiNtp = RtpTime::convertUnixTimeToNtpTimestamp(946684800, 500000000);
+  BOOST_CHECK_EQUAL(static_cast<uint32_t>(uiNtp >> 32), 3155673600U);
+  BOOST_CHECK_EQUAL(static_cast<uint32_t>(uiNtp), 0x80000000U);
+  boost::posix_time::ptime tExpected(boost::gregorian::date(2000, 1, 1), boost::posix_time::milliseconds(500));
+  BOOST_CHECK_EQUAL(RtpTime::convertNtpTimestampToPosixTime(uiNtp) == tExpected, true);
+}
+
+BOOST_AUTO_TEST_CASE(tc_test_RtpTimestampConverter)
+{
+  // must match the ptime based conversion on microsecond boundaries
+  const uint32_t uiFrequencies[] = { 8000, 44100, 48000, 90000 };
+  boost::posix_time::ptime tStart(boost::gregorian::date(2015, 6, 1), boost::posix_time::hours(13));
+  for (uint32_t uiFrequency : uiFrequencies)
+  {
+    RtpTimestampConverter converter(uiFrequency);
+    for (int i = 0; i < 1000; ++i)
+    {
+      boost::posix_time::ptime t = tStart + boost::posix_time::microseconds(i * 7919);
+      uint32_t uiExpected = RtpTime::convertTimeToRtpTimestamp(t, uiFrequency, 12345);
+      BOOST_CHECK_EQUAL(converter.toRtpTimestamp(Clock::fromPosixTime(t), 12345), uiExpected);
+    }
+  }
+
+  RtpTimestampConverter converter(90000);
+  BOOST_CHECK_EQUAL(converter.toNs(3000), 33333333);
+  BOOST_CHECK_EQUAL(converter.toNs(-90000), -1000000000LL);
+  // presentation time across the RTP timestamp wrap
+  BOOST_CHECK_EQUAL(converter.getPresentationTime(0xFFFFFF00, 5000000000LL, 0x00000100), 5000000000LL + 512 * 100000000LL / 9000);
+}
+
+BOOST_AUTO_TEST_CASE(tc_test_UnixNsToNtp)
+{
+  // 2000-01-01 00:00:00.5 UTC
+  int64_t iUnixNs = 946684800LL * 1000000000LL + 500000000LL;
+  uint64_t uiNtp = RtpTime::convertUnixNsToNtpTimestamp(iUnixNs);
+  BOOST_CHECK_EQUAL(static_cast<uint32_t>(uiNtp >> 32), 3155673600U);
+  BOOST_CHECK_EQUAL(static_cast<uint32_t>(uiNtp), 0x80000000U);
+  BOOST_CHECK_EQUAL(RtpTime::convertNtpTimestampToUnixNs(uiNtp), iUnixNs);
+
+  // round trip is accurate to a nanosecond
+  int64_t iNs = 1434000000123456789LL;
+  BOOST_CHECK(std::abs(RtpTime::convertNtpTimestampToUnixNs(RtpTime::convertUnixNsToNtpTimestamp(iNs)) - iNs) <= 1);
+}
+
+BOOST_AUTO_TEST_CASE(tc_test_VirtualClock)
+{
+  int64_t iStartNs = 1434000000LL * 1000000000LL;
+  VirtualClock clock(iStartNs);
+  Clock::install(&clock);
+  BOOST_CHECK_EQUAL(Clock::monotonicNs(), 0);
+  BOOST_CHECK_EQUAL(Clock::realtimeNs(), iStartNs);
+
+  clock.advance(boost::posix_time::milliseconds(20));
+  BOOST_CHECK_EQUAL(Clock::monotonicNs(), 20000000);
+  BOOST_CHECK(Clock::universalTime() == Clock::toPosixTime(iStartNs) + boost::posix_time::milliseconds(20));
+
+  uint32_t uiMsw = 0, uiLsw = 0;
+  RtpTime::getNTPTimeStamp(uiMsw, uiLsw);
+  BOOST_CHECK_EQUAL(uiMsw, 1434000000U + 2208988800U);
+
+  Clock::install(nullptr);
+  BOOST_CHECK(Clock::realtimeNs() > iStartNs);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // test
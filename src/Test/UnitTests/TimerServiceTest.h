@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <boost/asio/io_service.hpp>
+#include <boost/bind.hpp>
+#include <rtp++/util/Clock.h>
+#include <rtp++/util/TimerService.h>
+
+namespace rtp_plus_plus
+{
+namespace test {
+
+static void onTimerServiceTimeout(const boost::system::error_code& ec, int iValue, std::vector<int>& vFired, std::vector<int>& vAborted)
+{
+  if (ec == boost::asio::error::operation_aborted)
+    vAborted.push_back(iValue);
+  else
+    vFired.push_back(iValue);
+}
+
+BOOST_AUTO_TEST_SUITE(TimerServiceTest)
+BOOST_AUTO_TEST_CASE(test_TimerServiceOrder)
+{
+  boost::asio::io_service ioService;
+  TimerService& timerService = boost::asio::use_service<TimerService>(ioService);
+  std::vector<int> vFired;
+  std::vector<int> vAborted;
+  boost::posix_time::ptime tNow = boost::posix_time::microsec_clock::universal_time();
+  // scheduled out of order: an earlier deadline re-arms the timer
+  timerService.expiresAt(tNow + boost::posix_time::milliseconds(30), boost::bind(&onTimerServiceTimeout, _1, 3, boost::ref(vFired), boost::ref(vAborted)));
+  timerService.expiresAt(tNow + boost::posix_time::milliseconds(10), boost::bind(&onTimerServiceTimeout, _1, 1, boost::ref(vFired), boost::ref(vAborted)));
+  timerService.expiresAt(tNow + boost::posix_time::milliseconds(20), boost::bind(&onTimerServiceTimeout, _1, 2, boost::ref(vFired), boost::ref(vAborted)));
+  // same deadline: scheduling order is kept
+  timerService.expiresAt(tNow + boost::posix_time::milliseconds(30), boost::bind(&onTimerServiceTimeout, _1, 4, boost::ref(vFired), boost::ref(vAborted)));
+  BOOST_CHECK_EQUAL(timerService.getPendingCount(), 4);
+  ioService.run();
+
+  BOOST_CHECK_EQUAL(timerService.getPendingCount(), 0);
+  BOOST_CHECK_EQUAL(vAborted.size(), 0);
+  BOOST_CHECK_EQUAL(vFired.size(), 4);
+  for (size_t i = 0; i < vFired.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(vFired[i], static_cast<int>(i + 1));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_TimerServiceCancelGroup)
+{
+  boost::asio::io_service ioService;
+  TimerService& timerService = boost::asio::use_service<TimerService>(ioService);
+  uint32_t uiGroup1 = timerService.createGroup();
+  uint32_t uiGroup2 = timerService.createGroup();
+  BOOST_CHECK(uiGroup1 != uiGroup2);
+  std::vector<int> vFired;
+  std::vector<int> vAborted;
+  timerService.expiresFromNow(boost::posix_time::milliseconds(10), boost::bind(&onTimerServiceTimeout, _1, 1, boost::ref(vFired), boost::ref(vAborted)), uiGroup1);
+  timerService.expiresFromNow(boost::posix_time::milliseconds(20), boost::bind(&onTimerServiceTimeout, _1, 2, boost::ref(vFired), boost::ref(vAborted)), uiGroup2);
+  timerService.expiresFromNow(boost::posix_time::milliseconds(30), boost::bind(&onTimerServiceTimeout, _1, 3, boost::ref(vFired), boost::ref(vAborted)), uiGroup1);
+  BOOST_CHECK_EQUAL(timerService.cancel(uiGroup1), 2);
+  BOOST_CHECK_EQUAL(timerService.cancel(uiGroup1), 0);
+  ioService.run();
+
+  BOOST_CHECK_EQUAL(vFired.size(), 1);
+  BOOST_CHECK_EQUAL(vFired[0], 2);
+  BOOST_CHECK_EQUAL(vAborted.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_TimerServiceVirtualClock)
+{
+  int64_t iStartNs = 1434000000LL * 1000000000LL;
+  VirtualClock clock(iStartNs);
+  Clock::install(&clock);
+  {
+    boost::asio::io_service ioService;
+    TimerService& timerService = boost::asio::use_service<TimerService>(ioService);
+    std::vector<int> vFired;
+    std::vector<int> vAborted;
+    // simulated time only passes when the clock is advanced
+    timerService.expiresFromNow(boost::posix_time::seconds(10), boost::bind(&onTimerServiceTimeout, _1, 1, boost::ref(vFired), boost::ref(vAborted)));
+    timerService.expiresAt(Clock::universalTime() + boost::posix_time::seconds(20), boost::bind(&onTimerServiceTimeout, _1, 2, boost::ref(vFired), boost::ref(vAborted)));
+    timerService.expiresFromNow(boost::posix_time::hours(1), boost::bind(&onTimerServiceTimeout, _1, 3, boost::ref(vFired), boost::ref(vAborted)));
+    BOOST_CHECK_EQUAL(timerService.poll(), 0);
+
+    clock.advance(boost::posix_time::seconds(10));
+    BOOST_CHECK_EQUAL(timerService.poll(), 1);
+    BOOST_REQUIRE_EQUAL(vFired.size(), 1);
+    BOOST_CHECK_EQUAL(vFired[0], 1);
+
+    clock.advance(boost::posix_time::hours(1));
+    BOOST_CHECK_EQUAL(timerService.poll(), 2);
+    BOOST_REQUIRE_EQUAL(vFired.size(), 3);
+    BOOST_CHECK_EQUAL(vFired[1], 2);
+    BOOST_CHECK_EQUAL(vFired[2], 3);
+    BOOST_CHECK_EQUAL(timerService.getPendingCount(), 0);
+    BOOST_CHECK_EQUAL(vAborted.size(), 0);
+  }
+  Clock::install(nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // test
+} // rtp_plus_plus
@@ -32,6 +32,44 @@ BOOST_AUTO_TEST_CASE(test_storePacketForRetransmission)
   BOOST_CHECK_EQUAL(pInfo == nullptr, true);
 }
 
+BOOST_AUTO_TEST_CASE(test_historyExpiry)
+{
+  uint8_t uiPayloadType = 96;
+  RtpSessionState rtpSessionState(uiPayloadType);
+  boost::asio::io_service ioService;
+  TransmissionManager tm(rtpSessionState, ioService, TxBufferManagementMode::CIRCULAR_MODE, 100);
+
+  RtpPacket rtpPacket;
+  rtpPacket.getHeader().setPayloadType(uiPayloadType);
+  // store across the 16-bit SN wrap-around
+  const uint16_t uiFirstSN = 65530;
+  for (uint16_t i = 0; i < 40; ++i)
+  {
+    rtpPacket.setExtendedSequenceNumber(static_cast<uint16_t>(uiFirstSN + i));
+    tm.storePacketForRetransmission(rtpPacket);
+  }
+  // only the most recent packets are kept in circular mode
+  const uint32_t uiCircularSize = TransmissionManager::CIRCULAR_HISTORY_SIZE;
+  BOOST_CHECK_EQUAL(tm.getHistorySize(), uiCircularSize);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(uiFirstSN) == nullptr, true);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(static_cast<uint16_t>(uiFirstSN + 9)) == nullptr, true);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(static_cast<uint16_t>(uiFirstSN + 10)) != nullptr, true);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(static_cast<uint16_t>(uiFirstSN + 39)) != nullptr, true);
+
+  // limit the history to the size of 5 packets
+  tm.setHistoryLimits(0, 5 * rtpPacket.getSize());
+  rtpPacket.setExtendedSequenceNumber(static_cast<uint16_t>(uiFirstSN + 40));
+  tm.storePacketForRetransmission(rtpPacket);
+  BOOST_CHECK_EQUAL(tm.getHistorySize(), 5);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(static_cast<uint16_t>(uiFirstSN + 35)) == nullptr, true);
+  BOOST_CHECK_EQUAL(tm.lookupRtpPacketInfo(static_cast<uint16_t>(uiFirstSN + 36)) != nullptr, true);
+
+  // a jump of more than the ring size evicts all older packets
+  rtpPacket.setExtendedSequenceNumber(static_cast<uint16_t>(uiFirstSN + 40 + TransmissionManager::DEFAULT_HISTORY_SIZE));
+  tm.storePacketForRetransmission(rtpPacket);
+  BOOST_CHECK_EQUAL(tm.getHistorySize(), 1);
+}
+
 BOOST_AUTO_TEST_CASE(test_getLastNReceivedSequenceNumbers)
 {
   uint8_t uiPayloadType = 96;
@@ -35,6 +35,7 @@
 #include "LossEstimatorTest.h"
 #include "MediaTest.h"
 #include "MemberEntryTest.h"
+#include "MemberTableTest.h"
 #include "MpRtpTest.h"
 #include "NetworkTest.h"
 #include "Rfc2326Test.h"
@@ -43,13 +44,16 @@
 #include "Rfc4585Test.h"
 #include "Rfc5285Test.h"
 #include "Rfc6184Test.h"
+#include "RfchevcTest.h"
 #include "RtcpTest.h"
 #include "RtoTest.h"
 #include "RtpJitterBufferV2Test.h"
+#include "RtpPacketiserTest.h"
 #include "RtpPacketGroupTest.h"
 #include "RtpPlayoutBufferTest.h"
 #include "RtpTimeTest.h"
 #include "SctpTest.h"
+#include "TimerServiceTest.h"
 #include "TransmissionManagerTest.h"
 
 using namespace std;
@@ -88,6 +92,14 @@ BOOST_AUTO_TEST_CASE( tc_test_RtpJitterBufferV2)
 #endif
 #endif
 
+// This unit test runs the RtpJitterBufferV2 insertion and RtpPlayoutBuffer tests against the ring based jitter buffer
+BOOST_AUTO_TEST_CASE( tc_test_RtpRingJitterBuffer )
+{
+  RtpJitterBufferV2Test::test_insertion<RtpRingJitterBuffer>();
+  RtpJitterBufferV2Test::test_ring_wrap_around();
+  RtpJitterBufferTest::test_RtpRingJitterBuffer();
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE( tc_test_TcpRtpSockets )
 {
@@ -0,0 +1,915 @@
+#include "RtpBenchmarkPch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/exception/all.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread.hpp>
+#include <cpputil/GenericParameters.h>
+#include <rtp++/RtpPacket.h>
+#include <rtp++/RtpPacketGroup.h>
+#include <rtp++/RtpReferenceClock.h>
+#include <rtp++/RtpSession.h>
+#include <rtp++/RtpSessionParameters.h>
+#include <rtp++/RtpSessionState.h>
+#include <rtp++/network/ReusePortShardGroup.h>
+#include <rtp++/media/MediaSample.h>
+#include <rtp++/media/NalUnitMediaSource.h>
+#include <rtp++/media/StartCodeScanner.h>
+#include <rtp++/network/UdpSocketWrapper.h>
+#include <rtp++/media/h265/H265NalUnitTypes.h>
+#include <rtp++/rfc3550/SessionDatabase.h>
+#include <rtp++/rfc6184/Rfc6184.h>
+#include <rtp++/rfchevc/RfchevcPacketiser.h>
+#include <rtp++/util/BufferPool.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using namespace rtp_plus_plus;
+namespace po = boost::program_options;
+
+/**
+ * @brief Returns the CPU time (user + system) consumed by the process so far in microseconds.
+ */
+static uint64_t getCpuTimeUs()
+{
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+      usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Receiver side of the UDP receive benchmark.
+ *
+ * Counts the datagrams delivered by the UdpSocketWrapper in either the single datagram
+ * or the batched receive mode.
+ */
+class UdpReceiveCounter
+{
+public:
+  UdpReceiveCounter(boost::asio::io_service& ioService, uint16_t uiPort, uint32_t uiBatchSize)
+    :m_timer(ioService),
+      m_uiPackets(0),
+      m_uiBytes(0),
+      m_uiCallbacks(0)
+  {
+    m_pSocket = UdpSocketWrapper::create(ioService, "127.0.0.1", uiPort);
+    m_pSocket->onRecv(boost::bind(&UdpReceiveCounter::onRecv, this, _1, _2, _3, _4));
+    m_pSocket->onRecvBatch(boost::bind(&UdpReceiveCounter::onRecvBatch, this, _1, _2, _3));
+    if (uiBatchSize > 1 && !m_pSocket->setReceiveBatchSize(uiBatchSize))
+    {
+      LOG(WARNING) << "Batched receive not supported on this platform";
+    }
+  }
+
+  void start()
+  {
+    m_pSocket->recv();
+  }
+  /**
+   * @brief stops receiving once no packet has arrived for the specified duration
+   */
+  void stopWhenIdle(uint32_t uiIdleMs)
+  {
+    m_timer.expires_from_now(boost::posix_time::milliseconds(uiIdleMs));
+    m_timer.async_wait(boost::bind(&UdpReceiveCounter::onIdleCheck, this, _1, m_uiPackets, uiIdleMs));
+  }
+
+  uint64_t getPackets() const { return m_uiPackets; }
+  uint64_t getBytes() const { return m_uiBytes; }
+  uint64_t getCallbacks() const { return m_uiCallbacks; }
+
+private:
+  void onIdleCheck(const boost::system::error_code& ec, uint64_t uiPacketsAtLastCheck, uint32_t uiIdleMs)
+  {
+    if (ec) return;
+    if (m_uiPackets == uiPacketsAtLastCheck)
+    {
+      m_pSocket->close();
+      return;
+    }
+    stopWhenIdle(uiIdleMs);
+  }
+
+  void onRecv(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, NetworkPacket networkPacket, const EndPoint& ep)
+  {
+    if (ec) return;
+    ++m_uiCallbacks;
+    ++m_uiPackets;
+    m_uiBytes += networkPacket.getSize();
+    pSource->recv();
+  }
+
+  void onRecvBatch(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, const UdpSocketWrapper::NetworkPacketBatch_t& batch)
+  {
+    if (ec) return;
+    ++m_uiCallbacks;
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+      ++m_uiPackets;
+      m_uiBytes += batch[i].first.getSize();
+    }
+    pSource->recv();
+  }
+
+private:
+  UdpSocketWrapper::ptr m_pSocket;
+  boost::asio::deadline_timer m_timer;
+  uint64_t m_uiPackets;
+  uint64_t m_uiBytes;
+  uint64_t m_uiCallbacks;
+};
+
+/**
+ * @brief Sends uiPackets datagrams of uiSize bytes to the loopback port as fast as possible.
+ */
+static void sendUdpPackets(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize)
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket socket(ioService, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  boost::asio::ip::udp::endpoint destination(boost::asio::ip::address::from_string("127.0.0.1"), uiPort);
+  std::vector<char> vPayload(uiSize, 'x');
+  boost::system::error_code ec;
+  for (uint32_t i = 0; i < uiPackets; ++i)
+  {
+    socket.send_to(boost::asio::buffer(vPayload), destination, 0, ec);
+  }
+}
+
+/**
+ * @brief Compares the packet rate and CPU cost of the single datagram and batched UDP receive paths.
+ */
+static int benchmarkUdpReceive(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize, uint32_t uiBatchSize)
+{
+  boost::asio::io_service ioService;
+  UdpReceiveCounter counter(ioService, uiPort, uiBatchSize);
+  counter.start();
+
+  uint64_t uiCpuStart = getCpuTimeUs();
+  boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+
+  boost::thread sender(boost::bind(&sendUdpPackets, uiPort, uiPackets, uiSize));
+  counter.stopWhenIdle(200);
+  ioService.run();
+  sender.join();
+
+  boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+  uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+  // don't count the idle period used to detect the end of the test
+  double dSeconds = std::max<int64_t>((tEnd - tStart).total_microseconds() - 200000, 1) / 1000000.0;
+
+  cout << "UDP receive: batch size " << uiBatchSize
+       << " received " << counter.getPackets() << "/" << uiPackets
+       << " (" << counter.getBytes() << " bytes) in " << counter.getCallbacks() << " callbacks"
+       << " rate: " << (uint64_t)(counter.getPackets() / dSeconds) << " pps"
+       << " CPU: " << uiCpuUs / 1000 << " ms"
+       << " CPU per packet: " << (counter.getPackets() ? (double)uiCpuUs / counter.getPackets() : 0.0) << " us"
+       << endl;
+  cout << "Buffer pool (MTU): " << BufferPool::getStatistics(BufferPool::SC_MTU) << endl;
+  return 0;
+}
+
+/**
+ * @brief Sends uiPackets minimal RTP packets of uiSize bytes with the specified SSRC to the loopback port.
+ *
+ * Each call uses its own socket so that the flows have different source ports.
+ */
+static void sendRtpPackets(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize, uint32_t uiSsrc)
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::udp::socket socket(ioService, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+  boost::asio::ip::udp::endpoint destination(boost::asio::ip::address::from_string("127.0.0.1"), uiPort);
+  std::vector<uint8_t> vPacket(std::max<uint32_t>(uiSize, 12), 'x');
+  // V=2, PT=96
+  vPacket[0] = 0x80;
+  vPacket[1] = 96;
+  vPacket[8] = uiSsrc >> 24;
+  vPacket[9] = (uiSsrc >> 16) & 0xFF;
+  vPacket[10] = (uiSsrc >> 8) & 0xFF;
+  vPacket[11] = uiSsrc & 0xFF;
+  boost::system::error_code ec;
+  for (uint32_t i = 0; i < uiPackets; ++i)
+  {
+    vPacket[2] = (i >> 8) & 0xFF;
+    vPacket[3] = i & 0xFF;
+    socket.send_to(boost::asio::buffer(vPacket), destination, 0, ec);
+  }
+}
+
+/**
+ * @brief Counts the RTP packets received by one shard. Only accessed from the shard thread.
+ */
+struct ShardCounter
+{
+  ShardCounter() :Packets(0) {}
+  void onRtp(const RtpPacket& rtpPacket, const EndPoint& ep) { ++Packets; }
+  uint64_t Packets;
+};
+
+/**
+ * @brief Measures the receive rate of uiShards SO_REUSEPORT shards on one multiplexed RTP/RTCP port.
+ */
+static int benchmarkShardedUdpReceive(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize, uint32_t uiShards)
+{
+  boost::system::error_code ec;
+  ReusePortShardGroup group(EndPoint("127.0.0.1", uiPort), uiShards, ec);
+  if (ec)
+  {
+    LOG(WARNING) << "Failed to create receive shards: " << ec.message();
+    return -1;
+  }
+  std::vector<ShardCounter> vCounters(uiShards);
+  for (uint32_t i = 0; i < uiShards; ++i)
+  {
+    group.getNetworkInterface(i).setIncomingRtpHandler(boost::bind(&ShardCounter::onRtp, &vCounters[i], _1, _2));
+  }
+  group.start();
+
+  // use several flows per shard so that the kernel hash has something to distribute
+  const uint32_t uiFlows = uiShards * 4;
+  uint64_t uiCpuStart = getCpuTimeUs();
+  boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+  boost::thread_group senders;
+  for (uint32_t i = 0; i < uiFlows; ++i)
+  {
+    senders.create_thread(boost::bind(&sendRtpPackets, uiPort, uiPackets / uiFlows, uiSize, 1000 + i));
+  }
+  senders.join_all();
+  boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+  // give the shards time to drain their socket buffers
+  boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+  group.stop();
+  uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+  double dSeconds = std::max<int64_t>((tEnd - tStart).total_microseconds(), 1) / 1000000.0;
+
+  uint64_t uiReceived = 0;
+  ostringstream ostr;
+  for (uint32_t i = 0; i < uiShards; ++i)
+  {
+    uiReceived += vCounters[i].Packets;
+    ostr << " " << vCounters[i].Packets;
+  }
+  cout << "UDP receive: shards " << uiShards
+       << " received " << uiReceived << "/" << (uiPackets / uiFlows) * uiFlows
+       << " rate: " << (uint64_t)(uiReceived / dSeconds) << " pps"
+       << " CPU: " << uiCpuUs / 1000 << " ms"
+       << " per shard:" << ostr.str()
+       << endl;
+  return 0;
+}
+
+/**
+ * @brief Sender side of the UDP send benchmark.
+ *
+ * Hands frames of packets to the UdpSocketWrapper and queues the next frame once all
+ * packets of the previous one have been sent.
+ */
+class UdpFrameSender
+{
+public:
+  UdpFrameSender(boost::asio::io_service& ioService, uint16_t uiPort, uint32_t uiBatchSize, bool bGso,
+                 uint32_t uiPackets, uint32_t uiSize, uint32_t uiFrameSize)
+    :m_rIoService(ioService),
+      m_destination("127.0.0.1", uiPort),
+      m_uiPackets(uiPackets),
+      m_uiFrameSize(uiFrameSize),
+      m_uiOutstanding(0),
+      m_uiSent(0)
+  {
+    m_pSocket = UdpSocketWrapper::create(ioService, "127.0.0.1", 0);
+    m_pSocket->onSendComplete(boost::bind(&UdpFrameSender::onSent, this, _1, _2, _3, _4));
+    if (uiBatchSize > 1 && !m_pSocket->setSendBatchSize(uiBatchSize))
+    {
+      LOG(WARNING) << "Batched send not supported on this platform";
+    }
+    if (bGso && !m_pSocket->setSegmentationOffload(true))
+    {
+      LOG(WARNING) << "UDP segmentation offload not supported on this platform";
+    }
+    for (uint32_t i = 0; i < m_uiFrameSize; ++i)
+    {
+      uint8_t* pData = new uint8_t[uiSize];
+      memset(pData, 'x', uiSize);
+      m_vFrame.push_back(Buffer(pData, uiSize));
+    }
+  }
+
+  void start()
+  {
+    sendFrame();
+  }
+
+  uint64_t getSent() const { return m_uiSent; }
+
+private:
+  void sendFrame()
+  {
+    uint32_t uiRemaining = m_uiPackets - m_uiSent;
+    if (uiRemaining == 0)
+    {
+      m_pSocket->close();
+      return;
+    }
+    if (uiRemaining < m_vFrame.size())
+      m_vFrame.resize(uiRemaining);
+    m_uiOutstanding = m_vFrame.size();
+    m_pSocket->send(m_vFrame, m_destination);
+  }
+
+  void onSent(const boost::system::error_code& ec, UdpSocketWrapper::ptr pSource, Buffer buffer, const EndPoint& ep)
+  {
+    ++m_uiSent;
+    if (--m_uiOutstanding == 0)
+    {
+      // queue the next frame from the io_service rather than from within the completion handler
+      m_rIoService.post(boost::bind(&UdpFrameSender::sendFrame, this));
+    }
+  }
+
+private:
+  boost::asio::io_service& m_rIoService;
+  UdpSocketWrapper::ptr m_pSocket;
+  EndPoint m_destination;
+  std::vector<Buffer> m_vFrame;
+  uint32_t m_uiPackets;
+  uint32_t m_uiFrameSize;
+  uint32_t m_uiOutstanding;
+  uint64_t m_uiSent;
+};
+
+/**
+ * @brief Compares the packet rate and CPU cost of the single datagram and batched UDP send paths.
+ */
+static int benchmarkUdpSend(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize, uint32_t uiFrameSize, uint32_t uiBatchSize, bool bGso)
+{
+  boost::asio::io_service ioService;
+  // the datagrams are not read: the receiver only has to exist so that sends don't fail
+  boost::asio::ip::udp::socket sink(ioService, boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), uiPort));
+  UdpFrameSender sender(ioService, uiPort, uiBatchSize, bGso, uiPackets, uiSize, uiFrameSize);
+
+  uint64_t uiCpuStart = getCpuTimeUs();
+  boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+  sender.start();
+  ioService.run();
+  boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+  uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+  double dSeconds = std::max<int64_t>((tEnd - tStart).total_microseconds(), 1) / 1000000.0;
+
+  cout << "UDP send: batch size " << uiBatchSize << " GSO: " << bGso
+       << " frame size: " << uiFrameSize
+       << " sent " << sender.getSent() << "/" << uiPackets
+       << " rate: " << (uint64_t)(sender.getSent() / dSeconds) << " pps"
+       << " CPU: " << uiCpuUs / 1000 << " ms"
+       << " CPU per packet: " << (sender.getSent() ? (double)uiCpuUs / sender.getSent() : 0.0) << " us"
+       << endl;
+  return 0;
+}
+
+/**
+ * @brief Measures the per RTCP interval cost of the session database with uiMembers synthetic members.
+ *
+ * Half of the members are senders that send one RTP packet per interval, the others only send RTCP RRs.
+ */
+static int benchmarkSessionDatabase(uint32_t uiMembers, uint32_t uiIntervals, uint32_t uiReportedSenders)
+{
+  RtpSessionParameters rtpParameters(rfc3550::SdesInformation("benchmark@127.0.0.1"));
+  rtpParameters.setSessionBandwidthKbps(100000);
+  const uint32_t uiLocalSSRC = 0x12345678;
+  RtpSessionState rtpSessionState(96, uiLocalSSRC, true);
+  rfc3550::SessionDatabase sessionDb(rtpSessionState, rtpParameters);
+  sessionDb.setMaxReportedSenders(uiReportedSenders);
+  EndPoint ep("127.0.0.1", 49170);
+
+  std::vector<uint32_t> vSSRCs;
+  for (uint32_t i = 0; i < uiMembers; ++i)
+  {
+    // spread the SSRCs like random ones would be
+    vSSRCs.push_back(0x9E3779B1 * (i + 1));
+  }
+
+  RtpPacket rtpPacket;
+  rtpPacket.getHeader().setPayloadType(96);
+  bool bIsSSRCValid = false;
+  bool bIsRtcpSynchronised = false;
+  boost::posix_time::ptime tPresentation;
+  uint16_t uiSN = 0;
+
+  boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+  for (uint32_t i = 0; i < uiMembers; ++i)
+  {
+    if (i % 2 == 0)
+    {
+      // pass probation
+      rtpPacket.getHeader().setSSRC(vSSRCs[i]);
+      for (uint32_t j = 0; j < rfc3550::MIN_SEQUENTIAL + 1; ++j)
+      {
+        rtpPacket.getHeader().setSequenceNumber(j);
+        sessionDb.processIncomingRtpPacket(rtpPacket, ep, 90000, bIsSSRCValid, bIsRtcpSynchronised, tPresentation);
+      }
+    }
+    else
+    {
+      sessionDb.processIncomingRtcpPacket(*rfc3550::RtcpRr::create(vSSRCs[i]), ep);
+    }
+  }
+  uiSN = rfc3550::MIN_SEQUENTIAL + 1;
+  int64_t iInsertUs = (boost::posix_time::microsec_clock::universal_time() - tStart).total_microseconds();
+
+  int64_t iRtpUs = 0;
+  int64_t iRtcpUs = 0;
+  int64_t iReportedSenders = 0;
+  for (uint32_t uiInterval = 0; uiInterval < uiIntervals; ++uiInterval)
+  {
+    tStart = boost::posix_time::microsec_clock::universal_time();
+    rtpPacket.getHeader().setSequenceNumber(uiSN++);
+    for (uint32_t i = 0; i < uiMembers; i += 2)
+    {
+      rtpPacket.getHeader().setSSRC(vSSRCs[i]);
+      sessionDb.processIncomingRtpPacket(rtpPacket, ep, 90000, bIsSSRCValid, bIsRtcpSynchronised, tPresentation);
+    }
+    boost::posix_time::ptime tRtcp = boost::posix_time::microsec_clock::universal_time();
+    iRtpUs += (tRtcp - tStart).total_microseconds();
+
+    // the work done by the RTCP report manager per interval
+    sessionDb.checkMemberDatabase();
+    uint32_t uiSenders = sessionDb.getSenderCount();
+    uint32_t uiActive = sessionDb.getActiveMemberCount();
+    rfc3550::RtcpReportData_t reportData = sessionDb.gatherRTCPReportDataAndBeginNewInterval();
+    iReportedSenders += std::get<1>(reportData).size();
+    iRtcpUs += (boost::posix_time::microsec_clock::universal_time() - tRtcp).total_microseconds();
+    if (uiInterval == 0)
+    {
+      cout << "Session database: members " << sessionDb.getTotalMemberCount()
+           << " senders: " << uiSenders << " active: " << uiActive << endl;
+    }
+  }
+
+  cout << "Session database: " << uiMembers << " members"
+       << " insertion: " << iInsertUs / 1000 << " ms"
+       << " RTP per packet: " << (double)iRtpUs / (uiIntervals * ((uiMembers + 1) / 2)) << " us"
+       << " RTCP interval: " << (double)iRtcpUs / uiIntervals << " us"
+       << " reported senders per interval: " << iReportedSenders / uiIntervals
+       << endl;
+  return 0;
+}
+
+/**
+ * @brief Measures the packet rate of the RtpSession send path: packetise followed by sendRtpPackets.
+ *
+ * A generic payload type is used so that each media sample maps onto one RTP packet.
+ */
+static int benchmarkPacketise(uint16_t uiPort, uint32_t uiPackets, uint32_t uiSize, uint32_t uiFrameSize)
+{
+  boost::asio::io_service ioService;
+  boost::asio::ip::address loopback = boost::asio::ip::address::from_string("127.0.0.1");
+  // the datagrams are not read: the receivers only have to exist so that sends don't fail
+  boost::asio::ip::udp::socket rtpSink(ioService, boost::asio::ip::udp::endpoint(loopback, uiPort));
+  boost::asio::ip::udp::socket rtcpSink(ioService, boost::asio::ip::udp::endpoint(loopback, uiPort + 1));
+
+  RtpSessionParameters rtpParameters(rfc3550::SdesInformation("benchmark@127.0.0.1"));
+  rtpParameters.addPayloadType(96, "benchmark", 90000);
+  rtpParameters.addLocalEndPoint(std::make_pair(EndPoint("127.0.0.1", uiPort + 2), EndPoint("127.0.0.1", uiPort + 3)));
+  rtpParameters.addRemoteEndPoint(std::make_pair(EndPoint("127.0.0.1", uiPort), EndPoint("127.0.0.1", uiPort + 1)));
+  RtpReferenceClock referenceClock;
+  GenericParameters applicationParameters;
+  RtpSession::ptr pRtpSession = RtpSession::create(ioService, rtpParameters, referenceClock, applicationParameters, true);
+  boost::system::error_code ec = pRtpSession->start();
+  if (ec)
+  {
+    LOG(WARNING) << "Failed to start RTP session: " << ec.message();
+    return -1;
+  }
+
+  std::vector<media::MediaSample> vFrame(uiFrameSize);
+  for (media::MediaSample& mediaSample : vFrame)
+  {
+    uint8_t* pData = new uint8_t[uiSize];
+    memset(pData, 'x', uiSize);
+    mediaSample.setData(pData, uiSize);
+  }
+
+  uint64_t uiSent = 0;
+  uint32_t uiRtpTimestamp = 0;
+  uint64_t uiCpuStart = getCpuTimeUs();
+  boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+  while (uiSent < uiPackets)
+  {
+    if (uiPackets - uiSent < vFrame.size())
+      vFrame.resize(uiPackets - uiSent);
+    std::vector<RtpPacket> vRtpPackets = pRtpSession->packetise(vFrame, uiRtpTimestamp);
+    pRtpSession->sendRtpPackets(vRtpPackets);
+    uiSent += vRtpPackets.size();
+    uiRtpTimestamp += 3000;
+    ioService.poll();
+  }
+  boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+  uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+  double dSeconds = std::max<int64_t>((tEnd - tStart).total_microseconds(), 1) / 1000000.0;
+
+  pRtpSession->stop();
+  ioService.poll();
+
+  cout << "RTP packetise and send: frame size: " << uiFrameSize
+       << " sent " << uiSent << "/" << uiPackets
+       << " rate: " << (uint64_t)(uiSent / dSeconds) << " pps"
+       << " CPU: " << uiCpuUs / 1000 << " ms"
+       << " CPU per packet: " << (uiSent ? (double)uiCpuUs / uiSent : 0.0) << " us"
+       << endl;
+  return 0;
+}
+
+/**
+ * @brief Creates a synthetic HEVC NAL unit of uiSize bytes with LayerId 0 and TID 1.
+ */
+static media::MediaSample createHevcNalUnit(uint8_t uiType, uint32_t uiSize)
+{
+  media::MediaSample mediaSample;
+  uint8_t* pData = new uint8_t[uiSize];
+  memset(pData, 'x', uiSize);
+  pData[0] = uiType << 1;
+  pData[1] = 0x01;
+  mediaSample.setData(pData, uiSize);
+  return mediaSample;
+}
+
+/**
+ * @brief Measures the RFC 7798 packetise and depacketise throughput for access units of
+ * uiFrameBytes bytes split into uiSlices slices e.g. 8K intra frames.
+ *
+ * If uiMaxDonDiff is greater than 0 the interleaved mode is used: the slices are sent in
+ * reverse order within blocks of uiMaxDonDiff + 1 NAL units and the depacketiser restores
+ * the decoding order.
+ */
+static int benchmarkHevc(uint32_t uiFrames, uint32_t uiFrameBytes, uint32_t uiSlices, uint32_t uiMtu, uint32_t uiMaxDonDiff, bool bZeroCopy)
+{
+  std::vector<media::MediaSample> vAccessUnit;
+  vAccessUnit.push_back(createHevcNalUnit(media::h265::NUT_VPS, 24));
+  vAccessUnit.push_back(createHevcNalUnit(media::h265::NUT_SPS, 64));
+  vAccessUnit.push_back(createHevcNalUnit(media::h265::NUT_PPS, 8));
+  const uint32_t uiSliceSize = std::max<uint32_t>(uiFrameBytes / std::max<uint32_t>(uiSlices, 1), 3);
+  for (uint32_t i = 0; i < std::max<uint32_t>(uiSlices, 1); ++i)
+  {
+    vAccessUnit.push_back(createHevcNalUnit(media::h265::NUT_IDR_W_RADL, uiSliceSize));
+  }
+  vAccessUnit.back().setMarker(true);
+
+  if (uiMaxDonDiff > 0)
+  {
+    for (size_t i = 0; i < vAccessUnit.size(); ++i)
+    {
+      vAccessUnit[i].setDecodingOrderNumber(static_cast<int32_t>(i));
+    }
+    const size_t uiBlock = uiMaxDonDiff + 1;
+    for (size_t i = 3; i < vAccessUnit.size(); i += uiBlock)
+    {
+      std::reverse(vAccessUnit.begin() + i, vAccessUnit.begin() + std::min(i + uiBlock, vAccessUnit.size()));
+    }
+  }
+
+  rfchevc::RfchevcPacketiser packetiser(uiMtu, 0);
+  packetiser.setZeroCopy(bZeroCopy);
+  if (uiMaxDonDiff > 0)
+  {
+    packetiser.setPacketizationMode(rfchevc::RfchevcPacketiser::INTERLEAVED_MODE);
+    packetiser.setMaxDonDiff(uiMaxDonDiff);
+  }
+
+  uint64_t uiBytes = 0;
+  uint64_t uiPackets = 0;
+  uint64_t uiNalUnits = 0;
+  uint64_t uiPacketiseUs = 0;
+  uint64_t uiDepacketiseUs = 0;
+  uint64_t uiCpuStart = getCpuTimeUs();
+  uint32_t uiSN = 0;
+  for (uint32_t uiFrame = 0; uiFrame < uiFrames; ++uiFrame)
+  {
+    if (uiMaxDonDiff > 0)
+    {
+      // keep the DONs increasing from frame to frame
+      for (size_t i = 0; i < vAccessUnit.size(); ++i)
+      {
+        vAccessUnit[i].setDecodingOrderNumber((vAccessUnit[i].getDecodingOrderNumber() + vAccessUnit.size()) & 0xFFFF);
+      }
+    }
+    boost::posix_time::ptime t0 = boost::posix_time::microsec_clock::universal_time();
+    std::vector<RtpPacket> vRtpPackets = packetiser.packetise(vAccessUnit);
+    boost::posix_time::ptime t1 = boost::posix_time::microsec_clock::universal_time();
+
+    // received packets consist of one payload buffer
+    std::unique_ptr<RtpPacketGroup> pGroup;
+    for (RtpPacket& rtpPacket : vRtpPackets)
+    {
+      uiBytes += rtpPacket.getPayloadSize();
+      rtpPacket.setPayload(rtpPacket.getContiguousPayload());
+      rtpPacket.setExtendedSequenceNumber(uiSN++);
+      rtpPacket.getHeader().setRtpTimestamp(uiFrame * 3000);
+      if (pGroup)
+        pGroup->insert(rtpPacket);
+      else
+        pGroup = std::unique_ptr<RtpPacketGroup>(new RtpPacketGroup(rtpPacket, boost::posix_time::ptime(), false, boost::posix_time::ptime()));
+    }
+    boost::posix_time::ptime t2 = boost::posix_time::microsec_clock::universal_time();
+    std::vector<media::MediaSample> vNalUnits = packetiser.depacketize(*pGroup);
+    boost::posix_time::ptime t3 = boost::posix_time::microsec_clock::universal_time();
+
+    uiPackets += vRtpPackets.size();
+    uiNalUnits += vNalUnits.size();
+    uiPacketiseUs += (t1 - t0).total_microseconds();
+    uiDepacketiseUs += (t3 - t2).total_microseconds();
+  }
+  uiNalUnits += packetiser.flush().size();
+  uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+  double dPacketiseSeconds = std::max<uint64_t>(uiPacketiseUs, 1) / 1000000.0;
+  double dDepacketiseSeconds = std::max<uint64_t>(uiDepacketiseUs, 1) / 1000000.0;
+
+  cout << "HEVC " << (uiMaxDonDiff > 0 ? "interleaved" : "non-interleaved")
+       << (bZeroCopy ? " zero copy" : " copy")
+       << ": frames: " << uiFrames
+       << " packets: " << uiPackets
+       << " NAL units: " << uiNalUnits << "/" << (uint64_t)uiFrames * vAccessUnit.size()
+       << " packetise: " << (uint64_t)(uiBytes / dPacketiseSeconds / 1000000) << " MB/s "
+       << (uint64_t)(uiPackets / dPacketiseSeconds) << " pps"
+       << " depacketise: " << (uint64_t)(uiBytes / dDepacketiseSeconds / 1000000) << " MB/s "
+       << (uint64_t)(uiPackets / dDepacketiseSeconds) << " pps"
+       << " CPU: " << uiCpuUs / 1000 << " ms"
+       << endl;
+  return 0;
+}
+
+/**
+ * @brief Measures the throughput of the Annex B start code search over uiMegabytes of
+ * synthetic data with a NAL unit every 1000 bytes for the scalar and the dispatched
+ * implementations.
+ */
+static int benchmarkStartCodes(uint32_t uiMegabytes)
+{
+  const size_t uiSize = static_cast<size_t>(uiMegabytes) * 1024 * 1024;
+  std::vector<uint8_t> vData(uiSize);
+  uint32_t uiSeed = 1;
+  for (size_t i = 0; i < uiSize; ++i)
+  {
+    uiSeed = uiSeed * 1103515245 + 12345;
+    vData[i] = static_cast<uint8_t>(uiSeed >> 16);
+    // emulation prevention: 00 00 is never followed by 00, 01, 02 or 03 in a NAL unit
+    if (i >= 2 && vData[i - 1] == 0 && vData[i - 2] == 0 && vData[i] <= 3)
+      vData[i] = 4;
+  }
+  for (size_t i = 0; i + 4 <= uiSize; i += 1000)
+  {
+    vData[i] = 0;
+    vData[i + 1] = 0;
+    vData[i + 2] = 0;
+    vData[i + 3] = 1;
+  }
+
+  typedef size_t (*FindFunction)(const uint8_t*, size_t, size_t);
+  const FindFunction functions[] = { &media::StartCodeScanner::findScalar, &media::StartCodeScanner::find };
+  const char* names[] = { "scalar", media::StartCodeScanner::getImplementation() };
+  for (size_t j = 0; j < sizeof(functions)/sizeof(FindFunction); ++j)
+  {
+    uint64_t uiStartCodes = 0;
+    uint64_t uiCpuStart = getCpuTimeUs();
+    boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+    for (size_t i = functions[j](&vData[0], uiSize, 0); i < uiSize; i = functions[j](&vData[0], uiSize, i + 3))
+    {
+      ++uiStartCodes;
+    }
+    boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+    uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+    double dSeconds = std::max<int64_t>((tEnd - tStart).total_microseconds(), 1) / 1000000.0;
+
+    cout << "Start code search: " << names[j]
+         << " start codes: " << uiStartCodes
+         << " rate: " << (uint64_t)(uiSize / dSeconds / 1000000) << " MB/s"
+         << " CPU: " << uiCpuUs / 1000 << " ms"
+         << endl;
+  }
+  return 0;
+}
+
+/**
+ * @brief Measures the start up time of a NAL unit file source without and with the index
+ * and the time to read uiLoops loops of the file.
+ */
+static int benchmarkNalSource(const std::string& sFilename, const std::string& sMediaType, uint32_t uiLoops)
+{
+  std::remove(media::NalUnitMediaSource::getIndexFilename(sFilename).c_str());
+  const char* names[] = { "scan", "index" };
+  for (size_t j = 0; j < sizeof(names)/sizeof(const char*); ++j)
+  {
+    uint64_t uiCpuStart = getCpuTimeUs();
+    boost::posix_time::ptime tStart = boost::posix_time::microsec_clock::universal_time();
+    media::NalUnitMediaSource source(sFilename, sMediaType, true, uiLoops);
+    boost::posix_time::ptime tOpened = boost::posix_time::microsec_clock::universal_time();
+    uint64_t uiAccessUnits = 0;
+    uint64_t uiBytes = 0;
+    while (source.isGood())
+    {
+      std::vector<media::MediaSample> vAu = source.getNextAccessUnit();
+      if (vAu.empty()) break;
+      ++uiAccessUnits;
+      for (size_t i = 0; i < vAu.size(); ++i)
+        uiBytes += vAu[i].getPayloadSize();
+    }
+    boost::posix_time::ptime tEnd = boost::posix_time::microsec_clock::universal_time();
+    uint64_t uiCpuUs = getCpuTimeUs() - uiCpuStart;
+
+    cout << "NAL unit source: " << names[j]
+         << " start up: " << (tOpened - tStart).total_microseconds() << " us"
+         << " AUs: " << uiAccessUnits
+         << " bytes: " << uiBytes
+         << " read: " << (tEnd - tOpened).total_milliseconds() << " ms"
+         << " CPU: " << uiCpuUs / 1000 << " ms"
+         << endl;
+  }
+  return 0;
+}
+
+/**
+ * @brief main Micro-benchmarks for the rtp++ hot paths.
+ *
+ * Usage: RtpBenchmark --mode udp-recv --packets 1000000 --size 1200 --recv-batch 32
+ *        RtpBenchmark --mode udp-send --packets 1000000 --size 1200 --frame-size 100 --send-batch 64 --udp-gso
+ *        RtpBenchmark --mode udp-shard-recv --packets 1000000 --size 1200 --shards 4
+ *        RtpBenchmark --mode session-db --members 10000 --intervals 100 --report-senders 31
+ *        RtpBenchmark --mode packetise --packets 1000000 --size 1200 --frame-size 100
+ *        RtpBenchmark --mode hevc --frames 100 --frame-bytes 1500000 --slices 16 --mtu 1460 --max-don-diff 4
+ *        RtpBenchmark --mode start-codes --scan-mb 256
+ *        RtpBenchmark --mode nal-source --file video.264 --media-type H264 --loops 100
+ */
+int main(int argc, char** argv)
+{
+  google::InitGoogleLogging(argv[0]);
+
+  try
+  {
+    string sMode;
+    uint32_t uiPackets = 0;
+    uint32_t uiSize = 0;
+    uint32_t uiBatchSize = 0;
+    uint32_t uiSendBatchSize = 0;
+    uint32_t uiFrameSize = 0;
+    uint32_t uiShards = 0;
+    uint32_t uiMembers = 0;
+    uint32_t uiIntervals = 0;
+    uint32_t uiReportedSenders = 0;
+    uint32_t uiFrames = 0;
+    uint32_t uiFrameBytes = 0;
+    uint32_t uiSlices = 0;
+    uint32_t uiMtu = 0;
+    uint32_t uiMaxDonDiff = 0;
+    uint32_t uiScanMegabytes = 0;
+    string sFilename;
+    string sMediaType;
+    uint32_t uiLoops = 0;
+    bool bGso = false;
+    uint16_t uiPort = 0;
+
+    po::options_description cmdline_options("Options");
+    cmdline_options.add_options()
+        ("help,?", "produce help message")
+        ("mode", po::value<string>(&sMode)->default_value("udp-recv"), "Benchmark to run: udp-recv, udp-send, udp-shard-recv, session-db, packetise, hevc, start-codes, nal-source")
+        ("packets", po::value<uint32_t>(&uiPackets)->default_value(1000000), "Number of packets")
+        ("size", po::value<uint32_t>(&uiSize)->default_value(1200), "Packet size in bytes")
+        ("recv-batch", po::value<uint32_t>(&uiBatchSize)->default_value(0), "Max UDP datagrams read per receive. 0 = compare single datagram receive against batch sizes 8, 32 and 64")
+        ("send-batch", po::value<uint32_t>(&uiSendBatchSize)->default_value(0), "Max UDP datagrams written per send. 0 = compare single datagram send against batch sizes 8, 32 and 64")
+        ("udp-gso", po::bool_switch(&bGso)->default_value(false), "Use UDP segmentation offload for batched sends")
+        ("frame-size", po::value<uint32_t>(&uiFrameSize)->default_value(100), "Packets per frame handed to the socket at once")
+        ("shards", po::value<uint32_t>(&uiShards)->default_value(0), "Number of SO_REUSEPORT receive shards. 0 = compare 1, 2 and 4 shards")
+        ("port", po::value<uint16_t>(&uiPort)->default_value(49170), "Local UDP port")
+        ("members", po::value<uint32_t>(&uiMembers)->default_value(10000), "Number of synthetic session members")
+        ("intervals", po::value<uint32_t>(&uiIntervals)->default_value(100), "Number of RTCP intervals")
+        ("report-senders", po::value<uint32_t>(&uiReportedSenders)->default_value(0), "Max senders reported on per RTCP interval. 0 = all")
+        ("frames", po::value<uint32_t>(&uiFrames)->default_value(100), "Number of HEVC access units")
+        ("frame-bytes", po::value<uint32_t>(&uiFrameBytes)->default_value(1500000), "Size of each HEVC access unit in bytes")
+        ("slices", po::value<uint32_t>(&uiSlices)->default_value(16), "Number of slices per HEVC access unit")
+        ("mtu", po::value<uint32_t>(&uiMtu)->default_value(1460), "MTU used by the HEVC packetiser")
+        ("max-don-diff", po::value<uint32_t>(&uiMaxDonDiff)->default_value(4), "sprop-max-don-diff used in the interleaved HEVC runs")
+        ("scan-mb", po::value<uint32_t>(&uiScanMegabytes)->default_value(256), "Megabytes of Annex B data searched for start codes")
+        ("file", po::value<string>(&sFilename), "Annex B file read by the NAL unit source")
+        ("media-type", po::value<string>(&sMediaType)->default_value(rfc6184::H264), "Media type of the NAL unit source: H264 or H265")
+        ("loops", po::value<uint32_t>(&uiLoops)->default_value(100), "Number of times the NAL unit source is looped")
+        ;
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).options(cmdline_options).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))
+    {
+      ostringstream ostr;
+      ostr << cmdline_options;
+      LOG(ERROR) << ostr.str();
+      return 1;
+    }
+
+    if (sMode == "udp-recv")
+    {
+      if (uiBatchSize != 0)
+        return benchmarkUdpReceive(uiPort, uiPackets, uiSize, uiBatchSize);
+
+      const uint32_t batchSizes[] = { 1, 8, 32, 64 };
+      for (size_t i = 0; i < sizeof(batchSizes)/sizeof(uint32_t); ++i)
+      {
+        benchmarkUdpReceive(uiPort, uiPackets, uiSize, batchSizes[i]);
+      }
+      return 0;
+    }
+
+    if (sMode == "udp-send")
+    {
+      if (uiSendBatchSize != 0)
+        return benchmarkUdpSend(uiPort, uiPackets, uiSize, uiFrameSize, uiSendBatchSize, bGso);
+
+      const uint32_t batchSizes[] = { 1, 8, 32, 64 };
+      for (size_t i = 0; i < sizeof(batchSizes)/sizeof(uint32_t); ++i)
+      {
+        benchmarkUdpSend(uiPort, uiPackets, uiSize, uiFrameSize, batchSizes[i], false);
+      }
+      benchmarkUdpSend(uiPort, uiPackets, uiSize, uiFrameSize, 64, true);
+      return 0;
+    }
+
+    if (sMode == "udp-shard-recv")
+    {
+      if (uiShards != 0)
+        return benchmarkShardedUdpReceive(uiPort, uiPackets, uiSize, uiShards);
+
+      const uint32_t shards[] = { 1, 2, 4 };
+      for (size_t i = 0; i < sizeof(shards)/sizeof(uint32_t); ++i)
+      {
+        benchmarkShardedUdpReceive(uiPort, uiPackets, uiSize, shards[i]);
+      }
+      return 0;
+    }
+
+    if (sMode == "session-db")
+    {
+      return benchmarkSessionDatabase(uiMembers, uiIntervals, uiReportedSenders);
+    }
+
+    if (sMode == "packetise")
+    {
+      return benchmarkPacketise(uiPort, uiPackets, uiSize, uiFrameSize);
+    }
+
+    if (sMode == "hevc")
+    {
+      const bool zeroCopy[] = { false, true };
+      for (size_t i = 0; i < sizeof(zeroCopy)/sizeof(bool); ++i)
+      {
+        benchmarkHevc(uiFrames, uiFrameBytes, uiSlices, uiMtu, 0, zeroCopy[i]);
+        if (uiMaxDonDiff > 0)
+          benchmarkHevc(uiFrames, uiFrameBytes, uiSlices, uiMtu, uiMaxDonDiff, zeroCopy[i]);
+      }
+      return 0;
+    }
+
+    if (sMode == "start-codes")
+    {
+      return benchmarkStartCodes(uiScanMegabytes);
+    }
+
+    if (sMode == "nal-source")
+    {
+      if (sFilename.empty())
+      {
+        LOG(ERROR) << "No file specified";
+        return -1;
+      }
+      return benchmarkNalSource(sFilename, sMediaType, uiLoops);
+    }
+
+    LOG(ERROR) << "Unknown benchmark: " << sMode;
+    return -1;
+  }
+  catch (boost::exception& e)
+  {
+    LOG(ERROR) << "Exception: " << boost::diagnostic_information(e);
+  }
+  catch (std::exception& e)
+  {
+    LOG(ERROR) << "Exception: " << e.what();
+  }
+  catch (...)
+  {
+    LOG(ERROR) << "Unknown exception!!!";
+  }
+  return -1;
+}